@@ -79,6 +79,8 @@ RNA::RNA(const char sequence[], const bool IsRNA):Thermodynamics(IsRNA) {
 
 	//Indicate that the partition function calculation has not been performed.
 	partitionfunctionallocated = false;
+	meaprobabilities = NULL;
+	measingle = NULL;
 
 	//Indicate that the energy data is not read.
 	energyallocated = false;
@@ -110,6 +112,8 @@ RNA::RNA(const char filename[], const int type, const bool IsRNA ):Thermodynamic
 
 	//Indicate that the partition function calculation has not been performed.
 	partitionfunctionallocated = false;
+	meaprobabilities = NULL;
+	measingle = NULL;
 
 	//Indicate that the energy data is not (yet) read.
 	energyallocated = false;
@@ -144,6 +148,8 @@ RNA::RNA(const bool IsRNA):Thermodynamics(IsRNA) {
 
 	//Indicate that the partition function calculation has not been performed.
 	partitionfunctionallocated = false;
+	meaprobabilities = NULL;
+	measingle = NULL;
 
 	//Indicate that the energy data is not (yet) read.
 	energyallocated = false;
@@ -197,6 +203,8 @@ char* RNA::GetErrorMessage(const int error) {
 	else if (error==24) return "Too few iterations.  There must be at least one iteration.\n";
 	else if (error==25) return "Index is not a multiple of 10.\n";
 	else if (error==26) return "k, the equilibrium constant, needs to be greater than or equal to 0.\n";
+	else if (error==27) return "The sequences are not the same length.\n";
+	else if (error==28) return "Found too few values in experimental pair bonus file.\n";
 	else return "Unknown Error\n";
 
 
@@ -394,12 +402,28 @@ int RNA::MaximizeExpectedAccuracy(const double maxPercent, const int maxStructur
 
 
 	//Past error trapping
-	MaxExpectFill(ct, v, w5, pfdata, lfce, mod, fce, maxPercent, maxStructures, window, gamma, progress);
+	//The probabilities do not depend on gamma, so they are calculated once and used for every later call.
+	if (meaprobabilities==NULL) {
+		meaprobabilities = new meaarray(ct->GetSequenceLength());
+		measingle = new double [ct->GetSequenceLength()+1];
+		MaxExpectProbabilities(ct, v, v2, w5, pfdata, lfce, mod, fce, meaprobabilities, measingle);
+	}
+	MaxExpectTrace(ct, meaprobabilities, measingle, maxPercent, maxStructures, window, gamma, progress);
 
 	return 0;//no error return functionality right now
 
 }
 
+// Delete the probabilities kept by MaximizeExpectedAccuracy.
+void RNA::deleteMaxExpectProbabilities() {
+
+	delete meaprobabilities;
+	delete[] measingle;
+	meaprobabilities = NULL;
+	measingle = NULL;
+
+}
+
 // This function predicts structures composed of probable base pairs.
 int RNA::PredictProbablePairs(const float probability) {
 	int i,j,count;
@@ -446,7 +470,7 @@ int RNA::PredictProbablePairs(const float probability) {
 		for (i=1;i<ct->GetSequenceLength();i++) {
 			for (j=i+1;j<=ct->GetSequenceLength();j++) {
 
-				if (calculateprobability(i,j,v,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce) > probability) {
+				if (calculateprobability(i,j,v,v2,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce) > probability) {
 					//This pair exceeded the threshold, so add it to the list
 					ct->SetPair(i,j);
 					
@@ -495,7 +519,7 @@ int RNA::PredictProbablePairs(const float probability) {
 				for (j=i+1;j<=ct->GetSequenceLength();j++) {
 
 					if (count==1) {
-						if (calculateprobability(i,j,v,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.99) {
+						if (calculateprobability(i,j,v,v2,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.99) {
 							
 							//set this pair because it meets the threshold
 							ct->SetPair(i,j,count);
@@ -503,49 +527,49 @@ int RNA::PredictProbablePairs(const float probability) {
 						}
 					}
 					else if (count==2) {
-						if (calculateprobability(i,j,v,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.97) {
+						if (calculateprobability(i,j,v,v2,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.97) {
 							
 							//set this pair because it meets the threshold
 							ct->SetPair(i,j,count);
 						}
 					}
 					else if (count==3) {
-						if (calculateprobability(i,j,v,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.95) {
+						if (calculateprobability(i,j,v,v2,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.95) {
 							
 							//set this pair because it meets the threshold
 							ct->SetPair(i,j,count);
 						}
 					}
 					else if (count==4) {
-						if (calculateprobability(i,j,v,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.90) {
+						if (calculateprobability(i,j,v,v2,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.90) {
 							
 							//set this pair because it meets the threshold
 							ct->SetPair(i,j,count);
 						}
 					}
 					else if (count==5) {
-						if (calculateprobability(i,j,v,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.80) {
+						if (calculateprobability(i,j,v,v2,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.80) {
 							
 							//set this pair because it meets the threshold
 							ct->SetPair(i,j,count);
 						}
 					}
 					else if (count==6) {
-						if (calculateprobability(i,j,v,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.70) {
+						if (calculateprobability(i,j,v,v2,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.70) {
 							
 							//set this pair because it meets the threshold
 							ct->SetPair(i,j,count);
 						}
 					}
 					else if (count==7) {
-						if (calculateprobability(i,j,v,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.60) {
+						if (calculateprobability(i,j,v,v2,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>=.60) {
 							
 							//set this pair because it meets the threshold
 							ct->SetPair(i,j,count);
 						}
 					}
 					else if (count==8) {
-						if (calculateprobability(i,j,v,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>.50) {
+						if (calculateprobability(i,j,v,v2,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce)>.50) {
 							
 							//set this pair because it meets the threshold
 							ct->SetPair(i,j,count);
@@ -623,6 +647,7 @@ int RNA::PartitionFunction(const char savefile[], double temperature) {
 
 	if (partitionfunctionallocated) {
 		delete v;
+		delete v2;
 		delete w;
 		delete wmb;
 		delete wl;
@@ -635,6 +660,8 @@ int RNA::PartitionFunction(const char savefile[], double temperature) {
 		delete[] w5;
 		delete pfdata;
 	}
+	//The MaxExpect probabilities of the last partition function are no longer valid.
+	deleteMaxExpectProbabilities();
 	//Allocate the memory needed (only if this is the first call to pfunction):
 	//indicate that the memory has been allocated so that the destructor will delete it.
 	partitionfunctionallocated = true;
@@ -642,6 +669,7 @@ int RNA::PartitionFunction(const char savefile[], double temperature) {
 	//allocate space for the v and w arrays:
 	w = new pfunctionclass(ct->GetSequenceLength());
 	v = new pfunctionclass(ct->GetSequenceLength());
+	v2 = NULL;
 	wmb = new pfunctionclass(ct->GetSequenceLength());
 	wl = new pfunctionclass(ct->GetSequenceLength());
 	wmbl = new pfunctionclass(ct->GetSequenceLength());
@@ -703,15 +731,18 @@ int RNA::PartitionFunction(const char savefile[], double temperature) {
 	  for (i=1;i<=2*ct->GetSequenceLength();i++) ct->SHAPE[i]=boltzman( ct->SHAPE[i], pfdata->temp);
 	}
 
+	//With the three-state reactivity model, the stacked-versus-helix-end differences are converted as well
+	//and v2 holds the part of V in which the pair stacks on the pair inside it.
+	if (pfthreestate(ct)) {
+	  for (i=1;i<=2*ct->GetSequenceLength();i++) ct->SHAPEdiff[i]=boltzman( ct->SHAPEdiff[i], pfdata->temp);
+	  v2 = new pfunctionclass(ct->GetSequenceLength());
+	}
+
 	if (ct->experimentalPairBonusExists){
 	  //symmetrize as well...
-	  for (i = 1; i <= 2*ct->GetSequenceLength(); i++){
-	    for(j = i; j <= 2*ct->GetSequenceLength(); j++){
-	      double avg = (double)( 0.5*(ct->EX[i][j] + ct->EX[j][i]) );
-	      ct->EX[i][j] = boltzman( avg, pfdata->temp);
-	      ct->EX[j][i] = ct->EX[i][j];
-	    }
-	  }
+	  ct->EX->symmetrize();
+	  for (i = 0; i < ct->EX->GetEntries(); i++) ct->EX->GetValue(i) = boltzman( ct->EX->GetValue(i), pfdata->temp);
+	  ct->EX->GetDefault() = boltzman( ct->EX->GetDefault(), pfdata->temp);
 	}
 
 
@@ -731,7 +762,7 @@ int RNA::PartitionFunction(const char savefile[], double temperature) {
 
 #ifndef _CUDA_CALC_
 	//default behavior: calculate the partition function on the CPU
-	calculatepfunction(ct,pfdata,progress,savefilename,false,&Q,w,v,wmb,wl,wmbl,wcoax,fce,w5,w3,mod,lfce);
+	calculatepfunction(ct,pfdata,progress,savefilename,false,&Q,w,v,v2,wmb,wl,wmbl,wcoax,fce,w5,w3,mod,lfce);
 #else //ifdef _CUDA_CALC_
 	//if cuda flag is set, calculate on GPU
 	//this requires compilation with nvcc
@@ -767,7 +798,7 @@ int RNA::PartitionFunction(const char savefile[], double temperature) {
 	prna_delete(p);
 #endif
 	if (savefilename!=NULL) {
-		writepfsave(savefilename,ct,w5,w3,v,w,wmb,wl,wmbl,wcoax,fce,mod,lfce,pfdata);
+		writepfsave(savefilename,ct,w5,w3,v,v2,w,wmb,wl,wmbl,wcoax,fce,mod,lfce,pfdata);
 
 		//clean up some memory use:
 		delete[] savefilename;
@@ -795,7 +826,7 @@ int RNA::ProbKnot(int iterations, int MinHelixLength) {
 
 	//Past error trapping
 	//Call the ProbKnot Program:
-	return ProbKnotAssemble(v, w5, ct, pfdata, lfce, mod, pfdata->scaling, fce, iterations, MinHelixLength );
+	return ProbKnotAssemble(v, v2, w5, ct, pfdata, lfce, mod, pfdata->scaling, fce, iterations, MinHelixLength );
 
 
 }
@@ -841,7 +872,7 @@ int RNA::Stochastic(const int structures, const int seed) {
 
 
 	//Past error trapping, call the stochastic traceback function
-	return stochastictraceback(w,wmb,wmbl,wcoax,wl,v,
+	return stochastictraceback(w,wmb,wmbl,wcoax,wl,v,v2,
 		fce, w3,w5,pfdata->scaling, lfce, mod, pfdata, structures,
 		ct, seed, progress);
 
@@ -849,6 +880,21 @@ int RNA::Stochastic(const int structures, const int seed) {
 }
 
 
+//Sample structures from the Boltzman ensemble, streaming them to out.
+int RNA::StochasticStream(const int structures, ostream *out, const int format, stochasticstatistics *statistics, const int seed) {
+
+	if (!partitionfunctionallocated) {
+		//There is no partition function data available.
+		return 15;
+	}
+
+	return stochasticstream(w,wmb,wmbl,wcoax,wl,v,v2,
+		fce, w3,w5,pfdata->scaling, lfce, mod, pfdata, structures,
+		ct, out, format, statistics, seed, progress);
+
+}
+
+
 //Force a nucleotide to be double stranded (base paired).
 //Return an integer that indicates an error code (0 = no error, 4 = nucleotide out of range, 8 = too many restraints specified, 9 = same nucleotide in conflicting restraint).
 int RNA::ForceDoubleStranded(const int i) {
@@ -1280,7 +1326,7 @@ int RNA::ReadSHAPE(const char filename[], const double parameter1, const double
 //filename is a c string that indicates a file that contains SHAPE data.
 //parameter1 is the slope.
 //parameter2 is the intercept.
-//Returns an integer that indicates an error code (0 = no error, 1 = input file not found).
+//Returns an integer that indicates an error code (0 = no error, 1 = input file not found, 4 = nucleotide in a list out of range, 28 = too few values in a matrix).
 int RNA::ReadExperimentalPairBonus(const char filename[], double const experimentalOffset, double const experimentalScaling ) {
 	FILE *check;
 
@@ -1295,9 +1341,7 @@ int RNA::ReadExperimentalPairBonus(const char filename[], double const experimen
 	  fclose(check);
 	}
 
-	ct->ReadExperimentalPairBonus(filename, experimentalOffset, experimentalScaling );
-
-	return 0;
+	return ct->ReadExperimentalPairBonus(filename, experimentalOffset, experimentalScaling );
 
 }
 
@@ -1334,6 +1378,26 @@ int RNA::ReadSHAPE(const char filename[], const double parameter1, const double
 	return 0;
 
 
+}
+
+//Use SHAPE data that is already in memory to constrain structure prediction on subsequent structure predictions.
+//positions and reactivities hold the nucleotide indexes and the reactivities.
+//The other parameters are the same as ReadSHAPE above.
+//Returns an integer that indicates an error code (0 = no error, 1 = positions and reactivities differ in length).
+int RNA::SetSHAPE(const std::vector<int> &positions, const std::vector<double> &reactivities, const double parameter1, const double parameter2, const double ssm, const double ssb, std::string modifier) {
+
+	if (positions.size()!=reactivities.size()) return 1;
+
+	ct->SHAPEslope=parameter1*conversionfactor;//register the slope in tenths of kcal/mol
+	ct->SHAPEintercept=parameter2*conversionfactor;//register the intercept in tenths of a kcal/mol
+	ct->SHAPEslope_ss=ssm*conversionfactor;//register the slope in tenths of kcal/mol
+	ct->SHAPEintercept_ss=ssb*conversionfactor;//register the intercept in tenths of a kcal/mol
+	ct->SetSHAPE(positions, reactivities, modifier);//determine pseudo energies
+
+
+	return 0;
+
+
 }
 
 //Read Double Strand Offset
@@ -1489,10 +1553,9 @@ int RNA::BreakPseudoknot(const bool minimum_energy, const int structurenumber) {
 	structure *tempct;
 
 
-	double **bpProbArray; //contains the raw bp probabilities for each bp
+	meaarray *bpProbArray; //contains the raw bp probabilities for each bp
 	double *bpSSProbArray; //contains the raw single strand probability for a base
-	double **vwArray;  //contains v and w recursion values
-	double **vwPArray; //the v' and w' recursion values
+	meafill *fill; //the w and w' recursion values
 
 	double *w3Array=0;//w3Array[i] is the maximum score from nucletides i to ct->GetSequenceLength()
 	double *w5Array=0;//w5Array[i] is the maximum score from nucleotides 1 to i
@@ -1632,35 +1695,18 @@ int RNA::BreakPseudoknot(const bool minimum_energy, const int structurenumber) {
 
 
 			//allocate main arrays and initialize the Arrays to defaults
-			bpProbArray = new double *[ct->GetSequenceLength()+1];
+			bpProbArray = new meaarray(ct->GetSequenceLength());
 			bpSSProbArray = new double [ct->GetSequenceLength()+1];
-			vwArray = new double *[ct->GetSequenceLength()+1];
-			vwPArray = new double *[ct->GetSequenceLength()+1];
 
 
 			sumPij = 0;
 
-			for (i=0;i<=ct->GetSequenceLength();i++) {
-				bpProbArray[i] = new double [ct->GetSequenceLength()+1];
-				vwArray[i] = new double [ct->GetSequenceLength()+1];
-				vwPArray[i] = new double [ct->GetSequenceLength()+1];
-
-				//tempct->basepr[1][i] = 0;
-				bpSSProbArray[i] = 0;
-
-				for (j=0;j<=ct->GetSequenceLength();j++) {
-					bpProbArray[i][j]=0;
-					vwArray[i][j]=-0;
-					vwPArray[i][j]=-0;
-				}
-			}
-
 
 
 
 			tempct->nucs[0] = ' ';
 
-			// Recursion rules investigate for vwArray
+			// Recursion rules investigate for w
 			//    1)  if the base pair (BP) probability value is 0, skip that pair
 			//    2)  hairpin turns at 5 BP
 			//    3)  stack/internal/bulge pairing at 7 BPs
@@ -1670,7 +1716,6 @@ int RNA::BreakPseudoknot(const bool minimum_energy, const int structurenumber) {
 
 			// Calculate the single stranded probabilities for each base
 			// Pi = 1 - (for all j, sum(Pij)
-			// fill in w for the diagonal for the Pi,i
 			for (i=1; i<=ct->GetSequenceLength(); i++)
 			{
 
@@ -1680,7 +1725,6 @@ int RNA::BreakPseudoknot(const bool minimum_energy, const int structurenumber) {
 
 
 
-				vwArray[i][i] = bpSSProbArray[i];
 			} // end loop over each base pair
 
 
@@ -1693,10 +1737,10 @@ int RNA::BreakPseudoknot(const bool minimum_energy, const int structurenumber) {
 				for (i=1, j=i+Length-1; j<=ct->GetSequenceLength(); i++, j++)
 				{
 					if (ct->GetPair(i,structures)==j) {
-						bpProbArray[j][i]=1.0;
+						bpProbArray->f(i,j)=1.0;
 					}
 					else {
-						bpProbArray[j][i]=-1.0;
+						bpProbArray->f(i,j)=-1.0;
 					}
 
 				}
@@ -1705,12 +1749,13 @@ int RNA::BreakPseudoknot(const bool minimum_energy, const int structurenumber) {
 			//Call the MEAFill routine.
 				//Note the false at the end "allows" non-canonical pairs.  This is required so that
 				//non-canonical pairs aren't spuriosly broken
-			MEAFill(tempct, bpProbArray, bpSSProbArray, vwArray, vwPArray, w5Array, w3Array, 1.0, 0, progress,false);
+			fill = new meafill(tempct, bpProbArray, bpSSProbArray, 1.0, false);
+			MEAFill(fill, w5Array, w3Array, 0, progress);
 
 
 
 			// start traceback
-			trace(tempct, vwArray, vwPArray, bpProbArray, 1.0, 0, 1, 0);
+			trace(fill, 0, 1, 0);
 
 
 
@@ -1719,20 +1764,10 @@ int RNA::BreakPseudoknot(const bool minimum_energy, const int structurenumber) {
 
 			// Deallocate memory for the MaxExpect calculation
 			//Arrays with functionality in the fill step
-			for (i=0;i<=ct->GetSequenceLength();i++) {
-				delete[] bpProbArray[i];
-			}
-			delete[] bpProbArray;
-
+			delete fill;
+			delete bpProbArray;
 			delete[] bpSSProbArray;
 
-			for (i=0; i<=ct->GetSequenceLength(); i++) {
-				delete[] vwArray[i];
-				delete[] vwPArray[i];
-			}
-			delete[] vwArray;
-			delete[] vwPArray;
-
 
 
 
@@ -1930,7 +1965,7 @@ double RNA::GetPairProbability(const int i, const int j) {
 	ErrorCode = 0;
 
 	//calculate the base pair probability
-	return (double) calculateprobability(i,j,v,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce);
+	return (double) calculateprobability(i,j,v,v2,w5,ct,pfdata,lfce,mod,pfdata->scaling,fce);
 
 
 }
@@ -2134,6 +2169,34 @@ structure *RNA::GetStructure() {
 
 }
 
+//Copy the thermodynamic parameters of source and share its reactivity histograms.
+void RNA::ShareParameters(RNA *source) {
+
+	CopyThermodynamic(source);
+	ct->ShareTrainingParam(source->GetStructure());
+
+}
+
+//Derive the thermodynamic parameters at temperature from source and share its reactivity histograms.
+int RNA::ShareParameters(RNA *source, double temperature) {
+	int error;
+
+	error = CopyThermodynamic(source,temperature);
+	if (error!=0) return error;
+	ct->ShareTrainingParam(source->GetStructure());
+
+	return 0;
+}
+
+//Copy the SHAPE pseudo free energies of source, which has the same sequence.
+int RNA::CopySHAPE(RNA *source) {
+
+	if (source->GetSequenceLength()!=GetSequenceLength()) return 27;
+	ct->CopySHAPE(source->GetStructure());
+
+	return 0;
+}
+
 
 //Provide a TProgressDialog for following calculation progress.
 //A TProgressDialog class has a public function void update(int percent) that indicates the progress of a long calculation.
@@ -2173,6 +2236,11 @@ void RNA::setSmoothVersion(bool useSmoothVersion)
 	ct->setSmoothVersion(useSmoothVersion);
 }
 
+void RNA::setFillTile(int tile)
+{
+	ct->SetFillTile(tile);
+}
+
 //FD
 //Generate reactivity histogram from training set
 void RNA::GenerateHistogram(const char* filename, double binSize)
@@ -2236,6 +2304,7 @@ RNA::~RNA() {
 		delete[] w5;
 		delete[] w3;
 		delete v;
+		delete v2;
 		delete w;
 		delete wmb;
 		delete wl;
@@ -2245,6 +2314,7 @@ RNA::~RNA() {
 		delete pfdata;
 
 	}
+	deleteMaxExpectProbabilities();
 
 	if (energyallocated) {
 		//A folding save file was opened, so clean up the memory use.
@@ -2264,6 +2334,8 @@ RNA::~RNA() {
 		}
 
 		delete ev;
+		delete ev1;
+		delete ev2;
 		delete ew;
 		delete ewmb;
 		delete fce;
@@ -2342,13 +2414,14 @@ int RNA::FileReader(const char filename[], const int type) {
 			//allocate everything
 			ct->allocate(sequencelength);
 
-			w = new pfunctionclass(ct->GetSequenceLength());
-			v = new pfunctionclass(ct->GetSequenceLength());
-			wmb = new pfunctionclass(ct->GetSequenceLength());
-			wmbl = new pfunctionclass(ct->GetSequenceLength());
-			wcoax = new pfunctionclass(ct->GetSequenceLength());
-			wl = new pfunctionclass(ct->GetSequenceLength());
-			fce = new forceclass(ct->GetSequenceLength());
+			//the arrays are attached to the blocks of the save file by readpfsave
+			w = new pfunctionclass(ct->GetSequenceLength(),false);
+			v = new pfunctionclass(ct->GetSequenceLength(),false);
+			wmb = new pfunctionclass(ct->GetSequenceLength(),false);
+			wmbl = new pfunctionclass(ct->GetSequenceLength(),false);
+			wcoax = new pfunctionclass(ct->GetSequenceLength(),false);
+			wl = new pfunctionclass(ct->GetSequenceLength(),false);
+			fce = new forceclass(ct->GetSequenceLength(),0,false);
 
 			w5 = new PFPRECISION [ct->GetSequenceLength()+1];
 			w3 = new PFPRECISION [ct->GetSequenceLength()+2];
@@ -2362,8 +2435,7 @@ int RNA::FileReader(const char filename[], const int type) {
 			partitionfunctionallocated = true;
 
 			//load all the data from the pfsavefile:
-			readpfsave(filename, ct, w5, w3,v, w, wmb,wl, wmbl, wcoax, fce,&pfdata->scaling,mod,lfce,pfdata);
-			return 0;
+			return readpfsave(filename, ct, w5, w3,v,&v2, w, wmb,wl, wmbl, wcoax, fce,&pfdata->scaling,mod,lfce,pfdata);
 
 		}
 		else if (type==4) {
@@ -2394,10 +2466,13 @@ int RNA::FileReader(const char filename[], const int type) {
 			//allocate everything
 			ct->allocate(sequencelength);
 
-			ew = new arrayclass(ct->GetSequenceLength());
-			ev = new arrayclass(ct->GetSequenceLength());
-			ewmb = new arrayclass(ct->GetSequenceLength());
-			fce = new forceclass(ct->GetSequenceLength());
+			//the arrays are attached to the blocks of the save file by readsav
+			ew = new arrayclass(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+			ev = new arrayclass(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+			ev1 = new arrayclass(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+			ev2 = new arrayclass(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+			ewmb = new arrayclass(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+			fce = new forceclass(ct->GetSequenceLength(),0,false);
 
 
 			lfce = new bool [2*ct->GetSequenceLength()+1];
@@ -2407,8 +2482,8 @@ int RNA::FileReader(const char filename[], const int type) {
 			ew3 = new integersize [ct->GetSequenceLength()+2];
 
 			if (ct->intermolecular) {
-				ew2 = new arrayclass(ct->GetSequenceLength());
-				ewmb2 = new arrayclass(ct->GetSequenceLength());
+				ew2 = new arrayclass(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+				ewmb2 = new arrayclass(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
 
 				for (i=0;i<3;i++) read(&sav,&(ct->inter[i]));
 
@@ -2422,12 +2497,9 @@ int RNA::FileReader(const char filename[], const int type) {
 			energyread = true;
 			data = new datatable();
 
-			//now read the file.
-			readsav(filename, ct, ew2, ewmb2, ew5, ew3, lfce, mod, data,
-					 ev, ew, ewmb, fce, &vmin);
-
-			//set error status to zero
-			 return 0;
+			//now read the file; this sets the error status to zero, or to 16 for a truncated or corrupt file
+			return readsav(filename, ct, ew2, ewmb2, ew5, ew3, lfce, mod, data,
+					 ev, ev1, ev2, ew, ewmb, fce, &vmin);
 
 
 		}
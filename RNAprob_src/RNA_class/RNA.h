@@ -12,9 +12,12 @@
 #include "../src/defines.h"
 #include "../src/rna_library.h"
 #include "../src/pfunction.h"
+#include "../src/stochastic.h"
 #include "thermodynamics.h"
 #include "../src/draw.h"
 
+class meaarray;
+
 #ifdef _WINDOWS_GUI
 #include "../RNAstructure_windows_interface/TProgressDialog.h"
 #else
@@ -249,6 +252,8 @@ class RNA: public Thermodynamics {
 		//! The score for a structure is = gamma * 2 * (sum of pairing probabilities for pairs) + (sum of unpairing probabilities for single stranded nucleotides).
 		//! This function requires partition function data from either a previous partition function calculations or
 		//!		from having read a partition function save file during construction of the class.
+		//! The pair probabilities are calculated by the first call after the partition function and kept, so that
+		//!		later calls, such as a scan of gamma, only fill and trace the structures.
 		//!	In case of error, the function returns a non-zero that can be parsed by GetErrorMessage() or GetErrorMessageString().
 		//!	\param maxPercent is the maximum percent difference is score in generating suboptimal structures.
 		//!	\param maxStructures is the maximum number of suboptimal structures to generate.
@@ -326,6 +331,19 @@ class RNA: public Thermodynamics {
 		//!	\param seed is an integer that seeds the random number generator that is required for sampling, which defaults to 1.
 		//! \return An int that indicates an error code (0 = no error, non-zero = error).
 		int Stochastic(const int structures, const int seed=1);
+
+		//! Sample structures from the Boltzman ensemble, writing each one to a stream instead of storing it.
+
+		//! The structures are the same, and in the same order, as those of Stochastic(), but only a few are held in memory at once,
+		//!		so any number can be sampled.  The samples are written in parallel by the SMP build.
+		//!	In case of error, the function returns a non-zero that can be parsed by GetErrorMessage() or GetErrorMessageString().
+		//!	\param structures is the number of structures to be sampled.
+		//!	\param out is the stream to which the structures are written, or NULL if only the statistics are needed.
+		//!	\param format is STOCHASTIC_DOTBRACKET for one line of dot-bracket notation per structure, or STOCHASTIC_PAIRS for binary pair lists (see stochastic.h).
+		//!	\param statistics, if not NULL, receives the pair and unpaired counts of the samples; it must have the length of the sequence.
+		//!	\param seed is an integer that seeds the random number generator that is required for sampling, which defaults to 1.
+		//! \return An int that indicates an error code (0 = no error, 2 = error writing out, non-zero = error).
+		int StochasticStream(const int structures, std::ostream *out, const int format, stochasticstatistics *statistics, const int seed=1);
 		
 
 		//********************************************************************************
@@ -520,6 +538,20 @@ class RNA: public Thermodynamics {
 		//!\return An integer that indicates an error code (0 = no error, 1 = input file not found).
 		int ReadSHAPE(const char filename[], const double parameter1, const double parameter2, const double ssm, const double ssb, std::string modifier="SHAPE");
 
+		//!Use SHAPE data that is already in memory, including single-stranded SHAPE pseudo free energys.
+		
+		//!This is the same as the ReadSHAPE overload above, but the reactivities are given as arrays instead of a file.
+		//!Nothing is written to disk, so this can be used to fold many resampled profiles (e.g. bootstrap replicates).
+		//!\param positions holds the nucleotide index of each reactivity.
+		//!\param reactivities holds the reactivities, values <= -500 are ignored.
+		//!\param parameter1 is the double-stranded slope.
+		//!\param parameter2 is the double-stranded intercept.
+		//!\param ssm is the single-stranded slope.
+		//!\param ssb is the single-stranded intercept.
+		//!\param modifier is the type of chemical modification probe that was used (currently accepted values are SHAPE, DMS, and CMCT). Defaults to SHAPE.
+		//!\return An integer that indicates an error code (0 = no error, 1 = the arrays are not the same length).
+		int SetSHAPE(const std::vector<int> &positions, const std::vector<double> &reactivities, const double parameter1, const double parameter2, const double ssm, const double ssb, std::string modifier="SHAPE");
+
 		//!Read double strand offset data from disk.
 		
 		//!The double strand offset is data that is used to constrain structure prediction on subsequent structure predictions.
@@ -544,10 +576,12 @@ class RNA: public Thermodynamics {
 		//! and those at the end of a helix get the bonus once.
 		//! The bonus is in the form of experimentalScaling*value + experimentalOffset.
 		//! The data is formatted using a simple square matrix of values and no headers.  The format requires that there be N^2 entries for a sequence of N nucleotides. 
+		//! Alternatively, the data can be a list with one "i j value" line for each pair that has a bonus; pairs that are not listed get only the offset.
+		//! Only pairs with a bonus are stored, so sparse data for long sequences takes little memory.
 		//!\param filename is a c string that indicates a file that contains data.
 		//!\param experimentalOffset is a double that is added to each value. 
 		//!\param experimentalScaling is a double by which each value is multiplied.
-		//!\return An integer that indicates an error code (0 = no error, 1 = input file not found).
+		//!\return An integer that indicates an error code (0 = no error, 1 = input file not found, 4 = nucleotide in a list out of range, 28 = too few values in a matrix).
 		int ReadExperimentalPairBonus(const char filename[], double const experimentalOffset, double const experimentalScaling );
 
 		//!Remove all folding constraints.
@@ -822,6 +856,30 @@ class RNA: public Thermodynamics {
 		//!\return A pointer to structure.
 		structure *GetStructure();
 
+		//!Use the parameters of another RNA class, so that they are read from disk only once.
+
+		//!The thermodynamic parameters of source are copied (see CopyThermodynamic()) and its reactivity histograms are shared.
+		//!This is helpful when many sequences or replicates are folded.  source must outlive this class.
+		//!\param source is a pointer to an RNA class that has already read its thermodynamic parameters.
+		void ShareParameters(RNA *source);
+
+		//!Use the parameters of another RNA class at another folding temperature.
+
+		//!The thermodynamic parameters at temperature are derived from those of source (see CopyThermodynamic(Thermodynamics *thermo, double temperature)) and its reactivity histograms are shared.
+		//!This is helpful when the same sequence is folded at many temperatures.  source must outlive this class.
+		//!\param source is a pointer to an RNA class that has already read its thermodynamic parameters at 310.15 K.
+		//!\param temperature is a double that indicates the folding temperature in K.
+		//!\return An integer that indicates an error code (0 = no error, 5 = the parameters at temperature could not be derived).
+		int ShareParameters(RNA *source, double temperature);
+
+		//!Use the SHAPE pseudo free energies of another RNA class with the same sequence.
+
+		//!The pseudo free energies that source calculated with ReadSHAPE() or SetSHAPE() are copied, so the reactivity data need not be read again.
+		//!They do not depend on the folding temperature.
+		//!\param source is a pointer to an RNA class with the same sequence.
+		//!\return An integer that indicates an error code (0 = no error, 27 = the sequences differ in length).
+		int CopySHAPE(RNA *source);
+
 		//******************************************************************
 		//Functions that provide a connection to TProgressDialog, for following calculation progress:
 		//******************************************************************
@@ -858,6 +916,9 @@ class RNA: public Thermodynamics {
 		
 		void setSmoothVersion(bool useSmoothVersion);
 
+		//!Fill the folding arrays in tiles of tile x tile fragments (0, the default, fills one diagonal at a time).
+		void setFillTile(int tile);
+
 		//*****************************
 		//Destructor:
 		//*****************************
@@ -885,6 +946,7 @@ class RNA: public Thermodynamics {
 		PFPRECISION *w5,*w3,**wca;
 		pfdatatable *pfdata;
 		pfunctionclass *w,*v,*wmb,*wl,*wmbl,*wcoax;
+		pfunctionclass *v2;//only allocated (otherwise NULL) with the three-state reactivity model, see pfthreestate
 		PFPRECISION Q;
 
 
@@ -897,6 +959,12 @@ class RNA: public Thermodynamics {
 		//The following bool is used to indicate whether the partion function arrays have been allocated and therefore need to be deleted.
 		bool partitionfunctionallocated;
 
+		//The pair and single strand probabilities of the partition function used by MaximizeExpectedAccuracy, or NULL if
+		//they have not been calculated since the last partition function.
+		meaarray *meaprobabilities;
+		double *measingle;
+		void deleteMaxExpectProbabilities();
+
 		
 
 		//The following bool is used to indicate whether the folding free energy arrays are allocated and therefore need to be deleted.
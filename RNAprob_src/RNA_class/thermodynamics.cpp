@@ -1,6 +1,8 @@
 #include <cstdlib>
 #include <cstring>
 #include "thermodynamics.h"
+#include "../src/profile.h"
+#include "../src/thermosnapshot.h"
 
 //Constructor:
 Thermodynamics::Thermodynamics(const bool ISRNA) {
@@ -17,6 +19,9 @@ Thermodynamics::Thermodynamics(const bool ISRNA) {
 	//set the enthalpy parameters to an unread status
 	enthalpy = NULL;
 
+	//no snapshot is mapped until the parameters are read
+	snapshot = NULL;
+
 
 }
 
@@ -29,7 +34,7 @@ int Thermodynamics::SetTemperature(double temperature) {
 	temp = temperature;
 
 	//If the thermodynamic parameter files were read at some point, delete them now:
-	if (energyread) delete data;
+	if (energyread) DeleteDatatable();
 
 	//Setting energyread to false will ensure that the parameters will be re-read from disk
 		//and set for the correct temperature at ay point they are needed.
@@ -59,7 +64,7 @@ double Thermodynamics::GetTemperature() {
 Thermodynamics::~Thermodynamics() {
 
 	//If the thermodynamic parameter files were read at some point, delete them now:
-	if (energyread) delete data;
+	if (energyread) DeleteDatatable();
 
 	//If the enthalpy parameters were read from disk, they must be deleted now:
 	if (enthalpy!=NULL) delete enthalpy;
@@ -209,34 +214,45 @@ datatable *Thermodynamics::GetDatatable() {
 
 //read the thermodynamic parameters from disk at location $DATAPATH or pwd
 int Thermodynamics::ReadThermodynamic(const char *pathname) {
+	profiletimer timer(profile.thermodynamictime);
 	char loop[maxfil],stackf[maxfil],tstackh[maxfil],tstacki[maxfil],
 		tloop[maxfil],miscloop[maxfil],danglef[maxfil],int22[maxfil],
 		int21[maxfil],coax[maxfil],tstackcoax[maxfil],
 		coaxstack[maxfil],tstack[maxfil],tstackm[maxfil],triloop[maxfil],int11[maxfil],hexaloop[maxfil],
-		tstacki23[maxfil], tstacki1n[maxfil],datapath[maxfil],*pointer;
-
-	//only allocate the datatable if energyread is false, meaning that no parameters are loaded
-	//	This is important because the user might alter the temperature with SetTemperature(), triggering a re-read of the parameters.
-	if (!energyread) data = new datatable();
-	
+		tstacki23[maxfil], tstacki1n[maxfil],datapath[maxfil],snapshotfile[maxfil];
+	bool altered = temp>(310.15+TOLERANCE)||temp<(310.15-TOLERANCE);
 
 	//Set the path to the thermodynamic parameters:
-	if (pathname!=NULL) {
-		//The user is specifying a path to the thermodynamic parameters
-		strcpy(datapath,pathname);
-		strcat(datapath,"/");
+	GetDataPath(datapath,pathname);
+
+	//If the data tables were compiled into a snapshot, map the parameters instead of parsing the files.
+	//	The enthalpies are needed only if the temperature is altered.
+	strcpy(snapshotfile,datapath);
+	strcat(snapshotfile,thermosnapshotname(isrna));
+	savemapping *mapping = NULL;
+	if (SnapshotCurrent(snapshotfile,datapath,false)&&(!altered||SnapshotCurrent(snapshotfile,datapath,true)))
+		mapping = openthermosnapshot(snapshotfile,altered);
+	if (mapping!=NULL) {
+		if (energyread) DeleteDatatable();
+		snapshot = mapping;
+		data = (datatable *) mapping->block(0);
+
+		//the mapping is private, so the free energy changes can be overwritten for the current temperature
+		if (altered) dG_T((float)temp,*data,*((datatable *) mapping->block(1)),*data);
 
+		energyread = true;
+		return 0;
 	}
-	else {
-		//Get the path to thermodynamic parameters from $DATAPATH, if available
-		pointer = getenv("DATAPATH");
-		if (pointer!=NULL) {
-			strcpy(datapath,pointer);
-			strcat(datapath,"/");
-		}
-		else strcpy(datapath,"");
 
+	//A snapshot that was mapped earlier cannot be read into.
+	if (energyread&&snapshot!=NULL) {
+		DeleteDatatable();
+		energyread = false;
 	}
+
+	//only allocate the datatable if energyread is false, meaning that no parameters are loaded
+	//	This is important because the user might alter the temperature with SetTemperature(), triggering a re-read of the parameters.
+	if (!energyread) data = new datatable();
 	
 	//open the data files -- must reside in pwd or $DATAPATH.
 	//open the thermodynamic data tables
@@ -299,25 +315,133 @@ int Thermodynamics::ReadThermodynamic(const char *pathname) {
 }
 
 
+//Parse the free energy and enthalpy parameter files and write them as a snapshot that ReadThermodynamic can map.
+int Thermodynamics::WriteThermodynamicSnapshot(const char *pathname) {
+	char loop[maxfil],stackf[maxfil],tstackh[maxfil],tstacki[maxfil],
+		tloop[maxfil],miscloop[maxfil],danglef[maxfil],int22[maxfil],
+		int21[maxfil],coax[maxfil],tstackcoax[maxfil],
+		coaxstack[maxfil],tstack[maxfil],tstackm[maxfil],triloop[maxfil],int11[maxfil],hexaloop[maxfil],
+		tstacki23[maxfil], tstacki1n[maxfil],datapath[maxfil],snapshotfile[maxfil];
+	datatable *freeenergy,*enthalpies;
+	int error = 0;
+
+	GetDataPath(datapath,pathname);
+
+	//the free energy changes at 37 degrees C
+	freeenergy = new datatable();
+	GetDat (loop, stackf, tstackh, tstacki,tloop, miscloop, danglef, int22,
+          int21,coax, tstackcoax,coaxstack, tstack, tstackm, triloop,
+          int11, hexaloop, tstacki23, tstacki1n, datapath, isrna);
+	if (opendat (loop,stackf,tstackh,tstacki,tloop,miscloop,danglef,int22,int21,
+   		coax,tstackcoax,coaxstack,tstack,tstackm,triloop,int11,hexaloop,tstacki23, tstacki1n,freeenergy)==0) {
+
+		delete freeenergy;
+		return 5;
+
+	}
+
+	//and the enthalpies; without them, the snapshot is only used at 37 degrees C
+	enthalpies = new datatable();
+	GetDat(loop, stackf, tstackh, tstacki,
+		tloop, miscloop, danglef, int22,
+		int21,coax, tstackcoax,
+		coaxstack, tstack, tstackm, triloop,
+		int11, hexaloop, tstacki23, tstacki1n, datapath, isrna,true);
+	if (opendat(loop, stackf, tstackh, tstacki,
+		tloop, miscloop, danglef, int22,
+		int21,coax, tstackcoax,
+		coaxstack, tstack, tstackm, triloop,
+		int11,hexaloop,tstacki23, tstacki1n, enthalpies)==0) {
+
+		delete enthalpies;
+		enthalpies = NULL;
+
+	}
+
+	strcpy(snapshotfile,datapath);
+	strcat(snapshotfile,thermosnapshotname(isrna));
+	if (!writethermosnapshot(snapshotfile,freeenergy,enthalpies)) error = 2;
+
+	delete freeenergy;
+	delete enthalpies;
+	return error;
+}
+
+//Check that no parameter file changed after the snapshot was written.
+bool Thermodynamics::SnapshotCurrent(const char *snapshotfile, char *datapath, bool isEnthalpy) {
+	char loop[maxfil],stackf[maxfil],tstackh[maxfil],tstacki[maxfil],
+		tloop[maxfil],miscloop[maxfil],danglef[maxfil],int22[maxfil],
+		int21[maxfil],coax[maxfil],tstackcoax[maxfil],
+		coaxstack[maxfil],tstack[maxfil],tstackm[maxfil],triloop[maxfil],int11[maxfil],hexaloop[maxfil],
+		tstacki23[maxfil], tstacki1n[maxfil];
+
+	GetDat (loop, stackf, tstackh, tstacki,tloop, miscloop, danglef, int22,
+          int21,coax, tstackcoax,coaxstack, tstack, tstackm, triloop,
+          int11, hexaloop, tstacki23, tstacki1n, datapath, isrna, isEnthalpy);
+
+	char *sources[19] = {loop,stackf,tstackh,tstacki,tloop,miscloop,danglef,int22,int21,
+		coax,tstackcoax,coaxstack,tstack,tstackm,triloop,int11,hexaloop,tstacki23,tstacki1n};
+	return thermosnapshotcurrent(snapshotfile,sources,19);
+}
+
+//Get the path to the parameter files.
+void Thermodynamics::GetDataPath(char *datapath, const char *pathname) {
+	char *pointer;
+
+	if (pathname!=NULL) {
+		//The user is specifying a path to the thermodynamic parameters
+		strcpy(datapath,pathname);
+		strcat(datapath,"/");
+
+	}
+	else {
+		//Get the path to thermodynamic parameters from $DATAPATH, if available
+		pointer = getenv("DATAPATH");
+		if (pointer!=NULL) {
+			strcpy(datapath,pointer);
+			strcat(datapath,"/");
+		}
+		else strcpy(datapath,"");
+
+	}
+}
+
+//Delete the free energy parameters, or release the snapshot they are mapped from.
+void Thermodynamics::DeleteDatatable() {
+	if (snapshot!=NULL) {
+		snapshot->release();
+		snapshot = NULL;
+	}
+	else delete data;
+}
+
+
 // This function is used to provide an enthalpy table.
 datatable *Thermodynamics::GetEnthalpyTable() {
 	char loop[maxfil],stackf[maxfil],tstackh[maxfil],tstacki[maxfil],
 		tloop[maxfil],miscloop[maxfil],danglef[maxfil],int22[maxfil],
 		int21[maxfil],coax[maxfil],tstackcoax[maxfil],
 		coaxstack[maxfil],tstack[maxfil],tstackm[maxfil],triloop[maxfil],int11[maxfil],hexaloop[maxfil],
-		tstacki23[maxfil], tstacki1n[maxfil],datapath[maxfil],*pointer;
+		tstacki23[maxfil], tstacki1n[maxfil],datapath[maxfil],snapshotfile[maxfil];
 
 	//start by determining if the parameters need to be read or whether they have already been read:
 	if (enthalpy==NULL) {
 		//The parameters have not been read, so read them now:
 
 		//Get the information from $DATAPATH, if available
-		pointer = getenv("DATAPATH");
-		if (pointer!=NULL) {
-			strcpy(datapath,pointer);
-			strcat(datapath,"/");
+		GetDataPath(datapath,NULL);
+
+		//A snapshot with the enthalpies saves parsing them; they are copied, so that the snapshot need not stay mapped.
+		strcpy(snapshotfile,datapath);
+		strcat(snapshotfile,thermosnapshotname(isrna));
+		if (SnapshotCurrent(snapshotfile,datapath,true)) {
+			savemapping *mapping = openthermosnapshot(snapshotfile,true);
+			if (mapping!=NULL) {
+				enthalpy = new datatable(*((datatable *) mapping->block(1)));
+				mapping->release();
+				return enthalpy;
+			}
 		}
-		else strcpy(datapath,"");
 
 		//get the names of the enthalpy files
 		GetDat(loop, stackf, tstackh, tstacki,
@@ -337,6 +461,7 @@ datatable *Thermodynamics::GetEnthalpyTable() {
 			int11,hexaloop,tstacki23, tstacki1n, enthalpy)==0) {
 
 			delete enthalpy;
+			enthalpy = NULL;
 			return NULL;//an error has occured
 
 		}
@@ -360,11 +485,18 @@ void Thermodynamics::CopyThermodynamic(Thermodynamics *thermo) {
 
 	if (thermo->GetEnergyRead()) {
 		SetTemperature(thermo->GetTemperature());
-		data = new datatable();
 		energyread = true;
-		
 
-		*data = *thermo->GetDatatable(); 
+		if (thermo->snapshot!=NULL) {
+			//the parameters are mapped from a snapshot, which can be shared instead of copied
+			snapshot = thermo->snapshot;
+			snapshot->hold();
+			data = thermo->data;
+		}
+		else {
+			data = new datatable();
+			*data = *thermo->GetDatatable(); 
+		}
 	}
 
 	return;
@@ -372,6 +504,35 @@ void Thermodynamics::CopyThermodynamic(Thermodynamics *thermo) {
 }
 
 
+//Derive the thermodynamic parameters at temperature from those of thermo at 310.15 K.
+int Thermodynamics::CopyThermodynamic(Thermodynamics *thermo, double temperature) {
+	datatable *enthalpies;
+
+	if (!thermo->GetEnergyRead()) return 5;
+	if (thermo->GetTemperature()>(310.15+TOLERANCE)||thermo->GetTemperature()<(310.15-TOLERANCE)) return 5;
+
+	//at 310.15 K, the parameters are simply copied
+	if (temperature<=(310.15+TOLERANCE)&&temperature>=(310.15-TOLERANCE)) {
+		CopyThermodynamic(thermo);
+		temp = temperature;
+		return 0;
+	}
+
+	enthalpies = thermo->GetEnthalpyTable();
+	if (enthalpies==NULL) return 5;
+
+	SetTemperature(temperature);
+	data = new datatable();
+	*data = *thermo->GetDatatable();
+
+	//as in ReadThermodynamic, overwrite the free energy changes at 37 degrees C with those at temp
+	dG_T((float)temp,*data,*enthalpies,*data);
+	energyread = true;
+
+	return 0;
+}
+
+
 //Return whether this instance of Thermodynamics has the paremters populated (either from disk or from another Thermodynamics class).
 		
 		
@@ -7,6 +7,8 @@
 //Import the definition of struct datatable.
 #include "../src/rna_library.h"
 
+class savemapping;
+
 
 //TOLERANCE is the maximum deviation from 310.15 K before which the enthalpy parameters are read from disk to adjust the free energyy changes from 310.15 K.
 #define TOLERANCE 0.01 
@@ -67,8 +69,17 @@ class Thermodynamics {
 		//! If a specific path is needed, $DATAPATH is overridden by specifying the pathname explicitly here as a parameter.
 		//! \return An int that indicates whether an error occured.
 		//! \param pathname is a pointer to cstring that indicates the pathname to the thermodynamnic parameters.  By default, this is NULL and the environment variable $DATAPATH is consulted to get this path. 
+		//! If the path holds a thermodynamic snapshot (rna.snapshot or dna.snapshot, see WriteThermodynamicSnapshot), the parameters are mapped from it instead of being parsed.
 		int ReadThermodynamic(const char *pathname = NULL);
 
+		//! Function to write a thermodynamic snapshot.
+
+		//! The free energy and enthalpy parameter files are parsed and written, as binary tables, to rna.snapshot (or dna.snapshot) in the same path.
+		//! ReadThermodynamic then maps the snapshot, which is much faster than parsing the files.  The snapshot must be written again when the files change.
+		//! \return An int that indicates an error code (0 = no error, 2 = error writing the snapshot, 5 = error reading the parameter files).
+		//! \param pathname is a pointer to cstring that indicates the pathname to the thermodynamnic parameters, as for ReadThermodynamic.
+		int WriteThermodynamicSnapshot(const char *pathname = NULL);
+
 		//**********************************************
 		//Functions that provide accessibility of the underlying tables:
 		//**********************************************
@@ -96,6 +107,18 @@ class Thermodynamics {
 		//!\param thermo is a pointer to Thermodynamics class.  That must have already called the ReadThermodynamics() function.  
 		void CopyThermodynamic(Thermodynamics *thermo);
 
+		//!Derive the thermodynamic parameters at another temperature from an instance of Thermodynamics class.
+
+		//!The free energy changes at temperature are calculated in memory from the free energy changes at 310.15 K
+		//!and the enthalpy changes of thermo, so that the parameter files are read only once when the same
+		//!calculation is repeated at many temperatures.
+		//!thermo must have read its parameters at 310.15 K.  Its enthalpy parameters are read on the first call (see GetEnthalpyTable());
+		//!call GetEnthalpyTable() on thermo first if several instances derive their parameters from it in parallel.
+		//!\return An int that indicates an error code (0 = no error, 5 = thermo was not read at 310.15 K or the enthalpy parameters could not be read).
+		//!\param thermo is a pointer to Thermodynamics class, that must have already called the ReadThermodynamics() function at 310.15 K.
+		//!\param temperature is a double that indicates the folding temperature in K.
+		int CopyThermodynamic(Thermodynamics *thermo, double temperature);
+
 
 		//!Return whether this instance of Thermodynamics has the paremters populated (either from disk or from another Thermodynamics class).
 		
@@ -123,6 +146,15 @@ class Thermodynamics {
 			char *coaxstack, char *tstack, char *tstackm, char *triloop,
 			char *int11, char *hexaloop, char *tstacki23, char *tstacki1n,
 			char *datapath, bool isRNA, bool isEnthalpy=false);
+
+		//Get the path to the parameter files, which is pathname or, if pathname is NULL, $DATAPATH, followed by a slash.
+		void GetDataPath(char *datapath, const char *pathname);
+
+		//Whether the snapshot is at least as new as the free energy (or, with isEnthalpy, the enthalpy) parameter files in datapath.
+		bool SnapshotCurrent(const char *snapshotfile, char *datapath, bool isEnthalpy);
+
+		//Delete data, or release the snapshot it points into.
+		void DeleteDatatable();
 		
 		//!Access the thermodynamic parameter class an instance of datatable.
 		
@@ -136,6 +168,9 @@ class Thermodynamics {
 		//Class to store thermodynamic parameters.
 		datatable *data;
 
+		//The mapped thermodynamic snapshot that data points into, or NULL if data was allocated.
+		savemapping *snapshot;
+
 		//Class to store enthalpy parameters.
 		datatable *enthalpy;
 
@@ -0,0 +1,472 @@
+/*
+ * A program that times the folding calculations over a set of sequences and reactivity profiles.
+ * The timings are written to a baseline file and can be compared with a stored reference.
+ */
+
+#include "Bench.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#ifdef __linux__
+#include <malloc.h>
+#endif
+#include <sys/resource.h>
+#include <sys/time.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Get the wall clock time, in seconds.
+///////////////////////////////////////////////////////////////////////////////
+static double wallTime() {
+	struct timeval now;
+	gettimeofday( &now, NULL );
+	return now.tv_sec + now.tv_usec / 1e6;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Reset the peak resident set size to the current one, so that the next call
+// to peakResidentSize gives the peak of one calculation.
+///////////////////////////////////////////////////////////////////////////////
+static void resetPeakResidentSize() {
+#ifdef __linux__
+	// Return the memory freed by earlier calculations, which the allocator keeps, so that it is not counted.
+	malloc_trim( 0 );
+
+	// Writing 5 to clear_refs resets VmHWM, the peak of the process.
+	ofstream clear( "/proc/self/clear_refs" );
+	clear << "5";
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Get the peak resident set size since the last reset, in kB.
+// Where the peak cannot be reset, this is the peak of the whole process.
+///////////////////////////////////////////////////////////////////////////////
+static long peakResidentSize() {
+#ifdef __linux__
+	ifstream status( "/proc/self/status" );
+	string line;
+	while( getline( status, line ) ) {
+		if( line.compare( 0, 6, "VmHWM:" ) == 0 ) { return atol( line.c_str() + 6 ); }
+	}
+#endif
+
+	struct rusage usage;
+	getrusage( RUSAGE_SELF, &usage );
+#ifdef __APPLE__
+	// Mac reports bytes, Linux reports kB.
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Remove the structures of a strand, so that the next calculation starts from none.
+///////////////////////////////////////////////////////////////////////////////
+static void clearStructures( RNA* strand ) {
+	structure* ct = strand->GetStructure();
+	while( ct->GetNumberofStructures() > 0 ) { ct->RemoveLastStructure(); }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor.
+///////////////////////////////////////////////////////////////////////////////
+Bench::Bench() {
+
+	// Initialize the calculation type description.
+	calcType = "Benchmark";
+
+	// Initialize the range of sequence lengths (all sequences).
+	minLength = 0;
+	maxLength = -1;
+
+	// Initialize the number of repeats.
+	repeats = 1;
+
+	// Initialize the regression tolerance (25 percent).
+	tolerance = 0.25;
+
+	// Initialize the shortest time that is checked for regressions.
+	minSeconds = 0.05;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Parse the command line arguments.
+///////////////////////////////////////////////////////////////////////////////
+bool Bench::parse( int argc, char** argv ) {
+
+	// Create the command line parser and build in its required parameters.
+	ParseCommandLine* parser = new ParseCommandLine( "RNAprob-bench" );
+	parser->addParameterDescription( "data directory", "The name of a directory holding sequence files in ct_sequence_file/<name>.fa and SHAPE profiles in shape_raw/<name>.shape." );
+	parser->addParameterDescription( "baseline file", "The name of a file to which the timings will be written." );
+
+	// Add the reference option.
+	vector<string> referenceOptions;
+	referenceOptions.push_back( "-r" );
+	referenceOptions.push_back( "-R" );
+	referenceOptions.push_back( "--reference" );
+	parser->addOptionFlagsWithParameters( referenceOptions, "Specify a baseline file written by an earlier run. Timings and peak memory that exceed the reference by more than the tolerance are flagged as regressions. Default is no comparison." );
+
+	// Add the tolerance option.
+	vector<string> toleranceOptions;
+	toleranceOptions.push_back( "-tol" );
+	toleranceOptions.push_back( "--tolerance" );
+	parser->addOptionFlagsWithParameters( toleranceOptions, "Specify the fraction by which a timing may exceed the reference before it is flagged. Default is 0.25." );
+
+	// Add the minimum length option.
+	vector<string> minLengthOptions;
+	minLengthOptions.push_back( "-min" );
+	minLengthOptions.push_back( "--minLength" );
+	parser->addOptionFlagsWithParameters( minLengthOptions, "Specify the length of the shortest sequence to be timed. Default is 0, all sequences." );
+
+	// Add the maximum length option.
+	vector<string> maxLengthOptions;
+	maxLengthOptions.push_back( "-max" );
+	maxLengthOptions.push_back( "--maxLength" );
+	parser->addOptionFlagsWithParameters( maxLengthOptions, "Specify the length of the longest sequence to be timed. Default is no limit." );
+
+	// Add the repeats option.
+	vector<string> repeatOptions;
+	repeatOptions.push_back( "-n" );
+	repeatOptions.push_back( "--repeats" );
+	parser->addOptionFlagsWithParameters( repeatOptions, "Specify the number of times each calculation is repeated; the fastest time is reported. Default is 1." );
+
+	// Parse the command line into pieces.
+	parser->parseLine( argc, argv );
+
+	// Get required parameters from the parser.
+	if( !parser->isError() ) {
+		dataDir = parser->getParameter( 1 );
+		baselineFile = parser->getParameter( 2 );
+	}
+
+	// Get the reference option.
+	if( !parser->isError() ) { referenceFile = parser->getOptionString( referenceOptions, true ); }
+
+	// Get the tolerance option.
+	if( !parser->isError() ) {
+		parser->setOptionDouble( toleranceOptions, tolerance );
+		if( tolerance < 0 ) { parser->setError( "tolerance" ); }
+	}
+
+	// Get the length range options.
+	if( !parser->isError() ) {
+		parser->setOptionInteger( minLengthOptions, minLength );
+		if( minLength < 0 ) { parser->setError( "minimum length" ); }
+	}
+	if( !parser->isError() ) {
+		parser->setOptionInteger( maxLengthOptions, maxLength );
+		if( maxLength < 0 && maxLength != -1 ) { parser->setError( "maximum length" ); }
+	}
+
+	// Get the repeats option.
+	if( !parser->isError() ) {
+		parser->setOptionInteger( repeatOptions, repeats );
+		if( repeats <= 0 ) { parser->setError( "repeats" ); }
+	}
+
+	// Delete the parser and return whether the parser encountered an error.
+	bool noError = ( parser->isError() == false );
+	delete parser;
+	return noError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Find the sequences that have a SHAPE profile, shortest first.
+///////////////////////////////////////////////////////////////////////////////
+bool Bench::readSequences( vector<BenchSequence>& sequences ) {
+	string seqDir = dataDir + "/ct_sequence_file/";
+	string shapeDir = dataDir + "/shape_raw/";
+
+	DIR* directory = opendir( seqDir.c_str() );
+	if( directory == NULL ) { return false; }
+
+	struct dirent* entry;
+	while( ( entry = readdir( directory ) ) != NULL ) {
+		string file = entry->d_name;
+		if( file.size() <= 3 || file.substr( file.size() - 3 ) != ".fa" ) { continue; }
+
+		BenchSequence sequence;
+		sequence.name = file.substr( 0, file.size() - 3 );
+		sequence.seqFile = seqDir + file;
+		sequence.SHAPEFile = shapeDir + sequence.name + ".shape";
+		ifstream test( sequence.SHAPEFile.c_str() );
+		if( !test ) { continue; }
+
+		RNA strand( sequence.seqFile.c_str(), 2 );
+		if( strand.GetErrorCode() != 0 ) { continue; }
+		sequence.length = strand.GetSequenceLength();
+		if( sequence.length < minLength || ( maxLength != -1 && sequence.length > maxLength ) ) { continue; }
+
+		sequences.push_back( sequence );
+	}
+	closedir( directory );
+
+	// Sort by length, then name, so that runs on different file systems list the sequences in the same order.
+	vector< pair< pair<int,string>, int > > order;
+	for( unsigned int i=0;i<sequences.size();i++ ) { order.push_back( make_pair( make_pair( sequences[i].length, sequences[i].name ), i ) ); }
+	sort( order.begin(), order.end() );
+	vector<BenchSequence> sorted;
+	for( unsigned int i=0;i<order.size();i++ ) { sorted.push_back( sequences[order[i].second] ); }
+	sequences = sorted;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create a strand for a sequence, with its SHAPE restraints applied.
+///////////////////////////////////////////////////////////////////////////////
+RNA* Bench::prepareStrand( RNA* master, const BenchSequence& sequence, const string& mode ) {
+	RNA* strand = new RNA( sequence.seqFile.c_str(), 2 );
+	strand->ShareParameters( master );
+	strand->setStateType( mode == "2s" );
+	strand->setSmoothVersion( mode == "smooth" );
+
+	// The profile is read directly; ReadSHAPE also dumps the pseudoenergies to the working directory.
+	vector<int> positions;
+	vector<double> reactivities;
+	readreactivity( sequence.SHAPEFile.c_str(), positions, reactivities );
+	strand->SetSHAPE( positions, reactivities, 1.8, -0.6, 0, 0, "SHAPE" );
+	return strand;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Time each calculation for one sequence and scoring mode.
+///////////////////////////////////////////////////////////////////////////////
+int Bench::timeSequence( RNA* master, const BenchSequence& sequence, const string& mode, vector<BenchResult>& results ) {
+	int length = sequence.length;
+	int window = defaultwindowsize( length );
+
+	const int numStages = 5;
+	const char* stages[numStages] = { "mfe", "fold", "pf", "stochastic", "maxexpect" };
+	double best[numStages];
+	long peakRSS[numStages];
+	int structures[numStages];
+	int error = 0;
+	int stage;
+
+	for( stage=0;stage<numStages;stage++ ) {
+		best[stage] = -1;
+		peakRSS[stage] = 0;
+	}
+
+	for( int repeat=0;repeat<repeats && error==0;repeat++ ) {
+		double seconds[numStages];
+		long peak[numStages];
+		double start;
+
+		// The mfe calculation fills only the half of the arrays needed for the lowest free energy structure.
+		RNA* strand = prepareStrand( master, sequence, mode );
+		resetPeakResidentSize();
+		start = wallTime();
+		error = strand->FoldSingleStrand( 10, 20, window, "", 30, true );
+		seconds[0] = wallTime() - start;
+		peak[0] = peakResidentSize();
+		structures[0] = strand->GetStructureNumber();
+		delete strand;
+
+		// The full fill and the suboptimal traceback, with the defaults of RNAprob.
+		strand = prepareStrand( master, sequence, mode );
+		if( error == 0 ) {
+			resetPeakResidentSize();
+			start = wallTime();
+			error = strand->FoldSingleStrand( 10, 20, window, "", 30, false );
+			seconds[1] = wallTime() - start;
+			peak[1] = peakResidentSize();
+			structures[1] = strand->GetStructureNumber();
+		}
+
+		if( error == 0 ) {
+			resetPeakResidentSize();
+			start = wallTime();
+			error = strand->PartitionFunction();
+			seconds[2] = wallTime() - start;
+			peak[2] = peakResidentSize();
+			structures[2] = 0;
+		}
+
+		// Stochastic sampling and MaxExpect use the defaults of the RNAstructure programs.
+		if( error == 0 ) {
+			clearStructures( strand );
+			resetPeakResidentSize();
+			start = wallTime();
+			error = strand->Stochastic( 1000, 1234 );
+			seconds[3] = wallTime() - start;
+			peak[3] = peakResidentSize();
+			structures[3] = strand->GetStructureNumber();
+		}
+
+		if( error == 0 ) {
+			clearStructures( strand );
+			resetPeakResidentSize();
+			start = wallTime();
+			error = strand->MaximizeExpectedAccuracy( 50, 1000, 5, 1.0 );
+			seconds[4] = wallTime() - start;
+			peak[4] = peakResidentSize();
+			structures[4] = strand->GetStructureNumber();
+		}
+
+		if( error != 0 ) { cerr << "\n" << sequence.name << " (" << mode << "): " << strand->GetErrorMessage( error ); }
+		delete strand;
+
+		for( stage=0;stage<numStages && error==0;stage++ ) {
+			if( best[stage] < 0 || seconds[stage] < best[stage] ) { best[stage] = seconds[stage]; }
+			if( peak[stage] > peakRSS[stage] ) { peakRSS[stage] = peak[stage]; }
+		}
+	}
+
+	if( error != 0 ) { return error; }
+
+	for( stage=0;stage<numStages;stage++ ) {
+		BenchResult result;
+		result.name = sequence.name;
+		result.length = length;
+		result.mode = mode;
+		result.stage = stages[stage];
+		result.seconds = best[stage];
+		result.peakRSS = peakRSS[stage];
+		result.structures = structures[stage];
+		results.push_back( result );
+	}
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Compare the timings with the reference and report the regressions.
+///////////////////////////////////////////////////////////////////////////////
+int Bench::compareReference( const vector<BenchResult>& results ) {
+	ifstream in( referenceFile.c_str() );
+	string line;
+
+	// reference[name mode stage] is the time and peak memory of the reference run.
+	map< string, pair<double,long> > reference;
+	getline( in, line );
+	while( getline( in, line ) ) {
+		istringstream fields( line );
+		string name, mode, stage;
+		int length;
+		double seconds;
+		long peakRSS;
+		if( fields >> name >> length >> mode >> stage >> seconds >> peakRSS ) {
+			reference[name + " " + mode + " " + stage] = make_pair( seconds, peakRSS );
+		}
+	}
+	in.close();
+
+	int regressions = 0;
+	for( unsigned int i=0;i<results.size();i++ ) {
+		const BenchResult& result = results[i];
+		map< string, pair<double,long> >::iterator found = reference.find( result.name + " " + result.mode + " " + result.stage );
+		if( found == reference.end() ) { continue; }
+
+		double seconds = found->second.first;
+		long peakRSS = found->second.second;
+		if( result.seconds > seconds * ( 1 + tolerance ) && result.seconds > minSeconds ) {
+			cout << "REGRESSION " << result.name << " " << result.mode << " " << result.stage << ": "
+				<< seconds << " s -> " << result.seconds << " s\n";
+			regressions++;
+		}
+		if( result.peakRSS > peakRSS * ( 1 + tolerance ) ) {
+			cout << "REGRESSION " << result.name << " " << result.mode << " " << result.stage << ": "
+				<< peakRSS << " kB -> " << result.peakRSS << " kB peak memory\n";
+			regressions++;
+		}
+	}
+	return regressions;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Run calculations.
+///////////////////////////////////////////////////////////////////////////////
+int Bench::run() {
+
+	// Create a variable that handles errors.
+	int error = 0;
+
+	// Find the sequences.
+	cout << "Reading data set..." << flush;
+	vector<BenchSequence> sequences;
+	if( !readSequences( sequences ) ) {
+		cerr << "\nThe data directory " << dataDir << " could not be read.\n";
+		error = 1;
+	}
+	if( error == 0 ) { cout << "done, " << sequences.size() << " sequences." << endl; }
+
+	// Read the thermodynamic parameters and the reactivity histograms once; every strand shares them.
+	RNA* master = new RNA();
+	ErrorChecker<RNA>* checker = new ErrorChecker<RNA>( master );
+	if( error == 0 ) {
+		cout << "Reading parameters..." << flush;
+		error = checker->isErrorStatus( master->ReadThermodynamic() );
+		if( error == 0 ) {
+			structure* source = master->GetStructure();
+			source->ReadTrainingParam();
+			source->trainingParamRead = true;
+			cout << "done." << endl;
+		}
+	}
+
+	// Open the baseline; each sequence is written as soon as it is timed, so an interrupted run keeps what was done.
+	ofstream out;
+	if( error == 0 ) {
+		out.open( baselineFile.c_str() );
+		if( !out ) {
+			cerr << "The baseline " << baselineFile << " could not be written.\n";
+			error = 1;
+		}
+		else { out << "name\tlength\tmode\tstage\tseconds\tpeak_rss_kb\tstructures\tstructures_per_sec\n"; }
+	}
+
+	// Time each sequence in each scoring mode.
+	vector<BenchResult> results;
+	const char* modes[3] = { "3state", "2s", "smooth" };
+	for( unsigned int i=0;i<sequences.size() && error==0;i++ ) {
+		for( int mode=0;mode<3 && error==0;mode++ ) {
+			cout << "Timing " << sequences[i].name << " (" << sequences[i].length << " nt, " << modes[mode] << ")..." << flush;
+			unsigned int first = results.size();
+			error = timeSequence( master, sequences[i], modes[mode], results );
+
+			for( unsigned int r=first;r<results.size();r++ ) {
+				const BenchResult& result = results[r];
+				out << result.name << "\t" << result.length << "\t" << result.mode << "\t" << result.stage << "\t"
+					<< result.seconds << "\t" << result.peakRSS << "\t" << result.structures << "\t"
+					<< ( result.seconds > 0 ? result.structures / result.seconds : 0 ) << "\n";
+			}
+			out.flush();
+
+			if( error == 0 ) { cout << "done." << endl; }
+		}
+	}
+	out.close();
+
+	// Compare with the reference.
+	int regressions = 0;
+	if( error == 0 && referenceFile != "" ) {
+		regressions = compareReference( results );
+		cout << regressions << " regressions against " << referenceFile << "." << endl;
+	}
+
+	// Delete the error checker and master strand.
+	delete checker;
+	delete master;
+
+	// Print confirmation of run finishing.
+	if( error == 0 ) { cout << calcType << " complete." << endl; }
+	else { cerr << calcType << " complete with errors." << endl; }
+	return ( error == 0 ) ? regressions : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main method to run the program.
+// The exit status is nonzero if the benchmark failed or a timing regressed.
+///////////////////////////////////////////////////////////////////////////////
+int main( int argc, char* argv[] ) {
+
+	Bench* runner = new Bench();
+	bool parseable = runner->parse( argc, argv );
+	int regressions = 0;
+	if( parseable == true ) { regressions = runner->run(); }
+	delete runner;
+	return ( regressions != 0 ) ? 1 : 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * A program that times the folding calculations over a set of sequences and reactivity profiles.
+ * The timings are written to a baseline file and can be compared with a stored reference.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <map>
+#include "../RNA_class/RNA.h"
+#include "../src/ErrorChecker.h"
+#include "../src/ParseCommandLine.h"
+
+class Bench {
+ public:
+	// Public constructor and methods.
+
+	/*
+	 * Name:        Constructor.
+	 * Description: Initializes all private variables.
+	 */
+	Bench();
+
+	/*
+	 * Name:        parse
+	 * Description: Parses command line arguments to determine what options are required for a particular calculation.
+	 * Arguments:
+	 *     1.   The number of command line arguments.
+	 *     2.   The command line arguments themselves.
+	 * Returns:
+	 *     True if parsing completed without errors, false if not.
+	 */
+	bool parse( int argc, char** argv );
+
+	/*
+	 * Name:        run
+	 * Description: Run calculations.
+	 * Returns:
+	 *     The number of timings that regressed against the reference, or -1 if the benchmark could not be run.
+	 */
+	int run();
+
+ private:
+	// Private variables.
+
+	// Description of the calculation type.
+	string calcType;
+
+	// Input and output file names.
+	string dataDir;          // The data directory, holding ct_sequence_file/*.fa and shape_raw/*.shape.
+	string baselineFile;     // The output baseline file.
+	string referenceFile;    // The optional reference baseline file.
+
+	// The shortest and longest sequences that are timed.
+	int minLength;
+	int maxLength;
+
+	// The number of times each calculation is repeated; the fastest time is kept.
+	int repeats;
+
+	// The fraction by which a time or peak memory may exceed the reference before it is flagged.
+	double tolerance;
+
+	// Times shorter than this, in seconds, are too noisy to be flagged.
+	double minSeconds;
+
+	// One sequence of the data set.
+	struct BenchSequence {
+		string name;           // The name shared by the sequence and reactivity files.
+		string seqFile;        // The input sequence file.
+		string SHAPEFile;      // The input SHAPE profile.
+		int length;            // The sequence length.
+	};
+
+	// One timed calculation.
+	struct BenchResult {
+		string name;           // The sequence name.
+		int length;            // The sequence length.
+		string mode;           // 3state, 2s or smooth.
+		string stage;          // mfe, fold, pf, stochastic or maxexpect.
+		double seconds;        // The wall time.
+		long peakRSS;          // The peak resident set size during the calculation, in kB.
+		int structures;        // The number of structures generated, 0 for the partition function.
+	};
+
+	// Auxiliary functions used to run the benchmark.
+	bool readSequences( vector<BenchSequence>& sequences );
+	RNA* prepareStrand( RNA* master, const BenchSequence& sequence, const string& mode );
+	int timeSequence( RNA* master, const BenchSequence& sequence, const string& mode, vector<BenchResult>& results );
+	int compareReference( const vector<BenchResult>& results );
+};
+
+#endif /* BENCH_H */
@@ -70,20 +70,94 @@ RNA_FILES = \
 	${ROOTPATH}/src/forceclass.o \
 	${ROOTPATH}/src/MaxExpect.o \
 	${ROOTPATH}/src/MaxExpectStack.o \
+	${ROOTPATH}/src/minplus.o \
 	${ROOTPATH}/src/outputconstraints.o \
 	${ROOTPATH}/src/pfunction.o \
 	${ROOTPATH}/src/probknot.o \
+	${ROOTPATH}/src/pairbonus.o \
+	${ROOTPATH}/src/profile.o \
 	${ROOTPATH}/src/random.o \
+	${ROOTPATH}/src/reactivityfile.o \
+	${ROOTPATH}/src/pairmarks.o \
+	${ROOTPATH}/src/savemapping.o \
 	${ROOTPATH}/src/rna_library.o \
 	${ROOTPATH}/src/stackclass.o \
 	${ROOTPATH}/src/stackstruct.o \
 	${ROOTPATH}/src/stochastic.o \
+	${ROOTPATH}/src/thermosnapshot.o \
 	${ROOTPATH}/src/structure.o \
     ${ROOTPATH}/src/histData.o \
     ${ROOTPATH}/src/histSet.o \
 	${TPROGRESSDIR}/TProgressDialog.o \
 	${PROGRESSMONITOR}
 
+# Common files for the RNA library, for SMP calculations.
+RNA_FILES_SMP = \
+	${ROOTPATH}/RNA_class/RNA.o \
+	${ROOTPATH}/RNA_class/thermodynamics.o \
+	${ROOTPATH}/src/algorithm-smp.o \
+	${ROOTPATH}/src/alltrace.o \
+	${ROOTPATH}/src/arrayclass.o \
+	${ROOTPATH}/src/dotarray.o \
+	${ROOTPATH}/src/draw.o \
+	${ROOTPATH}/src/extended_double.o \
+	${ROOTPATH}/src/forceclass.o \
+	${ROOTPATH}/src/MaxExpect-smp.o \
+	${ROOTPATH}/src/MaxExpectStack.o \
+	${ROOTPATH}/src/minplus.o \
+	${ROOTPATH}/src/outputconstraints.o \
+	${ROOTPATH}/src/pfunction-smp.o \
+	${ROOTPATH}/src/probknot.o \
+	${ROOTPATH}/src/pairbonus.o \
+	${ROOTPATH}/src/profile-smp.o \
+	${ROOTPATH}/src/random.o \
+	${ROOTPATH}/src/reactivityfile.o \
+	${ROOTPATH}/src/pairmarks.o \
+	${ROOTPATH}/src/savemapping.o \
+	${ROOTPATH}/src/rna_library.o \
+	${ROOTPATH}/src/stackclass.o \
+	${ROOTPATH}/src/stackstruct.o \
+	${ROOTPATH}/src/stochastic-smp.o \
+	${ROOTPATH}/src/thermosnapshot.o \
+	${ROOTPATH}/src/structure.o \
+    ${ROOTPATH}/src/histData.o \
+    ${ROOTPATH}/src/histSet.o \
+	${TPROGRESSDIR}/TProgressDialog.o \
+	${PROGRESSMONITOR}
+
+# Common files for the RNA library, for the profiling build, which counts the calls to the free energy functions.
+RNA_FILES_PROFILE = \
+	${ROOTPATH}/RNA_class/RNA.o \
+	${ROOTPATH}/RNA_class/thermodynamics.o \
+	${ROOTPATH}/src/algorithm.o \
+	${ROOTPATH}/src/alltrace.o \
+	${ROOTPATH}/src/arrayclass.o \
+	${ROOTPATH}/src/dotarray.o \
+	${ROOTPATH}/src/draw.o \
+	${ROOTPATH}/src/extended_double.o \
+	${ROOTPATH}/src/forceclass.o \
+	${ROOTPATH}/src/MaxExpect.o \
+	${ROOTPATH}/src/MaxExpectStack.o \
+	${ROOTPATH}/src/minplus.o \
+	${ROOTPATH}/src/outputconstraints.o \
+	${ROOTPATH}/src/pfunction.o \
+	${ROOTPATH}/src/probknot.o \
+	${ROOTPATH}/src/pairbonus.o \
+	${ROOTPATH}/src/profile-profile.o \
+	${ROOTPATH}/src/random.o \
+	${ROOTPATH}/src/reactivityfile.o \
+	${ROOTPATH}/src/pairmarks.o \
+	${ROOTPATH}/src/savemapping.o \
+	${ROOTPATH}/src/rna_library-profile.o \
+	${ROOTPATH}/src/stackclass.o \
+	${ROOTPATH}/src/stackstruct.o \
+	${ROOTPATH}/src/stochastic.o \
+	${ROOTPATH}/src/thermosnapshot.o \
+	${ROOTPATH}/src/structure.o \
+    ${ROOTPATH}/src/histData.o \
+    ${ROOTPATH}/src/histSet.o \
+	${TPROGRESSDIR}/TProgressDialog.o \
+	${PROGRESSMONITOR}
 
 
 
@@ -93,7 +167,12 @@ RNA_FILES = \
 ##########
 
 ${ROOTPATH}/fold/Fold.o: \
-	${ROOTPATH}/fold/Fold.cpp ${ROOTPATH}/fold/Fold.h
+	${ROOTPATH}/fold/Fold.cpp ${ROOTPATH}/fold/Fold.h ${ROOTPATH}/src/profile.h ${ROOTPATH}/src/reactivityfile.h
+
+${ROOTPATH}/fold/Fold-smp.o: \
+	${ROOTPATH}/fold/Fold.cpp ${ROOTPATH}/fold/Fold.h ${ROOTPATH}/src/profile.h ${ROOTPATH}/src/reactivityfile.h
+	${CXX} -c ${CXXOPENMPFLAGS} \
+	-o ${ROOTPATH}/fold/Fold-smp.o ${ROOTPATH}/fold/Fold.cpp
 
 
 ${ROOTPATH}/RNA_class/Dynalign_class.o: RNA_class/Dynalign_class.cpp
@@ -124,12 +203,12 @@ ${ROOTPATH}/RNA_class/HybridRNA.o: \
 	${ROOTPATH}/src/rna_library.h \
 	${ROOTPATH}/src/stackclass.h \
 	${ROOTPATH}/src/stackstruct.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${TPROGRESSDIR}/TProgressDialog.h
 
 ${ROOTPATH}/RNA_class/HybridRNA_class.o: \
 	${ROOTPATH}/RNA_class/HybridRNA_class.cpp \
-	${ROOTPATH}/src/structure.h
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h
 
 ${ROOTPATH}/RNA_class/Multifind_object.o: \
 	${ROOTPATH}/RNA_class/Multifind_object.cpp ${ROOTPATH}/RNA_class/Multifind_object.h
@@ -156,7 +235,7 @@ ${ROOTPATH}/RNA_class/Multilign_object.o: \
 	${ROOTPATH}/src/rna_library.h \
 	${ROOTPATH}/src/stackclass.h \
 	${ROOTPATH}/src/stackstruct.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${ROOTPATH}/src/TProgressDialog.h \
 	${ROOTPATH}/src/varray.h \
 	${ROOTPATH}/src/wendarray.h
@@ -183,7 +262,7 @@ ${ROOTPATH}/RNA_class/Multilign_object-Multifind.o: \
 	${ROOTPATH}/src/rna_library.h \
 	${ROOTPATH}/src/stackclass.h \
 	${ROOTPATH}/src/stackstruct.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${ROOTPATH}/src/TProgressDialog.h \
 	${ROOTPATH}/src/varray.h \
 	${ROOTPATH}/src/wendarray.h
@@ -214,7 +293,7 @@ ${ROOTPATH}/RNA_class/RNA.o: \
 	${ROOTPATH}/src/stackclass.h \
 	${ROOTPATH}/src/stackstruct.h \
 	${ROOTPATH}/src/stochastic.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
     ${ROOTPATH}/src/histData.h \
     ${ROOTPATH}/src/histSet.h \
 	${TPROGRESSDIR}/TProgressDialog.h
@@ -239,16 +318,17 @@ ${ROOTPATH}/RNA_class/RNA_dynalign_ii.o: \
 	${ROOTPATH}/src/stackclass.h \
 	${ROOTPATH}/src/stackstruct.h \
 	${ROOTPATH}/src/stochastic.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${TPROGRESSDIR}/TProgressDialog.h
 	${COMPILE_DYNALIGN_II} ${ROOTPATH}/RNA_class/RNA.cpp
 
 ${ROOTPATH}/RNA_class/RNA_class.o: \
 	${ROOTPATH}/RNA_class/RNA_class.cpp \
-	${ROOTPATH}/src/structure.h
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h
 
 ${ROOTPATH}/RNA_class/thermodynamics.o: \
-	${ROOTPATH}/RNA_class/thermodynamics.cpp ${ROOTPATH}/RNA_class/thermodynamics.h
+	${ROOTPATH}/RNA_class/thermodynamics.cpp ${ROOTPATH}/RNA_class/thermodynamics.h \
+	${ROOTPATH}/src/profile.h ${ROOTPATH}/src/thermosnapshot.h ${ROOTPATH}/src/savemapping.h
 
 ${ROOTPATH}/RNA_class/TwoRNA.o: \
 	${ROOTPATH}/RNA_class/RNA.cpp ${ROOTPATH}/RNA_class/RNA.h \
@@ -265,9 +345,18 @@ ${ROOTPATH}/RNA_class/TwoRNA.o: \
 	${ROOTPATH}/src/rna_library.h \
 	${ROOTPATH}/src/stackclass.h \
 	${ROOTPATH}/src/stackstruct.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${TPROGRESSDIR}/TProgressDialog.h
 															
+${ROOTPATH}/bench/Bench.o: \
+	${ROOTPATH}/bench/Bench.cpp ${ROOTPATH}/bench/Bench.h
+
+${ROOTPATH}/thermo/ThermoSnapshot.o: \
+	${ROOTPATH}/thermo/ThermoSnapshot.cpp ${ROOTPATH}/thermo/ThermoSnapshot.h ${ROOTPATH}/src/thermosnapshot.h
+
+${ROOTPATH}/reactivity/ReactivityConverter.o: \
+	${ROOTPATH}/reactivity/ReactivityConverter.cpp ${ROOTPATH}/reactivity/ReactivityConverter.h ${ROOTPATH}/src/reactivityfile.h
+
 ${ROOTPATH}/scorer/Scorer_Interface.o: \
 	${ROOTPATH}/scorer/Scorer_Interface.cpp ${ROOTPATH}/scorer/Scorer_Interface.h
 
@@ -278,11 +367,15 @@ ${ROOTPATH}/src/algorithm.o: \
 	${ROOTPATH}/src/defines.h \
 	${ROOTPATH}/src/dotarray.h \
 	${ROOTPATH}/src/forceclass.h \
+	${ROOTPATH}/src/minplus.h \
+	${ROOTPATH}/src/pairmarks.h \
+	${ROOTPATH}/src/savemapping.h \
 	${ROOTPATH}/src/platform.h \
 	${ROOTPATH}/src/rna_library.h \
 	${ROOTPATH}/src/stackclass.h \
 	${ROOTPATH}/src/stackstruct.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/profile.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
     ${ROOTPATH}/src/histData.h \
     ${ROOTPATH}/src/histSet.h \
 	${TPROGRESSDIR}/TProgressDialog.h
@@ -293,11 +386,15 @@ ${ROOTPATH}/src/algorithm-smp.o: \
 	${ROOTPATH}/src/defines.h \
 	${ROOTPATH}/src/dotarray.h \
 	${ROOTPATH}/src/forceclass.h \
+	${ROOTPATH}/src/minplus.h \
+	${ROOTPATH}/src/pairmarks.h \
+	${ROOTPATH}/src/savemapping.h \
 	${ROOTPATH}/src/platform.h \
+	${ROOTPATH}/src/profile.h \
 	${ROOTPATH}/src/rna_library.h \
 	${ROOTPATH}/src/stackclass.h \
 	${ROOTPATH}/src/stackstruct.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${TPROGRESSDIR}/TProgressDialog.h
 	${CXX} -c ${CXXOPENMPFLAGS} \
 	-o ${ROOTPATH}/src/algorithm-smp.o ${ROOTPATH}/src/algorithm.cpp 
@@ -313,7 +410,7 @@ ${ROOTPATH}/src/algorithm_dynalign_ii.o: \
 	${ROOTPATH}/src/rna_library.h \
 	${ROOTPATH}/src/stackclass.h \
 	${ROOTPATH}/src/stackstruct.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${TPROGRESSDIR}/TProgressDialog.h
 	${COMPILE_DYNALIGN_II} ${ROOTPATH}/src/algorithm.cpp
 
@@ -327,21 +424,21 @@ ${ROOTPATH}/src/algorithm_instrumented.o: \
 	${ROOTPATH}/src/rna_library.h \
 	${ROOTPATH}/src/stackclass.h \
 	${ROOTPATH}/src/stackstruct.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${TPROGRESSDIR}/TProgressDialog.h
 	${COMPILE_INSTRUMENTED} ${ROOTPATH}/src/algorithm.cpp
 
 ${ROOTPATH}/src/alltrace.o: \
 	${ROOTPATH}/src/alltrace.cpp ${ROOTPATH}/src/alltrace.h \
 	${ROOTPATH}/src/defines.h \
-	${ROOTPATH}/src/structure.h
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h ${ROOTPATH}/src/arrayclass.h
 
 ${ROOTPATH}/src/alltrace_intermolecular.o: \
 	${ROOTPATH}/src/alltrace_intermolecular.cpp ${ROOTPATH}/src/alltrace_intermolecular.h
 
 ${ROOTPATH}/src/arrayclass.o: \
 	${ROOTPATH}/src/arrayclass.cpp ${ROOTPATH}/src/arrayclass.h \
-	${ROOTPATH}/src/defines.h
+	${ROOTPATH}/src/defines.h ${ROOTPATH}/src/savemapping.h
 
 ${ROOTPATH}/src/bimol.o: \
 	${ROOTPATH}/src/bimol.cpp ${ROOTPATH}/src/bimol.h
@@ -374,7 +471,7 @@ ${ROOTPATH}/src/dynalign.o: \
 	${ROOTPATH}/src/forceclass.h \
 	${ROOTPATH}/src/platform.h \
 	${ROOTPATH}/src/rna_library.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${ROOTPATH}/src/varray.h \
 	${ROOTPATH}/src/wendarray.h \
 	${TPROGRESSDIR}/TProgressDialog.h
@@ -394,7 +491,7 @@ ${ROOTPATH}/src/dynalign-smp.o: \
 	${ROOTPATH}/src/rankmanager.h \
 	${ROOTPATH}/src/rankproducer.h \
 	${ROOTPATH}/src/rna_library.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${ROOTPATH}/src/TProgressDialog.h \
 	${ROOTPATH}/src/varray.h \
 	${ROOTPATH}/src/wendarray.h
@@ -411,7 +508,7 @@ ${ROOTPATH}/src/dynalign_ii.o: \
 	${ROOTPATH}/src/forceclass.h \
 	${ROOTPATH}/src/platform.h \
 	${ROOTPATH}/src/rna_library.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${ROOTPATH}/src/varray.h \
 	${ROOTPATH}/src/wendarray.h \
 	${TPROGRESSDIR}/TProgressDialog.h
@@ -428,7 +525,7 @@ ${ROOTPATH}/src/dynalign_ii-smp.o: \
 	${ROOTPATH}/src/forceclass.h \
 	${ROOTPATH}/src/platform.h \
 	${ROOTPATH}/src/rna_library.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${ROOTPATH}/src/varray.h \
 	${ROOTPATH}/src/wendarray.h \
 	${TPROGRESSDIR}/TProgressDialog.h
@@ -457,7 +554,7 @@ ${ROOTPATH}/src/extended_double.o: \
 	${ROOTPATH}/src/extended_double.cpp ${ROOTPATH}/src/extended_double.h
 
 ${ROOTPATH}/src/forceclass.o: \
-	${ROOTPATH}/src/forceclass.cpp ${ROOTPATH}/src/forceclass.h
+	${ROOTPATH}/src/forceclass.cpp ${ROOTPATH}/src/forceclass.h ${ROOTPATH}/src/savemapping.h
 
 ${ROOTPATH}/src/intermolecular.o: \
 	${ROOTPATH}/src/intermolecular.cpp ${ROOTPATH}/src/intermolecular.h \
@@ -465,7 +562,15 @@ ${ROOTPATH}/src/intermolecular.o: \
 
 ${ROOTPATH}/src/MaxExpect.o: \
 	${ROOTPATH}/src/defines.h \
-	${ROOTPATH}/src/MaxExpect.cpp ${ROOTPATH}/src/MaxExpect.h
+	${ROOTPATH}/src/MaxExpect.cpp ${ROOTPATH}/src/MaxExpect.h \
+	${ROOTPATH}/src/pfunction.h ${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h ${ROOTPATH}/src/arrayclass.h
+
+${ROOTPATH}/src/MaxExpect-smp.o: \
+	${ROOTPATH}/src/defines.h \
+	${ROOTPATH}/src/MaxExpect.cpp ${ROOTPATH}/src/MaxExpect.h \
+	${ROOTPATH}/src/pfunction.h ${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h ${ROOTPATH}/src/arrayclass.h
+	${CXX} -c ${CXXOPENMPFLAGS} \
+	-o ${ROOTPATH}/src/MaxExpect-smp.o ${ROOTPATH}/src/MaxExpect.cpp 
 
 ${ROOTPATH}/src/MaxExpectStack.o: \
 	${ROOTPATH}/src/MaxExpectStack.cpp ${ROOTPATH}/src/MaxExpectStack.h
@@ -500,21 +605,57 @@ ${ROOTPATH}/src/pclass.o: \
 	${ROOTPATH}/src/pclass.cpp ${ROOTPATH}/src/pclass.h
 
 ${ROOTPATH}/src/probknot.o: \
-	${ROOTPATH}/src/probknot.cpp ${ROOTPATH}/src/probknot.h
+	${ROOTPATH}/src/probknot.cpp ${ROOTPATH}/src/probknot.h \
+	${ROOTPATH}/src/pfunction.h ${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h ${ROOTPATH}/src/arrayclass.h
 
 ${ROOTPATH}/src/pfunction.o: \
 	${ROOTPATH}/src/pfunction.cpp ${ROOTPATH}/src/pfunction.h ${ROOTPATH}/src/boltzmann.h \
-	${ROOTPATH}/src/algorithm.h ${ROOTPATH}/src/structure.h  
+	${ROOTPATH}/src/algorithm.h ${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h ${ROOTPATH}/src/arrayclass.h \
+	${ROOTPATH}/src/savemapping.h
 
 ${ROOTPATH}/src/pfunction-smp.o: \
 	${ROOTPATH}/src/pfunction.cpp ${ROOTPATH}/src/pfunction.h ${ROOTPATH}/src/boltzmann.h \
-	${ROOTPATH}/src/algorithm.h ${ROOTPATH}/src/structure.h  
+	${ROOTPATH}/src/algorithm.h ${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h ${ROOTPATH}/src/arrayclass.h \
+	${ROOTPATH}/src/savemapping.h
 	${CXX} -c ${CXXOPENMPFLAGS} \
 	-o ${ROOTPATH}/src/pfunction-smp.o ${ROOTPATH}/src/pfunction.cpp
 
+${ROOTPATH}/src/minplus.o: \
+	${ROOTPATH}/src/minplus.cpp ${ROOTPATH}/src/minplus.h ${ROOTPATH}/src/defines.h
+
+${ROOTPATH}/src/pairbonus.o: \
+	${ROOTPATH}/src/pairbonus.cpp ${ROOTPATH}/src/pairbonus.h
+
 ${ROOTPATH}/src/phmm.o: \
     ${ROOTPATH}/src/phmm.cpp ${ROOTPATH}/src/phmm.h
 
+${ROOTPATH}/src/profile.o: \
+	${ROOTPATH}/src/profile.cpp ${ROOTPATH}/src/profile.h ${ROOTPATH}/src/minplus.h
+
+${ROOTPATH}/src/profile-smp.o: \
+	${ROOTPATH}/src/profile.cpp ${ROOTPATH}/src/profile.h ${ROOTPATH}/src/minplus.h
+	${CXX} -c ${CXXOPENMPFLAGS} \
+	-o ${ROOTPATH}/src/profile-smp.o ${ROOTPATH}/src/profile.cpp
+
+${ROOTPATH}/src/profile-profile.o: \
+	${ROOTPATH}/src/profile.cpp ${ROOTPATH}/src/profile.h ${ROOTPATH}/src/minplus.h
+	${CXX} -c -D PROFILECOUNTS ${CXXFLAGS} \
+	-o ${ROOTPATH}/src/profile-profile.o ${ROOTPATH}/src/profile.cpp
+
+${ROOTPATH}/src/savemapping.o: \
+	${ROOTPATH}/src/savemapping.cpp ${ROOTPATH}/src/savemapping.h
+
+${ROOTPATH}/src/pairmarks.o: \
+	${ROOTPATH}/src/pairmarks.cpp ${ROOTPATH}/src/pairmarks.h
+
+${ROOTPATH}/src/reactivityfile.o: \
+	${ROOTPATH}/src/reactivityfile.cpp ${ROOTPATH}/src/reactivityfile.h ${ROOTPATH}/src/savemapping.h \
+	${ROOTPATH}/src/defines.h
+
+${ROOTPATH}/src/thermosnapshot.o: \
+	${ROOTPATH}/src/thermosnapshot.cpp ${ROOTPATH}/src/thermosnapshot.h ${ROOTPATH}/src/savemapping.h \
+	${ROOTPATH}/src/rna_library.h ${ROOTPATH}/src/defines.h
+
 ${ROOTPATH}/src/random.o: \
 	${ROOTPATH}/src/random.cpp ${ROOTPATH}/src/random.h
 
@@ -529,7 +670,7 @@ ${ROOTPATH}/src/rankconsumer.o: \
 	${ROOTPATH}/src/rankconsumer.cpp ${ROOTPATH}/src/rankconsumer.h \
 	${ROOTPATH}/src/rankmanager.h \
 	${ROOTPATH}/src/rna_library.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${ROOTPATH}/src/varray.h \
 	${ROOTPATH}/src/wendarray.h \
 	${ROOTPATH}/src/workslice.h
@@ -540,7 +681,7 @@ ${ROOTPATH}/src/rankconsumer_ii.o: \
 	${ROOTPATH}/src/rankconsumer.cpp ${ROOTPATH}/src/rankconsumer.h \
 	${ROOTPATH}/src/rankmanager.h \
 	${ROOTPATH}/src/rna_library.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${ROOTPATH}/src/varray.h \
 	${ROOTPATH}/src/wendarray.h \
 	${ROOTPATH}/src/workslice.h
@@ -562,8 +703,18 @@ ${ROOTPATH}/src/rankproducer.o: \
 ${ROOTPATH}/src/rna_library.o: \
 	${ROOTPATH}/src/defines.h \
 	${ROOTPATH}/src/platform.h \
+	${ROOTPATH}/src/profile.h \
+	${ROOTPATH}/src/rna_library.cpp ${ROOTPATH}/src/rna_library.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h
+
+${ROOTPATH}/src/rna_library-profile.o: \
+	${ROOTPATH}/src/defines.h \
+	${ROOTPATH}/src/platform.h \
+	${ROOTPATH}/src/profile.h \
 	${ROOTPATH}/src/rna_library.cpp ${ROOTPATH}/src/rna_library.h \
-	${ROOTPATH}/src/structure.h
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h
+	${CXX} -c -D PROFILECOUNTS ${CXXFLAGS} \
+	-o ${ROOTPATH}/src/rna_library-profile.o ${ROOTPATH}/src/rna_library.cpp
 
 ${ROOTPATH}/src/pkHelix.o: \
 	${ROOTPATH}/src/pkHelix.cpp ${ROOTPATH}/src/pkHelix.h
@@ -591,10 +742,12 @@ ${ROOTPATH}/src/stackstruct.o: \
 	${ROOTPATH}/src/stackstruct.cpp ${ROOTPATH}/src/stackstruct.h
 
 ${ROOTPATH}/src/stochastic.o: \
-	${ROOTPATH}/src/stochastic.cpp ${ROOTPATH}/src/stochastic.h
+	${ROOTPATH}/src/stochastic.cpp ${ROOTPATH}/src/stochastic.h \
+	${ROOTPATH}/src/pfunction.h ${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h ${ROOTPATH}/src/arrayclass.h
 
 ${ROOTPATH}/src/stochastic-smp.o: \
-	${ROOTPATH}/src/stochastic.cpp ${ROOTPATH}/src/stochastic.h
+	${ROOTPATH}/src/stochastic.cpp ${ROOTPATH}/src/stochastic.h \
+	${ROOTPATH}/src/pfunction.h ${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h ${ROOTPATH}/src/arrayclass.h
 	${CXX} -c ${CXXOPENMPFLAGS} \
 	-o ${ROOTPATH}/src/stochastic-smp.o ${ROOTPATH}/src/stochastic.cpp 
 
@@ -602,7 +755,8 @@ ${ROOTPATH}/src/structure.o: \
 	${ROOTPATH}/src/defines.h \
     ${ROOTPATH}/src/histSet.h \
 	${ROOTPATH}/src/platform.h \
-	${ROOTPATH}/src/structure.cpp ${ROOTPATH}/src/structure.h
+	${ROOTPATH}/src/profile.h \
+	${ROOTPATH}/src/structure.cpp ${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h
 
 ${ROOTPATH}/src/histData.o: \
     ${ROOTPATH}/src/histData.cpp ${ROOTPATH}/src/histData.h
@@ -639,7 +793,7 @@ ${ROOTPATH}/src/ShapeKnots.o: \
 	${ROOTPATH}/src/pkHelix.h \
 	${ROOTPATH}/src/PseudoParser.h \
 	${ROOTPATH}/src/rna_library.h \
-	${ROOTPATH}/src/structure.h \
+	${ROOTPATH}/src/structure.h ${ROOTPATH}/src/pairbonus.h \
 	${ROOTPATH}/src/algorithm.h \
 	${ROOTPATH}/src/ParseCommandLine.h \
 	${ROOTPATH}/RNA_class/RNA.h
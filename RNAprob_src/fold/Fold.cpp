@@ -7,6 +7,10 @@
  */
 
 #include "Fold.h"
+#include "../src/profile.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
 #include <time.h>
 ///////////////////////////////////////////////////////////////////////////////
 // Constructor.
@@ -37,6 +41,9 @@ Fold::Fold() {
 	// Initialize the maximum pairing distance between nucleotides.
 	maxDistance = -1;
 
+	// Initialize the fill tile size.
+	fillTile = 0;
+
 	// Initialize the maximum number of structures.
 	maxStructures = 20;
 
@@ -58,6 +65,13 @@ Fold::Fold() {
 	// Initialize the calculation temperature.
 	bootstrap = 0;
 
+	// Initialize the bootstrap and sampling seed (-1 means the current time is used).
+	seed = -1;
+
+	// Initialize the number of sampled structures (the sequence is folded).
+	samples = 0;
+	sampleBinary = false;
+
 	// Initialize the folding window size.
 	windowSize = -1;
 
@@ -73,6 +87,12 @@ Fold::Fold() {
 	
 	// Initialize the decoder to be empirical version
 	smoothVersion = false;
+
+	// Initialize the batch mode (a single sequence is folded).
+	batch = false;
+
+	// Initialize the local fold span (the whole sequence is folded).
+	localSpan = -1;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -232,8 +252,61 @@ bool Fold::parse( int argc, char** argv ) {
 	bootstrapOptions.push_back( "-boot" );
 	bootstrapOptions.push_back( "-B" );
 	bootstrapOptions.push_back( "--bootstrap" );
-	parser->addOptionFlagsWithParameters( bootstrapOptions, "Specify the number of bootstrap iterations to be done to retrieve base pair confidence. Defaults to no bootstrapping." );
-
+	parser->addOptionFlagsWithParameters( bootstrapOptions, "Specify the number of bootstrap iterations to be done to retrieve base pair confidence. The confidence of each pair is written to <ct file>.boot. Defaults to no bootstrapping." );
+
+	// Add the bootstrap seed option.
+	vector<string> seedOptions;
+	seedOptions.push_back( "-seed" );
+	seedOptions.push_back( "--seed" );
+	parser->addOptionFlagsWithParameters( seedOptions, "Specify the random seed used to resample reactivities for bootstrapping, or to sample structures with -sample. Defaults to the current time." );
+
+	// Add the stochastic sampling option.
+	vector<string> sampleOptions;
+	sampleOptions.push_back( "-sample" );
+	sampleOptions.push_back( "--sample" );
+	parser->addOptionFlagsWithParameters( sampleOptions, "Specify a number of structures to sample from the Boltzmann ensemble, instead of folding. The structures are written to <ct file> as they are sampled, one per line in dot-bracket notation after a line with the sequence, so any number can be sampled; RNAprob-smp samples them in parallel. The frequency of each sampled pair is written to <ct file>.pairs, and the frequency with which each nucleotide is unpaired to <ct file>.unpaired. Default is to fold." );
+
+	// Add the binary sample option.
+	vector<string> sampleBinaryOptions;
+	sampleBinaryOptions.push_back( "-samplebinary" );
+	sampleBinaryOptions.push_back( "--sampleBinary" );
+	parser->addOptionFlagsNoParameters( sampleBinaryOptions, "Specify that the structures sampled with -sample are written as binary pair lists: a header with the sequence length, then for each structure the number of pairs and the nucleotides of each pair, as 4-byte integers. Default is dot-bracket notation." );
+
+	// Add the maximum expected accuracy option.
+	vector<string> maxExpectOptions;
+	maxExpectOptions.push_back( "-maxexpect" );
+	maxExpectOptions.push_back( "--maxExpect" );
+	parser->addOptionFlagsWithParameters( maxExpectOptions, "Specify weights (gamma) given to base pairs to predict maximum expected accuracy structures, instead of folding, as a comma-separated list (e.g. 0.5,1,2) or as first:last:factor (e.g. 0.03125:32:2, each gamma the last times the factor). The partition function and the pair probabilities are calculated once for all of the gammas. The structures for each gamma are written to <ct file>.<gamma>; -p, -m and -w limit the suboptimal structures as in folding. Default is to fold." );
+
+	// Add the batch option.
+	vector<string> batchOptions;
+	batchOptions.push_back( "-batch" );
+	batchOptions.push_back( "--batch" );
+	parser->addOptionFlagsNoParameters( batchOptions, "Specify that <seq file> is a manifest with one \"<seq file> <reactivity file> <ct file> [SHAPE|DMS]\" line per sequence, and <ct file> is a summary file. The parameters are read once and the sequences are folded in parallel by RNAprob-smp. Use - for a sequence without reactivity data, and <file>#<ID> for the record of a transcript in a multi-transcript reactivity file (see RNAprob-reactivity). Constraint, offset, experimental bonus, save and bootstrap options are not used in batch mode. Default is to fold a single sequence." );
+
+	// Add the local fold option.
+	vector<string> localOptions;
+	localOptions.push_back( "-local" );
+	localOptions.push_back( "--local" );
+	parser->addOptionFlagsWithParameters( localOptions, "Specify a maximum pairing span for a local fold of a long sequence. The sequence is folded in windows of twice the span, each starting one span after the last, so the memory used does not grow with the sequence length. The lowest free energy structure of each window is written to <ct file> as it is folded, and the probability that each nucleotide is unpaired, averaged over the windows that contain it, to <ct file>.unpaired. Only the SHAPE, DMS and CMCT restraints, -2s, -smooth, -l and -t are used in a local fold. Default is to fold the whole sequence." );
+
+	// Add the temperature sweep option.
+	vector<string> sweepOptions;
+	sweepOptions.push_back( "-sweep" );
+	sweepOptions.push_back( "--sweep" );
+	parser->addOptionFlagsWithParameters( sweepOptions, "Specify temperatures in Kelvin at which the sequence is folded, as a comma-separated list (e.g. 300,310.15,320) or as first:last:step (e.g. 293.15:333.15:2). The parameters and the reactivities are read once, the parameters for each temperature are derived from them in memory, and the temperatures are folded in parallel by RNAprob-smp. The structures at each temperature are written to <ct file>.<temperature>, and the lowest free energy and status at each temperature to <ct file>. Only the SHAPE, differential SHAPE, DMS and CMCT restraints, -2s, -smooth, -md, -l, -m, -p, -w, -mfe and -tile are used in a sweep. Default is to fold at one temperature." );
+
+	// Add the fill tile option.
+	vector<string> tileOptions;
+	tileOptions.push_back( "-tile" );
+	tileOptions.push_back( "--tile" );
+	parser->addOptionFlagsWithParameters( tileOptions, "Specify the size of the tiles in which the dynamic programming arrays are filled. Tiles of about 64 nucleotides keep the fragments each tile reads in cache, and let RNAprob-smp fill tiles in parallel without waiting at the end of each diagonal. The structures are the same for any size. Default is 0, filling one diagonal at a time." );
+
+	// Add the profile option.
+	vector<string> profileOptions;
+	profileOptions.push_back( "-profile" );
+	profileOptions.push_back( "--profile" );
+	parser->addOptionFlagsWithParameters( profileOptions, "Specify the name of a file to which the timings of the main steps, the number of free energy function calls (counted only by RNAprob-profile), the internal loop candidates visited and the memory of the dynamic programming arrays are written, as JSON. In batch mode, these cover the whole batch. Default is not to write a profile." );
 
 	// Add the unpaired SHAPE intercept option.
 	vector<string> shapeInterceptUnpairedOptions;
@@ -261,7 +334,7 @@ bool Fold::parse( int argc, char** argv ) {
 	experimentalOptions.push_back( "-x" );
 	experimentalOptions.push_back( "-X" );
 	experimentalOptions.push_back( "--experimentalPairBonus" );
-	parser->addOptionFlagsWithParameters( experimentalOptions, "Input text file with bonuses (in kcal) as a matrix. As with SHAPE, bonuses will be applied twice to internal base pairs, once to edge base pairs, and not at all to single stranded regions. Default is no experimental pair bonus file specified." );
+	parser->addOptionFlagsWithParameters( experimentalOptions, "Input text file with bonuses (in kcal) as a matrix, or as one \"i j bonus\" line per pair with a bonus. As with SHAPE, bonuses will be applied twice to internal base pairs, once to edge base pairs, and not at all to single stranded regions. Default is no experimental pair bonus file specified." );
 
 	// Add the experimental pair bonus offset option.
 	vector<string> experimentalOffsetOptions;
@@ -377,6 +450,52 @@ bool Fold::parse( int argc, char** argv ) {
 		if( bootstrap < 0 ) { parser->setError( "bootstrap" ); }
 	}
 
+	// Get the bootstrap seed.
+	if( !parser->isError() ) {
+		parser->setOptionInteger( seedOptions, seed );
+		if( seed < -1 ) { parser->setError( "seed" ); }
+	}
+
+	// Get the stochastic sampling options.
+	if( !parser->isError() ) {
+		parser->setOptionInteger( sampleOptions, samples );
+		if( samples < 0 ) { parser->setError( "number of samples" ); }
+	}
+	if( !parser->isError() ) { sampleBinary = parser->contains( sampleBinaryOptions ); }
+
+	// Get the maximum expected accuracy gammas.
+	if( !parser->isError() ) {
+		string list = parser->getOptionString( maxExpectOptions, false );
+		if( list != "" && !readGammas( list ) ) { parser->setError( "maximum expected accuracy gammas" ); }
+	}
+
+	// Get the batch option.
+	if( !parser->isError() ) { batch = parser->contains( batchOptions ); }
+
+	// Get the local fold span.
+	if( !parser->isError() ) {
+		parser->setOptionInteger( localOptions, localSpan );
+		bool badSpan =
+		  ( localSpan <= minloop + 1 ) &&
+		  ( localSpan != -1 );
+		if( badSpan ) { parser->setError( "local span" ); }
+	}
+
+	// Get the temperature sweep.
+	if( !parser->isError() ) {
+		string list = parser->getOptionString( sweepOptions, false );
+		if( list != "" && !readSweep( list ) ) { parser->setError( "temperature sweep" ); }
+	}
+
+	// Get the fill tile option.
+	if( !parser->isError() ) {
+		parser->setOptionInteger( tileOptions, fillTile );
+		if( fillTile < 0 ) { parser->setError( "fill tile size" ); }
+	}
+
+	// Get the profile file name.
+	if( !parser->isError() ) { profileFile = parser->getOptionString( profileOptions, false ); }
+
 	// Get the window size option.
 	if( !parser->isError() ) {
 		parser->setOptionInteger( windowOptions, windowSize );
@@ -406,45 +525,971 @@ bool Fold::parse( int argc, char** argv ) {
 	return noError;
 }
 
-string Fold::sample_file(string shapefile, int numnuc, int iter) {
-	char numstr[21];
+///////////////////////////////////////////////////////////////////////////////
+// Read the temperatures of a sweep, given as a comma-separated list or as first:last:step.
+///////////////////////////////////////////////////////////////////////////////
+bool Fold::readSweep( string list ) {
+	double first, last, step;
+	char colon1, colon2;
+
+	istringstream range( list );
+	if( range >> first >> colon1 >> last >> colon2 >> step && colon1 == ':' && colon2 == ':' && range.eof() ) {
+		if( step <= 0 || last < first ) { return false; }
+
+		// Count the steps, so that rounding does not drop the last temperature.
+		int steps = (int) ( ( last - first ) / step + 1e-6 );
+		for( int i=0;i<=steps;i++ ) { sweepTemperatures.push_back( first + i * step ); }
+	}
+	else {
+		replace( list.begin(), list.end(), ',', ' ' );
+		istringstream values( list );
+		double value;
+		while( values >> value ) { sweepTemperatures.push_back( value ); }
+		if( !values.eof() ) { return false; }
+	}
+
+	for( unsigned int i=0;i<sweepTemperatures.size();i++ ) {
+		if( sweepTemperatures[i] < 0 ) { return false; }
+	}
+	return !sweepTemperatures.empty();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Read the gammas of maximum expected accuracy structures, given as a comma-separated list or as first:last:factor.
+///////////////////////////////////////////////////////////////////////////////
+bool Fold::readGammas( string list ) {
+	double first, last, factor;
+	char colon1, colon2;
+
+	istringstream range( list );
+	if( range >> first >> colon1 >> last >> colon2 >> factor && colon1 == ':' && colon2 == ':' && range.eof() ) {
+		if( first <= 0 || factor <= 1 || last < first ) { return false; }
+
+		// Count the steps, so that rounding does not drop the last gamma.
+		int steps = (int) ( log( last / first ) / log( factor ) + 1e-6 );
+		for( int i=0;i<=steps;i++ ) { gammas.push_back( first * pow( factor, (double) i ) ); }
+	}
+	else {
+		replace( list.begin(), list.end(), ',', ' ' );
+		istringstream values( list );
+		double value;
+		while( values >> value ) { gammas.push_back( value ); }
+		if( !values.eof() ) { return false; }
+	}
+
+	for( unsigned int i=0;i<gammas.size();i++ ) {
+		if( gammas[i] <= 0 ) { return false; }
+	}
+	return !gammas.empty();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Read a reactivity file into memory for bootstrapping.
+///////////////////////////////////////////////////////////////////////////////
+void Fold::readProfile( string shapefile, int numnuc, vector<double>& profile ) {
 	ifstream infile;
-	sprintf(numstr, "%d", iter);
-	string outname = shapefile + "_boot" + numstr;
-	ofstream outfile;
-	outfile.open(outname.c_str());
-	infile.open(shapefile.c_str());
-	double *SHAPEdata = new double [numnuc];
-	int index, ridx, i;
+	int index;
 	double value;
 
-	for( i=0;i<numnuc;i++ ) { SHAPEdata[i] = -999; }
+	// profile[i] is the reactivity of nucleotide i, -999 means no data.
+	profile.assign( numnuc + 1, -999 );
+
+	infile.open( shapefile.c_str() );
+	while( infile >> index >> value ) {
+		if( index >= 1 && index <= numnuc ) { profile[index] = value; }
+	}
+	infile.close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Resample a reactivity profile for one bootstrap replicate.
+///////////////////////////////////////////////////////////////////////////////
+void Fold::resampleProfile( const vector<double>& profile, randomnumber& rng, vector<int>& positions, vector<double>& sample ) {
+	int numnuc = (int) profile.size() - 1;
+	int i, ridx;
 
-	while( infile >> index >> value ) { SHAPEdata[index] = value; }
+	sample = profile;
 
-	srand( time(0) );
-	for( i=0;i<numnuc;i++ ) {
-		ridx = rand() % numnuc;
-		if( SHAPEdata[ridx] != -999 ) { SHAPEdata[ridx] += SHAPEdata[ridx]; }
+	// Draw numnuc nucleotides with replacement, the reactivity of a nucleotide is doubled each time it is drawn.
+	for( i=1;i<=numnuc;i++ ) {
+		ridx = rng.roll_int( 1, numnuc );
+		if( sample[ridx] != -999 ) { sample[ridx] += sample[ridx]; }
 	}
 
-	for( i=0;i<numnuc;i++ ) { outfile << i << " " << SHAPEdata[i] << "\n"; }
-	
-	outfile.close();
-	infile.close();
+	positions.resize( numnuc );
+	for( i=1;i<=numnuc;i++ ) { positions[i-1] = i; }
+	sample.erase( sample.begin() );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fold one bootstrap replicate.
+///////////////////////////////////////////////////////////////////////////////
+int Fold::foldReplicate( RNA* strand, int replicate, vector<int>& pairs ) {
+
+	// Each replicate gets its own strand, with the parameters taken from the strand that was already folded.
+	RNA* sample = new RNA( seqFile.c_str(), 2, isRNA );
+	int error = sample->GetErrorCode();
+	if( error == 0 ) { sample->ShareParameters( strand ); }
+
+	if( error == 0 && maxDistance != -1 ) { error = sample->ForceMaximumPairingDistance( maxDistance ); }
+
+	if( error == 0 ) {
+		sample->setStateType( twoStateVersion );
+		sample->setSmoothVersion( smoothVersion );
+		sample->setFillTile( fillTile );
+	}
+
+	// Each replicate has its own random number stream, so the result does not depend on the number of threads.
+	randomnumber rng;
+	rng.seed( seed + replicate );
+	vector<int> positions;
+	vector<double> reactivities;
+
+	// Apply the constraints in the same order as run().
+	if( error == 0 && constraintFile != "" ) { error = sample->ReadConstraints( constraintFile.c_str() ); }
+	if( error == 0 && SHAPEFile != "" ) {
+		resampleProfile( SHAPEProfile, rng, positions, reactivities );
+		error = sample->SetSHAPE( positions, reactivities, slope, intercept, slopeSingle, interceptSingle, "SHAPE" );
+	}
+	if( error == 0 && DSHAPEFile != "" ) {
+		resampleProfile( DSHAPEProfile, rng, positions, reactivities );
+		error = sample->SetSHAPE( positions, reactivities, Dslope, 0, 0, 0, "diffSHAPE" );
+	}
+	if( error == 0 && DMSFile != "" ) {
+		resampleProfile( DMSProfile, rng, positions, reactivities );
+		error = sample->SetSHAPE( positions, reactivities, slope, intercept, slopeSingle, interceptSingle, "DMS" );
+	}
+	if( error == 0 && CMCTFile != "" ) {
+		resampleProfile( CMCTProfile, rng, positions, reactivities );
+		error = sample->SetSHAPE( positions, reactivities, slope, intercept, slopeSingle, interceptSingle, "CMCT" );
+	}
+	if( error == 0 && singleOffsetFile != "" ) { error = sample->ReadSSO( singleOffsetFile.c_str() ); }
+	if( error == 0 && doubleOffsetFile != "" ) { error = sample->ReadDSO( doubleOffsetFile.c_str() ); }
+	if( error == 0 && experimentalFile != "" ) { error = sample->ReadExperimentalPairBonus( experimentalFile.c_str(), experimentalOffset, experimentalScaling ); }
+
+	// Only the lowest free energy structure of a replicate is used.
+	if( error == 0 ) { error = sample->FoldSingleStrand( percent, maxStructures, windowSize, "", maxLoop, true ); }
+
+	pairs.clear();
+	if( error == 0 ) {
+		for( int i=1;i<=sample->GetSequenceLength();i++ ) {
+			if( sample->GetPair( i ) > i ) {
+				pairs.push_back( i );
+				pairs.push_back( sample->GetPair( i ) );
+			}
+		}
+	}
+
+	delete sample;
+	return error;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Run the bootstrap replicates and write the confidence of each pair.
+///////////////////////////////////////////////////////////////////////////////
+int Fold::runBootstrap( RNA* strand ) {
+	int numnuc = strand->GetSequenceLength();
+	int replicates = (int) bootstrap;
+	int failed = 0;
+	int i;
+
+	if( seed == -1 ) { seed = (int) time( 0 ); }
+
+	// Read each reactivity file once.
+	if( SHAPEFile != "" ) { readProfile( SHAPEFile, numnuc, SHAPEProfile ); }
+	if( DSHAPEFile != "" ) { readProfile( DSHAPEFile, numnuc, DSHAPEProfile ); }
+	if( DMSFile != "" ) { readProfile( DMSFile, numnuc, DMSProfile ); }
+	if( CMCTFile != "" ) { readProfile( CMCTFile, numnuc, CMCTProfile ); }
+
+	// Read the reactivity histograms now, before they are shared between threads.
+	structure* source = strand->GetStructure();
+	if( !source->trainingParamRead ) {
+		source->ReadTrainingParam();
+		source->trainingParamRead = true;
+	}
+
+	// counts[i][j] is the number of replicates in which i is paired to j.
+	vector< map<int,int> > counts( numnuc + 1 );
+
+#ifdef SMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for( int replicate=1;replicate<=replicates;replicate++ ) {
+		vector<int> pairs;
+		int replicateError = foldReplicate( strand, replicate, pairs );
+
+#ifdef SMP
+#pragma omp critical
+#endif
+		{
+			if( replicateError != 0 ) { failed++; }
+			for( unsigned int p=0;p<pairs.size();p+=2 ) { counts[pairs[p]][pairs[p+1]]++; }
+		}
+	}
+
+	if( failed == replicates ) { return 1; }
+
+	// The pairs of the lowest free energy structure are always listed, even if no replicate has them.
+	for( i=1;i<=numnuc;i++ ) {
+		if( strand->GetPair( i ) > i ) { counts[i].insert( make_pair( strand->GetPair( i ), 0 ) ); }
+	}
+
+	ofstream out( ( ctFile + ".boot" ).c_str() );
+	if( !out ) { return 2; }
+	out << "# " << replicates - failed << " bootstrap replicates, seed " << seed << "\n";
+	out << "i\tj\tconfidence\tmfe\n";
+	for( i=1;i<=numnuc;i++ ) {
+		for( map<int,int>::iterator pair=counts[i].begin();pair!=counts[i].end();++pair ) {
+			out << i << "\t" << pair->first << "\t" << ( (double) pair->second / ( replicates - failed ) )
+				<< "\t" << ( strand->GetPair( i ) == pair->first ? 1 : 0 ) << "\n";
+		}
+	}
+	out.close();
+
+	if( failed > 0 ) { cerr << failed << " bootstrap replicates could not be folded.\n"; }
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Sample structures from the ensemble, streaming them to the ct file, and write the pair and unpaired frequencies.
+///////////////////////////////////////////////////////////////////////////////
+int Fold::runSample( RNA* strand ) {
+	int numnuc = strand->GetSequenceLength();
+	int i;
+
+	if( seed == -1 ) { seed = (int) time( 0 ); }
+
+	// The partition function, with the same reactivity model as folding.
+	int error = strand->PartitionFunction();
+	if( error != 0 ) { return error; }
+
+	// The samples are written as they are drawn, so only a few are held in memory at once.
+	ofstream out( ctFile.c_str(), sampleBinary ? ios::out | ios::binary : ios::out );
+	if( !out ) { return 2; }
+	if( !sampleBinary ) {
+		for( i=1;i<=numnuc;i++ ) { out << strand->GetNucleotide( i ); }
+		out << "\n";
+	}
+
+	stochasticstatistics statistics( numnuc );
+	error = strand->StochasticStream( samples, &out, sampleBinary ? STOCHASTIC_PAIRS : STOCHASTIC_DOTBRACKET, &statistics, seed );
+	out.close();
+	if( error != 0 ) { return error; }
+	if( out.fail() ) { return 2; }
+
+	ofstream pairsOut( ( ctFile + ".pairs" ).c_str() );
+	ofstream unpairedOut( ( ctFile + ".unpaired" ).c_str() );
+	if( !pairsOut || !unpairedOut ) { return 2; }
+
+	pairsOut << "# " << samples << " samples, seed " << seed << "\n";
+	pairsOut << "i\tj\tfrequency\n";
+	for( i=1;i<=numnuc;i++ ) {
+		vector< pair<int,int> > partners = statistics.partners( i );
+		sort( partners.begin(), partners.end() );
+		for( unsigned int p=0;p<partners.size();p++ ) {
+			pairsOut << i << "\t" << partners[p].first << "\t" << ( (double) partners[p].second / samples ) << "\n";
+		}
+	}
+
+	unpairedOut << "i\tnucleotide\tunpaired\n";
+	for( i=1;i<=numnuc;i++ ) {
+		unpairedOut << i << "\t" << strand->GetNucleotide( i ) << "\t" << statistics.unpairedfrequency( i ) << "\n";
+	}
+
+	pairsOut.close();
+	unpairedOut.close();
+	return ( pairsOut.fail() || unpairedOut.fail() ) ? 2 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Predict the maximum expected accuracy structures for each gamma, from one partition function.
+///////////////////////////////////////////////////////////////////////////////
+int Fold::runMaxExpect( RNA* strand ) {
+	structure* ct = strand->GetStructure();
+
+	// The partition function, with the same reactivity model as folding.
+	int error = strand->PartitionFunction();
+
+	// The pair probabilities are calculated for the first gamma and kept by the strand for the others.
+	for( unsigned int i=0;i<gammas.size() && error == 0;i++ ) {
+		while( ct->GetNumberofStructures() > 0 ) { ct->RemoveLastStructure(); }
+		error = strand->MaximizeExpectedAccuracy( percent, maxStructures, windowSize, gammas[i] );
+
+		if( error == 0 ) {
+			ostringstream name;
+			name << ctFile << "." << gammas[i];
+			error = strand->WriteCt( name.str().c_str() );
+		}
+	}
+	return error;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Read the batch manifest.
+///////////////////////////////////////////////////////////////////////////////
+bool Fold::readManifest( vector<BatchJob>& jobs ) {
+	ifstream manifest( seqFile.c_str() );
+	if( !manifest ) { return false; }
+
+	string line;
+	while( getline( manifest, line ) ) {
+
+		// Skip blank lines and comments.
+		istringstream fields( line );
+		BatchJob job;
+		if( !( fields >> job.seqFile ) || job.seqFile[0] == '#' ) { continue; }
+		fields >> job.profileFile >> job.ctFile;
+		if( !( fields >> job.modifier ) ) { job.modifier = "SHAPE"; }
+
+		job.length = 0;
+		job.energy = 0;
+		job.status = "ok";
+		if( job.ctFile == "" ) { job.status = "The manifest line needs a sequence, reactivity and ct file."; }
+		else if( job.modifier != "SHAPE" && job.modifier != "DMS" ) { job.status = "Only SHAPE and DMS data are supported."; }
+
+		// The size of the sequence file is a cheap estimate of the folding time.
+		ifstream sequence( job.seqFile.c_str(), ios::binary );
+		sequence.seekg( 0, ios::end );
+		job.size = sequence ? (long) sequence.tellg() : 0;
+
+		jobs.push_back( job );
+	}
+	manifest.close();
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Read the reactivities of one sequence of a batch manifest, from a file of its own or from a record of a
+// multi-transcript reactivity file opened by runBatch.  Returns "ok", or the reason they could not be read.
+///////////////////////////////////////////////////////////////////////////////
+string Fold::readBatchReactivities( const string& profile, vector<int>& positions, vector<double>& reactivities ) {
+
+	size_t mark = profile.rfind( '#' );
+	if( mark == string::npos ) {
+		ifstream test( profile.c_str() );
+		if( !test ) { return "Input file not found."; }
+		test.close();
+
+		readreactivity( profile.c_str(), positions, reactivities );
+		return "ok";
+	}
+
+	string id = profile.substr( mark + 1 );
+	map<string, reactivityfile*>::const_iterator file = reactivityFiles.find( profile.substr( 0, mark ) );
+	if( file == reactivityFiles.end() || file->second == NULL ) { return "The reactivity file " + profile.substr( 0, mark ) + " could not be read."; }
+
+	int record = file->second->find( id );
+	if( record == -1 ) { return "No record " + id + " in the reactivity file."; }
+	if( !file->second->read( record, positions, reactivities ) ) { return "The record " + id + " of the reactivity file could not be read."; }
+	return "ok";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fold one sequence of a batch manifest.
+///////////////////////////////////////////////////////////////////////////////
+void Fold::foldBatchJob( RNA* master, BatchJob& job ) {
+	if( job.status != "ok" ) { return; }
+
+	// Each sequence gets its own strand, with the parameters taken from the master strand.
+	RNA* strand = new RNA( job.seqFile.c_str(), 2, isRNA );
+	int error = strand->GetErrorCode();
+	if( error == 0 ) { strand->ShareParameters( master ); }
+
+	if( error == 0 && maxDistance != -1 ) { error = strand->ForceMaximumPairingDistance( maxDistance ); }
+
+	if( error == 0 ) {
+		strand->setStateType( twoStateVersion );
+		strand->setSmoothVersion( smoothVersion );
+		strand->setFillTile( fillTile );
+	}
+
+	// The reactivities are read directly; ReadSHAPE also dumps the pseudoenergies to the working directory, which threads cannot share.
+	string status = "ok";
+	if( error == 0 && job.profileFile != "-" ) {
+		vector<int> positions;
+		vector<double> reactivities;
+		status = readBatchReactivities( job.profileFile, positions, reactivities );
+		if( status == "ok" ) { error = strand->SetSHAPE( positions, reactivities, slope, intercept, slopeSingle, interceptSingle, job.modifier ); }
+	}
+
+	if( status != "ok" ) {
+		job.status = status;
+		delete strand;
+		return;
+	}
+
+	if( error == 0 ) {
+		job.length = strand->GetSequenceLength();
+		int window = ( windowSize == -1 ) ? defaultwindowsize( job.length ) : windowSize;
+		error = strand->FoldSingleStrand( percent, maxStructures, window, "", maxLoop, quickfold );
+	}
+
+	if( error == 0 ) { error = strand->WriteCt( job.ctFile.c_str() ); }
+	if( error == 0 ) { job.energy = strand->GetFreeEnergy( 1 ); }
+
+	if( error != 0 ) {
+		job.status = strand->GetErrorMessage( error );
+		job.status.erase( job.status.find_last_not_of( "\n" ) + 1 );
+	}
+
+	delete strand;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fold every sequence in a batch manifest.
+///////////////////////////////////////////////////////////////////////////////
+void Fold::runBatch() {
+
+	// Create a variable that handles errors.
+	int error = 0;
+
+	// Read the manifest.
+	cout << "Reading batch manifest..." << flush;
+	vector<BatchJob> jobs;
+	if( !readManifest( jobs ) ) {
+		cerr << "\nThe batch manifest " << seqFile << " could not be read.\n";
+		error = 1;
+	}
+	if( error == 0 ) { cout << "done." << endl; }
+
+	/*
+	 * Read the thermodynamic parameters and the reactivity histograms once, into a master strand.
+	 * Every sequence copies the thermodynamic parameters and shares the histograms of the master.
+	 */
+	RNA* master = new RNA( isRNA );
+	ErrorChecker<RNA>* checker = new ErrorChecker<RNA>( master );
+	if( error == 0 ) {
+
+		// Show a message saying that the parameters are being read.
+		cout << "Reading parameters..." << flush;
+
+		if( temperature != 310.15 ) { error = checker->isErrorStatus( master->SetTemperature( temperature ) ); }
+		if( error == 0 ) { error = checker->isErrorStatus( master->ReadThermodynamic() ); }
+		if( error == 0 ) {
+			structure* source = master->GetStructure();
+			source->ReadTrainingParam();
+			source->trainingParamRead = true;
+		}
+
+		// If no error occurred, print a message saying that the parameters were read.
+		if( error == 0 ) { cout << "done." << endl; }
+	}
+
+	// Index each multi-transcript reactivity file once; the sequences then read their records from it in parallel.
+	if( error == 0 ) {
+		for( unsigned int i=0;i<jobs.size();i++ ) {
+			size_t mark = jobs[i].profileFile.rfind( '#' );
+			if( mark == string::npos ) { continue; }
+			string file = jobs[i].profileFile.substr( 0, mark );
+			if( reactivityFiles.find( file ) == reactivityFiles.end() ) { reactivityFiles[file] = reactivityfile::open( file.c_str() ); }
+		}
+	}
+
+	/*
+	 * Fold the sequences, largest first, so that a long sequence does not start last and hold up the batch.
+	 * The sequences are folded in parallel in the SMP build.
+	 */
+	if( error == 0 ) {
+
+		// Show a message saying that the main calculation has started.
+		cout << "Folding " << jobs.size() << " sequences..." << flush;
+
+		vector< pair<long,int> > order;
+		for( unsigned int i=0;i<jobs.size();i++ ) { order.push_back( make_pair( jobs[i].size, -(int) i ) ); }
+		sort( order.rbegin(), order.rend() );
+
+#ifdef SMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for( int i=0;i<(int) order.size();i++ ) { foldBatchJob( master, jobs[-order[i].second] ); }
+
+		// If no error occurred, print a message saying that the main calculation is done.
+		cout << "done." << endl;
+	}
+
+	// Write the summary, in manifest order.
+	if( error == 0 ) {
+
+		// Show a message saying that the summary is being written.
+		cout << "Writing batch summary..." << flush;
+
+		int failed = 0;
+		ofstream out( ctFile.c_str() );
+		if( !out ) {
+			cerr << "\nThe batch summary " << ctFile << " could not be written.\n";
+			error = 1;
+		}
+		else {
+			out << "seq file\tct file\tlength\tenergy\tstatus\n";
+			for( unsigned int i=0;i<jobs.size();i++ ) {
+				out << jobs[i].seqFile << "\t" << jobs[i].ctFile << "\t" << jobs[i].length << "\t" << jobs[i].energy << "\t" << jobs[i].status << "\n";
+				if( jobs[i].status != "ok" ) { failed++; }
+			}
+			out.close();
+			cout << "done." << endl;
+		}
+
+		if( failed > 0 ) { cerr << failed << " of " << jobs.size() << " sequences could not be folded, see " << ctFile << ".\n"; }
+	}
+
+	// Write the profile of the whole batch, if requested.
+	if( error == 0 && profileFile != "" ) {
+		int length = 0;
+		for( unsigned int i=0;i<jobs.size();i++ ) { length += jobs[i].length; }
+		if( !writeProfile( length ) ) {
+			cerr << "The profile " << profileFile << " could not be written.\n";
+			error = 1;
+		}
+	}
+
+	// Delete the reactivity files, the error checker and master strand.
+	for( map<string, reactivityfile*>::iterator file=reactivityFiles.begin();file!=reactivityFiles.end();++file ) { delete file->second; }
+	reactivityFiles.clear();
+	delete checker;
+	delete master;
+
+	// Print confirmation of run finishing.
+	if( error == 0 ) { cout << calcType << " complete." << endl; }
+	else { cerr << calcType << " complete with errors." << endl; }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fold one window of a local fold.
+///////////////////////////////////////////////////////////////////////////////
+void Fold::foldLocalWindow( RNA* master, RNA* strand, LocalWindow& window ) {
+	int length = window.end - window.start + 1;
+	int i;
+
+	// Each window gets its own strand, with the parameters taken from the master strand.
+	string sequence;
+	for( i=window.start;i<=window.end;i++ ) { sequence += strand->GetNucleotide( i ); }
+	RNA* local = new RNA( sequence.c_str(), isRNA );
+	int error = local->GetErrorCode();
+	if( error == 0 ) { local->ShareParameters( master ); }
+
+	if( error == 0 ) { error = local->ForceMaximumPairingDistance( localSpan ); }
+
+	if( error == 0 ) {
+		local->setStateType( twoStateVersion );
+		local->setSmoothVersion( smoothVersion );
+		local->setFillTile( fillTile );
+	}
+
+	// The reactivities of the window are taken from the profiles read by runLocal, renumbered from the start of the window.
+	const vector<double>* profiles[3] = { &SHAPEProfile, &DMSProfile, &CMCTProfile };
+	const char* modifiers[3] = { "SHAPE", "DMS", "CMCT" };
+	for( int p=0;p<3 && error==0;p++ ) {
+		if( profiles[p]->empty() ) { continue; }
+
+		vector<int> positions;
+		vector<double> reactivities;
+		for( i=window.start;i<=window.end;i++ ) {
+			if( (*profiles[p])[i] != -999 ) {
+				positions.push_back( i - window.start + 1 );
+				reactivities.push_back( (*profiles[p])[i] );
+			}
+		}
+		error = local->SetSHAPE( positions, reactivities, slope, intercept, slopeSingle, interceptSingle, modifiers[p] );
+	}
+
+	// The lowest free energy structure; the traceback of the full fill also gives its energy.
+	if( error == 0 ) { error = local->FoldSingleStrand( percent, 1, 0, "", maxLoop, false ); }
+	if( error == 0 ) {
+		window.energy = local->GetFreeEnergy( 1 );
+		window.structure.assign( length, '.' );
+		for( i=1;i<=length;i++ ) {
+			if( local->GetPair( i ) > i ) {
+				window.structure[i-1] = '(';
+				window.structure[local->GetPair( i )-1] = ')';
+			}
+		}
+	}
 
-	return outname;
+	// The unpaired probabilities, from the partition function of the window.
+	if( error == 0 ) { error = local->PartitionFunction(); }
+	if( error == 0 ) {
+		window.unpaired.assign( length + 1, 1.0 );
+		for( i=1;i<=length;i++ ) {
+			for( int j=i+1;j<=length && j-i<localSpan;j++ ) {
+				double probability = local->GetPairProbability( i, j );
+				window.unpaired[i] -= probability;
+				window.unpaired[j] -= probability;
+			}
+		}
+	}
+
+	window.status = "ok";
+	if( error != 0 ) {
+		window.status = local->GetErrorMessage( error );
+		window.status.erase( window.status.find_last_not_of( "\n" ) + 1 );
+	}
+
+	delete local;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fold a long sequence in windows, with pairs limited to the local span.
+///////////////////////////////////////////////////////////////////////////////
+void Fold::runLocal() {
+
+	// Create a variable that handles errors.
+	int error = 0;
+
+	// Read the sequence; only the windows are folded, so no dynamic programming arrays are allocated for the whole sequence.
+	cout << "Initializing nucleic acids..." << flush;
+	RNA* strand = new RNA( seqFile.c_str(), 2, isRNA );
+	ErrorChecker<RNA>* checker = new ErrorChecker<RNA>( strand );
+	error = checker->isErrorStatus();
+	if( error == 0 ) { cout << "done." << endl; }
+	int length = ( error == 0 ) ? strand->GetSequenceLength() : 0;
+
+	/*
+	 * Read the thermodynamic parameters and the reactivity histograms once, into a master strand.
+	 * Every window copies the thermodynamic parameters and shares the histograms of the master.
+	 */
+	RNA* master = new RNA( isRNA );
+	ErrorChecker<RNA>* masterChecker = new ErrorChecker<RNA>( master );
+	if( error == 0 ) {
+
+		// Show a message saying that the parameters are being read.
+		cout << "Reading parameters..." << flush;
+
+		if( temperature != 310.15 ) { error = masterChecker->isErrorStatus( master->SetTemperature( temperature ) ); }
+		if( error == 0 ) { error = masterChecker->isErrorStatus( master->ReadThermodynamic() ); }
+		if( error == 0 ) {
+			structure* source = master->GetStructure();
+			source->ReadTrainingParam();
+			source->trainingParamRead = true;
+		}
+
+		// If no error occurred, print a message saying that the parameters were read.
+		if( error == 0 ) { cout << "done." << endl; }
+	}
+
+	// Read the reactivity profiles once; each window takes its part.
+	if( error == 0 ) {
+		string files[3] = { SHAPEFile, DMSFile, CMCTFile };
+		vector<double>* profiles[3] = { &SHAPEProfile, &DMSProfile, &CMCTProfile };
+		for( int p=0;p<3 && error==0;p++ ) {
+			if( files[p] == "" ) { continue; }
+			ifstream test( files[p].c_str() );
+			if( !test ) {
+				cerr << "The reactivity file " << files[p] << " could not be read.\n";
+				error = 1;
+			}
+			else { readProfile( files[p], length, *profiles[p] ); }
+		}
+	}
+
+	// Open the output files.
+	ofstream out, unpairedOut;
+	if( error == 0 ) {
+		out.open( ctFile.c_str() );
+		unpairedOut.open( ( ctFile + ".unpaired" ).c_str() );
+		if( !out || !unpairedOut ) {
+			cerr << "The local fold output " << ctFile << " could not be written.\n";
+			error = 1;
+		}
+	}
+
+	/*
+	 * Fold the windows.  Each window is twice the span and starts one span after the last, so every pair
+	 * within the span lies inside some window.  The windows are folded in parallel in the SMP build, and
+	 * their results are written in order as they are finished.
+	 */
+	if( error == 0 ) {
+		int windowLength = min( 2 * localSpan, length );
+		int windows = ( length <= windowLength ) ? 1 : ( length - windowLength + localSpan - 1 ) / localSpan + 1;
+		int failed = 0;
+
+		// The sums of the unpaired probabilities of each nucleotide over its windows, written once no later window contains it.
+		vector<double> unpairedSum( length + 1, 0.0 );
+		vector<int> unpairedCount( length + 1, 0 );
+		int written = 0;
+
+		// Show a message saying that the main calculation has started.
+		cout << "Folding " << windows << " windows..." << flush;
+
+		out << "start\tend\tenergy\tstructure\tstatus\n";
+		unpairedOut << "i\tnucleotide\tunpaired\n";
+
+#ifdef SMP
+#pragma omp parallel for ordered schedule(dynamic)
+#endif
+		for( int w=0;w<windows;w++ ) {
+			LocalWindow window;
+			window.start = w * localSpan + 1;
+			window.end = min( window.start + windowLength - 1, length );
+			window.energy = 0;
+			foldLocalWindow( master, strand, window );
+
+#ifdef SMP
+#pragma omp ordered
+#endif
+			{
+				out << window.start << "\t" << window.end << "\t" << window.energy << "\t" << window.structure << "\t" << window.status << "\n" << flush;
+				if( window.status != "ok" ) { failed++; }
+				else {
+					for( int i=window.start;i<=window.end;i++ ) {
+						unpairedSum[i] += window.unpaired[i-window.start+1];
+						unpairedCount[i]++;
+					}
+				}
+
+				// The next window starts one span later, so the nucleotides before it are finished.
+				int finished = ( w == windows - 1 ) ? length : window.start + localSpan - 1;
+				for( ;written<finished;written++ ) {
+					unpairedOut << written + 1 << "\t" << strand->GetNucleotide( written + 1 ) << "\t";
+					if( unpairedCount[written+1] > 0 ) { unpairedOut << unpairedSum[written+1] / unpairedCount[written+1] << "\n"; }
+					else { unpairedOut << "NA\n"; }
+				}
+				unpairedOut << flush;
+			}
+		}
+
+		out.close();
+		unpairedOut.close();
+
+		// If no error occurred, print a message saying that the main calculation is done.
+		cout << "done." << endl;
+
+		if( failed > 0 ) {
+			cerr << failed << " of " << windows << " windows could not be folded, see " << ctFile << ".\n";
+			if( failed == windows ) { error = 1; }
+		}
+	}
+
+	// Write the profile of the whole sequence, if requested.
+	if( error == 0 && profileFile != "" ) {
+		if( !writeProfile( length ) ) {
+			cerr << "The profile " << profileFile << " could not be written.\n";
+			error = 1;
+		}
+	}
+
+	// Delete the error checkers and strands.
+	delete masterChecker;
+	delete master;
+	delete checker;
+	delete strand;
+
+	// Print confirmation of run finishing.
+	if( error == 0 ) { cout << calcType << " complete." << endl; }
+	else { cerr << calcType << " complete with errors." << endl; }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fold the sequence at one temperature of a sweep.
+///////////////////////////////////////////////////////////////////////////////
+void Fold::foldSweepPoint( RNA* master, SweepPoint& point ) {
+
+	// Each temperature gets its own strand, with the parameters derived from the master strand at 310.15 K.
+	RNA* strand = new RNA( seqFile.c_str(), 2, isRNA );
+	int error = strand->GetErrorCode();
+	if( error == 0 ) { error = strand->ShareParameters( master, point.temperature ); }
+
+	if( error == 0 && maxDistance != -1 ) { error = strand->ForceMaximumPairingDistance( maxDistance ); }
+
+	if( error == 0 ) {
+		strand->setStateType( twoStateVersion );
+		strand->setSmoothVersion( smoothVersion );
+		strand->setFillTile( fillTile );
+	}
+
+	// The pseudoenergies do not depend on the temperature, so they are taken from the master strand.
+	if( error == 0 ) { error = strand->CopySHAPE( master ); }
+
+	if( error == 0 ) { error = strand->FoldSingleStrand( percent, maxStructures, windowSize, "", maxLoop, quickfold ); }
+	if( error == 0 ) { error = strand->WriteCt( point.ctFile.c_str() ); }
+	if( error == 0 ) { point.energy = strand->GetFreeEnergy( 1 ); }
+
+	point.status = "ok";
+	if( error != 0 ) {
+		point.status = strand->GetErrorMessage( error );
+		point.status.erase( point.status.find_last_not_of( "\n" ) + 1 );
+	}
+
+	delete strand;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+// Fold a sequence at each temperature of a sweep.
+///////////////////////////////////////////////////////////////////////////////
+void Fold::runSweep() {
+
+	// Create a variable that handles errors.
+	int error = 0;
+
+	/*
+	 * The master strand reads the thermodynamic parameters at 310.15 K, the enthalpies and the reactivity
+	 * histograms once, and calculates the pseudoenergies of the reactivities.  Every temperature derives its
+	 * parameters from the master and copies its pseudoenergies.
+	 */
+	cout << "Initializing nucleic acids..." << flush;
+	RNA* master = new RNA( seqFile.c_str(), 2, isRNA );
+	ErrorChecker<RNA>* checker = new ErrorChecker<RNA>( master );
+	error = checker->isErrorStatus();
+	if( error == 0 ) { cout << "done." << endl; }
+
+	if( windowSize == -1 && error == 0 ) { windowSize = defaultwindowsize( master->GetSequenceLength() ); }
+
+	if( error == 0 ) {
+
+		// Show a message saying that the parameters are being read.
+		cout << "Reading parameters..." << flush;
+
+		error = checker->isErrorStatus( master->ReadThermodynamic() );
+
+		// The enthalpies are read before the temperatures are folded in parallel, which then only read them.
+		if( error == 0 && master->GetEnthalpyTable() == NULL ) { error = checker->isErrorStatus( 5 ); }
+		if( error == 0 ) {
+			structure* source = master->GetStructure();
+			source->ReadTrainingParam();
+			source->trainingParamRead = true;
+		}
+
+		// If no error occurred, print a message saying that the parameters were read.
+		if( error == 0 ) { cout << "done." << endl; }
+	}
+
+	// The pseudoenergies depend on the scoring scheme, so it is set before the reactivities are read.
+	if( error == 0 ) {
+		master->setStateType( twoStateVersion );
+		master->setSmoothVersion( smoothVersion );
+	}
+
+	// Read the reactivities once.
+	if( error == 0 && ( SHAPEFile != "" || DSHAPEFile != "" || DMSFile != "" || CMCTFile != "" ) ) {
+
+		// Show a message saying that constraints are being applied.
+		cout << "Applying constraints..." << flush;
+
+		// In the same order as run().
+		if( SHAPEFile != "" ) { error = checker->isErrorStatus( master->ReadSHAPE( SHAPEFile.c_str(), slope, intercept, slopeSingle, interceptSingle, "SHAPE" ) ); }
+		if( error == 0 && DSHAPEFile != "" ) { error = checker->isErrorStatus( master->ReadSHAPE( DSHAPEFile.c_str(), Dslope, 0, 0, 0, "diffSHAPE" ) ); }
+		if( error == 0 && DMSFile != "" ) { error = checker->isErrorStatus( master->ReadSHAPE( DMSFile.c_str(), slope, intercept, slopeSingle, interceptSingle, "DMS" ) ); }
+		if( error == 0 && CMCTFile != "" ) { error = checker->isErrorStatus( master->ReadSHAPE( CMCTFile.c_str(), slope, intercept, slopeSingle, interceptSingle, "CMCT" ) ); }
+
+		// If no error occurred, print a message saying that constraints were applied.
+		if( error == 0 ) { cout << "done." << endl; }
+	}
+
+	// Fold each temperature; the temperatures are folded in parallel in the SMP build.
+	vector<SweepPoint> points( sweepTemperatures.size() );
+	if( error == 0 ) {
+
+		// Show a message saying that the main calculation has started.
+		cout << "Folding at " << points.size() << " temperatures..." << flush;
+
+		for( unsigned int i=0;i<points.size();i++ ) {
+			ostringstream name;
+			name << ctFile << "." << sweepTemperatures[i];
+			points[i].temperature = sweepTemperatures[i];
+			points[i].ctFile = name.str();
+			points[i].energy = 0;
+		}
+
+#ifdef SMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for( int i=0;i<(int) points.size();i++ ) { foldSweepPoint( master, points[i] ); }
+
+		// If no error occurred, print a message saying that the main calculation is done.
+		cout << "done." << endl;
+	}
+
+	// Write the summary, in the order of the sweep.
+	if( error == 0 ) {
+
+		// Show a message saying that the summary is being written.
+		cout << "Writing sweep summary..." << flush;
+
+		int failed = 0;
+		ofstream out( ctFile.c_str() );
+		if( !out ) {
+			cerr << "\nThe sweep summary " << ctFile << " could not be written.\n";
+			error = 1;
+		}
+		else {
+			out << "temperature\tct file\tenergy\tstatus\n";
+			for( unsigned int i=0;i<points.size();i++ ) {
+				out << points[i].temperature << "\t" << points[i].ctFile << "\t" << points[i].energy << "\t" << points[i].status << "\n";
+				if( points[i].status != "ok" ) { failed++; }
+			}
+			out.close();
+			cout << "done." << endl;
+		}
+
+		if( failed > 0 ) { cerr << failed << " of " << points.size() << " temperatures could not be folded, see " << ctFile << ".\n"; }
+	}
+
+	// Write the profile of the whole sweep, if requested.
+	if( error == 0 && profileFile != "" ) {
+		if( !writeProfile( master->GetSequenceLength() ) ) {
+			cerr << "The profile " << profileFile << " could not be written.\n";
+			error = 1;
+		}
+	}
+
+	// Delete the error checker and master strand.
+	delete checker;
+	delete master;
+
+	// Print confirmation of run finishing.
+	if( error == 0 ) { cout << calcType << " complete." << endl; }
+	else { cerr << calcType << " complete with errors." << endl; }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Write the timings and counters collected during the run as a JSON object.
+///////////////////////////////////////////////////////////////////////////////
+bool Fold::writeProfile( int length ) {
+
+	ofstream out( profileFile.c_str() );
+	if( !out ) { return false; }
+
+	out << "{\n";
+	out << "  \"seq file\": \"" << seqFile << "\",\n";
+	out << "  \"length\": " << length << ",\n";
+#ifdef SMP
+	out << "  \"smp\": true,\n";
+#else
+	out << "  \"smp\": false,\n";
+#endif
+	profile.write( out );
+	out << "}\n";
+
+	return !out.fail();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Run calculations.
 ///////////////////////////////////////////////////////////////////////////////
 void Fold::run() {
 
+	// Collect timings and counters only if a profile was requested.
+	profile.enabled = ( profileFile != "" );
+
+	// A batch manifest is folded separately.
+	if( batch ) {
+		runBatch();
+		return;
+	}
+
+	// So is a local fold.
+	if( localSpan != -1 ) {
+		runLocal();
+		return;
+	}
+
+	// And a temperature sweep.
+	if( !sweepTemperatures.empty() ) {
+		runSweep();
+		return;
+	}
+
 	// Create a variable that handles errors.
 	int error = 0;
-	char numstr[21];
-	int b_iter;
-	string consFile;
 
 	/*
 	 * Use the constructor for RNA that specifies a filename.
@@ -482,17 +1527,7 @@ void Fold::run() {
 	 * Use method GetSequenceLength to get the length of the sequence.
 	 * The window sizes in relation to the length are hardcoded values.
 	 */
-	if( windowSize == -1 && error == 0 ) {
-		int length = strand->GetSequenceLength();
-		windowSize =
-			( length > 1200 ) ? 20 :
-			( length > 800 ) ? 15 :
-			( length > 500 ) ? 11 :
-			( length > 300 ) ? 7 :
-			( length > 120 ) ? 5 :
-			( length > 50 ) ? 3 :
-			2;
-	}
+	if( windowSize == -1 && error == 0 ) { windowSize = defaultwindowsize( strand->GetSequenceLength() ); }
 
 	/*
 	 * Set the temperature using the SetTemperature method.
@@ -535,6 +1570,7 @@ void Fold::run() {
 	if(error == 0) {
 		strand->setStateType(twoStateVersion);
 		strand->setSmoothVersion(smoothVersion);
+		strand->setFillTile(fillTile);
 		if(error != 0) {
 			cout<<"error setting state option and smooth option.\n";
 			exit(0);
@@ -562,132 +1598,204 @@ void Fold::run() {
 		( doubleOffsetFile != "" ) ||
 		( experimentalFile != "" );
 
-	for( b_iter=0; b_iter <= bootstrap; b_iter++) {
-		// If constraints should be applied, do so.
-		if( error == 0 && applyConstraints ) {
+	// If constraints should be applied, do so.
+	if( error == 0 && applyConstraints ) {
 
-			// Show a message saying that constraints are being applied.
-			cout << "Applying constraints..." << flush;
-			int constraintError = 0;
+		// Show a message saying that constraints are being applied.
+		cout << "Applying constraints..." << flush;
+		int constraintError = 0;
 
-			// Read folding constraints, if applicable.
-			if( constraintFile != "" ) {
-				constraintError = strand->ReadConstraints( constraintFile.c_str() );
-				error = checker->isErrorStatus( constraintError );
-			}
-
-			// Read SHAPE constraints
-			if( error == 0 && SHAPEFile != "" ) {
-				if( b_iter > 0 ) { consFile = sample_file(SHAPEFile, strand->GetSequenceLength(), b_iter); }
-				else { consFile = SHAPEFile; }
-				constraintError = strand->ReadSHAPE( consFile.c_str(), slope, intercept, slopeSingle, interceptSingle, "SHAPE" );
-				error = checker->isErrorStatus( constraintError );
-			}
+		// Read folding constraints, if applicable.
+		if( constraintFile != "" ) {
+			constraintError = strand->ReadConstraints( constraintFile.c_str() );
+			error = checker->isErrorStatus( constraintError );
+		}
 
-			// Read differential SHAPE constraints
-			if( error == 0 && DSHAPEFile != "" ) {
-				if( b_iter > 0 ) { consFile = sample_file(DSHAPEFile, strand->GetSequenceLength(), b_iter); }
-				else { consFile = DSHAPEFile; }
-				constraintError = strand->ReadSHAPE( consFile.c_str(), Dslope, 0, 0, 0, "diffSHAPE" );
-				error = checker->isErrorStatus( constraintError );
-			}
+		// Read SHAPE constraints
+		if( error == 0 && SHAPEFile != "" ) {
+			constraintError = strand->ReadSHAPE( SHAPEFile.c_str(), slope, intercept, slopeSingle, interceptSingle, "SHAPE" );
+			error = checker->isErrorStatus( constraintError );
+		}
 
-			// Read DMS constraints.
-			if( error == 0 && DMSFile != "" ) {
-				if( b_iter > 0 ) { consFile = sample_file(DMSFile, strand->GetSequenceLength(), b_iter); }
-				else { consFile = DMSFile; }
-				constraintError = strand->ReadSHAPE( consFile.c_str(), slope, intercept, slopeSingle, interceptSingle, "DMS" );
-				error = checker->isErrorStatus( constraintError );
-			}
+		// Read differential SHAPE constraints
+		if( error == 0 && DSHAPEFile != "" ) {
+			constraintError = strand->ReadSHAPE( DSHAPEFile.c_str(), Dslope, 0, 0, 0, "diffSHAPE" );
+			error = checker->isErrorStatus( constraintError );
+		}
 
-			// Read CMCT constraints.
-			if( error == 0 && CMCTFile != "" ) {
-				if( b_iter > 0 ) { consFile = sample_file(CMCTFile, strand->GetSequenceLength(), b_iter); }
-				else { consFile = CMCTFile; }
-				constraintError = strand->ReadSHAPE( consFile.c_str(), slope, intercept, slopeSingle, interceptSingle, "CMCT" );
-				error = checker->isErrorStatus( constraintError );
-			}
+		// Read DMS constraints.
+		if( error == 0 && DMSFile != "" ) {
+			constraintError = strand->ReadSHAPE( DMSFile.c_str(), slope, intercept, slopeSingle, interceptSingle, "DMS" );
+			error = checker->isErrorStatus( constraintError );
+		}
 
+		// Read CMCT constraints.
+		if( error == 0 && CMCTFile != "" ) {
+			constraintError = strand->ReadSHAPE( CMCTFile.c_str(), slope, intercept, slopeSingle, interceptSingle, "CMCT" );
+			error = checker->isErrorStatus( constraintError );
+		}
 
-			// Read single strand offset, if applicable.
-			if( error == 0 && singleOffsetFile != "" ) {
-				constraintError = strand->ReadSSO( singleOffsetFile.c_str() );
-				error = checker->isErrorStatus( constraintError );
-			}
 
-			// Read double strand offset, if applicable.
-			if( error == 0 && doubleOffsetFile != "" ) {
-				constraintError = strand->ReadDSO( doubleOffsetFile.c_str() );
-				error = checker->isErrorStatus( constraintError );
-			}
+		// Read single strand offset, if applicable.
+		if( error == 0 && singleOffsetFile != "" ) {
+			constraintError = strand->ReadSSO( singleOffsetFile.c_str() );
+			error = checker->isErrorStatus( constraintError );
+		}
 
-			// Read experimental pair bonus constraints, if applicable.
-			if( error == 0 && experimentalFile != "" ) {
-				constraintError = strand->ReadExperimentalPairBonus( experimentalFile.c_str(), experimentalOffset, experimentalScaling );
-				error = checker->isErrorStatus( constraintError );
-			}
+		// Read double strand offset, if applicable.
+		if( error == 0 && doubleOffsetFile != "" ) {
+			constraintError = strand->ReadDSO( doubleOffsetFile.c_str() );
+			error = checker->isErrorStatus( constraintError );
+		}
 
-			// If no error occurred, print a message saying that constraints were applied.
-			if( error == 0 ) { cout << "done." << endl; }
+		// Read experimental pair bonus constraints, if applicable.
+		if( error == 0 && experimentalFile != "" ) {
+			constraintError = strand->ReadExperimentalPairBonus( experimentalFile.c_str(), experimentalOffset, experimentalScaling );
+			error = checker->isErrorStatus( constraintError );
 		}
 
-		//Make sure the user isn't using -mfe and -s, these are incompatible.
+		// If no error occurred, print a message saying that constraints were applied.
+		if( error == 0 ) { cout << "done." << endl; }
+	}
 
-		if (quickfold&&saveFile!="") {
+	/*
+	 * Sample structures instead of folding, if requested; the samples take the place of the ct file.
+	 */
+	if( error == 0 && samples > 0 ) {
 
-			error = 1;
-			cerr << "Fold stopped.  The -s and -mfe commands are incompatible.\n";
+		// Show a message saying that sampling has started.
+		cout << "Sampling " << samples << " structures..." << flush;
+
+		// Sample the structures and check for errors.
+		error = checker->isErrorStatus( runSample( strand ) );
+
+		// If no error occurred, print a message saying that sampling is done.
+		if( error == 0 ) { cout << "done." << endl; }
 
+		// Write the profile, if requested.
+		if( error == 0 && profileFile != "" ) {
+			if( !writeProfile( strand->GetSequenceLength() ) ) {
+				cerr << "The profile " << profileFile << " could not be written.\n";
+				error = 1;
+			}
 		}
 
-		/*
-		 * Fold the single strand using the FoldSingleStrand method.
-		 * During calculation, monitor progress using the TProgressDialog class and the Start/StopProgress methods of the RNA class.
-		 * Neither of these methods require any error checking.
-		 * After the main calculation is complete, use the error checker's isErrorStatus method to check for errors.
-		 */
-		if( error == 0 ) {
+		delete checker;
+		delete strand;
 
-			// Show a message saying that the main calculation has started.
-			cout << "Folding single strand..." << flush;
+		if( error == 0 ) { cout << calcType << " complete." << endl; }
+		else { cerr << calcType << " complete with errors." << endl; }
+		return;
+	}
 
-			// Create the progress monitor.
-			TProgressDialog* progress = new TProgressDialog();
-			strand->SetProgress( *progress );
+	/*
+	 * Predict maximum expected accuracy structures instead of folding, if requested; a ct file is written for each gamma.
+	 */
+	if( error == 0 && !gammas.empty() ) {
 
-			// Do the main calculation and check for errors.
-			int mainCalcError = strand->FoldSingleStrand( percent, maxStructures, windowSize, saveFile.c_str(), maxLoop, quickfold );
-			error = checker->isErrorStatus( mainCalcError );
+		// Show a message saying that the calculation has started.
+		cout << "Predicting maximum expected accuracy structures for " << gammas.size() << " gammas..." << flush;
 
-			// Delete the progress monitor.
-			strand->StopProgress();
-			delete progress;
+		// Predict the structures and check for errors.
+		error = checker->isErrorStatus( runMaxExpect( strand ) );
 
-			// If no error occurred, print a message saying that the main calculation is done.
-			if( error == 0 ) { cout << "done." << endl; }
+		// If no error occurred, print a message saying that the calculation is done.
+		if( error == 0 ) { cout << "done." << endl; }
+
+		// Write the profile, if requested.
+		if( error == 0 && profileFile != "" ) {
+			if( !writeProfile( strand->GetSequenceLength() ) ) {
+				cerr << "The profile " << profileFile << " could not be written.\n";
+				error = 1;
+			}
 		}
 
-		/*
-		 * Write a CT output file using the WriteCt method.
-		 * After writing is complete, use the error checker's isErrorStatus method to check for errors.
-		 */
-		if( error == 0 ) {
+		delete checker;
+		delete strand;
 
-			// Show a message saying that the CT file is being written.
-			cout << "Writing output ct file..." << flush;
+		if( error == 0 ) { cout << calcType << " complete." << endl; }
+		else { cerr << calcType << " complete with errors." << endl; }
+		return;
+	}
+
+	//Make sure the user isn't using -mfe and -s, these are incompatible.
+
+	if (quickfold&&saveFile!="") {
 
-			// Write the CT file and check for errors.
-			sprintf(numstr, "%d", b_iter);
-			int writeError;
+		error = 1;
+		cerr << "Fold stopped.  The -s and -mfe commands are incompatible.\n";
 
-			if( b_iter > 0 ){ writeError = strand->WriteCt( (ctFile + "_boot" + numstr).c_str() ); }
-			
-			else { writeError = strand->WriteCt( ctFile.c_str() ); }
+	}
 
-			error = checker->isErrorStatus( writeError );
+	/*
+	 * Fold the single strand using the FoldSingleStrand method.
+	 * During calculation, monitor progress using the TProgressDialog class and the Start/StopProgress methods of the RNA class.
+	 * Neither of these methods require any error checking.
+	 * After the main calculation is complete, use the error checker's isErrorStatus method to check for errors.
+	 */
+	if( error == 0 ) {
 
-			// If no errors occurred, show a CT file writing completion message.
-			if( error == 0 ) { cout << "done." << endl; }
+		// Show a message saying that the main calculation has started.
+		cout << "Folding single strand..." << flush;
+
+		// Create the progress monitor.
+		TProgressDialog* progress = new TProgressDialog();
+		strand->SetProgress( *progress );
+
+		// Do the main calculation and check for errors.
+		int mainCalcError = strand->FoldSingleStrand( percent, maxStructures, windowSize, saveFile.c_str(), maxLoop, quickfold );
+		error = checker->isErrorStatus( mainCalcError );
+
+		// Delete the progress monitor.
+		strand->StopProgress();
+		delete progress;
+
+		// If no error occurred, print a message saying that the main calculation is done.
+		if( error == 0 ) { cout << "done." << endl; }
+	}
+
+	/*
+	 * Write a CT output file using the WriteCt method.
+	 * After writing is complete, use the error checker's isErrorStatus method to check for errors.
+	 */
+	if( error == 0 ) {
+
+		// Show a message saying that the CT file is being written.
+		cout << "Writing output ct file..." << flush;
+
+		// Write the CT file and check for errors.
+		int writeError = strand->WriteCt( ctFile.c_str() );
+
+		error = checker->isErrorStatus( writeError );
+
+		// If no errors occurred, show a CT file writing completion message.
+		if( error == 0 ) { cout << "done." << endl; }
+	}
+
+	/*
+	 * Estimate the confidence of each pair by bootstrapping the reactivities, if requested.
+	 * The replicates are resampled in memory and folded in parallel in the SMP build.
+	 */
+	if( error == 0 && bootstrap > 0 ) {
+
+		// Show a message saying that bootstrapping has started.
+		cout << "Bootstrapping " << (int) bootstrap << " replicates..." << flush;
+
+		// Fold the replicates and write the pair confidences.
+		int bootError = runBootstrap( strand );
+		if( bootError == 1 ) { cerr << "\nNo bootstrap replicate could be folded.\n"; }
+		else if( bootError == 2 ) { cerr << "\nThe bootstrap confidence file could not be written.\n"; }
+		if( bootError != 0 ) { error = bootError; }
+
+		// If no error occurred, print a message saying that bootstrapping is done.
+		if( error == 0 ) { cout << "done." << endl; }
+	}
+
+	// Write the profile, if requested.
+	if( error == 0 && profileFile != "" ) {
+		if( !writeProfile( strand->GetSequenceLength() ) ) {
+			cerr << "The profile " << profileFile << " could not be written.\n";
+			error = 1;
 		}
 	}
 
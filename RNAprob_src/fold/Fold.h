@@ -9,9 +9,12 @@
 #ifndef FOLD_H
 #define FOLD_H
 
+#include <map>
 #include "../RNA_class/RNA.h"
 #include "../src/ErrorChecker.h"
 #include "../src/ParseCommandLine.h"
+#include "../src/random.h"
+#include "../src/reactivityfile.h"
 
 class Fold {
  public:
@@ -40,6 +43,24 @@ class Fold {
 	 */
 	void run();
 
+	/*
+	 * Name:        runBatch
+	 * Description: Fold every sequence listed in a batch manifest, reading the parameters only once.
+	 */
+	void runBatch();
+
+	/*
+	 * Name:        runLocal
+	 * Description: Fold a long sequence in overlapping windows, with pairs limited to the local span.
+	 */
+	void runLocal();
+
+	/*
+	 * Name:        runSweep
+	 * Description: Fold a sequence at each temperature of a sweep, reading the parameters and reactivities only once.
+	 */
+	void runSweep();
+
  private:
 	// Private variables.
 
@@ -50,6 +71,7 @@ class Fold {
 	string seqFile;          // The input sequence file.
 	string ctFile;           // The output ct file.
 	string saveFile;         // The optional output save file.
+	string profileFile;      // The optional output profile file.
 
 	string constraintFile;   // The optional folding constraints file.
 	string experimentalFile; // The optional input bonus file.
@@ -82,6 +104,9 @@ class Fold {
 	// The maximum pairing distance.
 	int maxDistance;
 
+	// The size of the tiles in which the fill arrays are filled (0 fills one diagonal at a time).
+	int fillTile;
+
 	// The maximum internal bulge loop size.
 	int maxLoop;
 
@@ -106,6 +131,21 @@ class Fold {
 	// The number of bootstraping iterations to be done.
 	double bootstrap;
 
+	// The random seed for bootstrap resampling and stochastic sampling.
+	int seed;
+
+	// The number of structures to sample from the ensemble, 0 if the sequence is folded.
+	int samples;
+
+	// Flag signifying if the samples are written as binary pair lists (true) or in dot-bracket notation (false).
+	bool sampleBinary;
+
+	// The reactivity profiles that are resampled for bootstrapping, indexed by nucleotide.
+	vector<double> SHAPEProfile;
+	vector<double> DSHAPEProfile;
+	vector<double> DMSProfile;
+	vector<double> CMCTProfile;
+
 	// The window size for calculation.
 	int windowSize;
 
@@ -122,8 +162,78 @@ class Fold {
 	// FD
 	bool smoothVersion;
 
-	//Auxiliary function used to sample a SHAPE, DMS, CMCT file.
-	string sample_file(string shapefile, int numnuc, int iter);
+	// Flag signifying if seqFile is a batch manifest and ctFile is the batch summary.
+	bool batch;
+
+	// The maximum pairing span of a local fold, -1 if the whole sequence is folded.
+	int localSpan;
+
+	// One line of a batch manifest, and the result of folding it.
+	struct BatchJob {
+		string seqFile;        // The input sequence file.
+		string profileFile;    // The reactivity file, <file>#<ID> for a record of a multi-transcript file, "-" if there is none.
+		string ctFile;         // The output ct file.
+		string modifier;       // SHAPE or DMS.
+		long size;             // The size of the sequence file, used to fold the largest sequences first.
+		int length;            // The sequence length.
+		double energy;         // The lowest free energy, in kcal/mol.
+		string status;         // "ok", or the error that stopped the fold.
+	};
+
+	//Auxiliary functions used to bootstrap a SHAPE, DMS, CMCT file.
+	void readProfile( string shapefile, int numnuc, vector<double>& profile );
+	void resampleProfile( const vector<double>& profile, randomnumber& rng, vector<int>& positions, vector<double>& sample );
+	int foldReplicate( RNA* strand, int replicate, vector<int>& pairs );
+	int runBootstrap( RNA* strand );
+
+	// Auxiliary function used to sample structures from the ensemble, streaming them to the output.
+	int runSample( RNA* strand );
+
+	// The weights given to base pairs for maximum expected accuracy structures, empty if the sequence is folded.
+	vector<double> gammas;
+
+	// Auxiliary functions used to predict maximum expected accuracy structures for each gamma.
+	bool readGammas( string list );
+	int runMaxExpect( RNA* strand );
+
+	// The multi-transcript reactivity files named by a batch manifest, opened once for all of its sequences.
+	map<string, reactivityfile*> reactivityFiles;
+
+	// Auxiliary functions used to fold a batch manifest.
+	bool readManifest( vector<BatchJob>& jobs );
+	string readBatchReactivities( const string& profile, vector<int>& positions, vector<double>& reactivities );
+	void foldBatchJob( RNA* master, BatchJob& job );
+
+	// One window of a local fold, and the result of folding it.
+	struct LocalWindow {
+		int start;                // The first nucleotide of the window.
+		int end;                  // The last nucleotide of the window.
+		double energy;            // The lowest free energy, in kcal/mol.
+		string structure;         // The lowest free energy structure, in dot-bracket notation.
+		vector<double> unpaired;  // The probability that each nucleotide of the window is unpaired, indexed from 1.
+		string status;            // "ok", or the error that stopped the fold.
+	};
+
+	// Auxiliary function used to fold a window of a local fold.
+	void foldLocalWindow( RNA* master, RNA* strand, LocalWindow& window );
+
+	// The temperatures of a sweep, in K, empty if the sequence is folded at one temperature.
+	vector<double> sweepTemperatures;
+
+	// One temperature of a sweep, and the result of folding at it.
+	struct SweepPoint {
+		double temperature;  // The folding temperature, in K.
+		string ctFile;       // The output ct file.
+		double energy;       // The lowest free energy, in kcal/mol.
+		string status;       // "ok", or the error that stopped the fold.
+	};
+
+	// Auxiliary functions used to fold a temperature sweep.
+	bool readSweep( string list );
+	void foldSweepPoint( RNA* master, SweepPoint& point );
+
+	// Auxiliary function used to write the timings and counters of a run.
+	bool writeProfile( int length );
 };
 
 #endif /* FOLD_H */
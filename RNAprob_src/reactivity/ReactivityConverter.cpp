@@ -0,0 +1,83 @@
+/*
+ * A program that converts a multi-transcript reactivity file from the text form to the binary form.
+ * RNAprob maps the binary form and finds the record of a transcript in its index, without reading the rest of the file.
+ */
+
+#include "ReactivityConverter.h"
+#include "../src/reactivityfile.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor.
+///////////////////////////////////////////////////////////////////////////////
+ReactivityConverter::ReactivityConverter() {
+
+	// Initialize the calculation type description.
+	calcType = "Reactivity file conversion";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Parse the command line arguments.
+///////////////////////////////////////////////////////////////////////////////
+bool ReactivityConverter::parse( int argc, char** argv ) {
+
+	// Create the command line parser and build in its required parameters.
+	ParseCommandLine* parser = new ParseCommandLine( "RNAprob-reactivity" );
+	parser->addParameterDescription( "text file", "The name of a multi-transcript reactivity file in the text form, a \">ID\" line for each transcript followed by its \"position reactivity\" lines." );
+	parser->addParameterDescription( "binary file", "The name of the binary reactivity file to write." );
+
+	// Parse the command line into pieces.
+	parser->parseLine( argc, argv );
+
+	// Get required parameters from the parser.
+	if( !parser->isError() ) {
+		textFile = parser->getParameter( 1 );
+		binaryFile = parser->getParameter( 2 );
+	}
+
+	// Delete the parser and return whether the parser encountered an error.
+	bool noError = ( parser->isError() == false );
+	delete parser;
+	return noError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Convert the file.
+///////////////////////////////////////////////////////////////////////////////
+bool ReactivityConverter::run() {
+
+	cout << "Writing " << binaryFile << "..." << flush;
+	bool written = writereactivitybinary( textFile.c_str(), binaryFile.c_str() );
+	if( written ) { cout << "done." << endl; }
+	else { cerr << "\n" << textFile << " could not be read as a reactivity file, or " << binaryFile << " could not be written.\n"; }
+
+	// Report the number of records.
+	if( written ) {
+		reactivityfile* file = reactivityfile::open( binaryFile.c_str() );
+		if( file == NULL ) {
+			cerr << binaryFile << " could not be read back.\n";
+			written = false;
+		}
+		else {
+			cout << file->records() << " transcripts." << endl;
+			delete file;
+		}
+	}
+
+	// Print confirmation of run finishing.
+	if( written ) { cout << calcType << " complete." << endl; }
+	else { cerr << calcType << " complete with errors." << endl; }
+	return written;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main method to run the program.
+///////////////////////////////////////////////////////////////////////////////
+int main( int argc, char* argv[] ) {
+
+	ReactivityConverter* runner = new ReactivityConverter();
+	bool parseable = runner->parse( argc, argv );
+	bool written = false;
+	if( parseable == true ) { written = runner->run(); }
+	delete runner;
+	return written ? 0 : 1;
+}
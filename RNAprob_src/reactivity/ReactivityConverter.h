@@ -0,0 +1,55 @@
+/*
+ * A program that converts a multi-transcript reactivity file from the text form to the binary form.
+ * RNAprob maps the binary form and finds the record of a transcript in its index, without reading the rest of the file.
+ */
+
+#ifndef REACTIVITYCONVERTER_INTERFACE_H
+#define REACTIVITYCONVERTER_INTERFACE_H
+
+#include <iostream>
+#include <string>
+#include "../src/ParseCommandLine.h"
+
+using namespace std;
+
+class ReactivityConverter {
+ public:
+	// Public constructor and methods.
+
+	/*
+	 * Name:        Constructor.
+	 * Description: Initializes all private variables.
+	 */
+	ReactivityConverter();
+
+	/*
+	 * Name:        parse
+	 * Description: Parses command line arguments to determine what options are required for a particular calculation.
+	 * Arguments:
+	 *     1.   The number of command line arguments.
+	 *     2.   The command line arguments themselves.
+	 * Returns:
+	 *     True if parsing completed without errors, false if not.
+	 */
+	bool parse( int argc, char** argv );
+
+	/*
+	 * Name:        run
+	 * Description: Convert the file.
+	 * Returns:
+	 *     True if the binary file was written, false if not.
+	 */
+	bool run();
+
+ private:
+	// Private variables.
+
+	// Description of the calculation type.
+	string calcType;
+
+	// The input text file and the output binary file.
+	string textFile;
+	string binaryFile;
+};
+
+#endif /* REACTIVITYCONVERTER_INTERFACE_H */
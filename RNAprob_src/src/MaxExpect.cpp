@@ -32,12 +32,93 @@ using namespace std;
 
 const double DOUBLE_DELTA = 1e-13; //the amount the doubles can differ - an estimate of precision for this calculation
 
+//a mask array indicating the identity of canonical pairs
+static const bool canonicalpair[6][6]={{false,false,false,false,false,false},{false,false,false,false,true,false},{false,false,false,true,false,false},{false,false,true,false,true,false},
+	{false,true,false,true,false,false},{false,false,false,false,false,false}};
+
+
+meaarray::meaarray(int size, bool lower) {
+	long total,offset;
+	int i;
+
+	total = ((long) (size+1)*(size+2))/2;
+	block = new double [total];
+
+	//Point each row into the block: an upper row a holds b=a..size and is shifted by a, so dg[a][a] is its first element,
+		//and a lower row a holds b=0..a
+	dg = new double *[size+1];
+	offset = 0;
+	for (i=0;i<=size;i++) {
+		if (lower) {
+			dg[i] = block + offset;
+			offset += i+1;
+		}
+		else {
+			dg[i] = block + offset - i;
+			offset += size+1-i;
+		}
+	}
+
+}
+
+meaarray::~meaarray() {
+	delete[] dg;
+	delete[] block;
+}
+
+
+meafill::meafill(structure *ct, meaarray *bpProbArray, double *bpSSProbArray, double gamma, bool OnlyCanonical) {
+	this->ct = ct;
+	this->bpProbArray = bpProbArray;
+	this->bpSSProbArray = bpSSProbArray;
+	this->gamma = gamma;
+	this->OnlyCanonical = OnlyCanonical;
+
+	w = new meaarray(ct->GetSequenceLength());
+	wcolumn = new meaarray(ct->GetSequenceLength(),true);
+	wprime = new meaarray(ct->GetSequenceLength());
+	wprimecolumn = new meaarray(ct->GetSequenceLength(),true);
+}
+
+meafill::~meafill() {
+	delete w;
+	delete wcolumn;
+	delete wprime;
+	delete wprimecolumn;
+}
+
+//  v = 2*gamma*probability + w(subloop)
+double meafill::v(int i, int j) {
+
+	if ((!canonicalpair[ct->numseq[i]][ct->numseq[j]])&&OnlyCanonical) return -DOUBLE_INFINITY;
+
+	//with no nucleotides between i and j, the subloop is empty
+	if (j-i<2) return 2 * gamma * bpProbArray->f(i,j);
+	return 2 * gamma * bpProbArray->f(i,j) + w->f(i+1,j-1);
+
+}
+
+//  v' = 2*gamma*probability + w'(exterior fragment), with only the 5' or the 3' end of the exterior fragment
+	//at the ends of the sequence
+double meafill::vprime(int i, int j) {
+
+	if ((!canonicalpair[ct->numseq[i]][ct->numseq[j]])&&OnlyCanonical) return -DOUBLE_INFINITY;
+
+	if (i>1&&j<ct->GetSequenceLength()) return 2 * gamma * bpProbArray->f(i,j) + wprime->f(i-1,j+1);
+	else if (i>1) return 2 * gamma * bpProbArray->f(i,j) + w->f(1,i-1);
+	else if (j<ct->GetSequenceLength()) return 2 * gamma * bpProbArray->f(i,j) + w->f(j+1,ct->GetSequenceLength());
+	else return 2 * gamma * bpProbArray->f(i,j);
+
+}
+
 
 /*
  * Method for executing the traceback through v and w to find
  * the optimal structure with the highest bp probability 
  */
-void traceBack(structure *ct, double **vwArray, double **bpProbArray, double gamma, int ip, int jp) {
+void traceBack(meafill *fill, int ip, int jp) {
+	structure *ct = fill->ct;
+	meaarray *w = fill->w;
 	int i, j;
 	int branchPt;
 	bool foundTrace = false; // used to determine if the traceback value was found
@@ -58,7 +139,7 @@ void traceBack(structure *ct, double **vwArray, double **bpProbArray, double gam
 		foundTrace = false;
 
 		#if defined DEBUG
-			printf(" Stack pull: i:j %i:%i - probability: %21.17f checking if V = W\n", i, j, vwArray[i][j]);
+			printf(" Stack pull: i:j %i:%i - probability: %21.17f checking if V = W\n", i, j, w->f(i,j));
 		#endif
 		
 		// check for the end of a hairpin
@@ -69,7 +150,7 @@ void traceBack(structure *ct, double **vwArray, double **bpProbArray, double gam
 			#endif
 		}
 		// check to see if v value is equal to w
-		else if (doubleEqual(vwArray[j][i], vwArray[i][j]))
+		else if (doubleEqual(fill->v(i,j), w->f(i,j)))
 		{
 			// add to the bp list set to each other
 			ct->SetPair(i,j,ct->GetNumberofStructures());
@@ -77,8 +158,8 @@ void traceBack(structure *ct, double **vwArray, double **bpProbArray, double gam
 			
 
 			#if defined DEBUG
-				printf("   Basepair found, pushing i+1:j-1 %i:%i with a probability of: %21.17f to the stack\n",
-					i+1, j-1, vwArray[i+1][j-1]);
+				printf("   Basepair found, pushing i+1:j-1 %i:%i to the stack\n",
+					i+1, j-1);
 			#endif
 
 			expectMxStk->push(i+1, j-1);
@@ -92,7 +173,7 @@ void traceBack(structure *ct, double **vwArray, double **bpProbArray, double gam
 			#endif
 
 			// check 5' neighbor
-			if (doubleEqual(vwArray[i][j], (vwArray[i+1][j]) + vwArray[i][i]) )
+			if (doubleEqual(w->f(i,j), (w->f(i+1,j)) + w->f(i,i)) )
 			{
 				foundTrace = true;
 				expectMxStk->push(i+1, j);
@@ -101,7 +182,7 @@ void traceBack(structure *ct, double **vwArray, double **bpProbArray, double gam
 				#endif
 			}
 			// check 3' neighbor
-			else if (doubleEqual(vwArray[i][j], (vwArray[i][j-1]) + vwArray[j][j]) )
+			else if (doubleEqual(w->f(i,j), (w->f(i,j-1)) + w->f(j,j)) )
 			{
 				foundTrace = true;
 				expectMxStk->push(i, j-1);
@@ -112,7 +193,7 @@ void traceBack(structure *ct, double **vwArray, double **bpProbArray, double gam
 			// else must be a branch
 			else
 			{
-				foundTrace = getStructure(i, j, vwArray[i][j], vwArray, &branchPt);
+				foundTrace = getStructure(i, j, w->f(i,j), w, &branchPt);
 
 				#if defined DEBUG
 					printf("  Looked for multibranch on stack: [%i][%i] and received %i\n",i,j,foundTrace);
@@ -144,7 +225,10 @@ void traceBack(structure *ct, double **vwArray, double **bpProbArray, double gam
  * Method for executing the traceback through v and w to find
  * the optimal structure with the highest bp probability 
  */
-void traceBackExternal(structure *ct, double **vwArray, double **vwPArray, double **bpProbArray, double gamma, int ip, int jp) {
+void traceBackExternal(meafill *fill, int ip, int jp) {
+	structure *ct = fill->ct;
+	meaarray *w = fill->w;
+	meaarray *wprime = fill->wprime;
 	int i, j, k;
 	//int branchPt;
 	bool foundTrace = false; // used to determine if the traceback value was found
@@ -161,8 +245,8 @@ void traceBackExternal(structure *ct, double **vwArray, double **vwPArray, doubl
 	
 
 	if (ip>1&&jp<ct->GetSequenceLength()) expectMxStk->push(ip-1, jp+1);
-	else if (ip>1) traceBack(ct,vwArray,bpProbArray,gamma,1,ip-1);
-	else if (jp<ct->GetSequenceLength()) traceBack(ct,vwArray,bpProbArray,gamma,jp+1,ct->GetSequenceLength());
+	else if (ip>1) traceBack(fill,1,ip-1);
+	else if (jp<ct->GetSequenceLength()) traceBack(fill,jp+1,ct->GetSequenceLength());
 	
 
 	// continue processing while the stack has values
@@ -172,29 +256,29 @@ void traceBackExternal(structure *ct, double **vwArray, double **vwPArray, doubl
 		foundTrace = false;
 
 		#if defined DEBUG
-			printf(" Stack pull: i:j %i:%i - probability: %21.17f checking if V = W\n", i, j, vwArray[i][j]);
+			printf(" Stack pull: i:j %i:%i - probability: %21.17f checking if V = W\n", i, j, wprime->f(i,j));
 		#endif
 		
 		
 		
 		// check to see if v value is equal to w
-		if (doubleEqual(vwPArray[j][i], vwPArray[i][j]))
+		if (doubleEqual(fill->vprime(i,j), wprime->f(i,j)))
 		{
 			// add to the bp list set to each other
 			ct->SetPair(i,j,ct->GetNumberofStructures());
 			
 
 			#if defined DEBUG
-				printf("   Basepair found, pushing i+1:j-1 %i:%i with a probability of: %21.17f to the stack\n",
-					i+1, j-1, vwPArray[i+1][j-1]);
+				printf("   Basepair found, pushing i-1:j+1 %i:%i to the stack\n",
+					i-1, j+1);
 			#endif
 
 			if (i>1&&j<ct->GetSequenceLength()) expectMxStk->push(i-1, j+1);
-			else if (i>1) traceBack(ct,vwArray,bpProbArray,gamma,1,i-1);
-			else if (j<ct->GetSequenceLength()) traceBack(ct,vwArray,bpProbArray,gamma,j+1,ct->GetSequenceLength());
+			else if (i>1) traceBack(fill,1,i-1);
+			else if (j<ct->GetSequenceLength()) traceBack(fill,j+1,ct->GetSequenceLength());
 			
 
-		} // end if vwPArray = bp probability total, then bp was found
+		} // end if vprime = wprime, then bp was found
 		// else the bases assessed are not paired
 		else
 		{
@@ -204,7 +288,7 @@ void traceBackExternal(structure *ct, double **vwArray, double **vwPArray, doubl
 
 			// check 5' neighbor
 			if (i>1) {
-				if (doubleEqual(vwPArray[i][j], vwPArray[i-1][j] + vwArray[i][i]) )
+				if (doubleEqual(wprime->f(i,j), wprime->f(i-1,j) + w->f(i,i)) )
 				{
 					foundTrace = true;
 					expectMxStk->push(i-1, j);
@@ -215,7 +299,7 @@ void traceBackExternal(structure *ct, double **vwArray, double **vwPArray, doubl
 			}
 			if (j<ct->GetSequenceLength()&&!foundTrace) {
 			// check 3' neighbor
-				if (doubleEqual(vwPArray[i][j], (vwPArray[i][j+1]) + vwArray[j][j]) )
+				if (doubleEqual(wprime->f(i,j), (wprime->f(i,j+1)) + w->f(j,j)) )
 				{
 					foundTrace = true;
 					expectMxStk->push(i, j+1);
@@ -225,7 +309,7 @@ void traceBackExternal(structure *ct, double **vwArray, double **vwPArray, doubl
 				}
 			}
 			if (i==1&&j==ct->GetSequenceLength()&&!foundTrace) {
-				if (doubleEqual(vwPArray[i][j],vwArray[j][j]+vwArray[i][i])) foundTrace=true;
+				if (doubleEqual(wprime->f(i,j),w->f(j,j)+w->f(i,i))) foundTrace=true;
 
 			}
 			// else must be a branch
@@ -237,9 +321,9 @@ void traceBackExternal(structure *ct, double **vwArray, double **vwPArray, doubl
 				#endif
 
 				for (k=2;k< i&&!foundTrace; k++) {
-					if (doubleEqual(vwPArray[i][j] ,vwArray[k][i]+vwPArray[k-1][j])) {
+					if (doubleEqual(wprime->f(i,j) ,w->f(k,i)+wprime->f(k-1,j))) {
 						foundTrace = true;
-						traceBack(ct,vwArray,bpProbArray,gamma,k,i);
+						traceBack(fill,k,i);
 						expectMxStk->push(k-1,j);
 
 					}
@@ -249,11 +333,11 @@ void traceBackExternal(structure *ct, double **vwArray, double **vwPArray, doubl
 
 				for (k=j+1;k<ct->GetSequenceLength()&&!foundTrace;k++) {
 
-					if (doubleEqual(vwPArray[i][j],vwArray[j][k]+vwPArray[i][k+1])) {
+					if (doubleEqual(wprime->f(i,j),w->f(j,k)+wprime->f(i,k+1))) {
 
 
 						foundTrace=true;
-						traceBack(ct,vwArray,bpProbArray,gamma,j,k);
+						traceBack(fill,j,k);
 						expectMxStk->push(i,k+1);
 				
 
@@ -280,7 +364,12 @@ void traceBackExternal(structure *ct, double **vwArray, double **vwPArray, doubl
 
 
 //Trace is responsible for coordinating traceback of suboptimal (and optimal) structures
-void trace(structure *ct, double **vwArray, double **vwPArray, double **bpProbArray, double gamma, double maxPercent, int maxStructures, int Window) {
+void trace(meafill *fill, double maxPercent, int maxStructures, int Window) {
+
+	structure *ct = fill->ct;
+	meaarray *w = fill->w;
+	meaarray *bpProbArray = fill->bpProbArray;
+	double gamma = fill->gamma;
 
 	bool **mark;
 	register int number;
@@ -320,8 +409,8 @@ void trace(structure *ct, double **vwArray, double **vwPArray, double **bpProbAr
 
 
 	//Determine the miniumum allowable score using the best score and maxPercent
-	crit= ((vwArray[1][number])*((maxPercent+DOUBLE_DELTA)/100.0));//DOUBLE_DELTAis a tolerance term
-	crit =  vwArray[1][number] - crit;
+	crit= ((w->f(1,number))*((maxPercent+DOUBLE_DELTA)/100.0));//DOUBLE_DELTAis a tolerance term
+	crit =  w->f(1,number) - crit;
 
 
 
@@ -350,12 +439,13 @@ void trace(structure *ct, double **vwArray, double **vwPArray, double **bpProbAr
 
 			//check the best score for a structure conating the i-j pair
 			//Put it in the heap if the score is good enough
-			if ((vwArray[j][i]+vwPArray[j][i]-2*gamma*bpProbArray[j][i])>=crit&&bpProbArray[j][i]>DOUBLE_DELTA) {
+			double score = fill->v(i,j)+fill->vprime(i,j)-2*gamma*bpProbArray->f(i,j);
+			if (score>=crit&&bpProbArray->f(i,j)>DOUBLE_DELTA) {
 
    				num++;
    				heapi[num]=i;
    				heapj[num]=j;
-				energy[num] = (vwArray[j][i]+vwPArray[j][i]-2*gamma*bpProbArray[j][i]);
+				energy[num] = score;
 	   			
 			}
 
@@ -439,9 +529,8 @@ void trace(structure *ct, double **vwArray, double **vwPArray, double **bpProbAr
 		   
 		   ct->SetPair(iret,jret,ct->GetNumberofStructures());
 		   
-			traceBack(ct, vwArray, bpProbArray, gamma, iret+1, jret-1);//internal fragment
-		   //traceBackExternal(ct, vwArray, vwPArray, bpProbArray, gamma, 2, 72);
-			traceBackExternal(ct, vwArray, vwPArray, bpProbArray, gamma, iret, jret);//external fragment
+			traceBack(fill, iret+1, jret-1);//internal fragment
+			traceBackExternal(fill, iret, jret);//external fragment
 
        		ct->SetEnergy(ct->GetNumberofStructures(),energy[cntr]);
 				
@@ -508,322 +597,181 @@ void trace(structure *ct, double **vwArray, double **vwPArray, double **bpProbAr
 }//end trace
 
 
-void MaxExpectFill(structure *ct, pfunctionclass *v, PFPRECISION *w5, pfdatatable *pfdata, bool *lfce, bool *mod, forceclass *fce, double maxPercent, int maxStructures, int Window, double gamma, TProgressDialog *progress) {
-	double **bpProbArray; //contains the raw bp probabilities for each bp
+void MaxExpectFill(structure *ct, pfunctionclass *v, pfunctionclass *v2, PFPRECISION *w5, pfdatatable *pfdata, bool *lfce, bool *mod, forceclass *fce, double maxPercent, int maxStructures, int Window, double gamma, TProgressDialog *progress) {
+	meaarray *bpProbArray; //contains the raw bp probabilities for each bp
 	double *bpSSProbArray; //contains the raw single strand probability for a base
-	double **vwArray;  //contains v and w recursion values
-	double **vwPArray; //the v' and w' recursion values
 
-	double *w3Array,*w5Array;//w3Array[i] is the maximum score from nucletides i to ct->GetSequenceLength()
-							//w5Array[i] is the maximum score from nucleotides 1 to i
+	bpProbArray = new meaarray(ct->GetSequenceLength());
+	bpSSProbArray = new double [ct->GetSequenceLength()+1];
 
-	
+	MaxExpectProbabilities(ct, v, v2, w5, pfdata, lfce, mod, fce, bpProbArray, bpSSProbArray);
+	MaxExpectTrace(ct, bpProbArray, bpSSProbArray, maxPercent, maxStructures, Window, gamma, progress);
 
-	//allocate main arrays and initialize the Arrays to defaults
-	bpProbArray = new double *[ct->GetSequenceLength()+1];
-	bpSSProbArray = new double [ct->GetSequenceLength()+1];
-	vwArray = new double *[ct->GetSequenceLength()+1];
-	vwPArray = new double *[ct->GetSequenceLength()+1];
+	delete bpProbArray;
+	delete[] bpSSProbArray;
 
-	int i, j, iSmall, jBig, Length;
-	
-	
-	//double sumPij = 0; //holds the sum of probabilities for base pairs based on a specific i over js
+}
 
 
-	for (i=0;i<=ct->GetSequenceLength();i++) {
-		bpProbArray[i] = new double [ct->GetSequenceLength()+1];
-		vwArray[i] = new double [ct->GetSequenceLength()+1];
-		vwPArray[i] = new double [ct->GetSequenceLength()+1];
+//Calculate the pair and single strand probabilities used by the fill
+void MaxExpectProbabilities(structure *ct, pfunctionclass *v, pfunctionclass *v2, PFPRECISION *w5, pfdatatable *pfdata, bool *lfce, bool *mod, forceclass *fce, meaarray *bpProbArray, double *bpSSProbArray) {
+	int i, j;
 
-		//ct->basepr[1][i] = 0;
-		bpSSProbArray[i] = 0;
+	ct->nucs[0] = ' ';
 
-		for (j=0;j<=ct->GetSequenceLength();j++) {
-			bpProbArray[i][j]=0;
-			vwArray[i][j]=-0;
-			vwPArray[i][j]=-0;
+	//Calculate the base pair probabilities to start...
+	//The probabilities are independent of each other, so the rows are calculated in parallel with SMP.
+	// JG 20071226 - modified to just check probability rather than canonical
+#ifdef SMP
+#pragma omp parallel for private(j) schedule(dynamic)
+#endif
+	for (i=1; i<=ct->GetSequenceLength(); i++)
+	{
+		for (j=i+MIN_HP_LENGTH-1; j<=ct->GetSequenceLength(); j++)
+		{
+			bpProbArray->f(i,j) = calculateprobability(i, j, v, v2, w5, ct, pfdata, lfce, mod, pfdata->scaling, fce);
 		}
 	}
 
-	#if defined DEBUG
-		w3Array = new double [ct->GetSequenceLength()+1];
-		w5Array = new double [ct->GetSequenceLength()+1];
-	#else
-		w3Array = NULL;
-		w5Array = NULL;
-
-	#endif
-
-
-		ct->nucs[0] = ' ';
-
-	// Recursion rules investigate for vwArray
-	//    1)  if the base pair (BP) probability value is 0, skip that pair
-	//    2)  hairpin turns at 5 BP
-	//    3)  stack/internal/bulge pairing at 7 BPs 
-	//    4)  multibranching at 12 BPs (2 hairpins and a stack)
-	// Because of the rules for hairpin, the probabilities 
-	//    can be taken from the bpProbArray directly until j-i > 5
-	
 	// Calculate the single stranded probabilities for each base
 	// Pi = 1 - (for all j, sum(Pij)
-	// fill in w for the diagonal for the Pi,i
 	for (i=1; i<=ct->GetSequenceLength(); i++)
 	{
-
-		
-
 		bpSSProbArray[i] = 1;
 
-		for (j=1; j<=ct->GetSequenceLength(); j++)
-		{
-			if (i!=j)
-			{
-				if (i < j)
-				{
-					iSmall = i;
-					jBig = j;
-				}
-				else
-				{
-					iSmall = j;
-					jBig = i;
-				}
-					
-				//subtract the paired probability
-				bpSSProbArray[i] = bpSSProbArray[i] - calculateprobability(iSmall, jBig, v, w5, ct, pfdata, lfce, mod, pfdata->scaling, fce);
-
-			} //end if
-
-		} // end for each paired base
+		//subtract the paired probabilities
+		for (j=1; j<i; j++) bpSSProbArray[i] = bpSSProbArray[i] - bpProbArray->f(j,i);
+		for (j=i+1; j<=ct->GetSequenceLength(); j++) bpSSProbArray[i] = bpSSProbArray[i] - bpProbArray->f(i,j);
 
-		vwArray[i][i] = bpSSProbArray[i];
 	} // end loop over each base pair
 
+}
 
-	//Calculate the base pair probabilities to start...
-	for (Length = MIN_HP_LENGTH; Length <=ct->GetSequenceLength(); Length++)
-	{
 
-		//begin populating v and w along the diagonal starting with the
-		//   shortest hairpin length
-		for (i=1, j=i+Length-1; j<=ct->GetSequenceLength(); i++, j++)
-		{
-			// check for canonical pair
-			// JG 20071226 - modified to just check probability rather than canonical
-			bpProbArray[j][i] = calculateprobability(i, j, v, w5, ct, pfdata, lfce, mod, pfdata->scaling, fce);
+//Fill and trace the structures for one gamma
+void MaxExpectTrace(structure *ct, meaarray *bpProbArray, double *bpSSProbArray, double maxPercent, int maxStructures, int Window, double gamma, TProgressDialog *progress) {
+	double *w3Array,*w5Array;//w3Array[i] is the maximum score from nucletides i to ct->GetSequenceLength()
+							//w5Array[i] is the maximum score from nucleotides 1 to i
 
-		}
-	}
+	#if defined DEBUG
+		w3Array = new double [ct->GetSequenceLength()+1];
+		w5Array = new double [ct->GetSequenceLength()+1];
+	#else
+		w3Array = NULL;
+		w5Array = NULL;
 
-	
-	MEAFill(ct, bpProbArray, bpSSProbArray, vwArray, vwPArray, w5Array, w3Array, gamma, maxPercent,progress);
+	#endif
 
+	meafill fill(ct, bpProbArray, bpSSProbArray, gamma);
 
+	MEAFill(&fill, w5Array, w3Array, maxPercent, progress);
 
 	// start traceback 
-	trace(ct, vwArray, vwPArray, bpProbArray, gamma, maxPercent, maxStructures, Window);
-
-	
-
-
-	
-
-	// Deallocate memory for the MaxExpect calculation
-	//Arrays with functionality in the fill step
-	for (i=0;i<=ct->GetSequenceLength();i++) {
-		delete[] bpProbArray[i];
-	}
-	delete[] bpProbArray;
-
-	delete[] bpSSProbArray;
-
-	for (i=0; i<=ct->GetSequenceLength(); i++) {
-		delete[] vwArray[i];
-		delete[] vwPArray[i];
-	}
-	delete[] vwArray;
-	delete[] vwPArray;
+	trace(&fill, maxPercent, maxStructures, Window);
 
 	#if defined DEBUG
 		delete[] w5Array;
 		delete[] w3Array;
 	#endif
 
-
 }
 
 
-//This is actual fill routine for maximum expewcted accuracy structure prediction:
-//bool OnlyCanonical indicates whether only Canonical pairs should be allowed
-void MEAFill(structure *ct, double **bpProbArray, double *bpSSProbArray, double **vwArray, double **vwPArray, double *w5Array, double *w3Array, double gamma, double maxPercent, TProgressDialog *progress, bool OnlyCanonical) {
+//This is actual fill routine for maximum expewcted accuracy structure prediction.
+//The fragments of each diagonal only depend on shorter fragments for w, and on longer fragments for w',
+//so each diagonal is filled in parallel with SMP.
+void MEAFill(meafill *fill, double *w5Array, double *w3Array, double maxPercent, TProgressDialog *progress) {
 
-	bool inc[6][6]={{false,false,false,false,false,false},{false,false,false,false,true,false},{false,false,false,true,false,false},{false,false,true,false,true,false},
-	{false,true,false,true,false,false},{false,false,false,false,false,false}};//a mask array indicating the identity of canonical pairs
+	structure *ct = fill->ct;
+	double *bpSSProbArray = fill->bpSSProbArray;
+	meaarray *w = fill->w;
+	meaarray *wcolumn = fill->wcolumn;
+	meaarray *wprime = fill->wprime;
+	meaarray *wprimecolumn = fill->wprimecolumn;
+	int i, Length;
 
-//<<<<<<< MaxExpect.cpp
-
-//	int size = 0;
-	//int kSS = 0; //internal single stranded probability loop variable
-//	double valueArray[maxfil];
-
-//	double max = 0;    //holds max values from called methods
-
-//	int i,j,Length,k;
-//=======
-	int Length;
-//>>>>>>> 1.19
+	// **WARNING**
+	// **WARNING** the diagonal of w is used for w of the base being single stranded
+	for (i=1; i<=ct->GetSequenceLength(); i++) {
+		w->f(i,i) = bpSSProbArray[i];
+		wcolumn->f(i,i) = bpSSProbArray[i];
+	}
 
-	// Populate the V Array
+	// Populate the W Array
 	// Start a for loop the will increment the length of the BP
 	//    expand the lenth of BPs using the bpLength loop
-	//
-	// The i axis will be "horizontal" and ASCENDING
-	//    the j axis will be "vertical" and ASCENDING 
-	//    such that the max value will be in the [max][1] array spot
-	//
-	// Populate the wArray in parallel with vArray using the vwArray
-	//    but switch the indexes to use the other side of the "square"
-	//
-	// **WARNING**
-	// **WARNING** the diagonal of vwArray is used for w of the base being single stranded
 	for (Length = MIN_HP_LENGTH; Length <=ct->GetSequenceLength(); Length++)
 	{
 
 		if (((Length%10)==0)&&progress!=NULL) progress->update((100*Length)/(2*ct->GetSequenceLength()));
 
-		//begin populating v and w along the diagonal starting with the
+		//begin populating w along the diagonal starting with the
 		//   shortest hairpin length
-//<<<<<<< MaxExpect.cpp
-//		for (i=1, j=i+Length-1; j<=ct->GetSequenceLength(); i++, j++)
-//		{
-			
-//=======
 #ifdef SMP
 #pragma omp parallel for
 #endif
 		for (int j=Length; j<=ct->GetSequenceLength();j++){
 			int i=j-Length+1;	
-			int k, size;
-			int kSS = 0; //internal single stranded probability loop variable
+			int k;
 			double max = 0;
 			double valueArray[maxfil];
-//>>>>>>> 1.19
-
-			//if (!isCanonical(ct->nucs[i], ct->nucs[j]))
-			if ((!inc[ct->numseq[i]][ct->numseq[j]])&&OnlyCanonical)
-			{
-				vwArray[j][i] = -DOUBLE_INFINITY;
-				#if defined DEBUG
-					printf("v fill non-canonical v[%i][%i]\n",i,j);
-				#endif
-			}
-			else // is canonical pair or we are allowing non-canonicals
-			{
-				#if defined DEBUG
-					printf("v fill canonical v[%i][%i]\n",i,j);
-				#endif
-
-				// call the method to calculate the probability
-				// utilize gamma to adjust for pairing weight
-				// JG 20071226 - moved up:  bpProbArray[j][i] = calculateprobability(i, j, v, w5, ct, pfdata, lfce, mod, scaling, fce);
-	
-				//*************************************************
-				//  vArray logic START
-				//  vArray uses the lower left of the array
-				//  v = 2*gamma*probability + w(subloop)
-				//*************************************************
-				//if (bpLength == 2)
-				//	vwArray[j][i] = 2 * gamma * bpProbArray[j][i];
-				//if (bpLength == 3)
-				//	vwArray[j][i] = 2 * gamma * bpProbArray[j][i] + vwArray[i+1][i+1];
-				//else
-					vwArray[j][i] = 2 * gamma * bpProbArray[j][i] + vwArray[i+1][j-1];
 
-				#if defined DEBUG
-				
-					printf("  V[%i][%i]\t=\t%21.17f\n",i,j,vwArray[j][i]);
-					printf("    Pair ProbArray[%i][%i] is: %21.17f (*2gamma = %21.17f)\n",i,j,bpProbArray[j][i],
-							bpProbArray[j][i]*2*gamma);
-					printf("    SSi  ProbArray[%i]     is: %21.17f\n",i, bpSSProbArray[i]);
-					printf("    SSj  ProbArray    [%i] is: %21.17f\n",j, bpSSProbArray[j]);
-				#endif
-
-			} // end else was a canonical pair
-			//*************************************************
-			//  vArray logic END
-			//*************************************************
-			
 			//*************************************************
 			//  wArray logic START
-			//  wArray uses the upper right of the array
 			//*************************************************
-			// use the max of vArray, or its wArray neighbors
+			// use the max of v, or its w neighbors
 			// or the multibranch-stack
-			size = 4;
-			valueArray[0] = vwArray[j][i]; // vArray i,j value
-			valueArray[1] = vwArray[i+1][j] + bpSSProbArray[i]; // 5' neighbor SS
-			valueArray[2] = vwArray[i][j-1] + bpSSProbArray[j]; // 3' neighbor SS
+			valueArray[0] = fill->v(i,j); // v i,j value
+			valueArray[1] = w->f(i+1,j) + bpSSProbArray[i]; // 5' neighbor SS
+			valueArray[2] = w->f(i,j-1) + bpSSProbArray[j]; // 3' neighbor SS
 			valueArray[3] = -DOUBLE_INFINITY; 
 
 			if (Length >= MIN_MBWOS_LENGTH)
 			{
-
-				
+				// w(k+1,j) is read from the column copy, so both terms are contiguous in k
 				for (k=i+1; k < j; k++)
 				{
-					if ((vwArray[i][k] + vwArray[k+1][j])>valueArray[3]) {
+					if ((w->f(i,k) + wcolumn->f(j,k+1))>valueArray[3]) {
 
-						valueArray[3] = vwArray[i][k] + vwArray[k+1][j];
+						valueArray[3] = w->f(i,k) + wcolumn->f(j,k+1);
 
 					}
-
-					
 				} // end for multibranch choices
 
-
 			} // end if mb w/o stack check
 
-			
-
-
-
+			getMax(&max, valueArray, 4);
 
-			///////////////////////////////
-
-			getMax(&max, valueArray, size);
-
-			vwArray[i][j] = max;
+			w->f(i,j) = max;
+			wcolumn->f(j,i) = max;
 
 			#if defined DEBUG
-				printf("  W[%i][%i]\t=\t%21.17f\n",i,j,vwArray[i][j]);
+				printf("  W[%i][%i]\t=\t%21.17f\n",i,j,max);
 			#endif
 
 			//*************************************************
 			//  wArray logic END
 			//*************************************************
 
-			i++;
-
-		} // end for population of the v and w arrays along the diagonal
+		} // end for population of the w array along the diagonal
 	} // end increasing BP length loop
 
 	#if defined DEBUG
-		//w3[1] and w5[ct->GetSequenceLength()] should == vwArray[1][ct->GetSequenceLength()]
+		//w3[1] and w5[ct->GetSequenceLength()] should == w(1,ct->GetSequenceLength())
 		//If debugging, calculate w3 and w5 to check this is true
 		//Now fill w5:
+		int j;
 		w5Array[1] = bpSSProbArray[1];
 		for (i=2;i<=ct->GetSequenceLength();i++) {
 			w5Array[i] = w5Array[i-1]+bpSSProbArray[i]; //add an unpaired nucleotide
 
-			if (w5Array[i]<vwArray[i][1]) w5Array[i] = vwArray[i][1]; //check whether a whole branch is the best score
+			if (w5Array[i]<fill->v(1,i)) w5Array[i] = fill->v(1,i); //check whether a whole branch is the best score
 
 			//Now check for bifurcations
 			if (i>=MIN_MBWOS_LENGTH) {
 				for (j=1;j<=i-MIN_HP_LENGTH;j++) {
 
-					if (w5Array[i]<(w5Array[j]+vwArray[i][j+1])) w5Array[i] = w5Array[j]+vwArray[i][j+1];
+					if (w5Array[i]<(w5Array[j]+fill->v(j+1,i))) w5Array[i] = w5Array[j]+fill->v(j+1,i);
 
 				}//end loop over j
 
@@ -836,13 +784,13 @@ void MEAFill(structure *ct, double **bpProbArray, double *bpSSProbArray, double
 		for (i=ct->GetSequenceLength()-1;i>=1;i--) {
 			w3Array[i] = w3Array[i+1] +bpSSProbArray[i]; //add an unpaired nucleotide 
 
-			if (w3Array[i]<vwArray[ct->GetSequenceLength()][i]) w3Array[i] = vwArray[ct->GetSequenceLength()][i]; //check whether a whole branch is the best score
+			if (w3Array[i]<fill->v(i,ct->GetSequenceLength())) w3Array[i] = fill->v(i,ct->GetSequenceLength()); //check whether a whole branch is the best score
 
 			//Now check for bifurcations
 			if ((ct->GetSequenceLength()-i+1)>=MIN_MBWOS_LENGTH) {
 				for (j=ct->GetSequenceLength();j>=i+MIN_HP_LENGTH-1;j--) {
 
-					if (w3Array[i]<(w3Array[j]+vwArray[j-1][i])) w3Array[i] = w3Array[j]+vwArray[j-1][i];
+					if (w3Array[i]<(w3Array[j]+fill->v(i,j-1))) w3Array[i] = w3Array[j]+fill->v(i,j-1);
 
 				}//end loop over j
 
@@ -852,133 +800,67 @@ void MEAFill(structure *ct, double **bpProbArray, double *bpSSProbArray, double
 	#endif
 
 
-	// Populate the V' Array
-	
-	// **WARNING**
-	// **WARNING** the diagonal of vwArray is used for w of the base being single stranded
+	// Populate the W' Array
 	for (Length = ct->GetSequenceLength(); Length >= MIN_HP_LENGTH; Length--) 
 	{
-//<<<<<<< MaxExpect.cpp
-//		if (((Length%10)==0)&&progress!=NULL) progress->update((200*(ct->GetSequenceLength()-Length))/(2*ct->GetSequenceLength()));
-//		for (i=1, j=i+Length-1; j<=ct->GetSequenceLength(); i++, j++)
-//=======
 		if (((Length%10)==0)&&progress!=NULL) progress->update((200*(ct->GetSequenceLength()-Length))/(2*ct->GetSequenceLength()));
 #ifdef SMP
 #pragma omp parallel for
 #endif
 		for (int j=Length;j<=ct->GetSequenceLength();j++)
-//>>>>>>> 1.19
 		{
 			int i=j-Length+1;	
-			int k, size;
-			int kSS = 0; //internal single stranded probability loop variable
+			int k;
 			double max = 0;
 			double valueArray[maxfil];
-			
-
-
-
-			//if (!isCanonical(ct->nucs[i], ct->nucs[j]))
-			if ((!inc[ct->numseq[i]][ct->numseq[j]])&&OnlyCanonical)
-			{
-				vwPArray[j][i] = -DOUBLE_INFINITY;
-				#if defined DEBUG
-					printf("v fill non-canonical v[%i][%i]\n",i,j);
-				#endif
-			}
-			else // is canonical pair
-			{
-				#if defined DEBUG
-					printf("v fill canonical v[%i][%i]\n",i,j);
-				#endif
-
-				if (i>1&&j<ct->GetSequenceLength()) {
-					vwPArray[j][i] = 2 * gamma * bpProbArray[j][i] + vwPArray[i-1][j+1];
-				}
-				else if (i>1) {
-					vwPArray[j][i] = 2 * gamma * bpProbArray[j][i] + vwArray[1][i-1];	
-				
-				}
-				else if (j<ct->GetSequenceLength()) {
-					vwPArray[j][i] = 2 * gamma * bpProbArray[j][i] + vwArray[j+1][ct->GetSequenceLength()];	
-				}
-				else vwPArray[j][i] = 2 * gamma * bpProbArray[j][i];
-
 
-				#if defined DEBUG
-				
-					printf("  V[%i][%i]\t=\t%21.17f\n",i,j,vwArray[j][i]);
-					printf("    Pair ProbArray[%i][%i] is: %21.17f (*2gamma = %21.17f)\n",i,j,bpProbArray[j][i],
-							bpProbArray[j][i]*2*gamma);
-					printf("    SSi  ProbArray[%i]     is: %21.17f\n",i, bpSSProbArray[i]);
-					printf("    SSj  ProbArray    [%i] is: %21.17f\n",j, bpSSProbArray[j]);
-				#endif
-
-			} // end else was a canonical pair
-			//*************************************************
-			//  vArray logic END
 			//*************************************************
-			
+			//  w'Array logic START
 			//*************************************************
-			//  wArray logic START
-			//  wArray uses the upper right of the array
-			//*************************************************
-			// use the max of vArray, or its wArray neighbors
+			// use the max of v', or its w' neighbors
 			// or the multibranch-stack
-			size = 4;
-			valueArray[0] = vwPArray[j][i]; // vArray i,j value
-			if (i>1) valueArray[1] = vwPArray[i-1][j] + bpSSProbArray[i]; // 5' neighbor SS
+			valueArray[0] = fill->vprime(i,j); // v' i,j value
+			if (i>1) valueArray[1] = wprime->f(i-1,j) + bpSSProbArray[i]; // 5' neighbor SS
 			else valueArray[1] = -DOUBLE_INFINITY;
-			if (j<ct->GetSequenceLength()) valueArray[2] = vwPArray[i][j+1] + bpSSProbArray[j];// 3' neighbor SS
+			if (j<ct->GetSequenceLength()) valueArray[2] = wprime->f(i,j+1) + bpSSProbArray[j];// 3' neighbor SS
 			else if (i==1) valueArray[2] = bpSSProbArray[j] + bpSSProbArray[i];//case where i==1 and j==N
 			else valueArray[2] = -DOUBLE_INFINITY;
 			valueArray[3] = -DOUBLE_INFINITY; 
 
-			
+			// w(k,i) and w'(k-1,j) are read from the column copies, so the terms are contiguous in k
 			for (k=2; k < i; k++)
 			{
-				if ((vwArray[k][i] + vwPArray[k-1][j])>valueArray[3]) {
+				if ((wcolumn->f(i,k) + wprimecolumn->f(j,k-1))>valueArray[3]) {
 
-					valueArray[3] = vwArray[k][i] + vwPArray[k-1][j];
+					valueArray[3] = wcolumn->f(i,k) + wprimecolumn->f(j,k-1);
 
 				}
-				
-
-				
 			} // end for multibranch choices -1
 
 			for (k=j+1; k < ct->GetSequenceLength(); k++)
 			{
-				if ((vwArray[j][k] + vwPArray[i][k+1])>valueArray[3]) {
+				if ((w->f(j,k) + wprime->f(i,k+1))>valueArray[3]) {
 
-					valueArray[3] = vwArray[j][k] + vwPArray[i][k+1];
+					valueArray[3] = w->f(j,k) + wprime->f(i,k+1);
 
 				}
-				
-
-				
 			} // end for multibranch choices -2
 
+			getMax(&max, valueArray, 4);
 
-
-			///////////////////////////////
-
-			getMax(&max, valueArray, size);
-
-			vwPArray[i][j] = max;
+			wprime->f(i,j) = max;
+			wprimecolumn->f(j,i) = max;
 
 			#if defined DEBUG
-				printf("  W[%i][%i]\t=\t%21.17f\n",i,j,vwArray[i][j]);
+				printf("  W'[%i][%i]\t=\t%21.17f\n",i,j,max);
 			#endif
 
 			//*************************************************
-			//  wArray logic END
+			//  w'Array logic END
 			//*************************************************
 
-			i++;
-
-		} // end for population of the v and w arrays along the diagonal
-	} // end increasing BP length loop
+		} // end for population of the w' array along the diagonal
+	} // end decreasing BP length loop
 
 
 }
@@ -1008,13 +890,15 @@ void bpMatch(structure *ct, char* pfsfile,
 
 
 	// define the variables for the partition function and probability methods
-	pfunctionclass *w = new pfunctionclass(ct->GetSequenceLength());
-	pfunctionclass *v = new pfunctionclass(ct->GetSequenceLength());
-	pfunctionclass *wmb = new pfunctionclass(ct->GetSequenceLength());
-	forceclass *fce = new forceclass(ct->GetSequenceLength());
-	pfunctionclass *wl = new pfunctionclass(ct->GetSequenceLength());
-	pfunctionclass *wcoax = new pfunctionclass(ct->GetSequenceLength());
-	pfunctionclass *wmbl = new pfunctionclass(ct->GetSequenceLength());
+	//the arrays are attached to the blocks of the save file by readpfsave
+	pfunctionclass *w = new pfunctionclass(ct->GetSequenceLength(),false);
+	pfunctionclass *v = new pfunctionclass(ct->GetSequenceLength(),false);
+	pfunctionclass *v2;
+	pfunctionclass *wmb = new pfunctionclass(ct->GetSequenceLength(),false);
+	forceclass *fce = new forceclass(ct->GetSequenceLength(),0,false);
+	pfunctionclass *wl = new pfunctionclass(ct->GetSequenceLength(),false);
+	pfunctionclass *wcoax = new pfunctionclass(ct->GetSequenceLength(),false);
+	pfunctionclass *wmbl = new pfunctionclass(ct->GetSequenceLength(),false);
 	PFPRECISION *w5 = new PFPRECISION [ct->GetSequenceLength()+1];
 	PFPRECISION *w3 = new PFPRECISION [ct->GetSequenceLength()+2];
 	PFPRECISION scaling;
@@ -1024,11 +908,12 @@ void bpMatch(structure *ct, char* pfsfile,
 	datatable *data = new datatable();
 	
 
-	// read the pfs file
-	readpfsave(pfsfile,ct,w5,w3,v,w,wmb,wl,wmbl,wcoax,fce,&scaling,mod,lfce,pfdata);
+	// read the pfs file; a truncated or corrupt file leaves no structures
+	if (readpfsave(pfsfile,ct,w5,w3,v,&v2,w,wmb,wl,wmbl,wcoax,fce,&scaling,mod,lfce,pfdata)==0) {
 
-	//Run the fill routine
-	MaxExpectFill(ct, v, w5, pfdata, lfce, mod, fce, maxPercent, maxStructures, Window, gamma, progress);
+		//Run the fill routine
+		MaxExpectFill(ct, v, v2, w5, pfdata, lfce, mod, fce, maxPercent, maxStructures, Window, gamma, progress);
+	}
 
 
 	// Deallocate memory for partition function primitives
@@ -1037,6 +922,7 @@ void bpMatch(structure *ct, char* pfsfile,
 	delete data;
 	delete w;
 	delete v;
+	delete v2;
 	delete wmb;
 	delete fce;
 	delete wl;
@@ -1055,16 +941,16 @@ void bpMatch(structure *ct, char* pfsfile,
 // This method attempts to find the substructure
 // Return true if the value is found
 bool getStructure(int i, int j, double branchValue,
-	                 double **vwArray, int *branchPt) 
+	                 meaarray *w, int *branchPt) 
 {
 	// look thorough the multibranch possibilities
-	for ((*branchPt) = i; *branchPt <= j; (*branchPt)++)
+	for ((*branchPt) = i; *branchPt < j; (*branchPt)++)
 	{
 		// don't allow the branch to have a 0 value
-		if ( (0 != vwArray[i][*branchPt]) && (0 != vwArray[*branchPt+1][j]) )
+		if ( (0 != w->f(i,*branchPt)) && (0 != w->f(*branchPt+1,j)) )
 		{
 			if( doubleEqual(branchValue, 
-		             (vwArray[i][*branchPt] + vwArray[*branchPt+1][j])))
+		             (w->f(i,*branchPt) + w->f(*branchPt+1,j))))
 			{
 				return true;
 			} // end if found branch value
@@ -1,3 +1,6 @@
+#ifndef MAXEXPECT_H
+#define MAXEXPECT_H
+
 #define MAX_INTER 30
 
 #ifdef _WINDOWS_GUI
@@ -13,28 +16,73 @@
 //static variables
 static double DOUBLE_INFINITY = 1e300;
 
+// meaarray holds one of the triangular arrays of doubles used by MaxExpect,
+// for the fragments i..j (1<=i<=j<=size) of a sequence.  As in arrayclass,
+// the rows are carved out of a single allocation and shifted so that f
+// indexes them directly.  An upper array holds fragment i..j at f(i,j), and a
+// lower array at f(j,i), so that the fragments that end at j are contiguous.
+// The elements are not initialized.
+class meaarray {
+	public:
+		meaarray(int size, bool lower=false);
+		~meaarray();
+
+		inline double &f(int a, int b) {return dg[a][b];}
+
+	private:
+		double *block;
+		double **dg;
+};
+
+// The arrays of the MaxExpect fill, for one gamma.  w.f(i,j) is the best score
+// of the nucleotides i to j, and w.f(i,i) the probability that i is unpaired;
+// wprime.f(i,j) is the best score of the exterior fragment, nucleotides 1 to i
+// and j to N, with i<j.  wcolumn and wprimecolumn hold the same scores
+// transposed, for the bifurcations that run down a column of w or wprime.  The
+// scores with i paired to j, v and vprime, are not stored but calculated from
+// the probability and the enclosed or enclosing fragment.
+struct meafill {
+	meafill(structure *ct, meaarray *bpProbArray, double *bpSSProbArray, double gamma, bool OnlyCanonical=true);
+	~meafill();
+
+	double v(int i, int j);
+	double vprime(int i, int j);
+
+	structure *ct;
+	meaarray *bpProbArray;
+	double *bpSSProbArray;
+	double gamma;
+	bool OnlyCanonical;
+	meaarray *w,*wcolumn,*wprime,*wprimecolumn;
+};
+
 // core functionality methods
 
 // this function runs MaxExpect using data written to disk
 void bpMatch(structure *ct, char* pfsfile, double gamma, double maxPercent, int maxStructures, int Window, TProgressDialog *progress=NULL);
 
 //This function sets up the fill routine and runs the traceback routine
-void MaxExpectFill(structure *ct, pfunctionclass *v, PFPRECISION *w5, pfdatatable *pfdata, bool *lfce, bool *mod, forceclass *fce, double maxPercent, int maxStructures, int Window, double gamma=1.0, TProgressDialog *progress=NULL);
+void MaxExpectFill(structure *ct, pfunctionclass *v, pfunctionclass *v2, PFPRECISION *w5, pfdatatable *pfdata, bool *lfce, bool *mod, forceclass *fce, double maxPercent, int maxStructures, int Window, double gamma=1.0, TProgressDialog *progress=NULL);
 
-//This is actual fill routine
-void MEAFill(structure *ct, double **bpProbArray, double *bpSSProbArray, double **vwArray, double **vwPArray, double *w5Array, double *w3Array, double gamma, double maxPercent, TProgressDialog *progress, bool OnlyCanonical=true);
+//Calculate the pair probabilities of the partition function into bpProbArray (an upper meaarray of the sequence length)
+	//and the probability that each nucleotide is unpaired into bpSSProbArray; they do not depend on gamma, so they can be
+	//reused by MaxExpectTrace for several gammas
+void MaxExpectProbabilities(structure *ct, pfunctionclass *v, pfunctionclass *v2, PFPRECISION *w5, pfdatatable *pfdata, bool *lfce, bool *mod, forceclass *fce, meaarray *bpProbArray, double *bpSSProbArray);
 
-// execute the recursion function based on probabilities from the partition function
-void bpProbRecursion(double **bpProbArray, double **vwArray, structure *ct, char* pfsfile);
+//Fill and trace the structures for one gamma from the probabilities of MaxExpectProbabilities
+void MaxExpectTrace(structure *ct, meaarray *bpProbArray, double *bpSSProbArray, double maxPercent, int maxStructures, int Window, double gamma=1.0, TProgressDialog *progress=NULL);
+
+//This is actual fill routine
+void MEAFill(meafill *fill, double *w5Array, double *w3Array, double maxPercent, TProgressDialog *progress);
 
 // execute the traceback utilizing the v and w Arrays - internal fragments ( nucs i to j, inclusive)
-void traceBack(structure *ct, double **vwArray, double **bpProbArray, double gamma, int ip, int jp);
+void traceBack(meafill *fill, int ip, int jp);
 
 // execute the traceback utilizing the v and w Arrays - external fragments ( nucs 1 to i and j to N)
-void traceBackExternal(structure *ct, double **vwArray, double **vwPArray, double **bpProbArray, double gamma, int ip, int jp);
+void traceBackExternal(meafill *fill, int ip, int jp);
 
 //Coordinates traceback of suboptimal structures
-void trace(structure *ct, double **vwArray, double **vwPArray, double **bpProbArray, double gamma, double maxPercent, int maxStructures, int Window);
+void trace(meafill *fill, double maxPercent, int maxStructures, int Window);
 
 // compares 2 double values for equality
 bool doubleEqual(double double1, double double2);
@@ -45,7 +93,9 @@ bool isCanonical(char i, char j);
 
 // get the location of a passed branch value looking for a structure value
 bool getStructure(int i, int j, double branchValue,
-                         double **vwArray, int *branchPt);
+                         meaarray *w, int *branchPt);
 
 // gets the max from a array of numbers of a defined size
 void getMax(double *max, double *valueArray, int size);
+
+#endif
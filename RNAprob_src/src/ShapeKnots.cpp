@@ -401,12 +401,6 @@ void copyStructure(structure * ct, structure* &pseudoStructAggregate, string DMS
 	if(!SHAPEFile.empty()||!DMSFile.empty()){
 		pseudoStructAggregate->SHAPE = new double [2*ct->GetSequenceLength()+1];
 		pseudoStructAggregate->SHAPEss = new double [2*ct->GetSequenceLength()+1];
-		
-		pseudoStructAggregate->SHAPEss_region = new int *[pseudoStructAggregate->GetSequenceLength() + 1];
-		for (int i = 1; i <= pseudoStructAggregate->GetSequenceLength(); i++) {
-			pseudoStructAggregate->SHAPEss_region[i] = new int [i];
-			for (int j=0;j<i;++j) pseudoStructAggregate->SHAPEss_region[i][j]=0;
-		}
 
 	}
 	
@@ -426,6 +420,7 @@ void copyStructure(structure * ct, structure* &pseudoStructAggregate, string DMS
 	if(!SHAPEFile.empty()||!DMSFile.empty()){
 		pseudoStructAggregate->SHAPEslope=ct->SHAPEslope;
 		pseudoStructAggregate->SHAPEintercept=ct->SHAPEintercept;
+		pseudoStructAggregate->SHAPEss_sums();
 	}
 }
 
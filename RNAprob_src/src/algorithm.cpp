@@ -17,6 +17,10 @@
 
 #include "structure.h"
 #include "algorithm.h"
+#include "profile.h"
+#include "minplus.h"
+#include "savemapping.h"
+#include "pairmarks.h"
 #ifdef _WINDOWS_GUI
 #include "../RNAstructure_windows_interface/platform.h"
 #else 
@@ -25,6 +29,10 @@
 #include <cstring>
 #include <cmath>
 #include <cstdlib>
+#include <vector>
+#ifdef SMP
+#include <omp.h>
+#endif
 using namespace std;
 
 
@@ -272,23 +280,23 @@ subroutine://loop starts here (I chose the goto statement to make the code more
 }
 
 //This function adds the pair between i and j to structure ct.  
-//This pair is added to the last structure structured in ct.
+//This pair is added to structure number structurenumber of ct.
 //This function is careful to register the pair for the real nucleotide indexes.  This is important because the pair could have been discovered in an exterior fragment.
-void registerbasepair(structure *ct, int i, int j) {
+void registerbasepair(structure *ct, int i, int j, int structurenumber) {
 	
 	//i and j are paired -- put that information in structure ct
 	if (j<=ct->GetSequenceLength()) {
-		ct->SetPair(i,j,ct->GetNumberofStructures());
+		ct->SetPair(i,j,structurenumber);
 	}
 	else if (i>ct->GetSequenceLength()) {
 
 		i = i - ct->GetSequenceLength();
 		j = j - ct->GetSequenceLength();
-		ct->SetPair(i,j,ct->GetNumberofStructures());
+		ct->SetPair(i,j,structurenumber);
 	}
 	else {
 		j = j-ct->GetSequenceLength();
-		ct->SetPair(i,j,ct->GetNumberofStructures());
+		ct->SetPair(i,j,structurenumber);
 	}
 	
 	return;
@@ -298,18 +306,19 @@ void registerbasepair(structure *ct, int i, int j) {
 //This function, given a pair between ii and ji, will determine base pairs
 //in the lowest free energy structure that contain that pair.
 
-//Pairs are stored in structure ct at the last structure number recorded in ct.
+//Pairs are stored in structure ct at structure number structurenumber, or if that is zero, at the last structure number recorded in ct.
+//	Traces into different structures can run in parallel.
 //This returns an error code, where zero is no error and non-zero indicates a traceback error.
 
 //If quickstructure=true, then the function knows that the fragment to traceback is from 1 to N, and the W5 array should be traced.
 #ifdef DYNALIGN_II
 int trace(structure *ct, datatable *data, int ii, int ji,
           arrayclass *v, arrayclass *v1, arrayclass *v2, arrayclass *w, arrayclass *wmb, arrayclass *w2, arrayclass *wmb2, 
-          bool *lfce, forceclass *fce, integersize *w3, integersize *w5,bool *mod,arrayclass *we,integersize energy,int open,int pair, bool quickstructure)
+          bool *lfce, forceclass *fce, integersize *w3, integersize *w5,bool *mod,arrayclass *we,integersize energy,int open,int pair, bool quickstructure, int structurenumber)
 #else
 int trace(structure *ct, datatable *data, int ii, int ji,
 		arrayclass *v, arrayclass *v1, arrayclass *v2, arrayclass *w, arrayclass *wmb, arrayclass *w2, arrayclass *wmb2, 
-		bool *lfce, forceclass *fce, integersize *w3, integersize *w5,bool *mod,bool quickstructure)
+		bool *lfce, forceclass *fce, integersize *w3, integersize *w5,bool *mod,bool quickstructure, int structurenumber)
 #endif
 {
 	stackclass *stack;
@@ -349,7 +358,7 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 	}
 
-	else stack->push(ii,ji,0,v->f(ii,ji),1); //normal traceback from a pair
+	else stack->push(ii,ji,0,v->get(ii,ji),1); //normal traceback from a pair
 #endif
 	
 	//zero all basepairs:
@@ -363,9 +372,11 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 	//}
 
 
+	if (structurenumber==0) structurenumber = ct->GetNumberofStructures();
+
 	//Add forced pairs to the underlying structure ct
 	for (k=0;k<ct->GetNumberofPairs();k++) {
-		ct->SetPair(ct->GetPair5(k),ct->GetPair3(k),ct->GetNumberofStructures());
+		ct->SetPair(ct->GetPair5(k),ct->GetPair3(k),structurenumber);
 	}
 
 	
@@ -400,71 +411,71 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 				if (i!=number&&j!=1) {
 
-					if (energy==v->f(i+1,j) + penalty(i+1,j,ct,data) +
+					if (energy==v->get(i+1,j) + penalty(i+1,j,ct,data) +
 							erg4(j,i+1,i,2,ct,data,lfce[i])) {
 						i++;
-						stack->push(i,j,0,v->f(i,j),1);
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 
 					else if ((mod[i+1]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[j]]) {
-						if (energy==v->f(i+2,j-1) + penalty(i+1,j,ct,data) +
+						if (energy==v->get(i+2,j-1) + penalty(i+1,j,ct,data) +
 								erg4(j,i+1,i,2,ct,data,lfce[i])+erg1(i+1,j,i+2,j-1,ct,data)) {
 
-							stack->push(i+2,j-1,0,v->f(i+2,j-1),1);
-							registerbasepair(ct,i+1,j);
+							stack->push(i+2,j-1,0,v->get(i+2,j-1),1);
+							registerbasepair(ct,i+1,j,structurenumber);
 							found = true;
 						}
 					}
-					if (!found&&(energy==v->f(i,j-1) + penalty(i,j-1,ct,data) +
+					if (!found&&(energy==v->get(i,j-1) + penalty(i,j-1,ct,data) +
 								erg4(j-1,i,j,1,ct,data,lfce[j]))) {
 						j--;
-						stack->push(i,j,0,v->f(i,j),1);
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 
 					else if ((!found)&&(mod[i]||mod[j-1])&&inc[ct->numseq[i]][ct->numseq[j-1]]) {
-						if (energy==v->f(i+1,j-2) + penalty(i,j-1,ct,data) +
+						if (energy==v->get(i+1,j-2) + penalty(i,j-1,ct,data) +
 									erg4(j-1,i,j,1,ct,data,lfce[j])
 									+erg1(i,j-1,i+1,j-2,ct,data)) {
 
-							registerbasepair(ct,i,j-1);
-							stack->push(i+1,j-2,0,v->f(i+1,j-2),1);
+							registerbasepair(ct,i,j-1,structurenumber);
+							stack->push(i+1,j-2,0,v->get(i+1,j-2),1);
 							found = true;
 						}
 					}
 
-					if (!found&&(energy==v->f(i+1,j-1) + penalty(i+1,j-1,ct,data) +
+					if (!found&&(energy==v->get(i+1,j-1) + penalty(i+1,j-1,ct,data) +
 								data->tstack[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]]
 								[ct->numseq[i]]+checknp(lfce[i],lfce[j])+ ct->SHAPEss_give_value(i)+ ct->SHAPEss_give_value(j))) {
 						j--;
 						i++;
-						stack->push(i,j,0,v->f(i,j),1);
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 
 					else if (!found&&(mod[i+1]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[j-1]]) {
 
-						if (energy==v->f(i+2,j-2) + penalty(i+1,j-1,ct,data) +
+						if (energy==v->get(i+2,j-2) + penalty(i+1,j-1,ct,data) +
 								data->tstack[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]]
 								[ct->numseq[i]]+checknp(lfce[i],lfce[j])+erg1(i+1,j-1,i+2,j-2,ct,data)+ ct->SHAPEss_give_value(i)+ 
 								ct->SHAPEss_give_value(j)) {
 
-							registerbasepair(ct,i+1,j-1);
-							stack->push(i+2,j-2,0,v->f(i+2,j-2),1);
+							registerbasepair(ct,i+1,j-1,structurenumber);
+							stack->push(i+2,j-2,0,v->get(i+2,j-2),1);
 							found = true;
 						}
 					}
 
-					if (!found&&(energy==v->f(i,j)+penalty(i,j,ct,data))) {
-						stack->push(i,j,0,v->f(i,j),1);
+					if (!found&&(energy==v->get(i,j)+penalty(i,j,ct,data))) {
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 
 					else if (!found&&(mod[i]||mod[j])&&inc[ct->numseq[i]][ct->numseq[j]]) {
-						if (energy==v->f(i+1,j-1)+penalty(i+1,j-1,ct,data)+erg1(i,j,i+1,j-1,ct,data)) {
-							registerbasepair(ct,i,j);
-							stack->push(i+1,j-1,0,v->f(i+1,j-1),1);
+						if (energy==v->get(i+1,j-1)+penalty(i+1,j-1,ct,data)+erg1(i,j,i+1,j-1,ct,data)) {
+							registerbasepair(ct,i,j,structurenumber);
+							stack->push(i+1,j-1,0,v->get(i+1,j-1),1);
 							found = true;
 						}
 					}
@@ -474,91 +485,91 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 #else
 
 									//start by removing nucleotides:
-				while (energy==we->f(i+1,j)) {
+				while (energy==we->get(i+1,j)) {
 				  i++;
-				  energy = we->f(i,j);
+				  energy = we->get(i,j);
 				  if (i==j) break;
 				  
 				}
-				while (energy==we->f(i,j-1)) {
+				while (energy==we->get(i,j-1)) {
 				  j--;
-				  energy = we->f(i,j);
+				  energy = we->get(i,j);
 				  if (i==j) break;
 				  
 				}
 
 					//now check for a stem:
 					
-				if (energy==v->f(i+1,j)+erg4(j,i+1,i,2,ct,data,lfce[i])+
+				if (energy==v->get(i+1,j)+erg4(j,i+1,i,2,ct,data,lfce[i])+
 				    penalty(i+1,j,ct,data)) {
 				  
 				  i++;
-				  stack->push(i,j,0,v->f(i,j),1);
+				  stack->push(i,j,0,v->get(i,j),1);
 				  found = true;
 				}
 				
 				else if ((mod[i+1]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[j]]) {
 
-				  if (energy==v->f(i+2,j-1)+erg4(j,i+1,i,2,ct,data,lfce[i])+
+				  if (energy==v->get(i+2,j-1)+erg4(j,i+1,i,2,ct,data,lfce[i])+
 				      penalty(i+1,j,ct,data)+erg1(i+1,j,i+2,j-1,ct,data)) {
 
-				    registerbasepair(ct,i+1,j);
-				    stack->push(i+2,j-1,0,v->f(i+2,j-1),1);
+				    registerbasepair(ct,i+1,j,structurenumber);
+				    stack->push(i+2,j-1,0,v->get(i+2,j-1),1);
 				    found = true;
 				  }
 				}
 
-				if (!found&&(energy==v->f(i,j-1)+erg4(j-1,i,j,1,ct,data,lfce[j])+
+				if (!found&&(energy==v->get(i,j-1)+erg4(j-1,i,j,1,ct,data,lfce[j])+
 					     penalty(i,j-1,ct,data))) {
 				  
 				  j--;
-				  stack->push(i,j,0,v->f(i,j),1);
+				  stack->push(i,j,0,v->get(i,j),1);
 				  found = true;
 				}
 				    else if (!found&&(mod[i]||mod[j-1])&&inc[ct->numseq[i]][ct->numseq[j-1]]) {
 				      
-				      if ((energy==v->f(i+1,j-2)+erg4(j-1,i,j,1,ct,data,lfce[j])+
+				      if ((energy==v->get(i+1,j-2)+erg4(j-1,i,j,1,ct,data,lfce[j])+
 					   penalty(i,j-1,ct,data)+erg1(i,j-1,i+1,j-2,ct,data))) {
 					
-					registerbasepair(ct,i,j-1);
-					stack->push(i+1,j-2,0,v->f(i+1,j-2),1);
+					registerbasepair(ct,i,j-1,structurenumber);
+					stack->push(i+1,j-2,0,v->get(i+1,j-2),1);
 					found = true;
 				      }
 				    }
 
-				    if (!found&&energy==v->f(i+1,j-1)+
+				    if (!found&&energy==v->get(i+1,j-1)+
 					data->tstack[ct->numseq[j-1]][ct->numseq[i+1]]//tstkm?
 					[ct->numseq[j]][ct->numseq[i]] + checknp(lfce[i],lfce[j])+
 					penalty(i+1,j-1,ct,data)) {
 				      
 				      i++;
 				      j--;
-				      stack->push(i,j,0,v->f(i,j),1);
+				      stack->push(i,j,0,v->get(i,j),1);
 				      found = true;
 				    }
 				    else if (!found&&(mod[i+1]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[j-1]]) {
-				      if (energy==v->f(i+2,j-2)+
+				      if (energy==v->get(i+2,j-2)+
 					  data->tstack[ct->numseq[j-1]][ct->numseq[i+1]]
 					  [ct->numseq[j]][ct->numseq[i]] + checknp(lfce[i],lfce[j])+
 					  penalty(i+1,j-1,ct,data)
 					  +erg1(i+1,j-1,i+2,j-2,ct,data)) {
 
-					registerbasepair(ct,i+1,j-1);
-					stack->push(i+2,j-2,0,v->f(i+2,j-2),1);
+					registerbasepair(ct,i+1,j-1,structurenumber);
+					stack->push(i+2,j-2,0,v->get(i+2,j-2),1);
 					found = true;
 				      }
 				    }
 
-				    if (!found&&energy==v->f(i,j)+penalty(i,j,ct,data)) {
-				      stack->push(i,j,0,v->f(i,j),1);
+				    if (!found&&energy==v->get(i,j)+penalty(i,j,ct,data)) {
+				      stack->push(i,j,0,v->get(i,j),1);
 				      found = true;
 				    }
 				    else if (!found&&(mod[i]||mod[j])&&inc[ct->numseq[i]][ct->numseq[j]]) {
 				      
-				      if (energy==v->f(i+1,j-1)+penalty(i,j,ct,data)+erg1(i,j,i+1,j-1,ct,data)) {
+				      if (energy==v->get(i+1,j-1)+penalty(i,j,ct,data)+erg1(i,j,i+1,j-1,ct,data)) {
 					
-					registerbasepair(ct,i,j);
-					stack->push(i+1,j-1,0,v->f(i+1,j-1),1);
+					registerbasepair(ct,i,j,structurenumber);
+					stack->push(i+1,j-1,0,v->get(i+1,j-1),1);
 					found = true;
 				      }
 				    }
@@ -575,117 +586,117 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 					//intermolcular folding 
 
 					//start by removing nucleotides:
-					while (energy==w2->f(i+1,j)) {
+					while (energy==w2->get(i+1,j)) {
 						i++;
-						energy = w2->f(i,j);
+						energy = w2->get(i,j);
 						if (i==j) break;
 					}
-					while (energy==w2->f(i,j-1)) {
+					while (energy==w2->get(i,j-1)) {
 						j--;
-						energy = w2->f(i,j);
+						energy = w2->get(i,j);
 						if (i==j) break;
 					}
 
 					//following commented out by DHM (5/17/08) -- this should be handled by WMB2
 					//if (fce->f(i,i)&INTER) {
 
-					//	if (energy==w2->f(i+1,j)-INFINITE_ENERGY+data->init) {
+					//	if (energy==w2->get(i+1,j)-INFINITE_ENERGY+data->init) {
 					//		i++;
-					//		energy = w2->f(i,j);
+					//		energy = w2->get(i,j);
 
 					//	}
 					//}
 					//if (fce->f(j,j)&INTER) {
 
-					//	if (energy==w2->f(i,j-1)-INFINITE_ENERGY+data->init) {
+					//	if (energy==w2->get(i,j-1)-INFINITE_ENERGY+data->init) {
 					//		j--;
-					//		energy = w2->f(i,j);
+					//		energy = w2->get(i,j);
 
 					//	}
 					//}
 
-					while (energy==w2->f(i+1,j)) {
+					while (energy==w2->get(i+1,j)) {
 						i++;
-						energy = w2->f(i,j);
+						energy = w2->get(i,j);
 						if (i==j) break;
 					}
-					while (energy==w2->f(i,j-1)) {
+					while (energy==w2->get(i,j-1)) {
 						j--;
-						energy = w2->f(i,j);
+						energy = w2->get(i,j);
 						if (i==j) break;
 					}
 
 					//now check for a stem:					
-					if (energy==v->f(i+1,j)+erg4(j,i+1,i,2,ct,data,lfce[i])+
+					if (energy==v->get(i+1,j)+erg4(j,i+1,i,2,ct,data,lfce[i])+
 							penalty(i+1,j,ct,data)) {
 
 						i++;
-						stack->push(i,j,0,v->f(i,j),1);
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 
 					else if ((mod[i+1]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[j]]) {
 
-						if (energy==v->f(i+2,j-1)+erg4(j,i+1,i,2,ct,data,lfce[i])+
+						if (energy==v->get(i+2,j-1)+erg4(j,i+1,i,2,ct,data,lfce[i])+
 								penalty(i+1,j,ct,data)+erg1(i+1,j,i+2,j-1,ct,data)) {
 
-							registerbasepair(ct,i+1,j);
-							stack->push(i+2,j-1,0,v->f(i+2,j-1),1);
+							registerbasepair(ct,i+1,j,structurenumber);
+							stack->push(i+2,j-1,0,v->get(i+2,j-1),1);
 							found = true;
 						}
 					}
-					if (!found&&(energy==v->f(i,j-1)+erg4(j-1,i,j,1,ct,data,lfce[j])+
+					if (!found&&(energy==v->get(i,j-1)+erg4(j-1,i,j,1,ct,data,lfce[j])+
 								penalty(i,j-1,ct,data))) {
 
 						j--;
-						stack->push(i,j,0,v->f(i,j),1);
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 					else if (!found&&(mod[i]||mod[j-1])&&inc[ct->numseq[i]][ct->numseq[j-1]]) { 
 
-						if (!found&&(energy==v->f(i+1,j-2)+erg4(j-1,i,j,1,ct,data,lfce[j])+
+						if (!found&&(energy==v->get(i+1,j-2)+erg4(j-1,i,j,1,ct,data,lfce[j])+
 									penalty(i,j-1,ct,data)+erg1(i,j-1,i+1,j-2,ct,data))) {
 
-							registerbasepair(ct,i,j);
-							stack->push(i+1,j-2,0,v->f(i+1,j-2),1);
+							registerbasepair(ct,i,j,structurenumber);
+							stack->push(i+1,j-2,0,v->get(i+1,j-2),1);
 							found = true;
 						}
 					}
 
-					if (!found&&(energy==v->f(i+1,j-1)+
+					if (!found&&(energy==v->get(i+1,j-1)+
 								data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]]
 								[ct->numseq[j]][ct->numseq[i]] + ct->SHAPEss_give_value(i)+ ct->SHAPEss_give_value(j) + checknp(lfce[i],lfce[j])+
 								penalty(i+1,j-1,ct,data))) {
 
 						i++;
 						j--;
-						stack->push(i,j,0,v->f(i,j),1);
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 
 					else if (!found&&(mod[i+1]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[j-1]]) {
-						if (!found&&(energy==v->f(i+2,j-2)+
+						if (!found&&(energy==v->get(i+2,j-2)+
 									data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]]
 									[ct->numseq[j]][ct->numseq[i]] + ct->SHAPEss_give_value(i) + ct->SHAPEss_give_value(j) + checknp(lfce[i],lfce[j])+
 									penalty(i+1,j-1,ct,data)+erg1(i+1,j-1,i+2,j-2,ct,data))) {
 
-							registerbasepair(ct,i+1,j-1);
-							stack->push(i+2,j-2,0,v->f(i+2,j-2),1);
+							registerbasepair(ct,i+1,j-1,structurenumber);
+							stack->push(i+2,j-2,0,v->get(i+2,j-2),1);
 							found = true;
 						}
 					}
 
-					if (!found&&(energy==v->f(i,j)+penalty(i,j,ct,data))) {
-						stack->push(i,j,0,v->f(i,j),1);
+					if (!found&&(energy==v->get(i,j)+penalty(i,j,ct,data))) {
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 
 					else if (!found&&(mod[i]||mod[j])&&inc[ct->numseq[i]][ct->numseq[j]]) {
-						if (!found&&(energy==v->f(i+1,j-1)+penalty(i,j,ct,data)
+						if (!found&&(energy==v->get(i+1,j-1)+penalty(i,j,ct,data)
 									+erg1(i,j,i+1,j-1,ct,data))) {
 
-							registerbasepair(ct,i,j);
-							stack->push(i+1,j-1,0,v->f(i+1,j-1),1);
+							registerbasepair(ct,i,j,structurenumber);
+							stack->push(i+1,j-1,0,v->get(i+1,j-1),1);
 							found = true;
 						}
 					}
@@ -694,61 +705,61 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 				if (!found) {
 
 					//start by removing nucleotides:
-					while (energy==w->f(i+1,j)+data->eparam[6]+ ct->SHAPEss_give_value(i)) {
+					while (energy==w->get(i+1,j)+data->eparam[6]+ ct->SHAPEss_give_value(i)) {
 						i++;
-						energy = w->f(i,j);
+						energy = w->get(i,j);
 						if (i==j) break;
 
 					}
-					while (energy==w->f(i,j-1)+data->eparam[6]+ ct->SHAPEss_give_value(j)&&j!=ct->GetSequenceLength()+1) {
+					while (energy==w->get(i,j-1)+data->eparam[6]+ ct->SHAPEss_give_value(j)&&j!=ct->GetSequenceLength()+1) {
 						j--;
-						energy = w->f(i,j);
+						energy = w->get(i,j);
 						if (i==j) break;
 
 					}
 
 					//now check for a stem:
 
-					if (energy==v->f(i+1,j)+erg4(j,i+1,i,2,ct,data,lfce[i])+
+					if (energy==v->get(i+1,j)+erg4(j,i+1,i,2,ct,data,lfce[i])+
 							penalty(i+1,j,ct,data)+data->eparam[10]+data->eparam[6]) {
 
 						i++;
-						stack->push(i,j,0,v->f(i,j),1);
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 
 					else if ((mod[i+1]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[j]]) {
 
-						if (energy==v->f(i+2,j-1)+erg4(j,i+1,i,2,ct,data,lfce[i])+
+						if (energy==v->get(i+2,j-1)+erg4(j,i+1,i,2,ct,data,lfce[i])+
 								penalty(i+1,j,ct,data)+data->eparam[10]+data->eparam[6]
 								+erg1(i+1,j,i+2,j-1,ct,data)) {
 
-							registerbasepair(ct,i+1,j);
-							stack->push(i+2,j-1,0,v->f(i+2,j-1),1);
+							registerbasepair(ct,i+1,j,structurenumber);
+							stack->push(i+2,j-1,0,v->get(i+2,j-1),1);
 							found = true;
 						}
 					}
 
-					if (!found&&(energy==v->f(i,j-1)+erg4(j-1,i,j,1,ct,data,lfce[j])+
+					if (!found&&(energy==v->get(i,j-1)+erg4(j-1,i,j,1,ct,data,lfce[j])+
 								penalty(i,j-1,ct,data)+data->eparam[10]+data->eparam[6])) {
 
 						j--;
-						stack->push(i,j,0,v->f(i,j),1);
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 					else if (!found&&(mod[i]||mod[j-1])&&inc[ct->numseq[i]][ct->numseq[j-1]]) {
 
-						if (energy==v->f(i+1,j-2)+erg4(j-1,i,j,1,ct,data,lfce[j])+
+						if (energy==v->get(i+1,j-2)+erg4(j-1,i,j,1,ct,data,lfce[j])+
 									penalty(i,j-1,ct,data)+data->eparam[10]+data->eparam[6]
 									+erg1(i,j-1,i+1,j-2,ct,data)) {
 
-							registerbasepair(ct,i,j-1);
-							stack->push(i+1,j-2,0,v->f(i+1,j-2),1);
+							registerbasepair(ct,i,j-1,structurenumber);
+							stack->push(i+1,j-2,0,v->get(i+1,j-2),1);
 							found = true;
 						}
 					}
 
-					if (!found&&energy==v->f(i+1,j-1)+
+					if (!found&&energy==v->get(i+1,j-1)+
 							data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]]
 							[ct->numseq[j]][ct->numseq[i]] + checknp(lfce[i],lfce[j])+
 							penalty(i+1,j-1,ct,data)+data->eparam[10]+2*data->eparam[6]
@@ -756,33 +767,33 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 						i++;
 						j--;
-						stack->push(i,j,0,v->f(i,j),1);
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 					else if (!found&&(mod[i+1]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[j-1]]) {
-						if (energy==v->f(i+2,j-2)+
+						if (energy==v->get(i+2,j-2)+
 								data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]]
 								[ct->numseq[j]][ct->numseq[i]] + checknp(lfce[i],lfce[j])+
 								penalty(i+1,j-1,ct,data)+data->eparam[10]+2*data->eparam[6]
 								+erg1(i+1,j-1,i+2,j-2,ct,data)+ ct->SHAPEss_give_value(i)+ ct->SHAPEss_give_value(j)) {
 
-							registerbasepair(ct,i+1,j-1);
-							stack->push(i+2,j-2,0,v->f(i+2,j-2),1);
+							registerbasepair(ct,i+1,j-1,structurenumber);
+							stack->push(i+2,j-2,0,v->get(i+2,j-2),1);
 							found = true;
 						}
 					}
 
-					if (!found&&energy==v->f(i,j)+penalty(i,j,ct,data)+data->eparam[10]) {
-						stack->push(i,j,0,v->f(i,j),1);
+					if (!found&&energy==v->get(i,j)+penalty(i,j,ct,data)+data->eparam[10]) {
+						stack->push(i,j,0,v->get(i,j),1);
 						found = true;
 					}
 					else if (!found&&(mod[i]||mod[j])&&inc[ct->numseq[i]][ct->numseq[j]]) {
 
-						if (energy==v->f(i+1,j-1)+penalty(i,j,ct,data)+data->eparam[10]
+						if (energy==v->get(i+1,j-1)+penalty(i,j,ct,data)+data->eparam[10]
 								+erg1(i,j,i+1,j-1,ct,data)) {
 
-							registerbasepair(ct,i,j);
-							stack->push(i+1,j-1,0,v->f(i+1,j-1),1);
+							registerbasepair(ct,i,j,structurenumber);
+							stack->push(i+1,j-1,0,v->get(i+1,j-1),1);
 							found = true;
 						}
 					}
@@ -792,56 +803,56 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 		else if (pair==2) {
 			found = false;
-			while (energy==wmb->f(i+1,j)+data->eparam[6]+ ct->SHAPEss_give_value(i)) {
+			while (energy==wmb->get(i+1,j)+data->eparam[6]+ ct->SHAPEss_give_value(i)) {
 				i++;
-				energy= wmb->f(i,j);
+				energy= wmb->get(i,j);
 				if (i==j) break;
 			}
-			while (energy==wmb->f(i,j-1)+data->eparam[6]+ ct->SHAPEss_give_value(j)) {
+			while (energy==wmb->get(i,j-1)+data->eparam[6]+ ct->SHAPEss_give_value(j)) {
 				j--;
-				energy = wmb->f(i,j);
+				energy = wmb->get(i,j);
 				if (i==j) break;
 			}
 
 			if (ct->intermolecular) {
-				while (energy==w2->f(i+1,j)) {
+				while (energy==w2->get(i+1,j)) {
 					i++;
-					energy = w2->f(i,j);
+					energy = w2->get(i,j);
 					if (i==j) break;
 
 				}
-				while (energy==w2->f(i,j-1)) {
+				while (energy==w2->get(i,j-1)) {
 					j--;
-					energy = w2->f(i,j);
+					energy = w2->get(i,j);
 					if (i==j) break;
 				}
 				//Commented out by DHM (5/17/08) - Should be handled by wmb2
 				//if (fce->f(i,i)&INTER) {
 
-				//	if (energy==w2->f(i+1,j)-INFINITE_ENERGY+data->init) {
+				//	if (energy==w2->get(i+1,j)-INFINITE_ENERGY+data->init) {
 				//		i++;
-				//		energy = w2->f(i,j);
+				//		energy = w2->get(i,j);
 
 				//	}
 				//}
 				//if (fce->f(j,j)&INTER) {
 
-				//	if (energy==w2->f(i,j-1)-INFINITE_ENERGY+data->init) {
+				//	if (energy==w2->get(i,j-1)-INFINITE_ENERGY+data->init) {
 				//		j--;
-				//		energy = w2->f(i,j);
+				//		energy = w2->get(i,j);
 
 				//	}
 				//}
 
-				while (energy==w2->f(i+1,j)) {
+				while (energy==w2->get(i+1,j)) {
 					i++;
-					energy = w2->f(i,j);
+					energy = w2->get(i,j);
 					if (i==j) break;
 
 				}
-				while (energy==w2->f(i,j-1)) {
+				while (energy==w2->get(i,j-1)) {
 					j--;
-					energy = w2->f(i,j);
+					energy = w2->get(i,j);
 					if (i==j) break;
 				}
 			}
@@ -859,84 +870,84 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 				if (i==1) {
 					k=1;
 					while(k<=j-minloop&&!found) {
-						if (energy==w5[k]+v->f(k+1,j)+penalty(k+1,j,ct,data)) {
+						if (energy==w5[k]+v->get(k+1,j)+penalty(k+1,j,ct,data)) {
 							stack->push(1,k,1,w5[k],0);
-							stack->push(k+1,j,0,v->f(k+1,j),1);
+							stack->push(k+1,j,0,v->get(k+1,j),1);
 							found = true;
 						}
 						else if ((mod[k+1]||mod[j])&&inc[ct->numseq[k+1]][ct->numseq[j]]) {
 
-							if (energy==w5[k]+v->f(k+2,j-1)+penalty(k+1,j,ct,data)
+							if (energy==w5[k]+v->get(k+2,j-1)+penalty(k+1,j,ct,data)
 									+erg1(k+1,j,k+2,j-1,ct,data)) {
 
-								registerbasepair(ct,k+1,j);
+								registerbasepair(ct,k+1,j,structurenumber);
 								stack->push(1,k,1,w5[k],0);
-								stack->push(k+2,j-1,0,v->f(k+2,j-1),1);
+								stack->push(k+2,j-1,0,v->get(k+2,j-1),1);
 								found = true;
 							}
 						}
-						if (!found&&(energy==w5[k]+v->f(k+2,j)+penalty(k+2,j,ct,data)+
+						if (!found&&(energy==w5[k]+v->get(k+2,j)+penalty(k+2,j,ct,data)+
 									erg4(j,k+2,k+1,2,ct,data,lfce[k+1]))) {
 							stack->push(1,k,1,w5[k],0);
-							stack->push(k+2,j,0,v->f(k+2,j),1);
+							stack->push(k+2,j,0,v->get(k+2,j),1);
 							found = true;
 						}
 						else if (!found&&(mod[k+2]||mod[j])&&inc[ct->numseq[k+2]][ct->numseq[j]]) {
 
 
-							if (energy==w5[k]+v->f(k+3,j-1)+penalty(k+2,j,ct,data)+
+							if (energy==w5[k]+v->get(k+3,j-1)+penalty(k+2,j,ct,data)+
 									erg4(j,k+2,k+1,2,ct,data,lfce[k+1])
 									+erg1(k+2,j,k+3,j-2,ct,data)) {
 
-								registerbasepair(ct,k+2,j);
+								registerbasepair(ct,k+2,j,structurenumber);
 								stack->push(1,k,1,w5[k],0);
-								stack->push(k+3,j-1,0,v->f(k+3,j-1),1);
+								stack->push(k+3,j-1,0,v->get(k+3,j-1),1);
 								found = true;
 							}
 						}
 
-						if (!found&&(energy==w5[k]+v->f(k+1,j-1)+penalty(k+1,j-1,ct,data)+
+						if (!found&&(energy==w5[k]+v->get(k+1,j-1)+penalty(k+1,j-1,ct,data)+
 									erg4(j-1,k+1,j,1,ct,data,lfce[j]))) {
 
 							stack->push(1,k,1,w5[k],0);
-							stack->push(k+1,j-1,0,v->f(k+1,j-1),1);
+							stack->push(k+1,j-1,0,v->get(k+1,j-1),1);
 							found = true;
 						}
 						else if (!found&&(mod[k+1]||mod[j-1])&&inc[ct->numseq[k+1]][ct->numseq[j-1]]) {
 
-							if (!found&&(energy==w5[k]+v->f(k+2,j-2)+penalty(k+1,j-1,ct,data)+
+							if (!found&&(energy==w5[k]+v->get(k+2,j-2)+penalty(k+1,j-1,ct,data)+
 										erg4(j-1,k+1,j,1,ct,data,lfce[j])
 										+erg1(k+1,j-1,k+2,j-2,ct,data))) {
 
-								registerbasepair(ct,k+1,j-1);
+								registerbasepair(ct,k+1,j-1,structurenumber);
 								stack->push(1,k,1,w5[k],0);
-								stack->push(k+2,j-2,0,v->f(k+2,j-2),1);
+								stack->push(k+2,j-2,0,v->get(k+2,j-2),1);
 								found = true;
 
 							}
 						}
 
-						if (!found&&(energy==w5[k]+v->f(k+2,j-1)+penalty(k+2,j-1,ct,data)+
+						if (!found&&(energy==w5[k]+v->get(k+2,j-1)+penalty(k+2,j-1,ct,data)+
 									data->tstack[ct->numseq[j-1]][ct->numseq[k+2]]
 									[ct->numseq[j]][ct->numseq[k+1]]+checknp(lfce[j],lfce[k+1])
 									+ ct->SHAPEss_give_value(j)+ ct->SHAPEss_give_value(k+1))) {
 
 							stack->push(1,k,1,w5[k],0);
-							stack->push(k+2,j-1,0,v->f(k+2,j-1),1);
+							stack->push(k+2,j-1,0,v->get(k+2,j-1),1);
 							found = true;
 						}
 
 						else if (!found&&(mod[k+2]||mod[j-1])&&inc[ct->numseq[k+2]][ct->numseq[j-1]]) {
 
-							if (energy==w5[k]+v->f(k+3,j-2)+penalty(k+2,j-1,ct,data)+
+							if (energy==w5[k]+v->get(k+3,j-2)+penalty(k+2,j-1,ct,data)+
 										data->tstack[ct->numseq[j-1]][ct->numseq[k+2]]
 										[ct->numseq[j]][ct->numseq[k+1]]+checknp(lfce[j],lfce[k+1])
 										+erg1(k+2,j-1,k+3,j-2,ct,data)
 										+ ct->SHAPEss_give_value(j)+ ct->SHAPEss_give_value(k+1)) {
 
-								registerbasepair(ct,k+2,j-1);
+								registerbasepair(ct,k+2,j-1,structurenumber);
 								stack->push(1,k,1,w5[k],0);
-								stack->push(k+3,j-2,0,v->f(k+3,j-2),1);
+								stack->push(k+3,j-2,0,v->get(k+3,j-2),1);
 								found = true;
 							}
 						}
@@ -945,13 +956,13 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 							//check for coaxial stacking:
 							a = k+minloop+1;
 							while (a<j-minloop&&!found) {
-								if (energy==w5[k-1]+v->f(k,a)+v->f(a+1,j)+
+								if (energy==w5[k-1]+v->get(k,a)+v->get(a+1,j)+
 										ergcoaxflushbases(k,a,a+1,j,ct,data)+
 										penalty(k,a,ct,data)+penalty(a+1,j,ct,data)) {
 
 									if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-									stack->push(k,a,0,v->f(k,a),1);
-									stack->push(a+1,j,0,v->f(a+1,j),1);
+									stack->push(k,a,0,v->get(k,a),1);
+									stack->push(a+1,j,0,v->get(a+1,j),1);
 									found = true;
 								}
 
@@ -960,60 +971,60 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 											&&inc[ct->numseq[a+1]][ct->numseq[j]]) {
 
 
-										if (energy==w5[k-1]+v->f(k+1,a-1)+v->f(a+2,j-1)+
+										if (energy==w5[k-1]+v->get(k+1,a-1)+v->get(a+2,j-1)+
 												ergcoaxflushbases(k,a,a+1,j,ct,data)+
 												penalty(k,a,ct,data)+penalty(a+1,j,ct,data)
 												+erg1(k,a,k+1,a-1,ct,data)
 												+erg1(a+1,j,a+2,j-1,ct,data)) {
 
-											registerbasepair(ct,k,a);
-											registerbasepair(ct,a+1,j);
+											registerbasepair(ct,k,a,structurenumber);
+											registerbasepair(ct,a+1,j,structurenumber);
 											if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-											stack->push(k+1,a-1,0,v->f(k+1,a-1),1);
-											stack->push(a+2,j-1,0,v->f(a+2,j-1),1);
+											stack->push(k+1,a-1,0,v->get(k+1,a-1),1);
+											stack->push(a+2,j-1,0,v->get(a+2,j-1),1);
 											found = true;
 										}
 									}
 									if (!found&&(mod[k]||mod[a])&&inc[ct->numseq[k]][ct->numseq[a]]) {
 
-										if (energy==w5[k-1]+v->f(k+1,a-1)+v->f(a+1,j)+
+										if (energy==w5[k-1]+v->get(k+1,a-1)+v->get(a+1,j)+
 												ergcoaxflushbases(k,a,a+1,j,ct,data)+
 												penalty(k,a,ct,data)+penalty(a+1,j,ct,data)
 												+erg1(k,a,k+1,a-1,ct,data)) {
 
-											registerbasepair(ct,k,a);
+											registerbasepair(ct,k,a,structurenumber);
 
 											if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-											stack->push(k+1,a-1,0,v->f(k+1,a-1),1);
-											stack->push(a+1,j,0,v->f(a+1,j),1);
+											stack->push(k+1,a-1,0,v->get(k+1,a-1),1);
+											stack->push(a+1,j,0,v->get(a+1,j),1);
 											found = true;
 										}
 									}
 
 									if (!found&&(mod[a+1]||mod[j])&&inc[ct->numseq[a+1]][ct->numseq[j]]) {
 
-										if (energy==w5[k-1]+v->f(k,a)+v->f(a+2,j-1)+
+										if (energy==w5[k-1]+v->get(k,a)+v->get(a+2,j-1)+
 												ergcoaxflushbases(k,a,a+1,j,ct,data)+
 												penalty(k,a,ct,data)+penalty(a+1,j,ct,data)
 
 												+erg1(a+1,j,a+2,j-1,ct,data)) {
 
-											registerbasepair(ct,a+1,j);
+											registerbasepair(ct,a+1,j,structurenumber);
 											if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-											stack->push(k,a,0,v->f(k,a),1);
-											stack->push(a+2,j-1,0,v->f(a+2,j-1),1);
+											stack->push(k,a,0,v->get(k,a),1);
+											stack->push(a+2,j-1,0,v->get(a+2,j-1),1);
 											found = true;
 										}
 									}
 								}
 
-								if (!found&&(energy==w5[k-1]+v->f(k,a)+v->f(a+2,j-1)+
+								if (!found&&(energy==w5[k-1]+v->get(k,a)+v->get(a+2,j-1)+
 											ergcoaxinterbases2(k,a,a+2,j-1,ct,data)+
 											penalty(k,a,ct,data)+penalty(a+2,j-1,ct,data))) {
 
 									if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-									stack->push(k,a,0,v->f(k,a),1);
-									stack->push(a+2,j-1,0,v->f(a+2,j-1),1);
+									stack->push(k,a,0,v->get(k,a),1);
+									stack->push(a+2,j-1,0,v->get(a+2,j-1),1);
 									found = true;
 								}
 
@@ -1022,60 +1033,60 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 									if ((mod[k]||mod[a])&&(mod[a+2]||mod[j-1])&&inc[ct->numseq[k]][ct->numseq[a]]
 											&&inc[ct->numseq[a+2]][ct->numseq[j-1]]) {
 
-										if (energy==w5[k-1]+v->f(k+1,a-1)+v->f(a+3,j-2)+
+										if (energy==w5[k-1]+v->get(k+1,a-1)+v->get(a+3,j-2)+
 													ergcoaxinterbases2(k,a,a+2,j-1,ct,data)+
 													penalty(k,a,ct,data)+penalty(a+2,j-1,ct,data)
 													+erg1(k,a,k+1,a-1,ct,data)
 													+erg1(a+2,j-1,a+3,j-2,ct,data)) {
 
-											registerbasepair(ct,k,a);
-											registerbasepair(ct,a+2,j-1);
+											registerbasepair(ct,k,a,structurenumber);
+											registerbasepair(ct,a+2,j-1,structurenumber);
 											if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-											stack->push(k+1,a-1,0,v->f(k+1,a-1),1);
-											stack->push(a+3,j-2,0,v->f(a+3,j-2),1);
+											stack->push(k+1,a-1,0,v->get(k+1,a-1),1);
+											stack->push(a+3,j-2,0,v->get(a+3,j-2),1);
 											found = true;
 										}
 									}
 
 									if (!found&&(mod[k]||mod[a])&&inc[ct->numseq[k]][ct->numseq[a]]) {
 
-										if (energy==w5[k-1]+v->f(k+1,a-1)+v->f(a+2,j-1)+
+										if (energy==w5[k-1]+v->get(k+1,a-1)+v->get(a+2,j-1)+
 													ergcoaxinterbases2(k,a,a+2,j-1,ct,data)+
 													penalty(k,a,ct,data)+penalty(a+2,j-1,ct,data)
 													+erg1(k,a,k+1,a-1,ct,data)) {
 
-											registerbasepair(ct,k,a);
+											registerbasepair(ct,k,a,structurenumber);
 
 											if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-											stack->push(k+1,a-1,0,v->f(k+1,a-1),1);
-											stack->push(a+2,j-1,0,v->f(a+2,j-1),1);
+											stack->push(k+1,a-1,0,v->get(k+1,a-1),1);
+											stack->push(a+2,j-1,0,v->get(a+2,j-1),1);
 											found = true;
 										}
 									}
 
 									if (!found&&(mod[a+2]||mod[j-1])&&inc[ct->numseq[a+2]][ct->numseq[j-1]]) {
 
-										if (energy==w5[k-1]+v->f(k,a)+v->f(a+3,j-2)+
+										if (energy==w5[k-1]+v->get(k,a)+v->get(a+3,j-2)+
 													ergcoaxinterbases2(k,a,a+2,j-1,ct,data)+
 													penalty(k,a,ct,data)+penalty(a+2,j-1,ct,data)
 													+erg1(a+2,j-1,a+3,j-2,ct,data)) {
 
-											registerbasepair(ct,a+2,j-1);
+											registerbasepair(ct,a+2,j-1,structurenumber);
 											if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-											stack->push(k,a,0,v->f(k,a),1);
-											stack->push(a+3,j-2,0,v->f(a+3,j-2),1);
+											stack->push(k,a,0,v->get(k,a),1);
+											stack->push(a+3,j-2,0,v->get(a+3,j-2),1);
 											found = true;
 										}
 									}
 								}
 
-								if (!found&&(energy==w5[k-1]+v->f(k+1,a)+v->f(a+2,j)+
+								if (!found&&(energy==w5[k-1]+v->get(k+1,a)+v->get(a+2,j)+
 											ergcoaxinterbases1(k+1,a,a+2,j,ct,data)+
 											penalty(k+1,a,ct,data)+penalty(a+2,j,ct,data))) {
 
 									if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-									stack->push(k+1,a,0,v->f(k+1,a),1);
-									stack->push(a+2,j,0,v->f(a+2,j),1);
+									stack->push(k+1,a,0,v->get(k+1,a),1);
+									stack->push(a+2,j,0,v->get(a+2,j),1);
 									found = true;
 								}
 
@@ -1084,48 +1095,48 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 									if ((mod[k+1]||mod[a])&&(mod[a+2]||mod[j])&&inc[ct->numseq[k+1]][ct->numseq[a]]
 											&&inc[ct->numseq[a+2]][ct->numseq[j]]) {
 
-										if (energy==w5[k-1]+v->f(k+2,a-1)+v->f(a+3,j-1)+
+										if (energy==w5[k-1]+v->get(k+2,a-1)+v->get(a+3,j-1)+
 													ergcoaxinterbases1(k+1,a,a+2,j,ct,data)+
 													penalty(k+1,a,ct,data)+penalty(a+2,j,ct,data)
 													+erg1(k+1,a,k+2,a-1,ct,data)
 													+erg1(a+2,j,a+3,j-1,ct,data)) {
 
-											registerbasepair(ct,k+1,a);
-											registerbasepair(ct,a+2,j);
+											registerbasepair(ct,k+1,a,structurenumber);
+											registerbasepair(ct,a+2,j,structurenumber);
 											if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-											stack->push(k+2,a-1,0,v->f(k+2,a-1),1);
-											stack->push(a+3,j-1,0,v->f(a+3,j-1),1);
+											stack->push(k+2,a-1,0,v->get(k+2,a-1),1);
+											stack->push(a+3,j-1,0,v->get(a+3,j-1),1);
 											found = true;
 										}
 									}
 
 									if (!found&&(mod[k+1]||mod[a])&&inc[ct->numseq[k+1]][ct->numseq[a]]) {
 
-										if (energy==w5[k-1]+v->f(k+2,a-1)+v->f(a+2,j)+
+										if (energy==w5[k-1]+v->get(k+2,a-1)+v->get(a+2,j)+
 													ergcoaxinterbases1(k+1,a,a+2,j,ct,data)+
 													penalty(k+1,a,ct,data)+penalty(a+2,j,ct,data)
 													+erg1(k+1,a,k+2,a-1,ct,data)) {
 
-											registerbasepair(ct,k+1,a);
+											registerbasepair(ct,k+1,a,structurenumber);
 
 											if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-											stack->push(k+2,a-1,0,v->f(k+2,a-1),1);
-											stack->push(a+2,j,0,v->f(a+2,j),1);
+											stack->push(k+2,a-1,0,v->get(k+2,a-1),1);
+											stack->push(a+2,j,0,v->get(a+2,j),1);
 											found = true;
 										}
 									}
 
 									if (!found&&(mod[a+2]||mod[j])&&inc[ct->numseq[a+2]][ct->numseq[j]]) {
 
-										if (energy==w5[k-1]+v->f(k+1,a)+v->f(a+3,j-1)+
+										if (energy==w5[k-1]+v->get(k+1,a)+v->get(a+3,j-1)+
 													ergcoaxinterbases1(k+1,a,a+2,j,ct,data)+
 													penalty(k+1,a,ct,data)+penalty(a+2,j,ct,data)
 													+erg1(a+2,j,a+3,j-1,ct,data)) {
 
-											registerbasepair(ct,a+2,j);
+											registerbasepair(ct,a+2,j,structurenumber);
 											if (k>1) stack->push(1,k-1,1,w5[k-1],0);
-											stack->push(k+1,a,0,v->f(k+1,a),1);
-											stack->push(a+3,j-1,0,v->f(a+3,j-1),1);
+											stack->push(k+1,a,0,v->get(k+1,a),1);
+											stack->push(a+3,j-1,0,v->get(a+3,j-1),1);
 											found = true;
 										}
 									}
@@ -1140,87 +1151,87 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 					//j==n
 					k=i+minloop;
 					while(k<=j&&!found) {
-						if (energy==w3[k]+v->f(i,k-1)+penalty(i,k-1,ct,data)) {
+						if (energy==w3[k]+v->get(i,k-1)+penalty(i,k-1,ct,data)) {
 							stack->push(k,number,1,w3[k],0);
-							stack->push(i,k-1,0,v->f(i,k-1),1);
+							stack->push(i,k-1,0,v->get(i,k-1),1);
 							found=true;
 						}
 						else if ((mod[i]||mod[k-1])&&inc[ct->numseq[i]][ct->numseq[k-1]]) {
 
-							if (energy==w3[k]+v->f(i+1,k-2)+penalty(i,k-1,ct,data)
+							if (energy==w3[k]+v->get(i+1,k-2)+penalty(i,k-1,ct,data)
 									+erg1(i,k-1,i+1,k-2,ct,data)) {
 
-								registerbasepair(ct,i,k-1);
+								registerbasepair(ct,i,k-1,structurenumber);
 								stack->push(k,number,1,w3[k],0);
-								stack->push(i+1,k-2,0,v->f(i+1,k-2),1);
+								stack->push(i+1,k-2,0,v->get(i+1,k-2),1);
 								found=true;
 							}
 						}
-						if (!found&&(energy==w3[k]+v->f(i,k-2)+penalty(i,k-2,ct,data)+
+						if (!found&&(energy==w3[k]+v->get(i,k-2)+penalty(i,k-2,ct,data)+
 									erg4(k-2,i,k-1,1,ct,data,lfce[k-1]))) {
 
 							stack->push(k,number,1,w3[k],0);
-							stack->push(i,k-2,0,v->f(i,k-2),1);
+							stack->push(i,k-2,0,v->get(i,k-2),1);
 							found=true;
 
 						}
 						else if (!found&&(mod[i]||mod[k-2])&&inc[ct->numseq[i]][ct->numseq[k-2]]) {
 
-							if (energy==w3[k]+v->f(i+1,k-3)+penalty(i,k-2,ct,data)+
+							if (energy==w3[k]+v->get(i+1,k-3)+penalty(i,k-2,ct,data)+
 										erg4(k-2,i,k-1,1,ct,data,lfce[k-1])
 										+erg1(i,k-2,i+1,k-3,ct,data)) {
 
-								registerbasepair(ct,i,k-2);
+								registerbasepair(ct,i,k-2,structurenumber);
 								stack->push(k,number,1,w3[k],0);
-								stack->push(i+1,k-3,0,v->f(i+1,k-3),1);
+								stack->push(i+1,k-3,0,v->get(i+1,k-3),1);
 								found=true;
 							}
 						}
 
-						if (!found&&(energy==w3[k]+v->f(i+1,k-1)+penalty(i+1,k-1,ct,data)+
+						if (!found&&(energy==w3[k]+v->get(i+1,k-1)+penalty(i+1,k-1,ct,data)+
 									erg4(k-1,i+1,i,2,ct,data,lfce[i]))) {
 
 							stack->push(k,number,1,w3[k],0);
-							stack->push(i+1,k-1,0,v->f(i+1,k-1),1);
+							stack->push(i+1,k-1,0,v->get(i+1,k-1),1);
 							found=true;
 
 						}
 						else if (!found&&(mod[i+1]||mod[k-1])&&inc[ct->numseq[i+1]][ct->numseq[k-1]]) {
 
-							if (energy==w3[k]+v->f(i+2,k-2)+penalty(i+1,k-1,ct,data)+
+							if (energy==w3[k]+v->get(i+2,k-2)+penalty(i+1,k-1,ct,data)+
 										erg4(k-1,i+1,i,2,ct,data,lfce[i])
 										+erg1(i+1,k-1,i+2,k-2,ct,data)) {
 
-								registerbasepair(ct,i+1,k-1);
+								registerbasepair(ct,i+1,k-1,structurenumber);
 								stack->push(k,number,1,w3[k],0);
-								stack->push(i+2,k-2,0,v->f(i+2,k-2),1);
+								stack->push(i+2,k-2,0,v->get(i+2,k-2),1);
 								found=true;
 
 							}
 
 						}
-						if (!found&&(energy==w3[k]+v->f(i+1,k-2)+penalty(i+1,k-2,ct,data)+
+						if (!found&&(energy==w3[k]+v->get(i+1,k-2)+penalty(i+1,k-2,ct,data)+
 									data->tstack[ct->numseq[k-2]][ct->numseq[i+1]]
 									[ct->numseq[k-1]][ct->numseq[i]]+
 									checknp(lfce[k-1],lfce[i])+ ct->SHAPEss_give_value(k-1)+ ct->SHAPEss_give_value(i))) {
 
 							stack->push(k,number,1,w3[k],0);
-							stack->push(i+1,k-2,0,v->f(i+1,k-2),1);
+							stack->push(i+1,k-2,0,v->get(i+1,k-2),1);
 							found=true;
 
 
 						}
 
 						else if (!found&&(mod[i+1]||mod[k-2])&&inc[ct->numseq[i+1]][ct->numseq[k-2]]) {
-							if (energy==w3[k]+v->f(i+2,k-3)+penalty(i+1,k-2,ct,data)+
+							if (energy==w3[k]+v->get(i+2,k-3)+penalty(i+1,k-2,ct,data)+
 										data->tstack[ct->numseq[k-2]][ct->numseq[i+1]]
 										[ct->numseq[k-1]][ct->numseq[i]]+
 										checknp(lfce[k-1],lfce[i])+erg1(i+1,k-2,i+2,k-3,ct,data)+ 
 										ct->SHAPEss_give_value(k-1)+ ct->SHAPEss_give_value(i)) {
 
-								registerbasepair(ct,i+1,k-2);
+								registerbasepair(ct,i+1,k-2,structurenumber);
 								stack->push(k,number,1,w3[k],0);
-								stack->push(i+2,k-3,0,v->f(i+2,k-3),1);
+								stack->push(i+2,k-3,0,v->get(i+2,k-3),1);
 								found=true;
 							}
 						}
@@ -1229,13 +1240,13 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 							a = i+minloop+1;
 							while (a<k&&!found) {
 
-								if (energy==w3[k+1]+v->f(i,a)+v->f(a+1,k)+
+								if (energy==w3[k+1]+v->get(i,a)+v->get(a+1,k)+
 										ergcoaxflushbases(i,a,a+1,k,ct,data)+
 										penalty(i,a,ct,data)+penalty(a+1,k,ct,data)) {
 
 									if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-									stack->push(i,a,0,v->f(i,a),1);
-									stack->push(a+1,k,0,v->f(a+1,k),1);
+									stack->push(i,a,0,v->get(i,a),1);
+									stack->push(a+1,k,0,v->get(a+1,k),1);
 									found =true;
 
 								}
@@ -1243,49 +1254,49 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 									if ((mod[i]||mod[a])&&(mod[a+1]||mod[k])&&inc[ct->numseq[i]][ct->numseq[a]]
 											&&inc[ct->numseq[a+1]][ct->numseq[k]]) {
-										if (energy==w3[k+1]+v->f(i+1,a-1)+v->f(a+2,k-1)+
+										if (energy==w3[k+1]+v->get(i+1,a-1)+v->get(a+2,k-1)+
 												ergcoaxflushbases(i,a,a+1,k,ct,data)+
 												penalty(i,a,ct,data)+penalty(a+1,k,ct,data)
 												+erg1(i,a,i+1,a-1,ct,data)
 												+erg1(a+1,k,a+2,k-1,ct,data)) {
 
-											registerbasepair(ct,i,a);
-											registerbasepair(ct,a+1,k);
+											registerbasepair(ct,i,a,structurenumber);
+											registerbasepair(ct,a+1,k,structurenumber);
 											if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-											stack->push(i+1,a-1,0,v->f(i+1,a-1),1);
-											stack->push(a+2,k-1,0,v->f(a+2,k-1),1);
+											stack->push(i+1,a-1,0,v->get(i+1,a-1),1);
+											stack->push(a+2,k-1,0,v->get(a+2,k-1),1);
 											found =true;
 
 										}	
 									}
 
 									if ((mod[i]||mod[a])&&!found&&inc[ct->numseq[i]][ct->numseq[a]]) {
-										if (energy==w3[k+1]+v->f(i+1,a-1)+v->f(a+1,k)+
+										if (energy==w3[k+1]+v->get(i+1,a-1)+v->get(a+1,k)+
 												ergcoaxflushbases(i,a,a+1,k,ct,data)+
 												penalty(i,a,ct,data)+penalty(a+1,k,ct,data)
 												+erg1(i,a,i+1,a-1,ct,data)) {
 
-											registerbasepair(ct,i,a);
+											registerbasepair(ct,i,a,structurenumber);
 
 											if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-											stack->push(i+1,a-1,0,v->f(i+1,a-1),1);
-											stack->push(a+1,k,0,v->f(a+1,k),1);
+											stack->push(i+1,a-1,0,v->get(i+1,a-1),1);
+											stack->push(a+1,k,0,v->get(a+1,k),1);
 											found =true;
 
 										}	
 									}
 
 									if (!found&&(mod[a+1]||mod[k])&&inc[ct->numseq[a+1]][ct->numseq[k]]) {
-										if (energy==w3[k+1]+v->f(i,a)+v->f(a+2,k-1)+
+										if (energy==w3[k+1]+v->get(i,a)+v->get(a+2,k-1)+
 												ergcoaxflushbases(i,a,a+1,k,ct,data)+
 												penalty(i,a,ct,data)+penalty(a+1,k,ct,data)
 												+erg1(a+1,k,a+2,k-1,ct,data)) {
 
 
-											registerbasepair(ct,a+1,k);
+											registerbasepair(ct,a+1,k,structurenumber);
 											if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-											stack->push(i,a,0,v->f(i,a),1);
-											stack->push(a+2,k-1,0,v->f(a+2,k-1),1);
+											stack->push(i,a,0,v->get(i,a),1);
+											stack->push(a+2,k-1,0,v->get(a+2,k-1),1);
 											found =true;
 
 										}	
@@ -1294,77 +1305,77 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 
 								}
-								if (!found&&(energy==w3[k+1]+v->f(i,a)+v->f(a+2,k-1)+
+								if (!found&&(energy==w3[k+1]+v->get(i,a)+v->get(a+2,k-1)+
 											ergcoaxinterbases2(i,a,a+2,k-1,ct,data)+
 											penalty(i,a,ct,data)+penalty(a+2,k-1,ct,data))) {
 
 									if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-									stack->push(i,a,0,v->f(i,a),1);
-									stack->push(a+2,k-1,0,v->f(a+2,k-1),1);
+									stack->push(i,a,0,v->get(i,a),1);
+									stack->push(a+2,k-1,0,v->get(a+2,k-1),1);
 									found=true;
 
 								}
 								else if (!found&&(mod[i]||mod[a]||mod[a+2]||mod[k-1])) {
 									if ((mod[i]||mod[a])&&(mod[a+2]||mod[k-1])&&inc[ct->numseq[i]][ct->numseq[a]]
 											&&inc[ct->numseq[a+2]][ct->numseq[k-1]]) {
-										if (energy==w3[k+1]+v->f(i+1,a-1)+v->f(a+3,k-2)+
+										if (energy==w3[k+1]+v->get(i+1,a-1)+v->get(a+3,k-2)+
 													ergcoaxinterbases2(i,a,a+2,k-1,ct,data)+
 													penalty(i,a,ct,data)+penalty(a+2,k-1,ct,data)
 													+erg1(i,a,i+1,a-1,ct,data)
 													+erg1(a+2,k-1,a+3,k-2,ct,data)) {
 
-											registerbasepair(ct,i,a);
-											registerbasepair(ct,a+2,k-1);
+											registerbasepair(ct,i,a,structurenumber);
+											registerbasepair(ct,a+2,k-1,structurenumber);
 											if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-											stack->push(i+1,a-1,0,v->f(i+1,a-1),1);
-											stack->push(a+3,k-2,0,v->f(a+3,k-2),1);
+											stack->push(i+1,a-1,0,v->get(i+1,a-1),1);
+											stack->push(a+3,k-2,0,v->get(a+3,k-2),1);
 											found=true;
 
 										}
 									}
 
 									if ((mod[i]||mod[a])&&!found&&inc[ct->numseq[i]][ct->numseq[a]]) {
-										if (energy==w3[k+1]+v->f(i+1,a-1)+v->f(a+2,k-1)+
+										if (energy==w3[k+1]+v->get(i+1,a-1)+v->get(a+2,k-1)+
 													ergcoaxinterbases2(i,a,a+2,k-1,ct,data)+
 													penalty(i,a,ct,data)+penalty(a+2,k-1,ct,data)
 													+erg1(i,a,i+1,a-1,ct,data)
 											) {
 
-											registerbasepair(ct,i,a);
+											registerbasepair(ct,i,a,structurenumber);
 
 											if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-											stack->push(i+1,a-1,0,v->f(i+1,a-1),1);
-											stack->push(a+2,k-1,0,v->f(a+2,k-1),1);
+											stack->push(i+1,a-1,0,v->get(i+1,a-1),1);
+											stack->push(a+2,k-1,0,v->get(a+2,k-1),1);
 											found=true;
 
 										}
 									}
 
 									if ((!found)&&(mod[a+2]||mod[k-1])&&inc[ct->numseq[a+2]][ct->numseq[k-1]]) {
-										if (energy==w3[k+1]+v->f(i,a)+v->f(a+3,k-2)+
+										if (energy==w3[k+1]+v->get(i,a)+v->get(a+3,k-2)+
 													ergcoaxinterbases2(i,a,a+2,k-1,ct,data)+
 													penalty(i,a,ct,data)+penalty(a+2,k-1,ct,data)
 													+erg1(a+2,k-1,a+3,k-2,ct,data)) {
 
 
-											registerbasepair(ct,a+2,k-1);
+											registerbasepair(ct,a+2,k-1,structurenumber);
 											if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-											stack->push(i,a,0,v->f(i,a),1);
-											stack->push(a+3,k-2,0,v->f(a+3,k-2),1);
+											stack->push(i,a,0,v->get(i,a),1);
+											stack->push(a+3,k-2,0,v->get(a+3,k-2),1);
 											found=true;
 
 										}
 									}
 								}
 
-								if (!found&&(energy==w3[k+1]+v->f(i+1,a)+v->f(a+2,k)+
+								if (!found&&(energy==w3[k+1]+v->get(i+1,a)+v->get(a+2,k)+
 											ergcoaxinterbases1(i+1,a,a+2,k,ct,data)+
 											penalty(i+1,a,ct,data)+penalty(a+2,k,ct,data)
 									    )) {
 
 									if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-									stack->push(i+1,a,0,v->f(i+1,a),1);
-									stack->push(a+2,k,0,v->f(a+2,k),1);
+									stack->push(i+1,a,0,v->get(i+1,a),1);
+									stack->push(a+2,k,0,v->get(a+2,k),1);
 									found=true;
 
 								}
@@ -1373,17 +1384,17 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 											&&inc[ct->numseq[i+1]][ct->numseq[a]]
 											&&inc[ct->numseq[a+2]][ct->numseq[k]]) {
 
-										if (energy==w3[k+1]+v->f(i+2,a-1)+v->f(a+3,k-1)+
+										if (energy==w3[k+1]+v->get(i+2,a-1)+v->get(a+3,k-1)+
 													ergcoaxinterbases1(i+1,a,a+2,k,ct,data)+
 													penalty(i+1,a,ct,data)+penalty(a+2,k,ct,data)
 													+erg1(i+1,a,i+2,a-1,ct,data)
 													+erg1(a+2,k,a+3,k-1,ct,data)) {
 
-											registerbasepair(ct,i+1,a);
-											registerbasepair(ct,a+2,k);
+											registerbasepair(ct,i+1,a,structurenumber);
+											registerbasepair(ct,a+2,k,structurenumber);
 											if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-											stack->push(i+2,a-1,0,v->f(i+2,a-1),1);
-											stack->push(a+3,k-1,0,v->f(a+3,k-1),1);
+											stack->push(i+2,a-1,0,v->get(i+2,a-1),1);
+											stack->push(a+3,k-1,0,v->get(a+3,k-1),1);
 											found=true;
 
 										}	
@@ -1391,16 +1402,16 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 									if ((mod[i+1]||mod[a])&&(!found)&&inc[ct->numseq[i+1]][ct->numseq[a]]) {
 
-										if (energy==w3[k+1]+v->f(i+2,a-1)+v->f(a+2,k)+
+										if (energy==w3[k+1]+v->get(i+2,a-1)+v->get(a+2,k)+
 													ergcoaxinterbases1(i+1,a,a+2,k,ct,data)+
 													penalty(i+1,a,ct,data)+penalty(a+2,k,ct,data)
 													+erg1(i+1,a,i+2,a-1,ct,data)) {
 
-											registerbasepair(ct,i+1,a);
+											registerbasepair(ct,i+1,a,structurenumber);
 
 											if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-											stack->push(i+2,a-1,0,v->f(i+2,a-1),1);
-											stack->push(a+2,k,0,v->f(a+2,k),1);
+											stack->push(i+2,a-1,0,v->get(i+2,a-1),1);
+											stack->push(a+2,k,0,v->get(a+2,k),1);
 											found=true;
 
 										}	
@@ -1408,16 +1419,16 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 									if ((!found)&&(mod[a+2]||mod[k])&&inc[ct->numseq[a+2]][ct->numseq[k]]) {
 
-										if (energy==w3[k+1]+v->f(i+1,a)+v->f(a+3,k-1)+
+										if (energy==w3[k+1]+v->get(i+1,a)+v->get(a+3,k-1)+
 													ergcoaxinterbases1(i+1,a,a+2,k,ct,data)+
 													penalty(i+1,a,ct,data)+penalty(a+2,k,ct,data)
 													+erg1(a+2,k,a+3,k-1,ct,data)) {
 
 
-											registerbasepair(ct,a+2,k);
+											registerbasepair(ct,a+2,k,structurenumber);
 											if (k<number) stack->push(k+1,number,1,w3[k+1],0);
-											stack->push(i+1,a,0,v->f(i+1,a),1);
-											stack->push(a+3,k-1,0,v->f(a+3,k-1),1);
+											stack->push(i+1,a,0,v->get(i+1,a),1);
+											stack->push(a+3,k-1,0,v->get(a+3,k-1),1);
 											found=true;
 
 										}	
@@ -1432,19 +1443,19 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 #else
               			  k=i+1;
 			  while(k<j&&!found) {
-					if (energy==we->f(i,k)+we->f(k+1,j)) {
-						stack->push(i,k,1,we->f(i,k),0);
-						stack->push(k+1,j,1,we->f(k+1,j),0);
+					if (energy==we->get(i,k)+we->get(k+1,j)) {
+						stack->push(i,k,1,we->get(i,k),0);
+						stack->push(k+1,j,1,we->get(k+1,j),0);
 						found = true;
 					}
 
 					//also check for coaxial stacking:
-					else if (energy==v->f(i,k)+v->f(k+1,j)+penalty(i,k,ct,data)+
+					else if (energy==v->get(i,k)+v->get(k+1,j)+penalty(i,k,ct,data)+
 					         penalty(k+1,j,ct,data)
 					         +ergcoaxflushbases(i,k,k+1,j,ct,data)) {
 
-					  stack->push(i,k,0,v->f(i,k),1);
-					  stack->push(k+1,j,0,v->f(k+1,j),1);
+					  stack->push(i,k,0,v->get(i,k),1);
+					  stack->push(k+1,j,0,v->get(k+1,j),1);
 					  found = true;
 					}
 
@@ -1453,55 +1464,55 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 					  if ((mod[i]||mod[k])&&(mod[k+1]||mod[j])&&inc[ct->numseq[i]][ct->numseq[k]]
 					      &&inc[ct->numseq[k+1]][ct->numseq[j]]) {
 
-					    if (energy==v->f(i+1,k-1)+v->f(k+2,j-1)+penalty(i,k,ct,data)+
+					    if (energy==v->get(i+1,k-1)+v->get(k+2,j-1)+penalty(i,k,ct,data)+
 						penalty(k+1,j,ct,data)
 						+ergcoaxflushbases(i,k,k+1,j,ct,data)
 						+erg1(i,k,i+1,k-1,ct,data)
 						+erg1(k+1,j,k+2,j-1,ct,data)) {
 
-					      registerbasepair(ct,i,k);
-					      registerbasepair(ct,k+1,j);
-					      stack->push(i+1,k-1,0,v->f(i+1,k-1),1);
-					      stack->push(k+2,j-1,0,v->f(k+2,j-1),1);
+					      registerbasepair(ct,i,k,structurenumber);
+					      registerbasepair(ct,k+1,j,structurenumber);
+					      stack->push(i+1,k-1,0,v->get(i+1,k-1),1);
+					      stack->push(k+2,j-1,0,v->get(k+2,j-1),1);
 					      found = true;
 					    }		
 					  }
 
 					  if ((mod[i]||mod[k])&&(!found)&&inc[ct->numseq[i]][ct->numseq[k]]) {
 					    
-					    if (energy==v->f(i+1,k-1)+v->f(k+1,j)+penalty(i,k,ct,data)+
+					    if (energy==v->get(i+1,k-1)+v->get(k+1,j)+penalty(i,k,ct,data)+
 						penalty(k+1,j,ct,data)
 						+ergcoaxflushbases(i,k,k+1,j,ct,data)
 						+erg1(i,k,i+1,k-1,ct,data)) {
 
-					      registerbasepair(ct,i,k);
+					      registerbasepair(ct,i,k,structurenumber);
 					      
-					      stack->push(i+1,k-1,0,v->f(i+1,k-1),1);
-					      stack->push(k+1,j,0,v->f(k+1,j),1);
+					      stack->push(i+1,k-1,0,v->get(i+1,k-1),1);
+					      stack->push(k+1,j,0,v->get(k+1,j),1);
 					      found = true;
 					    }		
 					  }
 					  if ((!found)&&(mod[k+1]||mod[j])&&inc[ct->numseq[k+1]][ct->numseq[j]]) {
 
-					    if (energy==v->f(i,k)+v->f(k+2,j-1)+penalty(i,k,ct,data)+
+					    if (energy==v->get(i,k)+v->get(k+2,j-1)+penalty(i,k,ct,data)+
 						penalty(k+1,j,ct,data)
 						+ergcoaxflushbases(i,k,k+1,j,ct,data)
 						+erg1(k+1,j,k+2,j-1,ct,data)) {
 
 							
-					      registerbasepair(ct,k+1,j);
-					      stack->push(i,k,0,v->f(i,k),1);
-					      stack->push(k+2,j-1,0,v->f(k+2,j-1),1);
+					      registerbasepair(ct,k+1,j,structurenumber);
+					      stack->push(i,k,0,v->get(i,k),1);
+					      stack->push(k+2,j-1,0,v->get(k+2,j-1),1);
 					      found = true;
 					    }		
 					  }
 					}
-					if (!found&&(energy==v->f(i,k)+v->f(k+2,j-1)+penalty(i,k,ct,data)+
+					if (!found&&(energy==v->get(i,k)+v->get(k+2,j-1)+penalty(i,k,ct,data)+
 					             penalty(k+2,j-1,ct,data)
 					             +ergcoaxinterbases2(i,k,k+2,j-1,ct,data))) {
 
-					  stack->push(i,k,0,v->f(i,k),1);
-					  stack->push(k+2,j-1,0,v->f(k+2,j-1),1);
+					  stack->push(i,k,0,v->get(i,k),1);
+					  stack->push(k+2,j-1,0,v->get(k+2,j-1),1);
 					  found = true;
 					}
 					else if (!found&&(mod[i]||mod[k]||mod[k+2]||mod[j-1])) {
@@ -1509,56 +1520,56 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 					  if ((mod[i]||mod[k])&&(mod[k+2]||mod[j-1])&&inc[ct->numseq[i]][ct->numseq[k]]
 					      &&inc[ct->numseq[k+2]][ct->numseq[j-1]]) {
 
-					    if ((energy==v->f(i+1,k-1)+v->f(k+3,j-2)+penalty(i,k,ct,data)+
+					    if ((energy==v->get(i+1,k-1)+v->get(k+3,j-2)+penalty(i,k,ct,data)+
 						 penalty(k+2,j-1,ct,data)
 						 +ergcoaxinterbases2(i,k,k+2,j-1,ct,data)
 						 +erg1(i,k,i+1,k-1,ct,data)
 						 +erg1(k+2,j-1,k+3,j-2,ct,data))) {
 
-					      registerbasepair(ct,i,k);
-					      registerbasepair(ct,k+2,j-1);
-					      stack->push(i+1,k-1,0,v->f(i+1,k-1),1);
-					      stack->push(k+3,j-2,0,v->f(k+3,j-2),1);
+					      registerbasepair(ct,i,k,structurenumber);
+					      registerbasepair(ct,k+2,j-1,structurenumber);
+					      stack->push(i+1,k-1,0,v->get(i+1,k-1),1);
+					      stack->push(k+3,j-2,0,v->get(k+3,j-2),1);
 					      found = true;
 					    }	
 					  }
 
 					  if ((mod[i]||mod[k])&&(!found)&&inc[ct->numseq[i]][ct->numseq[k]]) {
 					    
-					    if ((energy==v->f(i+1,k-1)+v->f(k+2,j-1)+penalty(i,k,ct,data)+
+					    if ((energy==v->get(i+1,k-1)+v->get(k+2,j-1)+penalty(i,k,ct,data)+
 						 penalty(k+2,j-1,ct,data)
 						 +ergcoaxinterbases2(i,k,k+2,j-1,ct,data)
 						 +erg1(i,k,i+1,k-1,ct,data))) {
 					      
-					      registerbasepair(ct,i,k);
+					      registerbasepair(ct,i,k,structurenumber);
 								
-					      stack->push(i+1,k-1,0,v->f(i+1,k-1),1);
-					      stack->push(k+2,j-1,0,v->f(k+2,j-1),1);
+					      stack->push(i+1,k-1,0,v->get(i+1,k-1),1);
+					      stack->push(k+2,j-1,0,v->get(k+2,j-1),1);
 					      found = true;
 					    }	
 					  }
 
 					  if ((!found)&&(mod[k+2]||mod[j-1])&&inc[ct->numseq[k+2]][ct->numseq[j-1]]) {
 					    
-					    if ((energy==v->f(i,k)+v->f(k+3,j-2)+penalty(i,k,ct,data)+
+					    if ((energy==v->get(i,k)+v->get(k+3,j-2)+penalty(i,k,ct,data)+
 						 penalty(k+2,j-1,ct,data)+
 						 ergcoaxinterbases2(i,k,k+2,j-1,ct,data)
 						 +erg1(k+2,j-1,k+3,j-2,ct,data))) {
 
 								
-					      registerbasepair(ct,k+2,j-1);
-					      stack->push(i,k,0,v->f(i,k),1);
-					      stack->push(k+3,j-2,0,v->f(k+3,j-2),1);
+					      registerbasepair(ct,k+2,j-1,structurenumber);
+					      stack->push(i,k,0,v->get(i,k),1);
+					      stack->push(k+3,j-2,0,v->get(k+3,j-2),1);
 					      found = true;
 					    }	
 					  }
 					}
-					if (!found&&(energy==v->f(i+1,k)+v->f(k+2,j)+penalty(i+1,k,ct,data)+
+					if (!found&&(energy==v->get(i+1,k)+v->get(k+2,j)+penalty(i+1,k,ct,data)+
 					             penalty(k+2,j,ct,data)+
 					             ergcoaxinterbases1(i+1,k,k+2,j,ct,data))) {
 
-					  stack->push(i+1,k,0,v->f(i+1,k),1);
-					  stack->push(k+2,j,0,v->f(k+2,j),1);
+					  stack->push(i+1,k,0,v->get(i+1,k),1);
+					  stack->push(k+2,j,0,v->get(k+2,j),1);
 					  found = true;
 					}
 
@@ -1566,45 +1577,45 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 					  if ((mod[i+1]||mod[k])&&(mod[k+2]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[k]]
 					      &&inc[ct->numseq[k+2]][ct->numseq[j]]) {
-					    if ((energy==v->f(i+2,k-1)+v->f(k+3,j-1)+penalty(i+1,k,ct,data)+
+					    if ((energy==v->get(i+2,k-1)+v->get(k+3,j-1)+penalty(i+1,k,ct,data)+
 						 penalty(k+2,j,ct,data)+
 						 ergcoaxinterbases1(i+1,k,k+2,j,ct,data)
 						 +erg1(i+1,k,i+2,k-1,ct,data)
 						 +erg1(k+2,j,k+3,j-1,ct,data))) {
 
-					      registerbasepair(ct,i+1,k);
-					      registerbasepair(ct,k+2,j);
-					      stack->push(i+2,k-1,0,v->f(i+2,k-1),1);
-					      stack->push(k+3,j-1,0,v->f(k+3,j-1),1);
+					      registerbasepair(ct,i+1,k,structurenumber);
+					      registerbasepair(ct,k+2,j,structurenumber);
+					      stack->push(i+2,k-1,0,v->get(i+2,k-1),1);
+					      stack->push(k+3,j-1,0,v->get(k+3,j-1),1);
 					      found = true;
 					    }
 					  }
 
 					  if ((mod[i+1]||mod[k])&&(!found)&&inc[ct->numseq[i+1]][ct->numseq[k]]) {
-					    if ((energy==v->f(i+2,k-1)+v->f(k+2,j)+penalty(i+1,k,ct,data)+
+					    if ((energy==v->get(i+2,k-1)+v->get(k+2,j)+penalty(i+1,k,ct,data)+
 						 penalty(k+2,j,ct,data)+
 						 ergcoaxinterbases1(i+1,k,k+2,j,ct,data)
 						 +erg1(i+1,k,i+2,k-1,ct,data))) {
 
-					      registerbasepair(ct,i+1,k);
+					      registerbasepair(ct,i+1,k,structurenumber);
 								
-					      stack->push(i+2,k-1,0,v->f(i+2,k-1),1);
-					      stack->push(k+2,j,0,v->f(k+2,j),1);
+					      stack->push(i+2,k-1,0,v->get(i+2,k-1),1);
+					      stack->push(k+2,j,0,v->get(k+2,j),1);
 					      found = true;
 					    }
 					  }
 
 					  if ((!found)&&(mod[k+2]||mod[j])&&inc[ct->numseq[k+2]][ct->numseq[j]]) {
-					    if ((energy==v->f(i+1,k)+v->f(k+3,j-1)+penalty(i+1,k,ct,data)+
+					    if ((energy==v->get(i+1,k)+v->get(k+3,j-1)+penalty(i+1,k,ct,data)+
 						 penalty(k+2,j,ct,data)+
 						 ergcoaxinterbases1(i+1,k,k+2,j,ct,data)
 								
 						 +erg1(k+2,j,k+3,j-1,ct,data))) {
 
 					      
-					      registerbasepair(ct,k+2,j);
-					      stack->push(i+1,k,0,v->f(i+1,k),1);
-					      stack->push(k+3,j-1,0,v->f(k+3,j-1),1);
+					      registerbasepair(ct,k+2,j,structurenumber);
+					      stack->push(i+1,k,0,v->get(i+1,k),1);
+					      stack->push(k+3,j-1,0,v->get(k+3,j-1),1);
 					      found = true;
 					    }
 					  }
@@ -1620,19 +1631,19 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 				//open == 0, multiloop
 				k=i+1;
 				while(k<j&&!found) {
-					if (energy==w->f(i,k)+w->f(k+1,j)) {
-						stack->push(i,k,0,w->f(i,k),0);
-						stack->push(k+1,j,0,w->f(k+1,j),0);
+					if (energy==w->get(i,k)+w->get(k+1,j)) {
+						stack->push(i,k,0,w->get(i,k),0);
+						stack->push(k+1,j,0,w->get(k+1,j),0);
 						found = true;
 					}
 
 					//also check for coaxial stacking:
-					else if (energy==v->f(i,k)+v->f(k+1,j)+penalty(i,k,ct,data)+
+					else if (energy==v->get(i,k)+v->get(k+1,j)+penalty(i,k,ct,data)+
 							penalty(k+1,j,ct,data)+2*data->eparam[10]+
 							ergcoaxflushbases(i,k,k+1,j,ct,data)) {
 
-						stack->push(i,k,0,v->f(i,k),1);
-						stack->push(k+1,j,0,v->f(k+1,j),1);
+						stack->push(i,k,0,v->get(i,k),1);
+						stack->push(k+1,j,0,v->get(k+1,j),1);
 						found = true;
 					}
 
@@ -1641,55 +1652,55 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 						if ((mod[i]||mod[k])&&(mod[k+1]||mod[j])&&inc[ct->numseq[i]][ct->numseq[k]]
 								&&inc[ct->numseq[k+1]][ct->numseq[j]]) {
 
-							if (energy==v->f(i+1,k-1)+v->f(k+2,j-1)+penalty(i,k,ct,data)+
+							if (energy==v->get(i+1,k-1)+v->get(k+2,j-1)+penalty(i,k,ct,data)+
 									penalty(k+1,j,ct,data)+2*data->eparam[10]+
 									ergcoaxflushbases(i,k,k+1,j,ct,data)
 									+erg1(i,k,i+1,k-1,ct,data)
 									+erg1(k+1,j,k+2,j-1,ct,data)) {
 
-								registerbasepair(ct,i,k);
-								registerbasepair(ct,k+1,j);
-								stack->push(i+1,k-1,0,v->f(i+1,k-1),1);
-								stack->push(k+2,j-1,0,v->f(k+2,j-1),1);
+								registerbasepair(ct,i,k,structurenumber);
+								registerbasepair(ct,k+1,j,structurenumber);
+								stack->push(i+1,k-1,0,v->get(i+1,k-1),1);
+								stack->push(k+2,j-1,0,v->get(k+2,j-1),1);
 								found = true;
 							}		
 						}
 
 						if ((mod[i]||mod[k])&&(!found)&&inc[ct->numseq[i]][ct->numseq[k]]) {
 
-							if (energy==v->f(i+1,k-1)+v->f(k+1,j)+penalty(i,k,ct,data)+
+							if (energy==v->get(i+1,k-1)+v->get(k+1,j)+penalty(i,k,ct,data)+
 									penalty(k+1,j,ct,data)+2*data->eparam[10]+
 									ergcoaxflushbases(i,k,k+1,j,ct,data)
 									+erg1(i,k,i+1,k-1,ct,data)) {
 
-								registerbasepair(ct,i,k);
+								registerbasepair(ct,i,k,structurenumber);
 
-								stack->push(i+1,k-1,0,v->f(i+1,k-1),1);
-								stack->push(k+1,j,0,v->f(k+1,j),1);
+								stack->push(i+1,k-1,0,v->get(i+1,k-1),1);
+								stack->push(k+1,j,0,v->get(k+1,j),1);
 								found = true;
 							}		
 						}
 						if ((!found)&&(mod[k+1]||mod[j])&&inc[ct->numseq[k+1]][ct->numseq[j]]) {
 
-							if (energy==v->f(i,k)+v->f(k+2,j-1)+penalty(i,k,ct,data)+
+							if (energy==v->get(i,k)+v->get(k+2,j-1)+penalty(i,k,ct,data)+
 									penalty(k+1,j,ct,data)+2*data->eparam[10]+
 									ergcoaxflushbases(i,k,k+1,j,ct,data)
 									+erg1(k+1,j,k+2,j-1,ct,data)) {
 
 
-								registerbasepair(ct,k+1,j);
-								stack->push(i,k,0,v->f(i,k),1);
-								stack->push(k+2,j-1,0,v->f(k+2,j-1),1);
+								registerbasepair(ct,k+1,j,structurenumber);
+								stack->push(i,k,0,v->get(i,k),1);
+								stack->push(k+2,j-1,0,v->get(k+2,j-1),1);
 								found = true;
 							}		
 						}
 					}
-					if (!found&&(energy==v->f(i,k)+v->f(k+2,j-1)+penalty(i,k,ct,data)+
+					if (!found&&(energy==v->get(i,k)+v->get(k+2,j-1)+penalty(i,k,ct,data)+
 								penalty(k+2,j-1,ct,data)+2*data->eparam[10]+2*data->eparam[6]+
 								ergcoaxinterbases2(i,k,k+2,j-1,ct,data))) {
 
-						stack->push(i,k,0,v->f(i,k),1);
-						stack->push(k+2,j-1,0,v->f(k+2,j-1),1);
+						stack->push(i,k,0,v->get(i,k),1);
+						stack->push(k+2,j-1,0,v->get(k+2,j-1),1);
 						found = true;
 					}
 					else if (!found&&(mod[i]||mod[k]||mod[k+2]||mod[j-1])) {
@@ -1697,56 +1708,56 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 						if ((mod[i]||mod[k])&&(mod[k+2]||mod[j-1])&&inc[ct->numseq[i]][ct->numseq[k]]
 								&&inc[ct->numseq[k+2]][ct->numseq[j-1]]) {
 
-							if (energy==v->f(i+1,k-1)+v->f(k+3,j-2)+penalty(i,k,ct,data)+
+							if (energy==v->get(i+1,k-1)+v->get(k+3,j-2)+penalty(i,k,ct,data)+
 										penalty(k+2,j-1,ct,data)+2*data->eparam[10]+2*data->eparam[6]+
 										ergcoaxinterbases2(i,k,k+2,j-1,ct,data)
 										+erg1(i,k,i+1,k-1,ct,data)
 										+erg1(k+2,j-1,k+3,j-2,ct,data)) {
 
-								registerbasepair(ct,i,k);
-								registerbasepair(ct,k+2,j-1);
-								stack->push(i+1,k-1,0,v->f(i+1,k-1),1);
-								stack->push(k+3,j-2,0,v->f(k+3,j-2),1);
+								registerbasepair(ct,i,k,structurenumber);
+								registerbasepair(ct,k+2,j-1,structurenumber);
+								stack->push(i+1,k-1,0,v->get(i+1,k-1),1);
+								stack->push(k+3,j-2,0,v->get(k+3,j-2),1);
 								found = true;
 							}	
 						}
 
 						if ((mod[i]||mod[k])&&(!found)&&inc[ct->numseq[i]][ct->numseq[k]]) {
 
-							if (energy==v->f(i+1,k-1)+v->f(k+2,j-1)+penalty(i,k,ct,data)+
+							if (energy==v->get(i+1,k-1)+v->get(k+2,j-1)+penalty(i,k,ct,data)+
 										penalty(k+2,j-1,ct,data)+2*data->eparam[10]+2*data->eparam[6]+
 										ergcoaxinterbases2(i,k,k+2,j-1,ct,data)
 										+erg1(i,k,i+1,k-1,ct,data)) {
 
-								registerbasepair(ct,i,k);
+								registerbasepair(ct,i,k,structurenumber);
 
-								stack->push(i+1,k-1,0,v->f(i+1,k-1),1);
-								stack->push(k+2,j-1,0,v->f(k+2,j-1),1);
+								stack->push(i+1,k-1,0,v->get(i+1,k-1),1);
+								stack->push(k+2,j-1,0,v->get(k+2,j-1),1);
 								found = true;
 							}	
 						}
 
 						if ((!found)&&(mod[k+2]||mod[j-1])&&inc[ct->numseq[k+2]][ct->numseq[j-1]]) {
 
-							if (energy==v->f(i,k)+v->f(k+3,j-2)+penalty(i,k,ct,data)+
+							if (energy==v->get(i,k)+v->get(k+3,j-2)+penalty(i,k,ct,data)+
 										penalty(k+2,j-1,ct,data)+2*data->eparam[10]+2*data->eparam[6]+
 										ergcoaxinterbases2(i,k,k+2,j-1,ct,data)
 										+erg1(k+2,j-1,k+3,j-2,ct,data)) {
 
 
-								registerbasepair(ct,k+2,j-1);
-								stack->push(i,k,0,v->f(i,k),1);
-								stack->push(k+3,j-2,0,v->f(k+3,j-2),1);
+								registerbasepair(ct,k+2,j-1,structurenumber);
+								stack->push(i,k,0,v->get(i,k),1);
+								stack->push(k+3,j-2,0,v->get(k+3,j-2),1);
 								found = true;
 							}	
 						}
 					}
-					if (!found&&(energy==v->f(i+1,k)+v->f(k+2,j)+penalty(i+1,k,ct,data)+
+					if (!found&&(energy==v->get(i+1,k)+v->get(k+2,j)+penalty(i+1,k,ct,data)+
 								penalty(k+2,j,ct,data)+2*data->eparam[10]+2*data->eparam[6]+
 								ergcoaxinterbases1(i+1,k,k+2,j,ct,data))) {
 
-						stack->push(i+1,k,0,v->f(i+1,k),1);
-						stack->push(k+2,j,0,v->f(k+2,j),1);
+						stack->push(i+1,k,0,v->get(i+1,k),1);
+						stack->push(k+2,j,0,v->get(k+2,j),1);
 						found = true;
 					}
 
@@ -1754,45 +1765,45 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 						if ((mod[i+1]||mod[k])&&(mod[k+2]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[k]]
 								&&inc[ct->numseq[k+2]][ct->numseq[j]]) {
-							if (energy==v->f(i+2,k-1)+v->f(k+3,j-1)+penalty(i+1,k,ct,data)+
+							if (energy==v->get(i+2,k-1)+v->get(k+3,j-1)+penalty(i+1,k,ct,data)+
 										penalty(k+2,j,ct,data)+2*data->eparam[10]+2*data->eparam[6]+
 										ergcoaxinterbases1(i+1,k,k+2,j,ct,data)
 										+erg1(i+1,k,i+2,k-1,ct,data)
 										+erg1(k+2,j,k+3,j-1,ct,data)) {
 
-								registerbasepair(ct,i+1,k);
-								registerbasepair(ct,k+2,j);
-								stack->push(i+2,k-1,0,v->f(i+2,k-1),1);
-								stack->push(k+3,j-1,0,v->f(k+3,j-1),1);
+								registerbasepair(ct,i+1,k,structurenumber);
+								registerbasepair(ct,k+2,j,structurenumber);
+								stack->push(i+2,k-1,0,v->get(i+2,k-1),1);
+								stack->push(k+3,j-1,0,v->get(k+3,j-1),1);
 								found = true;
 							}
 						}
 
 						if ((mod[i+1]||mod[k])&&(!found)&&inc[ct->numseq[i+1]][ct->numseq[k]]) {
-							if (energy==v->f(i+2,k-1)+v->f(k+2,j)+penalty(i+1,k,ct,data)+
+							if (energy==v->get(i+2,k-1)+v->get(k+2,j)+penalty(i+1,k,ct,data)+
 										penalty(k+2,j,ct,data)+2*data->eparam[10]+2*data->eparam[6]+
 										ergcoaxinterbases1(i+1,k,k+2,j,ct,data)
 										+erg1(i+1,k,i+2,k-1,ct,data)) {
 
-								registerbasepair(ct,i+1,k);
+								registerbasepair(ct,i+1,k,structurenumber);
 
-								stack->push(i+2,k-1,0,v->f(i+2,k-1),1);
-								stack->push(k+2,j,0,v->f(k+2,j),1);
+								stack->push(i+2,k-1,0,v->get(i+2,k-1),1);
+								stack->push(k+2,j,0,v->get(k+2,j),1);
 								found = true;
 							}
 						}
 
 						if ((!found)&&(mod[k+2]||mod[j])&&inc[ct->numseq[k+2]][ct->numseq[j]]) {
-							if (energy==v->f(i+1,k)+v->f(k+3,j-1)+penalty(i+1,k,ct,data)+
+							if (energy==v->get(i+1,k)+v->get(k+3,j-1)+penalty(i+1,k,ct,data)+
 										penalty(k+2,j,ct,data)+2*data->eparam[10]+2*data->eparam[6]+
 										ergcoaxinterbases1(i+1,k,k+2,j,ct,data)
 
 										+erg1(k+2,j,k+3,j-1,ct,data)) {
 
 
-								registerbasepair(ct,k+2,j);
-								stack->push(i+1,k,0,v->f(i+1,k),1);
-								stack->push(k+3,j-1,0,v->f(k+3,j-1),1);
+								registerbasepair(ct,k+2,j,structurenumber);
+								stack->push(i+1,k,0,v->get(i+1,k),1);
+								stack->push(k+3,j-1,0,v->get(k+3,j-1),1);
 								found = true;
 							}
 						}
@@ -1803,9 +1814,9 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 				if (ct->intermolecular) {
 					k=i+1;
 					while(k<j&&!found) {
-						if (energy==w2->f(i,k)+w2->f(k+1,j)) {
-							stack->push(i,k,0,w2->f(i,k),0);
-							stack->push(k+1,j,0,w2->f(k+1,j),0);
+						if (energy==w2->get(i,k)+w2->get(k+1,j)) {
+							stack->push(i,k,0,w2->get(i,k),0);
+							stack->push(k+1,j,0,w2->get(k+1,j),0);
 							found = true;
 						}
 
@@ -1815,25 +1826,25 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 					if (i!=number) {
 						if (!(fce->f(i,i)&INTER)) {
-							if (energy==wmb2->f(i+1,j) ) {
-								stack->push(i+1,j,0,w2->f(i+1,j),0); 
+							if (energy==wmb2->get(i+1,j) ) {
+								stack->push(i+1,j,0,w2->get(i+1,j),0); 
 								found = true;
 							}
 						}
-						else  if (energy==wmb2->f(i+1,j) + data->init - INFINITE_ENERGY) {
-							stack->push(i+1,j,0,w2->f(i+1,j),0);
+						else  if (energy==wmb2->get(i+1,j) + data->init - INFINITE_ENERGY) {
+							stack->push(i+1,j,0,w2->get(i+1,j),0);
 							found = true;
 						}
 					}
 					if ((j!=number+1)&&(!found)) {
 						if (!(fce->f(j,j)&INTER)) {
-							if (energy==wmb2->f(i,j-1)) {
-								stack->push(i,j-1,0,wmb2->f(i,j-1),0);
+							if (energy==wmb2->get(i,j-1)) {
+								stack->push(i,j-1,0,wmb2->get(i,j-1),0);
 								found = true;
 							}
 						}
-						else if (energy==wmb2->f(i,j-1) +data->init-INFINITE_ENERGY) {
-							stack->push(i,j-1,0,wmb2->f(i,j-1),0);
+						else if (energy==wmb2->get(i,j-1) +data->init-INFINITE_ENERGY) {
+							stack->push(i,j-1,0,wmb2->get(i,j-1),0);
 							found = true;
 						}
 					}
@@ -1848,46 +1859,46 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 		}
 
 		else if (pair==1) {
-			//energy = v->f(i,j) So we have a basepair
+			//energy = v->get(i,j) So we have a basepair
 
 			/*
 			//Comment out by FD
-			while (energy==v->f(i,j)) {
+			while (energy==v->get(i,j)) {
 				//record the found base pair
-				registerbasepair(ct,i,j);
+				registerbasepair(ct,i,j,structurenumber);
 
 				//check for stacked pair:
 				//FD
-				if (energy==erg1(i,j,i+1,j-1,ct,data)+v->f(i+1,j-1)+SHAPEendPair(i,j,ct)&&
+				if (energy==erg1(i,j,i+1,j-1,ct,data)+v->get(i+1,j-1)+SHAPEendPair(i,j,ct)&&
 						i!=number&&j!=number+1) {
 					i++;
 					j--;
-					energy = v->f(i,j);
+					energy = v->get(i,j);
 				}
 				else break;
 			}*/
 			bool firstPair = true;
-			while (energy==v->f(i,j)) {
+			while (energy==v->get(i,j)) {
 				//record the found base pair
-				registerbasepair(ct,i,j);
+				registerbasepair(ct,i,j,structurenumber);
 				//FD
-				//if(energy == v1->f(i,j) && i!=number && j!=number+1) break;
+				//if(energy == v1->get(i,j) && i!=number && j!=number+1) break;
 				
 				if (firstPair){
 					firstPair = false;
-					if (energy == v2->f(i,j) && i!=number&&j!=number+1){
+					if (energy == v2->get(i,j) && i!=number&&j!=number+1){
 						i++;
 						j--;
-						energy = v->f(i,j);
+						energy = v->get(i,j);
 					}
 					else
 						break;
 				}
 				else{
-					if (energy == v2->f(i,j)  && i!=number&&j!=number+1){
+					if (energy == v2->get(i,j)  && i!=number&&j!=number+1){
 						i++;
 						j--;
-						energy = v->f(i,j);
+						energy = v->get(i,j);
 					}
 					else break;
 				}
@@ -1928,77 +1939,77 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 					a = j-number-minloop-2;
 					while (a>0&&!found) {
 						if (energy==w5[a-1]+penalty(i,j,ct,data)+
-								penalty(a,j-number-1,ct,data)+v->f(a,j-number-1)+
+								penalty(a,j-number-1,ct,data)+v->get(a,j-number-1)+
 								ergcoaxflushbases(a,j-number-1,j-number,i,ct,data)) {
 
 							if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 							if (i+1<number-minloop-1) stack->push(i+1,number,1,w3[i+1],0);
-							stack->push(a,j-number-1,0,v->f(a,j-number-1),1);
+							stack->push(a,j-number-1,0,v->get(a,j-number-1),1);
 							found = true;
 						}
 
 						else if ((mod[a]||mod[j-number-1])&&inc[ct->numseq[a]][ct->numseq[j-number-1]]) {
 
 							if (energy==w5[a-1]+penalty(i,j,ct,data)+
-									penalty(a,j-number-1,ct,data)+v->f(a+1,j-number-2)+
+									penalty(a,j-number-1,ct,data)+v->get(a+1,j-number-2)+
 									ergcoaxflushbases(a,j-number-1,j-number,i,ct,data)
 									+erg1(a,j-number-1,a+1,j-number-2,ct,data)) {
 
-								registerbasepair(ct,a,j-number-1);
+								registerbasepair(ct,a,j-number-1,structurenumber);
 								if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 								if (i+1<number-minloop-1) stack->push(i+1,number,1,w3[i+1],0);
-								stack->push(a+1,j-number-2,0,v->f(a+1,j-number-2),1);
+								stack->push(a+1,j-number-2,0,v->get(a+1,j-number-2),1);
 								found = true;
 							}
 
 						}
 
 						if (!found&&(energy==w5[a-1]+penalty(i,j,ct,data)+
-									penalty(a+1,j-number-2,ct,data)+v->f(a+1,j-number-2)+
+									penalty(a+1,j-number-2,ct,data)+v->get(a+1,j-number-2)+
 									ergcoaxinterbases1(a+1,j-number-2,j-number,i,ct,data))) {
 
 							if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 							if (i+1<number-minloop-1) stack->push(i+1,number,1,w3[i+1],0);
-							stack->push(a+1,j-number-2,0,v->f(a+1,j-number-2),1);
+							stack->push(a+1,j-number-2,0,v->get(a+1,j-number-2),1);
 							found = true;
 
 						}
 						else if (!found&&(mod[a+1]||mod[j-number-2])&&inc[ct->numseq[i+1]][ct->numseq[j-number-2]]) {
 							if (energy==w5[a-1]+penalty(i,j,ct,data)+
-										penalty(a+1,j-number-2,ct,data)+v->f(a+2,j-number-3)+
+										penalty(a+1,j-number-2,ct,data)+v->get(a+2,j-number-3)+
 										ergcoaxinterbases1(a+1,j-number-2,j-number,i,ct,data)
 										+erg1(a+1,j-number-2,a+2,j-number-3,ct,data)) {
 
-								registerbasepair(ct,a+1,j-number-2);
+								registerbasepair(ct,a+1,j-number-2,structurenumber);
 								if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 								if (i+1<number-minloop-1) stack->push(i+1,number,1,w3[i+1],0);
-								stack->push(a+2,j-number-3,0,v->f(a+2,j-number-3),1);
+								stack->push(a+2,j-number-3,0,v->get(a+2,j-number-3),1);
 								found = true;
 
 							}
 						}
 						if (!found&&i<number) {
 							if (energy==w5[a-1]+penalty(i,j,ct,data)+
-									penalty(a,j-number-2,ct,data)+v->f(a,j-number-2)+
+									penalty(a,j-number-2,ct,data)+v->get(a,j-number-2)+
 									ergcoaxinterbases2(a,j-number-2,j-number,i,ct,data)) {
 
 								if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 								if (i+2<number-minloop-1) stack->push(i+2,number,1,w3[i+2],0);
-								stack->push(a,j-number-2,0,v->f(a,j-number-2),1);
+								stack->push(a,j-number-2,0,v->get(a,j-number-2),1);
 								found = true;
 
 							}
 							else if ((mod[a]||mod[j-number-2])&&inc[ct->numseq[a]][ct->numseq[j-number-2]]) {
 
 								if (energy==w5[a-1]+penalty(i,j,ct,data)+
-										penalty(a,j-number-2,ct,data)+v->f(a+1,j-number-3)+
+										penalty(a,j-number-2,ct,data)+v->get(a+1,j-number-3)+
 										ergcoaxinterbases2(a,j-number-2,j-number,i,ct,data)
 										+erg1(a,j-number-2,a+1,j-number-3,ct,data)) {
 
-									registerbasepair(ct,a,j-number-2);
+									registerbasepair(ct,a,j-number-2,structurenumber);
 									if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 									if (i+2<number-minloop-1) stack->push(i+2,number,1,w3[i+2],0);
-									stack->push(a+1,j-number-3,0,v->f(a+1,j-number-3),1);
+									stack->push(a+1,j-number-3,0,v->get(a+1,j-number-3),1);
 									found = true;
 								}
 							}
@@ -2013,35 +2024,35 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 					//check for the case where the bifuraction is in a multibranch loop:
 
-					if (energy==wmb->f(i+1,j-1)+data->eparam[10]+data->eparam[5]+penalty(i,j,ct,data)) {
+					if (energy==wmb->get(i+1,j-1)+data->eparam[10]+data->eparam[5]+penalty(i,j,ct,data)) {
 
-						stack->push(i+1,j-1,0,wmb->f(i+1,j-1),2);
+						stack->push(i+1,j-1,0,wmb->get(i+1,j-1),2);
 						found = true;
 
 					}
-					else if (energy==wmb->f(i+2,j-1)+penalty(i,j,ct,data)+
+					else if (energy==wmb->get(i+2,j-1)+penalty(i,j,ct,data)+
 							data->eparam[10]+data->eparam[5]+data->eparam[6]+
 							erg4(i,j,i+1,1,ct,data,lfce[i+1])) {
 
-						stack->push(i+2,j-1,0,wmb->f(i+2,j-1),2);
+						stack->push(i+2,j-1,0,wmb->get(i+2,j-1),2);
 						found = true;
 
 					}
-					else if (energy==wmb->f(i+1,j-2)+penalty(i,j,ct,data)+
+					else if (energy==wmb->get(i+1,j-2)+penalty(i,j,ct,data)+
 							data->eparam[10]+data->eparam[5]+data->eparam[6]+
 							erg4(i,j,j-1,2,ct,data,lfce[j-1])) {
 
-						stack->push(i+1,j-2,0,wmb->f(i+1,j-2),2);
+						stack->push(i+1,j-2,0,wmb->get(i+1,j-2),2);
 						found = true;
 
 					}
-					else if (energy==wmb->f(i+2,j-2)+penalty(i,j,ct,data)+
+					else if (energy==wmb->get(i+2,j-2)+penalty(i,j,ct,data)+
 							data->eparam[10]+data->eparam[5]+2*data->eparam[6]+
 							data->tstkm[ct->numseq[i]][ct->numseq[j]]
 							[ct->numseq[i+1]][ct->numseq[j-1]]
 							+checknp(lfce[i+1],lfce[j-1])+ ct->SHAPEss_give_value(i+1)+ ct->SHAPEss_give_value(j-1)) {
 
-						stack->push(i+2,j-2,0,wmb->f(i+2,j-2),2);
+						stack->push(i+2,j-2,0,wmb->get(i+2,j-2),2);
 						found = true;
 					}
 					k=i+1;
@@ -2049,60 +2060,60 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 						//if (k!=number) {
 
 						if (k+1<j-1&&energy==penalty(i,j,ct,data)+
-								penalty(i+1,k,ct,data)+v->f(i+1,k)+
-								ergcoaxflushbases(j,i,i+1,k,ct,data)+w->f(k+1,j-1)+
+								penalty(i+1,k,ct,data)+v->get(i+1,k)+
+								ergcoaxflushbases(j,i,i+1,k,ct,data)+w->get(k+1,j-1)+
 								data->eparam[5]+2*data->eparam[10]) {
 
-							stack->push(i+1,k,0,v->f(i+1,k),1);
-							stack->push(k+1,j-1,0,w->f(k+1,j-1),0);
+							stack->push(i+1,k,0,v->get(i+1,k),1);
+							stack->push(k+1,j-1,0,w->get(k+1,j-1),0);
 							found = true;
 						}
 
 						else if (k+1<j-1&&(mod[i+1]||mod[k])&&inc[ct->numseq[i+1]][ct->numseq[k]]) {
 
 							if (energy==penalty(i,j,ct,data)+
-									penalty(i+1,k,ct,data)+v->f(i+2,k-1)+
-									ergcoaxflushbases(j,i,i+1,k,ct,data)+w->f(k+1,j-1)+
+									penalty(i+1,k,ct,data)+v->get(i+2,k-1)+
+									ergcoaxflushbases(j,i,i+1,k,ct,data)+w->get(k+1,j-1)+
 									data->eparam[5]+2*data->eparam[10]
 									+erg1(i+1,k,i+2,k-1,ct,data)) {
 
-								registerbasepair(ct,i+1,k);
-								stack->push(i+2,k-1,0,v->f(i+2,k-1),1);
-								stack->push(k+1,j-1,0,w->f(k+1,j-1),0);
+								registerbasepair(ct,i+1,k,structurenumber);
+								stack->push(i+2,k-1,0,v->get(i+2,k-1),1);
+								stack->push(k+1,j-1,0,w->get(k+1,j-1),0);
 								found = true;
 							}
 						}
 
 						if (!found&&(k+1<j-2&&energy==penalty(i,j,ct,data)+
-									penalty(i+2,k,ct,data)+v->f(i+2,k)+
-									ergcoaxinterbases1(j,i,i+2,k,ct,data)+w->f(k+1,j-2)+
+									penalty(i+2,k,ct,data)+v->get(i+2,k)+
+									ergcoaxinterbases1(j,i,i+2,k,ct,data)+w->get(k+1,j-2)+
 									data->eparam[5]+2*data->eparam[10]+2*data->eparam[6])) {
 
-							stack->push(i+2,k,0,v->f(i+2,k),1);
-							stack->push(k+1,j-2,0,w->f(k+1,j-2),0);
+							stack->push(i+2,k,0,v->get(i+2,k),1);
+							stack->push(k+1,j-2,0,w->get(k+1,j-2),0);
 							found = true;
 						}
 						else if (!found&&(k+1<j-2&&(mod[i+2]||mod[k]))&&inc[ct->numseq[i+2]][ct->numseq[k]]) {
 
 							if (energy==penalty(i,j,ct,data)+
-									penalty(i+2,k,ct,data)+v->f(i+3,k-1)+
-									ergcoaxinterbases1(j,i,i+2,k,ct,data)+w->f(k+1,j-2)+
+									penalty(i+2,k,ct,data)+v->get(i+3,k-1)+
+									ergcoaxinterbases1(j,i,i+2,k,ct,data)+w->get(k+1,j-2)+
 									data->eparam[5]+2*data->eparam[10]+2*data->eparam[6]
 									+erg1(i+2,k,i+3,k-1,ct,data)) {
 
-								registerbasepair(ct,i+2,k);
-								stack->push(i+3,k-1,0,v->f(i+3,k-1),1);
-								stack->push(k+1,j-2,0,w->f(k+1,j-2),0);
+								registerbasepair(ct,i+2,k,structurenumber);
+								stack->push(i+3,k-1,0,v->get(i+3,k-1),1);
+								stack->push(k+1,j-2,0,w->get(k+1,j-2),0);
 								found = true;
 							}
 						}
 						if (!found&&k+1<j-1&&energy==penalty(i,j,ct,data)+
-								penalty(i+2,k-1,ct,data)+v->f(i+2,k-1)+
-								ergcoaxinterbases2(j,i,i+2,k-1,ct,data)+w->f(k+1,j-1)+
+								penalty(i+2,k-1,ct,data)+v->get(i+2,k-1)+
+								ergcoaxinterbases2(j,i,i+2,k-1,ct,data)+w->get(k+1,j-1)+
 								data->eparam[5]+2*data->eparam[10]+2*data->eparam[6]) {
 
-							stack->push(i+2,k-1,0,v->f(i+2,k-1),1);
-							stack->push(k+1,j-1,0,w->f(k+1,j-1),0);
+							stack->push(i+2,k-1,0,v->get(i+2,k-1),1);
+							stack->push(k+1,j-1,0,w->get(k+1,j-1),0);
 							found = true;
 
 
@@ -2110,89 +2121,89 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 						else if (!found&&(k+1<j-1)&&(mod[i+2]||mod[k-1])&&inc[ct->numseq[i+2]][ct->numseq[k-1]]) {
 
 							if (energy==penalty(i,j,ct,data)+
-									penalty(i+2,k-1,ct,data)+v->f(i+3,k-2)+
-									ergcoaxinterbases2(j,i,i+2,k-1,ct,data)+w->f(k+1,j-1)+
+									penalty(i+2,k-1,ct,data)+v->get(i+3,k-2)+
+									ergcoaxinterbases2(j,i,i+2,k-1,ct,data)+w->get(k+1,j-1)+
 									data->eparam[5]+2*data->eparam[10]+2*data->eparam[6]
 									+erg1(i+2,k-1,i+3,k-2,ct,data)) {
 
-								registerbasepair(ct,i+2,k-1);
-								stack->push(i+3,k-2,0,v->f(i+3,k-2),1);
-								stack->push(k+1,j-1,0,w->f(k+1,j-1),0);
+								registerbasepair(ct,i+2,k-1,structurenumber);
+								stack->push(i+3,k-2,0,v->get(i+3,k-2),1);
+								stack->push(k+1,j-1,0,w->get(k+1,j-1),0);
 								found = true;
 							}
 						}
 
 						if (!found&&i+1<k-1&&energy==penalty(i,j,ct,data)+
-								penalty(k,j-1,ct,data)+v->f(k,j-1)+
-								ergcoaxflushbases(k,j-1,j,i,ct,data)+w->f(i+1,k-1)+
+								penalty(k,j-1,ct,data)+v->get(k,j-1)+
+								ergcoaxflushbases(k,j-1,j,i,ct,data)+w->get(i+1,k-1)+
 								data->eparam[5]+2*data->eparam[10]) {
 
-							stack->push(k,j-1,0,v->f(k,j-1),1);
-							stack->push(i+1,k-1,0,w->f(i+1,k-1),0);
+							stack->push(k,j-1,0,v->get(k,j-1),1);
+							stack->push(i+1,k-1,0,w->get(i+1,k-1),0);
 							found = true;
 
 						}
 						else if (!found&&i+1<k-1&&(mod[k]||mod[j-1])&&inc[ct->numseq[k]][ct->numseq[j-1]]) {
 
 							if (energy==penalty(i,j,ct,data)+
-									penalty(k,j-1,ct,data)+v->f(k+1,j-2)+
-									ergcoaxflushbases(k,j-1,j,i,ct,data)+w->f(i+1,k-1)+
+									penalty(k,j-1,ct,data)+v->get(k+1,j-2)+
+									ergcoaxflushbases(k,j-1,j,i,ct,data)+w->get(i+1,k-1)+
 									data->eparam[5]+2*data->eparam[10]
 									+erg1(k,j-1,k+1,j-2,ct,data)) {
 
-								registerbasepair(ct,k,j-1);
-								stack->push(k+1,j-2,0,v->f(k+1,j-2),1);
-								stack->push(i+1,k-1,0,w->f(i+1,k-1),0);
+								registerbasepair(ct,k,j-1,structurenumber);
+								stack->push(k+1,j-2,0,v->get(k+1,j-2),1);
+								stack->push(i+1,k-1,0,w->get(i+1,k-1),0);
 								found = true;
 							}
 						}
 
 						if (!found&&i+2<k-1&&energy==penalty(i,j,ct,data)+
-								penalty(k,j-2,ct,data)+v->f(k,j-2)+
-								ergcoaxinterbases2(k,j-2,j,i,ct,data)+w->f(i+2,k-1)+
+								penalty(k,j-2,ct,data)+v->get(k,j-2)+
+								ergcoaxinterbases2(k,j-2,j,i,ct,data)+w->get(i+2,k-1)+
 								data->eparam[5]+2*data->eparam[10]+2*data->eparam[6]
 						   ){
 
-							stack->push(k,j-2,0,v->f(k,j-2),1);
-							stack->push(i+2,k-1,0,w->f(i+2,k-1),0);
+							stack->push(k,j-2,0,v->get(k,j-2),1);
+							stack->push(i+2,k-1,0,w->get(i+2,k-1),0);
 							found = true;
 						}
 
 						else if (!found&&i+2<k-1&&(mod[k]||mod[j-2])&&inc[ct->numseq[k]][ct->numseq[j-2]]) {
 							if (energy==penalty(i,j,ct,data)+
-									penalty(k,j-2,ct,data)+v->f(k+1,j-3)+
-									ergcoaxinterbases2(k,j-2,j,i,ct,data)+w->f(i+2,k-1)+
+									penalty(k,j-2,ct,data)+v->get(k+1,j-3)+
+									ergcoaxinterbases2(k,j-2,j,i,ct,data)+w->get(i+2,k-1)+
 									data->eparam[5]+2*data->eparam[10]+2*data->eparam[6]
 									+erg1(k,j-2,k+1,j-3,ct,data)){
 
-								registerbasepair(ct,k,j-2);
-								stack->push(k+1,j-3,0,v->f(k+1,j-3),1);
-								stack->push(i+2,k-1,0,w->f(i+2,k-1),0);
+								registerbasepair(ct,k,j-2,structurenumber);
+								stack->push(k+1,j-3,0,v->get(k+1,j-3),1);
+								stack->push(i+2,k-1,0,w->get(i+2,k-1),0);
 								found = true;
 							}
 						}
 
 						if (!found&&i+1<k-1&&energy==penalty(i,j,ct,data)+
-								penalty(k+1,j-2,ct,data)+v->f(k+1,j-2)+
-								ergcoaxinterbases1(k+1,j-2,j,i,ct,data)+w->f(i+1,k-1)+
+								penalty(k+1,j-2,ct,data)+v->get(k+1,j-2)+
+								ergcoaxinterbases1(k+1,j-2,j,i,ct,data)+w->get(i+1,k-1)+
 								data->eparam[5]+2*data->eparam[10]+2*data->eparam[6]
 						   ) {
 
-							stack->push(k+1,j-2,0,v->f(k+1,j-2),1);
-							stack->push(i+1,k-1,0,w->f(i+1,k-1),0);
+							stack->push(k+1,j-2,0,v->get(k+1,j-2),1);
+							stack->push(i+1,k-1,0,w->get(i+1,k-1),0);
 							found = true;
 						}
 						else if (!found&&i+1<k-1&&(mod[k+1]||mod[j-2])&&inc[ct->numseq[k+1]][ct->numseq[j-2]]) {
 
 							if (energy==penalty(i,j,ct,data)+
-									penalty(k+1,j-2,ct,data)+v->f(k+2,j-3)+
-									ergcoaxinterbases1(k+1,j-2,j,i,ct,data)+w->f(i+1,k-1)+
+									penalty(k+1,j-2,ct,data)+v->get(k+2,j-3)+
+									ergcoaxinterbases1(k+1,j-2,j,i,ct,data)+w->get(i+1,k-1)+
 									data->eparam[5]+2*data->eparam[10]+2*data->eparam[6]
 									+erg1(k+1,j-2,k+2,j-3,ct,data)) {
 
-								registerbasepair(ct,k+1,j-2);
-								stack->push(k+2,j-3,0,v->f(k+2,j-3),1);
-								stack->push(i+1,k-1,0,w->f(i+1,k-1),0);
+								registerbasepair(ct,k+1,j-2,structurenumber);
+								stack->push(k+2,j-3,0,v->get(k+2,j-3),1);
+								stack->push(i+1,k-1,0,w->get(i+1,k-1),0);
 								found = true;
 							}
 						}
@@ -2245,77 +2256,77 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 							a = j-number-minloop-2;
 							while (a>0&&!found) {
 								if (energy==w5[a-1]+w3[i+1]+penalty(i,j,ct,data)+
-										penalty(a,j-number-1,ct,data)+v->f(a,j-number-1)+
+										penalty(a,j-number-1,ct,data)+v->get(a,j-number-1)+
 										ergcoaxflushbases(a,j-number-1,j-number,i,ct,data)) {
 
 									if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 									if (i+1<number-minloop-1) stack->push(i+1,number,1,w3[i+1],0);
-									stack->push(a,j-number-1,0,v->f(a,j-number-1),1);
+									stack->push(a,j-number-1,0,v->get(a,j-number-1),1);
 									found = true;
 								}
 
 								else if ((mod[a]||mod[j-number-1])&&inc[ct->numseq[a]][ct->numseq[j-number-1]]) {
 
 									if (energy==w5[a-1]+w3[i+1]+penalty(i,j,ct,data)+
-											penalty(a,j-number-1,ct,data)+v->f(a+1,j-number-2)+
+											penalty(a,j-number-1,ct,data)+v->get(a+1,j-number-2)+
 											ergcoaxflushbases(a,j-number-1,j-number,i,ct,data)
 											+erg1(a,j-number-1,a+1,j-number-2,ct,data)) {
 
-										registerbasepair(ct,a,j-number-1);
+										registerbasepair(ct,a,j-number-1,structurenumber);
 										if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 										if (i+1<number-minloop-1) stack->push(i+1,number,1,w3[i+1],0);
-										stack->push(a+1,j-number-2,0,v->f(a+1,j-number-2),1);
+										stack->push(a+1,j-number-2,0,v->get(a+1,j-number-2),1);
 										found = true;
 									}
 								}
 
 								if (!found&&energy==w5[a-1]+w3[i+1]+penalty(i,j,ct,data)+
-										penalty(a+1,j-number-2,ct,data)+v->f(a+1,j-number-2)+
+										penalty(a+1,j-number-2,ct,data)+v->get(a+1,j-number-2)+
 										ergcoaxinterbases1(a+1,j-number-2,j-number,i,ct,data)
 								   ) {
 
 									if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 									if (i+1<number-minloop-1) stack->push(i+1,number,1,w3[i+1],0);
-									stack->push(a+1,j-number-2,0,v->f(a+1,j-number-2),1);
+									stack->push(a+1,j-number-2,0,v->get(a+1,j-number-2),1);
 									found = true;
 								}
 
 								else if (!found&&(mod[a+1]||mod[j-number-2])&&inc[ct->numseq[a+1]][ct->numseq[j-number-2]]) {
 
 									if (energy==w5[a-1]+w3[i+1]+penalty(i,j,ct,data)+
-											penalty(a+1,j-number-2,ct,data)+v->f(a+2,j-number-3)+
+											penalty(a+1,j-number-2,ct,data)+v->get(a+2,j-number-3)+
 											ergcoaxinterbases1(a+1,j-number-2,j-number,i,ct,data)
 											+erg1(a+1,j-number-2,a+2,j-number-3,ct,data)) {
 
-										registerbasepair(ct,a+1,j-number-2);
+										registerbasepair(ct,a+1,j-number-2,structurenumber);
 										if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 										if (i+1<number-minloop-1) stack->push(i+1,number,1,w3[i+1],0);
-										stack->push(a+2,j-number-3,0,v->f(a+2,j-number-3),1);
+										stack->push(a+2,j-number-3,0,v->get(a+2,j-number-3),1);
 										found = true;
 									}
 								}
 
 								if (!found&&energy==w5[a-1]+w3[i+2]+penalty(i,j,ct,data)+
-										penalty(a,j-number-2,ct,data)+v->f(a,j-number-2)+
+										penalty(a,j-number-2,ct,data)+v->get(a,j-number-2)+
 										ergcoaxinterbases2(a,j-number-2,j-number,i,ct,data)) {
 
 									if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 									if (i+2<number-minloop-1) stack->push(i+2,number,1,w3[i+2],0);
-									stack->push(a,j-number-2,0,v->f(a,j-number-2),1);
+									stack->push(a,j-number-2,0,v->get(a,j-number-2),1);
 									found = true;
 								}
 
 								else if (!found&&(mod[a]||mod[j-number-2])&&inc[ct->numseq[a]][ct->numseq[j-number-2]]) {
 
 									if (energy==w5[a-1]+w3[i+2]+penalty(i,j,ct,data)+
-											penalty(a,j-number-2,ct,data)+v->f(a+1,j-number-3)+
+											penalty(a,j-number-2,ct,data)+v->get(a+1,j-number-3)+
 											ergcoaxinterbases2(a,j-number-2,j-number,i,ct,data)
 											+erg1(a,j-number-2,a+1,j-number-3,ct,data)) {
 
-										registerbasepair(ct,a,j-number-2);
+										registerbasepair(ct,a,j-number-2,structurenumber);
 										if (a-1>minloop+1) stack->push(1,a-1,1,w5[a-1],0);
 										if (i+2<number-minloop-1) stack->push(i+2,number,1,w3[i+2],0);
-										stack->push(a+1,j-number-3,0,v->f(a+1,j-number-3),1);
+										stack->push(a+1,j-number-3,0,v->get(a+1,j-number-3),1);
 										found = true;
 									}
 								}
@@ -2326,82 +2337,82 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 							a = i+minloop+2;
 							while (a<=number&&!found) {
 								if (energy==w5[j-number-1]+w3[a+1]+penalty(i,j,ct,data)+
-										penalty(i+1,a,ct,data) +v->f(i+1,a)+
+										penalty(i+1,a,ct,data) +v->get(i+1,a)+
 										ergcoaxflushbases(j-number,i,i+1,a,ct,data)) {
 
 									if (j-number-1>minloop+1) stack->push(1,j-number-1,1,w5[j-number-1],0);
 									if (a+1<number-minloop-1) stack->push(a+1,number,1,w3[a+1],0);
 
-									stack->push(i+1,a,0,v->f(i+1,a),1);
+									stack->push(i+1,a,0,v->get(i+1,a),1);
 									found = true;
 								}
 
 								else if ((mod[i+1]||mod[a])&&inc[ct->numseq[i+1]][ct->numseq[a]]) {
 									if (energy==w5[j-number-1]+w3[a+1]+penalty(i,j,ct,data)+
-											penalty(i+1,a,ct,data) +v->f(i+2,a-1)+
+											penalty(i+1,a,ct,data) +v->get(i+2,a-1)+
 											ergcoaxflushbases(j-number,i,i+1,a,ct,data)
 											+erg1(i+1,a,i+2,a-1,ct,data)) {
 
-										registerbasepair(ct,i+1,a);
+										registerbasepair(ct,i+1,a,structurenumber);
 										if (j-number-1>minloop+1) stack->push(1,j-number-1,1,w5[j-number-1],0);
 										if (a+1<number-minloop-1) stack->push(a+1,number,1,w3[a+1],0);
 
-										stack->push(i+2,a-1,0,v->f(i+2,a-1),1);
+										stack->push(i+2,a-1,0,v->get(i+2,a-1),1);
 										found = true;
 									}
 								}
 
 								if (j-number-2>-1) {
 									if (!found&&energy==w5[j-number-2]+w3[a+1]+penalty(i,j,ct,data)+
-											penalty(i+2,a,ct,data)+v->f(i+2,a)+
+											penalty(i+2,a,ct,data)+v->get(i+2,a)+
 											ergcoaxinterbases1(j-number,i,i+2,a,ct,data)
 									   ) {
 
 										if (j-number-2>minloop+1) stack->push(1,j-number-2,1,w5[j-number-2],0);
 										if (a+1<number-minloop-1) stack->push(a+1,number,1,w3[a+1],0);
 
-										stack->push(i+2,a,0,v->f(i+2,a),1);
+										stack->push(i+2,a,0,v->get(i+2,a),1);
 										found = true;
 									}
 									else if (!found&&(mod[i+2]||mod[a])&&inc[ct->numseq[i+2]][ct->numseq[a]]) {
 										if (!found&&energy==w5[j-number-2]+w3[a+1]+penalty(i,j,ct,data)+
-												penalty(i+2,a,ct,data)+v->f(i+3,a-1)+
+												penalty(i+2,a,ct,data)+v->get(i+3,a-1)+
 												ergcoaxinterbases1(j-number,i,i+2,a,ct,data)
 												+erg1(i+2,a,i+3,a-1,ct,data)) {
 
-											registerbasepair(ct,i+2,a);
+											registerbasepair(ct,i+2,a,structurenumber);
 											if (j-number-2>minloop+1) stack->push(1,j-number-2,1,w5[j-number-2],0);
 											if (a+1<number-minloop-1) stack->push(a+1,number,1,w3[a+1],0);
 
-											stack->push(i+3,a-1,0,v->f(i+3,a-1),1);
+											stack->push(i+3,a-1,0,v->get(i+3,a-1),1);
 											found = true;
 										}
 									}
 								}
 
 								if (!found&&energy==w5[j-number-1]+w3[a+1]+penalty(i,j,ct,data)+
-										penalty(i+2,a-1,ct,data)+v->f(i+2,a-1)+
+										penalty(i+2,a-1,ct,data)+v->get(i+2,a-1)+
 										ergcoaxinterbases2(j-number,i,i+2,a-1,ct,data)) {
 
 									if (j-number-1>minloop+1) stack->push(1,j-number-1,1,w5[j-number-1],0);
 									if (a+1<number-minloop-1) stack->push(a+1,number,1,w3[a+1],0);
 
-									stack->push(i+2,a-1,0,v->f(i+2,a-1),1);
+									stack->push(i+2,a-1,0,v->get(i+2,a-1),1);
 									found = true;
 
 								}
 
 								else if (!found&&(mod[i+2]||mod[a-1])&&inc[ct->numseq[i+2]][ct->numseq[a-1]]) {
 									if (!found&&energy==w5[j-number-1]+w3[a+1]+penalty(i,j,ct,data)+
-											penalty(i+2,a-1,ct,data)+v->f(i+3,a-2)+
+											penalty(i+2,a-1,ct,data)+v->get(i+3,a-2)+
 											ergcoaxinterbases2(j-number,i,i+2,a-1,ct,data)
 											+erg1(i+2,a-1,i+3,a-2,ct,data)) {
 
-										registerbasepair(ct,i+2,a-1);
+										registerbasepair(ct,i+2,a-1,structurenumber);
 										if (j-number-1>minloop+1) stack->push(1,j-number-1,1,w5[j-number-1],0);
 										if (a+1<number-minloop-1) stack->push(a+1,number,1,w3[a+1],0);
 
-										stack->push(i+3,a-2,0,v->f(i+3,a-2),1);
+										stack->push(i+3,a-2,0,v->get(i+3,a-2),1);
 										found = true;
 
 									}
@@ -2417,33 +2428,33 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 					if (ct->intermolecular) {
 
 
-						if (energy==wmb2->f(i+1,j-1)+penalty(i,j,ct,data)+INFINITE_ENERGY) {
+						if (energy==wmb2->get(i+1,j-1)+penalty(i,j,ct,data)+INFINITE_ENERGY) {
 
-							stack->push(i+1,j-1,0,wmb2->f(i+1,j-1),2);
+							stack->push(i+1,j-1,0,wmb2->get(i+1,j-1),2);
 							found = true;
 
 						}
-						else if (energy==wmb2->f(i+2,j-1)+penalty(i,j,ct,data)+
+						else if (energy==wmb2->get(i+2,j-1)+penalty(i,j,ct,data)+
 								erg4(i,j,i+1,1,ct,data,lfce[i+1])+INFINITE_ENERGY) {
 
-							stack->push(i+2,j-1,0,wmb2->f(i+2,j-1),2);
+							stack->push(i+2,j-1,0,wmb2->get(i+2,j-1),2);
 							found = true;
 
 						}
-						else if (energy==wmb2->f(i+1,j-2)+penalty(i,j,ct,data)+
+						else if (energy==wmb2->get(i+1,j-2)+penalty(i,j,ct,data)+
 								erg4(i,j,j-1,2,ct,data,lfce[j-1])+INFINITE_ENERGY) {
 
-							stack->push(i+1,j-2,0,wmb2->f(i+1,j-2),2);
+							stack->push(i+1,j-2,0,wmb2->get(i+1,j-2),2);
 							found = true;
 
 						}
-						else if (energy==wmb2->f(i+2,j-2)+penalty(i,j,ct,data)+
+						else if (energy==wmb2->get(i+2,j-2)+penalty(i,j,ct,data)+
 								INFINITE_ENERGY+
 								data->tstkm[ct->numseq[i]][ct->numseq[j]]
 								[ct->numseq[i+1]][ct->numseq[j-1]]
 								+checknp(lfce[i+1],lfce[j-1])) {
 
-							stack->push(i+2,j-2,0,wmb2->f(i+2,j-2),2);
+							stack->push(i+2,j-2,0,wmb2->get(i+2,j-2),2);
 							found = true;
 
 						}
@@ -2460,20 +2471,20 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 								//if (abs(a-i+b-j)<=data->eparam[8]) { 
 
 								if (energy==(erg2(i,j,a,b,ct,data,fce->f(i,a),fce->f(b,j))+
-											v->f(a,b))) {
+											v->get(a,b))) {
 									i = a;
 									j = b;
-									stack->push(i,j,0,v->f(i,j),1);
+									stack->push(i,j,0,v->get(i,j),1);
 									found = true;
 								}
 								//}
 								if ((mod[a]||mod[b])&&inc[ct->numseq[a]][ct->numseq[b]]) {
 									if (energy==(erg2(i,j,a,b,ct,data,fce->f(i,a),fce->f(b,j))+
-												v->f(a+1,b-1)+erg1(a,b,a+1,b-1,ct,data))) {
+												v->get(a+1,b-1)+erg1(a,b,a+1,b-1,ct,data))) {
 										i = a+1;
 										j = b-1;
-										registerbasepair(ct,a,b);
-										stack->push(i,j,0,v->f(i,j),1);
+										registerbasepair(ct,a,b,structurenumber);
+										stack->push(i,j,0,v->get(i,j),1);
 										found = true;
 									}
 								}
@@ -2495,9 +2506,16 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 
 
 
-#define maxsort 90000 //Starting point for the maximum number of basepairs within %cntrl8
-//of the minimum free energy.
+//The highest energy of the pairs that traceback uses: within cntrl8 percent of vmin, or
+//within -cntrl8 when cntrl8 is not positive
+static int suboptimalcrit(int vmin, int cntrl8) {
+	int crit;
+
+	if (cntrl8> 0) crit= (int) (abs(vmin)*(float (cntrl8)/100.0));
+	else crit = -cntrl8;
 
+	return crit + vmin;
+}
 
 //Traceback predicts a set of low free energy structures using the mfold heuristic with the fill step information.
 //cntrl8 is the maximum % difference in free energy of suboptimal structures if > 0
@@ -2506,26 +2524,22 @@ int trace(structure *ct, datatable *data, int ii, int ji,
 //This returns an error code, where zero is no error and non-zero indicates a traceback error.
 int traceback(structure *ct, datatable *data, arrayclass *v, arrayclass *v1, arrayclass *v2, arrayclass *w, arrayclass *wmb, arrayclass *w2,arrayclass *wmb2, integersize *w3, integersize *w5, forceclass *fce,
               bool *lfce,integersize vmin, int cntrl6, int cntrl8, int cntrl9, bool *mod) {
-	bool flag,**mark;
+	bool flag;
 	register int number;
-	int ii,sort;
 	int i;
-	int iret,jret,numbp,count,count2,k1,k2,num,crit;
-	int *heapi,*heapj;
+	int numbp,k1,num,crit;
 	int cur,c,k,j,cntr;
-	int ji;//(added during debugging)
 	int tracebackerror=0;
 
-	integersize *energy;
+	//heapi, heapj and energy hold the candidate pairs from index 1; they grow as candidates are found
+	vector<int> heapi,heapj;
+	vector<integersize> energy;
 
 #if defined(debugmode)
 	char filename[maxfil];
 	char temp[20];
 #endif
 
-	//mark keeps track of which pairs have been formed by the suboptimal routine
-
-	sort = maxsort;
 	number = ct->GetSequenceLength();
 
 	
@@ -2547,49 +2561,21 @@ int traceback(structure *ct, datatable *data, arrayclass *v, arrayclass *v1, arr
 
 	
 
-	//dynamically allocate space for mark:
-	mark = new bool *[number + 1];
-	for (i=0;i<=(number);i++)
-		mark[i] = new bool [number + 1];
+	//marks keeps track of which pairs have been formed by the suboptimal routine
+	pairmarks marks(number);
 
 	//This is the traceback portion of the dynamic algorithm
 
-	flag = true;
-	
-
-	for (count=1;count<=(number);count++) {
-		for (count2=1;count2<=(number);count2++) {
-			mark[count][count2]=false;
-		}
-	}
-
-	if (cntrl8> 0) crit= (int) (abs(vmin)*(float (cntrl8)/100.0));
-	else crit = -cntrl8;
-
-	crit = crit + vmin;
+	crit = suboptimalcrit(vmin,cntrl8);
 
-	energy = new integersize [sort+1];
-	heapi = new int [sort+1];
-	heapj = new int [sort+1];
+	//energy[0] is never used, but gets tested in the case that up=0
+	heapi.push_back(0);
+	heapj.push_back(0);
+	energy.push_back(0);
 
-	num = 0;
 	i = 1;
 	j = 2;
 	while (i<(number)) {
-		if (num==sort) {
-			//allocate more space for the heap
-			delete[] heapi;
-			delete[] heapj;
-			delete[] energy;
-			sort = 10*sort;
-			heapi = new int [sort+1];
-			heapj = new int [sort+1];
-			energy = new integersize [sort+1];
-			i = 1;
-			j = 2;
-			num = 0;
-
-		}
 		
 		//FD
 		
@@ -2601,10 +2587,9 @@ int traceback(structure *ct, datatable *data, arrayclass *v, arrayclass *v1, arr
 		
 		if (the_energy <= crit) { 
 
-			num++;
-			heapi[num]=i;
-			heapj[num]=j;
-			energy[num] = the_energy;
+			heapi.push_back(i);
+			heapj.push_back(j);
+			energy.push_back(the_energy);
 			j = j+cntrl9+1;
 			if (j>number) {
 				i++;
@@ -2616,10 +2601,9 @@ int traceback(structure *ct, datatable *data, arrayclass *v, arrayclass *v1, arr
 			if (v->f(i,j)<INFINITE_ENERGY) {
 				cur = v->f(i,j)+v->f(j+1,i+number-1)+erg1(j,i+number,j+1,i+number-1,ct,data);
 				if (cur<=crit) {
-					num++;
-					heapi[num]=i;
-					heapj[num]=j;
-					energy[num] = crit;
+					heapi.push_back(i);
+					heapj.push_back(j);
+					energy.push_back(crit);
 					j = j+cntrl9+1;
 					if (j>number) {
 						i++;
@@ -2640,10 +2624,9 @@ int traceback(structure *ct, datatable *data, arrayclass *v, arrayclass *v1, arr
 			else if (v->f(j,i+number)==INFINITE_ENERGY) {
 				cur = v->f(i+1,j-1)+v->f(j,i+number)+erg1(i,j,i+1,j-1,ct,data);
 				if (cur<=crit) {
-					num++;
-					heapi[num]=i;
-					heapj[num]=j;
-					energy[num] = crit;
+					heapi.push_back(i);
+					heapj.push_back(j);
+					energy.push_back(crit);
 					j = j+cntrl9+1;
 					if (j>number) {
 						i++;
@@ -2679,6 +2662,7 @@ int traceback(structure *ct, datatable *data, arrayclass *v, arrayclass *v1, arr
 			}
 		}
 	}
+	num = (int) heapi.size()-1;
 
 	//sort the base pair list:
 	///////////////////////////////////
@@ -2686,7 +2670,6 @@ int traceback(structure *ct, datatable *data, arrayclass *v, arrayclass *v1, arr
 	//make a heap:
 
 	int q,up,ir;
-	energy[0]=0;//energy[0] is never used, but gets tested in the case that up=0;
 	for (q=2;q<=num;q++) {
 		cur = q;
 		up = cur/2;
@@ -2727,40 +2710,49 @@ int traceback(structure *ct, datatable *data, arrayclass *v, arrayclass *v1, arr
 	
 	
 
-	cntr = num;
+	//The candidates are traced from the lowest free energy, skipping those already marked by a kept structure.
+	//	In the SMP build, the next unmarked candidates are traced in parallel, one per thread, and are then kept
+	//	or rejected in order, exactly as they would be one at a time.  A candidate that is marked by a structure
+	//	kept earlier in its batch is skipped, as it would have been, so the structures do not depend on the
+	//	number of threads.
+	int batchsize = 1;
+#ifdef SMP
+	batchsize = omp_get_max_threads();
+#endif
+	vector<int> batch;
+	vector< vector<int> > batchpairs(batchsize,vector<int>(number+1));
+	vector<int> batcherror(batchsize);
 
-	//keep track if a structure was allocated, but has been rejected with failedprevious.
-	bool failedprevious = false;
+	cntr = num;
+	flag = num>0;
 	while (flag) {
-		//This is routine to select the region of the structure to be
-		//	folded, it allows for sub-optimal structure predictions
-		//err=0;
-		//Select the next valid unmarked basepair
-		while (mark[heapi[cntr]][heapj[cntr]]) {
-			if (cntr==1) {
-				flag=false;
-				goto sub900;
-			}
-			cntr--;
+		//Select the next valid unmarked basepairs
+		batch.clear();
+		for (c=cntr;c>=1&&(int) batch.size()<batchsize;c--) {
+			if (!marks.get(heapi[c],heapj[c])) batch.push_back(c);
 		}
-		iret = heapi[cntr];
-		jret = heapj[cntr];
-		//No prior structure was allocated, so add a structure now:
-		if (!failedprevious) ct->AddStructure();
-		//The prior failed structure needs to be cleaned, i.e. all base pairs removed:
-		else ct->CleanStructure(ct->GetNumberofStructures());
-		//Reset failedprevious as a new traceback is started:
-		failedprevious=false;
-
-		//Traceback to find best structure on included fragment (ie:iret to jret)
-		if (flag) {
+		if (batch.empty()) break;
+
+		//Traceback to find best structure on included fragment (ie:iret to jret), each in a structure of its own
+		int first = ct->GetNumberofStructures()+1;
+		for (k=0;k<(int) batch.size();k++) ct->AddStructure();
+
+#ifdef SMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for (int b=0;b<(int) batch.size();b++) {
+			int iret = heapi[batch[b]];
+			int jret = heapj[batch[b]];
+			int ii,ji,count,n;
+
+			batcherror[b] = 0;
 			for (count=1;count<=2;count++) {
 				if (count==1) {
 					ii=iret;
 					ji=jret;
 			
 				}
-				if (count==2) {
+				else {
 					ii=jret;
 					ji=iret+(number);
 				}
@@ -2774,72 +2766,74 @@ int traceback(structure *ct, datatable *data, arrayclass *v, arrayclass *v1, arr
 					}
 				}
 #ifndef DYNALIGN_II
-				//cout<<"trace:"<<ii<<"-"<<ji<<"  "<<energy[cntr]<<endl;
-				if(trace(ct,data,ii,ji,v, v1, v2, w,wmb,w2,wmb2,lfce,fce,w3,w5,mod)!=0) tracebackerror=1;//FD
+				if(trace(ct,data,ii,ji,v, v1, v2, w,wmb,w2,wmb2,lfce,fce,w3,w5,mod,false,first+b)!=0) batcherror[b]=1;//FD
 #else
-				if(trace(ct,data,ii,ji,v, v1, v2, w,wmb,w2,wmb2,lfce,fce,w3,w5,mod,NULL)!=0) tracebackerror=1;//FD
+				if(trace(ct,data,ii,ji,v, v1, v2, w,wmb,w2,wmb2,lfce,fce,w3,w5,mod,NULL,0,0,0,false,first+b)!=0) batcherror[b]=1;//FD
 #endif
-				if (count==2) {
-
-					ct->SetEnergy(ct->GetNumberofStructures(),energy[cntr]);
-					//count the number of new base pairs not within window of existing
-					//base pairs
-					numbp = 0;
-					for (k=1;k<=number;k++) {
-						if (k<(ct->GetPair(k,ct->GetNumberofStructures()))) {
-							if (!(mark[k][ct->GetPair(k,ct->GetNumberofStructures())])) numbp++;
-						}
-					}
-					for (k=1;k<=(number);k++) {
-						if (k<ct->GetPair(k,ct->GetNumberofStructures())) {
-							//Mark "traced back" base pairs and also base pairs
-							//	which are within a window of cntrl9
-							mark[k][ct->GetPair(k,ct->GetNumberofStructures())]=true;
-							if (cntrl9>0) {
-								for (k1=max(1,k-cntrl9);k1<=min(number,k+cntrl9);k1++) {
-									for (k2=max(k1,ct->GetPair(k,ct->GetNumberofStructures())-cntrl9);k2<=min(number,ct->GetPair(k,ct->GetNumberofStructures())+cntrl9);k2++) {
-                        	
-										mark[k1][k2]=true;
-									}
-								}
-							}
-						}
-					}
-					if (numbp<=cntrl9&&ct->GetNumberofStructures()>1) {
-						failedprevious=true;
+			}
+			for (n=1;n<=number;n++) batchpairs[b][n] = ct->GetPair(n,first+b);
+		}
+		for (k=0;k<(int) batch.size();k++) ct->RemoveLastStructure();
 
-						//goto sub900;
-					}
-					else {
+		for (int b=0;b<(int) batch.size()&&flag;b++) {
+			cntr = batch[b];
+			if (marks.get(heapi[cntr],heapj[cntr])) continue;
+			if (batcherror[b]) tracebackerror=1;
+
+			ct->AddStructure();
+			int structurenumber = ct->GetNumberofStructures();
+			for (k=1;k<=number;k++) {
+				if (k<batchpairs[b][k]) ct->SetPair(k,batchpairs[b][k],structurenumber);
+			}
+
+			//checking the structure against the window is the filter step of the profile
+			profiletimer timer(profile.filtertime);
+
+			ct->SetEnergy(structurenumber,energy[cntr]);
+			//count the number of new base pairs not within window of existing
+			//base pairs
+			numbp = 0;
+			for (k=1;k<=number;k++) {
+				if (k<(ct->GetPair(k,structurenumber))) {
+					if (!(marks.get(k,ct->GetPair(k,structurenumber)))) numbp++;
+				}
+			}
+			for (k=1;k<=(number);k++) {
+				if (k<ct->GetPair(k,structurenumber)) {
+					//Mark "traced back" base pairs and also base pairs
+					//	which are within a window of cntrl9
+					k1 = ct->GetPair(k,structurenumber);
+					if (cntrl9>0) marks.setwindow(k-cntrl9,k+cntrl9,k1-cntrl9,k1+cntrl9);
+					else marks.set(k,k1);
+				}
+			}
+
+			//The candidate is marked even if a modified nucleotide kept it out of its own structure, so that it is
+			//	not traced again.
+			marks.set(heapi[cntr],heapj[cntr]);
 
-						//place the structure name (from ctlabel[1]) into each structure
-						ct->SetCtLabel(ct->GetSequenceLabel(), ct->GetNumberofStructures());
-						//cout<<iret<<"-"<<jret<<"  "<<v->f(iret, jret)+v->f(jret,iret+number)<<endl;
+			if (numbp<=cntrl9&&ct->GetNumberofStructures()>1) {
+				//the structure is too similar to those already kept
+				ct->RemoveLastStructure();
+			}
+			else {
+
+				//place the structure name (from ctlabel[1]) into each structure
+				ct->SetCtLabel(ct->GetSequenceLabel(), structurenumber);
 #if defined(debugmode)
-					
-						strcpy(filename,"energydump");
-						itoa(ct->GetNumberofStructures(),temp,10);
-						strcat(filename,temp);
-						strcat(filename,".out");
-						energydump (ct, v, data, ct->GetNumberofStructures(),filename,iret,jret);
+			
+				strcpy(filename,"energydump");
+				itoa(structurenumber,temp,10);
+				strcat(filename,temp);
+				strcat(filename,".out");
+				energydump (ct, v, data, structurenumber,filename,heapi[cntr],heapj[cntr]);
 #endif
 
-					}
-					if (ct->GetNumberofStructures()==cntrl6&&!failedprevious) {
-						flag=false;
-					}
-				}
+				if (ct->GetNumberofStructures()==cntrl6) flag=false;
 			}
-		sub900:
-			continue;
 		}
 	}
-	if (failedprevious) ct->RemoveLastStructure();
 
-	de_allocate (mark,number+1);
-	delete[] energy;
-	delete[] heapi;
-	delete[] heapj;
 	return tracebackerror;
 }
 
@@ -2921,7 +2915,8 @@ void force(structure *ct,forceclass *fce, bool *lfce){
 	//The next section handles the case where base pairs are not
 	//not allowed to form between nucs more distant
 	//than ct->GetPairingDistanceLimit()
-	if (ct->DistanceLimited()) {
+	//(a banded fill checks the distance itself, without the N^2 template)
+	if (ct->DistanceLimited()&&!fce->IsBanded()) {
 
 		if (!ct->templated) ct->allocatetem();
 
@@ -2935,6 +2930,21 @@ void force(structure *ct,forceclass *fce, bool *lfce){
 #else
 #endif
 
+//The largest j-i that the fill needs to store for ct, or 0 if every fragment is needed.
+//When only the lowest free energy is wanted and the pairing distance is limited, pairs span
+//less than the limit, and two coaxially stacked helices (wca) less than twice the limit, plus
+//the few nucleotides that the mismatch and modified nucleotide terms reach past the pairs,
+//so nothing further apart than that is ever used.
+int fillband(structure *ct, bool quick) {
+	int band;
+
+	if (!quick||!ct->DistanceLimited()||ct->intermolecular) return 0;
+
+	band = 2*(ct->GetPairingDistanceLimit()+3);
+	if (band>=ct->GetSequenceLength()) return 0;
+	return band;
+}
+
 #ifndef DYNALIGN_II
 	//This is the dynamic algorithm of Zuker:
 	//cntrl6 = #tracebacks
@@ -3020,14 +3030,19 @@ void force(structure *ct,forceclass *fce, bool *lfce){
 #endif
 
 			//allocate space for the v and w arrays:
-			arrayclass w(number);
-			arrayclass v1(number);//FD
-			arrayclass v2(number);//FD
+			//when only the lowest free energy is needed, the exterior fragments (j>number) are never filled;
+			//a save file holds the full arrays, so they are only cut down without one
+			bool triangular = (quickenergy||quickstructure)&&!ct->intermolecular&&save==0;
+			//with a maximum pairing distance, only a band along the diagonal is stored
+			int band = fillband(ct,(quickenergy||quickstructure)&&save==0);
+			arrayclass w(number,INFINITE_ENERGY,triangular,band);
+			arrayclass v1(number,INFINITE_ENERGY,triangular,band);//FD
+			arrayclass v2(number,INFINITE_ENERGY,triangular,band);//FD
 #ifndef INSTRUMENTED // if INSTRUMENTED compiler flag is defined
-			arrayclass v(number);
+			arrayclass v(number,INFINITE_ENERGY,triangular,band);
 #endif
-			arrayclass wmb(number);
-			forceclass fce(number);
+			arrayclass wmb(number,INFINITE_ENERGY,triangular,band);
+			forceclass fce(number,band);
 
 			//add a second array for intermolecular folding:
 			arrayclass *w2,*wmb2;
@@ -3103,8 +3118,28 @@ void force(structure *ct,forceclass *fce, bool *lfce){
 
 #ifndef INSTRUMENTED//If pre-compiler flag INSTRUMENTED is not defined, compile the following code
 #ifndef DYNALIGN_II
+			if (profile.enabled) {
+				profile.addallocation("v",v.GetAllocatedBytes());
+				profile.addallocation("v1",v1.GetAllocatedBytes());
+				profile.addallocation("v2",v2.GetAllocatedBytes());
+				profile.addallocation("w",w.GetAllocatedBytes());
+				profile.addallocation("wmb",wmb.GetAllocatedBytes());
+				if (ct->intermolecular) {
+					profile.addallocation("w2",w2->GetAllocatedBytes());
+					profile.addallocation("wmb2",wmb2->GetAllocatedBytes());
+				}
+				profile.addallocation("w5,w3",(2*number+3)*sizeof(integersize));
+			}
+
 			//perform the fill steps:(i.e. fill arrays v and w.)
-			fill(ct, v, v1, v2, w, wmb, fce, vmin,lfce, mod,w5, w3, quickenergy, data, w2, wmb2, update, maxinter,quickstructure);//FD
+			//Without a save file, traceback only reads the exterior fragments of pairs within the percent sort,
+			//so the others need not be filled.  Modified nucleotides are traced outside that window.
+			{
+				profiletimer timer(profile.filltime);
+				bool pruneexterior = save==0&&ct->GetNumberofModified()==0;
+				fill(ct, v, v1, v2, w, wmb, fce, vmin,lfce, mod,w5, w3, quickenergy, data, w2, wmb2, update, maxinter,quickstructure,
+					pruneexterior,cntrl8);//FD
+			}
 #else
                         fill(ct, v, v1, v2, w, wmb, fce, vmin,lfce, mod,w5, w3, quickenergy, data, w2, wmb2, NULL, update, maxinter);//FD
 #endif
@@ -3198,34 +3233,20 @@ void force(structure *ct,forceclass *fce, bool *lfce){
 		//write the SHAPE data (for pseudo-free energy constraints)
 		write(&sav,&(ct->shaped));
 		if (ct->shaped) {
-			for (i=0;i<=2*ct->GetSequenceLength();i++) write(&sav,&(ct->SHAPE[i]));
-
-		}
-
-	
-		//now write the array class data for v, w, and wmb:
-		for (i=0;i<=ct->GetSequenceLength();i++) {
-			write(&sav,&(w3[i]));
-			write(&sav,&(w5[i]));
-			for (j=0;j<=ct->GetSequenceLength();j++) {
-				write(&sav,&(v.dg[i][j+i]));
-				write(&sav,&(w.dg[i][j+i]));
-				write(&sav,&(wmb.dg[i][j+i]));
-				writesinglechar(&sav,&(fce.dg[i][j]));
+			sav.write((char *) ct->SHAPE,(2*ct->GetSequenceLength()+1)*sizeof(double));
+			sav.write((char *) ct->SHAPEss,(2*ct->GetSequenceLength()+1)*sizeof(double));
 
+			//and the differences between the stacked and helix-end pseudo-energies, which the traceback uses
+			write(&sav,&(ct->SHAPEFileRead));
+			if (ct->SHAPEFileRead) sav.write((char *) ct->SHAPEdiff,(2*ct->GetSequenceLength()+1)*sizeof(double));
 
-				if (ct->intermolecular) {
-					write(&sav,&(w2->dg[i][j+i]));
-					write(&sav,&(wmb2->dg[i][j+i]));
-				}
-			}	
 		}
 
-		write(&sav,&(w3[ct->GetSequenceLength()+1]));
-		for (i=0;i<=2*ct->GetSequenceLength();i++) {
-			write(&sav,&(lfce[i]));
-			write(&sav,&(mod[i]));
-		}
+		//w5, w3 and the nucleotide constraints; the arrays are written at the end of the file
+		sav.write((char *) w5,(ct->GetSequenceLength()+1)*sizeof(integersize));
+		sav.write((char *) w3,(ct->GetSequenceLength()+2)*sizeof(integersize));
+		sav.write((char *) lfce,(2*ct->GetSequenceLength()+1)*sizeof(bool));
+		sav.write((char *) mod,(2*ct->GetSequenceLength()+1)*sizeof(bool));
 
 		write(&sav,&vmin);
 
@@ -3300,10 +3321,22 @@ void force(structure *ct,forceclass *fce, bool *lfce){
 		write(&sav,&(data->strain));
 		write(&sav,&(data->prelog));
 		write(&sav,&(data->singlecbulge));
+
+		//now the arrays, each as one block that readsav can use in place: v, v1, v2, w, wmb, fce, and w2 and wmb2 for intermolecular folds
+		arrayclass *arrays[7] = {&v,&v1,&v2,&w,&wmb,w2,wmb2};
+		int arraycount = ct->intermolecular ? 7 : 5;
+		vector<saveblock> blocks(arraycount+1);
+		for (i=0;i<arraycount;i++) blocks[i].bytes = (long long) (number+1)*(number+1)*sizeof(integersize);
+		blocks[arraycount].bytes = fce.GetBlockSize();
+		writesavedirectory(&sav,blocks);
+		for (i=0;i<arraycount;i++) writesaveblock(&sav,blocks[i],arrays[i]->dg[0]);
+		writesaveblock(&sav,blocks[arraycount],fce.GetBlock());
 	
 		sav.close();
 	}
 
+	{
+	profiletimer timer(profile.tracebacktime);
 	if (quickenergy) {
 		//Don't do traceback, just return energy
 
@@ -3318,6 +3351,7 @@ void force(structure *ct,forceclass *fce, bool *lfce){
 	}
 
 	else tracebackerror=traceback(ct, data, &v, &v1, &v2, &w, &wmb, w2, wmb2,w3, w5, &fce, lfce, vmin, cntrl6, cntrl8, cntrl9,mod);//FD
+	}
 
 //<<<<<<< algorithm.cpp
 //	if (quickenergy) {
@@ -3411,452 +3445,482 @@ void force(structure *ct,forceclass *fce, bool *lfce){
 #else
 #endif
 
-	//The fill routine is encapsulated in function fill.
-	//This was separated from dynamic on 3/12/06 by DHM.  This provides greater flexibility
-	//for use of the arrays for other tasks than secondary structure prediction, e.g. dot plots.
+	//Single-stranded SHAPE pseudoenergy for the O(N^3) internal loop recursion.
+	//For a loop closed by i-j and ip-jp where both sides have at least two unpaired nucleotides,
+	//erg2 adds SHAPEss_calc(i+1,ip-1)+SHAPEss_calc(jp+1,j-1).  With the running sums in
+	//structure::SHAPEss_sum, which cover the doubled sequence, this separates into a term that depends
+	//only on the inner pair (stored in loopE) and a term that depends only on the closing
+	//pair (added when loopE is used), so the interior energies prefilled for i+1,j-1 remain
+	//valid for i,j.
+	template <bool shaped>
+	inline integersize SHAPEssInnerPair(structure *ct, int ip, int jp) {
+		if (!shaped||!ct->shaped) return 0;
+		return ct->SHAPEss_calc(ip-2,ip-1) + ct->SHAPEss_sum[ip-3] - ct->SHAPEss_sum[jp];
+	}
+
+	template <bool shaped>
+	inline integersize SHAPEssOuterPair(structure *ct, int i, int j) {
+		if (!shaped||!ct->shaped) return 0;
+		return ct->SHAPEss_calc(j-2,j-1) + ct->SHAPEss_sum[j-3] - ct->SHAPEss_sum[i];
+	}
+
+	//mod[i] for fillcell, which is always false when modified is false (no nucleotide is modified).
+	template <bool modified>
+	struct modflags {
+		bool *flags;
+		bool operator[](int i) const { return modified&&flags[i]; }
+	};
+
+	//The SHAPE terms of fillcell, which are zero when shaped is false (no SHAPE data was read).
+	template <bool shaped>
+	inline int SHAPEss(structure *ct, int i) {
+		return shaped ? ct->SHAPEss_give_value(i) : 0;
+	}
+
+	template <bool shaped>
+	inline int SHAPEdiff(structure *ct, int i) {
+		return shaped ? ct->SHAPEdiff_give_value(i) : 0;
+	}
+
+	template <bool shaped>
+	inline integersize SHAPEpair(int i, int j, structure *ct) {
+		return shaped ? SHAPEendPair(i,j,ct) : 0;
+	}
+
+	//Whether an energy can only come from fragments that were pruned (see fillstate::prune).
+	inline bool pruned(integersize energy) {
+		return energy>=INFINITE_ENERGY;
+	}
+
+	struct fillstate;
+	typedef void (*fillcellfunction)(fillstate &s, int i, int j);
+
+	//The arrays and settings shared by the fragments of one fill.
+	struct fillstate {
+		structure *ct;
+		datatable *data;
+		arrayclass *v,*v1,*v2,*w,*wmb,*w2,*wmb2;
 #if defined DYNALIGN_II
-void fill(structure *ct, arrayclass &v, arrayclass &v1, arrayclass &v2, arrayclass &w, arrayclass &wmb, forceclass &fce, int &vmin,bool *lfce, bool *mod,
-          integersize *w5, integersize *w3, bool quickenergy,
-          datatable *data, arrayclass *w2, arrayclass *wmb2, arrayclass *we,TProgressDialog* update, int maxinter, bool quickstructure)
+		arrayclass *we;
+#elif defined INSTRUMENTED
+		arrayclass *vmb,*vext;
+#endif
+		forceclass *fce;
+		bool *lfce,*mod;
+		integersize *w5,*w3;
+		integersize **wca;
+		//loopE[i+j] holds the interior loop energies prefilled for the fragments i,j, i-1,j+1, ...
+		//(i+j-number for the exterior fragments), indexed by the span of the inner pair
+		integersize **loopE;
+		//wcol[j][i] mirrors w.f(i,j), so that the columns of w can be read in order
+		integersize **wcol;
+		int *vmin;
+		int number,band,limit,maxinter,maxll;
+		//the instantiation of fillcell for the features of ct
+		fillcellfunction cell;
+		//with prune, the exterior fragments that cannot be part of a structure with energy up
+		//to critbound are not searched, and are set to INFINITE_ENERGY (see boundexterior)
+		bool prune;
+		int critbound,pairslack,coaxbound;
+		//helix5[m] is the lowest energy of a helix k-m, with its terminal penalty, and the fold
+		//of 1..k-1 (w5[k-1]); helix5gap[m] leaves k-1 unpaired (w5[k-2]).  helix3[m] and
+		//helix3gap[m] are the same for a helix m-k and w3[k+1] or w3[k+2].
+		integersize *helix5,*helix5gap,*helix3,*helix3gap;
+	};
+
+	//Fill fragment i,j: v, w, wmb and, at the ends of the sequence, w5[j] or w3[i].
+	//Every fragment inside i,j (i<=ip<=jp<=j) must already be filled.
+	//Each template flag says whether a feature may be present; when it is false the feature
+	//is known to be absent, and its tests are compiled out (see choosefillcell).
+	template <bool intermolecular, bool templated, bool modified, bool bonus, bool shaped>
+	static void fillcell(fillstate &s, int i, int j) {
+		structure *ct = s.ct;
+		datatable *data = s.data;
+		arrayclass &v = *s.v;
+		arrayclass &v1 = *s.v1;
+		arrayclass &v2 = *s.v2;
+		arrayclass &w = *s.w;
+		arrayclass &wmb = *s.wmb;
+		arrayclass *w2 = s.w2;
+		arrayclass *wmb2 = s.wmb2;
+#if defined DYNALIGN_II
+		arrayclass *we = s.we;
+#elif defined INSTRUMENTED
+		arrayclass &vmb = *s.vmb;
+		arrayclass &vext = *s.vext;
+#endif
+		forceclass &fce = *s.fce;
+		bool *lfce = s.lfce;
+		modflags<modified> mod = {s.mod};
+		integersize *w5 = s.w5;
+		integersize *w3 = s.w3;
+		integersize **wca = s.wca;
+		integersize **wcol = s.wcol;
+		int &vmin = *s.vmin;
+		int number = s.number;
+		int band = s.band;
+		int limit = s.limit;
+		int maxinter = s.maxinter;
+		int maxll = s.maxll;
+		int d = j-i;
+		integersize *loopE = (intermolecular&&ct->intermolecular) ? NULL : s.loopE[(j>number) ? i+j-number : i+j];
+
+	register int rarray;
+	int dp,ll,jpf,jf,bl,maxasym;
+	int before,after;
+	int e[6];
+	int k,p;
+	int ip,jp,ii,jj,di;
+	int candidates=0;//internal loop candidates visited for i,j, for the profile
+	register int inc[6][6]={{0,0,0,0,0,0},{0,0,0,0,1,0},{0,0,0,1,0,0},{0,0,1,0,1,0},
+		{0,1,0,1,0,0},{0,0,0,0,0,0}};
+#ifndef disablecoax
+	register int castack; //variable for coaxial stacking, not needed if coaxial stacking is disabled
+#endif
 
-#elif !defined INSTRUMENTED//If pre-compiler flag INSTRUMENTED is not defined, compile the following code
-	void fill(structure *ct, arrayclass &v, arrayclass &v1, arrayclass &v2, arrayclass &w, arrayclass &wmb, forceclass &fce, int &vmin,bool *lfce, bool *mod,
-			integersize *w5, integersize *w3, bool quickenergy,
-			datatable *data, arrayclass *w2, arrayclass *wmb2, TProgressDialog* update, int maxinter,bool quickstructure)
 
-#else //IF DEFINED INSTRUMENTED
-		void fill(structure *ct, arrayclass &v, arrayclass &v1, arrayclass &v2, arrayclass &vmb, arrayclass &vext, arrayclass &w, arrayclass &wmb, forceclass &fce, int &vmin,bool *lfce, bool *mod,
-				integersize *w5, integersize *w3, bool quickenergy,
-				datatable *data, arrayclass *w2, arrayclass *wmb2, TProgressDialog* update, int maxinter,bool quickstructure)
+	maxasym = maxinter;
 
-#endif //end !INTRUMENTED
-		{
-			//This is the fill routine:
-			register int number, h, maximum;
-			int d, maxj;
-			integersize **wca,**curE,**prevE,**tempE;
+	//beyond the band only w5 and w3 are needed, and within it pairs must be closer than the limit
+	if (d>band) {
+		if (i!=1&&j!=number) return;
+		goto sub3;
+	}
+	if (d>=limit) goto sub2;
+
+	if ((templated&&ct->templated)) {
+		if (i>ct->GetSequenceLength()) ii = i - ct->GetSequenceLength();
+		else ii = i;
+		if (j>ct->GetSequenceLength()) jj = j - ct->GetSequenceLength();
+		else jj = j;
+		if (jj<ii) {
+			p = jj;
+			jj = ii;
+			ii = p;
+		}
+		if (!ct->tem[jj][ii]) goto sub2;
+	}
 
+	//Compute v[i][j], the minimum energy of the substructure from i to j,
+	//inclusive, where i and j are base paired
+	if (fce.f(i,j)&SINGLE) {
+		//i or j is forced single-stranded
+		v.f(i,j) = INFINITE_ENERGY + 50;
+		v1.f(i,j) = INFINITE_ENERGY + 50;
+		v2.f(i,j) = INFINITE_ENERGY + 50;
+		goto sub2;
+	}
+	if (fce.f(i,j)&NOPAIR) {
+		//i or j is forced into a pair elsewhere
+		v.f(i,j)= INFINITE_ENERGY+50;
+		v1.f(i,j) = INFINITE_ENERGY + 50;
+		v2.f(i,j) = INFINITE_ENERGY + 50;
+		goto sub2;
+	}
 
-			number = ct->GetSequenceLength();
+	if (j<=(number)) {
+		if ((j-i)<=minloop) goto sub3;
 
-			if (!ct->intermolecular) {
-				//This code is needed for O(N^3) prediction of internal loops
-				wca = new integersize *[number+1];
-				curE= new integersize *[number+1];
-				prevE= new integersize *[number+1];
-
-				for (int locali=0;locali<=number;locali++) {
-					wca[locali] = new integersize [number+1];
-					curE[locali]= new integersize [number+1];
-					prevE[locali]= new integersize [number+1];
-					for (int localj=0;localj<=number;localj++){
-						wca[locali][localj] = INFINITE_ENERGY;
-						curE[locali][localj]=INFINITE_ENERGY;
-						prevE[locali][localj]=INFINITE_ENERGY;
-					}
-				}
+	}
+	v.f(i,j) = INFINITE_ENERGY;
+	v1.f(i,j) = INFINITE_ENERGY;
+	v2.f(i,j) = INFINITE_ENERGY;
+
+	if (inc[ct->numseq[i]][ct->numseq[j]]==0) goto sub2;
+
+	//force u's into gu pairs
+	for (ip=0;ip<ct->GetNumberofGU();ip++) {
+		if (ct->GetGUpair(ip)==i) {
+			if (ct->numseq[j]!=3) {
+				v.f(i,j) = INFINITE_ENERGY;
+				v1.f(i,j) = INFINITE_ENERGY;
+				v2.f(i,j) = INFINITE_ENERGY;
+				goto sub2;
 			}
-			else {//intermolecular folding
-				//initialize wca only
-				wca = new integersize *[number+1];
-				for (int locali=0;locali<=number;locali++) {
-					wca[locali] = new integersize [number+1];
-
-					for (int localj=0;localj<=number;localj++)	{
-						wca[locali][localj] = INFINITE_ENERGY;
-					}
-				}
+		}
+		//else if ((ct->gu[ip]+number)==i) {
+		// 	if (ct->numseq[j]!=3) {
+		//   	v.f(i,j) = INFINITE_ENERGY;
+		//      goto sub2;
+		//   }
+		//}
+		else if (ct->GetGUpair(ip)==j) {
+			if (ct->numseq[i]!=3) {
+				v.f(i,j) = INFINITE_ENERGY;
+				v1.f(i,j) = INFINITE_ENERGY;
+				v2.f(i,j) = INFINITE_ENERGY;
+				goto sub2;
+			}
+		}
+		else if ((ct->GetGUpair(ip)+number)==j) {
+			if (ct->numseq[i]!=3) {
+				v.f(i,j) = INFINITE_ENERGY;
+				v1.f(i,j) = INFINITE_ENERGY;
+				v2.f(i,j) = INFINITE_ENERGY;
+				goto sub2;
 			}
+		}
 
-			if (quickenergy||quickstructure) maximum = number;
-			else maximum = (2*(number)-1);
+	}
 
 
-			vmin=INFINITE_ENERGY;
-			//h or (h-number+1) is the distance between i and j
-			for (h=0;h<=maximum-1;h++){
-
-				//d = j-i;
-				d=(h<=(number-1))?h:(h-number+1);
-				if (((h%10)==0)&&update) update->update((100*h)/(maximum+1));
-				if (h==number&&!ct->intermolecular) {
-					for(int locali=0;locali<=number;locali++) {
-						for(int localj=0;localj<=number;localj++) {
-							curE[locali][localj]=INFINITE_ENERGY;
-							prevE[locali][localj]=INFINITE_ENERGY;
-						}
-					}
-				}
-				
+	//now check to make sure that this isn't an isolated pair:
+	//	(consider a pair separated by a bulge as not! stacked)
 
-				//These variables for start and end (as opposed the fancy syntax that was here before) are needed because of openmp.
-				int startme,endme;//start and end for loop over i
-				if (h<=(number-1)) {
-					startme=1;
-					endme=number-h;
-				}
-				else {
-					startme=2*number-h;
-					endme=number;
+	//before = 0 if a stacked pair cannot form 5' to i
+	before =0;
+	if ((i>1&&j<(2*number)&&j!=number)) {
+		if ((j>number&&((i-j+number)>minloop+2))||j<number) {
+			before = inc[ct->numseq[i-1]][ct->numseq[j+1]];
+		}
+	}
 
-				}
-#ifdef SMP
-#pragma omp parallel for
-#endif
-				
-				
+	//after = 0 if a stacked pair cannot form 3' to i
+	if ((((j-i)>minloop+2)&&(j<=number)||(j>number+1))&&(i!=number)) {
+		after = inc[ct->numseq[i+1]][ct->numseq[j-1]];
 
-				for (int i=startme;i<=endme;i++){
-					int j=i+d;
-					register int rarray;
-					int dp,ll,jpf,jf,bl,maxasym;
-					int before,after;
-					int e[6];
-					int k,p;
-					int ip,jp,ii,jj,di;
-					register int inc[6][6]={{0,0,0,0,0,0},{0,0,0,0,1,0},{0,0,0,1,0,0},{0,0,1,0,1,0},
-						{0,1,0,1,0,0},{0,0,0,0,0,0}};
-#ifndef disablecoax
-					register int castack; //variable for coaxial stacking, not needed if coaxial stacking is disabled
-#endif
-					int maxi=((h<=(number-1))?(number-h):number);
-					if (i==maxi)
-						maxj=j;
-
-
-					maxasym = maxinter;
-
-					if (ct->templated) {
-						if (i>ct->GetSequenceLength()) ii = i - ct->GetSequenceLength();
-						else ii = i;
-						if (j>ct->GetSequenceLength()) jj = j - ct->GetSequenceLength();
-						else jj = j;
-						if (jj<ii) {
-							p = jj;
-							jj = ii;
-							ii = p;
-						}
-						if (!ct->tem[jj][ii]) goto sub2;
-					}
+	}
+	else after = 0;
 
-					//Compute v[i][j], the minimum energy of the substructure from i to j,
-					//inclusive, where i and j are base paired
-					if (fce.f(i,j)&SINGLE) {
-						//i or j is forced single-stranded
-						v.f(i,j) = INFINITE_ENERGY + 50;
-						v1.f(i,j) = INFINITE_ENERGY + 50;
-						v2.f(i,j) = INFINITE_ENERGY + 50;
-						goto sub2;
-					}
-					if (fce.f(i,j)&NOPAIR) {
-						//i or j is forced into a pair elsewhere
-						v.f(i,j)= INFINITE_ENERGY+50;
-						v1.f(i,j) = INFINITE_ENERGY + 50;
-						v2.f(i,j) = INFINITE_ENERGY + 50;
-						goto sub2;
-					}
+	//if there are no stackable pairs to i.j then don't allow a pair i,j
+	if ((before==0)&&(after==0)) {
+		//v.f(i,j)= 0;
+		goto sub2;
+	}
+	rarray = INFINITE_ENERGY;
+	if (i==(number)||j==((number)+1)) goto sub1;
 
-					if (j<=(number)) {
-						if ((j-i)<=minloop) goto sub3;
 
-					}
-					v.f(i,j) = INFINITE_ENERGY;
-					v1.f(i,j) = INFINITE_ENERGY;
-					v2.f(i,j) = INFINITE_ENERGY;
-
-					if (inc[ct->numseq[i]][ct->numseq[j]]==0) goto sub2;
-
-					//force u's into gu pairs
-					for (ip=0;ip<ct->GetNumberofGU();ip++) {
-						if (ct->GetGUpair(ip)==i) {
-							if (ct->numseq[j]!=3) {
-								v.f(i,j) = INFINITE_ENERGY;
-								v1.f(i,j) = INFINITE_ENERGY;
-								v2.f(i,j) = INFINITE_ENERGY;
-								goto sub2;
-							}
-						}
-						//else if ((ct->gu[ip]+number)==i) {
-						// 	if (ct->numseq[j]!=3) {
-						//   	v.f(i,j) = INFINITE_ENERGY;
-						//      goto sub2;
-						//   }
-						//}
-						else if (ct->GetGUpair(ip)==j) {
-							if (ct->numseq[i]!=3) {
-								v.f(i,j) = INFINITE_ENERGY;
-								v1.f(i,j) = INFINITE_ENERGY;
-								v2.f(i,j) = INFINITE_ENERGY;
-								goto sub2;
-							}
-						}
-						else if ((ct->GetGUpair(ip)+number)==j) {
-							if (ct->numseq[i]!=3) {
-								v.f(i,j) = INFINITE_ENERGY;
-								v1.f(i,j) = INFINITE_ENERGY;
-								v2.f(i,j) = INFINITE_ENERGY;
-								goto sub2;
-							}
-						}
+	//Perhaps i and j close a hairpin:
+	rarray=min(rarray,erg3<shaped>(i,j,ct,data,fce.f(i,j)));
 
-					}
+	if ((j-i-1)>=(minloop+2)||j>(number)) {
+		//Perhaps i,j stacks over i+1,j-1
+		//FD
+		if (!mod[i]&&!mod[j]) { //make sure this is not a site of chemical modification
+			//rarray=min(rarray,(erg1<bonus>(i,j,i+1,j-1,ct,data)+v.f(i+1,j-1)));
+			integersize ea = v1.f(i+1, j-1) + erg1<bonus>(i,j,i+1,j-1,ct,data);
+			integersize eb = v2.f(i+1, j-1) + erg1<bonus>(i,j,i+1,j-1,ct,data) + SHAPEdiff<shaped>(ct,i+1) + SHAPEdiff<shaped>(ct,j-1);
+			v2.f(i,j) = min(ea, eb);
+			//cout<<SHAPEdiff<shaped>(ct,i+1)<<" "<<SHAPEdiff<shaped>(ct,i+1)<<endl;
+		}
+		else {
+			//allow G-U to be modified or a pair next to a G-U to be modified
+			if ((ct->numseq[i]==3&&ct->numseq[j]==4)||(ct->numseq[i]==4&&ct->numseq[j]==3)) {
+				//rarray=min(rarray,(erg1<bonus>(i,j,i+1,j-1,ct,data)+v.f(i+1,j-1)));	
+				//FD
+				integersize ea = v1.f(i+1, j-1) + erg1<bonus>(i,j,i+1,j-1,ct,data);
+				integersize eb = v2.f(i+1, j-1) + erg1<bonus>(i,j,i+1,j-1,ct,data) + SHAPEdiff<shaped>(ct,i+1) + SHAPEdiff<shaped>(ct,j-1);
+				v2.f(i,j) = min(ea, eb);
+			}
+			else if ((ct->numseq[i+1]==3&&ct->numseq[j-1]==4)||(ct->numseq[i+1]==4&&ct->numseq[j-1]==3)) {
 
+				//rarray=min(rarray,(erg1<bonus>(i,j,i+1,j-1,ct,data)+v.f(i+1,j-1)));
+				//FD
+				integersize ea = v1.f(i+1, j-1) + erg1<bonus>(i,j,i+1,j-1,ct,data);
+				integersize eb = v2.f(i+1, j-1) + erg1<bonus>(i,j,i+1,j-1,ct,data) + SHAPEdiff<shaped>(ct,i+1) + SHAPEdiff<shaped>(ct,j-1);
+				v2.f(i,j) = min(ea, eb);
+			}
+			else if (i-1>0&&j+1<2*number) {
+				if ((ct->numseq[i-1]==3&&ct->numseq[j+1]==4)||(ct->numseq[i-1]==4&&ct->numseq[j+1]==3)) {
+
+					//rarray=min(rarray,(erg1<bonus>(i,j,i+1,j-1,ct,data)+v.f(i+1,j-1)));
+					//FD
+					integersize ea = v1.f(i+1, j-1) + erg1<bonus>(i,j,i+1,j-1,ct,data);
+					integersize eb = v2.f(i+1, j-1) + erg1<bonus>(i,j,i+1,j-1,ct,data) + SHAPEdiff<shaped>(ct,i+1) + SHAPEdiff<shaped>(ct,j-1);
+					v2.f(i,j) = min(ea, eb);
+				}
+			}
+		}
+	}
 
-					//now check to make sure that this isn't an isolated pair:
-					//	(consider a pair separated by a bulge as not! stacked)
+	//Perhaps i,j closes an interior or bulge loop, search for the best
+	//possibility
+
+	//If this is intermolecular folding, revert to the old O(N^4) algorithm
+	//Single-stranded SHAPE pseudoenergies and offsets are carried by the O(N^3) algorithm (see SHAPEssInnerPair)
+	//The O(N^3) algorithm is also used with openMP: loopE is only touched by the thread that
+	//computes i,j, after i+1,j-1 is done.
+	if ((intermolecular&&ct->intermolecular)) {
+		//cout<<"Running into the first internal loop algorithm."<<endl;
+		if (((j-i-1)>=(minloop+3))||(j>(number))) {
+			for (di=(j-i-3);di>=1;di--) {
+				for (ip=(i+1);ip<=(j-1-di);ip++) {
+					jp = di+ip;
+					if ((j-i-2-di)>(data->eparam[7])) goto sub1;
+					if (abs(ip-i+j-jp)<=(maxinter)) {
+						candidates++;
+						if (ip>(number)) {
+							//if (jp<=number) {
+
+							//	v.f(i,j)=min(v.f(i,j),(erg2<shaped>(i,j,ip,jp,ct,data,fce[i][ip-number],
+							//		fce[jp][j])+
+							//		v.f(ip-(number),jp)));
 
-					//before = 0 if a stacked pair cannot form 5' to i
-					before =0;
-					if ((i>1&&j<(2*number)&&j!=number)) {
-						if ((j>number&&((i-j+number)>minloop+2))||j<number) {
-							before = inc[ct->numseq[i-1]][ct->numseq[j+1]];
-						}
-					}
+							//}
+							//else {
+							rarray=min(rarray,(erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip-number),
+											fce.f(jp-number,j-number))+
+										v.f(ip-(number),jp-(number))));
 
-					//after = 0 if a stacked pair cannot form 3' to i
-					if ((((j-i)>minloop+2)&&(j<=number)||(j>number+1))&&(i!=number)) {
-						after = inc[ct->numseq[i+1]][ct->numseq[j-1]];
+							if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]) {
+								//ip or jp is modified
 
-					}
-					else after = 0;
+								rarray=min(rarray,erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip-number),
+											fce.f(jp-number,j-number))+
+										v.f(ip-(number)+1,jp-(number)-1)+
+										erg1<bonus>(ip-number,jp-number,ip+1-number,jp-1-number,ct,data));
 
-					//if there are no stackable pairs to i.j then don't allow a pair i,j
-					if ((before==0)&&(after==0)) {
-						//v.f(i,j)= 0;
-						goto sub2;
-					}
-					rarray = INFINITE_ENERGY;
-					if (i==(number)||j==((number)+1)) goto sub1;
-
-
-					//Perhaps i and j close a hairpin:
-					rarray=min(rarray,erg3(i,j,ct,data,fce.f(i,j)));
-
-					if ((j-i-1)>=(minloop+2)||j>(number)) {
-						//Perhaps i,j stacks over i+1,j-1
-						//FD
-						if (!mod[i]&&!mod[j]) { //make sure this is not a site of chemical modification
-							//rarray=min(rarray,(erg1(i,j,i+1,j-1,ct,data)+v.f(i+1,j-1)));
-							integersize ea = v1.f(i+1, j-1) + erg1(i,j,i+1,j-1,ct,data);
-							integersize eb = v2.f(i+1, j-1) + erg1(i,j,i+1,j-1,ct,data) + ct->SHAPEdiff_give_value(i+1) + ct->SHAPEdiff_give_value(j-1);
-							v2.f(i,j) = min(ea, eb);
-							//cout<<ct->SHAPEdiff_give_value(i+1)<<" "<<ct->SHAPEdiff_give_value(i+1)<<endl;
+							}
+							//}
 						}
 						else {
-							//allow G-U to be modified or a pair next to a G-U to be modified
-							if ((ct->numseq[i]==3&&ct->numseq[j]==4)||(ct->numseq[i]==4&&ct->numseq[j]==3)) {
-								//rarray=min(rarray,(erg1(i,j,i+1,j-1,ct,data)+v.f(i+1,j-1)));	
-								//FD
-								integersize ea = v1.f(i+1, j-1) + erg1(i,j,i+1,j-1,ct,data);
-								integersize eb = v2.f(i+1, j-1) + erg1(i,j,i+1,j-1,ct,data) + ct->SHAPEdiff_give_value(i+1) + ct->SHAPEdiff_give_value(j-1);
-								v2.f(i,j) = min(ea, eb);
-							}
-							else if ((ct->numseq[i+1]==3&&ct->numseq[j-1]==4)||(ct->numseq[i+1]==4&&ct->numseq[j-1]==3)) {
+							if (jp<=number) {
 
-								//rarray=min(rarray,(erg1(i,j,i+1,j-1,ct,data)+v.f(i+1,j-1)));
-								//FD
-								integersize ea = v1.f(i+1, j-1) + erg1(i,j,i+1,j-1,ct,data);
-								integersize eb = v2.f(i+1, j-1) + erg1(i,j,i+1,j-1,ct,data) + ct->SHAPEdiff_give_value(i+1) + ct->SHAPEdiff_give_value(j-1);
-								v2.f(i,j) = min(ea, eb);
-							}
-							else if (i-1>0&&j+1<2*number) {
-								if ((ct->numseq[i-1]==3&&ct->numseq[j+1]==4)||(ct->numseq[i-1]==4&&ct->numseq[j+1]==3)) {
-
-									//rarray=min(rarray,(erg1(i,j,i+1,j-1,ct,data)+v.f(i+1,j-1)));
-									//FD
-									integersize ea = v1.f(i+1, j-1) + erg1(i,j,i+1,j-1,ct,data);
-									integersize eb = v2.f(i+1, j-1) + erg1(i,j,i+1,j-1,ct,data) + ct->SHAPEdiff_give_value(i+1) + ct->SHAPEdiff_give_value(j-1);
-									v2.f(i,j) = min(ea, eb);
-								}
-							}
-						}
-					}
 
-					//Perhaps i,j closes an interior or bulge loop, search for the best
-					//possibility
 
-					//If this is intermolecular folding, or if running in parallel with openMP, revert to the old O(N^4) algorithm
-					//For now, also use O(N^4) internal loops for applying SHAPE to single-stranded regions
-#ifndef SMP
-					ct->SHAPEintercept_ss = 1; //FD, always use the O(N^4) version
-					if (ct->intermolecular||(ct->shaped&&(ct->SHAPEintercept_ss!=0||ct->SHAPEslope_ss!=0))||ct->ssoffset) {
-						//cout<<"Running into the first internal loop algorithm."<<endl;
-#endif
-						if (((j-i-1)>=(minloop+3))||(j>(number))) {
-							for (di=(j-i-3);di>=1;di--) {
-								for (ip=(i+1);ip<=(j-1-di);ip++) {
-									jp = di+ip;
-									if ((j-i-2-di)>(data->eparam[7])) goto sub1;
-									if (abs(ip-i+j-jp)<=(maxinter)) {
-										if (ip>(number)) {
-											//if (jp<=number) {
-
-											//	v.f(i,j)=min(v.f(i,j),(erg2(i,j,ip,jp,ct,data,fce[i][ip-number],
-											//		fce[jp][j])+
-											//		v.f(ip-(number),jp)));
-
-											//}
-											//else {
-											rarray=min(rarray,(erg2(i,j,ip,jp,ct,data,fce.f(i,ip-number),
-															fce.f(jp-number,j-number))+
-														v.f(ip-(number),jp-(number))));
-
-											if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]) {
-												//ip or jp is modified
-
-												rarray=min(rarray,erg2(i,j,ip,jp,ct,data,fce.f(i,ip-number),
-															fce.f(jp-number,j-number))+
-														v.f(ip-(number)+1,jp-(number)-1)+
-														erg1(ip-number,jp-number,ip+1-number,jp-1-number,ct,data));
-
-											}
-											//}
-										}
-										else {
-											if (jp<=number) {
 
+								rarray=min(rarray,(erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip),
+												fce.f(jp,j))+
+											v.f(ip,jp)));
+																							
+								if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]) {
+									//i or j is modified
+									rarray=min(rarray,(erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip),
+													fce.f(jp,j))+
+												v.f(ip+1,jp-1)+erg1<bonus>(ip,jp,ip+1,jp-1,ct,data)));
 
+								}
 
 
-												rarray=min(rarray,(erg2(i,j,ip,jp,ct,data,fce.f(i,ip),
-																fce.f(jp,j))+
-															v.f(ip,jp)));
-																											
-												if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]) {
-													//i or j is modified
-													rarray=min(rarray,(erg2(i,j,ip,jp,ct,data,fce.f(i,ip),
-																	fce.f(jp,j))+
-																v.f(ip+1,jp-1)+erg1(ip,jp,ip+1,jp-1,ct,data)));
 
-												}
 
+							}
+							else {
 
 
+								rarray=min(rarray,(erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp-number,j-number))+
+											v.f(ip,jp)));
 
-											}
-											else {
 
+								if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]) {
+									//i or j is modified
+									rarray=min(rarray,(erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp-number,j-number))+
+												v.f(ip+1,jp-1)+erg1<bonus>(ip,jp,ip+1,jp-1,ct,data)));
 
-												rarray=min(rarray,(erg2(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp-number,j-number))+
-															v.f(ip,jp)));
+								}
 
+							}
 
-												if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]) {
-													//i or j is modified
-													rarray=min(rarray,(erg2(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp-number,j-number))+
-																v.f(ip+1,jp-1)+erg1(ip,jp,ip+1,jp-1,ct,data)));
 
-												}
 
-											}
 
+						}
+					}
 
 
 
-										}
-									}
+				}
+			}
+		}
+	}
+	/* Perhaps i,j closes an interior or bulge loop, search for the best possibility
+	   fill the interior loops' energy rarray first
+	   calculate the small loop (size<=5) first
+	   the larger loop is prefilled with loopE[dp] (after sub2)
 
+	   d= j-i, dp= jp-ip (interior loop)
+	   i<ip<number<jp<j or i<ip<jp<j<number
+	 */
 
+	//Below is the O(N^3) algorithm
+	else {
+		
+		if ((d-1)>=(minloop+3)||j>number) 
+			for (dp=d-3;dp>=((j>number)?1:minloop+1);dp--) {
+				ll=d-dp-2;//ll is the loop length in terms of number of unpaired nucs
 
-								}
-							}
-						}
-#ifndef SMP
-					}
-					/* Perhaps i,j closes an interior or bulge loop, search for the best possibility
-					   fill the interior loops' energy rarray first
-					   calculate the small loop (size<=5) first
-					   the larger loop is prefilled with curE[dp][i] (after sub2)
+				//calculate every ip,jp when ll <=5: this includes loops with special rules:
+				//0x1,0x2,0x3,0x4,0x5,1x1,1x2,1x3,1x4,2x2,2x3
+				if(ll>=1&&ll<=5)
+				{
 
-					   d= j-i, dp= jp-ip (interior loop)
-					   i<ip<number<jp<j or i<ip<jp<j<number
-					 */
+					for (ip=i+1;ip<=j-1-dp;ip++)
+					{
+						jp=ip+dp;
+						if (inc[ct->numseq[ip]][ct->numseq[jp]])
+							if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
+							{
+								candidates++;
+								//using jpf and jf and  instead of jp and j when j,jp>number
+								jpf=( (jp<=number)?jp:jp-number);
+								jf=((j<=number)?j:j-number);
+								rarray=min(rarray,(erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip),
+												fce.f(jpf,jf))+v.f(ip,jp)));
+								//i or j is modified
+								if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
+									rarray=min(rarray,(erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jpf,jf))+
+												v.f(ip+1,jp-1)+erg1<bonus>(ip,jp,ip+1,jp-1,ct,data)));
 
-					//Below is the O(N^3) algorithm
-					else {
-						
-						if ((d-1)>=(minloop+3)||j>number) 
-							for (dp=d-3;dp>=((j>number)?1:minloop+1);dp--) {
-								ll=d-dp-2;//ll is the loop length in terms of number of unpaired nucs
+							}
 
-								//calculate every ip,jp when ll <=5: this includes loops with special rules:
-								//0x1,0x2,0x3,0x4,0x5,1x1,1x2,1x3,1x4,2x2,2x3
-								if(ll>=1&&ll<=5)
+					}
+				}
+				//when size >=6 and <=30;
+				//	else if (ll>=6&&ll<=(data->eparam[7]))
+				else if (ll>=6&&ll<=maxll)
+				{
+
+					//interior energy prefilled (after sub2:) + exterior engergy (the function for erg2in and erg2ex is found in rna_library_inter.cpp
+					//The interior energy, loopE, is the lowest free energy for a interior fragment with a pair closing dp nucs
+					//the interior fragment and asymetry contriubutions are included
+					rarray=min(rarray,(loopE[dp]+erg2ex(i,j,ll,ct,data)+SHAPEssOuterPair<shaped>(ct,i,j)));
+					candidates++;
+
+					//considering loop 1x(n-1) (bl=1)and 0 x n(bulge)(bl=0) as stacking bonus on 1x(n-1) and bulge is not allowed
+					for (bl=0;bl<=1;bl++)
+					{
+						ip=i+1+bl;
+						jp=ip+dp;
+						jpf=( (jp<=number)?jp:jp-number);
+						jf=((j<=number)?j:j-number);
+						if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
+							if (inc[ct->numseq[ip]][ct->numseq[jp]])
+								if (abs(ip-i+jp-j)<=maxasym) 
 								{
+									candidates++;
+									rarray = min(rarray, (erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jpf,jf))+v.f(ip,jp)));
+									//i or j is modified
+									if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
+										rarray=min(rarray,(erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jpf,jf))+
+													v.f(ip+1,jp-1)+erg1<bonus>(ip,jp,ip+1,jp-1,ct,data)));
 
-									for (ip=i+1;ip<=j-1-dp;ip++)
-									{
-										jp=ip+dp;
-										if (inc[ct->numseq[ip]][ct->numseq[jp]])
-											if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
-											{
-												//using jpf and jf and  instead of jp and j when j,jp>number
-												jpf=( (jp<=number)?jp:jp-number);
-												jf=((j<=number)?j:j-number);
-												rarray=min(rarray,(erg2(i,j,ip,jp,ct,data,fce.f(i,ip),
-																fce.f(jpf,jf))+v.f(ip,jp)));
-												//i or j is modified
-												if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
-													rarray=min(rarray,(erg2(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jpf,jf))+
-																v.f(ip+1,jp-1)+erg1(ip,jp,ip+1,jp-1,ct,data)));
-
-											}
-
-									}
 								}
-								//when size >=6 and <=30;
-								//	else if (ll>=6&&ll<=(data->eparam[7]))
-								else if (ll>=6&&ll<=maxinter)
+
+						jp=j-1-bl;
+						ip=jp-dp;
+						jpf=( (jp<=number)?jp:jp-number);
+						jf=((j<=number)?j:j-number);
+						if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
+							if (inc[ct->numseq[ip]][ct->numseq[jp]])
+								if (abs(ip-i+jp-j)<=maxasym)
 								{
+									candidates++;
+									rarray = min(rarray, (erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jpf,jf))+v.f(ip,jp)));
+									if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
+										rarray=min(rarray,(erg2<shaped>(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jpf,jf))+
+													v.f(ip+1,jp-1)+erg1<bonus>(ip,jp,ip+1,jp-1,ct,data)));
 
-									//interior energy prefilled (after sub2:) + exterior engergy (the function for erg2in and erg2ex is found in rna_library_inter.cpp
-									//The interior energy, curE, is the lowest free energy for a interior fragment with a pair closing dp nucs
-									//the interior fragment and asymetry contriubutions are included
-									rarray=min(rarray,(curE[dp][i]+erg2ex(i,j,ll,ct,data)));
-
-									//considering loop 1x(n-1) (bl=1)and 0 x n(bulge)(bl=0) as stacking bonus on 1x(n-1) and bulge is not allowed
-									for (bl=0;bl<=1;bl++)
-									{
-										ip=i+1+bl;
-										jp=ip+dp;
-										jpf=( (jp<=number)?jp:jp-number);
-										jf=((j<=number)?j:j-number);
-										if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
-											if (inc[ct->numseq[ip]][ct->numseq[jp]])
-												if (abs(ip-i+jp-j)<=maxasym) 
-												{
-													rarray = min(rarray, (erg2(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jpf,jf))+v.f(ip,jp)));
-													//i or j is modified
-													if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
-														rarray=min(rarray,(erg2(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jpf,jf))+
-																	v.f(ip+1,jp-1)+erg1(ip,jp,ip+1,jp-1,ct,data)));
-
-												}
-
-										jp=j-1-bl;
-										ip=jp-dp;
-										jpf=( (jp<=number)?jp:jp-number);
-										jf=((j<=number)?j:j-number);
-										if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
-											if (inc[ct->numseq[ip]][ct->numseq[jp]])
-												if (abs(ip-i+jp-j)<=maxasym)
-												{
-													rarray = min(rarray, (erg2(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jpf,jf))+v.f(ip,jp)));
-													if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
-														rarray=min(rarray,(erg2(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jpf,jf))+
-																	v.f(ip+1,jp-1)+erg1(ip,jp,ip+1,jp-1,ct,data)));
-
-												} 
-									}
+								} 
+					}
 
-								}
-							}	  
+				}
+			}	  
 
-					}
-#endif
+	}
 
 
-					//Perhaps i,j closes a multibranch or exterior loop, search for the best possibility
+	//Perhaps i,j closes a multibranch or exterior loop, search for the best possibility
 
 
 
@@ -3865,831 +3929,840 @@ sub1:
 #ifndef INSTRUMENTED//
 
 #else//If INSTRUMENTED IS DEFINED
-					v.f(i,j) = rarray;
-					rarray = INFINITE_ENERGY;
+	v.f(i,j) = rarray;
+	rarray = INFINITE_ENERGY;
 #endif//END INSTRUMENTED
 
 
-					if (((j-i-1)>=(2*minloop+4))||(j>(number))) {
-						for (ii=1;ii<=4;ii++) e[ii]=INFINITE_ENERGY;
+	if (((j-i-1)>=(2*minloop+4))||(j>(number))) {
+		for (ii=1;ii<=4;ii++) e[ii]=INFINITE_ENERGY;
 
 
 
 
-						//consider the exterior loop closed by i,j
-						if (j>number) {
-							rarray = min(rarray,w3[i+1] + w5[j-number-1] + penalty(i,j,ct,data));
+		//consider the exterior loop closed by i,j
+		if (j>number) {
+			rarray = min(rarray,w3[i+1] + w5[j-number-1] + penalty(i,j,ct,data));
 
 
-							if (i!=number) rarray = min(rarray,erg4(i,j,i+1,1,ct,data,lfce[i+1]) + penalty(i,j,ct,data)+w3[i+2] + w5[j-number-1] );
-							if (j!=(number+1)) rarray = min(rarray,erg4(i,j,j-1,2,ct,data,lfce[j-1]) +penalty(i,j,ct,data)+ w3[i+1] + w5[j-number-2] );
-							if ((i!=number)&&(j!=(number+1))) {
-								rarray = min(rarray,data->tstack[ct->numseq[i]][ct->numseq[j]][ct->numseq[i+1]][ct->numseq[j-1]] 
-										+checknp(lfce[i+1],lfce[j-1]) + w3[i+2] + w5[j-number-2]
-										+penalty(i,j,ct,data)+ ct->SHAPEss_give_value(i+1)+ ct->SHAPEss_give_value(j-1));
-
-							}
+			if (i!=number) rarray = min(rarray,erg4(i,j,i+1,1,ct,data,lfce[i+1]) + penalty(i,j,ct,data)+w3[i+2] + w5[j-number-1] );
+			if (j!=(number+1)) rarray = min(rarray,erg4(i,j,j-1,2,ct,data,lfce[j-1]) +penalty(i,j,ct,data)+ w3[i+1] + w5[j-number-2] );
+			if ((i!=number)&&(j!=(number+1))) {
+				rarray = min(rarray,data->tstack[ct->numseq[i]][ct->numseq[j]][ct->numseq[i+1]][ct->numseq[j-1]] 
+						+checknp(lfce[i+1],lfce[j-1]) + w3[i+2] + w5[j-number-2]
+						+penalty(i,j,ct,data)+ SHAPEss<shaped>(ct,i+1)+ SHAPEss<shaped>(ct,j-1));
 
+			}
 
-							//consider the coaxial stacking of a helix from i to ip onto helix ip+1 or ip+2 to j:
 
-							//first consider a helix stacking from the 5' sequence fragment:
+			//consider the coaxial stacking of a helix from i to ip onto helix ip+1 or ip+2 to j:
 #ifndef disablecoax
-							for (ip=j-number-minloop-1;ip>0;ip--) {
-								//first consider flush stacking
-								rarray = min(rarray,
-										w3[i+1]+w5[ip-1]+penalty(i,j,ct,data)+penalty(j-number-1,ip,ct,data)+
-										ergcoaxflushbases(ip,j-number-1,j-number,i,ct,data)+v.f(ip,j-number-1));
-
-								if ((mod[ip]||mod[j-number-1])&&j-number-2>0&&!(fce.f(ip,j-number-1)&SINGLE)) {
-									if (inc[ct->numseq[ip+1]][ct->numseq[j-number-2]]) {
-										rarray = min(rarray,
-												w3[i+1]+w5[ip-1]+penalty(i,j,ct,data)+penalty(j-number-1,ip,ct,data)+
-												ergcoaxflushbases(ip,j-number-1,j-number,i,ct,data)+v.f(ip+1,j-number-2)+
-												erg1(ip,j-number-1,ip+1,j-number-2,ct,data));
-									}
-
-								}
+			//when pruning, a side is only searched if its best helix could keep the pair within critbound
+			bool stack5 = true,stack3 = true;
+			if (s.prune) {
+				integersize outside = v.f(j-number,i)+penalty(i,j,ct,data)+s.coaxbound-s.pairslack;
+				stack5 = outside+min(w3[i+1]+min(s.helix5[j-number-1],s.helix5gap[j-number-2]),
+					(i<number)?w3[i+2]+s.helix5[j-number-2]:INFINITE_ENERGY)<=s.critbound;
+				stack3 = outside+min(w5[j-number-1]+min(s.helix3[i+1],s.helix3gap[i+2]),
+					(j-number>1)?w5[j-number-2]+s.helix3[i+2]:INFINITE_ENERGY)<=s.critbound;
+			}
 
+			//first consider a helix stacking from the 5' sequence fragment:
+			if (stack5) for (ip=j-number-minloop-1;ip>0;ip--) {
+				//first consider flush stacking
+				rarray = min(rarray,
+						w3[i+1]+w5[ip-1]+penalty(i,j,ct,data)+penalty(j-number-1,ip,ct,data)+
+						ergcoaxflushbases(ip,j-number-1,j-number,i,ct,data)+v.f(ip,j-number-1));
+
+				if ((mod[ip]||mod[j-number-1])&&j-number-2>0&&!(fce.f(ip,j-number-1)&SINGLE)) {
+					if (inc[ct->numseq[ip+1]][ct->numseq[j-number-2]]) {
+						rarray = min(rarray,
+								w3[i+1]+w5[ip-1]+penalty(i,j,ct,data)+penalty(j-number-1,ip,ct,data)+
+								ergcoaxflushbases(ip,j-number-1,j-number,i,ct,data)+v.f(ip+1,j-number-2)+
+								erg1<bonus>(ip,j-number-1,ip+1,j-number-2,ct,data));
+					}
 
-								if (j-number-2>0) {
-									//now consider an intervening nuc
-									if(i<number) {
-										rarray = min(rarray,
-												w3[i+2]+w5[ip-1]+penalty(i,j,ct,data)+penalty(ip,j-number-2,ct,data)+
-												ergcoaxinterbases2(ip,j-number-2,j-number,i,ct,data)+v.f(ip,j-number-2)+checknp(lfce[i+1],lfce[j-number-1])
-											    );
+				}
 
 
-										if ((mod[ip]||mod[j-number-2])&&inc[ct->numseq[ip+1]][ct->numseq[j-number-3]]!=0&&!(fce.f(ip,j-number-2)&SINGLE)) {
-											rarray = min(rarray,
-													w3[i+2]+w5[ip-1]+penalty(i,j,ct,data)+penalty(ip,j-number-2,ct,data)+
-													ergcoaxinterbases2(ip,j-number-2,j-number,i,ct,data)+v.f(ip+1,j-number-3)+
-													erg1(ip,j-number-2,ip+1,j-number-3,ct,data)+checknp(lfce[i+1],lfce[j-number-1])
-												    );
+				if (j-number-2>0) {
+					//now consider an intervening nuc
+					if(i<number) {
+						rarray = min(rarray,
+								w3[i+2]+w5[ip-1]+penalty(i,j,ct,data)+penalty(ip,j-number-2,ct,data)+
+								ergcoaxinterbases2(ip,j-number-2,j-number,i,ct,data)+v.f(ip,j-number-2)+checknp(lfce[i+1],lfce[j-number-1])
+							    );
 
 
-										}
-									}
+						if ((mod[ip]||mod[j-number-2])&&inc[ct->numseq[ip+1]][ct->numseq[j-number-3]]!=0&&!(fce.f(ip,j-number-2)&SINGLE)) {
+							rarray = min(rarray,
+									w3[i+2]+w5[ip-1]+penalty(i,j,ct,data)+penalty(ip,j-number-2,ct,data)+
+									ergcoaxinterbases2(ip,j-number-2,j-number,i,ct,data)+v.f(ip+1,j-number-3)+
+									erg1<bonus>(ip,j-number-2,ip+1,j-number-3,ct,data)+checknp(lfce[i+1],lfce[j-number-1])
+								    );
 
 
-									//consider the other possibility for an intervening nuc
-									rarray = min(rarray,
-											w3[i+1]+w5[ip-1]+penalty(i,j,ct,data)+penalty(ip+1,j-number-2,ct,data)+
-											ergcoaxinterbases1(ip+1,j-number-2,j-number,i,ct,data)+v.f(ip+1,j-number-2)+checknp(lfce[ip],lfce[j-number-1])
-										    );
+						}
+					}
 
 
-									if ((mod[ip+1]||mod[j-number-2])&&inc[ct->numseq[ip+2]][ct->numseq[j-number-3]]&&!(fce.f(ip+1,j-number-2)&SINGLE)) {
-										rarray = min(rarray,
-												w3[i+1]+w5[ip-1]+penalty(i,j,ct,data)+penalty(ip+1,j-number-2,ct,data)+
-												ergcoaxinterbases1(ip+1,j-number-2,j-number,i,ct,data)+v.f(ip+2,j-number-3)
-												+erg1(ip+1,j-number-2,ip+2,j-number-3,ct,data)+checknp(lfce[ip],lfce[j-number-1])
-											    );
-									}
+					//consider the other possibility for an intervening nuc
+					rarray = min(rarray,
+							w3[i+1]+w5[ip-1]+penalty(i,j,ct,data)+penalty(ip+1,j-number-2,ct,data)+
+							ergcoaxinterbases1(ip+1,j-number-2,j-number,i,ct,data)+v.f(ip+1,j-number-2)+checknp(lfce[ip],lfce[j-number-1])
+						    );
 
 
-								}
+					if ((mod[ip+1]||mod[j-number-2])&&inc[ct->numseq[ip+2]][ct->numseq[j-number-3]]&&!(fce.f(ip+1,j-number-2)&SINGLE)) {
+						rarray = min(rarray,
+								w3[i+1]+w5[ip-1]+penalty(i,j,ct,data)+penalty(ip+1,j-number-2,ct,data)+
+								ergcoaxinterbases1(ip+1,j-number-2,j-number,i,ct,data)+v.f(ip+2,j-number-3)
+								+erg1<bonus>(ip+1,j-number-2,ip+2,j-number-3,ct,data)+checknp(lfce[ip],lfce[j-number-1])
+							    );
+					}
 
 
-							}
+				}
 
-							//now consider a helix stacking from the 3' sequence fragment:
-							for (ip=i+minloop+1;ip<=number;ip++) {
-								//first consider flush stacking
-								rarray = min(rarray,
-										w3[ip+1]+w5[j-number-1]+penalty(i,j,ct,data)+penalty(ip,i+1,ct,data)+
-										ergcoaxflushbases(j-number,i,i+1,ip,ct,data)+v.f(i+1,ip));
 
+			}
 
-								if ((mod[i+1]||mod[ip])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&!(fce.f(i+1,ip)&SINGLE)) {
+			//now consider a helix stacking from the 3' sequence fragment:
+			if (stack3) for (ip=i+minloop+1;ip<=number;ip++) {
+				//first consider flush stacking
+				rarray = min(rarray,
+						w3[ip+1]+w5[j-number-1]+penalty(i,j,ct,data)+penalty(ip,i+1,ct,data)+
+						ergcoaxflushbases(j-number,i,i+1,ip,ct,data)+v.f(i+1,ip));
 
-									rarray = min(rarray,
-											w3[ip+1]+w5[j-number-1]+penalty(i,j,ct,data)+penalty(ip,i+1,ct,data)+
-											ergcoaxflushbases(j-number,i,i+1,ip,ct,data)+v.f(i+2,ip-1)
-											+erg1(i+1,ip,i+2,ip-1,ct,data));
 
-								}
+				if ((mod[i+1]||mod[ip])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&!(fce.f(i+1,ip)&SINGLE)) {
 
-								//now consider an intervening nuc
-								if (j-number>1) {
-									rarray = min(rarray,
-											w3[ip+1]+w5[j-number-2]+penalty(i,j,ct,data)+penalty(ip,i+2,ct,data)+
-											ergcoaxinterbases1(j-number,i,i+2,ip,ct,data)+v.f(i+2,ip)+checknp(lfce[i+1],lfce[j-number-1])
-										    );
+					rarray = min(rarray,
+							w3[ip+1]+w5[j-number-1]+penalty(i,j,ct,data)+penalty(ip,i+1,ct,data)+
+							ergcoaxflushbases(j-number,i,i+1,ip,ct,data)+v.f(i+2,ip-1)
+							+erg1<bonus>(i+1,ip,i+2,ip-1,ct,data));
 
+				}
 
-									if ((mod[i+2]||mod[ip])&&inc[ct->numseq[i+3]][ct->numseq[ip-1]]&&!(fce.f(i+2,ip)&SINGLE)) {
+				//now consider an intervening nuc
+				if (j-number>1) {
+					rarray = min(rarray,
+							w3[ip+1]+w5[j-number-2]+penalty(i,j,ct,data)+penalty(ip,i+2,ct,data)+
+							ergcoaxinterbases1(j-number,i,i+2,ip,ct,data)+v.f(i+2,ip)+checknp(lfce[i+1],lfce[j-number-1])
+						    );
 
-										rarray = min(rarray,
-												w3[ip+1]+w5[j-number-2]+penalty(i,j,ct,data)+penalty(ip,i+2,ct,data)+
-												ergcoaxinterbases1(j-number,i,i+2,ip,ct,data)+v.f(i+3,ip-1)
-												+erg1(i+2,ip,i+3,ip-1,ct,data)+checknp(lfce[i+1],lfce[j-number-1])
-											    );
 
-									}
-								}
+					if ((mod[i+2]||mod[ip])&&inc[ct->numseq[i+3]][ct->numseq[ip-1]]&&!(fce.f(i+2,ip)&SINGLE)) {
 
-								//consider the other possibility for an intervening nuc
-								rarray = min(rarray,
-										w3[ip+1]+w5[j-number-1]+penalty(i,j,ct,data)+penalty(ip-1,i+2,ct,data)+
-										ergcoaxinterbases2(j-number,i,i+2,ip-1,ct,data)+v.f(i+2,ip-1)+checknp(lfce[i+1],lfce[ip])
-									    );
+						rarray = min(rarray,
+								w3[ip+1]+w5[j-number-2]+penalty(i,j,ct,data)+penalty(ip,i+2,ct,data)+
+								ergcoaxinterbases1(j-number,i,i+2,ip,ct,data)+v.f(i+3,ip-1)
+								+erg1<bonus>(i+2,ip,i+3,ip-1,ct,data)+checknp(lfce[i+1],lfce[j-number-1])
+							    );
 
-								if ((mod[i+2]||mod[ip-1])&&inc[ct->numseq[i+3]][ct->numseq[ip-2]]&&!(fce.f(i+2,ip-1)&SINGLE)) {
+					}
+				}
 
-									rarray = min(rarray,
-											w3[ip+1]+w5[j-number-1]+penalty(i,j,ct,data)+penalty(ip-1,i+2,ct,data)+
-											ergcoaxinterbases2(j-number,i,i+2,ip-1,ct,data)+v.f(i+3,ip-2)
-											+erg1(i+2,ip-1,i+3,ip-2,ct,data)+checknp(lfce[i+1],lfce[ip])
-										    );
-								}
-							}
-#endif //ifndef disablecoax
-						}
+				//consider the other possibility for an intervening nuc
+				rarray = min(rarray,
+						w3[ip+1]+w5[j-number-1]+penalty(i,j,ct,data)+penalty(ip-1,i+2,ct,data)+
+						ergcoaxinterbases2(j-number,i,i+2,ip-1,ct,data)+v.f(i+2,ip-1)+checknp(lfce[i+1],lfce[ip])
+					    );
 
-#ifndef INSTRUMENTED
+				if ((mod[i+2]||mod[ip-1])&&inc[ct->numseq[i+3]][ct->numseq[ip-2]]&&!(fce.f(i+2,ip-1)&SINGLE)) {
+
+					rarray = min(rarray,
+							w3[ip+1]+w5[j-number-1]+penalty(i,j,ct,data)+penalty(ip-1,i+2,ct,data)+
+							ergcoaxinterbases2(j-number,i,i+2,ip-1,ct,data)+v.f(i+3,ip-2)
+							+erg1<bonus>(i+2,ip-1,i+3,ip-2,ct,data)+checknp(lfce[i+1],lfce[ip])
+						    );
+				}
+			}
+#endif //ifndef disablecoax
+		}
+
+#ifndef INSTRUMENTED
 
 #else//IF INSTRUMENTED IS DEFINED
-						v.f(i,j) = min(rarray,v.f(i,j));//QUESTION: DO WE NEED THIS? WAS IN algorithm.napss.cpp
-						vext.f(i,j) = rarray;
+		v.f(i,j) = min(rarray,v.f(i,j));//QUESTION: DO WE NEED THIS? WAS IN algorithm.napss.cpp
+		vext.f(i,j) = rarray;
 
-						rarray = INFINITE_ENERGY;//QUESTION: DO WE NEED THIS? WAS IN algorithm.napss.cpp
+		rarray = INFINITE_ENERGY;//QUESTION: DO WE NEED THIS? WAS IN algorithm.napss.cpp
 #endif//END INSTRUMENTED
 
-						//consider the multiloop closed by i,j
-						if ((j-i)>(2*minloop+4)&&i!=number) {
-							//no dangling ends on i-j pair:
-							if (j-1!=number) {
-								rarray = min(rarray,wmb.f(i+1,j-1)+data->eparam[5]+data->eparam[10]
-										+ penalty(i,j,ct,data));
+		//consider the multiloop closed by i,j
+		if ((j-i)>(2*minloop+4)&&i!=number) {
+			//no dangling ends on i-j pair:
+			if (j-1!=number) {
+				rarray = min(rarray,wmb.f(i+1,j-1)+data->eparam[5]+data->eparam[10]
+						+ penalty(i,j,ct,data));
 
 
-								//i+1 dangles on i-j pair:
-								//COMMENT BY FD: eparam[5]--efn2a, eparam[6]--efn2b, penalty for unpaired base, eparam[10]--enf2c, penalty for each helix
-								if (i+1!=number) rarray = min(rarray,erg4(i,j,i+1,1,ct,data,lfce[i+1]) + penalty(i,j,ct,data) +
-										wmb.f(i+2,j-1) + data->eparam[5] + data->eparam[6] + data->eparam[10]);
-							}
-							if (j-2!=number) {
-								//j-1 dangles
-								if (j!=(number+1)) rarray = min(rarray,erg4(i,j,j-1,2,ct,data,lfce[j-1]) + penalty(i,j,ct,data) +
-										wmb.f(i+1,j-2) + data->eparam[5] + data->eparam[6] + data->eparam[10]);
-								//both i+1 and j-1 dangle
-								if ((i+1!=number)&&(j!=(number+1))) {
-									rarray = min(rarray,data->tstkm[ct->numseq[i]][ct->numseq[j]]
-											[ct->numseq[i+1]][ct->numseq[j-1]] +
-											checknp(lfce[i+1],lfce[j-1])+
-											wmb.f(i+2,j-2) + data->eparam[5] + 2*data->eparam[6] + data->eparam[10]
-											+penalty(i,j,ct,data)+ ct->SHAPEss_give_value(i+1)+ ct->SHAPEss_give_value(j-1));
-								}
-							}
+				//i+1 dangles on i-j pair:
+				//COMMENT BY FD: eparam[5]--efn2a, eparam[6]--efn2b, penalty for unpaired base, eparam[10]--enf2c, penalty for each helix
+				if (i+1!=number) rarray = min(rarray,erg4(i,j,i+1,1,ct,data,lfce[i+1]) + penalty(i,j,ct,data) +
+						wmb.f(i+2,j-1) + data->eparam[5] + data->eparam[6] + data->eparam[10]);
+			}
+			if (j-2!=number) {
+				//j-1 dangles
+				if (j!=(number+1)) rarray = min(rarray,erg4(i,j,j-1,2,ct,data,lfce[j-1]) + penalty(i,j,ct,data) +
+						wmb.f(i+1,j-2) + data->eparam[5] + data->eparam[6] + data->eparam[10]);
+				//both i+1 and j-1 dangle
+				if ((i+1!=number)&&(j!=(number+1))) {
+					rarray = min(rarray,data->tstkm[ct->numseq[i]][ct->numseq[j]]
+							[ct->numseq[i+1]][ct->numseq[j-1]] +
+							checknp(lfce[i+1],lfce[j-1])+
+							wmb.f(i+2,j-2) + data->eparam[5] + 2*data->eparam[6] + data->eparam[10]
+							+penalty(i,j,ct,data)+ SHAPEss<shaped>(ct,i+1)+ SHAPEss<shaped>(ct,j-1));
+				}
+			}
 
-							//consider the coaxial stacking of a helix from i to j onto helix i+1 or i+2 to ip:
+			//consider the coaxial stacking of a helix from i to j onto helix i+1 or i+2 to ip:
 #ifndef disablecoax
-							for (ip=i+1;(ip<j);ip++) {
-								//first consider flush stacking
+			for (ip=i+1;(ip<j);ip++) {
+				//when pruning, skip the helices that are removed exterior fragments
+				if (s.prune&&j>number&&pruned(v.f(i+1,ip))&&pruned(v.f(i+2,ip))) continue;
 
-								//conditions guarantee that the coaxial stacking isn't considering an exterior loop 
-								//if ((i!=number)/*&&(i+1!=number)*//*&&((j>number)||(ip!=number)&&(ip+1!=number))&&(j-1!=number)*/) 
-								if (i!=number&&ip!=number&&j-1!=number) {
-									
-									if (inc[ct->numseq[i+1]][ct->numseq[ip]]) {
-										//only proceed if i+1 can pair with ip
+				//first consider flush stacking
 
-										rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+1,ip)+
-												penalty(i+1,ip,ct,data)+data->eparam[5]
-												+2*data->eparam[10]+w.f(ip+1,j-1)+ergcoaxflushbases(j,i,i+1,ip,ct,data));
+				//conditions guarantee that the coaxial stacking isn't considering an exterior loop 
+				//if ((i!=number)/*&&(i+1!=number)*//*&&((j>number)||(ip!=number)&&(ip+1!=number))&&(j-1!=number)*/) 
+				if (i!=number&&ip!=number&&j-1!=number) {
+					
+					if (inc[ct->numseq[i+1]][ct->numseq[ip]]) {
+						//only proceed if i+1 can pair with ip
 
+						rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+1,ip)+
+								penalty(i+1,ip,ct,data)+data->eparam[5]
+								+2*data->eparam[10]+w.f(ip+1,j-1)+ergcoaxflushbases(j,i,i+1,ip,ct,data));
 
-										if((mod[i+1]||mod[ip])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&!(fce.f(i+1,ip)&SINGLE)) {
 
-											rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+2,ip-1)+
-													penalty(i+1,ip,ct,data)+data->eparam[5]
-													+2*data->eparam[10]+w.f(ip+1,j-1)+ergcoaxflushbases(j,i,i+1,ip,ct,data)
-													+erg1(i+1,ip,i+2,ip-1,ct,data));
-										}
-									}
-									//if ((ip<j-1)&&(i+2!=number)) 
-									if (inc[ct->numseq[i+2]][ct->numseq[ip]]&&ip+2<j-1&&i+1!=number&&ip+1!=number) {
-										//now consider an intervening nuc
-										if ((ip+2<j-1)/*&&(j>number||ip+2!=number)*/)
-											rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+2,ip)+
-													penalty(i+2,ip,ct,data)+data->eparam[5]
-													+2*data->eparam[6]+2*data->eparam[10]+w.f(ip+2,j-1)
-													+ergcoaxinterbases2(j,i,i+2,ip,ct,data)+checknp(lfce[i+1],lfce[ip+1])
-												    );
-
-										if((mod[i+2]||mod[ip])&&inc[ct->numseq[i+3]][ct->numseq[ip-1]]&&!(fce.f(i+2,ip)&SINGLE)) {
-
-											rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+3,ip-1)+
-													penalty(i+2,ip,ct,data)+data->eparam[5]
-													+2*data->eparam[6]+2*data->eparam[10]+w.f(ip+2,j-1)
-													+ergcoaxinterbases2(j,i,i+2,ip,ct,data)
-													+erg1(i+2,ip,i+3,ip-1,ct,data)+checknp(lfce[i+1],lfce[ip+1])
-												    );
+						if((mod[i+1]||mod[ip])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&!(fce.f(i+1,ip)&SINGLE)) {
 
-										}
+							rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+2,ip-1)+
+									penalty(i+1,ip,ct,data)+data->eparam[5]
+									+2*data->eparam[10]+w.f(ip+1,j-1)+ergcoaxflushbases(j,i,i+1,ip,ct,data)
+									+erg1<bonus>(i+1,ip,i+2,ip-1,ct,data));
+						}
+					}
+					//if ((ip<j-1)&&(i+2!=number)) 
+					if (inc[ct->numseq[i+2]][ct->numseq[ip]]&&ip+2<j-1&&i+1!=number&&ip+1!=number) {
+						//now consider an intervening nuc
+						if ((ip+2<j-1)/*&&(j>number||ip+2!=number)*/)
+							rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+2,ip)+
+									penalty(i+2,ip,ct,data)+data->eparam[5]
+									+2*data->eparam[6]+2*data->eparam[10]+w.f(ip+2,j-1)
+									+ergcoaxinterbases2(j,i,i+2,ip,ct,data)+checknp(lfce[i+1],lfce[ip+1])
+								    );
+
+						if((mod[i+2]||mod[ip])&&inc[ct->numseq[i+3]][ct->numseq[ip-1]]&&!(fce.f(i+2,ip)&SINGLE)) {
+
+							rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+3,ip-1)+
+									penalty(i+2,ip,ct,data)+data->eparam[5]
+									+2*data->eparam[6]+2*data->eparam[10]+w.f(ip+2,j-1)
+									+ergcoaxinterbases2(j,i,i+2,ip,ct,data)
+									+erg1<bonus>(i+2,ip,i+3,ip-1,ct,data)+checknp(lfce[i+1],lfce[ip+1])
+								    );
 
-										if (ip+1<j-2&&j-2!=number)
-											rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+2,ip)+
-													penalty(i+2,ip,ct,data)+data->eparam[5]
-													+2*data->eparam[6]+2*data->eparam[10]+w.f(ip+1,j-2)
-													+ergcoaxinterbases1(j,i,i+2,ip,ct,data)+checknp(lfce[i+1],lfce[j-1])
-												    );
+						}
 
-										if((mod[i+2]||mod[ip])&&inc[ct->numseq[i+3]][ct->numseq[ip-1]]&&!(fce.f(i+2,ip)&SINGLE)) {
+						if (ip+1<j-2&&j-2!=number)
+							rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+2,ip)+
+									penalty(i+2,ip,ct,data)+data->eparam[5]
+									+2*data->eparam[6]+2*data->eparam[10]+w.f(ip+1,j-2)
+									+ergcoaxinterbases1(j,i,i+2,ip,ct,data)+checknp(lfce[i+1],lfce[j-1])
+								    );
 
-											rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+3,ip-1)+
-													penalty(i+2,ip,ct,data)+data->eparam[5]
-													+2*data->eparam[6]+2*data->eparam[10]+w.f(ip+1,j-2)
-													+ergcoaxinterbases1(j,i,i+2,ip,ct,data)
-													+erg1(i+2,ip,i+3,ip-1,ct,data)+checknp(lfce[i+1],lfce[j-1])
-												    );
+						if((mod[i+2]||mod[ip])&&inc[ct->numseq[i+3]][ct->numseq[ip-1]]&&!(fce.f(i+2,ip)&SINGLE)) {
 
-										}
-									}//end (ip+2<j-1&&i+1!=number&&ip+1!=number)
-								}
-							}
+							rarray = min(rarray,penalty(i,j,ct,data)+v.f(i+3,ip-1)+
+									penalty(i+2,ip,ct,data)+data->eparam[5]
+									+2*data->eparam[6]+2*data->eparam[10]+w.f(ip+1,j-2)
+									+ergcoaxinterbases1(j,i,i+2,ip,ct,data)
+									+erg1<bonus>(i+2,ip,i+3,ip-1,ct,data)+checknp(lfce[i+1],lfce[j-1])
+								    );
 
-							//consider the coaxial stacking of a helix from i to j onto helix ip to j-2 or j-1:
-							for (ip=j-1;ip>i;ip--) {
+						}
+					}//end (ip+2<j-1&&i+1!=number&&ip+1!=number)
+				}
+			}
 
-								//conditions guarantee that the coaxial stacking isn't considering an exterior loop
-								//if ((i!=number)&&(i+1!=number)&&((j>number)||(ip!=number)&&(ip-1!=number))&&(j-1!=number)) {}
-								if (j-1!=number&&ip-1!=number&&i!=number) {
-									//first consider flush stacking
+			//consider the coaxial stacking of a helix from i to j onto helix ip to j-2 or j-1:
+			for (ip=j-1;ip>i;ip--) {
+				if (s.prune&&j>number&&pruned(v.f(ip,j-1))&&pruned(v.f(ip,j-2))) continue;
 
-									if (inc[ct->numseq[j-1]][ct->numseq[ip]]) {
-										//only proceed if j-1 can pair to ip
+				//conditions guarantee that the coaxial stacking isn't considering an exterior loop
+				//if ((i!=number)&&(i+1!=number)&&((j>number)||(ip!=number)&&(ip-1!=number))&&(j-1!=number)) {}
+				if (j-1!=number&&ip-1!=number&&i!=number) {
+					//first consider flush stacking
 
-										rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip,j-1)+
-												penalty(j-1,ip,ct,data)+data->eparam[5]
-												+2*data->eparam[10]+w.f(i+1,ip-1)+ergcoaxflushbases(ip,j-1,j,i,ct,data));
+					if (inc[ct->numseq[j-1]][ct->numseq[ip]]) {
+						//only proceed if j-1 can pair to ip
 
+						rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip,j-1)+
+								penalty(j-1,ip,ct,data)+data->eparam[5]
+								+2*data->eparam[10]+w.f(i+1,ip-1)+ergcoaxflushbases(ip,j-1,j,i,ct,data));
 
-										if((mod[ip]||mod[j-1])&&inc[ct->numseq[ip+1]][ct->numseq[j-2]]&&!(fce.f(ip,j-1)&SINGLE)) {
-											rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip+1,j-2)+
-													penalty(j-1,ip,ct,data)+data->eparam[5]
-													+2*data->eparam[10]+w.f(i+1,ip-1)+ergcoaxflushbases(ip,j-1,j,i,ct,data)
-													+erg1(ip,j-1,ip+1,j-2,ct,data));
 
-										}
-									}
+						if((mod[ip]||mod[j-1])&&inc[ct->numseq[ip+1]][ct->numseq[j-2]]&&!(fce.f(ip,j-1)&SINGLE)) {
+							rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip+1,j-2)+
+									penalty(j-1,ip,ct,data)+data->eparam[5]
+									+2*data->eparam[10]+w.f(i+1,ip-1)+ergcoaxflushbases(ip,j-1,j,i,ct,data)
+									+erg1<bonus>(ip,j-1,ip+1,j-2,ct,data));
 
-									if  (inc[ct->numseq[j-2]][ct->numseq[ip]]&&j-2!=number) {
-										//now consider an intervening nuc
-										//if ((ip>i+1)&&(j>number||ip-2!=number))
-										if (ip-2>i+1&&ip-2!=number) {
-											rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip,j-2)+
-													penalty(j-2,ip,ct,data)+data->eparam[5]
-													+2*data->eparam[6]+2*data->eparam[10]+w.f(i+1,ip-2)
-													+ergcoaxinterbases1(ip,j-2,j,i,ct,data)+checknp(lfce[j-1],lfce[ip-1])
-												    );
+						}
+					}
 
+					if  (inc[ct->numseq[j-2]][ct->numseq[ip]]&&j-2!=number) {
+						//now consider an intervening nuc
+						//if ((ip>i+1)&&(j>number||ip-2!=number))
+						if (ip-2>i+1&&ip-2!=number) {
+							rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip,j-2)+
+									penalty(j-2,ip,ct,data)+data->eparam[5]
+									+2*data->eparam[6]+2*data->eparam[10]+w.f(i+1,ip-2)
+									+ergcoaxinterbases1(ip,j-2,j,i,ct,data)+checknp(lfce[j-1],lfce[ip-1])
+								    );
 
 
-											if((mod[ip]||mod[j-2])&&inc[ct->numseq[ip+1]][ct->numseq[j-3]]&&!(fce.f(ip,j-2)&SINGLE)) {
-												rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip+1,j-3)+
-														penalty(j-2,ip,ct,data)+data->eparam[5]
-														+2*data->eparam[6]+2*data->eparam[10]+w.f(i+1,ip-2)
-														+ergcoaxinterbases1(ip,j-2,j,i,ct,data)
-														+erg1(ip,j-2,ip+1,j-3,ct,data)+checknp(lfce[j-1],lfce[ip-1])
-													    );
 
-											}
-										}
+							if((mod[ip]||mod[j-2])&&inc[ct->numseq[ip+1]][ct->numseq[j-3]]&&!(fce.f(ip,j-2)&SINGLE)) {
+								rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip+1,j-3)+
+										penalty(j-2,ip,ct,data)+data->eparam[5]
+										+2*data->eparam[6]+2*data->eparam[10]+w.f(i+1,ip-2)
+										+ergcoaxinterbases1(ip,j-2,j,i,ct,data)
+										+erg1<bonus>(ip,j-2,ip+1,j-3,ct,data)+checknp(lfce[j-1],lfce[ip-1])
+									    );
 
-										if ((ip-1>i+2)&&i+1!=number) {
-											rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip,j-2)+
-													penalty(j-2,ip,ct,data)+data->eparam[5]
-													+2*data->eparam[6]+2*data->eparam[10]+w.f(i+2,ip-1)
-													+ergcoaxinterbases2(ip,j-2,j,i,ct,data)+checknp(lfce[j-1],lfce[i+1])
-												    );
-
-											if((mod[ip]||mod[j-2])&&inc[ct->numseq[ip+1]][ct->numseq[j-3]]&&!(fce.f(ip,j-2)&SINGLE)) {
-												rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip+1,j-3)+
-														penalty(j-2,ip,ct,data)+data->eparam[5]
-														+2*data->eparam[6]+2*data->eparam[10]+w.f(i+2,ip-1)
-														+ergcoaxinterbases2(ip,j-2,j,i,ct,data)
-														+erg1(ip,j-2,ip+1,j-3,ct,data)+checknp(lfce[j-1],lfce[i+1])
-													    );
-
-											}
-										}
-									}
-								}
 							}
+						}
+
+						if ((ip-1>i+2)&&i+1!=number) {
+							rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip,j-2)+
+									penalty(j-2,ip,ct,data)+data->eparam[5]
+									+2*data->eparam[6]+2*data->eparam[10]+w.f(i+2,ip-1)
+									+ergcoaxinterbases2(ip,j-2,j,i,ct,data)+checknp(lfce[j-1],lfce[i+1])
+								    );
+
+							if((mod[ip]||mod[j-2])&&inc[ct->numseq[ip+1]][ct->numseq[j-3]]&&!(fce.f(ip,j-2)&SINGLE)) {
+								rarray = min(rarray,penalty(i,j,ct,data)+v.f(ip+1,j-3)+
+										penalty(j-2,ip,ct,data)+data->eparam[5]
+										+2*data->eparam[6]+2*data->eparam[10]+w.f(i+2,ip-1)
+										+ergcoaxinterbases2(ip,j-2,j,i,ct,data)
+										+erg1<bonus>(ip,j-2,ip+1,j-3,ct,data)+checknp(lfce[j-1],lfce[i+1])
+									    );
+
+							}
+						}
+					}
+				}
+			}
 #endif //ifndef disablecoax
-							if (ct->intermolecular) {
+			if ((intermolecular&&ct->intermolecular)) {
 
-								//intermolecular, so consider wmb2,
-								//don't add the multiloop penalties because this is a exterior loop
+				//intermolecular, so consider wmb2,
+				//don't add the multiloop penalties because this is a exterior loop
 
-								rarray = min(rarray,wmb2->f(i+1,j-1) + penalty(i,j,ct,data)+INFINITE_ENERGY);
+				rarray = min(rarray,wmb2->f(i+1,j-1) + penalty(i,j,ct,data)+INFINITE_ENERGY);
 
 
-								//i+1 dangles on i-j pair:
-								if (i!=number) rarray = min(rarray,erg4(i,j,i+1,1,ct,data,lfce[i+1]) + penalty(i,j,ct,data) +
-										wmb2->f(i+2,j-1)+INFINITE_ENERGY);
-								//j-1 dangles
-								if (j!=(number+1)) rarray = min(rarray,erg4(i,j,j-1,2,ct,data,lfce[j-1]) + penalty(i,j,ct,data) +
-										wmb2->f(i+1,j-2)+INFINITE_ENERGY);
-								//both i+1 and j-1 dangle
-								if ((i!=number)&&(j!=(number+1))) {
-									rarray = min(rarray,
-											data->tstkm[ct->numseq[i]][ct->numseq[j]][ct->numseq[i+1]][ct->numseq[j-1]] +
-											checknp(lfce[i+1],lfce[j-1]) +
-											wmb2->f(i+2,j-2) + penalty(i,j,ct,data)+INFINITE_ENERGY);
+				//i+1 dangles on i-j pair:
+				if (i!=number) rarray = min(rarray,erg4(i,j,i+1,1,ct,data,lfce[i+1]) + penalty(i,j,ct,data) +
+						wmb2->f(i+2,j-1)+INFINITE_ENERGY);
+				//j-1 dangles
+				if (j!=(number+1)) rarray = min(rarray,erg4(i,j,j-1,2,ct,data,lfce[j-1]) + penalty(i,j,ct,data) +
+						wmb2->f(i+1,j-2)+INFINITE_ENERGY);
+				//both i+1 and j-1 dangle
+				if ((i!=number)&&(j!=(number+1))) {
+					rarray = min(rarray,
+							data->tstkm[ct->numseq[i]][ct->numseq[j]][ct->numseq[i+1]][ct->numseq[j-1]] +
+							checknp(lfce[i+1],lfce[j-1]) +
+							wmb2->f(i+2,j-2) + penalty(i,j,ct,data)+INFINITE_ENERGY);
 
-								}
-							}
-						}
-					}
+				}
+			}
+		}
+	}
 
 #ifndef INSTRUMENTED//IF INSTRUMENTED IS NOT DEFINED
-					//MODIFIED BY FD
-					//v.f(i,j) = rarray;
-					v1.f(i,j) = rarray + SHAPEendPair(i, j, ct);
-					v2.f(i,j) += SHAPEendPair(i, j, ct);
-					v.f(i,j) = min(v1.f(i,j), v2.f(i,j));
+	//MODIFIED BY FD
+	//v.f(i,j) = rarray;
+	v1.f(i,j) = rarray + SHAPEpair<shaped>(i, j, ct);
+	v2.f(i,j) += SHAPEpair<shaped>(i, j, ct);
+	v.f(i,j) = min(v1.f(i,j), v2.f(i,j));
 #else//IF INSTRUMENTED IS DEFINED
-					vmb.f(i,j) = rarray;
-					v.f(i,j) = min(rarray,v.f(i,j));//QUESTION: THIS IS DIFFERENT FROM THE MAIN algorithm.cpp (see #ifndef above)
+	vmb.f(i,j) = rarray;
+	v.f(i,j) = min(rarray,v.f(i,j));//QUESTION: THIS IS DIFFERENT FROM THE MAIN algorithm.cpp (see #ifndef above)
 #endif//END INSTRUMENTED
 sub2:
 
-					/*prefill curE[i] and prev[i] for the first two diagonals as ll =4 and 5	
-					  As d =10, only fill curE (ll=4, d=10)
-					  As d =11, only fill prevE (ll=4||5, d=11)
-					  As d>11, fill curE(ll=4||5, d>11)
-					  exchange curE and prevE after d >11  as curE[h][i][dp]=curE=curE[h-2][i+1][dp]
-					  (curE[i][j][ll]=curE[i+1][j-1][ll-2])
+	/*prefill loopE for the loops closed by the fragments i-1,j+1, i-2,j+2, ...:
+	  the inner pairs that leave 4 or 5 unpaired nucleotides inside i,j, and the
+	  inner pairs next to i or j for larger loops
+	  (loopE[i][j][ll]=loopE[i+1][j-1][ll-2])
 
 note: dp = jp-ip, where ip and jp are the interior pairs in interior loop
 d = j - i;
-					 */
+	 */
 
 
-					if (((d-1)>=(minloop+3)||j>number)&&!ct->intermolecular) 
-						for (dp=d-3;dp>=((j>number)?1:minloop+1);dp--)
+	if (((d-1)>=(minloop+3)||j>number)&&!(intermolecular&&ct->intermolecular)) 
+		for (dp=d-3;dp>=((j>number)?1:minloop+1);dp--)
+		{
+			//cout<<"Enter calculation of loopE"<<endl;
+			ll=d-dp-2;
+			//calculate every ip>ip+1,jp<jp-1 when ll ==5 ||4
+			if (ll==4||ll==5) 
+			{
+				for (ip=i+2;ip<=j-2-dp;ip++)
+				{
+					jp=ip+dp;
+					if (inc[ct->numseq[ip]][ct->numseq[jp]])
+						if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
 						{
-							//cout<<"Enter calculation of curE and prevE"<<endl;
-							ll=d-dp-2;
-							//calculate every ip>ip+1,jp<jp-1 when ll ==5 ||4
-							if (ll==4||ll==5) 
-							{
-								for (ip=i+2;ip<=j-2-dp;ip++)
-								{
-									jp=ip+dp;
-									if (inc[ct->numseq[ip]][ct->numseq[jp]])
-										if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
-										{
-											if(d==( (j>number)?7:10 )||d>( (j>number)?8:11 ))  
-												//fill the first diagonal of d and first two of ll for every larger d 
-											{
-												curE[dp][i]=min(curE[dp][i],(erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+v.f(ip,jp)));
-
-												//i or j is modified
-												if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
-													curE[dp][i]=min(curE[dp][i],(erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+v.f(ip+1,jp-1)+erg1(ip,jp,ip+1,jp-1,ct,data)));
-
-											}
+							candidates++;
+							loopE[dp]=min(loopE[dp],(erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+SHAPEssInnerPair<shaped>(ct,ip,jp)+v.f(ip,jp)));
 
+							//i or j is modified
+							if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
+								loopE[dp]=min(loopE[dp],(erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+SHAPEssInnerPair<shaped>(ct,ip,jp)+v.f(ip+1,jp-1)+erg1<bonus>(ip,jp,ip+1,jp-1,ct,data)));
+						}
+				}
+			}
 
-											else if ( d==((j>number)?8:11) )  //fill the second diagonal of d
-											{
-												prevE[dp][i]=min(prevE[dp][i],(erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+v.f(ip,jp)));
-
-												if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
+			//when size >=6 and <=30;
+			//   else if (ll>=6&&ll<=(data->eparam[7]))
+			else if (ll>=6&&ll<=maxinter){
+				//calculate minimum loopE[dp] of 1 x (n-1) for next step's 2 x (n-2)
+				ip=i+2;
+				jp=ip+dp;
+				if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
+					if (abs(ip-i+jp-j)<=maxasym) 
+						if (inc[ct->numseq[ip]][ct->numseq[jp]]){
+							candidates++;
+							loopE[dp] = min(loopE[dp], (erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+SHAPEssInnerPair<shaped>(ct,ip,jp)+v.f(ip,jp))) ;	
 
-													prevE[dp][i]=min(prevE[dp][i],(erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+ v.f(ip+1,jp-1)+erg1(ip,jp,ip+1,jp-1,ct,data)));
-											}
-										}
-								}
-							}
+							if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
+								loopE[dp]=min(loopE[dp],(erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+SHAPEssInnerPair<shaped>(ct,ip,jp)+
+											v.f(ip+1,jp-1)+erg1<bonus>(ip,jp,ip+1,jp-1,ct,data)));
 
-							//when size >=6 and <=30;
-							//   else if (ll>=6&&ll<=(data->eparam[7]))
-							else if (ll>=6&&ll<=maxinter){
-								//calculate minimum curE[dp][i] of 1 x (n-1) for next step's 2 x (n-2)
-								ip=i+2;
-								jp=ip+dp;
-								if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
-									if (abs(ip-i+jp-j)<=maxasym) 
-										if (inc[ct->numseq[ip]][ct->numseq[jp]]){
-											curE[dp][i] = min(curE[dp][i], (erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+v.f(ip,jp))) ;	
 
-											if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
-												curE[dp][i]=min(curE[dp][i],(erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+
-															v.f(ip+1,jp-1)+erg1(ip,jp,ip+1,jp-1,ct,data)));
+						}
 
+				jp=j-2;
+				ip=jp-dp;
+				if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
+					if (abs(ip-i+jp-j)<=maxasym) 
+						if (inc[ct->numseq[ip]][ct->numseq[jp]]){
+							candidates++;
+							loopE[dp] = min(loopE[dp], (erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+SHAPEssInnerPair<shaped>(ct,ip,jp)+v.f(ip,jp))) ;	
 
-										}
+							if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
+								loopE[dp]=min(loopE[dp],(erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+SHAPEssInnerPair<shaped>(ct,ip,jp)+
+											v.f(ip+1,jp-1)+erg1<bonus>(ip,jp,ip+1,jp-1,ct,data)));
 
-								jp=j-2;
-								ip=jp-dp;
-								if ( (ip<=number&&jp>number) || (ip<=number&&j<=number) )
-									if (abs(ip-i+jp-j)<=maxasym) 
-										if (inc[ct->numseq[ip]][ct->numseq[jp]]){
-											curE[dp][i] = min(curE[dp][i], (erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+v.f(ip,jp))) ;	
 
-											if ((mod[ip]||mod[jp])&&inc[ct->numseq[ip]][ct->numseq[jp]]&&!(fce.f(ip,jp)&SINGLE)) 
-												curE[dp][i]=min(curE[dp][i],(erg2in(i,j,ip,jp,ct,data,fce.f(i,ip),fce.f(jp,j))+
-															v.f(ip+1,jp-1)+erg1(ip,jp,ip+1,jp-1,ct,data)));
+						}
+			}
+		}	  
 
+	if (profile.enabled&&candidates>0) {
+#ifdef SMP
+#pragma omp critical
+#endif
+		profile.addinternal(i,(j>number)?j-number:j,candidates);
+	}
 
-										}
-							}
-						}	  
+	//also block propagation of interior loops that contain nucleotides that need to be double-stranded:
+	if ((lfce[i]||lfce[j])&&!(intermolecular&&ct->intermolecular)) for (dp=1;dp<=d;dp++) loopE[dp] = INFINITE_ENERGY;//QUESTION: THIS WASN'T IN THE algirithm.napss.cpp
 
-					//also block propagation of interior loops that contain nucleotides that need to be double-stranded:
-					if ((lfce[i]||lfce[j])&&!ct->intermolecular) for (dp=1;dp<=d;dp++) curE[dp][i] = INFINITE_ENERGY;//QUESTION: THIS WASN'T IN THE algirithm.napss.cpp
 
+	//Compute w[i][j]: best energy between i and j where i,j does not have
+	//	to be a base pair
+	//(an exterior loop when it contains n and 1 (ie:n+1)   )
 
-					//Compute w[i][j]: best energy between i and j where i,j does not have
-					//	to be a base pair
-					//(an exterior loop when it contains n and 1 (ie:n+1)   )
 
+	w.f(i,j)=INFINITE_ENERGY;
 
-					w.f(i,j)=INFINITE_ENERGY;
+	if (fce.f(i,j)&PAIR)  {//force a pair between i and j
+		w.f(i,j) = v.f(i,j)+data->eparam[10]+penalty(i,j,ct,data);
 
-					if (fce.f(i,j)&PAIR)  {//force a pair between i and j
-						w.f(i,j) = v.f(i,j)+data->eparam[10]+penalty(i,j,ct,data);
+		goto sub3;
+	}
 
-						goto sub3;
-					}
+	for (ii=1;ii<=5;ii++) e[ii] = INFINITE_ENERGY;
 
-					for (ii=1;ii<=5;ii++) e[ii] = INFINITE_ENERGY;
+	if (i!=number) {
+		//calculate the energy of i stacked onto the pair of i+1,j
 
-					if (i!=number) {
-						//calculate the energy of i stacked onto the pair of i+1,j
+		e[1] = v.f(i+1,j) + data->eparam[10] + data->eparam[6] +
+			erg4(j,i+1,i,2,ct,data,lfce[i])+penalty(i+1,j,ct,data);
 
-						e[1] = v.f(i+1,j) + data->eparam[10] + data->eparam[6] +
-							erg4(j,i+1,i,2,ct,data,lfce[i])+penalty(i+1,j,ct,data);
+		if ((mod[i+1]||mod[j])&&inc[ct->numseq[i+2]][ct->numseq[j-1]]&&!(fce.f(i+1,j)&SINGLE)) {
 
-						if ((mod[i+1]||mod[j])&&inc[ct->numseq[i+2]][ct->numseq[j-1]]&&!(fce.f(i+1,j)&SINGLE)) {
+			e[1] = min(e[1],v.f(i+2,j-1) + data->eparam[10] + data->eparam[6] +
+					erg4(j,i+1,i,2,ct,data,lfce[i])+penalty(i+1,j,ct,data)
+					+erg1<bonus>(i+1,j,i+2,j-1,ct,data));
 
-							e[1] = min(e[1],v.f(i+2,j-1) + data->eparam[10] + data->eparam[6] +
-									erg4(j,i+1,i,2,ct,data,lfce[i])+penalty(i+1,j,ct,data)
-									+erg1(i+1,j,i+2,j-1,ct,data));
 
+		}
+		if (!lfce[i]) {
+			if (!(fce.f(i,i)&INTER))
+				//add a nuc to an existing loop:
+				e[4] = w.f(i+1,j) + data->eparam[6]+ SHAPEss<shaped>(ct,i);
+			//this is for when i represents the center of an intermolecular linker:
+			else e[4] = w.f(i+1,j) + data->eparam[6] + INFINITE_ENERGY;
+		}
+	}
+	if (j!=((number)+1)) {
+		//calculate the energy of j stacked onto the pair of i,j-1
+		if (j!=1) {
+			e[2] = v.f(i,j-1) + data->eparam[10] + data->eparam[6] +
+				erg4(j-1,i,j,1,ct,data,lfce[j])+penalty(i,j-1,ct,data);
 
-						}
-						if (!lfce[i]) {
-							if (!(fce.f(i,i)&INTER))
-								//add a nuc to an existing loop:
-								e[4] = w.f(i+1,j) + data->eparam[6]+ ct->SHAPEss_give_value(i);
-							//this is for when i represents the center of an intermolecular linker:
-							else e[4] = w.f(i+1,j) + data->eparam[6] + INFINITE_ENERGY;
-						}
-					}
-					if (j!=((number)+1)) {
-						//calculate the energy of j stacked onto the pair of i,j-1
-						if (j!=1) {
-							e[2] = v.f(i,j-1) + data->eparam[10] + data->eparam[6] +
-								erg4(j-1,i,j,1,ct,data,lfce[j])+penalty(i,j-1,ct,data);
-
-							if ((mod[i]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[j-2]]&&!(fce.f(i,j-1)&SINGLE)) {
+			if ((mod[i]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[j-2]]&&!(fce.f(i,j-1)&SINGLE)) {
 
-								e[2] = min(e[2],v.f(i+1,j-2) + data->eparam[10] + data->eparam[6] +
-										erg4(j-1,i,j,1,ct,data,lfce[j])+penalty(i,j-1,ct,data)
-										+erg1(i,j-1,i+1,j-2,ct,data));
-							}
+				e[2] = min(e[2],v.f(i+1,j-2) + data->eparam[10] + data->eparam[6] +
+						erg4(j-1,i,j,1,ct,data,lfce[j])+penalty(i,j-1,ct,data)
+						+erg1<bonus>(i,j-1,i+1,j-2,ct,data));
+			}
 
-							if (!lfce[j]) {
-								if (!(fce.f(j,j)&INTER)) {
-									//add a nuc to an existing loop:
-									e[5] = w.f(i,j-1) + data->eparam[6]+ ct->SHAPEss_give_value(j);
-								}
-								else e[5] = w.f(i,j-1) + data->eparam[6] + INFINITE_ENERGY;
+			if (!lfce[j]) {
+				if (!(fce.f(j,j)&INTER)) {
+					//add a nuc to an existing loop:
+					e[5] = w.f(i,j-1) + data->eparam[6]+ SHAPEss<shaped>(ct,j);
+				}
+				else e[5] = w.f(i,j-1) + data->eparam[6] + INFINITE_ENERGY;
 
-							}
-						}
-					}
-					if ((i!=(number))&&(j!=((number)+1))) {
-						//calculate i and j stacked onto the pair of i+1,j-1
-						if (j!=1&&!lfce[i]&&!lfce[j]) {
-							e[3] = v.f(i+1,j-1) + data->eparam[10] + 2*(data->eparam[6]) +
-								data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
-								+penalty(j-1,i+1,ct,data)+ ct->SHAPEss_give_value(i)+ ct->SHAPEss_give_value(j);
+			}
+		}
+	}
+	if ((i!=(number))&&(j!=((number)+1))) {
+		//calculate i and j stacked onto the pair of i+1,j-1
+		if (j!=1&&!lfce[i]&&!lfce[j]) {
+			e[3] = v.f(i+1,j-1) + data->eparam[10] + 2*(data->eparam[6]) +
+				data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
+				+penalty(j-1,i+1,ct,data)+ SHAPEss<shaped>(ct,i)+ SHAPEss<shaped>(ct,j);
 
 
 
-							if ((mod[i+1]||mod[j-1])&&(j-2>0)&&!(fce.f(i+1,j-1)&SINGLE)) {
-								if(inc[ct->numseq[i+2]][ct->numseq[j-2]]) {
+			if ((mod[i+1]||mod[j-1])&&(j-2>0)&&!(fce.f(i+1,j-1)&SINGLE)) {
+				if(inc[ct->numseq[i+2]][ct->numseq[j-2]]) {
 
-									e[3] = min(e[3],v.f(i+2,j-2) + data->eparam[10] + 2*(data->eparam[6]) +
-											data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
-											+penalty(j-1,i+1,ct,data)+erg1(i+1,j-1,i+2,j-2,ct,data)+ ct->SHAPEss_give_value(i)+ ct->SHAPEss_give_value(j));
+					e[3] = min(e[3],v.f(i+2,j-2) + data->eparam[10] + 2*(data->eparam[6]) +
+							data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
+							+penalty(j-1,i+1,ct,data)+erg1<bonus>(i+1,j-1,i+2,j-2,ct,data)+ SHAPEss<shaped>(ct,i)+ SHAPEss<shaped>(ct,j));
 
-								}
-							}
-						}
-					}
+				}
+			}
+		}
+	}
 
-					//fragment with i paired to j
-					e[1] = min(((data->eparam[10])+v.f(i,j)+penalty(j,i,ct,data)),e[1]);
+	//fragment with i paired to j
+	e[1] = min(((data->eparam[10])+v.f(i,j)+penalty(j,i,ct,data)),e[1]);
 
-					if ((mod[i]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[j-1]]&&!(fce.f(i,j)&SINGLE)) {
+	if ((mod[i]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[j-1]]&&!(fce.f(i,j)&SINGLE)) {
 
-						e[1] = min(((data->eparam[10])+v.f(i+1,j-1)+penalty(j,i,ct,data)+erg1(i,j,i+1,j-1,ct,data)),e[1]);			
+		e[1] = min(((data->eparam[10])+v.f(i+1,j-1)+penalty(j,i,ct,data)+erg1<bonus>(i,j,i+1,j-1,ct,data)),e[1]);			
 
-					}
-					w.f(i,j) = min(e[1],e[2]);
-					w.f(i,j) = min(w.f(i,j),e[3]);
-					w.f(i,j) = min(w.f(i,j),e[4]);
-					w.f(i,j) = min(w.f(i,j),e[5]);
+	}
+	w.f(i,j) = min(e[1],e[2]);
+	w.f(i,j) = min(w.f(i,j),e[3]);
+	w.f(i,j) = min(w.f(i,j),e[4]);
+	w.f(i,j) = min(w.f(i,j),e[5]);
 
-					if (ct->intermolecular) {
+	if ((intermolecular&&ct->intermolecular)) {
 
-						//wmb2[i][j%3] = INFINITE_ENERGY;
-						//keep track of w2:
-						for (ii=1;ii<=5;ii++) e[ii] = 2*INFINITE_ENERGY;
+		//wmb2[i][j%3] = INFINITE_ENERGY;
+		//keep track of w2:
+		for (ii=1;ii<=5;ii++) e[ii] = 2*INFINITE_ENERGY;
 
-						if (i!=number) {
-							//calculate the energy of i stacked onto the pair of i+1,j
+		if (i!=number) {
+			//calculate the energy of i stacked onto the pair of i+1,j
 
-							e[1] = v.f(i+1,j) +
-								erg4(j,i+1,i,2,ct,data,lfce[i])+penalty(i+1,j,ct,data);
+			e[1] = v.f(i+1,j) +
+				erg4(j,i+1,i,2,ct,data,lfce[i])+penalty(i+1,j,ct,data);
 
-							if ((mod[i+1]||mod[j])&&inc[ct->numseq[i+2]][ct->numseq[j-1]]&&!(fce.f(i+1,j)&SINGLE)) {
+			if ((mod[i+1]||mod[j])&&inc[ct->numseq[i+2]][ct->numseq[j-1]]&&!(fce.f(i+1,j)&SINGLE)) {
 
-								e[1] = min(e[1],v.f(i+2,j-1) +
-										erg4(j,i+1,i,2,ct,data,lfce[i])+penalty(i+1,j,ct,data)
-										+erg1(i+1,j,i+2,j-1,ct,data));
-							}
+				e[1] = min(e[1],v.f(i+2,j-1) +
+						erg4(j,i+1,i,2,ct,data,lfce[i])+penalty(i+1,j,ct,data)
+						+erg1<bonus>(i+1,j,i+2,j-1,ct,data));
+			}
 
-							//if (!lfce[i]) {
-							//if (!(fce.f(i,i)&DUBLE))
-							e[4] = w2->f(i+1,j);
-							//this is for when i represents the center of an intermolecular linker:
-							//else e[4] = w2->f(i+1,j) - INFINITE_ENERGY + data->init;
-							//}
-						}
-						if (j!=((number)+1)) {
-							//calculate the energy of j stacked onto the pair of i,j-1
-							if (j!=1) {
-								e[2] = v.f(i,j-1)   +
-									erg4(j-1,i,j,1,ct,data,lfce[j])+penalty(i,j-1,ct,data);
+			//if (!lfce[i]) {
+			//if (!(fce.f(i,i)&DUBLE))
+			e[4] = w2->f(i+1,j);
+			//this is for when i represents the center of an intermolecular linker:
+			//else e[4] = w2->f(i+1,j) - INFINITE_ENERGY + data->init;
+			//}
+		}
+		if (j!=((number)+1)) {
+			//calculate the energy of j stacked onto the pair of i,j-1
+			if (j!=1) {
+				e[2] = v.f(i,j-1)   +
+					erg4(j-1,i,j,1,ct,data,lfce[j])+penalty(i,j-1,ct,data);
 
-								if ((mod[i]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[j-2]]&&!(fce.f(i,j-1)&SINGLE)) {
+				if ((mod[i]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[j-2]]&&!(fce.f(i,j-1)&SINGLE)) {
 
-									e[2] = min(e[2],v.f(i+1,j-2) +
-											erg4(j-1,i,j,1,ct,data,lfce[j])+penalty(i,j-1,ct,data)
-											+erg1(i,j-1,i+1,j-2,ct,data));
+					e[2] = min(e[2],v.f(i+1,j-2) +
+							erg4(j-1,i,j,1,ct,data,lfce[j])+penalty(i,j-1,ct,data)
+							+erg1<bonus>(i,j-1,i+1,j-2,ct,data));
 
-								}
+				}
 
-								//if (!lfce[j]) {
-								//	if (!(fce[j][j]&DUBLE)) {
-								e[5] = w2->f(i,j-1);
-								//  }
-								//else e[5] = w2->f(i,j-1) - INFINITE_ENERGY + data->init;
+				//if (!lfce[j]) {
+				//	if (!(fce[j][j]&DUBLE)) {
+				e[5] = w2->f(i,j-1);
+				//  }
+				//else e[5] = w2->f(i,j-1) - INFINITE_ENERGY + data->init;
 
-								//}
-							}
-						}
-						if ((i!=(number))&&(j!=((number)+1))) {
-							//calculate i and j stacked onto the pair of i+1,j-1
-							if (j!=1) {
-								e[3] = v.f(i+1,j-1)   +
-									data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]]
-									[ct->numseq[j]][ct->numseq[i]]
-									+checknp(lfce[i],lfce[j])
-									+penalty(j-1,i+1,ct,data);
+				//}
+			}
+		}
+		if ((i!=(number))&&(j!=((number)+1))) {
+			//calculate i and j stacked onto the pair of i+1,j-1
+			if (j!=1) {
+				e[3] = v.f(i+1,j-1)   +
+					data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]]
+					[ct->numseq[j]][ct->numseq[i]]
+					+checknp(lfce[i],lfce[j])
+					+penalty(j-1,i+1,ct,data);
 
 
 
-								if ((mod[i+1]||mod[j-1])&&inc[ct->numseq[i+2]][ct->numseq[j-2]]&&!(fce.f(i+1,j-1)&SINGLE)) {
+				if ((mod[i+1]||mod[j-1])&&inc[ct->numseq[i+2]][ct->numseq[j-2]]&&!(fce.f(i+1,j-1)&SINGLE)) {
 
-									e[3] = min(e[3],v.f(i+2,j-2) +
-											data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
-											+checknp(lfce[i],lfce[j])
-											+penalty(j-1,i+1,ct,data)+erg1(i+1,j-1,i+2,j-2,ct,data));
+					e[3] = min(e[3],v.f(i+2,j-2) +
+							data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
+							+checknp(lfce[i],lfce[j])
+							+penalty(j-1,i+1,ct,data)+erg1<bonus>(i+1,j-1,i+2,j-2,ct,data));
 
-								}
-							}
-						}
+				}
+			}
+		}
 
-						e[1] = min(e[1],(v.f(i,j)+penalty(j,i,ct,data)));
+		e[1] = min(e[1],(v.f(i,j)+penalty(j,i,ct,data)));
 
-						if ((mod[i]||mod[j])&inc[ct->numseq[i+1]][ct->numseq[j-1]]&&!(fce.f(i,j)&SINGLE)) {
+		if ((mod[i]||mod[j])&inc[ct->numseq[i+1]][ct->numseq[j-1]]&&!(fce.f(i,j)&SINGLE)) {
 
-							e[1] = min((v.f(i+1,j-1)+penalty(j,i,ct,data)+erg1(i,j,i+1,j-1,ct,data)),e[1]);			
+			e[1] = min((v.f(i+1,j-1)+penalty(j,i,ct,data)+erg1<bonus>(i,j,i+1,j-1,ct,data)),e[1]);			
 
-						}
+		}
 
-						w2->f(i,j) = min(e[1],e[2]);
-						w2->f(i,j) = min(w2->f(i,j),e[3]);
-						w2->f(i,j) = min(w2->f(i,j),e[4]);
-						w2->f(i,j) = min(w2->f(i,j),e[5]);
+		w2->f(i,j) = min(e[1],e[2]);
+		w2->f(i,j) = min(w2->f(i,j),e[3]);
+		w2->f(i,j) = min(w2->f(i,j),e[4]);
+		w2->f(i,j) = min(w2->f(i,j),e[5]);
 
-					}
+	}
 
-					/*if (((j-i-1)>(2*minloop+2))||(j>(number))) {
-					// search for an open bifuraction:
-					for (k=i;k<=j-1;k++) {
-					if (k==(number)) w.f(i,j)=min(w.f(i,j),
-					w3[i]+w5[j-(number)]);
-					else w.f(i,j) = min(w.f(i,j),
-					w.f(i,k)+work[k+1][j%3]);
-					}
-					}  */
-					////fill wmb:
+	/*if (((j-i-1)>(2*minloop+2))||(j>(number))) {
+	// search for an open bifuraction:
+	for (k=i;k<=j-1;k++) {
+	if (k==(number)) w.f(i,j)=min(w.f(i,j),
+	w3[i]+w5[j-(number)]);
+	else w.f(i,j) = min(w.f(i,j),
+	w.f(i,k)+work[k+1][j%3]);
+	}
+	}  */
+	////fill wmb:
 
-					if (((j-i-1)>(2*minloop+2))||j>number) {
+	if (((j-i-1)>(2*minloop+2))||j>number) {
 
-						//search for an open bifurcation:
-						
-						//in this code, the w arrays are accessed directly, and not through the f function
-						int end=min(number,j);
-						for (k=i;k<end;++k) {
-							wmb.f(i,j) = min(wmb.f(i,j),w.dg[i][k]+w.dg[k+1][j]);
-						}		
-						for (k=number;k<j;++k) {
-							wmb.f(i,j) = min(wmb.f(i,j),w.dg[i][k]+w.dg[k+1-number][j-number]);
-						}
+		//search for an open bifurcation:
+		
+		//in this code, the w arrays are accessed directly, and not through the f function;
+		//w(i,k) is read along row i and w(k+1,j) down column j, through its mirror wcol
+		int end=min(number,j);
+		wmb.f(i,j) = minplus(&w.dg[i][i],&wcol[j][i+1],end-i,wmb.f(i,j));
+		if (j>number) {
+			wmb.f(i,j) = minplus(&w.dg[i][number],&wcol[j-number][1],j-number,wmb.f(i,j));
+		}
 
 
-						
+		
 
-						//for the sake of coaxial stacking, also consider the addition of nucs
-						//to a previously calculated wmb
-						if (i!=number)
-							if (!lfce[i]) wmb.f(i,j) = min(wmb.f(i,j) ,wmb.f(i+1,j) +data->eparam[6]+ ct->SHAPEss_give_value(i));
-						if (j!=number+1)
-							if (!lfce[j]) wmb.f(i,j)  = min(wmb.f(i,j) ,wmb.f(i,j-1) +data->eparam[6]+ ct->SHAPEss_give_value(j));
+		//for the sake of coaxial stacking, also consider the addition of nucs
+		//to a previously calculated wmb
+		if (i!=number)
+			if (!lfce[i]) wmb.f(i,j) = min(wmb.f(i,j) ,wmb.f(i+1,j) +data->eparam[6]+ SHAPEss<shaped>(ct,i));
+		if (j!=number+1)
+			if (!lfce[j]) wmb.f(i,j)  = min(wmb.f(i,j) ,wmb.f(i,j-1) +data->eparam[6]+ SHAPEss<shaped>(ct,j));
 
-						e[1]=INFINITE_ENERGY;
-						e[2]=INFINITE_ENERGY;
-						//also consider the coaxial stacking of two helixes
+		e[1]=INFINITE_ENERGY;
+		e[2]=INFINITE_ENERGY;
+		//also consider the coaxial stacking of two helixes
 #ifndef disablecoax
-						for (ip=i+minloop+1;ip<j-minloop-1;ip++) {
-							//first consider flush stacking
+		for (ip=i+minloop+1;ip<j-minloop-1;ip++) {
+			//when pruning, skip the pairs of helices that include a removed exterior fragment
+			if (s.prune&&j>number&&((pruned(v.f(i,ip))&&pruned(v.f(i+1,ip)))
+				||(pruned(v.f(ip+1,j))&&pruned(v.f(ip+2,j-1))&&pruned(v.f(ip+2,j))))) continue;
 
+			//first consider flush stacking
 
-							if (ip!=number) {
-								if (inc[ct->numseq[i]][ct->numseq[ip]]&&inc[ct->numseq[j]][ct->numseq[ip+1]]) {
-									//ony proceed if i and ip and ip+1 and j can pair
-									e[1]=min(e[1],v.f(i,ip)+v.f(ip+1,j)+penalty(i,ip,ct,data)
-											+penalty(ip+1,j,ct,data)+ergcoaxflushbases(i,ip,ip+1,j,ct,data));
 
-									if (mod[i]||mod[ip]||mod[ip+1]||mod[j]) {
+			if (ip!=number) {
+				if (inc[ct->numseq[i]][ct->numseq[ip]]&&inc[ct->numseq[j]][ct->numseq[ip+1]]) {
+					//ony proceed if i and ip and ip+1 and j can pair
+					e[1]=min(e[1],v.f(i,ip)+v.f(ip+1,j)+penalty(i,ip,ct,data)
+							+penalty(ip+1,j,ct,data)+ergcoaxflushbases(i,ip,ip+1,j,ct,data));
 
-										if ((mod[i]||mod[ip])&&(mod[ip+1]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
-												&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&!(fce.f(i,ip)&SINGLE)&&!(fce.f(ip+1,j)&SINGLE)) {
+					if (mod[i]||mod[ip]||mod[ip+1]||mod[j]) {
 
-											e[1]=min(e[1],v.f(i+1,ip-1)+v.f(ip+2,j-1)+penalty(i,ip,ct,data)
-													+penalty(ip+1,j,ct,data)+ergcoaxflushbases(i,ip,ip+1,j,ct,data)
-													+erg1(i,ip,i+1,ip-1,ct,data)+erg1(ip+1,j,ip+2,j-1,ct,data));
-										}
+						if ((mod[i]||mod[ip])&&(mod[ip+1]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
+								&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&!(fce.f(i,ip)&SINGLE)&&!(fce.f(ip+1,j)&SINGLE)) {
 
-										if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&!(fce.f(i,ip)&SINGLE)) {
+							e[1]=min(e[1],v.f(i+1,ip-1)+v.f(ip+2,j-1)+penalty(i,ip,ct,data)
+									+penalty(ip+1,j,ct,data)+ergcoaxflushbases(i,ip,ip+1,j,ct,data)
+									+erg1<bonus>(i,ip,i+1,ip-1,ct,data)+erg1<bonus>(ip+1,j,ip+2,j-1,ct,data));
+						}
 
-											e[1]=min(e[1],v.f(i+1,ip-1)+v.f(ip+1,j)+penalty(i,ip,ct,data)
-													+penalty(ip+1,j,ct,data)+ergcoaxflushbases(i,ip,ip+1,j,ct,data)
-													+erg1(i,ip,i+1,ip-1,ct,data));
-										}
+						if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&!(fce.f(i,ip)&SINGLE)) {
 
-										if ((mod[ip+1]||mod[j])&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&!(fce.f(ip+1,j)&SINGLE)) {
+							e[1]=min(e[1],v.f(i+1,ip-1)+v.f(ip+1,j)+penalty(i,ip,ct,data)
+									+penalty(ip+1,j,ct,data)+ergcoaxflushbases(i,ip,ip+1,j,ct,data)
+									+erg1<bonus>(i,ip,i+1,ip-1,ct,data));
+						}
 
+						if ((mod[ip+1]||mod[j])&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&!(fce.f(ip+1,j)&SINGLE)) {
 
-											e[1]=min(e[1],v.f(i,ip)+v.f(ip+2,j-1)+penalty(i,ip,ct,data)
-													+penalty(ip+1,j,ct,data)+ergcoaxflushbases(i,ip,ip+1,j,ct,data)
-													+erg1(ip+1,j,ip+2,j-1,ct,data));
 
-										}
-									}
-								}//end (inc[ct->numseq[i]][ct->numseq[ip]]&&inc[ct->numseq[j]][ct->numseq[ip+1]]) 
+							e[1]=min(e[1],v.f(i,ip)+v.f(ip+2,j-1)+penalty(i,ip,ct,data)
+									+penalty(ip+1,j,ct,data)+ergcoaxflushbases(i,ip,ip+1,j,ct,data)
+									+erg1<bonus>(ip+1,j,ip+2,j-1,ct,data));
+
+						}
+					}
+				}//end (inc[ct->numseq[i]][ct->numseq[ip]]&&inc[ct->numseq[j]][ct->numseq[ip+1]]) 
 
-								if (ip+1!=number) {
-									if (inc[ct->numseq[i]][ct->numseq[ip]]&&inc[ct->numseq[j-1]][ct->numseq[ip+2]]) {
-										//only proceed if i and ip and j-1 and ip+2 can pair
-										if (!lfce[ip+1]&&!lfce[j]) {
-											//now consider an intervening mismatch
-										
-											e[2]=min(e[2],v.f(i,ip)+v.f(ip+2,j-1)+penalty(i,ip,ct,data)
-													+penalty(ip+2,j-1,ct,data)+ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
-													);
+				if (ip+1!=number) {
+					if (inc[ct->numseq[i]][ct->numseq[ip]]&&inc[ct->numseq[j-1]][ct->numseq[ip+2]]) {
+						//only proceed if i and ip and j-1 and ip+2 can pair
+						if (!lfce[ip+1]&&!lfce[j]) {
+							//now consider an intervening mismatch
+						
+							e[2]=min(e[2],v.f(i,ip)+v.f(ip+2,j-1)+penalty(i,ip,ct,data)
+									+penalty(ip+2,j-1,ct,data)+ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
+									);
 
-											if (mod[i]||mod[ip]||mod[ip+2]||mod[j-1]) {
-												if ((mod[i]||mod[ip])&&(mod[ip+2]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
-														&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&!(fce.f(i,ip)&SINGLE)&&!(fce.f(ip+2,j-1)&SINGLE)) {
+							if (mod[i]||mod[ip]||mod[ip+2]||mod[j-1]) {
+								if ((mod[i]||mod[ip])&&(mod[ip+2]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
+										&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&!(fce.f(i,ip)&SINGLE)&&!(fce.f(ip+2,j-1)&SINGLE)) {
 
-													if(!lfce[ip+1]&&!lfce[j]) e[2]=min(e[2],v.f(i+1,ip-1)+v.f(ip+3,j-2)+penalty(i,ip,ct,data)
-															+penalty(ip+2,j-1,ct,data)+ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
-															+erg1(i,ip,i+1,ip-1,ct,data)+erg1(ip+2,j-1,ip+3,j-2,ct,data)
-															);
+									if(!lfce[ip+1]&&!lfce[j]) e[2]=min(e[2],v.f(i+1,ip-1)+v.f(ip+3,j-2)+penalty(i,ip,ct,data)
+											+penalty(ip+2,j-1,ct,data)+ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
+											+erg1<bonus>(i,ip,i+1,ip-1,ct,data)+erg1<bonus>(ip+2,j-1,ip+3,j-2,ct,data)
+											);
 
 
-												}
+								}
 
-												if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&!(fce.f(i,ip)&SINGLE)) {
+								if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&!(fce.f(i,ip)&SINGLE)) {
 
-													if(!lfce[ip+1]&&!lfce[j]) e[2]=min(e[2],v.f(i+1,ip-1)+v.f(ip+2,j-1)+penalty(i,ip,ct,data)
-															+penalty(ip+2,j-1,ct,data)+ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
-															+erg1(i,ip,i+1,ip-1,ct,data));
+									if(!lfce[ip+1]&&!lfce[j]) e[2]=min(e[2],v.f(i+1,ip-1)+v.f(ip+2,j-1)+penalty(i,ip,ct,data)
+											+penalty(ip+2,j-1,ct,data)+ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
+											+erg1<bonus>(i,ip,i+1,ip-1,ct,data));
 
 
-												}
+								}
 
-												if ((mod[ip+2]||mod[j-1])&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&!(fce.f(ip+2,j-1)&SINGLE)) {
+								if ((mod[ip+2]||mod[j-1])&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&!(fce.f(ip+2,j-1)&SINGLE)) {
 
 
-													if(!lfce[ip+1]&&!lfce[j]) e[2]=min(e[2],v.f(i,ip)+v.f(ip+3,j-2)+penalty(i,ip,ct,data)
-															+penalty(ip+2,j-1,ct,data)+ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
-															+erg1(ip+2,j-1,ip+3,j-2,ct,data));
+									if(!lfce[ip+1]&&!lfce[j]) e[2]=min(e[2],v.f(i,ip)+v.f(ip+3,j-2)+penalty(i,ip,ct,data)
+											+penalty(ip+2,j-1,ct,data)+ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
+											+erg1<bonus>(ip+2,j-1,ip+3,j-2,ct,data));
 
-												}
-											}
-										}//end (!lfce[ip+1]&&!lfce[j])
-									}//end (inc[ct->numseq[i]][ct->numseq[ip]]&&inc[ct->numseq[j-1]][ct->numseq[ip+2]])
+								}
+							}
+						}//end (!lfce[ip+1]&&!lfce[j])
+					}//end (inc[ct->numseq[i]][ct->numseq[ip]]&&inc[ct->numseq[j-1]][ct->numseq[ip+2]])
 
 
-									if (inc[ct->numseq[i+1]][ct->numseq[ip]]&&inc[ct->numseq[j]][ct->numseq[ip+2]]) {
-										//only proceed if i and ip j and ip+2 can pair
-										if(!lfce[i]&&!lfce[ip+1]&&i!=number) {
-											e[2]=min(e[2],v.f(i+1,ip)+v.f(ip+2,j)+penalty(i+1,ip,ct,data)
-													+penalty(ip+2,j,ct,data)+ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
-												);
+					if (inc[ct->numseq[i+1]][ct->numseq[ip]]&&inc[ct->numseq[j]][ct->numseq[ip+2]]) {
+						//only proceed if i and ip j and ip+2 can pair
+						if(!lfce[i]&&!lfce[ip+1]&&i!=number) {
+							e[2]=min(e[2],v.f(i+1,ip)+v.f(ip+2,j)+penalty(i+1,ip,ct,data)
+									+penalty(ip+2,j,ct,data)+ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
+								);
 
-											if (mod[i+1]||mod[ip]||mod[ip+2]||mod[j]) {
-												if ((mod[i+1]||mod[ip])&&(mod[ip+2]||mod[j])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]
-														&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&!(fce.f(i+1,ip)&SINGLE)&&!(fce.f(ip+2,j)&SINGLE)) {
+							if (mod[i+1]||mod[ip]||mod[ip+2]||mod[j]) {
+								if ((mod[i+1]||mod[ip])&&(mod[ip+2]||mod[j])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]
+										&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&!(fce.f(i+1,ip)&SINGLE)&&!(fce.f(ip+2,j)&SINGLE)) {
 
-													e[2]=min(e[2],v.f(i+2,ip-1)+v.f(ip+3,j-1)+penalty(i+1,ip,ct,data)
-															+penalty(ip+2,j,ct,data)+ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
-															+erg1(i+1,ip,i+2,ip-1,ct,data)+erg1(ip+2,j,ip+3,j-1,ct,data)
-														);	
+									e[2]=min(e[2],v.f(i+2,ip-1)+v.f(ip+3,j-1)+penalty(i+1,ip,ct,data)
+											+penalty(ip+2,j,ct,data)+ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
+											+erg1<bonus>(i+1,ip,i+2,ip-1,ct,data)+erg1<bonus>(ip+2,j,ip+3,j-1,ct,data)
+										);	
 
 
 
-												}
-												if ((mod[i+1]||mod[ip])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&!(fce.f(i+1,ip)&SINGLE)) {
+								}
+								if ((mod[i+1]||mod[ip])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&!(fce.f(i+1,ip)&SINGLE)) {
 
-													e[2]=min(e[2],v.f(i+2,ip-1)+v.f(ip+2,j)+penalty(i+1,ip,ct,data)
-															+penalty(ip+2,j,ct,data)+ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
-															+erg1(i+1,ip,i+2,ip-1,ct,data)
-														);
+									e[2]=min(e[2],v.f(i+2,ip-1)+v.f(ip+2,j)+penalty(i+1,ip,ct,data)
+											+penalty(ip+2,j,ct,data)+ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
+											+erg1<bonus>(i+1,ip,i+2,ip-1,ct,data)
+										);
 
 
-												}
+								}
 
-												if ((mod[ip+2]||mod[j])&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&!(fce.f(ip+2,j)&SINGLE)) {
+								if ((mod[ip+2]||mod[j])&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&!(fce.f(ip+2,j)&SINGLE)) {
 
 
-													e[2]=min(e[2],v.f(i+1,ip)+v.f(ip+3,j-1)+penalty(i+1,ip,ct,data)
-															+penalty(ip+2,j,ct,data)+ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
-															+erg1(ip+2,j,ip+3,j-1,ct,data)
-														);
+									e[2]=min(e[2],v.f(i+1,ip)+v.f(ip+3,j-1)+penalty(i+1,ip,ct,data)
+											+penalty(ip+2,j,ct,data)+ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
+											+erg1<bonus>(ip+2,j,ip+3,j-1,ct,data)
+										);
 
-												}
-											}
-										}
-									}//end (inc[ct->numseq[i+1]][ct->numseq[ip]]&&inc[ct->numseq[j]][ct->numseq[ip+2]]) 
 								}
 							}
+						}
+					}//end (inc[ct->numseq[i+1]][ct->numseq[ip]]&&inc[ct->numseq[j]][ct->numseq[ip+2]]) 
+				}
+			}
 
 
 
-						}
+		}
 #endif //ifndef disablecoax
 
-						wmb.f(i,j) =min(wmb.f(i,j) ,e[1]+2*data->eparam[10]);
-						wmb.f(i,j) =min(wmb.f(i,j) ,e[2]+2*data->eparam[10]+2*data->eparam[6]);
+		wmb.f(i,j) =min(wmb.f(i,j) ,e[1]+2*data->eparam[10]);
+		wmb.f(i,j) =min(wmb.f(i,j) ,e[2]+2*data->eparam[10]+2*data->eparam[6]);
 
-						if (j<=number)
-							wca[i][j] = min(e[1],e[2]);
+		if (j<=number)
+			wca[i][j] = min(e[1],e[2]);
 
 
-						w.f(i,j) = min(w.f(i,j),wmb.f(i,j) );
+		w.f(i,j) = min(w.f(i,j),wmb.f(i,j) );
 
-						if (ct->intermolecular) {
-							//intermolecular folding:
+		if ((intermolecular&&ct->intermolecular)) {
+			//intermolecular folding:
 
-							//search for an open bifurcation:
-							for (k=i;k<=j;k++) {
+			//search for an open bifurcation:
+			for (k=i;k<=j;k++) {
 
-								if (k!=number) wmb2->f(i,j) = min(wmb2->f(i,j),w2->f(i,k)+w2->f(k+1,j));
-							}
+				if (k!=number) wmb2->f(i,j) = min(wmb2->f(i,j),w2->f(i,k)+w2->f(k+1,j));
+			}
 
-							if (i!=number) {
-								if (!(fce.f(i,i)&INTER)) wmb2->f(i,j) = min(wmb2->f(i,j) ,wmb2->f(i+1,j) );
-								else  wmb2->f(i,j) = min(wmb2->f(i,j) ,wmb2->f(i+1,j) + data->init - INFINITE_ENERGY);
-							}
+			if (i!=number) {
+				if (!(fce.f(i,i)&INTER)) wmb2->f(i,j) = min(wmb2->f(i,j) ,wmb2->f(i+1,j) );
+				else  wmb2->f(i,j) = min(wmb2->f(i,j) ,wmb2->f(i+1,j) + data->init - INFINITE_ENERGY);
+			}
 
-							if (j!=number+1) {
-								if (!(fce.f(j,j)&INTER)) wmb2->f(i,j)  = min(wmb2->f(i,j) ,wmb2->f(i,j-1));
-								else wmb2->f(i,j)  = min(wmb2->f(i,j) ,wmb2->f(i,j-1) +data->init-INFINITE_ENERGY);
-							}
+			if (j!=number+1) {
+				if (!(fce.f(j,j)&INTER)) wmb2->f(i,j)  = min(wmb2->f(i,j) ,wmb2->f(i,j-1));
+				else wmb2->f(i,j)  = min(wmb2->f(i,j) ,wmb2->f(i,j-1) +data->init-INFINITE_ENERGY);
+			}
 
 
-							w2->f(i,j) = min(w2->f(i,j),wmb2->f(i,j) );
+			w2->f(i,j) = min(w2->f(i,j),wmb2->f(i,j) );
 
-						}
+		}
 
 
-					}
+	}
 
 
 
@@ -4698,78 +4771,95 @@ d = j - i;
 
 sub3:
 
-					//Calculate vmin, the best energy for the entire sequence
-					if (j>(number)) {
-						//FD
-						//vmin = min(vmin,v.f(i,j)+v.f(j-(number),i)-SHAPEendPair(i,j,ct));
-						if(v.f(i,j) == v2.f(i,j) && v.f(j-(number),i) == v2.f(j-(number),i))
-							vmin = min(vmin, v.f(i,j) + v.f(j-(number),i)- SHAPEendPair(i,j,ct) + ct->SHAPEdiff_give_value(i) + ct->SHAPEdiff_give_value(j));
-						else
-							vmin = min(vmin, v.f(i,j) + v.f(j-(number),i) - SHAPEendPair(i,j,ct));
-					}
+	//w(i,j) is now final
+	if (d<=band) wcol[j][i] = w.f(i,j);
 
-					//Compute w5[i], the energy of the best folding from 1->i, and
-					//w3[i], the energy of the best folding from i-->GetSequenceLength()
-					if (i==1&&j<=number)
-					{  
-						if (j<=minloop+1) {
-							if (lfce[j]) w5[j]= INFINITE_ENERGY;
-							else  w5[j] = w5[j-1]+ ct->SHAPEss_give_value(j);
-						}
+	//Calculate vmin, the best energy for the entire sequence
+	if (j>(number)) {
+		//FD
+		//vmin = min(vmin,v.f(i,j)+v.f(j-(number),i)-SHAPEpair<shaped>(i,j,ct));
+		int localvmin;
+		if(v.f(i,j) == v2.f(i,j) && v.f(j-(number),i) == v2.f(j-(number),i))
+			localvmin = v.f(i,j) + v.f(j-(number),i)- SHAPEpair<shaped>(i,j,ct) + SHAPEdiff<shaped>(ct,i) + SHAPEdiff<shaped>(ct,j);
+		else
+			localvmin = v.f(i,j) + v.f(j-(number),i) - SHAPEpair<shaped>(i,j,ct);
+		if (localvmin<vmin) {
+#ifdef SMP
+#pragma omp critical
+#endif
+			vmin = min(vmin, localvmin);
+		}
 
-						else {
-							if (lfce[j]) w5[j] = INFINITE_ENERGY;
+		//the lowest structure that contains j-number,i is above critbound
+		if (s.prune&&localvmin-s.pairslack>s.critbound) {
+			v.f(i,j) = INFINITE_ENERGY;
+			v1.f(i,j) = INFINITE_ENERGY;
+			v2.f(i,j) = INFINITE_ENERGY;
+		}
+	}
 
-							else w5[j] = w5[j-1] + ct->SHAPEss_give_value(j);
+	//Compute w5[i], the energy of the best folding from 1->i, and
+	//w3[i], the energy of the best folding from i-->GetSequenceLength()
+	if (i==1&&j<=number)
+	{  
+		if (j<=minloop+1) {
+			if (lfce[j]) w5[j]= INFINITE_ENERGY;
+			else  w5[j] = w5[j-1]+ SHAPEss<shaped>(ct,j);
+		}
 
-							for (k=1;k<=5;k++) e[k] = INFINITE_ENERGY;//e[k]=0;
+		else {
+			if (lfce[j]) w5[j] = INFINITE_ENERGY;
+
+			else w5[j] = w5[j-1] + SHAPEss<shaped>(ct,j);
+
+			for (k=1;k<=5;k++) e[k] = INFINITE_ENERGY;//e[k]=0;
 #ifndef disablecoax
-							castack = INFINITE_ENERGY;
+			castack = INFINITE_ENERGY;
 #endif //ifndef disablecoax
-							for (k=0;k<=(j-4);k++) {
+			for (k=max(0,j-band-1);k<=(j-4);k++) {
 
-								e[1] = min(e[1],(w5[k]+v.f(k+1,j)+penalty(j,k+1,ct,data)));
+				e[1] = min(e[1],(w5[k]+v.f(k+1,j)+penalty(j,k+1,ct,data)));
 
-								if ((mod[k+1]||mod[j])&&inc[ct->numseq[k+2]][ct->numseq[j-1]]&&!(fce.f(k+1,j)&SINGLE)) {
+				if ((mod[k+1]||mod[j])&&inc[ct->numseq[k+2]][ct->numseq[j-1]]&&!(fce.f(k+1,j)&SINGLE)) {
 
-									e[1] = min(e[1],(w5[k]+v.f(k+2,j-1)+penalty(j,k+1,ct,data)
-												+erg1(k+1,j,k+2,j-1,ct,data)));
-								}
+					e[1] = min(e[1],(w5[k]+v.f(k+2,j-1)+penalty(j,k+1,ct,data)
+								+erg1<bonus>(k+1,j,k+2,j-1,ct,data)));
+				}
 
 
 
-								e[2] = min(e[2],(w5[k]+erg4(j,k+2,k+1,2,ct,data,lfce[k+1])+v.f(k+2,j)+penalty(j,k+2,ct,data)));
+				e[2] = min(e[2],(w5[k]+erg4(j,k+2,k+1,2,ct,data,lfce[k+1])+v.f(k+2,j)+penalty(j,k+2,ct,data)));
 
-								if((mod[k+2]||mod[j])&&inc[ct->numseq[k+3]][ct->numseq[j-1]]&&!(fce.f(k+2,j)&SINGLE)) {
-									e[2] = min(e[2],(w5[k]+erg4(j,k+2,k+1,2,ct,data,lfce[k+1])+v.f(k+3,j-1)
-												+penalty(j,k+2,ct,data)+erg1(k+2,j,k+3,j-1,ct,data)));
+				if((mod[k+2]||mod[j])&&inc[ct->numseq[k+3]][ct->numseq[j-1]]&&!(fce.f(k+2,j)&SINGLE)) {
+					e[2] = min(e[2],(w5[k]+erg4(j,k+2,k+1,2,ct,data,lfce[k+1])+v.f(k+3,j-1)
+								+penalty(j,k+2,ct,data)+erg1<bonus>(k+2,j,k+3,j-1,ct,data)));
 
-								}
+				}
 
 
-								e[3] = min(e[3],(w5[k]+erg4(j-1,k+1,j,1,ct,data,lfce[j])+v.f(k+1,j-1)+penalty(j-1,k+1,ct,data)));
+				e[3] = min(e[3],(w5[k]+erg4(j-1,k+1,j,1,ct,data,lfce[j])+v.f(k+1,j-1)+penalty(j-1,k+1,ct,data)));
 
-								if ((mod[k+1]||mod[j-1])&&inc[ct->numseq[k+2]][ct->numseq[j-2]]&&!(fce.f(k+1,j-1)&SINGLE)) {
+				if ((mod[k+1]||mod[j-1])&&inc[ct->numseq[k+2]][ct->numseq[j-2]]&&!(fce.f(k+1,j-1)&SINGLE)) {
 
-									e[3] = min(e[3],(w5[k]+erg4(j-1,k+1,j,1,ct,data,lfce[j])+v.f(k+2,j-2)
-												+penalty(j-1,k+1,ct,data)+erg1(k+1,j-1,k+2,j-2,ct,data)));
-								}
+					e[3] = min(e[3],(w5[k]+erg4(j-1,k+1,j,1,ct,data,lfce[j])+v.f(k+2,j-2)
+								+penalty(j-1,k+1,ct,data)+erg1<bonus>(k+1,j-1,k+2,j-2,ct,data)));
+				}
 
 
 
-								e[4] = min(e[4],(w5[k]+data->tstack[ct->numseq[j-1]][ct->numseq[k+2]]
-											[ct->numseq[j]][ct->numseq[k+1]] 
-											+checknp(lfce[j],lfce[k+1]) + v.f(k+2,j-1)+
-											penalty(j-1,k+2,ct,data))+ ct->SHAPEss_give_value(j)+ ct->SHAPEss_give_value(k+1));
+				e[4] = min(e[4],(w5[k]+data->tstack[ct->numseq[j-1]][ct->numseq[k+2]]
+							[ct->numseq[j]][ct->numseq[k+1]] 
+							+checknp(lfce[j],lfce[k+1]) + v.f(k+2,j-1)+
+							penalty(j-1,k+2,ct,data))+ SHAPEss<shaped>(ct,j)+ SHAPEss<shaped>(ct,k+1));
 
-								if ((mod[k+2]||mod[j-1])&&inc[ct->numseq[k+3]][ct->numseq[j-2]]&&!(fce.f(k+2,j-1)&SINGLE)) {
+				if ((mod[k+2]||mod[j-1])&&inc[ct->numseq[k+3]][ct->numseq[j-2]]&&!(fce.f(k+2,j-1)&SINGLE)) {
 
-									e[4] = min(e[4],(w5[k]+data->tstack[ct->numseq[j-1]][ct->numseq[k+2]]
-												[ct->numseq[j]][ct->numseq[k+1]] 
-												+checknp(lfce[j],lfce[k+1]) + v.f(k+3,j-2)+
-												penalty(j-1,k+2,ct,data)+erg1(k+2,j-1,k+3,j-2,ct,data))+ ct->SHAPEss_give_value(j)+ ct->SHAPEss_give_value(k+1));
+					e[4] = min(e[4],(w5[k]+data->tstack[ct->numseq[j-1]][ct->numseq[k+2]]
+								[ct->numseq[j]][ct->numseq[k+1]] 
+								+checknp(lfce[j],lfce[k+1]) + v.f(k+3,j-2)+
+								penalty(j-1,k+2,ct,data)+erg1<bonus>(k+2,j-1,k+3,j-2,ct,data))+ SHAPEss<shaped>(ct,j)+ SHAPEss<shaped>(ct,k+1));
 
-								}
+				}
 
 
 
@@ -4778,316 +4868,652 @@ sub3:
 
 
 #ifndef disablecoax
-								castack = min(castack,w5[k]+wca[k+1][j]);
+				castack = min(castack,w5[k]+wca[k+1][j]);
 #endif //ifndef disablecoax
 
 
-							}
-							w5[j] = min(w5[j],e[1]);
-							w5[j] = min(w5[j],e[2]);
-							w5[j] = min(w5[j],e[3]);
-							w5[j] = min(w5[j],e[4]);
+			}
+			w5[j] = min(w5[j],e[1]);
+			w5[j] = min(w5[j],e[2]);
+			w5[j] = min(w5[j],e[3]);
+			w5[j] = min(w5[j],e[4]);
 #ifndef disablecoax
-							w5[j] = min(w5[j],castack);
+			w5[j] = min(w5[j],castack);
 #endif //ifndef disablecoax
 
-						}		
-					}	
+		}		
+	}	
 
-					if (j==number)
-					{	
-						w3[0] = 0;
-						w3[number+1] = 0;
-						if (i>=(number-minloop)) {    //number+1 ... number-minloop
-							if (lfce[i]) w3[i] = INFINITE_ENERGY;
-							else w3[i]=w3[i+1]+ ct->SHAPEss_give_value(i);
-						}
-						//w3[i]=0;
-						if (i>=1&&i<=((number)-minloop-1)) {
+	if (j==number)
+	{	
+		w3[0] = 0;
+		w3[number+1] = 0;
+		if (i>=(number-minloop)) {    //number+1 ... number-minloop
+			if (lfce[i]) w3[i] = INFINITE_ENERGY;
+			else w3[i]=w3[i+1]+ SHAPEss<shaped>(ct,i);
+		}
+		//w3[i]=0;
+		if (i>=1&&i<=((number)-minloop-1)) {
 
-							if (lfce[i]) w3[i] = INFINITE_ENERGY;
+			if (lfce[i]) w3[i] = INFINITE_ENERGY;
 
-							else w3[i] = w3[i+1]+ ct->SHAPEss_give_value(i);
+			else w3[i] = w3[i+1]+ SHAPEss<shaped>(ct,i);
 
-							for (k=1;k<=5;k++) e[k] = INFINITE_ENERGY;
+			for (k=1;k<=5;k++) e[k] = INFINITE_ENERGY;
 #ifndef disablecoax
-							castack = INFINITE_ENERGY;
+			castack = INFINITE_ENERGY;
 #endif //ifndef disablecoax
-							for (k=((number)+1);k>=(i+4);k--) {
-								e[1] = min(e[1],(v.f(i,k-1)+w3[k]+penalty(k-1,i,ct,data)));
+			//the pairs read below start within two nucleotides of i (or of k) and span less than the limit
+			for (k=min(number+1,i+limit+4);k>=(i+4);k--) {
+				e[1] = min(e[1],(v.f(i,k-1)+w3[k]+penalty(k-1,i,ct,data)));
 
-								if((mod[i]||mod[k-1])&&inc[ct->numseq[i+1]][ct->numseq[k-2]]&&!(fce.f(i,k-1)&SINGLE)) {
+				if((mod[i]||mod[k-1])&&inc[ct->numseq[i+1]][ct->numseq[k-2]]&&!(fce.f(i,k-1)&SINGLE)) {
 
-									e[1] = min(e[1],(v.f(i+1,k-2)+w3[k]+penalty(k-1,i,ct,data)+erg1(i,k-1,i+1,k-2,ct,data)));
+					e[1] = min(e[1],(v.f(i+1,k-2)+w3[k]+penalty(k-1,i,ct,data)+erg1<bonus>(i,k-1,i+1,k-2,ct,data)));
 
-								}
+				}
 
-								e[2] = min(e[2],(v.f(i+1,k-1)+erg4(k-1,i+1,i,2,ct,data,lfce[i])+penalty(k-1,i+1,ct,data) + w3[k])
-									  );
+				e[2] = min(e[2],(v.f(i+1,k-1)+erg4(k-1,i+1,i,2,ct,data,lfce[i])+penalty(k-1,i+1,ct,data) + w3[k])
+					  );
 
-								if((mod[i+1]||mod[k-1])&&inc[ct->numseq[i+2]][ct->numseq[k-2]]&&!(fce.f(i+1,k-1)&SINGLE)) {
+				if((mod[i+1]||mod[k-1])&&inc[ct->numseq[i+2]][ct->numseq[k-2]]&&!(fce.f(i+1,k-1)&SINGLE)) {
 
-									e[2] = min(e[2],(v.f(i+2,k-2)+erg4(k-1,i+1,i,2,ct,data,lfce[i])+
-												penalty(k-1,i+1,ct,data) + w3[k]+erg1(i+1,k-1,i+2,k-2,ct,data)));
+					e[2] = min(e[2],(v.f(i+2,k-2)+erg4(k-1,i+1,i,2,ct,data,lfce[i])+
+								penalty(k-1,i+1,ct,data) + w3[k]+erg1<bonus>(i+1,k-1,i+2,k-2,ct,data)));
 
-								}
+				}
 
-								e[3] = min(e[3],(v.f(i,k-2)+erg4(k-2,i,k-1,1,ct,data,lfce[k-1]) + penalty(k-2,i,ct,data) + w3[k])
-									  );
+				e[3] = min(e[3],(v.f(i,k-2)+erg4(k-2,i,k-1,1,ct,data,lfce[k-1]) + penalty(k-2,i,ct,data) + w3[k])
+					  );
 
-								if((mod[i]||mod[k-2])&&inc[ct->numseq[i+1]][ct->numseq[k-3]]&&!(fce.f(i,k-2)&SINGLE)) {
-									e[3] = min(e[3],(v.f(i+1,k-3)+erg4(k-2,i,k-1,1,ct,data,lfce[k-1]) + 
-												penalty(k-2,i,ct,data) + w3[k]+erg1(i,k-2,i+1,k-3,ct,data)));
+				if((mod[i]||mod[k-2])&&inc[ct->numseq[i+1]][ct->numseq[k-3]]&&!(fce.f(i,k-2)&SINGLE)) {
+					e[3] = min(e[3],(v.f(i+1,k-3)+erg4(k-2,i,k-1,1,ct,data,lfce[k-1]) + 
+								penalty(k-2,i,ct,data) + w3[k]+erg1<bonus>(i,k-2,i+1,k-3,ct,data)));
 
-								}
+				}
 
-								if (!lfce[i]&&!lfce[k-1]) {
-									e[4] = min(e[4],(v.f(i+1,k-2)+data->tstack[ct->numseq[k-2]][ct->numseq[i+1]]
-												[ct->numseq[k-1]][ct->numseq[i]]
-												+checknp(lfce[k-1],lfce[i])+w3[k]+
-												penalty(k-2,i+1,ct,data))+ ct->SHAPEss_give_value(i)+ ct->SHAPEss_give_value(k-1));
+				if (!lfce[i]&&!lfce[k-1]) {
+					e[4] = min(e[4],(v.f(i+1,k-2)+data->tstack[ct->numseq[k-2]][ct->numseq[i+1]]
+								[ct->numseq[k-1]][ct->numseq[i]]
+								+checknp(lfce[k-1],lfce[i])+w3[k]+
+								penalty(k-2,i+1,ct,data))+ SHAPEss<shaped>(ct,i)+ SHAPEss<shaped>(ct,k-1));
 
 
 
-									if((mod[i+1]||mod[k-2])&&inc[ct->numseq[i+2]][ct->numseq[k-3]]&&!(fce.f(i+1,k-2)&SINGLE)) {
-										e[4] = min(e[4],(v.f(i+2,k-3)+data->tstack[ct->numseq[k-2]][ct->numseq[i+1]]
-													[ct->numseq[k-1]][ct->numseq[i]]
-													+checknp(lfce[k-1],lfce[i])+w3[k]+
-													penalty(k-2,i+1,ct,data)+erg1(i+1,k-2,i+2,k-3,ct,data))
-												+ ct->SHAPEss_give_value(i)+ ct->SHAPEss_give_value(k-1));
+					if((mod[i+1]||mod[k-2])&&inc[ct->numseq[i+2]][ct->numseq[k-3]]&&!(fce.f(i+1,k-2)&SINGLE)) {
+						e[4] = min(e[4],(v.f(i+2,k-3)+data->tstack[ct->numseq[k-2]][ct->numseq[i+1]]
+									[ct->numseq[k-1]][ct->numseq[i]]
+									+checknp(lfce[k-1],lfce[i])+w3[k]+
+									penalty(k-2,i+1,ct,data)+erg1<bonus>(i+1,k-2,i+2,k-3,ct,data))
+								+ SHAPEss<shaped>(ct,i)+ SHAPEss<shaped>(ct,k-1));
 
 
-									}
-								}
+					}
+				}
 
-								//also consider coaxial stacking:
+				//also consider coaxial stacking:
 #ifndef disablecoax
-								for (ip=k+minloop+1;ip<=number+1;ip++) {
+				for (ip=k+minloop+1;ip<=min(number+1,k+limit+4);ip++) {
 
 
-									//first consider flush stacking:
-									castack=min(castack,v.f(i,k-1)+v.f(k,ip-1)+w3[ip]+
-											penalty(i,k-1,ct,data)+penalty(k,ip-1,ct,data)+
-											ergcoaxflushbases(i,k-1,k,ip-1,ct,data));
+					//first consider flush stacking:
+					castack=min(castack,v.f(i,k-1)+v.f(k,ip-1)+w3[ip]+
+							penalty(i,k-1,ct,data)+penalty(k,ip-1,ct,data)+
+							ergcoaxflushbases(i,k-1,k,ip-1,ct,data));
 
-									if(mod[i]||mod[k-1]||mod[k]||mod[ip-1]) {
+					if(mod[i]||mod[k-1]||mod[k]||mod[ip-1]) {
 
-										if ((mod[i]||mod[k-1])&&(mod[k]||mod[ip-1])&&inc[ct->numseq[i+1]][ct->numseq[k-2]]
-												&&inc[ct->numseq[k+1]][ct->numseq[ip-2]]&&!(fce.f(i,k-1)&SINGLE)&&!(fce.f(k,ip-1)&SINGLE)) {
-											castack=min(castack,v.f(i+1,k-2)+v.f(k+1,ip-2)+w3[ip]+
-													penalty(i,k-1,ct,data)+penalty(k,ip-1,ct,data)+
-													ergcoaxflushbases(i,k-1,k,ip-1,ct,data)
-													+erg1(i,k-1,i+1,k-2,ct,data)+erg1(k,ip-1,k+1,ip-2,ct,data));
-										}
-										if((mod[i]||mod[k-1])&&inc[ct->numseq[i+1]][ct->numseq[k-2]]&&!(fce.f(i,k-1)&SINGLE)) {
+						if ((mod[i]||mod[k-1])&&(mod[k]||mod[ip-1])&&inc[ct->numseq[i+1]][ct->numseq[k-2]]
+								&&inc[ct->numseq[k+1]][ct->numseq[ip-2]]&&!(fce.f(i,k-1)&SINGLE)&&!(fce.f(k,ip-1)&SINGLE)) {
+							castack=min(castack,v.f(i+1,k-2)+v.f(k+1,ip-2)+w3[ip]+
+									penalty(i,k-1,ct,data)+penalty(k,ip-1,ct,data)+
+									ergcoaxflushbases(i,k-1,k,ip-1,ct,data)
+									+erg1<bonus>(i,k-1,i+1,k-2,ct,data)+erg1<bonus>(k,ip-1,k+1,ip-2,ct,data));
+						}
+						if((mod[i]||mod[k-1])&&inc[ct->numseq[i+1]][ct->numseq[k-2]]&&!(fce.f(i,k-1)&SINGLE)) {
 
-											castack=min(castack,v.f(i+1,k-2)+v.f(k,ip-1)+w3[ip]+
-													penalty(i,k-1,ct,data)+penalty(k,ip-1,ct,data)+
-													ergcoaxflushbases(i,k-1,k,ip-1,ct,data)
-													+erg1(i,k-1,i+1,k-2,ct,data));
+							castack=min(castack,v.f(i+1,k-2)+v.f(k,ip-1)+w3[ip]+
+									penalty(i,k-1,ct,data)+penalty(k,ip-1,ct,data)+
+									ergcoaxflushbases(i,k-1,k,ip-1,ct,data)
+									+erg1<bonus>(i,k-1,i+1,k-2,ct,data));
 
-										}
+						}
 
-										if((mod[k]||mod[ip-1])&&inc[ct->numseq[k+1]][ct->numseq[ip-2]]&&!(fce.f(k,ip-1)&SINGLE)) {
+						if((mod[k]||mod[ip-1])&&inc[ct->numseq[k+1]][ct->numseq[ip-2]]&&!(fce.f(k,ip-1)&SINGLE)) {
 
-											castack=min(castack,v.f(i,k-1)+v.f(k+1,ip-2)+w3[ip]+
-													penalty(i,k-1,ct,data)+penalty(k,ip-1,ct,data)+
-													ergcoaxflushbases(i,k-1,k,ip-1,ct,data)
-													+erg1(k,ip-1,k+1,ip-2,ct,data));
-										}
+							castack=min(castack,v.f(i,k-1)+v.f(k+1,ip-2)+w3[ip]+
+									penalty(i,k-1,ct,data)+penalty(k,ip-1,ct,data)+
+									ergcoaxflushbases(i,k-1,k,ip-1,ct,data)
+									+erg1<bonus>(k,ip-1,k+1,ip-2,ct,data));
+						}
 
-									}
+					}
 
 
-									//now consider an intervening mismatch:
-									if (i>0&&!lfce[i]&&!lfce[k-1]) {
-										castack=min(castack,v.f(i+1,k-2)+v.f(k,ip-1)+w3[ip]+
-												penalty(i+1,k-2,ct,data)+penalty(k,ip-1,ct,data)+
-												ergcoaxinterbases1(i+1,k-2,k,ip-1,ct,data));
+					//now consider an intervening mismatch:
+					if (i>0&&!lfce[i]&&!lfce[k-1]) {
+						castack=min(castack,v.f(i+1,k-2)+v.f(k,ip-1)+w3[ip]+
+								penalty(i+1,k-2,ct,data)+penalty(k,ip-1,ct,data)+
+								ergcoaxinterbases1(i+1,k-2,k,ip-1,ct,data));
 
-										if(mod[i+1]||mod[k-2]||mod[k]||mod[ip-1]){
+						if(mod[i+1]||mod[k-2]||mod[k]||mod[ip-1]){
 
-											if((mod[i+1]||mod[k-2])&&(mod[k]||mod[ip-1])&&inc[ct->numseq[i+2]][ct->numseq[k-3]]
-													&&inc[ct->numseq[k+1]][ct->numseq[ip-2]]&&!(fce.f(i+1,k-2)&SINGLE)&&!(fce.f(k,ip-1)&SINGLE)){
-												castack=min(castack,v.f(i+2,k-3)+v.f(k+1,ip-2)+w3[ip]+
-														penalty(i+1,k-2,ct,data)+penalty(k,ip-1,ct,data)+
-														ergcoaxinterbases1(i+1,k-2,k,ip-1,ct,data)
-														+erg1(i+1,k-2,i+2,k-3,ct,data)+erg1(k,ip-1,k+1,ip-2,ct,data)
-													   );
+							if((mod[i+1]||mod[k-2])&&(mod[k]||mod[ip-1])&&inc[ct->numseq[i+2]][ct->numseq[k-3]]
+									&&inc[ct->numseq[k+1]][ct->numseq[ip-2]]&&!(fce.f(i+1,k-2)&SINGLE)&&!(fce.f(k,ip-1)&SINGLE)){
+								castack=min(castack,v.f(i+2,k-3)+v.f(k+1,ip-2)+w3[ip]+
+										penalty(i+1,k-2,ct,data)+penalty(k,ip-1,ct,data)+
+										ergcoaxinterbases1(i+1,k-2,k,ip-1,ct,data)
+										+erg1<bonus>(i+1,k-2,i+2,k-3,ct,data)+erg1<bonus>(k,ip-1,k+1,ip-2,ct,data)
+									   );
 
-											}
+							}
 
-											if((mod[i+1]||mod[k-2])&&inc[ct->numseq[i+2]][ct->numseq[k-3]]&&!(fce.f(i+1,k-2)&SINGLE)) {
-												castack=min(castack,v.f(i+2,k-3)+v.f(k,ip-1)+w3[ip]+
-														penalty(i+1,k-2,ct,data)+penalty(k,ip-1,ct,data)+
-														ergcoaxinterbases1(i+1,k-2,k,ip-1,ct,data)
-														+erg1(i+1,k-2,i+2,k-3,ct,data)
-													   );
+							if((mod[i+1]||mod[k-2])&&inc[ct->numseq[i+2]][ct->numseq[k-3]]&&!(fce.f(i+1,k-2)&SINGLE)) {
+								castack=min(castack,v.f(i+2,k-3)+v.f(k,ip-1)+w3[ip]+
+										penalty(i+1,k-2,ct,data)+penalty(k,ip-1,ct,data)+
+										ergcoaxinterbases1(i+1,k-2,k,ip-1,ct,data)
+										+erg1<bonus>(i+1,k-2,i+2,k-3,ct,data)
+									   );
 
-											}
-											if((mod[k]||mod[ip-1])&&inc[ct->numseq[k+1]][ct->numseq[ip-2]]&&!(fce.f(k,ip-1)&SINGLE)) {
-												castack=min(castack,v.f(i+1,k-2)+v.f(k+1,ip-2)+w3[ip]+
-														penalty(i+1,k-2,ct,data)+penalty(k,ip-1,ct,data)+
-														ergcoaxinterbases1(i+1,k-2,k,ip-1,ct,data)
-														+erg1(k,ip-1,k+1,ip-2,ct,data)
-													   );	
+							}
+							if((mod[k]||mod[ip-1])&&inc[ct->numseq[k+1]][ct->numseq[ip-2]]&&!(fce.f(k,ip-1)&SINGLE)) {
+								castack=min(castack,v.f(i+1,k-2)+v.f(k+1,ip-2)+w3[ip]+
+										penalty(i+1,k-2,ct,data)+penalty(k,ip-1,ct,data)+
+										ergcoaxinterbases1(i+1,k-2,k,ip-1,ct,data)
+										+erg1<bonus>(k,ip-1,k+1,ip-2,ct,data)
+									   );	
 
 
-											}
+							}
 
 
-										}
+						}
 
-									}
-									if (!lfce[k-1]&&!lfce[ip-1]) {
+					}
+					if (!lfce[k-1]&&!lfce[ip-1]) {
 
-										castack = min(castack,v.f(i,k-2)+v.f(k,ip-2)+w3[ip]+
-												penalty(i,k-2,ct,data)+penalty(k,ip-2,ct,data)+
-												ergcoaxinterbases2(i,k-2,k,ip-2,ct,data));
+						castack = min(castack,v.f(i,k-2)+v.f(k,ip-2)+w3[ip]+
+								penalty(i,k-2,ct,data)+penalty(k,ip-2,ct,data)+
+								ergcoaxinterbases2(i,k-2,k,ip-2,ct,data));
 
-										if (mod[i]||mod[k-2]||mod[k]||mod[ip-2]) {
+						if (mod[i]||mod[k-2]||mod[k]||mod[ip-2]) {
 
-											if ((mod[i]||mod[k-2])&&(mod[k]||mod[ip-2])&&inc[ct->numseq[i+1]][ct->numseq[k-3]]
-													&&inc[ct->numseq[k+1]][ct->numseq[ip-3]]&&!(fce.f(i,k-2)&SINGLE)&&!(fce.f(k,ip-2)&SINGLE)) {
+							if ((mod[i]||mod[k-2])&&(mod[k]||mod[ip-2])&&inc[ct->numseq[i+1]][ct->numseq[k-3]]
+									&&inc[ct->numseq[k+1]][ct->numseq[ip-3]]&&!(fce.f(i,k-2)&SINGLE)&&!(fce.f(k,ip-2)&SINGLE)) {
 
-												castack = min(castack,v.f(i+1,k-3)+v.f(k+1,ip-3)+w3[ip]+
-														penalty(i,k-2,ct,data)+penalty(k,ip-2,ct,data)+
-														ergcoaxinterbases2(i,k-2,k,ip-2,ct,data)
-														+erg1(i,k-2,i+1,k-3,ct,data)+erg1(k,ip-2,k+1,ip-3,ct,data)
-													     );
-											}
+								castack = min(castack,v.f(i+1,k-3)+v.f(k+1,ip-3)+w3[ip]+
+										penalty(i,k-2,ct,data)+penalty(k,ip-2,ct,data)+
+										ergcoaxinterbases2(i,k-2,k,ip-2,ct,data)
+										+erg1<bonus>(i,k-2,i+1,k-3,ct,data)+erg1<bonus>(k,ip-2,k+1,ip-3,ct,data)
+									     );
+							}
 
-											if ((mod[i]||mod[k-2])&&inc[ct->numseq[i+1]][ct->numseq[k-3]]&&!(fce.f(i,k-2)&SINGLE)) {
+							if ((mod[i]||mod[k-2])&&inc[ct->numseq[i+1]][ct->numseq[k-3]]&&!(fce.f(i,k-2)&SINGLE)) {
 
-												castack = min(castack,v.f(i+1,k-3)+v.f(k,ip-2)+w3[ip]+
-														penalty(i,k-2,ct,data)+penalty(k,ip-2,ct,data)+
-														ergcoaxinterbases2(i,k-2,k,ip-2,ct,data)
-														+erg1(i,k-2,i+1,k-3,ct,data)
-													     );
-											}
+								castack = min(castack,v.f(i+1,k-3)+v.f(k,ip-2)+w3[ip]+
+										penalty(i,k-2,ct,data)+penalty(k,ip-2,ct,data)+
+										ergcoaxinterbases2(i,k-2,k,ip-2,ct,data)
+										+erg1<bonus>(i,k-2,i+1,k-3,ct,data)
+									     );
+							}
 
-											if ((mod[k]||mod[ip-2])&&inc[ct->numseq[k+1]][ct->numseq[ip-3]]&&!(fce.f(k,ip-2)&SINGLE)) {
+							if ((mod[k]||mod[ip-2])&&inc[ct->numseq[k+1]][ct->numseq[ip-3]]&&!(fce.f(k,ip-2)&SINGLE)) {
 
-												castack = min(castack,v.f(i,k-2)+v.f(k+1,ip-3)+w3[ip]+
-														penalty(i,k-2,ct,data)+penalty(k,ip-2,ct,data)+
-														ergcoaxinterbases2(i,k-2,k,ip-2,ct,data)
-														+erg1(k,ip-2,k+1,ip-3,ct,data)
-													     );
-											}
+								castack = min(castack,v.f(i,k-2)+v.f(k+1,ip-3)+w3[ip]+
+										penalty(i,k-2,ct,data)+penalty(k,ip-2,ct,data)+
+										ergcoaxinterbases2(i,k-2,k,ip-2,ct,data)
+										+erg1<bonus>(k,ip-2,k+1,ip-3,ct,data)
+									     );
+							}
 
-										}
-									}
+						}
+					}
 
-								}
+				}
 #endif //ifndef disablecoax
 
-							}
-							w3[i] = min(w3[i],e[1]);
-							w3[i] = min(w3[i],e[2]);
-							w3[i] = min(w3[i],e[3]);
-							w3[i] = min(w3[i],e[4]);
+			}
+			w3[i] = min(w3[i],e[1]);
+			w3[i] = min(w3[i],e[2]);
+			w3[i] = min(w3[i],e[3]);
+			w3[i] = min(w3[i],e[4]);
 #ifndef disablecoax
-							w3[i] = min(w3[i],castack);
+			w3[i] = min(w3[i],castack);
 #endif //ifndef disablecoax
-						}
+		}
 
 
 
-					}
+	}
 
 
 
 #ifdef DYNALIGN_II
 
-			if(j<=number){
-				for(size_t it=1;it<=5;it++)e[it]=0;
-						
-			castack=0;
+if(j<=number){
+for(size_t it=1;it<=5;it++)e[it]=0;
+		
+castack=0;
 
-			//	we.f(i,j)=INFINITE_ENERGY;
-			if(j-i+1<=minloop+1){
-			  if(lfce[j]||lfce[i])we->f(i,j)=INFINITE_ENERGY;
-			  else we->f(i,j)=min(we->f(i,j-1),we->f(i+1,j));
-			  
-			}
-			 
-			else{
-			  if(lfce[j]||lfce[i])we->f(i,j)=INFINITE_ENERGY;
-			  else we->f(i,j)=min(we->f(i,j-1),we->f(i+1,j));
+//	we.f(i,j)=INFINITE_ENERGY;
+if(j-i+1<=minloop+1){
+  if(lfce[j]||lfce[i])we->f(i,j)=INFINITE_ENERGY;
+  else we->f(i,j)=min(we->f(i,j-1),we->f(i+1,j));
+  
+}
+ 
+else{
+  if(lfce[j]||lfce[i])we->f(i,j)=INFINITE_ENERGY;
+  else we->f(i,j)=min(we->f(i,j-1),we->f(i+1,j));
 
-			  for(k=1;k<=5;k++)e[k]=INFINITE_ENERGY;
-			  
-			  castack=INFINITE_ENERGY;
+  for(k=1;k<=5;k++)e[k]=INFINITE_ENERGY;
+  
+  castack=INFINITE_ENERGY;
 
-			  e[1]=min(e[1],v.f(i,j)+penalty(j,i,ct,data));
-			  
-			  if (mod[i]||mod[j]&&inc[ct->numseq[i+1]][ct->numseq[j-1]]&&!(fce.f(i,j)&SINGLE)) {
-			    e[1] = min(e[1],(v.f(i+1,j-1)+penalty(j,i,ct,data)
-					     +erg1(i,j,i+1,j-1,ct,data)));
-			  }
-			  
-			  e[2]=min(e[2],(v.f(i+1,j)+penalty(j,i+1,ct,data)+erg4(j,i+1,i,2,ct,data,lfce[i])));//yinghan:erg4, how to set up the fourth parameter? sep.27
-			  
-			  if (mod[i+1]||mod[j]&&inc[ct->numseq[i+2]][ct->numseq[j-1]]&&!(fce.f(i+1,j)&SINGLE)) {
-			    e[2] = min(e[2],(v.f(i+2,j-1)+penalty(j,i+1,ct,data)+erg4(j,i+1,i,2,ct,data,lfce[i])
-					     +erg1(i+1,j,i+2,j-1,ct,data)));
-			  }//yinghan:shoudln't they check mod first? sep.27
+  e[1]=min(e[1],v.f(i,j)+penalty(j,i,ct,data));
+  
+  if (mod[i]||mod[j]&&inc[ct->numseq[i+1]][ct->numseq[j-1]]&&!(fce.f(i,j)&SINGLE)) {
+    e[1] = min(e[1],(v.f(i+1,j-1)+penalty(j,i,ct,data)
+	     +erg1<bonus>(i,j,i+1,j-1,ct,data)));
+  }
+  
+  e[2]=min(e[2],(v.f(i+1,j)+penalty(j,i+1,ct,data)+erg4(j,i+1,i,2,ct,data,lfce[i])));//yinghan:erg4, how to set up the fourth parameter? sep.27
+  
+  if (mod[i+1]||mod[j]&&inc[ct->numseq[i+2]][ct->numseq[j-1]]&&!(fce.f(i+1,j)&SINGLE)) {
+    e[2] = min(e[2],(v.f(i+2,j-1)+penalty(j,i+1,ct,data)+erg4(j,i+1,i,2,ct,data,lfce[i])
+	     +erg1<bonus>(i+1,j,i+2,j-1,ct,data)));
+  }//yinghan:shoudln't they check mod first? sep.27
+
+  e[3]=min(e[3],(v.f(i,j-1)+penalty(j-1,i,ct,data)+erg4(j-1,i,j,1,ct,data,lfce[j])));
+
+  if (mod[i]||mod[j-1]&&inc[ct->numseq[i+1]][ct->numseq[j-2]]&&!(fce.f(i,j-1)&SINGLE)){
+    e[3] = min(e[3],(v.f(i+1,j-2)+penalty(j-1,i,ct,data)+erg4(j-1,i,j,1,ct,data,lfce[j])
+	     +erg1<bonus>(i,j-1,i+1,j-2,ct,data)));
+  }
+
+  e[4]=min(e[4],(data->tstack[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
+	 +checknp(lfce[j],lfce[i])+v.f(i+1,j-1)+penalty(j-1,i+1,ct,data)));
+
+  if(mod[i+1]||mod[j-1]&&inc[ct->numseq[i+2]][ct->numseq[j-2]]&&!(fce.f(i+1,j-1)&SINGLE)){
+    e[4]=min(e[4],(data->tstack[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
+	   +checknp(lfce[j],lfce[i])+v.f(i+2,j-2)+erg1<bonus>(i+1,j-1,i+2,j-2,ct,data)
+	   +penalty(j-1,i+1,ct,data)));
+  }
+    
 
-			  e[3]=min(e[3],(v.f(i,j-1)+penalty(j-1,i,ct,data)+erg4(j-1,i,j,1,ct,data,lfce[j])));
+  for (k=i;k<=j;k++)e[5]=min(e[5],we->f(i,k)+we->f(k+1,j));
 
-			  if (mod[i]||mod[j-1]&&inc[ct->numseq[i+1]][ct->numseq[j-2]]&&!(fce.f(i,j-1)&SINGLE)){
-			    e[3] = min(e[3],(v.f(i+1,j-2)+penalty(j-1,i,ct,data)+erg4(j-1,i,j,1,ct,data,lfce[j])
-					     +erg1(i,j-1,i+1,j-2,ct,data)));
-			  }
+  
+  castack=min(castack,wca[i][j]);
+}
 
-			  e[4]=min(e[4],(data->tstack[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
-					 +checknp(lfce[j],lfce[i])+v.f(i+1,j-1)+penalty(j-1,i+1,ct,data)));
+we->f(i,j)=min(we->f(i,j),e[1]);
+we->f(i,j)=min(we->f(i,j),e[2]);
+we->f(i,j)=min(we->f(i,j),e[3]);
+we->f(i,j)=min(we->f(i,j),e[4]);
+we->f(i,j)=min(we->f(i,j),e[5]);
+we->f(i,j)=min(we->f(i,j),castack);
 
-			  if(mod[i+1]||mod[j-1]&&inc[ct->numseq[i+2]][ct->numseq[j-2]]&&!(fce.f(i+1,j-1)&SINGLE)){
-			    e[4]=min(e[4],(data->tstack[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
-					   +checknp(lfce[j],lfce[i])+v.f(i+2,j-2)+erg1(i+1,j-1,i+2,j-2,ct,data)
-					   +penalty(j-1,i+1,ct,data)));
-			  }
-			    
+}
+#else
+#endif
+	}
 
-			  for (k=i;k<=j;k++)e[5]=min(e[5],we->f(i,k)+we->f(k+1,j));
+	//choosefillcell picks the instantiation of fillcell for the features of ct, one flag at a time:
+	//each level fixes the next template flag from ct and passes the ones already fixed along.
+	//Intermolecular and templated folds are rare, and the intermolecular ones spend their time in
+	//the O(N^4) internal loop search, so both use the instantiation with every feature.
+	template <bool modified, bool bonus>
+	static fillcellfunction choosefillcell(structure *ct) {
+		if (ct->shaped) return fillcell<false,false,modified,bonus,true>;
+		return fillcell<false,false,modified,bonus,false>;
+	}
 
-			  
-			  castack=min(castack,wca[i][j]);
+	template <bool modified>
+	static fillcellfunction choosefillcell(structure *ct) {
+		if (ct->experimentalPairBonusExists) return choosefillcell<modified,true>(ct);
+		return choosefillcell<modified,false>(ct);
+	}
+
+	static fillcellfunction choosefillcell(structure *ct) {
+		if (ct->intermolecular||ct->templated) return fillcell<true,true,true,true,true>;
+		if (ct->GetNumberofModified()>0) return choosefillcell<true>(ct);
+		return choosefillcell<false>(ct);
+	}
+
+	//true if tile p,q holds fragments of the half being filled
+	static inline bool tileused(int p, int q, int tiles, bool exterior) {
+		if (p<0||q<0||p>=tiles||q>=tiles) return false;
+		return exterior ? q<=p : p<=q;
+	}
+
+	//Fill the fragments of tile p,q in order of increasing j-i.
+	static void filltile(fillstate &s, bool exterior, int p, int q, int tile) {
+		int number = s.number;
+		int ilow,ihigh,jlow,jhigh,dlow,dhigh,d,i;
+
+		ilow = p*tile+1;
+		ihigh = min(number,(p+1)*tile);
+		jlow = q*tile+1;
+		jhigh = min(number,(q+1)*tile);
+		if (exterior) {
+			jlow += number;
+			jhigh += number;
+		}
+
+		dlow = max(exterior?1:0,jlow-ihigh);
+		dhigh = min(number-1,jhigh-ilow);
+		for (d=dlow;d<=dhigh;d++) {
+			for (i=max(ilow,jlow-d);i<=min(ihigh,jhigh-d);i++) s.cell(s,i,i+d);
+		}
+	}
+
+	//The tiled fill of one half of the arrays, the interior fragments (j<=number) or the
+	//exterior ones (j>number, with jj=j-number<i).  Tile p,q holds i=p*tile+1..(p+1)*tile
+	//and j (or jj) =q*tile+1..(q+1)*tile.  Fragment i,j only reads the fragments inside it,
+	//so a tile can be filled once the tile below it (p+1,q) and the one to its left (p,q-1)
+	//are done.  The tiles are small enough for the rows and columns they read to stay in
+	//cache.  In the SMP build, each tile is a task that depends on those two neighbours, so
+	//the threads fill tiles as they become ready instead of waiting for each other at the
+	//end of every diagonal, and idle threads wait in the OpenMP runtime rather than polling.
+	static void filltiles(fillstate &s, bool exterior, int tile, TProgressDialog *update) {
+		int tiles,total,done,p,q;
+		char *finished;//one element per tile, named by the depend clauses; the last stands for the tiles outside the half
+
+		tiles = (s.number+tile-1)/tile;
+		finished = new char [tiles*tiles+1];
+		total = 0;
+		done = 0;
+		for (p=0;p<tiles;p++) {
+			for (q=0;q<tiles;q++) if (tileused(p,q,tiles,exterior)) total++;
+		}
+
+		//the tiles are created from the bottom row up and from left to right, so that the tiles
+		//each one waits for are created before it, which is also the order of the serial fill
+#ifdef SMP
+#pragma omp parallel
+#pragma omp single
+#endif
+		for (p=tiles-1;p>=0;p--) {
+			for (q=0;q<tiles;q++) {
+				if (!tileused(p,q,tiles,exterior)) continue;
+				int below = tileused(p+1,q,tiles,exterior) ? (p+1)*tiles+q : tiles*tiles;
+				int left = tileused(p,q-1,tiles,exterior) ? p*tiles+q-1 : tiles*tiles;
+#ifdef SMP
+#pragma omp task firstprivate(p,q,below,left) shared(s,finished,done,total) \
+	depend(in: finished[below], finished[left]) depend(out: finished[p*tiles+q])
+#endif
+				{
+					int filled;
+
+					filltile(s,exterior,p,q,tile);
+#ifdef SMP
+#pragma omp atomic capture
+#endif
+					filled = ++done;
+
+					//the progress dialog is not thread safe, so only the first thread reports
+#ifdef SMP
+					if (update&&omp_get_thread_num()==0) update->update((100*filled)/total);
+#else
+					if (update) update->update((100*filled)/total);
+#endif
+				}
 			}
+		}
 
-			we->f(i,j)=min(we->f(i,j),e[1]);
-			we->f(i,j)=min(we->f(i,j),e[2]);
-			we->f(i,j)=min(we->f(i,j),e[3]);
-			we->f(i,j)=min(we->f(i,j),e[4]);
-			we->f(i,j)=min(we->f(i,j),e[5]);
-			we->f(i,j)=min(we->f(i,j),castack);
-			
+		delete[] finished;
+	}
+
+	//Fill diagonals first..last of the arrays, where diagonal h holds the fragments with j-i=h
+	//(h<number) or the exterior fragments with j-i=h-number+1.
+	static void filldiagonals(fillstate &s, int first, int last, int maximum, TProgressDialog *update) {
+		int number = s.number;
+		int h,d;
+
+		for (h=first;h<=last;h++){
+
+			//d = j-i;
+			d=(h<=(number-1))?h:(h-number+1);
+			if (((h%10)==0)&&update) update->update((100*h)/(maximum+1));
+
+			//These variables for start and end (as opposed the fancy syntax that was here before) are needed because of openmp.
+			int startme,endme;//start and end for loop over i
+			if (h<=(number-1)) {
+				startme=1;
+				endme=number-h;
 			}
-#else
+			else {
+				startme=2*number-h;
+				endme=number;
+
+			}
+#ifdef SMP
+#pragma omp parallel for
 #endif
-			
+			for (int i=startme;i<=endme;i++) s.cell(s,i,i+d);
+		}
+	}
 
+	//Fill the exterior fragments, once the interior ones are filled.
+	static void fillexterior(fillstate &s, int maximum, TProgressDialog *update) {
+		//the exterior fragments start new rows of loopE
+		if (s.loopE!=NULL) for (long locali=0;locali<(long) (2*s.number+1)*(s.band+1);locali++) s.loopE[0][locali]=INFINITE_ENERGY;
 
+		if (s.ct->GetFillTile()>0) filltiles(s,true,s.ct->GetFillTile(),update);
+		else filldiagonals(s,s.number,maximum-1,maximum,update);
+	}
+
+	//Prune the exterior fill to the structures with energies up to critbound, once the interior
+	//fragments are filled.  An exterior v fragment is removed if the lowest structure that contains
+	//its pair is above critbound, and the helices that would stack on removed fragments are not
+	//searched; the coaxial stacks of the exterior loop closed by a pair are only searched if helix5
+	//and helix3 allow them.  The pair energy that traceback sums is not split as the fill splits it:
+	//pairslack covers the SHAPE terms of a pair that is stacked on one side and not on the other.
+	static void boundexterior(fillstate &s, int critbound) {
+		structure *ct = s.ct;
+		datatable *data = s.data;
+		arrayclass &v = *s.v;
+		int number = s.number;
+		int a,b,c,d,k,m;
+		int ssmin,diffmax,coaxmin,tstackcoaxmin,coaxstackmin;
+
+		ssmin = 0;
+		diffmax = 0;
+		for (k=1;k<=number;k++) {
+			ssmin = min(ssmin,ct->SHAPEss_give_value(k));
+			diffmax = max(diffmax,abs(ct->SHAPEdiff_give_value(k)));
+		}
+
+		coaxmin = 0;
+		tstackcoaxmin = 0;
+		coaxstackmin = 0;
+		for (a=0;a<6;a++) for (b=0;b<6;b++) for (c=0;c<6;c++) {
+			for (d=0;d<6;d++) {
+				coaxmin = min(coaxmin,data->coax[a][b][c][d]);
+				tstackcoaxmin = min(tstackcoaxmin,data->tstackcoax[a][b][c][d]);
+				coaxstackmin = min(coaxstackmin,data->coaxstack[a][b][c][d]);
+			}
+		}
+
+		s.critbound = critbound;
+		s.coaxbound = min(coaxmin,tstackcoaxmin+coaxstackmin+2*ssmin);
+		//a pair is stacked or not on either side of the split
+		s.pairslack = 4*diffmax;
+
+		//helix5, helix5gap, helix3 and helix3gap hold m=-1..number+2, in one allocation
+		s.helix5 = new integersize [4*(number+4)]+1;
+		s.helix5gap = s.helix5+(number+4);
+		s.helix3 = s.helix5gap+(number+4);
+		s.helix3gap = s.helix3+(number+4);
+		for (m=-1;m<=number+2;m++) {
+			s.helix5[m] = INFINITE_ENERGY;
+			s.helix5gap[m] = INFINITE_ENERGY;
+			s.helix3[m] = INFINITE_ENERGY;
+			s.helix3gap[m] = INFINITE_ENERGY;
+		}
+		for (m=1;m<=number;m++) {
+			for (k=1;k<m;k++) {
+				integersize helix = v.f(k,m)+penalty(k,m,ct,data);
+				s.helix5[m] = min(s.helix5[m],s.w5[k-1]+helix);
+				if (k>1) s.helix5gap[m] = min(s.helix5gap[m],s.w5[k-2]+helix);
+			}
+			for (k=m+1;k<=number;k++) {
+				integersize helix = v.f(m,k)+penalty(m,k,ct,data);
+				s.helix3[m] = min(s.helix3[m],s.w3[k+1]+helix);
+				if (k<number) s.helix3gap[m] = min(s.helix3gap[m],s.w3[k+2]+helix);
+			}
+		}
+
+		s.prune = true;
+	}
+
+	//The fill routine is encapsulated in function fill.
+	//This was separated from dynamic on 3/12/06 by DHM.  This provides greater flexibility
+	//for use of the arrays for other tasks than secondary structure prediction, e.g. dot plots.
+#if defined DYNALIGN_II
+void fill(structure *ct, arrayclass &v, arrayclass &v1, arrayclass &v2, arrayclass &w, arrayclass &wmb, forceclass &fce, int &vmin,bool *lfce, bool *mod,
+          integersize *w5, integersize *w3, bool quickenergy,
+          datatable *data, arrayclass *w2, arrayclass *wmb2, arrayclass *we,TProgressDialog* update, int maxinter, bool quickstructure,
+			bool pruneexterior, int cntrl8)
+
+#elif !defined INSTRUMENTED//If pre-compiler flag INSTRUMENTED is not defined, compile the following code
+	void fill(structure *ct, arrayclass &v, arrayclass &v1, arrayclass &v2, arrayclass &w, arrayclass &wmb, forceclass &fce, int &vmin,bool *lfce, bool *mod,
+			integersize *w5, integersize *w3, bool quickenergy,
+			datatable *data, arrayclass *w2, arrayclass *wmb2, TProgressDialog* update, int maxinter,bool quickstructure,
+			bool pruneexterior, int cntrl8)
+
+#else //IF DEFINED INSTRUMENTED
+		void fill(structure *ct, arrayclass &v, arrayclass &v1, arrayclass &v2, arrayclass &vmb, arrayclass &vext, arrayclass &w, arrayclass &wmb, forceclass &fce, int &vmin,bool *lfce, bool *mod,
+				integersize *w5, integersize *w3, bool quickenergy,
+				datatable *data, arrayclass *w2, arrayclass *wmb2, TProgressDialog* update, int maxinter,bool quickstructure,
+			bool pruneexterior, int cntrl8)
+
+#endif //end !INTRUMENTED
+		{
+			//This is the fill routine:
+			register int number, maximum;
+			integersize **wca,**loopE,**wcol;
+			fillstate s;
+
+
+			number = ct->GetSequenceLength();
+
+			//with a maximum pairing distance, fragments with j-i>band are not stored (see fillband);
+			//limit is the smallest j-i that cannot pair
+			int band = fillband(ct,quickenergy||quickstructure);
+			int limit = number;
+			if (band>0) limit = ct->GetPairingDistanceLimit();
+			else band = number;
+			long wcasize = 0;
+			for (int locali=0;locali<=number;locali++) wcasize += min(number,locali+band)+1-locali;
+
+			//wca only needs i<=j<=min(number,i+band), so it is stored as a packed triangle in one allocation
+			wca = new integersize *[number+1];
+			wca[0] = new integersize [wcasize];
+			for (int locali=0;locali<=number;locali++) {
+				//row i holds j=i..min(number,i+band) and is shifted so that wca[i][i] is its first element
+				if (locali>0) wca[locali] = wca[locali-1]+(min(number,locali-1+band)+1-locali);
+				for (int localj=locali;localj<=min(number,locali+band);localj++) wca[locali][localj] = INFINITE_ENERGY;
+			}
+
+			loopE = NULL;
+			if (!ct->intermolecular) {
+				//This code is needed for O(N^3) prediction of internal loops
+				//loopE is one (2*number+1)x(band+1) allocation: the fragments i,j with the same i+j
+				//(the same i+j-number for exterior fragments) share a row, indexed by the inner pair span
+				loopE = new integersize *[2*number+1];
+				loopE[0] = new integersize [(long) (2*number+1)*(band+1)];
+
+				for (int locali=0;locali<=2*number;locali++) {
+					loopE[locali] = loopE[0]+(long) locali*(band+1);
+					for (int localj=0;localj<=band;localj++) loopE[locali][localj]=INFINITE_ENERGY;
 				}
-#ifndef SMP
+			}
+
+			if (profile.enabled) {
+				profile.addallocation("wca",wcasize*sizeof(integersize)+(number+1)*sizeof(integersize*));
 				if (!ct->intermolecular) {
-					if (d>(maxj>number?8:11))
-					{
-						tempE=curE;
-						curE=prevE;
-						prevE=tempE;
-					}	  
-					if(d>(maxj>number?7:10))
-						for (int localdp=1;localdp<=d-1;localdp++) {
-							for (int locali=((h<=(number-2))?1:(2*number-h-1));locali<=((h<=(number-2))?(number-h-1):number);locali++)
-							{
-								if (locali<number)
-									curE[localdp][locali]=curE[localdp][locali+1];
-							}
-						}
+					profile.addallocation("loopE",(long) (2*number+1)*(band+1)*sizeof(integersize)+(2*number+1)*sizeof(integersize*));
 				}
-#endif //ifndef SMP
+			}
+
+			//SHAPE-restrained folds were historically restricted to the O(N^4) internal loop search, which
+			//limits loops to maxinter-2 unpaired nucleotides (and to eparam[7]).  Keep that limit in the
+			//O(N^3) search so that restrained predictions are unchanged.
+			int maxll = maxinter;
+			if (ct->shaped) maxll = min(maxinter-2,data->eparam[7]);
+
+			if (quickenergy||quickstructure) maximum = number;
+			else maximum = (2*(number)-1);
+
+			//the mirror of w holds column j for the i within the band, max(1,j-band)<=i<=min(j,number)
+			long wcolsize = 0;
+			for (int localj=1;localj<=maximum;localj++) wcolsize += min(localj,number)+1-max(1,localj-band);
+			wcol = new integersize *[maximum+1];
+			wcol[0] = new integersize [wcolsize];
+			for (long locali=0;locali<wcolsize;locali++) wcol[0][locali] = INFINITE_ENERGY;
+			wcolsize = 0;
+			for (int localj=1;localj<=maximum;localj++) {
+				//column j is shifted so that wcol[j][max(1,j-band)] is its first element
+				wcol[localj] = wcol[0]+wcolsize-max(1,localj-band);
+				wcolsize += min(localj,number)+1-max(1,localj-band);
+			}
+			if (profile.enabled) profile.addallocation("wcol",wcolsize*sizeof(integersize)+(maximum+1)*sizeof(integersize*));
+
+			s.ct = ct;
+			s.data = data;
+			s.v = &v;
+			s.v1 = &v1;
+			s.v2 = &v2;
+			s.w = &w;
+			s.wmb = &wmb;
+			s.w2 = w2;
+			s.wmb2 = wmb2;
+#if defined DYNALIGN_II
+			s.we = we;
+#elif defined INSTRUMENTED
+			s.vmb = &vmb;
+			s.vext = &vext;
+#endif
+			s.fce = &fce;
+			s.lfce = lfce;
+			s.mod = mod;
+			s.w5 = w5;
+			s.w3 = w3;
+			s.wca = wca;
+			s.loopE = loopE;
+			s.wcol = wcol;
+			s.vmin = &vmin;
+			s.number = number;
+			s.band = band;
+			s.limit = limit;
+			s.maxinter = maxinter;
+			s.maxll = maxll;
+			s.cell = choosefillcell(ct);
+			s.prune = false;
+			s.helix5 = NULL;
+
+			vmin=INFINITE_ENERGY;
+
+			//fill the interior fragments, tile by tile or one diagonal at a time
+			if (ct->GetFillTile()>0) filltiles(s,false,ct->GetFillTile(),update);
+			else filldiagonals(s,0,number-1,maximum,update);
+
+			if (maximum>number) {
+				//traceback uses the pairs within cntrl8 of vmin, which is usually w5[number]; if it is lower,
+				//and the limit it gives is higher, the exterior fragments are filled again without pruning
+				if (pruneexterior&&!ct->intermolecular) boundexterior(s,suboptimalcrit(w5[number],cntrl8));
+				fillexterior(s,maximum,update);
+				if (s.prune&&suboptimalcrit(vmin,cntrl8)>s.critbound) {
+					s.prune = false;
+					vmin = INFINITE_ENERGY;
+					for (int locali=1;locali<=number;locali++) {
+						for (int localj=number+1;localj<locali+number;localj++) wmb.f(locali,localj) = INFINITE_ENERGY;
+					}
+					fillexterior(s,maximum,update);
+				}
+				if (s.helix5!=NULL) delete[] (s.helix5-1);
 			}
 
 
@@ -5116,17 +5542,14 @@ sub3:
 
 
 			//clean up memory use:
-			for (int locali=0;locali<=number;locali++)
-				delete[] wca[locali];
+			delete[] wca[0];
 			delete[] wca;
+			delete[] wcol[0];
+			delete[] wcol;
 
 			if (!ct->intermolecular) {
-				for (int locali=0;locali<=number;locali++) {
-					delete[] curE[locali];
-					delete[] prevE[locali];
-				}
-				delete[] curE;
-				delete[] prevE;
+				delete[] loopE[0];
+				delete[] loopE;
 
 			}
 
@@ -5266,114 +5689,60 @@ sub3:
 
 void filter(structure* ct, int percent, int max, int window) {
 
-	//structure temp;
-	int i,j,k1,k2,crit;
-	bool** mark;
-	//bool keep;
+	profiletimer timer(profile.filtertime);
 
-	mark = new bool *[ct->GetSequenceLength()+1];
-	for (i=0;i<=ct->GetSequenceLength();i++) {
-		mark[i] = new bool [ct->GetSequenceLength() + 1];
-	}
-	for (i=1;i<=ct->GetSequenceLength();i++) {
-		for (j=i;j<=ct->GetSequenceLength();j++) {
-			mark[i][j] = false;
-		}
-	}
+	int i,j,k,crit,kept;
 
- 
+	//marks keeps track of the pairs within window of the pairs of the structures already checked
+	pairmarks marks(ct->GetSequenceLength());
 
+	//keep holds which structures are kept; they are removed together at the end, so that removing one does not
+	//	move all of the later structures
+	vector<bool> keep(ct->GetNumberofStructures(),false);
 
 	crit = (int) (ct->GetEnergy(1) + abs((int)((float)ct->GetEnergy(1) *((((float)percent)/100.0)))));
-	//temp.numofstructures = 0;
 
 	//check each structure:
+	kept = 0;
 	for (i=1;i<=ct->GetNumberofStructures();++i) {
 		if (ct->GetEnergy(i) > crit) {
 			//none of the remaining structures should be kept bcs the free
-			
-			for (j=ct->GetNumberofStructures();j>=i;j--) ct->RemoveLastStructure();
-
-			//clean up memory:
-			de_allocate(mark,ct->GetSequenceLength()+1);
-			return; 
 			//energy is > than % sort
+			break;
 		}
-		else if (i>max) {
+		else if (kept>=max) {
 			//none of the remaining structures should be kept bcs the max #
 			//of structures has been reached
-
-			for (j=ct->GetNumberofStructures();j>=i;j--) ct->RemoveLastStructure();
-
-			de_allocate(mark,ct->GetSequenceLength()+1);
-			return;
+			break;
 		}
 
 		//now map the baspairs within size < window and verify whether this structure
 		//should be kept or discarded
-//<<<<<<< algorithm.cpp
-		//keep = false;
 		int newpairs=0;
 
 		for (j=1;j<=ct->GetSequenceLength();j++) {
 			if (ct->GetPair(j,i)>j) {
-				if (!mark[j][ct->GetPair(j,i)]) {
-/*||||||| ../../RNAstructure-before-fork/src/algorithm.cpp
-		keep = false;
-		for (j=1;j<=ct->numofbases;j++) {
-			if (ct->basepr[i][j]>j) {
-				if (!mark[j][ct->basepr[i][j]]) {
-=======
-		keep = false;
-		for (j=1;j<=ct->GetSequenceLength();j++) {
-			if (ct->GetPair(j,i)>j) {
-				if (!mark[j][ct->GetPair(j,i)]) {
->>>>>>> ../../RNAstructure-object/src/algorithm.cpp*/
+				if (!marks.get(j,ct->GetPair(j,i))) {
 					//this base has not been marked so keep the structure:
 					++newpairs;
 				}
 			}
 		}
 		for (j=1;j<=ct->GetSequenceLength();j++) {
-			if (ct->GetPair(j,i)>j) {
+			k = ct->GetPair(j,i);
+			if (k>j) {
 				//now mark the basepairs:
-				for (k1=j-window;k1<=j+window;k1++) {
-					for (k2=ct->GetPair(j,i)-window;k2<=ct->GetPair(j,i)+window;k2++) {
-						if ((k1>0)&&(k2>0)&&(k1<=ct->GetSequenceLength())&&(k2<=ct->GetSequenceLength())) {
-							mark[k1][k2] = true;
-						}
-					}
-				}
+				marks.setwindow(j-window,j+window,k-window,k+window);
 			}
 		}
 
-/*//<<<<<<< algorithm.cpp
-		if (newpairs>window) { //structure needs to be kept, copy it over to temp
-			(ct->numofstructures)++;
-			ct->energy[ct->numofstructures] = ct->energy[i];
-			for (j=1;j<=ct->numofbases;j++) {
-				ct->basepr[ct->numofstructures][j] = ct->basepr[i][j];
-			}
-||||||| ../../RNAstructure-before-fork/src/algorithm.cpp
-		if (keep) { //structure needs to be kept, copy it over to temp
-			(ct->numofstructures)++;
-			ct->energy[ct->numofstructures] = ct->energy[i];
-			for (j=1;j<=ct->numofbases;j++) {
-				ct->basepr[ct->numofstructures][j] = ct->basepr[i][j];
-			}
-=======*/
-		if (newpairs<=window) { //structure needs to be kept, copy it over to temp
-			//Get rid of this structure:
-			ct->RemoveStructure(i);
-			--i;//decrement the counter so that the new ith structure is not missed
-//>>>>>>> ../../RNAstructure-object/src/algorithm.cpp*/
+		if (newpairs>window) {
+			keep[i-1] = true;
+			++kept;
 		}
 	}
 
-
-
-	//clean up memory use:
-	de_allocate(mark,ct->GetSequenceLength()+1);
+	ct->RemoveStructures(keep);
 }
 
 	void cctout( structure *ct, char *filename) {
@@ -5825,9 +6194,9 @@ void energydump (structure *ct, datatable *data,arrayclass *v, int n,char *filen
 //cntrl6 = #tracebacks
 //cntrl8 = percent sort
 //cntrl9 = window
-void readsav(const char *filename, structure *ct, arrayclass *w2, arrayclass *wmb2, 
+int readsav(const char *filename, structure *ct, arrayclass *w2, arrayclass *wmb2, 
              integersize *w5, integersize *w3, bool *lfce, bool *mod, datatable *data,
-             arrayclass *v, arrayclass *w, arrayclass *wmb, forceclass *fce, int *vmin) {
+             arrayclass *v, arrayclass *v1, arrayclass *v2, arrayclass *w, arrayclass *wmb, forceclass *fce, int *vmin) {
 
 	int i,j,k,l,m,n,o,p;
 
@@ -5891,9 +6260,6 @@ void readsav(const char *filename, structure *ct, arrayclass *w2, arrayclass *wm
 
 	
 	if (ct->intermolecular) {
-		w2 = new arrayclass(ct->GetSequenceLength());
-		wmb2 = new arrayclass(ct->GetSequenceLength());
-		
 		for (i=0;i<3;i++) read(&sav,&(ct->inter[i]));
 		
 	}
@@ -5955,35 +6321,25 @@ void readsav(const char *filename, structure *ct, arrayclass *w2, arrayclass *wm
 	read(&sav,&ct->shaped);
 	if (ct->shaped) {
 		ct->SHAPE = new double [2*ct->GetSequenceLength()+1];
-		for (i=0;i<=2*ct->GetSequenceLength();i++) read(&sav,&(ct->SHAPE[i]));
-
-	}
-	
-
-	//now read the array class data for v, w, and wmb:
-	//now write the array class data for v, w, and wmb:
-	for (i=0;i<=ct->GetSequenceLength();i++) {
-		read(&sav,&(w3[i]));
-		read(&sav,&(w5[i]));
-		for (j=0;j<=ct->GetSequenceLength();j++) {
-			read(&sav,&(v->dg[i][j+i]));
-			read(&sav,&(w->dg[i][j+i]));
-			read(&sav,&(wmb->dg[i][j+i]));
-			readsinglechar(&sav,&(fce->dg[i][j]));
-			if (ct->intermolecular) {
-				read(&sav,&(w2->dg[i][j+i]));
-				read(&sav,&(wmb2->dg[i][j+i]));
-
-			}
+		sav.read((char *) ct->SHAPE,(2*ct->GetSequenceLength()+1)*sizeof(double));
+		ct->SHAPEss = new double [2*ct->GetSequenceLength()+1];
+		sav.read((char *) ct->SHAPEss,(2*ct->GetSequenceLength()+1)*sizeof(double));
+		ct->SHAPEss_sums();
+
+		read(&sav,&(ct->SHAPEFileRead));
+		if (ct->SHAPEFileRead) {
+			ct->SHAPEdiff = new double [2*ct->GetSequenceLength()+1];
+			sav.read((char *) ct->SHAPEdiff,(2*ct->GetSequenceLength()+1)*sizeof(double));
 		}
-	}
 
-	read(&sav,&(w3[ct->GetSequenceLength()+1]));
-	for (i=0;i<=2*ct->GetSequenceLength();i++) {
-		read(&sav,&(lfce[i]));
-		read(&sav,&(mod[i]));
 	}
 
+	//w5, w3 and the nucleotide constraints
+	sav.read((char *) w5,(ct->GetSequenceLength()+1)*sizeof(integersize));
+	sav.read((char *) w3,(ct->GetSequenceLength()+2)*sizeof(integersize));
+	sav.read((char *) lfce,(2*ct->GetSequenceLength()+1)*sizeof(bool));
+	sav.read((char *) mod,(2*ct->GetSequenceLength()+1)*sizeof(bool));
+
 	read(&sav, vmin);
 
 	//now open the data files:
@@ -6062,15 +6418,42 @@ void readsav(const char *filename, structure *ct, arrayclass *w2, arrayclass *wm
 	read(&sav,&(data->prelog));
 	read(&sav,&(data->singlecbulge));
 
-
-
+	//the arrays are used in place, from the blocks at the end of the file (see savemapping)
+	arrayclass *arrays[7] = {v,v1,v2,w,wmb,w2,wmb2};
+	int arraycount = ct->intermolecular ? 7 : 5;
+	long long bytes[8];
+	for (i=0;i<arraycount;i++) bytes[i] = (long long) (ct->GetSequenceLength()+1)*(ct->GetSequenceLength()+1)*sizeof(integersize);
+	bytes[arraycount] = fce->GetBlockSize();
+
+	vector<saveblock> blocks;
+	if (!readsavedirectory(&sav,blocks)||(int) blocks.size()!=arraycount+1||!checksaveblocks(&sav,blocks,bytes)) {
+		//a truncated or corrupt save file
+		return 16;
+	}
 	sav.close();
 
+	savemapping *mapping = savemapping::open(filename,blocks);
+	for (i=0;i<arraycount;i++) arrays[i]->attach((integersize *) mapping->block(i),mapping);
+	fce->attach((char *) mapping->block(arraycount),mapping);
+	mapping->release();
 
+	return 0;
 }
 
 
 
+//the window size grows with the length of the sequence, so that long sequences give suboptimal structures that differ by more than a few pairs
+int defaultwindowsize(int length) {
+
+	if (length>1200) return 20;
+	else if (length>800) return 15;
+	else if (length>500) return 11;
+	else if (length>300) return 7;
+	else if (length>120) return 5;
+	else if (length>50) return 3;
+	else return 2;
+}
+
 //opensav will open a save file created by the fill algorithm (function dynamic)
 //	it then runs the traceback routine with the parameters provided
 void opensav(char* filename, structure* ct, int cntrl6, int cntrl8,int cntrl9) {
@@ -6100,15 +6483,15 @@ void opensav(char* filename, structure* ct, int cntrl6, int cntrl8,int cntrl9) {
 	sav.close();
 
 
-	//allocate everything
+	//allocate everything; the arrays are attached to the blocks of the save file by readsav
 	ct->allocate(sequencelength);
 	
-	arrayclass w(ct->GetSequenceLength());
-	arrayclass v(ct->GetSequenceLength());
-	arrayclass v1(ct->GetSequenceLength());
-	arrayclass v2(ct->GetSequenceLength());
-	arrayclass wmb(ct->GetSequenceLength());	
-	forceclass fce(ct->GetSequenceLength());
+	arrayclass w(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+	arrayclass v(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+	arrayclass v1(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+	arrayclass v2(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+	arrayclass wmb(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);	
+	forceclass fce(ct->GetSequenceLength(),0,false);
 
 
 	lfce = new bool [2*ct->GetSequenceLength()+1];
@@ -6118,8 +6501,8 @@ void opensav(char* filename, structure* ct, int cntrl6, int cntrl8,int cntrl9) {
 	w3 = new integersize [ct->GetSequenceLength()+2];
 
 	if (ct->intermolecular) {
-		w2 = new arrayclass(ct->GetSequenceLength());
-		wmb2 = new arrayclass(ct->GetSequenceLength());
+		w2 = new arrayclass(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
+		wmb2 = new arrayclass(ct->GetSequenceLength(),INFINITE_ENERGY,false,0,false);
 		
 		for (i=0;i<3;i++) read(&sav,&(ct->inter[i]));
 		
@@ -6129,10 +6512,12 @@ void opensav(char* filename, structure* ct, int cntrl6, int cntrl8,int cntrl9) {
 		wmb2 = NULL;
 	}
 	
-	readsav(filename, ct, w2, wmb2, w5, w3, lfce, mod, data,
-	        &v, &w, &wmb, &fce, &vmin);
+	//a truncated or corrupt save file leaves no structures
+	if (readsav(filename, ct, w2, wmb2, w5, w3, lfce, mod, data,
+	        &v, &v1, &v2, &w, &wmb, &fce, &vmin)==0) {
 
-	traceback(ct, data, &v, &v1, &v2, &w, &wmb, w2, wmb2,w3, w5, &fce, lfce, vmin, cntrl6, cntrl8, cntrl9,mod);
+		traceback(ct, data, &v, &v1, &v2, &w, &wmb, w2, wmb2,w3, w5, &fce, lfce, vmin, cntrl6, cntrl8, cntrl9,mod);
+	}
 
 
 	delete[] lfce;
@@ -61,13 +61,17 @@ int dynamic (structure *ct,datatable *data,int cntrl6,int cntrl8,int cntrl9,
 
 void fill(structure *ct, arrayclass &v, arrayclass &v1, arrayclass &v2, arrayclass &w, arrayclass &wmb, forceclass &fce, int &vmin,bool *lfce, bool *mod,
           integersize *w5, integersize *w3, bool quickenergy,
-          datatable *data, arrayclass *w2, arrayclass *wmb2, arrayclass *we,TProgressDialog* update = 0, int maxinter = 30, bool quickstructure = false);
+          datatable *data, arrayclass *w2, arrayclass *wmb2, arrayclass *we,TProgressDialog* update = 0, int maxinter = 30, bool quickstructure = false,
+          bool pruneexterior = false, int cntrl8 = 0);
 
 
 //The fill step of the dynamic programming algorithm for free energy minimization:
+//pruneexterior indicates that only the exterior fragments that traceback can use, with the percent
+//sort cntrl8, are needed; the others are not filled, and may hold any energy above that limit
 void fill(structure *ct, arrayclass &v, arrayclass &v1, arrayclass &v2, arrayclass &w, arrayclass &wmb, forceclass &fce, int &vmin,bool *lfce, bool *mod,
 		  integersize *w5, integersize *w3, bool qickenergy,
-		  datatable *data, arrayclass *w2, arrayclass *wmb2, TProgressDialog* update=0, int maxinter = 30, bool quickstructure = false);
+		  datatable *data, arrayclass *w2, arrayclass *wmb2, TProgressDialog* update=0, int maxinter = 30, bool quickstructure = false,
+		  bool pruneexterior = false, int cntrl8 = 0);
 
 //this overloaded dynamic function is used by NAPSS program to generate a special format dotplot
 void dynamic (structure *ct,datatable* data,int cntrl6, int cntrl8,int cntrl9,
@@ -76,7 +80,8 @@ void dynamic (structure *ct,datatable* data,int cntrl6, int cntrl8,int cntrl9,
 //this overloaded fill function is used to NAPSS program to generate a special format dotplot
 void fill(structure *ct, arrayclass &v, arrayclass &v1, arrayclass &v2, arrayclass &vmb, arrayclass &vext, arrayclass &w, arrayclass &wmb, forceclass &fce, 
           int &vmin, bool *lfce, bool *mod,integersize *w5, integersize *w3, bool quickenergy,
-          datatable *data, arrayclass *w2, arrayclass *wmb2, TProgressDialog* update=0, int maxinter = 30, bool quickstructure = false);
+          datatable *data, arrayclass *w2, arrayclass *wmb2, TProgressDialog* update=0, int maxinter = 30, bool quickstructure = false,
+          bool pruneexterior = false, int cntrl8 = 0);
 
 void errmsg(int err,int err1);//function for outputting info in case of an error
 void update (int i);//function informs user of progress of fill algorithm
@@ -99,6 +104,10 @@ void filter(structure* ct, int percent, int max, int window);
 //	fill routines - it coordinates the force...() functions above
 void force(structure *ct,forceclass *fce, bool *lfce);
 
+//fillband gives the largest j-i stored by the fill arrays for ct, or 0 to store them all
+//	quick indicates that only the lowest free energy (structure) is needed
+int fillband(structure *ct, bool quick);
+
 //Use the fill information to generate a set of suboptimal structures using the mfold heuristic.
 	//This returns an error code, where zero is no error and non-zero indicates a traceback error.
 int traceback(structure *ct, datatable *data, arrayclass *v, arrayclass *v1, arrayclass *v2, arrayclass *w, arrayclass *wmb, arrayclass *w2,arrayclass *wmb2, integersize *w3, integersize *w5, forceclass *fce,
@@ -132,18 +141,21 @@ int checknp(bool lfce1,bool lfce2);
 void opensav(char* filename, structure* ct, int cntrl6, int cntrl8,int cntrl9);//opens a save file with information filled by
    									//fill algorithm
 
+int defaultwindowsize(int length);//the window size for suboptimal structures that RNAprob uses for a sequence of length nucleotides
+
 #ifdef DYNALIGN_II
 int trace(structure *ct, datatable *data, int ii, int ji,
           arrayclass *v, arrayclass *v1, arrayclass *v2, arrayclass *w, arrayclass *wmb, arrayclass *w2, arrayclass *wmb2, 
-          bool *lfce, forceclass *fce, integersize *w3, integersize *w5,bool *mod,arrayclass *we = NULL,integersize energy = 0,int open = 0, int pair = 0, bool quickstructure = false);
+          bool *lfce, forceclass *fce, integersize *w3, integersize *w5,bool *mod,arrayclass *we = NULL,integersize energy = 0,int open = 0, int pair = 0, bool quickstructure = false, int structurenumber = 0);
 #else
 int trace(structure *ct, datatable *data, int ii, int ji,
 		arrayclass *v, arrayclass *v1, arrayclass *v2, arrayclass *w, arrayclass *wmb, arrayclass *w2, arrayclass *wmb2, 
-          bool *lfce, forceclass *fce, integersize *w3, integersize *w5,bool *mod,bool quickstructure=false);
+          bool *lfce, forceclass *fce, integersize *w3, integersize *w5,bool *mod,bool quickstructure=false, int structurenumber = 0);
 #endif
-void readsav(const char *filename, structure *ct, arrayclass *w2, arrayclass *wmb2, 
+//readsav returns 0, or 16 if the arrays at the end of the file are missing or do not match the sequence (a truncated or corrupt file)
+int readsav(const char *filename, structure *ct, arrayclass *w2, arrayclass *wmb2, 
 			 integersize *w5, integersize *w3, bool *lfce, bool *mod, datatable *data,
-			 arrayclass *v, arrayclass *w, arrayclass *wmb, forceclass *fce, int *vmin);
+			 arrayclass *v, arrayclass *v1, arrayclass *v2, arrayclass *w, arrayclass *wmb, forceclass *fce, int *vmin);
 bool notgu(int i, int j, structure *ct);
 void writehelixfile(char *filename,structure *ct,int StructureNumber);//write a file with the helices
 
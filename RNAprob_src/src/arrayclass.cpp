@@ -6,30 +6,58 @@
  */
 
 #include "arrayclass.h"
+#include "savemapping.h"
 
 #include "defines.h"
 
-arrayclass::arrayclass(int size, integersize energy) {
+#include <algorithm>
+
+using namespace std;
+
+arrayclass::arrayclass(int size, integersize energy, bool triangular, int band, bool allocate) {
 	
 
 	infinite = INFINITE_ENERGY;
 
   Size = size;
-  register int i,j;
-  dg = new integersize *[size+1];
-    
-	for (i=0;i<=(size);i++)  {
-    dg[i] = new integersize [size+1];
+  register int i;
+  long total,offset;
+
+  if (triangular) {
+	  Lastj = size;
+	  if (band>0&&band<size) {
+		  //rows 0..size-band hold band+1 elements, the rest are cut short by the end of the sequence
+		  Band = band;
+		  total = (long) (size-band+1)*(band+1) + ((long) band*(band+1))/2;
+	  }
+	  else {
+		  Band = size;
+		  total = ((long) (size+1)*(size+2))/2;
+	  }
+  }
+  else {
+	  Lastj = 2*size;
+	  Band = 2*size;
+	  total = (long) (size+1)*(size+1);
   }
-  for (i=0;i<=size;i++) {
-    for (j=0;j<size+1;j++) {
-      dg[i][j] = INFINITE_ENERGY;
-    }
+
+  Total = total;
+  mapping = NULL;
+  dg = new integersize *[size+1];
+  if (!allocate) {
+	  block = NULL;
+	  for (i=0;i<=size;++i) dg[i] = NULL;
+	  return;
   }
 
-  //Now move pointers, to facilitate fast access:
+  block = new integersize [total];
+  for (offset=0;offset<total;offset++) block[offset] = INFINITE_ENERGY;
+
+  //Point each row into the block, shifted by i to facilitate fast access (dg[i][i] is the first element of row i):
+  offset = 0;
   for (i=0;i<=size;++i) {
-	  dg[i]-=i;
+	  dg[i] = block + offset - i;
+	  offset += triangular ? (min(size,i+Band)+1-i) : (size+1);
   }
 
 }
@@ -37,14 +65,19 @@ arrayclass::arrayclass(int size, integersize energy) {
 // the destructor deallocates the space used
 arrayclass::~arrayclass() {
 	
-	int i;
-       	
-    for (i=0;i<=Size;i++) {
-		//move pointers back before deleting
-		dg[i]+=i;
-
-		//now delete
-        delete[] dg[i];
-    }
-     delete[] dg;
+	if (mapping!=NULL) mapping->release();
+	else delete[] block;
+	delete[] dg;
+}
+
+void arrayclass::attach(integersize *values, savemapping *owner) {
+  register int i;
+
+  if (mapping!=NULL) mapping->release();
+  else delete[] block;
+
+  owner->hold();
+  mapping = owner;
+  block = values;
+  for (i=0;i<=Size;++i) dg[i] = block + (long) i*(Size+1) - i;
 }
@@ -1,31 +1,63 @@
-
-
 #ifndef ARRAYCLASS_H
 #define ARRAYCLASS_H
 
 #include "defines.h"
 
+#include <cassert>
+
+class savemapping;
+
 // arrayclass encapsulates the large 2-d arrays of w and v, used by
 // the dynamic programming algorithm 
 
+// The rows are carved out of a single allocation.  Row i holds j=i..i+size,
+// so that both the interior fragments (j<=size) and the exterior fragments
+// (j>size) fit.  If triangular is true, row i only holds j=i..size; this is
+// enough for folds that never fill the exterior fragments (quickenergy and
+// quickstructure), and it halves the memory used.  A triangular array can
+// also be banded: if band is greater than zero, row i only holds
+// j=i..i+band, so the memory grows with size*band.  Elements outside the
+// triangle or band are not stored: f must not be used for them, and get
+// reads them as INFINITE_ENERGY.
+
 class arrayclass {
 private:
   int Size;
+  int Lastj;
+  int Band;
+  long Total;
+  integersize *block;
+  savemapping *mapping;
 
 public:
   int k;
   integersize **dg;
   integersize infinite;
 
-  // the constructor allocates the space needed by the arrays
-    arrayclass(int size, integersize energy = INFINITE_ENERGY);
+  // the constructor allocates the space needed by the arrays; if allocate is
+  // false, nothing is allocated, and the array must be attached to a block of
+  // a save file before it is used
+    arrayclass(int size, integersize energy = INFINITE_ENERGY, bool triangular = false, int band = 0, bool allocate = true);
   
   // the destructor deallocates the space used
   ~arrayclass();
 
   // f is an integer function that references the correct element of
-  // the array
+  // the array; for a triangular or banded array, the element must be stored
   integersize &f(int i, int j);
+
+  // get returns element i,j, or INFINITE_ENERGY if it lies outside the
+  // triangle or band, for the reads of a triangular or banded array that may
+  // fall outside it (the traceback)
+  integersize get(int i, int j) const;
+
+  // use values, a block of a save file laid out as the block of this array,
+  // in place of the array's own block, holding mapping until the array is
+  // deleted (see savemapping); the array must not be triangular
+  void attach(integersize *values, savemapping *owner);
+
+  // the number of bytes allocated for the array
+  long GetAllocatedBytes() { return Total*sizeof(integersize) + (Size+1)*sizeof(integersize*); }
 };
 
 inline integersize &arrayclass::f(int i, int j) {
@@ -37,7 +69,21 @@ inline integersize &arrayclass::f(int i, int j) {
    if (i > j) {
         return infinite;
    }
-   
+
+   assert(j <= Lastj && j-i <= Band);
+   return dg[i][j];
+}
+
+inline integersize arrayclass::get(int i, int j) const {
+   if (i > Size) {
+     i -= Size;
+     j -= Size;
+   }
+
+   if (i > j || j > Lastj || j-i > Band) {
+        return INFINITE_ENERGY;
+   }
+
    return dg[i][j];
 }
 
@@ -75,8 +75,10 @@
 //#define integersize int
 //#define "DIGITS" "%.2f"
 
-#define safiversion 3//version is the save file version for single sequences
-#define pfsaveversion 4//this is the version of save file format for partition functions
+#define safiversion 4//version is the save file version for single sequences
+#define pfsaveversion 6//this is the version of save file format for partition functions
+#define thermosnapshotversion 1//this is the version of the thermodynamic snapshot format (see thermosnapshot.h)
+#define reactivityfileversion 1//this is the version of the binary reactivity file format (see reactivityfile.h)
 #define T37inK 310.15//37 degrees C in Kelvin
 
 enum StructureType{STYPE_ALL, STYPE_UNPAIRED, STYPE_PAIRED, STYPE_HELIXEND, STYPE_STACKED, NUM_STYPE};
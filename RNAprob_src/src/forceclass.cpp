@@ -1,31 +1,45 @@
 
 #include "forceclass.h"
+#include "savemapping.h"
 
 // forceclass encapsulates a large 2-d arrays of char used by the
 // dynamic algorithm to enforce folding constraints
 
-forceclass::forceclass(int size) {
+forceclass::forceclass(int size, int band, bool allocate) {
 	
 
   Size = size;
-  register int i,j;
-  dg = new char *[size+1];
+  Band = (band>0&&band<size) ? band : size;
+  register int i;
+  long offset;
 
-	for (i=0;i<=(size);i++)  {
-    dg[i] = new char [size+1];
-  }
-  for (i=0;i<=size;i++) {
-    for (j=0;j<size+1;j++) {
-      dg[i][j] = 0;
-             
-    }
+  mapping = NULL;
+  dg = new char *[size+1];
+  if (!allocate) {
+    block = NULL;
+    for (i=0;i<=size;i++) dg[i] = NULL;
+    return;
   }
+
+  block = new char [GetBlockSize()];
+  for (offset=0;offset<GetBlockSize();offset++) block[offset] = 0;
+
+  for (i=0;i<=size;i++) dg[i] = block + (long) i*(Band+1);
 }
 
 forceclass::~forceclass() {
-  for (int i = 0; i <= Size; i++) {
-    delete[] dg[i];
-  }
+  if (mapping!=NULL) mapping->release();
+  else delete[] block;
 
   delete[] dg;
 }
+
+void forceclass::attach(char *values, savemapping *owner) {
+  if (mapping!=NULL) mapping->release();
+  else delete[] block;
+
+  owner->hold();
+  mapping = owner;
+  block = values;
+  for (int i=0;i<=Size;i++) dg[i] = block + (long) i*(Band+1);
+}
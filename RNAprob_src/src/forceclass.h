@@ -2,18 +2,29 @@
 #ifndef FORCECLASS_H
 #define FORCECLASS_H
 
+class savemapping;
+
 // forceclass encapsulates a large 2-d arrays used by the dynamic
 // algorithm to enforce folding constraints
+
+// If band is greater than zero, only the elements with j-i<=band are stored
+// (see arrayclass); the others read as 0 and writes to them are dropped.
 class forceclass {
 private:
   int Size;
+  int Band;
+  char outside;
+  char *block;
+  savemapping *mapping;
 
 public:
   int k;
   char **dg;
   
-  // the constructor allocates the space needed by the arrays
-  forceclass(int size);
+  // the constructor allocates the space needed by the arrays; if allocate is
+  // false, nothing is allocated, and the array must be attached to a block of
+  // a save file before it is used
+  forceclass(int size, int band = 0, bool allocate = true);
 
   // the destructor deallocates the space used
   ~forceclass();
@@ -21,6 +32,19 @@ public:
   // f is an integer function that references the correct element of
   // the array
   char &f(int i, int j);
+
+  // true if only a band of the array is stored
+  bool IsBanded() { return Band<Size; }
+
+  // the rows are carved out of one block of (size+1)*(band+1) values, where
+  // row i holds j=i..i+band
+  char *GetBlock() { return block; }
+  long GetBlockSize() { return (long) (Size+1)*(Band+1); }
+
+  // use values, a block of a save file laid out as the block of this array,
+  // in place of the array's own block, holding mapping until the array is
+  // deleted (see savemapping)
+  void attach(char *values, savemapping *owner);
 };
 
 inline char &forceclass::f(int i, int j) {
@@ -37,6 +61,11 @@ inline char &forceclass::f(int i, int j) {
     j -= Size;
   }
 
+  if (j-i > Band) {
+    outside = 0;
+    return outside;
+  }
+
   return dg[i][j-i];
 }
 
@@ -2,7 +2,9 @@
  * structure for a historgram data set
  */
 #include <iostream>
+#include <math.h>
 #include "histData.h"
+#include "defines.h"
 
 using namespace std;
 
@@ -65,6 +67,20 @@ void histData::add(double probability)
 	size++;
 }
 
+/*
+	precompute the pseudoenergy -RT*ln(p) of each bin, bins with p<=0 give no pseudoenergy
+*/
+void histData::compile()
+{
+	energy.resize(size);
+	for (int i = 0; i < size; i++) {
+		if (prob[i] <= 0)
+			energy[i] = 0;
+		else
+			energy[i] = -(double) rt * log (prob[i]) * conversionfactor;
+	}
+}
+
 /*
 	get the starting reactivity (lower boundary) of the histogram
 */
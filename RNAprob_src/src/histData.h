@@ -11,6 +11,7 @@ private:
 	double start;
 	double binSize;
 	vector<double> prob;
+	vector<double> energy;//-RT*ln(prob) per bin, filled by compile()
 public:
 	histData();
 	histData(double startPos, double bin_size);
@@ -24,10 +25,29 @@ public:
 	double getProbability(int index);
 	double getProbability(double reactivity);
 	void add(double probability);
+	void compile();
+	double getPseudoEnergy(double reactivity);
 	void print();
 	
 };
 
+/*
+	get the pseudoenergy (in kcal/mol*conversionfactor) for a given reactivity value,
+	compile() must be called after the last add()
+*/
+inline double histData::getPseudoEnergy(double reactivity)
+{
+	if (size == 0)
+		return 0;
+	int index = (reactivity - start + 0.000001) / binSize;
+	//assign outlier to boundry
+	if (index < 0)
+		index = 0;
+	else if (index >= size)
+		index = size-1;
+	return energy[index];
+}
+
 
 
 #endif
\ No newline at end of file
@@ -10,50 +10,10 @@ using namespace std;
 
 histSet::histSet()
 {
-	init();
 }
 
-/*
-	initialize vectors for storing the histogram data
-*/
-void histSet::init()
-{	
-	//allocate space for storing shape histogram
-	shapeHist = new vector<vector<histData*>*>();
-	for (int i = 0; i < NUM_BASE; i++){
-		vector<histData*>* temp = new vector<histData*>;
-		shapeHist->push_back(temp);
-		for (int j = 0; j < NUM_STYPE; j++){
-			histData* ahist = new histData();
-			temp->push_back(ahist);
-		}
-	}	
-	
-	//allocate space for storing dms histogram
-	dmsHist = new vector<vector<histData*>*>();
-	for (int i = 0; i < NUM_BASE; i++){
-		vector<histData*>* temp = new vector<histData*>;
-		dmsHist->push_back(temp);
-		for (int j = 0; j < NUM_STYPE; j++){
-			histData* ahist = new histData();
-			temp->push_back(ahist);
-		}
-	}	
-}
-
-/*
-	destructor, to be improved
-*/
 histSet::~histSet()
 {
-	if (shapeHist != NULL){
-		//shapeHist->clear();
-		delete[] shapeHist;
-	}
-	if (dmsHist != NULL){
-		//dmsHist->clear();
-		delete[] dmsHist;
-	}
 }
 
 /*
@@ -100,6 +60,12 @@ void histSet::readHistFile(const char* filename)
 	}
 	
 	in.close();
+
+	//precompute the pseudoenergy tables
+	for (int i = 0; i < NUM_DSOURCE; i++)
+		for (int j = 0; j < NUM_BASE; j++)
+			for (int k = 0; k < NUM_STYPE; k++)
+				hist[i][j][k].compile();
 }
 
 /*
@@ -136,6 +102,8 @@ void histSet::getDataTitle(string title, int& dataSource, int& strucType, int& b
 void histSet::setHistParam(int dataSource, int strucType, int baseType, double startPos, double binSize)
 {
 	histData* ahist = getHistData(dataSource, strucType, baseType);
+	if (ahist == NULL)
+		return;
 	ahist->setStart(startPos);
 	ahist->setBinSize(binSize);
 }
@@ -145,14 +113,13 @@ void histSet::setHistParam(int dataSource, int strucType, int baseType, double s
 */
 histData* histSet::getHistData(int dataSource, int strucType, int baseType)
 {
-	if (dataSource == DSOURCE_SHAPE)
-		return shapeHist->at(baseType)->at(strucType);
-	else if(dataSource == DSOURCE_DMS)
-		return dmsHist->at(baseType)->at(strucType);
-	else{
+	if (dataSource != DSOURCE_SHAPE && dataSource != DSOURCE_DMS){
 		cout<<"Error: unrecognized data source"<<endl;
 		return NULL;
 	}
+	if (baseType < 0 || baseType >= NUM_BASE || strucType < 0 || strucType >= NUM_STYPE)
+		return NULL;
+	return &hist[dataSource][baseType][strucType];
 }
 
 /*
@@ -10,11 +10,9 @@ using namespace std;
 class histSet 
 {
 private:
-	//vector<histData *>* shapeHist;
-	vector<vector<histData*>*>* shapeHist;
-	vector<vector<histData*>*>* dmsHist;
+	//one histogram per data source, base type and structure type
+	histData hist[NUM_DSOURCE][NUM_BASE][NUM_STYPE];
 	
-	void init();
 	void getDataTitle(string title, int& dataSource, int& strucType, int& baseType);
 	void setHistParam(int dataSource, int strucType, int baseType, double startPos, double binSize);
 	void add(int dataSource, int strucType, int baseType, double probability);
@@ -24,9 +22,18 @@ public:
 	~histSet();	
 	void readHistFile(const char* filename);
 	histData* getHistData(int dataSource, int strucType, int baseType);
+	double getPseudoEnergy(int dataSource, int strucType, int baseType, double reactivity);
 	void print();
 };
 
+/*
+	get the pseudoenergy for a reactivity value from the precomputed table, no range checks
+*/
+inline double histSet::getPseudoEnergy(int dataSource, int strucType, int baseType, double reactivity)
+{
+	return hist[dataSource][baseType][strucType].getPseudoEnergy(reactivity);
+}
+
 int extractDataSource(string ds);
 int extractStructureType(char* stype);
 int extractBaseType(char* base);
@@ -0,0 +1,110 @@
+#include "minplus.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MINPLUS_X86
+#include <immintrin.h>
+#endif
+
+typedef integersize (*minplusfunction)(const integersize *, const integersize *, int, integersize);
+
+static integersize minplusscalar(const integersize *a, const integersize *b, int n, integersize best) {
+	int k;
+
+	for (k=0;k<n;k++) {
+		if (a[k]+b[k]<best) best = a[k]+b[k];
+	}
+	return best;
+}
+
+#ifdef MINPLUS_X86
+
+//the vector versions need 32 bit energies, see chooseminplus
+__attribute__((target("avx2")))
+static integersize minplusavx2(const integersize *a, const integersize *b, int n, integersize best) {
+	__m256i m0,m1;
+	int k,l;
+	int lane[8];
+
+	//two accumulators, so that consecutive mins do not wait on each other
+	m0 = _mm256_set1_epi32(best);
+	m1 = m0;
+	for (k=0;k+16<=n;k+=16) {
+		m0 = _mm256_min_epi32(m0,_mm256_add_epi32(_mm256_loadu_si256((const __m256i *) (a+k)),
+			_mm256_loadu_si256((const __m256i *) (b+k))));
+		m1 = _mm256_min_epi32(m1,_mm256_add_epi32(_mm256_loadu_si256((const __m256i *) (a+k+8)),
+			_mm256_loadu_si256((const __m256i *) (b+k+8))));
+	}
+	if (k+8<=n) {
+		m0 = _mm256_min_epi32(m0,_mm256_add_epi32(_mm256_loadu_si256((const __m256i *) (a+k)),
+			_mm256_loadu_si256((const __m256i *) (b+k))));
+		k+=8;
+	}
+	_mm256_storeu_si256((__m256i *) lane,_mm256_min_epi32(m0,m1));
+	for (l=0;l<8;l++) if (lane[l]<best) best = lane[l];
+
+	return minplusscalar(a+k,b+k,n-k,best);
+}
+
+//the unmasked AVX-512 mins of GCC 12 start from an undefined vector, which -Wall reports as uninitialized;
+//with a full mask, the zero vector of maskz is never used
+__attribute__((target("avx512f")))
+static inline __m512i min512(__m512i x, __m512i y) {
+	return _mm512_maskz_min_epi32((__mmask16) 0xFFFF,x,y);
+}
+
+__attribute__((target("avx512f")))
+static integersize minplusavx512(const integersize *a, const integersize *b, int n, integersize best) {
+	__m512i m0,m1;
+	int k,l;
+	int lane[16];
+
+	m0 = _mm512_set1_epi32(best);
+	m1 = m0;
+	for (k=0;k+32<=n;k+=32) {
+		m0 = min512(m0,_mm512_add_epi32(_mm512_loadu_si512(a+k),_mm512_loadu_si512(b+k)));
+		m1 = min512(m1,_mm512_add_epi32(_mm512_loadu_si512(a+k+16),_mm512_loadu_si512(b+k+16)));
+	}
+	if (k+16<=n) {
+		m0 = min512(m0,_mm512_add_epi32(_mm512_loadu_si512(a+k),_mm512_loadu_si512(b+k)));
+		k+=16;
+	}
+	_mm512_storeu_si512(lane,min512(m0,m1));
+	for (l=0;l<16;l++) if (lane[l]<best) best = lane[l];
+
+	//the remaining elements are fewer than 16
+	return minplusavx2(a+k,b+k,n-k,best);
+}
+
+#endif //MINPLUS_X86
+
+static minplusfunction chooseminplus(const char **name) {
+#ifdef MINPLUS_X86
+	if (sizeof(integersize)==4) {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f")) {
+			*name = "avx512";
+			return minplusavx512;
+		}
+		if (__builtin_cpu_supports("avx2")) {
+			*name = "avx2";
+			return minplusavx2;
+		}
+	}
+#endif
+	*name = "scalar";
+	return minplusscalar;
+}
+
+//chosen once, before main, so that threads share it without locking
+static const char *minplusname;
+static minplusfunction minpluskernel = chooseminplus(&minplusname);
+
+integersize minplus(const integersize *a, const integersize *b, int n, integersize best) {
+	//short ranges are not worth the call through the pointer
+	if (n<8) return minplusscalar(a,b,n,best);
+	return minpluskernel(a,b,n,best);
+}
+
+const char *minplusversion() {
+	return minplusname;
+}
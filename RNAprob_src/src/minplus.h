@@ -0,0 +1,18 @@
+#ifndef MINPLUS_H
+#define MINPLUS_H
+
+#include "defines.h"
+
+// minplus is the inner loop of the bifurcation search in fill:
+// the smallest a[k]+b[k] for k=0..n-1, or best if that is smaller.
+
+// On x86 processors, the AVX-512 or AVX2 version is chosen when the program
+// starts, according to what the processor supports; elsewhere, and on older
+// processors, a scalar loop is used.  The result does not depend on the
+// version, because min is exact for integers.
+integersize minplus(const integersize *a, const integersize *b, int n, integersize best);
+
+// the name of the version in use ("avx512", "avx2" or "scalar")
+const char *minplusversion();
+
+#endif
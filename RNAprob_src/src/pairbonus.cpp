@@ -0,0 +1,120 @@
+#include "pairbonus.h"
+
+#include <algorithm>
+
+using namespace std;
+
+//order pending bonuses by row, then column
+static bool entrybefore(const pairbonus_entry &a, const pairbonus_entry &b) {
+	if (a.i!=b.i) return a.i<b.i;
+	return a.j<b.j;
+}
+
+pairbonus::pairbonus(int size, double defaultvalue) {
+	Size = size;
+	Default = defaultvalue;
+	rowstart.assign(size+2,0);
+	stripstart.assign(size+1,-1);
+	rowfirst.assign(size+1,0);
+	rowlast.assign(size+1,-1);
+}
+
+void pairbonus::add(int i, int j, double bonus) {
+	int k;
+	pairbonus_entry e;
+
+	if (i > Size) i -= Size;
+	if (j > Size) j -= Size;
+
+	//a pair that is already stored is updated in place
+	k = find(i,j);
+	if (k>=0) {
+		value[k] += bonus;
+		return;
+	}
+
+	e.i = i;
+	e.j = j;
+	e.bonus = bonus;
+	pending.push_back(e);
+}
+
+void pairbonus::build() {
+	vector<int> newstart(Size+2,0);
+	vector<int> newcolumn;
+	vector<double> newvalue;
+	unsigned int p;
+	int i,k;
+
+	if (pending.empty()) return;
+
+	//stable, so that bonuses for the same pair are summed in the order they were added
+	stable_sort(pending.begin(),pending.end(),entrybefore);
+
+	newcolumn.reserve(column.size()+pending.size());
+	newvalue.reserve(value.size()+pending.size());
+
+	p = 0;
+	for (i=1;i<=Size;i++) {
+		newstart[i] = (int) newcolumn.size();
+		k = rowstart[i];
+
+		//merge the stored entries of row i with the pending ones
+		while (k<rowstart[i+1]||(p<pending.size()&&pending[p].i==i)) {
+			if (p<pending.size()&&pending[p].i==i&&(k>=rowstart[i+1]||pending[p].j<column[k])) {
+				newcolumn.push_back(pending[p].j);
+				newvalue.push_back(Default);
+				while (p<pending.size()&&pending[p].i==i&&pending[p].j==newcolumn.back()) {
+					newvalue.back() += pending[p].bonus;
+					p++;
+				}
+			}
+			else {
+				newcolumn.push_back(column[k]);
+				newvalue.push_back(value[k]);
+				k++;
+			}
+		}
+	}
+	newstart[Size+1] = (int) newcolumn.size();
+
+	rowstart.swap(newstart);
+	column.swap(newcolumn);
+	value.swap(newvalue);
+	pending.clear();
+
+	//index the long rows by column
+	strip.clear();
+	for (i=1;i<=Size;i++) {
+		stripstart[i] = -1;
+		if (rowstart[i+1]-rowstart[i]<=pairbonus_sparserow) continue;
+
+		rowfirst[i] = column[rowstart[i]];
+		rowlast[i] = column[rowstart[i+1]-1];
+		stripstart[i] = (long) strip.size();
+		strip.resize(strip.size()+rowlast[i]-rowfirst[i]+1,-1);
+		for (k=rowstart[i];k<rowstart[i+1];k++) strip[stripstart[i]+column[k]-rowfirst[i]] = k;
+	}
+}
+
+void pairbonus::symmetrize() {
+	vector<double> average;
+	int i,k,l;
+
+	//make sure that j-i is stored for every stored i-j
+	for (i=1;i<=Size;i++) {
+		for (k=rowstart[i];k<rowstart[i+1];k++) {
+			if (find(column[k],i)<0) add(column[k],i,0.0);
+		}
+	}
+	build();
+
+	average.resize(value.size());
+	for (i=1;i<=Size;i++) {
+		for (k=rowstart[i];k<rowstart[i+1];k++) {
+			l = find(column[k],i);
+			average[k] = 0.5*(value[k]+value[l]);
+		}
+	}
+	value.swap(average);
+}
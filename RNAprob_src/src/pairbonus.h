@@ -0,0 +1,103 @@
+#ifndef PAIRBONUS_H
+#define PAIRBONUS_H
+
+#include <vector>
+
+// the most entries that a row holds without a strip
+const int pairbonus_sparserow = 8;
+
+// a bonus waiting to be sorted into the rows
+struct pairbonus_entry {
+	int i,j;
+	double bonus;
+};
+
+// pairbonus holds the experimental pair bonuses (the -x file) for a sequence.
+
+// Only the pairs that were given a bonus are stored; every other pair takes
+// the default value, which is the experimental offset.  The entries are kept
+// in compressed rows, with the columns of each row in increasing order, so the
+// memory used grows with the number of bonuses rather than with N^2.  A row
+// with more than pairbonus_sparserow entries also gets a strip that maps each
+// column from its first to its last entry to the entry (or -1), so that the
+// lookups in a long row take constant time instead of a binary search.
+// Indexes above the sequence length (the exterior fragments) refer to the
+// same nucleotides as index-length.
+
+class pairbonus {
+private:
+	int Size;
+	double Default;
+
+	// the entries of row i are rowstart[i]..rowstart[i+1]-1
+	std::vector<int> rowstart;
+	std::vector<int> column;
+	std::vector<double> value;
+
+	// strip[stripstart[i]] is column rowfirst[i] of row i, and the strip ends
+	// at column rowlast[i]; stripstart[i] is -1 for a row without a strip
+	std::vector<long> stripstart;
+	std::vector<int> rowfirst,rowlast;
+	std::vector<int> strip;
+
+	// bonuses added since the last call to build
+	std::vector<pairbonus_entry> pending;
+
+	int find(int i, int j) const;
+
+public:
+	// make an empty set of bonuses for a sequence of length size
+	pairbonus(int size, double defaultvalue);
+
+	// add bonus to the value of pair i-j; bonuses for the same pair are summed
+	// build must be called before the values are used
+	void add(int i, int j, double bonus);
+
+	// sort the added bonuses into the compressed rows, and make the strips of the long rows
+	void build();
+
+	// make the value of i-j and j-i the average of the two, storing both
+	void symmetrize();
+
+	// the number of stored values, and access to them and to the default,
+	// used to convert the values to equilibrium constants
+	int GetEntries() const { return (int) value.size(); }
+	double &GetValue(int entry) { return value[entry]; }
+	double &GetDefault() { return Default; }
+
+	// the value of pair i-j
+	double f(int i, int j) const;
+};
+
+inline double pairbonus::f(int i, int j) const {
+	int k;
+
+	if (i > Size) i -= Size;
+	if (j > Size) j -= Size;
+
+	k = find(i,j);
+	return (k<0) ? Default : value[k];
+}
+
+inline int pairbonus::find(int i, int j) const {
+	int low,high,mid;
+
+	//a long row is read from its strip
+	if (stripstart[i]>=0) {
+		if (j<rowfirst[i]||j>rowlast[i]) return -1;
+		return strip[stripstart[i]+j-rowfirst[i]];
+	}
+
+	//binary search of row i; rows without a strip hold only a few entries
+	low = rowstart[i];
+	high = rowstart[i+1]-1;
+	while (low<=high) {
+		mid = (low+high)/2;
+		if (column[mid]==j) return mid;
+		else if (column[mid]<j) low = mid+1;
+		else high = mid-1;
+	}
+	return -1;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#include "pairmarks.h"
+
+#include <algorithm>
+
+using namespace std;
+
+pairmarks::pairmarks(int n) {
+	long long bits = 0;
+	int i;
+
+	this->n = n;
+	row.resize(n+2);
+	for (i=1;i<=n;i++) {
+		//row i holds j=i..n
+		row[i] = bits-i;
+		bits += n-i+1;
+	}
+	words.assign((size_t) (bits/64+1),0);
+}
+
+void pairmarks::setwindow(int i1, int i2, int j1, int j2) {
+	int i;
+
+	i1 = max(i1,1);
+	i2 = min(i2,n);
+	j2 = min(j2,n);
+	for (i=i1;i<=i2;i++) {
+		int low = max(j1,i);
+		if (low>j2) continue;
+
+		//the bits of a row are consecutive, so whole words are filled between the partial ones at the ends
+		long long first = row[i]+low,last = row[i]+j2;
+		long long firstword = first>>6,lastword = last>>6;
+		unsigned long long head = ~0ULL<<(first&63),tail = ~0ULL>>(63-(last&63));
+		if (firstword==lastword) words[firstword] |= head&tail;
+		else {
+			words[firstword] |= head;
+			for (long long w=firstword+1;w<lastword;w++) words[w] = ~0ULL;
+			words[lastword] |= tail;
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#ifndef PAIRMARKS_H
+#define PAIRMARKS_H
+
+#include <vector>
+
+// pairmarks is the set of base pairs i-j, 1<=i<=j<=n, that the suboptimal
+// traceback and filter mark as covered by the structures they keep.  Each
+// pair takes one bit, so the set is an eighth of the size of an N x N bool
+// array, and only the pairs with i<=j are stored.  A row holds the pairs of
+// one i, so the pairs within a window of a pair are marked a word at a time.
+class pairmarks {
+	public:
+		pairmarks(int n);
+
+		bool get(int i, int j) const {
+			long long bit = row[i]+j;
+			return (words[bit>>6]>>(bit&63))&1;
+		}
+
+		void set(int i, int j) {
+			long long bit = row[i]+j;
+			words[bit>>6] |= 1ULL<<(bit&63);
+		}
+
+		// mark the pairs k1-k2 with i1<=k1<=i2, j1<=k2<=j2 and k1<=k2, where
+		// the bounds are clipped to 1..n
+		void setwindow(int i1, int i2, int j1, int j2);
+
+	private:
+		int n;
+		std::vector<long long> row;//the bit of pair i-j is row[i]+j
+		std::vector<unsigned long long> words;
+};
+
+#endif
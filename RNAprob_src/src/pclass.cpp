@@ -212,6 +212,7 @@ void readpfsave(char *filename, structure *ct,PFPRECISION *w5, PFPRECISION *w3,
 		for (i=0;i<=2*ct->GetSequenceLength();i++) read(&sav,&(ct->SHAPE[i]));
 		ct->SHAPEss = new double [2 * ct->GetSequenceLength() + 1];
 		for (i=0;i<=2*ct->GetSequenceLength();i++) read(&sav,&(ct->SHAPEss[i]));
+		ct->SHAPEss_sums();
 
 	}
 
@@ -14,6 +14,7 @@ Contributions by Zhi John Lu, 2006.
 
 #include "pfunction.h"
 #include "boltzmann.h" //for boltzman
+#include "savemapping.h"
 #include <math.h>
 #include <cstdlib>
 
@@ -54,7 +55,7 @@ using namespace std;
 
 
 void calculatepfunction(structure* ct,pfdatatable* data, TProgressDialog* update, char* save, bool quickQ, PFPRECISION *Q,
-	pfunctionclass *w, pfunctionclass *v, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl,
+	pfunctionclass *w, pfunctionclass *v, pfunctionclass *v2, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl,
 	pfunctionclass *wcoax, forceclass *fce,PFPRECISION *w5,PFPRECISION *w3,bool *mod, bool *lfce) {
 
 
@@ -90,34 +91,29 @@ PFPRECISION **tempE,**wca;
 
 number = (ct->GetSequenceLength());//place the number of bases in a registered integer
 
-//#ifndef SMP //These (for internal loop calculations) are only used in serial code
-
-#ifndef SMP //These (for internal loop calculations) are only used in serial code
-
+//The O(N^3) internal loop arrays are also used with SMP; curE[dp][i] and prevE[dp][i] are only touched
+//by the thread that calculates i,j in a diagonal.
 curE= new  PFPRECISION *[number+1];
 prevE= new PFPRECISION *[number+1];
-#else
-curE = NULL;
-prevE = NULL;
-#endif
 wca = new PFPRECISION *[number+1];
 
-
+//curE and prevE are each one (number+1)x(number+1) allocation, wca only needs i<=j<=number
+//and is stored as a packed triangle
+curE[0]= new  PFPRECISION [(number+1)*(number+1)];
+prevE[0]= new PFPRECISION [(number+1)*(number+1)];
+wca[0]= new PFPRECISION [((number+1)*(number+2))/2];
 
 
 for (i=0;i<=number;i++) {
-	#ifndef SMP //These (for internal loop calculations) are only used in serial code
-		curE[i]= new  PFPRECISION [number+1];
-   		prevE[i]= new PFPRECISION [number+1];
-	#endif
-	wca[i]=new PFPRECISION [number+1];
+	curE[i]= curE[0]+i*(number+1);
+	prevE[i]= prevE[0]+i*(number+1);
+	//row i of wca holds j=i..number and is shifted so that wca[i][i] is its first element
+	if (i>0) wca[i]= wca[i-1]+(number+1-i);
 	for(j=0;j<=number;j++) {
 
-		wca[i][j] = (PFPRECISION) 0;
-		#ifndef SMP //These (for internal loop calculations) are only used in serial code
-			curE[i][j]= (PFPRECISION) 0;
-			prevE[i][j]= (PFPRECISION) 0;
-		#endif
+		if (j>=i) wca[i][j] = (PFPRECISION) 0;
+		curE[i][j]= (PFPRECISION) 0;
+		prevE[i][j]= (PFPRECISION) 0;
 	}
 
 }
@@ -140,7 +136,6 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 
 	d=(h<=(number-1))?h:(h-number+1);
 
-	#ifndef SMP //These (for internal loop calculations) are only used in serial code
 	if (h==number) {
 		for(i=0;i<=number;i++) {
 			for(j=0;j<=number;j++) {
@@ -149,13 +144,6 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 			}
 		}
 	}
-//<<<<<<< pfunction.cpp
-//	#endif
-
-	
-//=======
-	#endif
-//>>>>>>> 1.30
 
 	if (((h%10)==0)&&update) update->update((100*h)/(2*ct->GetSequenceLength()));
 
@@ -195,7 +183,8 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 	
 	//for (int locali=((h<=(number-1))?1:(2*number-h));locali<=((h<=(number-1))?(number-h):number);locali++){
 	#ifdef SMP
-		#pragma omp parallel for
+		//the internal loop indices are declared at function scope, so each thread needs its own copy
+		#pragma omp parallel for private(ip,jp,jpf,jf,bl,ll,dp,ii,jj,p)
 	#endif
 	for (int locali=start;locali<=end;locali++){
 		int localj=locali+d;
@@ -213,6 +202,8 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 			//Start the value of V:
 			double localrarray=0.0;
 			double locale;
+			//the part of V in which locali,localj stacks on locali+1,localj-1 (see v2)
+			double localstack=0.0;
 
 
 			//Now, test some conditions as to whether V should be evaluated:
@@ -368,28 +359,29 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 					if ((localj-locali-1)>=(minloop+2)||localj>(number)) {
       					//Perhaps locali,localj stacks over locali+1,localj-1
 						if (!mod[locali]&&!mod[localj])  //make sure this is not a site of chemical modification
-							localrarray+=erg1(locali,localj,locali+1,localj-1,ct,data)*v->f(locali+1,localj-1);
+							localstack=erg1(locali,localj,locali+1,localj-1,ct,data)*pfvstack(locali+1,localj-1,v,v2,ct);
 						else {
 							//allow G-U to be modified or a pair next to a G-U to be modified
 							if ((ct->numseq[locali]==3&&ct->numseq[localj]==4)||(ct->numseq[locali]==4&&ct->numseq[localj]==3)) {
-								localrarray+=erg1(locali,localj,locali+1,localj-1,ct,data)*v->f(locali+1,localj-1);
+								localstack=erg1(locali,localj,locali+1,localj-1,ct,data)*pfvstack(locali+1,localj-1,v,v2,ct);
 
 							}
 							else if ((ct->numseq[locali+1]==3&&ct->numseq[localj-1]==4)||(ct->numseq[locali+1]==4&&ct->numseq[localj-1]==3)) {
 
-								localrarray+=erg1(locali,localj,locali+1,localj-1,ct,data)*v->f(locali+1,localj-1);
+								localstack=erg1(locali,localj,locali+1,localj-1,ct,data)*pfvstack(locali+1,localj-1,v,v2,ct);
 
 							}
 							else if (locali-1>0&&localj+1<2*number) {
 								if ((ct->numseq[locali-1]==3&&ct->numseq[localj+1]==4)||(ct->numseq[locali-1]==4&&ct->numseq[localj+1]==3)) {
 
-									localrarray+=erg1(locali,localj,locali+1,localj-1,ct,data)*v->f(locali+1,localj-1);
+									localstack=erg1(locali,localj,locali+1,localj-1,ct,data)*pfvstack(locali+1,localj-1,v,v2,ct);
 
 								}
 
 							}
 
 						}
+						localrarray+=localstack;
 					}
 
 
@@ -429,7 +421,6 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 //=======
 					//Perhaps locali,localj closes an interior or bulge loop, search all possibilities
 
-					#ifndef SMP //USe the O(N^3) code, below, only for serial calculations:
 					
 						/*fill the interior loops' energy localrarray first
 						calculate the small loop (size<=5) first
@@ -632,90 +623,6 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 
 //										}
 //=======
-					#else
-						//If using SMP, resort to the O(N^4) recursions for internal loops: 
-								
-						if (((localj-locali-1)>=(minloop+3))||(localj>(number))) {
-							
-
-							int maxsize;
-							if (localj<=number) maxsize = min(maxinter,localj-locali-minloop-3);//interior fragment
-							else maxsize = min(localj - locali - 3,maxinter); //exterior fragment
-							for (int size=1;size<=maxsize;++size) {
-								int localip, localjp;
-								for (localip=locali+1,localjp=localj-size-1;localip<=locali+size+1&&localip<=number;++localip,++localjp) {
-									
-									
-									/*if (localip>(number)) {
-											
-										localrarray+=erg2(locali,localj,localip,localjp,ct,data,fce->f(locali,localip-number),
-																fce->f(localjp-number,localj-number))*
-																v->f(localip-(number),localjp-(number));
-
-										if ((mod[localip]||mod[localjp])&&inc[ct->numseq[localip]][ct->numseq[localjp]]) {
-											//localip or localjp is modified
-
-											localrarray+=erg2(locali,localj,localip,localjp,ct,data,fce->f(locali,localip-number),
-																	fce->f(localjp-number,localj-number))*
-														v->f(localip-(number)+1,localjp-(number)-1)*
-														erg1(localip-number,localjp-number,localip+1-number,localjp-1-number,ct,data);
-
-										}
-										//}
-									}*/
-									//else {
-										if (localjp<=number) {
-
-
-
-
-											localrarray+=erg2(locali,localj,localip,localjp,ct,data,fce->f(locali,localip),
-																	fce->f(localjp,localj))*
-																v->f(localip,localjp);
-
-											if ((mod[localip]||mod[localjp])&&inc[ct->numseq[localip]][ct->numseq[localjp]]) {
-												//locali or localj is modified
-												localrarray+=erg2(locali,localj,localip,localjp,ct,data,fce->f(locali,localip),
-																		fce->f(localjp,localj))*
-																	v->f(localip+1,localjp-1)*erg1(localip,localjp,localip+1,localjp-1,ct,data);
-
-											}
-									
-
-
-									
-										}
-										else {
-
-									 
-											localrarray+=erg2(locali,localj,localip,localjp,ct,data,fce->f(locali,localip),fce->f(localjp-number,localj-number))*
-																v->f(localip,localjp);
-
-
-											if ((mod[localip]||mod[localjp])&&inc[ct->numseq[localip]][ct->numseq[localjp]]) {
-												//locali or localj is modified
-												localrarray+=erg2(locali,localj,localip,localjp,ct,data,fce->f(locali,localip),fce->f(localjp-number,localj-number))*
-																	v->f(localip+1,localjp-1)*erg1(localip,localjp,localip+1,localjp-1,ct,data);
-
-											}
-
-										}
-//>>>>>>> 1.30
-
-
-
-
-									//}
-									
-
-
-						   
-								}//for size
-							}//for localip
-						}//if ((localj-locali-1)>=(minloop+3))||(localj>(number))
-						
-
-					#endif //SMP not defined
 
 
 
@@ -1189,6 +1096,12 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 			v->f(locali,localj) = localrarray;
 //>>>>>>> 1.30
 
+			//With the three-state reactivity model, the helix-end constants of the pair are applied here, once for each pair:
+			if (v2!=NULL) {
+				v->f(locali,localj) = v->f(locali,localj)*pfhelixend(locali,localj,ct);
+				v2->f(locali,localj) = localstack*pfhelixend(locali,localj,ct);
+			}
+
 //<<<<<<< pfunction.cpp
 			//Apply constant (an euilibrium constant for formation of locali-localj pair), if being used:
 //=======
@@ -1219,12 +1132,12 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 				}
 
 				v->f(locali,localj) = v->f(locali,localj)*ct->constant[jj][ii];
+				if (v2!=NULL) v2->f(locali,localj) = v2->f(locali,localj)*ct->constant[jj][ii];
 
 			}
 
 
-			#ifndef SMP	
-				//This code is for O(N^3) internal loops, and is not used for SMP calculations
+				//This code is for O(N^3) internal loops
 
 				/*prefill curE[locali] and prev[locali] for the first two diognals as ll =4 and 5
 					As d =10, only fill curE (ll=4, d=10)
@@ -1378,7 +1291,6 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 
 			//also block propagation of interior loops that contain nucleotides that need to be double-stranded:
 			if (lfce[locali]||lfce[localj]) for (dp=1;dp<=d;dp++) curE[dp][locali] = 0.0;
-			#endif //SMP not defined
 
 			if (fce->f(locali,localj)&PAIR)  {//force a pair between locali and localj
 	  			w->f(locali,localj) = v->f(locali,localj)*data->eparam[10]*penalty(locali,localj,ct,data);
@@ -1927,51 +1839,51 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 		//check to see if any of the 2-D arrays are about to go out of bounds
 		//(not checking wca[][],curE[][],prevE[][] although they need to be rescaled too)
 		if (v->f(i,j)>PFMAX) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
 			twoscaling = twoscaling*SCALEDOWN*SCALEDOWN;
 		}
 		else if (w->f(i,j)>PFMAX) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
 			twoscaling = twoscaling*SCALEDOWN*SCALEDOWN;
 		}
 		else if (wl->f(i,j)>PFMAX) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
 			twoscaling = twoscaling*SCALEDOWN*SCALEDOWN;
 		}
 		else if (wcoax->f(i,j)>PFMAX) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
 			twoscaling = twoscaling*SCALEDOWN*SCALEDOWN;
 		}
 		else if (wmb->f(i,j)>PFMAX) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
 			twoscaling = twoscaling*SCALEDOWN*SCALEDOWN;
 		}
 		else if (wmbl->f(i,j)>PFMAX) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
 			twoscaling = twoscaling*SCALEDOWN*SCALEDOWN;
 		}
 		else if (v->f(i,j)<PFMIN&&v->f(i,j)>0) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
 			twoscaling = twoscaling*SCALEUP*SCALEUP;
 		}
 		else if (w->f(i,j)<PFMIN&&w->f(i,j)>0) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
 			twoscaling = twoscaling*SCALEUP*SCALEUP;
 		}
 		else if (wl->f(i,j)<PFMIN&&wl->f(i,j)>0) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,curE,prevE,wca,SCALEUP);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
 			twoscaling = twoscaling*SCALEUP*SCALEUP;
 		}
 		else if (wcoax->f(i,j)<PFMIN&&wcoax->f(i,j)>0) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
 			twoscaling = twoscaling*SCALEUP*SCALEUP;
 		}
 		else if (wmb->f(i,j)<PFMIN&&wmb->f(i,j)>0) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
 			twoscaling = twoscaling*SCALEUP*SCALEUP;
 		}
 		else if (wmbl->f(i,j)<PFMIN&&wmbl->f(i,j)>0) {
-			rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
+			rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
 			twoscaling = twoscaling*SCALEUP*SCALEUP;
 		}
 	}
@@ -2117,11 +2029,11 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 
 			//check to see if w5 is about to go out of bounds:
 			if (w5[j]>PFMAX) {
-				rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
+				rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
 				twoscaling = twoscaling*SCALEDOWN*SCALEDOWN;
 			}
 			else if (w5[j]<PFMIN&&w5[j]>0) {
-				rescale(i,j,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
+				rescale(i,j,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
 				twoscaling=twoscaling*SCALEUP*SCALEUP;
 
 			}
@@ -2369,52 +2281,46 @@ for (h=0;h<=( quickQ?(maxj-1):(maxj-1-minloop) );h++){
 			w3[ii] = rarray;
 			//check to see if w5 is about to go out of bounds:
 			if (w3[ii]>PFMAX) {
-				rescale(1,number,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
+				rescale(1,number,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEDOWN);
 				twoscaling=twoscaling*SCALEDOWN*SCALEDOWN;
 			}
 			else if (w3[ii]<PFMIN&&w3[ii]>0) {
-				rescale(1,number,ct,data,v,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
+				rescale(1,number,ct,data,v,v2,w,wl,wcoax,wmb,wmbl,w5,w3,wca,curE,prevE,SCALEUP);
 				twoscaling = twoscaling*SCALEUP*SCALEUP;
 			}
 		}
 	}
 
-	#ifndef SMP
-		//This is O(N^3) internal loop code that is not used with SMP
-		if (d>(j>number?8:11))
-		{
-			tempE=curE;
-			curE=prevE;
-			prevE=tempE;
-		}
-		if(d> (j>number?7:10))
-		
-		for (dp=1;dp<=d-1;dp++) {
-			for (i=((h<=(number-2))?1:(2*number-h-1));i<=((h<=(number-2))?(number-h-1):number);i++){
-				if (i<number) curE[dp][i]=curE[dp][i+1];
+	//This is O(N^3) internal loop code
+	if (d>(j>number?8:11))
+	{
+		tempE=curE;
+		curE=prevE;
+		prevE=tempE;
+	}
+	if(d> (j>number?7:10)) {
+	
+		#ifdef SMP
+			#pragma omp parallel for
+		#endif
+		for (int localdp=1;localdp<=d-1;localdp++) {
+			for (int locali=((h<=(number-2))?1:(2*number-h-1));locali<=((h<=(number-2))?(number-h-1):number);locali++){
+				if (locali<number) curE[localdp][locali]=curE[localdp][locali+1];
 			}
 		}
-	#endif
+	}
 
 
 
 
 }
 
-for(ii=0;ii<=number;ii++) {
-	delete[] wca[ii];
-
-	#ifndef SMP
-	delete[] curE[ii];
-	delete[] prevE[ii];
-	#endif
-
-}
+delete[] wca[0];
+delete[] curE[0];
+delete[] prevE[0];
 delete[] wca;
-#ifndef SMP
 delete[] curE;
 delete[] prevE;
-#endif
 
 
 
@@ -2546,6 +2452,14 @@ if (ct->shaped) {
 
 }
 
+//With the three-state model, the stacked-versus-helix-end differences are converted as well, and
+//v2 is needed for the part of V in which the pair is stacked on the pair inside it.
+pfunctionclass *v2 = NULL;
+if (pfthreestate(ct)) {
+	for (i=1;i<=2*ct->GetSequenceLength();i++) ct->SHAPEdiff[i]=boltzman(ct->SHAPEdiff[i], data->temp);
+	v2 = new pfunctionclass(number);
+}
+
 //add a second array for intermolecular folding:
 
 /*if (ct->intermolecular) {
@@ -2613,13 +2527,13 @@ if (ct->DistanceLimited()) {
 
 
 
-calculatepfunction(ct,data,update,save,quickQ,Q,&w,&v,&wmb,&wl,&wmbl,&wcoax,&fce,w5,w3,mod,lfce);
+calculatepfunction(ct,data,update,save,quickQ,Q,&w,&v,v2,&wmb,&wl,&wmbl,&wcoax,&fce,w5,w3,mod,lfce);
 
 
 
 
 if (save!=0) {
-	writepfsave(save,ct,w5,w3,&v,&w,&wmb,&wl,&wmbl,&wcoax,&fce,mod,lfce,data);
+	writepfsave(save,ct,w5,w3,&v,v2,&w,&wmb,&wl,&wmbl,&wcoax,&fce,mod,lfce,data);
 }
 
 if (quickQ) *Q = w5[ct->GetSequenceLength()];
@@ -2627,6 +2541,7 @@ if (quickQ) *Q = w5[ct->GetSequenceLength()];
 
 delete[] lfce;
 delete[] mod;
+delete v2;
 
 
 
@@ -2649,7 +2564,7 @@ return;
 //writepfsave writes a save file with partition function data.
 void writepfsave(char *filename, structure *ct,
 			 PFPRECISION *w5, PFPRECISION *w3,
-			 pfunctionclass *v, pfunctionclass *w, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl, pfunctionclass *wcoax,
+			 pfunctionclass *v, pfunctionclass *v2, pfunctionclass *w, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl, pfunctionclass *wcoax,
 			 forceclass *fce, bool *mod, bool *lfce, pfdatatable *data) {
 
 	int i,j,k,l,m,n,o,p;
@@ -2761,71 +2676,21 @@ void writepfsave(char *filename, structure *ct,
 	//write the SHAPE data (for pseudo-free energy constraints)
 	write(&sav,&(ct->shaped));
 	if (ct->shaped) {
-		for (i=0;i<=2*ct->GetSequenceLength();i++) write(&sav,&(ct->SHAPE[i]));
-		for (i=0;i<=2*ct->GetSequenceLength();i++) write(&sav,&(ct->SHAPEss[i]));
-
-	}
-
-
-	//now write the array class data for v, w, and wmb:
-	for (i=0;i<=ct->GetSequenceLength();i++) {
-		write(&sav,&(w3[i]));
-		write(&sav,&(w5[i]));
-//<<<<<<< pfunction.cpp
-//		for (j=0;j<=ct->GetSequenceLength();j++) {
-//			write(&sav,&(v->dg[i][j]));
-//			write(&sav,&(w->dg[i][j]));
-//			write(&sav,&(wmb->dg[i][j]));
-//			write(&sav,&(wmbl->dg[i][j]));
-//			write(&sav,&(wl->dg[i][j]));
-//			write(&sav,&(wcoax->dg[i][j]));
-//=======
-		for (j=0;j<=ct->GetSequenceLength();j++) {
-			write(&sav,&(v->dg[i][j+i]));
-			write(&sav,&(w->dg[i][j+i]));
-			write(&sav,&(wmb->dg[i][j+i]));
-			write(&sav,&(wmbl->dg[i][j+i]));
-			write(&sav,&(wl->dg[i][j+i]));
-			write(&sav,&(wcoax->dg[i][j+i]));
-//>>>>>>> 1.30
-			writesinglechar(&sav,&(fce->dg[i][j]));
-			//if (ct->intermolecular) {
-			//	write(&sav,&(w2->dg[i][j]));
-			//	write(&sav,&(wmb2->dg[i][j]));
-
-			//}
-
-
-		}
-
-
-	}
-
-
-	// I should replace this with functionality to convert .pfs files to .txt files -- rhiju.
-	// this is inelegant -- quick way to get at base pair probabilities...
-	if ( false ) { //turn this off before CVS checkin!
-	  string bpp_file( "bpp.txt" );
-	  ofstream bpp_out( bpp_file.c_str() );
-	  for (i=1;i<=ct->GetSequenceLength();i++) {
-	    for (j=1;j<=ct->GetSequenceLength();j++) {
-	      bpp_out << ' ' << calculateprobability(i,j,v,w5,ct,data,lfce,mod,data->scaling,fce);
-	    }
-	    bpp_out << endl;
-	  }
-	  bpp_out.close();
-	}
-
+		sav.write((char *) ct->SHAPE,(2*ct->GetSequenceLength()+1)*sizeof(double));
+		sav.write((char *) ct->SHAPEss,(2*ct->GetSequenceLength()+1)*sizeof(double));
 
-	write(&sav,&(w3[ct->GetSequenceLength()+1]));
-	for (i=0;i<=2*ct->GetSequenceLength();i++) {
-		write(&sav,&(lfce[i]));
-		write(&sav,&(mod[i]));
+		//and whether the three-state reactivity model was used, with its stacked-versus-helix-end constants
+		bool threestate = v2!=NULL;
+		write(&sav,&threestate);
+		if (threestate) sav.write((char *) ct->SHAPEdiff,(2*ct->GetSequenceLength()+1)*sizeof(double));
 
 	}
 
-
-
+	//w5, w3 and the nucleotide constraints; the arrays are written at the end of the file
+	sav.write((char *) w5,(ct->GetSequenceLength()+1)*sizeof(PFPRECISION));
+	sav.write((char *) w3,(ct->GetSequenceLength()+2)*sizeof(PFPRECISION));
+	sav.write((char *) lfce,(2*ct->GetSequenceLength()+1)*sizeof(bool));
+	sav.write((char *) mod,(2*ct->GetSequenceLength()+1)*sizeof(bool));
 
 
 	//now write the thermodynamic data:
@@ -2907,7 +2772,16 @@ void writepfsave(char *filename, structure *ct,
 	write(&sav,&(data->singlecbulge));
 	write(&sav,&(data->maxintloopsize));
 
-
+	//now the arrays, each as one block that readpfsave can use in place: v, w, wmb, wmbl, wl, wcoax, v2 (only present
+	//with the three-state reactivity model) and fce
+	pfunctionclass *arrays[7] = {v,w,wmb,wmbl,wl,wcoax,v2};
+	int arraycount = (v2!=NULL) ? 7 : 6;
+	vector<saveblock> blocks(arraycount+1);
+	for (i=0;i<arraycount;i++) blocks[i].bytes = (long long) (ct->GetSequenceLength()+1)*(ct->GetSequenceLength()+1)*sizeof(PFPRECISION);
+	blocks[arraycount].bytes = fce->GetBlockSize();
+	writesavedirectory(&sav,blocks);
+	for (i=0;i<arraycount;i++) writesaveblock(&sav,blocks[i],arrays[i]->dg[0]);
+	writesaveblock(&sav,blocks[arraycount],fce->GetBlock());
 
 	sav.close();
 
@@ -2921,7 +2795,7 @@ void writepfsave(char *filename, structure *ct,
 //	partition function
 
       //the constructor allocates the space needed by the arrays
-pfunctionclass::pfunctionclass(int size) {
+pfunctionclass::pfunctionclass(int size, bool allocate) {
 	//zero indicates whether the array should be set to zero as opposed
 		//to being set to infinity, it is false by default
 
@@ -2930,23 +2804,25 @@ pfunctionclass::pfunctionclass(int size) {
 	infinite = (PFPRECISION) 0;
 
     Size = size;
-    /*register*/ int i,j;
-    dg = new PFPRECISION *[size+1];
+    /*register*/ int i;
+	long total,offset;
+
+	mapping = NULL;
+	dg = new PFPRECISION *[size+1];
+	if (!allocate) {
+		block = NULL;
+		for (i=0;i<=size;++i) dg[i] = NULL;
+		return;
+	}
 
-	for (i=0;i<=(size);i++)  {
-   		dg[i] = new PFPRECISION [size+1];
-   	}
-    for (i=0;i<=size;i++) {
-         for (j=0;j<size+1;j++) {
-
-             dg[i][j] = (PFPRECISION) 0;
-         }
-    }
-	
+	//The rows are carved out of one allocation, row i holds j=i..i+size
+	total = (long) (size+1)*(size+1);
+	block = new PFPRECISION [total];
+	for (offset=0;offset<total;offset++) block[offset] = (PFPRECISION) 0;
 
 	//Move pointers for faster access:
-	for (i=1;i<=size;++i) {
-		dg[i]-=i;
+	for (i=0;i<=size;++i) {
+		dg[i] = block + (long) i*(size+1) - i;
 
 	}
 
@@ -2955,15 +2831,21 @@ pfunctionclass::pfunctionclass(int size) {
 //the destructor deallocates the space used
 pfunctionclass::~pfunctionclass() {
 
+	if (mapping!=NULL) mapping->release();
+	else delete[] block;
+	delete[] dg;
+}
 
+void pfunctionclass::attach(PFPRECISION *values, savemapping *owner) {
 	int i;
 
-    for (i=0;i<=Size;i++) {
-		//restore the pointer position before deleting
-		dg[i]+=i;
-        delete[] dg[i];
-    }
-     delete[] dg;
+	if (mapping!=NULL) mapping->release();
+	else delete[] block;
+
+	owner->hold();
+	mapping = owner;
+	block = values;
+	for (i=0;i<=Size;++i) dg[i] = block + (long) i*(Size+1) - i;
 }
 
       //f is an integer function that references the correct element of the array
@@ -3114,7 +2996,8 @@ PFPRECISION erg1(int i,int j,int ip,int jp,structure *ct, pfdatatable *data)
       		energy = data->stack[(ct->numseq[i])][(ct->numseq[j])]
 				[(ct->numseq[ip])][(ct->numseq[jp])]*data->eparam[1];
 
-				if (ct->shaped) {
+				//with the three-state reactivity model, SHAPE is applied to V in the fill instead (see pfthreestate)
+				if (ct->shaped&&!pfthreestate(ct)) {
 					energy=energy*ct->SHAPE[i];
 					energy=energy*ct->SHAPE[j];
 					energy=energy*ct->SHAPE[ip];
@@ -3123,7 +3006,7 @@ PFPRECISION erg1(int i,int j,int ip,int jp,structure *ct, pfdatatable *data)
 
 				if ( ct->experimentalPairBonusExists ) {
 
-				    energy = energy * ct->EX[i][j] * ct->EX[ip][jp];
+				    energy = energy * ct->EX->f(i,j) * ct->EX->f(ip,jp);
 
 				}
 		}
@@ -3675,11 +3558,12 @@ PFPRECISION ergcoaxinterbases2(int i, int j, int ip, int jp, structure *ct, pfda
 //#endif
 
 
-void readpfsave(const char *filename, structure *ct,
+int readpfsave(const char *filename, structure *ct,
 			 PFPRECISION *w5, PFPRECISION *w3,
-			 pfunctionclass *v, pfunctionclass *w, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl, pfunctionclass *wcoax,
+			 pfunctionclass *v, pfunctionclass **v2, pfunctionclass *w, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl, pfunctionclass *wcoax,
 			 forceclass *fce, PFPRECISION *scaling, bool *mod, bool *lfce, pfdatatable *data) {
 	 int i,j,k,l,m,n,o,p;
+	bool threestate = false;
 	ifstream sav(filename,ios::binary);
 	int inc[6][6]={{0,0,0,0,0,0},{0,0,0,0,1,0},{0,0,0,1,0,0},{0,0,1,0,1,0},
 	{0,1,0,1,0,0},{0,0,0,0,0,0}};//a mask array indicating the identity of canonical pairs
@@ -3780,56 +3664,29 @@ void readpfsave(const char *filename, structure *ct,
 	read(&sav,&(ct->shaped));
 	if (ct->shaped) {
 		ct->SHAPE = new double [2*ct->GetSequenceLength()+1];
-		for (i=0;i<=2*ct->GetSequenceLength();i++) read(&sav,&(ct->SHAPE[i]));
+		sav.read((char *) ct->SHAPE,(2*ct->GetSequenceLength()+1)*sizeof(double));
 		ct->SHAPEss = new double [2 * ct->GetSequenceLength() + 1];
-		for (i=0;i<=2*ct->GetSequenceLength();i++) read(&sav,&(ct->SHAPEss[i]));
-
-	}
-
-
-	//now read the array class data for v, w, and wmb:
-	for (i=0;i<=ct->GetSequenceLength();i++) {
-		read(&sav,&(w3[i]));
-		read(&sav,&(w5[i]));
-//<<<<<<< pfunction.cpp
-//		for (j=0;j<=ct->GetSequenceLength();j++) {
-//			read(&sav,&(v->dg[i][j]));
-//			read(&sav,&(w->dg[i][j]));
-//			read(&sav,&(wmb->dg[i][j]));
-//			read(&sav,&(wmbl->dg[i][j]));
-//			read(&sav,&(wl->dg[i][j]));
-//			read(&sav,&(wcoax->dg[i][j]));
-//=======
-		for (j=0;j<=ct->GetSequenceLength();j++) {
-			read(&sav,&(v->dg[i][j+i]));
-			read(&sav,&(w->dg[i][j+i]));
-			read(&sav,&(wmb->dg[i][j+i]));
-			read(&sav,&(wmbl->dg[i][j+i]));
-			read(&sav,&(wl->dg[i][j+i]));
-			read(&sav,&(wcoax->dg[i][j+i]));
-//>>>>>>> 1.30
-			readsinglechar(&sav,&(fce->dg[i][j]));
-			//if (ct->intermolecular) {
-			//	read(&sav,&(w2->dg[i][j]));
-			//	read(&sav,&(wmb2->dg[i][j]));
-
-			//}
-
-
+		sav.read((char *) ct->SHAPEss,(2*ct->GetSequenceLength()+1)*sizeof(double));
+		ct->SHAPEss_sums();
+
+		read(&sav,&threestate);
+		if (threestate) {
+			ct->SHAPEdiff = new double [2*ct->GetSequenceLength()+1];
+			sav.read((char *) ct->SHAPEdiff,(2*ct->GetSequenceLength()+1)*sizeof(double));
+			ct->SHAPEFileRead = true;
+			ct->twoStateVersion = false;
 		}
 
-
 	}
+	//v2 is attached to its block below
+	if (threestate) *v2 = new pfunctionclass(ct->GetSequenceLength(),false);
+	else *v2 = NULL;
 
-	read(&sav,&(w3[ct->GetSequenceLength()+1]));
-	for (i=0;i<=2*ct->GetSequenceLength();i++) {
-		read(&sav,&(lfce[i]));
-		read(&sav,&(mod[i]));
-
-	}
-
-
-
+	//w5, w3 and the nucleotide constraints
+	sav.read((char *) w5,(ct->GetSequenceLength()+1)*sizeof(PFPRECISION));
+	sav.read((char *) w3,(ct->GetSequenceLength()+2)*sizeof(PFPRECISION));
+	sav.read((char *) lfce,(2*ct->GetSequenceLength()+1)*sizeof(bool));
+	sav.read((char *) mod,(2*ct->GetSequenceLength()+1)*sizeof(bool));
 
 
 	//now read the thermodynamic data:
@@ -3911,20 +3768,50 @@ void readpfsave(const char *filename, structure *ct,
 	read(&sav,&(data->singlecbulge));
 	read(&sav,&(data->maxintloopsize));
 
+	//the arrays are used in place, from the blocks at the end of the file (see savemapping)
+	pfunctionclass *arrays[7] = {v,w,wmb,wmbl,wl,wcoax,*v2};
+	int arraycount = threestate ? 7 : 6;
+	long long bytes[8];
+	for (i=0;i<arraycount;i++) bytes[i] = (long long) (ct->GetSequenceLength()+1)*(ct->GetSequenceLength()+1)*sizeof(PFPRECISION);
+	bytes[arraycount] = fce->GetBlockSize();
+
+	vector<saveblock> blocks;
+	if (!readsavedirectory(&sav,blocks)||(int) blocks.size()!=arraycount+1||!checksaveblocks(&sav,blocks,bytes)) {
+		//a truncated or corrupt save file
+		return 16;
+	}
+	sav.close();
 
+	savemapping *mapping = savemapping::open(filename,blocks);
+	for (i=0;i<arraycount;i++) arrays[i]->attach((PFPRECISION *) mapping->block(i),mapping);
+	fce->attach((char *) mapping->block(arraycount),mapping);
+	mapping->release();
 
-	sav.close();
+	return 0;
 }
 
 //return the pairing probability of the i=j pair, where i<j.
-PFPRECISION calculateprobability(int i, int j, pfunctionclass *v, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce) {
-	PFPRECISION interior, exterior;
+PFPRECISION calculateprobability(int i, int j, pfunctionclass *v, pfunctionclass *v2, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce) {
+	PFPRECISION interior, exterior, stacked, helixend;
 	int before,after;
 	int inc[6][6]={{0,0,0,0,0,0},{0,0,0,0,1,0},{0,0,0,1,0,0},{0,0,1,0,1,0},
 	{0,1,0,1,0,0},{0,0,0,0,0,0}};
 	bool adjacentgu;
 
+	if (v2!=NULL) {
+		//With the three-state reactivity model, V and V' both include the helix-end constants of i-j, and
+		//i-j is stacked when it stacks on a pair both inside (v2) and outside (v2').
+		helixend = pfhelixend(i,j,ct);
+		if (helixend<EPSILON) return 0.0;
+	}
+
 	if (!mod[i]&&!mod[j]) {
+		if (v2!=NULL) {
+			stacked = v2->f(i,j)*v2->f(j,i+ct->GetSequenceLength())*(pfstacked(i,j,ct)-1);
+			if (ct->constant==NULL) return (v->f(i,j)*v->f(j,i+ct->GetSequenceLength())+stacked)/(w5[ct->GetSequenceLength()]*scaling*scaling*helixend);
+			if (ct->constant[j][i]<EPSILON) return 0.0;
+			return (v->f(i,j)*v->f(j,i+ct->GetSequenceLength())+stacked)/(w5[ct->GetSequenceLength()]*scaling*scaling*ct->constant[j][i]*helixend);
+		}
 		if (ct->constant==NULL) return (v->f(i,j)*v->f(j,i+ct->GetSequenceLength()))/(w5[ct->GetSequenceLength()]*scaling*scaling);
 		else {
 			//constant is being used.
@@ -3964,10 +3851,17 @@ PFPRECISION calculateprobability(int i, int j, pfunctionclass *v, PFPRECISION *w
 			//if there are no stackable pairs to i.j then don't allow a pair i,j
 			if ((before!=0)||(after!=0)) {
 
-				if (i+1<j-1&&!adjacentgu) interior = erg1(i,j,i+1,j-1,ct,data)*v->f(i+1,j-1);
+				if (i+1<j-1&&!adjacentgu) interior = erg1(i,j,i+1,j-1,ct,data)*pfvstack(i+1,j-1,v,v2,ct);
 				else interior = (PFPRECISION) 0;
-				if (j+1<=ct->GetSequenceLength()&&!adjacentgu) exterior = erg1(j,i+ct->GetSequenceLength(),j+1,i+ct->GetSequenceLength()-1,ct,data)*v->f(j+1,i+ct->GetSequenceLength()-1);
+				if (j+1<=ct->GetSequenceLength()&&!adjacentgu) exterior = erg1(j,i+ct->GetSequenceLength(),j+1,i+ct->GetSequenceLength()-1,ct,data)*pfvstack(j+1,i+ct->GetSequenceLength()-1,v,v2,ct);
 				else exterior = (PFPRECISION) 0;
+				if (v2!=NULL) {
+					//the implicitly stacked pairs are stacked on the inside or the outside, respectively
+					interior = interior*helixend;
+					exterior = exterior*helixend;
+					stacked = ((v2->f(i,j)+interior)*(v2->f(j,i+ct->GetSequenceLength())+exterior)-interior*exterior)*(pfstacked(i,j,ct)-1);
+					return ((v->f(i,j)+interior)*(v->f(j,i+ct->GetSequenceLength())+exterior)-interior*exterior+stacked)/(w5[ct->GetSequenceLength()]*scaling*scaling*helixend);
+				}
 				return ((v->f(i,j)+interior)*(v->f(j,i+ct->GetSequenceLength())+exterior)-interior*exterior)/(w5[ct->GetSequenceLength()]*scaling*scaling);
 			}
 			else return 0;
@@ -3983,7 +3877,7 @@ PFPRECISION calculateprobability(int i, int j, pfunctionclass *v, PFPRECISION *w
 //function to rescale all arrays when partition function calculation is headed out of bounds
 
 
-void rescale(int i, int j, structure *ct, pfdatatable *data, pfunctionclass *v, pfunctionclass *w, pfunctionclass *wl, pfunctionclass *wcoax,
+void rescale(int i, int j, structure *ct, pfdatatable *data, pfunctionclass *v, pfunctionclass *v2, pfunctionclass *w, pfunctionclass *wl, pfunctionclass *wcoax,
 			 pfunctionclass *wmb,pfunctionclass *wmbl, PFPRECISION *w5, PFPRECISION *w3, PFPRECISION **wca, 
 			 PFPRECISION **curE, PFPRECISION **prevE, PFPRECISION rescalefactor) {
 
@@ -4138,6 +4032,7 @@ void rescale(int i, int j, structure *ct, pfdatatable *data, pfunctionclass *v,
 #endif //debug
 			//rescale v,w,wl,wcoax,wmb,wmbl,wca
 			v->f(ii,jj)=v->f(ii,jj)*multiplier;
+			if (v2!=NULL) v2->f(ii,jj)=v2->f(ii,jj)*multiplier;
 			w->f(ii,jj)=w->f(ii,jj)*multiplier;
 			wl->f(ii,jj)=wl->f(ii,jj)*multiplier;
 			wcoax->f(ii,jj)=wcoax->f(ii,jj)*multiplier;
@@ -4158,7 +4053,6 @@ void rescale(int i, int j, structure *ct, pfdatatable *data, pfunctionclass *v,
 	}
 
 	if (curE!=NULL) {
-			//curE and preE are not used in SMP mode:
 		//rescale curE and prevE
 		for (ii=((h<=(number-2))?1:(2*number-h-1));ii<=((h<=(number-2))?(number-h):number);ii++)
 		for (dp=1;dp<=d-1;dp++){
@@ -4269,7 +4163,7 @@ void thresh_structure(structure *ct, char *pfsfile, double thresh) {
 	int i,j;
 	int vers;
 	PFPRECISION *w5, *w3, scaling;
-	pfunctionclass *v, *w,*wmb,*wmbl,*wl,*wcoax;
+	pfunctionclass *v,*v2,*w,*wmb,*wmbl,*wl,*wcoax;
 	forceclass *fce;
 	bool *mod,*lfce;
 	pfdatatable *data;
@@ -4302,13 +4196,14 @@ void thresh_structure(structure *ct, char *pfsfile, double thresh) {
 
 	ct->allocate(SequenceLength);
 
-	w = new pfunctionclass(ct->GetSequenceLength());
-	v = new pfunctionclass(ct->GetSequenceLength());
-	wmb = new pfunctionclass(ct->GetSequenceLength());
-	wmbl = new pfunctionclass(ct->GetSequenceLength());
-	wcoax = new pfunctionclass(ct->GetSequenceLength());
-	wl = new pfunctionclass(ct->GetSequenceLength());
-	fce = new forceclass(ct->GetSequenceLength());
+	//the arrays are attached to the blocks of the save file by readpfsave
+	w = new pfunctionclass(ct->GetSequenceLength(),false);
+	v = new pfunctionclass(ct->GetSequenceLength(),false);
+	wmb = new pfunctionclass(ct->GetSequenceLength(),false);
+	wmbl = new pfunctionclass(ct->GetSequenceLength(),false);
+	wcoax = new pfunctionclass(ct->GetSequenceLength(),false);
+	wl = new pfunctionclass(ct->GetSequenceLength(),false);
+	fce = new forceclass(ct->GetSequenceLength(),0,false);
 
 	w5 = new PFPRECISION [ct->GetSequenceLength()+1];
 	w3 = new PFPRECISION [ct->GetSequenceLength()+2];
@@ -4318,20 +4213,20 @@ void thresh_structure(structure *ct, char *pfsfile, double thresh) {
 
 	data = new pfdatatable();
 
-	//load all the data from the pfsavefile:
-	readpfsave(pfsfile, ct, w5, w3,v, w, wmb,wl, wmbl, wcoax, fce,&scaling,mod,lfce,data);
+	//load all the data from the pfsavefile; a truncated or corrupt file leaves the structure without pairs
+	int error = readpfsave(pfsfile, ct, w5, w3,v,&v2, w, wmb,wl, wmbl, wcoax, fce,&scaling,mod,lfce,data);
 
 	//reset the base pairing info:
 	//for (i=1;i<=ct->GetSequenceLength();i++) ct->basepr[1][i]=0;
 
 	ct->AddStructure();
 	//fill array with the values for the plot:
-	for (i=1;i<ct->GetSequenceLength();i++) {
+	for (i=1;i<ct->GetSequenceLength()&&error==0;i++) {
 		for (j=i+1;j<=ct->GetSequenceLength();j++) {
 
 
 
-			if(calculateprobability(i,j,v,w5,ct,data,lfce,mod,scaling,fce)>thresh) {
+			if(calculateprobability(i,j,v,v2,w5,ct,data,lfce,mod,scaling,fce)>thresh) {
 
 				ct->SetPair(i,j);
 
@@ -4349,6 +4244,7 @@ void thresh_structure(structure *ct, char *pfsfile, double thresh) {
 
 	delete w;
 	delete v;
+	delete v2;
 	delete wmb;
 	delete fce;
 	delete[] w5;
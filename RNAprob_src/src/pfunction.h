@@ -16,11 +16,15 @@
 #include "algorithm.h"
 
 
+class savemapping;
+
 ////////////////////////////////////////////////////////////////////////
 //pfunctionclass encapsulates the large 2-d arrays of w and v, used by the 
 //	partition function
 class pfunctionclass {
    int Size;
+   PFPRECISION *block;
+   savemapping *mapping;
 
    public:
    	
@@ -30,11 +34,16 @@ class pfunctionclass {
       
 
       //the constructor allocates the space needed by the arrays
-   	pfunctionclass(int size);
+      //if allocate is false, nothing is allocated, and the array must be attached to a block of a save file before it is used
+   	pfunctionclass(int size, bool allocate = true);
 
       //the destructor deallocates the space used
       ~pfunctionclass();
 
+      //use values, a block of a save file laid out as the block of this array, in place of the array's own,
+      //holding mapping until the array is deleted (see savemapping)
+      void attach(PFPRECISION *values, savemapping *owner);
+
       //f is an integer function that references the correct element of the array
 	  inline PFPRECISION &f(int i, int j) {
 				  
@@ -82,6 +91,31 @@ public:
 };
 
 
+//The three-state reactivity model (helix-end / stacked / unpaired) in the partition function.
+//In this model ct->SHAPE holds the equilibrium constant of a paired nucleotide at a helix end and
+//ct->SHAPEdiff the additional constant for a paired nucleotide whose pair is stacked on both sides.
+//V(i,j) then includes the helix-end constants of i and j once, and the array v2 holds the part of V(i,j)
+//in which i-j stacks on i+1,j-1.  v2 is only allocated (otherwise NULL) when the model is used.
+inline bool pfthreestate(structure *ct) {
+	return ct->shaped&&ct->SHAPEFileRead&&!ct->twoStateVersion;
+}
+
+//the helix-end equilibrium constant of pair i-j
+inline PFPRECISION pfhelixend(int i, int j, structure *ct) {
+	return ct->SHAPE[i]*ct->SHAPE[j];
+}
+
+//the additional equilibrium constant of pair i-j when it is stacked on both sides
+inline PFPRECISION pfstacked(int i, int j, structure *ct) {
+	return ct->SHAPEdiff[i]*ct->SHAPEdiff[j];
+}
+
+//V(i,j) as seen from a pair that stacks on i-j from outside
+inline PFPRECISION pfvstack(int i, int j, pfunctionclass *v, pfunctionclass *v2, structure *ct) {
+	if (v2==NULL) return v->f(i,j);
+	else return v->f(i,j)+v2->f(i,j)*(pfstacked(i,j,ct)-1);
+}
+
 PFPRECISION pfchecknp(bool lfce1,bool lfce2);
 PFPRECISION erg1(int i,int j,int ip,int jp,structure *ct,pfdatatable *data);
 		//calculates equilibrium constant of stacked base pairs
@@ -112,16 +146,18 @@ void pfunction(structure* ct,pfdatatable* data, TProgressDialog* update, char* s
 //writepfsave writes a save file with partition function data.
 void writepfsave(char *filename, structure *ct, 
 			 PFPRECISION *w5, PFPRECISION *w3, 
-			 pfunctionclass *v, pfunctionclass *w, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl, pfunctionclass *wcoax,
+			 pfunctionclass *v, pfunctionclass *v2, pfunctionclass *w, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl, pfunctionclass *wcoax,
 			 forceclass *fce, bool *mod, bool *lfce, pfdatatable *data);
 
 //readpfsave reads a save file with partition function data.
-void readpfsave(const char *filename, structure *ct, 
+//*v2 is allocated here if the save file uses the three-state reactivity model, and is set to NULL otherwise.
+//Returns 0, or 16 if the arrays at the end of the file are missing or do not match the sequence (a truncated or corrupt file).
+int readpfsave(const char *filename, structure *ct, 
 			 PFPRECISION *w5, PFPRECISION *w3, 
-			 pfunctionclass *v, pfunctionclass *w, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl, pfunctionclass *wcoax,
+			 pfunctionclass *v, pfunctionclass **v2, pfunctionclass *w, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl, pfunctionclass *wcoax,
 			 forceclass *fce, PFPRECISION *scaling, bool *mod, bool *lfce, pfdatatable *data);
-PFPRECISION calculateprobability(int i, int j, pfunctionclass *v, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce);
-void rescale(int i, int j,structure *ct, pfdatatable *data, pfunctionclass *v, pfunctionclass *w, pfunctionclass *wl, pfunctionclass *wcoax,
+PFPRECISION calculateprobability(int i, int j, pfunctionclass *v, pfunctionclass *v2, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce);
+void rescale(int i, int j,structure *ct, pfdatatable *data, pfunctionclass *v, pfunctionclass *v2, pfunctionclass *w, pfunctionclass *wl, pfunctionclass *wcoax,
 			 pfunctionclass *wmb,pfunctionclass *wmbl, PFPRECISION *w5, PFPRECISION *w3, PFPRECISION **wca, PFPRECISION **curE, PFPRECISION **prevE, PFPRECISION rescalefactor); //function to rescale all arrays when partition function calculation is headed out
 															//of bounds
 //void rescaleatw3(int ii,structure *ct, pfdatatable *data, pfunctionclass *v, pfunctionclass *w, pfunctionclass *wl, pfunctionclass *wcoax,
@@ -134,7 +170,7 @@ void thresh_structure(structure *ct, char *pfsfile, double thresh); //determine
 
 //calculate a the partition function, given that the arrays have been allocated
 void calculatepfunction(structure* ct,pfdatatable* data, TProgressDialog* update, char* save, bool quickQ, PFPRECISION *Q,
-	pfunctionclass *w, pfunctionclass *v, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl,
+	pfunctionclass *w, pfunctionclass *v, pfunctionclass *v2, pfunctionclass *wmb, pfunctionclass *wl, pfunctionclass *wmbl,
 	pfunctionclass *wcoax, forceclass *fce,PFPRECISION *w5,PFPRECISION *w3,bool *mod, bool *lfce);
 
 
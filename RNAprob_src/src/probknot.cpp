@@ -3,7 +3,7 @@
 
 
 //Assemble the ProbKnot structure from base pair probabilities.
-int ProbKnotAssemble(pfunctionclass *v, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce, int iterations, int MinHelixLength) {
+int ProbKnotAssemble(pfunctionclass *v, pfunctionclass *v2, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce, int iterations, int MinHelixLength) {
 
 	PFPRECISION **probs,*rowprob;
 	int i,j,iter;
@@ -25,7 +25,7 @@ int ProbKnotAssemble(pfunctionclass *v, PFPRECISION *w5, structure *ct, pfdatata
 	}
     
     //Read the partition function and populate "probs" and "rowprob" arrays with probabilities
-    ProbKnotPartition( v, w5, ct, data, lfce, mod, scaling, fce, probs, rowprob );
+    ProbKnotPartition( v, v2, w5, ct, data, lfce, mod, scaling, fce, probs, rowprob );
 
     //Calculate maximum expected accuracy structure
     ProbKnotCompute( ct, probs, rowprob, iterations, MinHelixLength );
@@ -75,13 +75,13 @@ int ProbKnotAssemble( structure *ct, int iterations, int MinHelixLength) {
     return 0;
 }
 
-int ProbKnotPartition( pfunctionclass *v, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce, PFPRECISION **probs, PFPRECISION *rowprob ){
+int ProbKnotPartition( pfunctionclass *v, pfunctionclass *v2, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce, PFPRECISION **probs, PFPRECISION *rowprob ){
 
 	//First determine pair probabilities:
 	for (int i=1;i<ct->GetSequenceLength();i++) {
 		for (int j=i+minloop+1;j<=ct->GetSequenceLength();j++) {
 		
-			probs[j][i] = calculateprobability(i,j,v,w5,ct,data,lfce,mod,scaling,fce);
+			probs[j][i] = calculateprobability(i,j,v,v2,w5,ct,data,lfce,mod,scaling,fce);
 
 			//also accumulate the best probs for each nucleotide:
 			if (probs[j][i]>rowprob[i]) rowprob[i] = probs[j][i];
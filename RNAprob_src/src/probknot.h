@@ -17,7 +17,7 @@
 //fce, a pointer to forceclass, as used by the previous partition function calculation.
 //iteration, an int that indicates the number of assembly iteration to be performed, the defaulty and recommended value are 1.
 //MinHelixLength, and int that indicates the shortest helix length allowed.  This defaulst to 1, the recommended value.
-int ProbKnotAssemble(pfunctionclass *v, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce, int iterations =1, int MinHelixLength=1 );
+int ProbKnotAssemble(pfunctionclass *v, pfunctionclass *v2, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce, int iterations =1, int MinHelixLength=1 );
 
 //return an int that indicates errors.  0 = no error.
 //This requires: ct, a pointer to structure, which is filled with ensemble of structures.
@@ -36,7 +36,7 @@ int ProbKnotAssemble( structure *ct, int iterations =1, int MinHelixLength=1 );
 //fce, a pointer to forceclass, as used by the previous partition function calculation.
 //probs, a two-dimentional PFPRECISION array, which is filled with pair probabilities from partition function
 //rowprob, a PFPRECISION array, which is filled with highest probabilities for a given nucleotide from probs
-int ProbKnotPartition( pfunctionclass *v, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce, PFPRECISION **probs, PFPRECISION *rowprob );
+int ProbKnotPartition( pfunctionclass *v, pfunctionclass *v2, PFPRECISION *w5, structure *ct, pfdatatable *data, bool *lfce, bool *mod, PFPRECISION scaling, forceclass *fce, PFPRECISION **probs, PFPRECISION *rowprob );
     
 //return an int that indicates errors.  0 = no error.
 //This requires: ct, a pointer to structure, which is filled with ensemble of structures.
@@ -0,0 +1,126 @@
+#include "profile.h"
+#include "minplus.h"
+
+#if defined(_WIN32)
+#include <ctime>
+#else
+#include <sys/time.h>
+#endif
+
+using namespace std;
+
+profiledata profile;
+
+profiledata::profiledata() {
+	enabled = false;
+
+	filltime = 0;
+	tracebacktime = 0;
+	filtertime = 0;
+	SHAPEtime = 0;
+	thermodynamictime = 0;
+	trainingparamtime = 0;
+
+	erg1count = 0;
+	erg2count = 0;
+	erg2incount = 0;
+	erg2excount = 0;
+	erg3count = 0;
+	erg4count = 0;
+
+	internalcandidates = 0;
+	internalpairs = 0;
+	maxinternalcandidates = 0;
+	maxinternali = 0;
+	maxinternalj = 0;
+}
+
+void profiledata::addinternal(int i, int j, long long candidates) {
+	internalcandidates += candidates;
+	internalpairs++;
+	if (candidates>maxinternalcandidates) {
+		maxinternalcandidates = candidates;
+		maxinternali = i;
+		maxinternalj = j;
+	}
+}
+
+//folds run in parallel (batch, bootstrap and sweep) record their allocations at the same time
+void profiledata::addallocation(const char *name, long long bytes) {
+#ifdef SMP
+#pragma omp critical(profileallocation)
+#endif
+	{
+		unsigned int i;
+		for (i=0;i<allocations.size();i++) {
+			if (allocations[i].first==name) {
+				if (bytes>allocations[i].second) allocations[i].second = bytes;
+				break;
+			}
+		}
+		if (i==allocations.size()) allocations.push_back(make_pair(string(name),bytes));
+	}
+}
+
+void profiledata::addtime(double &step, double seconds) {
+#ifdef SMP
+#pragma omp atomic
+#endif
+	step += seconds;
+}
+
+void profiledata::write(ostream &out) {
+	long long total = 0;
+
+	out << "  \"time\": {\n";
+	out << "    \"thermodynamic_tables\": " << thermodynamictime << ",\n";
+	out << "    \"training_parameters\": " << trainingparamtime << ",\n";
+	out << "    \"ReadSHAPE\": " << SHAPEtime << ",\n";
+	out << "    \"fill\": " << filltime << ",\n";
+	out << "    \"traceback\": " << tracebacktime << ",\n";
+	out << "    \"filter\": " << filtertime << "\n";
+	out << "  },\n";
+
+	out << "  \"minplus\": \"" << minplusversion() << "\",\n";
+
+	//counted says whether this build counts the calls (see PROFILECOUNT); the counts of the serial profiling build are exact
+	out << "  \"calls\": {\n";
+#ifdef PROFILECOUNTS
+	out << "    \"counted\": true,\n";
+	out << "    \"erg1\": " << erg1count << ",\n";
+	out << "    \"erg2\": " << erg2count << ",\n";
+	out << "    \"erg2in\": " << erg2incount << ",\n";
+	out << "    \"erg2ex\": " << erg2excount << ",\n";
+	out << "    \"erg3\": " << erg3count << ",\n";
+	out << "    \"erg4\": " << erg4count << "\n";
+#else
+	out << "    \"counted\": false\n";
+#endif
+	out << "  },\n";
+
+	out << "  \"internal_loops\": {\n";
+	out << "    \"candidates\": " << internalcandidates << ",\n";
+	out << "    \"pairs\": " << internalpairs << ",\n";
+	out << "    \"candidates_per_pair\": " << (internalpairs>0?(double) internalcandidates/internalpairs:0) << ",\n";
+	out << "    \"max_candidates\": " << maxinternalcandidates << ",\n";
+	out << "    \"max_pair\": [" << maxinternali << ", " << maxinternalj << "]\n";
+	out << "  },\n";
+
+	out << "  \"memory_bytes\": {\n";
+	for (unsigned int i=0;i<allocations.size();i++) {
+		out << "    \"" << allocations[i].first << "\": " << allocations[i].second << ",\n";
+		total += allocations[i].second;
+	}
+	out << "    \"total\": " << total << "\n";
+	out << "  }\n";
+}
+
+double profiletime() {
+#if defined(_WIN32)
+	return (double) clock()/CLOCKS_PER_SEC;
+#else
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	return now.tv_sec+now.tv_usec/1e6;
+#endif
+}
@@ -0,0 +1,79 @@
+#if !defined(PROFILE_H)
+#define PROFILE_H
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+//profiledata collects timings and counts from the fold pipeline, for the --profile option of RNAprob.
+//Collection is switched on at run time with enabled; when it is off, each timer and record costs one test.
+//The times, allocations and internal loop candidates are synchronized between threads.
+//The calls to the free energy functions are only counted by the profiling build (make RNAprob-profile),
+//which defines PROFILECOUNTS and is serial, so its counts are exact; in the other builds PROFILECOUNT
+//compiles to nothing, and the energy functions, which the fill threads call concurrently, carry neither
+//a test nor a shared counter.
+#ifdef PROFILECOUNTS
+#ifdef SMP
+#error "the energy function calls are counted without synchronization, so the profiling build must be serial"
+#endif
+#define PROFILECOUNT(counter) (profile.counter++)
+#else
+#define PROFILECOUNT(counter)
+#endif
+
+class profiledata {
+	public:
+		/*	make an empty, disabled profile	*/
+		profiledata();
+
+		bool enabled;
+
+		//wall time in seconds spent in each step, summed over calls
+		double filltime,tracebacktime,filtertime,SHAPEtime,thermodynamictime,trainingparamtime;
+
+		//number of calls to the free energy functions (erg2in and erg2ex are the halves of erg2 used by the O(N^3) internal loop search),
+		//only counted with PROFILECOUNTS
+		long long erg1count,erg2count,erg2incount,erg2excount,erg3count,erg4count;
+
+		//internal loop candidates (ip,jp) visited by fill, in total, the number of pairs i,j that
+		//visited any, and the pair with the most
+		long long internalcandidates,internalpairs,maxinternalcandidates;
+		int maxinternali,maxinternalj;
+
+		//bytes allocated for each dynamic programming matrix, in order of allocation
+		std::vector< std::pair<std::string,long long> > allocations;
+
+		/*	record the internal loop candidates visited for i,j	*/
+		void addinternal(int i, int j, long long candidates);
+		/*	record the memory allocated for a matrix; repeated names (e.g. bootstrap replicates) keep the largest	*/
+		void addallocation(const char *name, long long bytes);
+		/*	add seconds to the time of a step	*/
+		void addtime(double &step, double seconds);
+		/*	write the profile as the members of a JSON object	*/
+		void write(std::ostream &out);
+};
+
+//the profile of the current run
+extern profiledata profile;
+
+//wall clock time in seconds, used to time the steps of the profile
+double profiletime();
+
+//profiletimer adds the wall time of its scope to a step of the profile, when the profile is enabled
+class profiletimer {
+	private:
+		double *step;
+		double start;
+
+	public:
+		profiletimer(double &time) {
+			step = profile.enabled ? &time : NULL;
+			if (step!=NULL) start = profiletime();
+		}
+		~profiletimer() {
+			if (step!=NULL) profile.addtime(*step,profiletime()-start);
+		}
+};
+
+#endif
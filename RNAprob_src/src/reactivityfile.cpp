@@ -0,0 +1,265 @@
+#include "reactivityfile.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+static const char reactivitymagic[8] = {'R','N','A','p','r','o','b','R'};
+
+//written as an int, so that a machine with the other byte order reads it differently
+static const int reactivitybyteorder = 0x01020304;
+
+//the blocks of a binary file, in order
+enum {NAMEOFFSETS,NAMES,FIRST,POSITIONS,VALUES,SORTED,BLOCKS};
+
+//orders record numbers by the IDs of the records, and by record number for equal IDs
+struct textidorder {
+	const vector<string> *ids;
+	bool operator()(int a, int b) const {return (*ids)[a]<(*ids)[b];}
+};
+
+struct binaryidorder {
+	const long long *nameoffsets;
+	const char *names;
+	bool operator()(int a, int b) const {return strcmp(names+nameoffsets[a],names+nameoffsets[b])<0;}
+};
+
+//the transcript ID on a > line, which is the first word after the >
+static string recordid(const string &line) {
+	size_t start = line.find_first_not_of(" \t",1);
+	if (start==string::npos) return "";
+	size_t end = line.find_first_of(" \t\r",start);
+	return line.substr(start,end==string::npos?string::npos:end-start);
+}
+
+reactivityfile::reactivityfile() {
+	count = 0;
+	mapping = NULL;
+	nameoffsets = NULL;
+	names = NULL;
+	first = NULL;
+	positions = NULL;
+	values = NULL;
+	sorted = NULL;
+}
+
+reactivityfile::~reactivityfile() {
+	if (mapping!=NULL) mapping->release();
+}
+
+reactivityfile *reactivityfile::open(const char *filename) {
+	reactivityheader header;
+	vector<saveblock> blocks;
+	long long filesize;
+	int i;
+
+	ifstream in(filename,ios::binary);
+	if (!in) return NULL;
+
+	reactivityfile *file = new reactivityfile();
+	file->filename = filename;
+
+	in.read((char *) &header,sizeof(header));
+	if (in&&memcmp(header.magic,reactivitymagic,sizeof(header.magic))==0) {
+		//the binary form
+		if (header.version!=reactivityfileversion||header.byteorder!=reactivitybyteorder||header.records<0||header.values<0) {
+			delete file;
+			return NULL;
+		}
+		readsavedirectory(&in,blocks);
+		in.seekg(0,ios::end);
+		filesize = (long long) in.tellg();
+		if (!in||blocks.size()!=BLOCKS) {
+			delete file;
+			return NULL;
+		}
+
+		//a mapping past the end of a truncated file would fault when it is read
+		long long expected[BLOCKS] = {header.records*(long long) sizeof(long long),-1,(header.records+1)*(long long) sizeof(long long),
+			header.values*(long long) sizeof(int),header.values*(long long) sizeof(double),header.records*(long long) sizeof(int)};
+		for (i=0;i<BLOCKS;i++) {
+			if ((expected[i]>=0&&blocks[i].bytes!=expected[i])||blocks[i].offset+blocks[i].bytes>filesize) {
+				delete file;
+				return NULL;
+			}
+		}
+
+		file->count = header.records;
+		file->mapping = savemapping::open(filename,blocks);
+		file->nameoffsets = (const long long *) file->mapping->block(NAMEOFFSETS);
+		file->names = (const char *) file->mapping->block(NAMES);
+		file->first = (const long long *) file->mapping->block(FIRST);
+		file->positions = (const int *) file->mapping->block(POSITIONS);
+		file->values = (const double *) file->mapping->block(VALUES);
+		file->sorted = (const int *) file->mapping->block(SORTED);
+		if (file->first[file->count]!=header.values||(blocks[NAMES].bytes>0&&file->names[blocks[NAMES].bytes-1]!=0)) {
+			delete file;
+			return NULL;
+		}
+		return file;
+	}
+
+	//the text form, which is indexed by reading it once; the offsets are counted from the line lengths, which is
+		//faster than asking the stream for each line
+	in.clear();
+	in.seekg(0,ios::beg);
+	string line;
+	long long offset = 0;
+	while (getline(in,line)) {
+		offset += (long long) line.size()+1;
+		if (line.size()>0&&line[0]=='>') {
+			file->textids.push_back(recordid(line));
+			file->textoffsets.push_back(offset);
+		}
+		else if (file->textids.empty()&&line.find_first_not_of(" \t\r")!=string::npos) {
+			//reactivities before the first ID belong to no transcript
+			delete file;
+			return NULL;
+		}
+	}
+
+	file->count = (int) file->textids.size();
+	file->textsorted.resize(file->count);
+	for (i=0;i<file->count;i++) file->textsorted[i] = i;
+	textidorder order;
+	order.ids = &file->textids;
+	stable_sort(file->textsorted.begin(),file->textsorted.end(),order);
+	return file;
+}
+
+int reactivityfile::records() const {
+	return count;
+}
+
+string reactivityfile::id(int record) const {
+	if (mapping!=NULL) return names+nameoffsets[record];
+	return textids[record];
+}
+
+//a binary search of the records in order of ID
+int reactivityfile::find(const string &id) const {
+	int low = 0,high = count;
+
+	while (low<high) {
+		int middle = (low+high)/2;
+		int record = mapping!=NULL ? sorted[middle] : textsorted[middle];
+		if (this->id(record)<id) low = middle+1;
+		else high = middle;
+	}
+	if (low<count) {
+		int record = mapping!=NULL ? sorted[low] : textsorted[low];
+		if (this->id(record)==id) return record;
+	}
+	return -1;
+}
+
+bool reactivityfile::read(int record, vector<int> &positions, vector<double> &reactivities) const {
+	long long k;
+
+	positions.clear();
+	reactivities.clear();
+	if (record<0||record>=count) return false;
+
+	if (mapping!=NULL) {
+		positions.assign(this->positions+first[record],this->positions+first[record+1]);
+		reactivities.assign(values+first[record],values+first[record+1]);
+		return true;
+	}
+
+	//each read opens the file, so that threads do not share a stream
+	ifstream in(filename.c_str(),ios::binary);
+	if (!in) return false;
+	in.seekg((streamoff) textoffsets[record]);
+
+	string line;
+	while (getline(in,line)) {
+		if (line.size()>0&&line[0]=='>') break;
+		const char *start = line.c_str();
+		char *end;
+		long position = strtol(start,&end,10);
+		if (end==start) {
+			//a blank line is skipped, anything else is not a reactivity
+			if (line.find_first_not_of(" \t\r")==string::npos) continue;
+			return false;
+		}
+		start = end;
+		double value = strtod(start,&end);
+		if (end==start) return false;
+		positions.push_back((int) position);
+		reactivities.push_back(value);
+	}
+	for (k=0;k<(long long) positions.size();k++) {
+		if (positions[k]<1) return false;
+	}
+	return true;
+}
+
+bool writereactivitybinary(const char *textfile, const char *binaryfile) {
+	reactivityheader header;
+	vector<long long> nameoffsets,first;
+	vector<char> names;
+	vector<int> positions,sorted,recordpositions;
+	vector<double> values,recordvalues;
+	int i;
+
+	reactivityfile *text = reactivityfile::open(textfile);
+	if (text==NULL) return false;
+
+	for (i=0;i<text->records();i++) {
+		if (!text->read(i,recordpositions,recordvalues)) {
+			delete text;
+			return false;
+		}
+		string id = text->id(i);
+		nameoffsets.push_back((long long) names.size());
+		names.insert(names.end(),id.begin(),id.end());
+		names.push_back(0);
+		first.push_back((long long) positions.size());
+		positions.insert(positions.end(),recordpositions.begin(),recordpositions.end());
+		values.insert(values.end(),recordvalues.begin(),recordvalues.end());
+	}
+	first.push_back((long long) positions.size());
+
+	//the index is sorted as the text index is, so find gives the same record in both forms
+	sorted.resize(text->records());
+	for (i=0;i<text->records();i++) sorted[i] = i;
+	if (!names.empty()) {
+		binaryidorder order;
+		order.nameoffsets = &nameoffsets[0];
+		order.names = &names[0];
+		stable_sort(sorted.begin(),sorted.end(),order);
+	}
+
+	memcpy(header.magic,reactivitymagic,sizeof(header.magic));
+	header.version = reactivityfileversion;
+	header.byteorder = reactivitybyteorder;
+	header.records = text->records();
+	header.unused = 0;
+	header.values = (long long) positions.size();
+	delete text;
+
+	ofstream out(binaryfile,ios::binary);
+	if (!out) return false;
+	out.write((char *) &header,sizeof(header));
+
+	vector<saveblock> blocks(BLOCKS);
+	blocks[NAMEOFFSETS].bytes = nameoffsets.size()*sizeof(long long);
+	blocks[NAMES].bytes = names.size();
+	blocks[FIRST].bytes = first.size()*sizeof(long long);
+	blocks[POSITIONS].bytes = positions.size()*sizeof(int);
+	blocks[VALUES].bytes = values.size()*sizeof(double);
+	blocks[SORTED].bytes = sorted.size()*sizeof(int);
+	writesavedirectory(&out,blocks);
+	writesaveblock(&out,blocks[NAMEOFFSETS],nameoffsets.empty()?NULL:&nameoffsets[0]);
+	writesaveblock(&out,blocks[NAMES],names.empty()?NULL:&names[0]);
+	writesaveblock(&out,blocks[FIRST],&first[0]);
+	writesaveblock(&out,blocks[POSITIONS],positions.empty()?NULL:&positions[0]);
+	writesaveblock(&out,blocks[VALUES],values.empty()?NULL:&values[0]);
+	writesaveblock(&out,blocks[SORTED],sorted.empty()?NULL:&sorted[0]);
+
+	out.close();
+	return !out.fail();
+}
@@ -0,0 +1,80 @@
+#ifndef REACTIVITYFILE_H
+#define REACTIVITYFILE_H
+
+#include <string>
+#include <vector>
+#include "defines.h"
+#include "savemapping.h"
+
+// A reactivity file holds the reactivity profiles of many transcripts, one
+// record per transcript, so that a transcriptome-wide experiment need not be
+// split into a file per transcript.  In the text form, each record is a line
+// with > and the transcript ID, followed by position and reactivity lines as
+// in a single reactivity file (see readreactivity):
+//   >ID
+//   1 0.25
+//   2 -999
+// The binary form, written by writereactivitybinary, holds the same records
+// as blocks that are mapped (see savemapping.h), with an index of the IDs.
+
+// The header identifies a binary reactivity file; a file of another version,
+// or from a machine with another byte order, is not used.
+struct reactivityheader {
+	char magic[8];
+	int version;
+	int byteorder;
+	int records;
+	int unused;
+	long long values;//the number of reactivities, in all records
+};
+
+// reactivityfile finds the records of a reactivity file, in either form, by
+// their transcript ID or by their order in the file.  Records are read
+// directly from the file, so several threads can read records at once.
+class reactivityfile {
+	public:
+		// index the records of filename; returns NULL if it cannot be read or is
+		// not a reactivity file
+		static reactivityfile *open(const char *filename);
+		~reactivityfile();
+
+		// the number of records, which are numbered from 0 in file order
+		int records() const;
+
+		// the transcript ID of record
+		std::string id(int record) const;
+
+		// the first record with transcript ID id, or -1 if there is none
+		int find(const std::string &id) const;
+
+		// the positions and reactivities of record, as readreactivity gives them
+		// for a single file; returns false if the record cannot be read
+		bool read(int record, std::vector<int> &positions, std::vector<double> &reactivities) const;
+
+	private:
+		reactivityfile();
+
+		std::string filename;
+		int count;
+
+		// the blocks of a mapped binary file, or NULL for a text file
+		savemapping *mapping;
+		const long long *nameoffsets;//of the ID of each record in names
+		const char *names;//the IDs, each followed by a zero
+		const long long *first;//of the first reactivity of each record, and the number of reactivities
+		const int *positions;
+		const double *values;
+		const int *sorted;//the records in order of ID
+
+		// the index of a text file: the IDs, the offset of the line after each
+		// ID, and the records in order of ID
+		std::vector<std::string> textids;
+		std::vector<long long> textoffsets;
+		std::vector<int> textsorted;
+};
+
+// convert the text reactivity file textfile to the binary form; returns false
+// if textfile cannot be read or binaryfile cannot be written
+bool writereactivitybinary(const char *textfile, const char *binaryfile);
+
+#endif
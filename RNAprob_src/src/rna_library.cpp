@@ -6,6 +6,7 @@
 #endif //_WINDOWS
 
 #include "rna_library.h"
+#include "profile.h"
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
@@ -1227,9 +1228,12 @@ integersize SHAPEendPair(int i, int j, structure *ct) {
 //   |  |
 //   j jp
 
+template <bool bonus>
 integersize erg1(int i,int j,int ip,int jp,structure *ct, datatable *data)
 {
 
+	PROFILECOUNT(erg1count);
+
 		integersize energy;
 
 		 if ((i==(ct->GetSequenceLength()))||(j==((ct->GetSequenceLength())+1))) {
@@ -1246,9 +1250,9 @@ integersize erg1(int i,int j,int ip,int jp,structure *ct, datatable *data)
 			//energy+=SHAPEend(ip,ct);
 			//energy+=SHAPEend(jp,ct);
 
-		if (ct->experimentalPairBonusExists ) {
-		  energy += 0.5 * ( ct->EX[i][j] + ct->EX[j][i] )
-		    + 0.5 * ( ct->EX[ip][jp] + ct->EX[jp][ip] );
+		if (bonus && ct->experimentalPairBonusExists ) {
+		  energy += 0.5 * ( ct->EX->f(i,j) + ct->EX->f(j,i) )
+		    + 0.5 * ( ct->EX->f(ip,jp) + ct->EX->f(jp,ip) );
 		}
 
 				//}
@@ -1257,13 +1261,24 @@ integersize erg1(int i,int j,int ip,int jp,structure *ct, datatable *data)
 		return energy;
 }
 
+template integersize erg1<true>(int i,int j,int ip,int jp,structure *ct, datatable *data);
+template integersize erg1<false>(int i,int j,int ip,int jp,structure *ct, datatable *data);
+
+integersize erg1(int i,int j,int ip,int jp,structure *ct, datatable *data)
+{
+	return erg1<true>(i,j,ip,jp,ct,data);
+}
+
 
 //calculate the energy of a bulge/internal loop
 //where i is paired to j; ip is paired to jp; ip > i; j > jp
+template <bool shaped>
 integersize erg2(int i,int j,int ip,int jp,structure *ct, datatable *data,
 	char a, char b)
 {
 
+	PROFILECOUNT(erg2count);
+
 	integersize energy;
 	int size,size1,size2,loginc, lopsid, energy2,count,k;
 	/* size,size1,size2 = size of a loop
@@ -1389,11 +1404,13 @@ integersize erg2(int i,int j,int ip,int jp,structure *ct, datatable *data,
 		//Introduces single stranded pseudoenergies from SHAPE data for interior/bulge loops
 		int SHAPEss_energy = 0;
 
-		if (size1 == 1) SHAPEss_energy += ct->SHAPEss_give_value(i + 1);
-		else if (size1 != 0) SHAPEss_energy += ct->SHAPEss_calc(i + 1, ip - 1);
+		if (shaped && ct->shaped) {
+			if (size1 == 1) SHAPEss_energy += ct->SHAPEss_give_value(i + 1);
+			else if (size1 != 0) SHAPEss_energy += ct->SHAPEss_calc(i + 1, ip - 1);
 
-		if (size2 == 1) SHAPEss_energy += ct->SHAPEss_give_value(j - 1);
-		else if (size2 != 0) SHAPEss_energy += ct->SHAPEss_calc(jp + 1, j - 1);
+			if (size2 == 1) SHAPEss_energy += ct->SHAPEss_give_value(j - 1);
+			else if (size2 != 0) SHAPEss_energy += ct->SHAPEss_calc(jp + 1, j - 1);
+		}
 
 
 		if (size1==0||size2==0) {//bulge loop
@@ -1566,11 +1583,22 @@ integersize erg2(int i,int j,int ip,int jp,structure *ct, datatable *data,
 		return energy;
 }
 
+template integersize erg2<true>(int i,int j,int ip,int jp,structure *ct, datatable *data,char a, char b);
+template integersize erg2<false>(int i,int j,int ip,int jp,structure *ct, datatable *data,char a, char b);
+
+integersize erg2(int i,int j,int ip,int jp,structure *ct, datatable *data,
+	char a, char b)
+{
+	return erg2<true>(i,j,ip,jp,ct,data,a,b);
+}
+
 //calculate the energy of the exterior part of a internal loop
 //which includes AU/GU penalty of the interior base pair + first mismatch bonus
 integersize erg2ex(int i,int j,int size,structure *ct, datatable *data)
 {
 
+	PROFILECOUNT(erg2excount);
+
 	integersize energy;
 	int loginc;
 	/* size,size1,size2 = size of a loop
@@ -1604,6 +1632,8 @@ integersize erg2ex(int i,int j,int size,structure *ct, datatable *data)
 integersize erg2in(int i,int j,int ip,int jp,structure *ct, datatable *data, char a, char b)
 {
 
+	PROFILECOUNT(erg2incount);
+
 	integersize energy;
 	int size1,size2,lopsid,energy2;
 	/* size,size1,size2 = size of a loop
@@ -1741,8 +1771,11 @@ integersize erg2in(int i,int j,int ip,int jp,structure *ct, datatable *data, cha
 
 
 //calculate the energy of a hairpin loop:
+template <bool shaped>
 integersize erg3(int i,int j,structure *ct, datatable *data,char dbl)
 {
+	PROFILECOUNT(erg3count);
+
 	integersize energy;
 	int size,loginc,count,key,k;
 
@@ -1845,7 +1878,7 @@ integersize erg3(int i,int j,structure *ct, datatable *data,char dbl)
 	  //energy+=(SHAPEend(i,ct)+SHAPEend(j,ct));
 
 	  //adds pseudo energy term for a hairpin loop based off of SHAPE data
-	  if (ct->shaped) energy += ct->SHAPEss_calc(i + 1, j - 1);
+	  if (shaped && ct->shaped) energy += ct->SHAPEss_calc(i + 1, j - 1);
 
       //check for an oligo-c loop
 
@@ -1859,11 +1892,21 @@ integersize erg3(int i,int j,structure *ct, datatable *data,char dbl)
 
 }
 
+template integersize erg3<true>(int i,int j,structure *ct, datatable *data,char dbl);
+template integersize erg3<false>(int i,int j,structure *ct, datatable *data,char dbl);
+
+integersize erg3(int i,int j,structure *ct, datatable *data,char dbl)
+{
+	return erg3<true>(i,j,ct,data,dbl);
+}
+
 
 
 //calculate the energy of a dangling end:
 integersize erg4(int i,int j,int ip,int jp,structure *ct, datatable *data, bool lfce)
 {
+	PROFILECOUNT(erg4count);
+
 	integersize energy;
 
 
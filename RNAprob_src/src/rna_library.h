@@ -90,9 +90,14 @@ void pull(stackstruct *stack,int *i,int *j,int *open,int *null,int *stz);
 
 integersize erg1(int i,int j,int ip,int jp,structure *ct,datatable *data);
 		//calculates energy of stacked base pairs
+template <bool bonus> integersize erg1(int i,int j,int ip,int jp,structure *ct,datatable *data);
+		//erg1<false> leaves out the experimental pair bonuses, for callers that know there are none
 integersize erg2(int i,int j,int ip,int jp,structure *ct,datatable *data,char a,
 	char b);
 		//calculates energy of a bulge/internal loop
+template <bool shaped> integersize erg2(int i,int j,int ip,int jp,structure *ct,datatable *data,char a,
+	char b);
+		//erg2<false> leaves out the SHAPE pseudoenergy, for callers that know no SHAPE data was read
 integersize erg2in(int i,int j,int ip,int jp,structure *ct, datatable *data,char a,
 	char b);
 		//calculates the energy of an interior part of an internal loop (includes asymmetry)
@@ -100,6 +105,8 @@ integersize erg2ex(int i,int j,int size,structure *ct, datatable *data);
 		//calculates the energy of an exterior part of an internal loop (only has length and terminal stack components)
 integersize erg3(int i,int j,structure *ct,datatable *data,char dbl);
 		//calculates energy of a hairpin loop
+template <bool shaped> integersize erg3(int i,int j,structure *ct,datatable *data,char dbl);
+		//erg3<false> leaves out the SHAPE pseudoenergy, for callers that know no SHAPE data was read
 integersize erg4(int i,int j,int ip,int jp,structure *ct,datatable *data,
 	bool lfce);
 		//calculates energy of a dangling base
@@ -0,0 +1,151 @@
+#include "savemapping.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+//the first multiple of savealignment at or after position
+static long long savealign(long long position) {
+	return ((position+savealignment-1)/savealignment)*savealignment;
+}
+
+void writesavedirectory(ofstream *sav, vector<saveblock> &blocks) {
+	int count = (int) blocks.size();
+	long long offset;
+	unsigned int i;
+
+	offset = (long long) sav->tellp() + sizeof(int) + count*2*sizeof(long long);
+	for (i=0;i<blocks.size();i++) {
+		offset = savealign(offset);
+		blocks[i].offset = offset;
+		offset += blocks[i].bytes;
+	}
+
+	sav->write((char *) &count,sizeof(int));
+	for (i=0;i<blocks.size();i++) {
+		sav->write((char *) &blocks[i].offset,sizeof(long long));
+		sav->write((char *) &blocks[i].bytes,sizeof(long long));
+	}
+}
+
+void writesaveblock(ofstream *sav, const saveblock &block, const void *values) {
+	char zero[256] = {0};
+	long long position = (long long) sav->tellp();
+
+	while (position<block.offset) {
+		long long pad = block.offset-position;
+		if (pad>(long long) sizeof(zero)) pad = sizeof(zero);
+		sav->write(zero,(streamsize) pad);
+		position += pad;
+	}
+	sav->write((const char *) values,(streamsize) block.bytes);
+}
+
+bool readsavedirectory(ifstream *sav, vector<saveblock> &blocks) {
+	int count,i;
+
+	blocks.clear();
+	sav->read((char *) &count,sizeof(int));
+	if (!*sav||count<0||count>savemaxblocks) return false;
+	blocks.resize(count);
+	for (i=0;i<count;i++) {
+		sav->read((char *) &blocks[i].offset,sizeof(long long));
+		sav->read((char *) &blocks[i].bytes,sizeof(long long));
+	}
+	if (!*sav) {
+		blocks.clear();
+		return false;
+	}
+	return true;
+}
+
+bool checksaveblocks(ifstream *sav, const vector<saveblock> &blocks, const long long *bytes) {
+	long long filesize,end;
+	unsigned int i;
+
+	sav->seekg(0,ios::end);
+	filesize = (long long) sav->tellg();
+	if (!*sav) return false;
+
+	//the mapping spans the blocks from the first to the last, so they must not overlap or run backwards
+	end = 0;
+	for (i=0;i<blocks.size();i++) {
+		if (blocks[i].bytes!=bytes[i]||blocks[i].offset<end||blocks[i].bytes>filesize-blocks[i].offset) return false;
+		end = blocks[i].offset+blocks[i].bytes;
+	}
+	return true;
+}
+
+savemapping::savemapping() {
+	base = NULL;
+	start = 0;
+	length = 0;
+	mapped = false;
+	holders = 1;
+}
+
+savemapping::~savemapping() {
+#if !defined(_WIN32)
+	if (mapped) {
+		munmap(base,(size_t) length);
+		return;
+	}
+#endif
+	delete[] base;
+}
+
+savemapping *savemapping::open(const char *filename, const vector<saveblock> &blocks) {
+	savemapping *mapping = new savemapping();
+
+	mapping->blocks = blocks;
+	if (blocks.empty()) return mapping;
+
+	mapping->start = blocks[0].offset;
+	mapping->length = blocks[blocks.size()-1].offset+blocks[blocks.size()-1].bytes-mapping->start;
+
+#if !defined(_WIN32)
+	int file = ::open(filename,O_RDONLY);
+	if (file>=0) {
+		//MAP_PRIVATE, so that changes to the arrays are not written back to the file
+		void *address = mmap(NULL,(size_t) mapping->length,PROT_READ|PROT_WRITE,MAP_PRIVATE,file,(off_t) mapping->start);
+		::close(file);
+		if (address!=MAP_FAILED) {
+			mapping->base = (char *) address;
+			mapping->mapped = true;
+			return mapping;
+		}
+	}
+#endif
+
+	//read the blocks instead; the callers have checked that the blocks lie within the file
+	ifstream sav(filename,ios::binary);
+	mapping->base = new char [mapping->length]();
+	sav.seekg((streamoff) mapping->start);
+	sav.read(mapping->base,(streamsize) mapping->length);
+	return mapping;
+}
+
+void *savemapping::block(int index) {
+	return base+(blocks[index].offset-start);
+}
+
+//the holders can be strands folded by different threads, which share a thermodynamic snapshot
+void savemapping::hold() {
+#ifdef __GNUC__
+	__sync_add_and_fetch(&holders,1);
+#else
+	holders++;
+#endif
+}
+
+void savemapping::release() {
+#ifdef __GNUC__
+	if (__sync_sub_and_fetch(&holders,1)==0) delete this;
+#else
+	if (--holders==0) delete this;
+#endif
+}
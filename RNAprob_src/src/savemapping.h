@@ -0,0 +1,69 @@
+#ifndef SAVEMAPPING_H
+#define SAVEMAPPING_H
+
+#include <fstream>
+#include <vector>
+
+// The dynamic programming arrays of the save files (.sav and .pfs) are
+// stored at the end of the file, each as one contiguous block laid out as in
+// memory, so that the arrays can be used in place when the file is read.
+
+// A directory, written after the small header data, gives the offset and the
+// size of each block.  The blocks start at multiples of savealignment, which
+// is a multiple of the page size on all common systems.
+const long long savealignment = 65536;
+
+struct saveblock {
+	long long offset,bytes;
+};
+
+// a directory with more blocks than this is taken to be corrupt
+const int savemaxblocks = 1024;
+
+// write the directory of blocks, whose bytes must be set, at the current
+// position of sav, and set their offsets; the blocks must then be written in
+// order with writesaveblock
+void writesavedirectory(std::ofstream *sav, std::vector<saveblock> &blocks);
+
+// write the values of a block, after padding sav to the offset of the block
+void writesaveblock(std::ofstream *sav, const saveblock &block, const void *values);
+
+// read the directory at the current position of sav; false, with no blocks,
+// if it could not be read or its count is out of range
+bool readsavedirectory(std::ifstream *sav, std::vector<saveblock> &blocks);
+
+// true if the blocks lie in order within the file read by sav and block i
+// holds bytes[i] bytes; a mapping past the end of a truncated file would fault
+// when it is read, so the blocks of a save file must be checked before they
+// are opened
+bool checksaveblocks(std::ifstream *sav, const std::vector<saveblock> &blocks, const long long *bytes);
+
+// savemapping makes the blocks of a save file, or of a thermodynamic snapshot
+// (see thermosnapshot.h), available in memory.  Where possible, the file is
+// mapped (copy on write, so the arrays can still be changed), and pages are
+// only read when they are used; otherwise the blocks are read into an
+// allocation.  Arrays that use a block hold the mapping, and it is removed
+// when the last holder releases it.
+class savemapping {
+	public:
+		// map the blocks of filename, which the caller then holds
+		static savemapping *open(const char *filename, const std::vector<saveblock> &blocks);
+
+		// the values of block index
+		void *block(int index);
+
+		void hold();
+		void release();
+
+	private:
+		savemapping();
+		~savemapping();
+
+		char *base;
+		long long start,length;
+		bool mapped;
+		int holders;
+		std::vector<saveblock> blocks;
+};
+
+#endif
@@ -7,261 +7,303 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstring>
-using namespace std;
 
+#ifdef SMP
+#include <omp.h>
+#endif
+
+using namespace std;
 
-//Define 1 for the purposes of taking an inverse
-static PFPRECISION ONE=1; //include code for extended double if needed
 
 
  
 //register a base pair between two nucleotides
-inline void regbp(structure *ct, int structurenumber, int i, int j) {
-	ct->SetPair(i,j,structurenumber);
+inline void regbp(int *basepr, int i, int j) {
+	basepr[i] = j;
+	basepr[j] = i;
 
 }
 
 
 
-int stochastictraceback(pfunctionclass *w,pfunctionclass *wmb,pfunctionclass *wmbl,pfunctionclass *wcoax,pfunctionclass *wl,pfunctionclass *v,
-	forceclass *fce, PFPRECISION *w3,PFPRECISION *w5,PFPRECISION scaling, bool *lfce, bool *mod, pfdatatable *data, int numberofstructures, 
-	structure *ct, int randomseed, TProgressDialog *progress) {
-	
-	double scalinginv,twoscaling;
-	int number;
-
-
+//Sample one structure, with the random numbers seeded by seed, into basepr, which holds the
+//pair of each nucleotide, or zero, and must be zero on entry.
+//This returns zero, or the error codes of stochastictraceback.
+static int samplestructure(pfunctionclass *w,pfunctionclass *wmb,pfunctionclass *wmbl,pfunctionclass *wcoax,pfunctionclass *wl,pfunctionclass *v,pfunctionclass *v2,
+	forceclass *fce, PFPRECISION *w3,PFPRECISION *w5,PFPRECISION scaling, bool *lfce, bool *mod, pfdatatable *data,
+	structure *ct, int seed, int *basepr) {
 
-	register int inc[6][6]={{0,0,0,0,0,0},{0,0,0,0,1,0},{0,0,0,1,0,0},{0,0,1,0,1,0},
+	double twoscaling;
+	int inc[6][6]={{0,0,0,0,0,0},{0,0,0,0,1,0},{0,0,0,1,0,0},{0,0,1,0,1,0},
 	{0,1,0,1,0,0},{0,0,0,0,0,0}};
-
-
-
-	scalinginv = ONE/data->scaling;
-	twoscaling=data->scaling*data->scaling;
-
-
-
-
 	int tracebackerror=0;
 
-	//ct->numofstructures=numberofstructures;
-	//ct->checknumberofstructures();
-	//Big loop:
-	#ifdef SMP
-	#pragma omp parallel for
-	#endif
-	for (number = 1; number <= numberofstructures; number++) {
-		randomnumber rand;
-		rand.seed(randomseed+number);
+	randomnumber rand;
+	double roll;
+	double cumulative, denominator, stackfactor;
+	stackclass stack;
+	integersize dummy1;
+	int stackedoutside;//1 when a v fragment was reached by stacking the pair outside it on i,j (used by the three-state reactivity model)
+	bool found;
+	int switchcase,i,j,k,ip,jp,d;
 
-		double roll;
-		double cumulative, denominator;
-		stackclass stack;
-		integersize dummy1;
-		int dummy2;
+	twoscaling=data->scaling*data->scaling;
+	rand.seed(seed);
 
-		bool found;
+	//start by putting the whole fragment on the stack:
+	stack.push(1,ct->GetSequenceLength(),0,0,0);
 	
-		int switchcase,i,j,k,ip,jp,d;
-
-		if (progress!=NULL) {
 
-			progress->update((int) (((float) 100*number)/((float) numberofstructures)));
-
-		}
-//<<<<<<< stochastic.cpp
-		
-		ct->AddStructure();
-		
-//=======
-		
-		//initialize the base pairs
-//		for (i=1;i<=ct->numofbases;i++) ct->basepr[number][i]=0;
-//>>>>>>> 1.10
+	while (stack.pull(&i,&j,&switchcase,&dummy1,&stackedoutside)) {
+		roll= rand.roll();
+		cumulative = 0;
+		found = false;
+		switch(switchcase) {
+			case 0: //switchcase=0, dealing with w5 fragment
 
-		ct->SetCtLabel(ct->GetSequenceLabel(),number);
-		
-		//start by putting the whole fragment on the stack:
-		stack.push(1,ct->GetSequenceLength(),0,0,0);
-		
+				//Try adding a nucleotide to existing w5 fragment:
+				if (j==0) found = true;
 
-		while (stack.pull(&i,&j,&switchcase,&dummy1,&dummy2)) {
-			roll= rand.roll();
-			cumulative = 0;
-			found = false;
-			switch(switchcase) {
-				case 0: //switchcase=0, dealing with w5 fragment
+				if (!lfce[j]&&!found) {
+					cumulative = ((w5[j-1]*scaling)/w5[j]);
+					if (cumulative > roll) {
+						stack.push(1,j-1,0,0,0);
+						found=true;
+					}
+				}
+				
+				for (k=0;k<=j-4&&!found;k++) {
 
-					//Try adding a nucleotide to existing w5 fragment:
-					if (j==0) found = true;
+					#ifdef SIMPLEMBLOOP
+					cumulative+=(w5[k]*erg4(j-1,k+1,j,1,ct,data,lfce[j])*v->f(k+1,j-1)*penalty(j-1,k+1,ct,data))/w5[j];
+					if (cumulative>roll&&!found) {
+						stack.push(1,k,0,0,0);
+						stack.push(k+1,j-1,1,0,0);
+						found = true;
+						
 
-					if (!lfce[j]&&!found) {
-						cumulative = ((w5[j-1]*scaling)/w5[j]);
-						if (cumulative > roll) {
-							stack.push(1,j-1,0,0,0);
-							found=true;
-						}
 					}
-					
-					for (k=0;k<=j-4&&!found;k++) {
+					if (!found&&(mod[k+1]||mod[j-1])) if(inc[ct->numseq[k+2]][ct->numseq[j-2]]&&notgu(k+1,j-1,ct)&&!(fce->f(k+1,j-1)&SINGLE)) {
 
-						#ifdef SIMPLEMBLOOP
-						cumulative+=(w5[k]*erg4(j-1,k+1,j,1,ct,data,lfce[j])*v->f(k+1,j-1)*penalty(j-1,k+1,ct,data))/w5[j];
+						cumulative+=(w5[k]*erg4(j-1,k+1,j,1,ct,data,lfce[j])*v->f(k+2,j-2)
+							*penalty(j-1,k+1,ct,data)*erg1(k+1,j-1,k+2,j-2,ct,data))/w5[j];
 						if (cumulative>roll&&!found) {
 							stack.push(1,k,0,0,0);
-							stack.push(k+1,j-1,1,0,0);
-							found = true;
+							stack.push(k+2,j-2,1,0,0);
+							regbp(basepr,k+1,j-1);
+							found=true;
 							
-
-						}
-						if (!found&&(mod[k+1]||mod[j-1])) if(inc[ct->numseq[k+2]][ct->numseq[j-2]]&&notgu(k+1,j-1,ct)&&!(fce->f(k+1,j-1)&SINGLE)) {
-
-							cumulative+=(w5[k]*erg4(j-1,k+1,j,1,ct,data,lfce[j])*v->f(k+2,j-2)
-								*penalty(j-1,k+1,ct,data)*erg1(k+1,j-1,k+2,j-2,ct,data))/w5[j];
-							if (cumulative>roll&&!found) {
-								stack.push(1,k,0,0,0);
-								stack.push(k+2,j-2,1,0,0);
-								regbp(ct,number,k+1,j-1);
-								found=true;
-								
-							}
 						}
-						#else  //!SIMPLEMBLOOP
-						cumulative +=(w5[k]*v->f(k+1,j)*penalty(j,k+1,ct,data))/w5[j];
+					}
+					#else  //!SIMPLEMBLOOP
+					cumulative +=(w5[k]*v->f(k+1,j)*penalty(j,k+1,ct,data))/w5[j];
+					if (cumulative > roll) {
+						stack.push(1,k,0,0,0);
+						stack.push(k+1,j,1,0,0);
+						found = true;
+					}
+					if (!found&&(mod[k+1]||mod[j])) if(inc[ct->numseq[k+2]][ct->numseq[j-1]]&&notgu(k+1,j,ct)&&!(fce->f(k+1,j)&SINGLE)) {
+						cumulative +=(w5[k]*v->f(k+2,j-1)*penalty(j,k+1,ct,data)
+							*erg1(k+1,j,k+2,j-1,ct,data))/w5[j];
 						if (cumulative > roll) {
 							stack.push(1,k,0,0,0);
-							stack.push(k+1,j,1,0,0);
-							found = true;
-						}
-						if (!found&&(mod[k+1]||mod[j])) if(inc[ct->numseq[k+2]][ct->numseq[j-1]]&&notgu(k+1,j,ct)&&!(fce->f(k+1,j)&SINGLE)) {
-							cumulative +=(w5[k]*v->f(k+2,j-1)*penalty(j,k+1,ct,data)
-								*erg1(k+1,j,k+2,j-1,ct,data))/w5[j];
-							if (cumulative > roll) {
-								stack.push(1,k,0,0,0);
-								stack.push(k+2,j-1,1,0,0);
-								regbp(ct,number,k+1,j);
-								found=true;
-							}
+							stack.push(k+2,j-1,1,0,0);
+							regbp(basepr,k+1,j);
+							found=true;
 						}
+					}
 
-						cumulative+=(w5[k]*erg4(j,k+2,k+1,2,ct,data,lfce[k+1])*v->f(k+2,j)*penalty(j,k+2,ct,data))/w5[j];
-						if (cumulative > roll&&!found) {
+					cumulative+=(w5[k]*erg4(j,k+2,k+1,2,ct,data,lfce[k+1])*v->f(k+2,j)*penalty(j,k+2,ct,data))/w5[j];
+					if (cumulative > roll&&!found) {
+						stack.push(1,k,0,0,0);
+						stack.push(k+2,j,1,0,0);
+						found=true;
+		
+					}
+					if (!found&&(mod[k+2]||mod[j])) if(inc[ct->numseq[k+3]][ct->numseq[j-1]]&&notgu(k+1,j-1,ct)&&!(fce->f(k+1,j-1)&SINGLE)) {
+						cumulative += (w5[k]*erg4(j,k+2,k+1,2,ct,data,lfce[j])*v->f(k+3,j-1)
+							*penalty(j,k+2,ct,data)*erg1(k+2,j,k+3,j-1,ct,data))/w5[j];
+						if (cumulative>roll) {
 							stack.push(1,k,0,0,0);
 							stack.push(k+2,j,1,0,0);
+							regbp(basepr,k+3,j-1);
 							found=true;
-			
-						}
-						if (!found&&(mod[k+2]||mod[j])) if(inc[ct->numseq[k+3]][ct->numseq[j-1]]&&notgu(k+1,j-1,ct)&&!(fce->f(k+1,j-1)&SINGLE)) {
-							cumulative += (w5[k]*erg4(j,k+2,k+1,2,ct,data,lfce[j])*v->f(k+3,j-1)
-								*penalty(j,k+2,ct,data)*erg1(k+2,j,k+3,j-1,ct,data))/w5[j];
-							if (cumulative>roll) {
-								stack.push(1,k,0,0,0);
-								stack.push(k+2,j,1,0,0);
-								regbp(ct,number,k+3,j-1);
-								found=true;
 
-							}
 						}
+					}
+
+					cumulative+=(w5[k]*erg4(j-1,k+1,j,1,ct,data,lfce[j])*v->f(k+1,j-1)*penalty(j-1,k+1,ct,data))/w5[j];
+					if (cumulative>roll&&!found) {
+						stack.push(1,k,0,0,0);
+						stack.push(k+1,j-1,1,0,0);
+						found = true;
+						
 
-						cumulative+=(w5[k]*erg4(j-1,k+1,j,1,ct,data,lfce[j])*v->f(k+1,j-1)*penalty(j-1,k+1,ct,data))/w5[j];
+					}
+					if (!found&&(mod[k+1]||mod[j-1])) if(inc[ct->numseq[k+2]][ct->numseq[j-2]]&&notgu(k+1,j-1,ct)&&!(fce->f(k+1,j-1)&SINGLE)) {
+
+						cumulative+=(w5[k]*erg4(j-1,k+1,j,1,ct,data,lfce[j])*v->f(k+2,j-2)
+							*penalty(j-1,k+1,ct,data)*erg1(k+1,j-1,k+2,j-2,ct,data))/w5[j];
 						if (cumulative>roll&&!found) {
 							stack.push(1,k,0,0,0);
-							stack.push(k+1,j-1,1,0,0);
-							found = true;
+							stack.push(k+2,j-2,1,0,0);
+							regbp(basepr,k+1,j-1);
+							found=true;
 							
-
 						}
-						if (!found&&(mod[k+1]||mod[j-1])) if(inc[ct->numseq[k+2]][ct->numseq[j-2]]&&notgu(k+1,j-1,ct)&&!(fce->f(k+1,j-1)&SINGLE)) {
+					}
+					cumulative+=(w5[k]*data->tstack[ct->numseq[j-1]][ct->numseq[k+2]][ct->numseq[j]][ct->numseq[k+1]] 
+								*pfchecknp(lfce[j],lfce[k+1]) * v->f(k+2,j-1)*
+								penalty(j-1,k+2,ct,data))/w5[j];
+					if (cumulative>roll&&!found) {
+						stack.push(1,k,0,0,0);
+						stack.push(k+2,j-1,1,0,0);
+						found=true;
+						
+
+
+					}
+
+					if (!found&&(mod[k+2]||mod[j-1])) if(inc[ct->numseq[k+3]][ct->numseq[j-2]]&&notgu(k+2,j-1,ct)&&!(fce->f(k+2,j-1)&SINGLE)) {
 
-							cumulative+=(w5[k]*erg4(j-1,k+1,j,1,ct,data,lfce[j])*v->f(k+2,j-2)
-								*penalty(j-1,k+1,ct,data)*erg1(k+1,j-1,k+2,j-2,ct,data))/w5[j];
-							if (cumulative>roll&&!found) {
-								stack.push(1,k,0,0,0);
-								stack.push(k+2,j-2,1,0,0);
-								regbp(ct,number,k+1,j-1);
-								found=true;
-								
-							}
-						}
 						cumulative+=(w5[k]*data->tstack[ct->numseq[j-1]][ct->numseq[k+2]][ct->numseq[j]][ct->numseq[k+1]] 
-									*pfchecknp(lfce[j],lfce[k+1]) * v->f(k+2,j-1)*
-									penalty(j-1,k+2,ct,data))/w5[j];
+								*pfchecknp(lfce[j],lfce[k+1]) * v->f(k+3,j-2)*
+								penalty(j-1,k+2,ct,data)*erg1(k+2,j-1,k+3,j-2,ct,data))/w5[j];
+
 						if (cumulative>roll&&!found) {
 							stack.push(1,k,0,0,0);
-							stack.push(k+2,j-1,1,0,0);
+							stack.push(k+3,j-2,1,0,0);
+							regbp(basepr,k+2,j-1);
 							found=true;
 							
+						}
+
+					}
 
+					//recheck all the coaxial stacking possibilities:
+					
+					i = k+1;
+					for (ip=i+minloop+1;ip<j-minloop-1&&!found;ip++) {
+					
+						//first consider flush stacking
+						cumulative+=w5[k]*v->f(i,ip)*v->f(ip+1,j)*penalty(i,ip,ct,data)
+							*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)/w5[j];
 
+						if (cumulative > roll) {
+							stack.push(i,ip,1,0,0);
+							stack.push(ip+1,j,1,0,0);
+							found=true;
+							stack.push(1,k,0,0,0);
 						}
 
-						if (!found&&(mod[k+2]||mod[j-1])) if(inc[ct->numseq[k+3]][ct->numseq[j-2]]&&notgu(k+2,j-1,ct)&&!(fce->f(k+2,j-1)&SINGLE)) {
 
-							cumulative+=(w5[k]*data->tstack[ct->numseq[j-1]][ct->numseq[k+2]][ct->numseq[j]][ct->numseq[k+1]] 
-									*pfchecknp(lfce[j],lfce[k+1]) * v->f(k+3,j-2)*
-									penalty(j-1,k+2,ct,data)*erg1(k+2,j-1,k+3,j-2,ct,data))/w5[j];
+						if ((mod[i]||mod[ip]||mod[ip+1]||mod[j])) {
+
+							if ((mod[i]||mod[ip])&&(mod[ip+1]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
+								&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&notgu(i,ip,ct)&&notgu(ip+1,j,ct)
+								&&!(fce->f(ip+1,j)&SINGLE)&&!(fce->f(i,ip)&SINGLE)) {
+
+								cumulative+=w5[k]*v->f(i+1,ip-1)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
+									*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
+									*erg1(i,ip,i+1,ip-1,ct,data)*erg1(ip+1,j,ip+2,j-1,ct,data)/w5[j];
+
+								if (!found&&cumulative>roll) {
+									stack.push(i+1,ip-1,1,0,0);
+									stack.push(ip+2,j-1,1,0,0);
+									found=true;
+									regbp(basepr,i,ip);
+									regbp(basepr,ip+1,j);
+									stack.push(1,k,0,0,0);
+								}
+
+
+							}
+
+							if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&notgu(i,ip,ct)&&!(fce->f(i,ip)&SINGLE)) {
+						
+								cumulative+=w5[k]*v->f(i+1,ip-1)*v->f(ip+1,j)*penalty(i,ip,ct,data)
+									*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
+									*erg1(i,ip,i+1,ip-1,ct,data)/w5[j];
+
+								if (!found&&cumulative>roll) {
+									stack.push(i+1,ip-1,1,0,0);
+									stack.push(ip+1,j,1,0,0);
+									found=true;
+									regbp(basepr,i,ip);
+									stack.push(1,k,0,0,0);
+
+								}
+
+
+							}
+
+							if ((mod[ip+1]||mod[j])&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&notgu(ip+1,j,ct)&&!(fce->f(ip+1,j)&SINGLE)) {
+
+
+								cumulative+=w5[k]*v->f(i,ip)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
+									*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
+									*erg1(ip+1,j,ip+2,j-1,ct,data)/w5[j];
+
+								if (!found&&cumulative>roll) {
+									stack.push(i,ip,1,0,0);
+									stack.push(ip+2,j-1,1,0,0);
+									found=true;
+									regbp(basepr,ip+1,j);
+									stack.push(1,k,0,0,0);
+		
+								}
 
-							if (cumulative>roll&&!found) {
-								stack.push(1,k,0,0,0);
-								stack.push(k+3,j-2,1,0,0);
-								regbp(ct,number,k+2,j-1);
-								found=true;
-								
 							}
 
+
 						}
 
-						//recheck all the coaxial stacking possibilities:
-						
-						i = k+1;
-						for (ip=i+minloop+1;ip<j-minloop-1&&!found;ip++) {
-						
-							//first consider flush stacking
-							cumulative+=w5[k]*v->f(i,ip)*v->f(ip+1,j)*penalty(i,ip,ct,data)
-								*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)/w5[j];
+						if (!lfce[ip+1]&&!lfce[j]) {
+							//now consider an intervening mismatch
+							cumulative+=w5[k]*v->f(i,ip)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
+								*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)/w5[j];
 
-							if (cumulative > roll) {
+							if (cumulative>roll&&!found) {
 								stack.push(i,ip,1,0,0);
-								stack.push(ip+1,j,1,0,0);
+								stack.push(ip+2,j-1,1,0,0);
 								found=true;
 								stack.push(1,k,0,0,0);
-							}
-
 
-							if ((mod[i]||mod[ip]||mod[ip+1]||mod[j])) {
+							}
 
-								if ((mod[i]||mod[ip])&&(mod[ip+1]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
-									&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&notgu(i,ip,ct)&&notgu(ip+1,j,ct)
-									&&!(fce->f(ip+1,j)&SINGLE)&&!(fce->f(i,ip)&SINGLE)) {
+							if (mod[i]||mod[ip]||mod[ip+2]||mod[j-1]) {
+								if ((mod[i]||mod[ip])&&(mod[ip+2]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
+									&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&notgu(i,ip,ct)&&notgu(ip+2,j-1,ct)
+										&&!(fce->f(i,ip)&SINGLE)&&!(fce->f(ip+2,j-1)&SINGLE)) {
 
-									cumulative+=w5[k]*v->f(i+1,ip-1)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
-										*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
-										*erg1(i,ip,i+1,ip-1,ct,data)*erg1(ip+1,j,ip+2,j-1,ct,data)/w5[j];
+									 cumulative+=w5[k]*v->f(i+1,ip-1)*v->f(ip+3,j-2)*penalty(i,ip,ct,data)
+										*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
+										*erg1(i,ip,i+1,ip-1,ct,data)*erg1(ip+2,j-1,ip+3,j-2,ct,data)/w5[j];
 
-									if (!found&&cumulative>roll) {
+									 if (!found&&cumulative>roll) {
 										stack.push(i+1,ip-1,1,0,0);
-										stack.push(ip+2,j-1,1,0,0);
+										stack.push(ip+3,j-2,1,0,0);
+										regbp(basepr,i,ip);
+										regbp(basepr,ip+2,j-1);
 										found=true;
-										regbp(ct,number,i,ip);
-										regbp(ct,number,ip+1,j);
 										stack.push(1,k,0,0,0);
-									}
+
+									 }
 
 
 								}
 
 								if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&notgu(i,ip,ct)&&!(fce->f(i,ip)&SINGLE)) {
-							
-									cumulative+=w5[k]*v->f(i+1,ip-1)*v->f(ip+1,j)*penalty(i,ip,ct,data)
-										*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
+						
+									cumulative+=w5[k]*v->f(i+1,ip-1)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
+										*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
 										*erg1(i,ip,i+1,ip-1,ct,data)/w5[j];
 
-									if (!found&&cumulative>roll) {
+									if(!found&&cumulative>roll) {
 										stack.push(i+1,ip-1,1,0,0);
-										stack.push(ip+1,j,1,0,0);
+										stack.push(ip+2,j-1,1,0,0);
+										regbp(basepr,i,ip);
 										found=true;
-										regbp(ct,number,i,ip);
 										stack.push(1,k,0,0,0);
 
 									}
@@ -269,1464 +311,1615 @@ int stochastictraceback(pfunctionclass *w,pfunctionclass *wmb,pfunctionclass *wm
 
 								}
 
-								if ((mod[ip+1]||mod[j])&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&notgu(ip+1,j,ct)&&!(fce->f(ip+1,j)&SINGLE)) {
+								if ((mod[ip+2]||mod[j-1])&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&notgu(ip+2,j-1,ct)&&!(fce->f(ip+2,j-1)&SINGLE)) {
 
 
-									cumulative+=w5[k]*v->f(i,ip)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
-										*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
-										*erg1(ip+1,j,ip+2,j-1,ct,data)/w5[j];
+									cumulative+=w5[k]*v->f(i,ip)*v->f(ip+3,j-2)*penalty(i,ip,ct,data)
+										*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
+										*erg1(ip+2,j-1,ip+3,j-2,ct,data)/w5[j];
 
 									if (!found&&cumulative>roll) {
 										stack.push(i,ip,1,0,0);
-										stack.push(ip+2,j-1,1,0,0);
+										stack.push(ip+3,j-2,1,0,0);
+										regbp(basepr,ip+2,j-1);
 										found=true;
-										regbp(ct,number,ip+1,j);
 										stack.push(1,k,0,0,0);
-			
+
 									}
 
 								}
-
-
 							}
+						}
 
-							if (!lfce[ip+1]&&!lfce[j]) {
-								//now consider an intervening mismatch
-								cumulative+=w5[k]*v->f(i,ip)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
-									*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)/w5[j];
-
-								if (cumulative>roll&&!found) {
-									stack.push(i,ip,1,0,0);
-									stack.push(ip+2,j-1,1,0,0);
-									found=true;
-									stack.push(1,k,0,0,0);
+						if(!lfce[i]&&!lfce[ip+1]) {
+							cumulative+=w5[k]*v->f(i+1,ip)*v->f(ip+2,j)*penalty(i+1,ip,ct,data)
+								*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)/w5[j];
 
-								}
 
-								if (mod[i]||mod[ip]||mod[ip+2]||mod[j-1]) {
-									if ((mod[i]||mod[ip])&&(mod[ip+2]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
-										&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&notgu(i,ip,ct)&&notgu(ip+2,j-1,ct)
-											&&!(fce->f(i,ip)&SINGLE)&&!(fce->f(ip+2,j-1)&SINGLE)) {
+							if (!found&&cumulative>roll) {
+								stack.push(i+1,ip,1,0,0);
+								stack.push(ip+2,j,1,0,0);
+								stack.push(1,k,0,0,0);
+								found=true;
 
-										 cumulative+=w5[k]*v->f(i+1,ip-1)*v->f(ip+3,j-2)*penalty(i,ip,ct,data)
-											*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
-											*erg1(i,ip,i+1,ip-1,ct,data)*erg1(ip+2,j-1,ip+3,j-2,ct,data)/w5[j];
+							}
 
-										 if (!found&&cumulative>roll) {
-											stack.push(i+1,ip-1,1,0,0);
-											stack.push(ip+3,j-2,1,0,0);
-											regbp(ct,number,i,ip);
-											regbp(ct,number,ip+2,j-1);
-											found=true;
-											stack.push(1,k,0,0,0);
+							if (mod[i+1]||mod[ip]||mod[ip+2]||mod[j]) {
+								if ((mod[i+1]||mod[ip])&&(mod[ip+2]||mod[j])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]
+									&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&notgu(i+1,ip,ct)&&notgu(ip+2,j,ct)
+									&&!(fce->f(i+1,ip)&SINGLE)&&!(fce->f(ip+2,j)&SINGLE)	) {
 
-										 }
+									cumulative+=w5[k]*v->f(i+2,ip-1)*v->f(ip+3,j-1)*penalty(i+1,ip,ct,data)
+										*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
+										*erg1(i+1,ip,i+2,ip-1,ct,data)*erg1(ip+2,j,ip+3,j-1,ct,data)/w5[j];	
 
+									if (!found&&cumulative>roll) {
+										stack.push(i+2,ip-1,1,0,0);
+										stack.push(ip+3,j-1,1,0,0);
+										regbp(basepr,i+1,ip);
+										regbp(basepr,ip+2,j);
+										found=true;
+										stack.push(1,k,0,0,0);
 
 									}
 
-									if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&notgu(i,ip,ct)&&!(fce->f(i,ip)&SINGLE)) {
-							
-										cumulative+=w5[k]*v->f(i+1,ip-1)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
-											*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
-											*erg1(i,ip,i+1,ip-1,ct,data)/w5[j];
-
-										if(!found&&cumulative>roll) {
-											stack.push(i+1,ip-1,1,0,0);
-											stack.push(ip+2,j-1,1,0,0);
-											regbp(ct,number,i,ip);
-											found=true;
-											stack.push(1,k,0,0,0);
-
-										}
+						
+								}
+								if ((mod[i+1]||mod[ip])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&notgu(i+1,ip,ct)&&!(fce->f(i+1,ip)&SINGLE)) {
+						
+									cumulative+=w5[k]*v->f(i+2,ip-1)*v->f(ip+2,j)*penalty(i+1,ip,ct,data)
+										*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
+										*erg1(i+1,ip,i+2,ip-1,ct,data)/w5[j];
 
+									if (!found&&cumulative>roll) {
+										stack.push(i+2,ip-1,1,0,0);
+										stack.push(ip+2,j,1,0,0);
+										regbp(basepr,i+1,ip);
+										stack.push(1,k,0,0,0);
+									
+										found=true;
 
 									}
 
-									if ((mod[ip+2]||mod[j-1])&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&notgu(ip+2,j-1,ct)&&!(fce->f(ip+2,j-1)&SINGLE)) {
 
+								}
+
+								if ((mod[ip+2]||mod[j])&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&notgu(ip+2,j,ct)&&!(fce->f(ip+2,j)&SINGLE)) {
 
-										cumulative+=w5[k]*v->f(i,ip)*v->f(ip+3,j-2)*penalty(i,ip,ct,data)
-											*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
-											*erg1(ip+2,j-1,ip+3,j-2,ct,data)/w5[j];
 
-										if (!found&&cumulative>roll) {
-											stack.push(i,ip,1,0,0);
-											stack.push(ip+3,j-2,1,0,0);
-											regbp(ct,number,ip+2,j-1);
-											found=true;
-											stack.push(1,k,0,0,0);
+									cumulative+=w5[k]*v->f(i+1,ip)*v->f(ip+3,j-1)*penalty(i+1,ip,ct,data)
+										*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
+										*erg1(ip+2,j,ip+3,j-1,ct,data)/w5[j];
 
-										}
+									if (!found&&cumulative>roll) {
+										stack.push(i+1,ip,1,0,0);
+										stack.push(ip+3,j-1,1,0,0);
+										stack.push(1,k,0,0,0);
+									
+										regbp(basepr,ip+2,j);
+										found=true;
 
 									}
+
 								}
 							}
+					
 
-							if(!lfce[i]&&!lfce[ip+1]) {
-								cumulative+=w5[k]*v->f(i+1,ip)*v->f(ip+2,j)*penalty(i+1,ip,ct,data)
-									*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)/w5[j];
+						}
+					}
 
+					#endif //SIMPLEMBLOOP
 
-								if (!found&&cumulative>roll) {
-									stack.push(i+1,ip,1,0,0);
-									stack.push(ip+2,j,1,0,0);
-									stack.push(1,k,0,0,0);
-									found=true;
-
-								}
-
-								if (mod[i+1]||mod[ip]||mod[ip+2]||mod[j]) {
-									if ((mod[i+1]||mod[ip])&&(mod[ip+2]||mod[j])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]
-										&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&notgu(i+1,ip,ct)&&notgu(ip+2,j,ct)
-										&&!(fce->f(i+1,ip)&SINGLE)&&!(fce->f(ip+2,j)&SINGLE)	) {
-
-										cumulative+=w5[k]*v->f(i+2,ip-1)*v->f(ip+3,j-1)*penalty(i+1,ip,ct,data)
-											*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
-											*erg1(i+1,ip,i+2,ip-1,ct,data)*erg1(ip+2,j,ip+3,j-1,ct,data)/w5[j];	
-
-										if (!found&&cumulative>roll) {
-											stack.push(i+2,ip-1,1,0,0);
-											stack.push(ip+3,j-1,1,0,0);
-											regbp(ct,number,i+1,ip);
-											regbp(ct,number,ip+2,j);
-											found=true;
-											stack.push(1,k,0,0,0);
-
-										}
-
-							
-									}
-									if ((mod[i+1]||mod[ip])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&notgu(i+1,ip,ct)&&!(fce->f(i+1,ip)&SINGLE)) {
-							
-										cumulative+=w5[k]*v->f(i+2,ip-1)*v->f(ip+2,j)*penalty(i+1,ip,ct,data)
-											*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
-											*erg1(i+1,ip,i+2,ip-1,ct,data)/w5[j];
-
-										if (!found&&cumulative>roll) {
-											stack.push(i+2,ip-1,1,0,0);
-											stack.push(ip+2,j,1,0,0);
-											regbp(ct,number,i+1,ip);
-											stack.push(1,k,0,0,0);
-										
-											found=true;
-
-										}
-
-
-									}
-
-									if ((mod[ip+2]||mod[j])&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&notgu(ip+2,j,ct)&&!(fce->f(ip+2,j)&SINGLE)) {
 
+				}
 
-										cumulative+=w5[k]*v->f(i+1,ip)*v->f(ip+3,j-1)*penalty(i+1,ip,ct,data)
-											*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
-											*erg1(ip+2,j,ip+3,j-1,ct,data)/w5[j];
+				if (!found) {
+					cout << "Traceback error at w5\n";
+					tracebackerror=14;
 
-										if (!found&&cumulative>roll) {
-											stack.push(i+1,ip,1,0,0);
-											stack.push(ip+3,j-1,1,0,0);
-											stack.push(1,k,0,0,0);
-										
-											regbp(ct,number,ip+2,j);
-											found=true;
-
-										}
-
-									}
-								}
-						
+				}
+         
+      		
+				break;
+			case 1: //switchcase=1, dealing with a v fragment
+				regbp(basepr,i,j);
+
+				//check to see if constant is used.  
+				//If it is, then v->f(i,j) was multiplied by ct->constant[j][i] and
+				//this influence needs to be removed.
+				if (ct->constant!=NULL) denominator = v->f(i,j) / ct->constant[j][i];
+				else denominator = v->f(i,j);
+
+				//With the three-state reactivity model, v->f(i,j) includes the helix-end constants of i,j, and
+				//if i,j is stacked on from outside, the part of V in v2 also gets the stacked constants of i,j.
+				stackfactor = 1.0;
+				if (v2!=NULL) {
+					if (stackedoutside) {
+						denominator = denominator*pfvstack(i,j,v,v2,ct)/v->f(i,j);
+						stackfactor = pfstacked(i,j,ct);
+					}
+					denominator = denominator/pfhelixend(i,j,ct);
+				}
 
-							}
-						}
+				//try closing a hairpin
+				cumulative += (erg3(i,j,ct,data,fce->f(i,j)))/denominator;
+				if (cumulative>roll) {
+					found = true; //nothing to put on the stack
 
-						#endif //SIMPLEMBLOOP
+				}
 
+				//try stacking on a previous pair
+				if (!mod[i]&&!mod[j]) {
+					cumulative+=erg1(i,j,i+1,j-1,ct,data)*pfvstack(i+1,j-1,v,v2,ct)*stackfactor/denominator;
+					if (!found&&cumulative>roll) {
+						stack.push(i+1,j-1,1,0,1);
+						found=true;
 
 					}
 
-					if (!found) {
-						cout << "Traceback error at w5\n";
-						tracebackerror=14;
+				}
+				else {
+					if ((ct->numseq[i]==3&&ct->numseq[j]==4)||(ct->numseq[i]==4&&ct->numseq[j]==3)) {
+						cumulative+=erg1(i,j,i+1,j-1,ct,data)*pfvstack(i+1,j-1,v,v2,ct)*stackfactor/denominator;
+						if (cumulative>roll) {
+							stack.push(i+1,j-1,1,0,1);
+							found=true;
 
-					}
-         
-      		
-					break;
-				case 1: //switchcase=1, dealing with a v fragment
-					regbp(ct,number,i,j);
-
-					//check to see if constant is used.  
-					//If it is, then v->f(i,j) was multiplied by ct->constant[j][i] and
-					//this influence needs to be removed.
-					if (ct->constant!=NULL) denominator = v->f(i,j) / ct->constant[j][i];
-					else denominator = v->f(i,j);
-
-					//try closing a hairpin
-					cumulative += (erg3(i,j,ct,data,fce->f(i,j)))/denominator;
-					if (cumulative>roll) {
-						found = true; //nothing to put on the stack
+						}
 
 					}
+					else if ((ct->numseq[i+1]==3&&ct->numseq[j-1]==4)||(ct->numseq[i+1]==4&&ct->numseq[j-1]==3)) {
 
-					//try stacking on a previous pair
-					if (!mod[i]&&!mod[j]) {
-						cumulative+=erg1(i,j,i+1,j-1,ct,data)*v->f(i+1,j-1)/denominator;
-						if (!found&&cumulative>roll) {
-							stack.push(i+1,j-1,1,0,0);
+						cumulative+=erg1(i,j,i+1,j-1,ct,data)*pfvstack(i+1,j-1,v,v2,ct)*stackfactor/denominator;
+						if (cumulative>roll) {
+							stack.push(i+1,j-1,1,0,1);
 							found=true;
 
 						}
 
 					}
-					else {
-						if ((ct->numseq[i]==3&&ct->numseq[j]==4)||(ct->numseq[i]==4&&ct->numseq[j]==3)) {
-							cumulative+=erg1(i,j,i+1,j-1,ct,data)*v->f(i+1,j-1)/denominator;
-							if (cumulative>roll) {
-								stack.push(i+1,j-1,1,0,0);
-								found=true;
-
-							}
-
-						}
-						else if ((ct->numseq[i+1]==3&&ct->numseq[j-1]==4)||(ct->numseq[i+1]==4&&ct->numseq[j-1]==3)) {
+					else if (i-1>0) {
+						if ((ct->numseq[i-1]==3&&ct->numseq[j+1]==4)||(ct->numseq[i-1]==4&&ct->numseq[j+1]==3)) {
 
-							cumulative+=erg1(i,j,i+1,j-1,ct,data)*v->f(i+1,j-1)/denominator;
+							cumulative+=erg1(i,j,i+1,j-1,ct,data)*pfvstack(i+1,j-1,v,v2,ct)*stackfactor/denominator;
 							if (cumulative>roll) {
-								stack.push(i+1,j-1,1,0,0);
+								stack.push(i+1,j-1,1,0,1);
 								found=true;
 
 							}
-
+			
 						}
-						else if (i-1>0) {
-							if ((ct->numseq[i-1]==3&&ct->numseq[j+1]==4)||(ct->numseq[i-1]==4&&ct->numseq[j+1]==3)) {
-
-								cumulative+=erg1(i,j,i+1,j-1,ct,data)*v->f(i+1,j-1)/denominator;
-								if (cumulative>roll) {
-									stack.push(i+1,j-1,1,0,0);
-									found=true;
-
-								}
-				
-							}
 
-						}
+					}
 
 
-					}
-					for (d=(j-i-3);d>=1&&!found;d--) {
-						for (ip=(i+1);ip<=(j-1-d)&&!found;ip++) {
+				}
+				for (d=(j-i-3);d>=1&&!found;d--) {
+					for (ip=(i+1);ip<=(j-1-d)&&!found;ip++) {
             				jp = d+ip;
-							if ((j-i-2-d)>(data->maxintloopsize)) break;
-								if (abs(ip-i+jp-j)<=(data->maxintloopsize)) {
+						if ((j-i-2-d)>(data->maxintloopsize)) break;
+							if (abs(ip-i+jp-j)<=(data->maxintloopsize)) {
 
-									cumulative+=erg2(i,j,ip,jp,ct,data,fce->f(i,ip),fce->f(jp,j))*v->f(ip,jp)/denominator;
+								cumulative+=erg2(i,j,ip,jp,ct,data,fce->f(i,ip),fce->f(jp,j))*v->f(ip,jp)/denominator;
 
-									if (!found&&cumulative>roll) {
+								if (!found&&cumulative>roll) {
 
-										stack.push(ip,jp,1,0,0);
-										found=true;
+									stack.push(ip,jp,1,0,0);
+									found=true;
 
-									}
+								}
 
-									if (!found&&(mod[ip]||mod[jp])) if (inc[ct->numseq[ip]][ct->numseq[jp]]&&notgu(ip,jp,ct)&&!(fce->f(ip,jp)&SINGLE)) {
-										//i or j is modified
-										cumulative+=erg2(i,j,ip,jp,ct,data,fce->f(i,ip),fce->f(jp,j))*
+								if (!found&&(mod[ip]||mod[jp])) if (inc[ct->numseq[ip]][ct->numseq[jp]]&&notgu(ip,jp,ct)&&!(fce->f(ip,jp)&SINGLE)) {
+									//i or j is modified
+									cumulative+=erg2(i,j,ip,jp,ct,data,fce->f(i,ip),fce->f(jp,j))*
                   							v->f(ip+1,jp-1)*erg1(ip,jp,ip+1,jp-1,ct,data)/denominator;
-										if (cumulative>roll) {
-
-											regbp(ct,number,ip,jp);
-											stack.push(ip+1,jp-1,1,0,0);
-											found=true;
-										}
+									if (cumulative>roll) {
 
+										regbp(basepr,ip,jp);
+										stack.push(ip+1,jp-1,1,0,0);
+										found=true;
 									}
+
 								}
-						
-						}
+							}
+					
 					}
-					//consider the multiloop closed by i,j
-					if (!found&&(j-i)>(2*minloop+4)) {
+				}
+				//consider the multiloop closed by i,j
+				if (!found&&(j-i)>(2*minloop+4)) {
           				
-						#ifdef SIMPLEMBLOOP
-						//i+1 dangles
-						cumulative+=erg4(i,j,i+1,1,ct,data,lfce[i+1])*penalty(i,j,ct,data)*
+					#ifdef SIMPLEMBLOOP
+					//i+1 dangles
+					cumulative+=erg4(i,j,i+1,1,ct,data,lfce[i+1])*penalty(i,j,ct,data)*
             				wmb->f(i+2,j-1)* data->eparam[5] * data->eparam[6] * data->eparam[10]*twoscaling/v->f(i,j);
-						if (!found&&cumulative>roll) {
-							stack.push(i+2,j-1,3,0,0);
-							found=true;
-			
-						}
-						#else  //!SIMPLEMBLOOP
+					if (!found&&cumulative>roll) {
+						stack.push(i+2,j-1,3,0,0);
+						found=true;
+		
+					}
+					#else  //!SIMPLEMBLOOP
 
-						
-						//no dangling ends on i-j pair:
-						cumulative+=wmb->f(i+1,j-1)*data->eparam[5]*data->eparam[10]
+					
+					//no dangling ends on i-j pair:
+					cumulative+=wmb->f(i+1,j-1)*data->eparam[5]*data->eparam[10]
             				*penalty(i,j,ct,data)*twoscaling/denominator;
 
-						if (cumulative>roll) {
-							stack.push(i+1,j-1,3,0,0);
-							found=true;
-			
-						}
+					if (cumulative>roll) {
+						stack.push(i+1,j-1,3,0,0);
+						found=true;
+		
+					}
 
-						//i+1 dangles
-						cumulative+=erg4(i,j,i+1,1,ct,data,lfce[i+1])*penalty(i,j,ct,data)*
+					//i+1 dangles
+					cumulative+=erg4(i,j,i+1,1,ct,data,lfce[i+1])*penalty(i,j,ct,data)*
             				wmb->f(i+2,j-1)* data->eparam[5] * data->eparam[6] * data->eparam[10]*twoscaling/denominator;
-						if (!found&&cumulative>roll) {
-							stack.push(i+2,j-1,3,0,0);
-							found=true;
-			
-						}
+					if (!found&&cumulative>roll) {
+						stack.push(i+2,j-1,3,0,0);
+						found=true;
+		
+					}
 
-						//j-1 dangles
-						cumulative+=erg4(i,j,j-1,2,ct,data,lfce[j-1]) * penalty(i,j,ct,data) *
+					//j-1 dangles
+					cumulative+=erg4(i,j,j-1,2,ct,data,lfce[j-1]) * penalty(i,j,ct,data) *
             				wmb->f(i+1,j-2) * data->eparam[5] * data->eparam[6] * data->eparam[10]*twoscaling/denominator;
+					if (!found&&cumulative>roll) {
+						stack.push(i+1,j-2,3,0,0);
+						found=true;
+		
+					}
+
+					//both i+1 and j-1 dangle
+			
+            			cumulative+=data->tstkm[ct->numseq[i]][ct->numseq[j]][ct->numseq[i+1]][ct->numseq[j-1]]*
+							pfchecknp(lfce[i+1],lfce[j-1])*
+							wmb->f(i+2,j-2) * data->eparam[5] * data->eparam[6] * data->eparam[6]* data->eparam[10]
+							*penalty(i,j,ct,data)*twoscaling/denominator;
+
+					if (!found&&cumulative>roll) {
+						stack.push(i+2,j-2,3,0,0);
+						found=true;
+		
+					}
+
+					#ifndef disablecoax //a flag to turn off coaxial stacking
+
+					//consider the coaxial stacking of a helix from i to j onto helix i+1 or i+2 to ip:
+					for (ip=i+1;(ip<j)&&!found;ip++) {
+						
+						//first consider flush stacking
+						cumulative+=penalty(i,j,ct,data)*v->f(i+1,ip)*
+							penalty(i+1,ip,ct,data)*data->eparam[5]
+							*data->eparam[10]*data->eparam[10]*(w->f(ip+1,j-1))*ergcoaxflushbases(j,i,i+1,ip,ct,data)
+							*twoscaling/denominator;
+
 						if (!found&&cumulative>roll) {
-							stack.push(i+1,j-2,3,0,0);
+							stack.push(ip+1,j-1,4,0,0);
+							stack.push(i+1,ip,1,0,0);
 							found=true;
-			
+		
 						}
 
-						//both i+1 and j-1 dangle
-				
-            			cumulative+=data->tstkm[ct->numseq[i]][ct->numseq[j]][ct->numseq[i+1]][ct->numseq[j-1]]*
-								pfchecknp(lfce[i+1],lfce[j-1])*
-								wmb->f(i+2,j-2) * data->eparam[5] * data->eparam[6] * data->eparam[6]* data->eparam[10]
-								*penalty(i,j,ct,data)*twoscaling/denominator;
+						cumulative+=penalty(i,j,ct,data)*v->f(i+1,ip)*
+							penalty(i+1,ip,ct,data)*data->eparam[5]
+							*data->eparam[10]*data->eparam[10]*(wmb->f(ip+1,j-1))*ergcoaxflushbases(j,i,i+1,ip,ct,data)
+							*twoscaling/denominator;
 
 						if (!found&&cumulative>roll) {
-							stack.push(i+2,j-2,3,0,0);
+							stack.push(ip+1,j-1,3,0,0);
+							stack.push(i+1,ip,1,0,0);
 							found=true;
-			
+		
 						}
 
-						#ifndef disablecoax //a flag to turn off coaxial stacking
+						if((mod[i+1]||mod[ip])) if (inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&notgu(i+1,ip,ct)&&!(fce->f(i+1,ip)&SINGLE)) {
 
-						//consider the coaxial stacking of a helix from i to j onto helix i+1 or i+2 to ip:
-						for (ip=i+1;(ip<j)&&!found;ip++) {
-							
-							//first consider flush stacking
-							cumulative+=penalty(i,j,ct,data)*v->f(i+1,ip)*
+							cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip-1)*
 								penalty(i+1,ip,ct,data)*data->eparam[5]
 								*data->eparam[10]*data->eparam[10]*(w->f(ip+1,j-1))*ergcoaxflushbases(j,i,i+1,ip,ct,data)
-								*twoscaling/denominator;
+								*erg1(i+1,ip,i+2,ip-1,ct,data)*twoscaling/denominator;
 
 							if (!found&&cumulative>roll) {
 								stack.push(ip+1,j-1,4,0,0);
-								stack.push(i+1,ip,1,0,0);
+								stack.push(i+2,ip-1,1,0,0);
+								regbp(basepr,i+1,ip);
 								found=true;
-			
+		
 							}
 
-							cumulative+=penalty(i,j,ct,data)*v->f(i+1,ip)*
+
+
+							cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip-1)*
 								penalty(i+1,ip,ct,data)*data->eparam[5]
 								*data->eparam[10]*data->eparam[10]*(wmb->f(ip+1,j-1))*ergcoaxflushbases(j,i,i+1,ip,ct,data)
-								*twoscaling/denominator;
+								*erg1(i+1,ip,i+2,ip-1,ct,data)*twoscaling/denominator;
 
 							if (!found&&cumulative>roll) {
 								stack.push(ip+1,j-1,3,0,0);
-								stack.push(i+1,ip,1,0,0);
+								stack.push(i+2,ip-1,1,0,0);
+								regbp(basepr,i+1,ip);
 								found=true;
-			
+		
 							}
 
-							if((mod[i+1]||mod[ip])) if (inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&notgu(i+1,ip,ct)&&!(fce->f(i+1,ip)&SINGLE)) {
-
-								cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip-1)*
-									penalty(i+1,ip,ct,data)*data->eparam[5]
-									*data->eparam[10]*data->eparam[10]*(w->f(ip+1,j-1))*ergcoaxflushbases(j,i,i+1,ip,ct,data)
-									*erg1(i+1,ip,i+2,ip-1,ct,data)*twoscaling/denominator;
-
-								if (!found&&cumulative>roll) {
-									stack.push(ip+1,j-1,4,0,0);
-									stack.push(i+2,ip-1,1,0,0);
-									regbp(ct,number,i+1,ip);
-									found=true;
-			
-								}
+						}
 
+						//Now calculate ca stacki8ng with intervening mismatch
+						if ((ip+2<j-1)) {
+							cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip)*
+								penalty(i+2,ip,ct,data)*data->eparam[5]
+								*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
+								(w->f(ip+2,j-1))
+								*ergcoaxinterbases2(j,i,i+2,ip,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[ip+1])/denominator;
 
+							if (!found&&cumulative>roll) {
+								stack.push(ip+2,j-1,4,0,0);
+								stack.push(i+2,ip,1,0,0);
+								
+								found=true;
+		
+							}
 
-								cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip-1)*
-									penalty(i+1,ip,ct,data)*data->eparam[5]
-									*data->eparam[10]*data->eparam[10]*(wmb->f(ip+1,j-1))*ergcoaxflushbases(j,i,i+1,ip,ct,data)
-									*erg1(i+1,ip,i+2,ip-1,ct,data)*twoscaling/denominator;
 
-								if (!found&&cumulative>roll) {
-									stack.push(ip+1,j-1,3,0,0);
-									stack.push(i+2,ip-1,1,0,0);
-									regbp(ct,number,i+1,ip);
-									found=true;
-			
-								}
+							cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip)*
+								penalty(i+2,ip,ct,data)*data->eparam[5]
+								*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
+								(wmb->f(ip+2,j-1))
+								*ergcoaxinterbases2(j,i,i+2,ip,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[ip+1])/denominator;
 
+							if (!found&&cumulative>roll) {
+								stack.push(ip+2,j-1,3,0,0);
+								stack.push(i+2,ip,1,0,0);
+								
+								found=true;
+		
 							}
 
-							//Now calculate ca stacki8ng with intervening mismatch
-							if ((ip+2<j-1)) {
-								cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip)*
-									penalty(i+2,ip,ct,data)*data->eparam[5]
-									*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
-									(w->f(ip+2,j-1))
-									*ergcoaxinterbases2(j,i,i+2,ip,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[ip+1])/denominator;
 
-								if (!found&&cumulative>roll) {
-									stack.push(ip+2,j-1,4,0,0);
-									stack.push(i+2,ip,1,0,0);
-									
-									found=true;
-			
-								}
 
+						}
 
-								cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip)*
-									penalty(i+2,ip,ct,data)*data->eparam[5]
-									*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
-									(wmb->f(ip+2,j-1))
-									*ergcoaxinterbases2(j,i,i+2,ip,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[ip+1])/denominator;
+						if((mod[i+2]||mod[ip])) if (inc[ct->numseq[i+3]][ct->numseq[ip-1]]&&notgu(i+2,ip,ct)
+							&&!(fce->f(i+2,ip)&SINGLE)) {
 
-								if (!found&&cumulative>roll) {
-									stack.push(ip+2,j-1,3,0,0);
-									stack.push(i+2,ip,1,0,0);
-									
-									found=true;
-			
-								}
+							cumulative+=penalty(i,j,ct,data)*v->f(i+3,ip-1)*
+								penalty(i+2,ip,ct,data)*data->eparam[5]
+								*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
+								(w->f(ip+2,j-1))
+								*ergcoaxinterbases2(j,i,i+2,ip,ct,data)
+								*erg1(i+2,ip,i+3,ip-1,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[ip+1])/denominator;
 
+							if (!found&&cumulative>roll) {
+								stack.push(ip+2,j-1,4,0,0);
+								stack.push(i+3,ip-1,1,0,0);
+								regbp(basepr,i+2,ip);
+								
+								found=true;
+		
+							}
 
 
-							}
+							cumulative+=penalty(i,j,ct,data)*v->f(i+3,ip-1)*
+								penalty(i+2,ip,ct,data)*data->eparam[5]
+								*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
+								(wmb->f(ip+2,j-1))
+								*ergcoaxinterbases2(j,i,i+2,ip,ct,data)
+								*erg1(i+2,ip,i+3,ip-1,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[ip+1])/denominator;
 
-							if((mod[i+2]||mod[ip])) if (inc[ct->numseq[i+3]][ct->numseq[ip-1]]&&notgu(i+2,ip,ct)
-								&&!(fce->f(i+2,ip)&SINGLE)) {
+							if (!found&&cumulative>roll) {
+								stack.push(ip+2,j-1,3,0,0);
+								stack.push(i+3,ip-1,1,0,0);
+								regbp(basepr,i+2,ip);
+								
+								found=true;
+		
+							}
 
-								cumulative+=penalty(i,j,ct,data)*v->f(i+3,ip-1)*
-									penalty(i+2,ip,ct,data)*data->eparam[5]
-									*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
-									(w->f(ip+2,j-1))
-									*ergcoaxinterbases2(j,i,i+2,ip,ct,data)
-									*erg1(i+2,ip,i+3,ip-1,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[ip+1])/denominator;
+						}
 
-								if (!found&&cumulative>roll) {
-									stack.push(ip+2,j-1,4,0,0);
-									stack.push(i+3,ip-1,1,0,0);
-									regbp(ct,number,i+2,ip);
-									
-									found=true;
-			
-								}
+						if (ip+1<j-2) {
+							cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip)*
+								penalty(i+2,ip,ct,data)*data->eparam[5]
+								*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
+								(w->f(ip+1,j-2))
+								*ergcoaxinterbases1(j,i,i+2,ip,ct,data)*twoscaling
+								*pfchecknp(lfce[i+1],lfce[j-1])/denominator;
 
+							if (!found&&cumulative>roll) {
+								stack.push(ip+1,j-2,4,0,0);
+								stack.push(i+2,ip,1,0,0);
+								
+								found=true;
+		
+							}
 
-								cumulative+=penalty(i,j,ct,data)*v->f(i+3,ip-1)*
-									penalty(i+2,ip,ct,data)*data->eparam[5]
-									*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
-									(wmb->f(ip+2,j-1))
-									*ergcoaxinterbases2(j,i,i+2,ip,ct,data)
-									*erg1(i+2,ip,i+3,ip-1,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[ip+1])/denominator;
 
-								if (!found&&cumulative>roll) {
-									stack.push(ip+2,j-1,3,0,0);
-									stack.push(i+3,ip-1,1,0,0);
-									regbp(ct,number,i+2,ip);
-									
-									found=true;
-			
-								}
+							cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip)*
+								penalty(i+2,ip,ct,data)*data->eparam[5]
+								*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
+								(wmb->f(ip+1,j-2))
+								*ergcoaxinterbases1(j,i,i+2,ip,ct,data)*twoscaling
+								*pfchecknp(lfce[i+1],lfce[j-1])/denominator;
 
+							if (!found&&cumulative>roll) {
+								stack.push(ip+1,j-2,3,0,0);
+								stack.push(i+2,ip,1,0,0);
+								
+								found=true;
+		
 							}
 
-							if (ip+1<j-2) {
-								cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip)*
+
+							if(!found&&(mod[i+2]||mod[ip])) if (inc[ct->numseq[i+3]][ct->numseq[ip-1]]&&notgu(i+2,ip,ct)
+								&&!(fce->f(i+2,ip)&SINGLE)) {
+
+								cumulative+=penalty(i,j,ct,data)*v->f(i+3,ip-1)*
 									penalty(i+2,ip,ct,data)*data->eparam[5]
 									*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
 									(w->f(ip+1,j-2))
-									*ergcoaxinterbases1(j,i,i+2,ip,ct,data)*twoscaling
-									*pfchecknp(lfce[i+1],lfce[j-1])/denominator;
+									*ergcoaxinterbases1(j,i,i+2,ip,ct,data)
+									*erg1(i+2,ip,i+3,ip-1,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[j-1])/denominator;
 
 								if (!found&&cumulative>roll) {
 									stack.push(ip+1,j-2,4,0,0);
-									stack.push(i+2,ip,1,0,0);
-									
+									stack.push(i+3,ip-1,1,0,0);
+									regbp(basepr,i+2,ip);
 									found=true;
-			
+		
 								}
 
-
-								cumulative+=penalty(i,j,ct,data)*v->f(i+2,ip)*
+								cumulative+=penalty(i,j,ct,data)*v->f(i+3,ip-1)*
 									penalty(i+2,ip,ct,data)*data->eparam[5]
 									*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
 									(wmb->f(ip+1,j-2))
-									*ergcoaxinterbases1(j,i,i+2,ip,ct,data)*twoscaling
-									*pfchecknp(lfce[i+1],lfce[j-1])/denominator;
-
+									*ergcoaxinterbases1(j,i,i+2,ip,ct,data)
+									*erg1(i+2,ip,i+3,ip-1,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[j-1])/denominator;
 								if (!found&&cumulative>roll) {
 									stack.push(ip+1,j-2,3,0,0);
-									stack.push(i+2,ip,1,0,0);
-									
+									stack.push(i+3,ip-1,1,0,0);
+									regbp(basepr,i+2,ip);
 									found=true;
-			
+		
 								}
 
-
-								if(!found&&(mod[i+2]||mod[ip])) if (inc[ct->numseq[i+3]][ct->numseq[ip-1]]&&notgu(i+2,ip,ct)
-									&&!(fce->f(i+2,ip)&SINGLE)) {
-
-									cumulative+=penalty(i,j,ct,data)*v->f(i+3,ip-1)*
-										penalty(i+2,ip,ct,data)*data->eparam[5]
-										*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
-										(w->f(ip+1,j-2))
-										*ergcoaxinterbases1(j,i,i+2,ip,ct,data)
-										*erg1(i+2,ip,i+3,ip-1,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[j-1])/denominator;
-
-									if (!found&&cumulative>roll) {
-										stack.push(ip+1,j-2,4,0,0);
-										stack.push(i+3,ip-1,1,0,0);
-										regbp(ct,number,i+2,ip);
-										found=true;
+							}
+						}
+					}
+					//consider the coaxial stacking of a helix from i to j onto helix ip to j-2 or j-1:
+					for (ip=j-1;ip>i&&!found;ip--) {
 			
-									}
-
-									cumulative+=penalty(i,j,ct,data)*v->f(i+3,ip-1)*
-										penalty(i+2,ip,ct,data)*data->eparam[5]
-										*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
-										(wmb->f(ip+1,j-2))
-										*ergcoaxinterbases1(j,i,i+2,ip,ct,data)
-										*erg1(i+2,ip,i+3,ip-1,ct,data)*twoscaling*pfchecknp(lfce[i+1],lfce[j-1])/denominator;
-									if (!found&&cumulative>roll) {
-										stack.push(ip+1,j-2,3,0,0);
-										stack.push(i+3,ip-1,1,0,0);
-										regbp(ct,number,i+2,ip);
-										found=true;
 			
-									}
+						//first consider flush stacking
+						cumulative+=penalty(i,j,ct,data)*v->f(ip,j-1)*
+							penalty(j-1,ip,ct,data)*data->eparam[5]
+							*data->eparam[10]*data->eparam[10]*(w->f(i+1,ip-1))*ergcoaxflushbases(ip,j-1,j,i,ct,data)
+							*twoscaling/denominator;
+								
+						if (!found&&cumulative>roll) {
+							stack.push(ip,j-1,1,0,0);
+							stack.push(i+1,ip-1,4,0,0);
+							found=true;
+						}
 
-								}
-							}
+
+						cumulative+=penalty(i,j,ct,data)*v->f(ip,j-1)*
+							penalty(j-1,ip,ct,data)*data->eparam[5]
+							*data->eparam[10]*data->eparam[10]*(wmb->f(i+1,ip-1))*ergcoaxflushbases(ip,j-1,j,i,ct,data)
+							*twoscaling/denominator;
+
+						if (!found&&cumulative>roll) {
+							stack.push(ip,j-1,1,0,0);
+							stack.push(i+1,ip-1,3,0,0);
+							found=true;
 						}
-						//consider the coaxial stacking of a helix from i to j onto helix ip to j-2 or j-1:
-						for (ip=j-1;ip>i&&!found;ip--) {
-				
-				
-							//first consider flush stacking
-							cumulative+=penalty(i,j,ct,data)*v->f(ip,j-1)*
+
+						if((mod[ip]||mod[j-1])) if(inc[ct->numseq[ip+1]][ct->numseq[j-2]]&&notgu(ip,j-1,ct)&&!(fce->f(ip,j-1)&SINGLE)) {
+								
+							cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-2)*
 								penalty(j-1,ip,ct,data)*data->eparam[5]
-								*data->eparam[10]*data->eparam[10]*(w->f(i+1,ip-1))*ergcoaxflushbases(ip,j-1,j,i,ct,data)
-								*twoscaling/denominator;
-									
+								*data->eparam[10]*data->eparam[10]*(w->f(i+1,ip-1))
+								*ergcoaxflushbases(ip,j-1,j,i,ct,data)
+								*erg1(ip,j-1,ip+1,j-2,ct,data)*twoscaling/denominator;
+
 							if (!found&&cumulative>roll) {
-								stack.push(ip,j-1,1,0,0);
+								stack.push(ip+1,j-2,1,0,0);
 								stack.push(i+1,ip-1,4,0,0);
+								regbp(basepr,ip,j-1);
 								found=true;
 							}
 
 
-							cumulative+=penalty(i,j,ct,data)*v->f(ip,j-1)*
+							cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-2)*
 								penalty(j-1,ip,ct,data)*data->eparam[5]
-								*data->eparam[10]*data->eparam[10]*(wmb->f(i+1,ip-1))*ergcoaxflushbases(ip,j-1,j,i,ct,data)
-								*twoscaling/denominator;
-
+								*data->eparam[10]*data->eparam[10]*(wmb->f(i+1,ip-1))
+								*ergcoaxflushbases(ip,j-1,j,i,ct,data)
+								*erg1(ip,j-1,ip+1,j-2,ct,data)*twoscaling/denominator;
 							if (!found&&cumulative>roll) {
-								stack.push(ip,j-1,1,0,0);
+								stack.push(ip+1,j-2,1,0,0);
 								stack.push(i+1,ip-1,3,0,0);
+								regbp(basepr,ip,j-1);
 								found=true;
 							}
 
-							if((mod[ip]||mod[j-1])) if(inc[ct->numseq[ip+1]][ct->numseq[j-2]]&&notgu(ip,j-1,ct)&&!(fce->f(ip,j-1)&SINGLE)) {
-									
-								cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-2)*
-									penalty(j-1,ip,ct,data)*data->eparam[5]
-									*data->eparam[10]*data->eparam[10]*(w->f(i+1,ip-1))
-									*ergcoaxflushbases(ip,j-1,j,i,ct,data)
-									*erg1(ip,j-1,ip+1,j-2,ct,data)*twoscaling/denominator;
+						}
 
-								if (!found&&cumulative>roll) {
-									stack.push(ip+1,j-2,1,0,0);
-									stack.push(i+1,ip-1,4,0,0);
-									regbp(ct,number,ip,j-1);
-									found=true;
-								}
+						//now consider an intervening nuc
+							
+						if (ip-2>i+1) {
+							cumulative+=penalty(i,j,ct,data)*v->f(ip,j-2)*
+								penalty(j-2,ip,ct,data)*data->eparam[5]
+								*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
+								(w->f(i+1,ip-2))
+								*ergcoaxinterbases1(ip,j-2,j,i,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[ip-1])/denominator;
 
+							if (!found&&cumulative>roll) {
+								stack.push(ip,j-2,1,0,0);
+								stack.push(i+1,ip-2,4,0,0);
+								found=true;
+							}
 
-								cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-2)*
-									penalty(j-1,ip,ct,data)*data->eparam[5]
-									*data->eparam[10]*data->eparam[10]*(wmb->f(i+1,ip-1))
-									*ergcoaxflushbases(ip,j-1,j,i,ct,data)
-									*erg1(ip,j-1,ip+1,j-2,ct,data)*twoscaling/denominator;
-								if (!found&&cumulative>roll) {
-									stack.push(ip+1,j-2,1,0,0);
-									stack.push(i+1,ip-1,3,0,0);
-									regbp(ct,number,ip,j-1);
-									found=true;
-								}
+							cumulative+=penalty(i,j,ct,data)*v->f(ip,j-2)*
+								penalty(j-2,ip,ct,data)*data->eparam[5]
+								*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
+								(wmb->f(i+1,ip-2))
+								*ergcoaxinterbases1(ip,j-2,j,i,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[ip-1])/denominator;
 
+							if (!found&&cumulative>roll) {
+								stack.push(ip,j-2,1,0,0);
+								stack.push(i+1,ip-2,3,0,0);
+								found=true;
 							}
 
-							//now consider an intervening nuc
-								
-							if (ip-2>i+1) {
-								cumulative+=penalty(i,j,ct,data)*v->f(ip,j-2)*
+							if((mod[ip]||mod[j-2])) if(inc[ct->numseq[ip+1]][ct->numseq[j-3]]&&notgu(ip,j-2,ct)&&!(fce->f(ip,j-2)&SINGLE)) {
+									
+								cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-3)*
 									penalty(j-2,ip,ct,data)*data->eparam[5]
 									*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
 									(w->f(i+1,ip-2))
-									*ergcoaxinterbases1(ip,j-2,j,i,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[ip-1])/denominator;
+									*ergcoaxinterbases1(ip,j-2,j,i,ct,data)
+									*erg1(ip,j-2,ip+1,j-3,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[ip-1])/denominator;
 
 								if (!found&&cumulative>roll) {
-									stack.push(ip,j-2,1,0,0);
+									stack.push(ip+1,j-3,1,0,0);
 									stack.push(i+1,ip-2,4,0,0);
+									regbp(basepr,ip,j-2);
 									found=true;
 								}
 
-								cumulative+=penalty(i,j,ct,data)*v->f(ip,j-2)*
+
+								cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-3)*
 									penalty(j-2,ip,ct,data)*data->eparam[5]
 									*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
 									(wmb->f(i+1,ip-2))
-									*ergcoaxinterbases1(ip,j-2,j,i,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[ip-1])/denominator;
+									*ergcoaxinterbases1(ip,j-2,j,i,ct,data)
+									*erg1(ip,j-2,ip+1,j-3,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[ip-1])/denominator;
 
 								if (!found&&cumulative>roll) {
-									stack.push(ip,j-2,1,0,0);
+									stack.push(ip+1,j-3,1,0,0);
 									stack.push(i+1,ip-2,3,0,0);
+									regbp(basepr,ip,j-2);
 									found=true;
 								}
 
-								if((mod[ip]||mod[j-2])) if(inc[ct->numseq[ip+1]][ct->numseq[j-3]]&&notgu(ip,j-2,ct)&&!(fce->f(ip,j-2)&SINGLE)) {
-										
-									cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-3)*
-										penalty(j-2,ip,ct,data)*data->eparam[5]
-										*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
-										(w->f(i+1,ip-2))
-										*ergcoaxinterbases1(ip,j-2,j,i,ct,data)
-										*erg1(ip,j-2,ip+1,j-3,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[ip-1])/denominator;
+							}
 
-									if (!found&&cumulative>roll) {
-										stack.push(ip+1,j-3,1,0,0);
-										stack.push(i+1,ip-2,4,0,0);
-										regbp(ct,number,ip,j-2);
-										found=true;
-									}
+						}
 
+						if ((ip-1>i+2)) {
+							cumulative+=penalty(i,j,ct,data)*v->f(ip,j-2)*
+								penalty(j-2,ip,ct,data)*data->eparam[5]
+								*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
+								(w->f(i+2,ip-1))
+								*ergcoaxinterbases2(ip,j-2,j,i,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[i+1])/denominator;
 
-									cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-3)*
-										penalty(j-2,ip,ct,data)*data->eparam[5]
-										*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
-										(wmb->f(i+1,ip-2))
-										*ergcoaxinterbases1(ip,j-2,j,i,ct,data)
-										*erg1(ip,j-2,ip+1,j-3,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[ip-1])/denominator;
+							if (!found&&cumulative>roll) {
+								stack.push(ip,j-2,1,0,0);
+								stack.push(i+2,ip-1,4,0,0);
+								found=true;
 
-									if (!found&&cumulative>roll) {
-										stack.push(ip+1,j-3,1,0,0);
-										stack.push(i+1,ip-2,3,0,0);
-										regbp(ct,number,ip,j-2);
-										found=true;
-									}
+							}
 
-								}
+
+							cumulative+=penalty(i,j,ct,data)*v->f(ip,j-2)*
+								penalty(j-2,ip,ct,data)*data->eparam[5]
+								*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
+								(wmb->f(i+2,ip-1))
+								*ergcoaxinterbases2(ip,j-2,j,i,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[i+1])/denominator;
+
+							if (!found&&cumulative>roll) {
+								stack.push(ip,j-2,1,0,0);
+								stack.push(i+2,ip-1,3,0,0);
+								found=true;
 
 							}
 
-							if ((ip-1>i+2)) {
-								cumulative+=penalty(i,j,ct,data)*v->f(ip,j-2)*
+							if((mod[ip]||mod[j-2])) if(inc[ct->numseq[ip+1]][ct->numseq[j-3]]&&notgu(ip,j-2,ct)
+								&&!(fce->f(ip,j-2)&SINGLE)) {
+								cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-3)*
 									penalty(j-2,ip,ct,data)*data->eparam[5]
 									*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
 									(w->f(i+2,ip-1))
-									*ergcoaxinterbases2(ip,j-2,j,i,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[i+1])/denominator;
+									*ergcoaxinterbases2(ip,j-2,j,i,ct,data)
+									*erg1(ip,j-2,ip+1,j-3,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[i+1])/denominator;
 
 								if (!found&&cumulative>roll) {
-									stack.push(ip,j-2,1,0,0);
+									stack.push(ip+1,j-3,1,0,0);
 									stack.push(i+2,ip-1,4,0,0);
+									regbp(basepr,ip,j-2);
 									found=true;
 
 								}
 
 
-								cumulative+=penalty(i,j,ct,data)*v->f(ip,j-2)*
+								cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-3)*
 									penalty(j-2,ip,ct,data)*data->eparam[5]
 									*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
 									(wmb->f(i+2,ip-1))
-									*ergcoaxinterbases2(ip,j-2,j,i,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[i+1])/denominator;
+									*ergcoaxinterbases2(ip,j-2,j,i,ct,data)
+									*erg1(ip,j-2,ip+1,j-3,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[i+1])/denominator;
 
 								if (!found&&cumulative>roll) {
-									stack.push(ip,j-2,1,0,0);
+									stack.push(ip+1,j-3,1,0,0);
 									stack.push(i+2,ip-1,3,0,0);
+									regbp(basepr,ip,j-2);
 									found=true;
 
 								}
 
-								if((mod[ip]||mod[j-2])) if(inc[ct->numseq[ip+1]][ct->numseq[j-3]]&&notgu(ip,j-2,ct)
-									&&!(fce->f(ip,j-2)&SINGLE)) {
-									cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-3)*
-										penalty(j-2,ip,ct,data)*data->eparam[5]
-										*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
-										(w->f(i+2,ip-1))
-										*ergcoaxinterbases2(ip,j-2,j,i,ct,data)
-										*erg1(ip,j-2,ip+1,j-3,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[i+1])/denominator;
-
-									if (!found&&cumulative>roll) {
-										stack.push(ip+1,j-3,1,0,0);
-										stack.push(i+2,ip-1,4,0,0);
-										regbp(ct,number,ip,j-2);
-										found=true;
-
-									}
-
-
-									cumulative+=penalty(i,j,ct,data)*v->f(ip+1,j-3)*
-										penalty(j-2,ip,ct,data)*data->eparam[5]
-										*data->eparam[6]*data->eparam[6]*data->eparam[10]*data->eparam[10]*
-										(wmb->f(i+2,ip-1))
-										*ergcoaxinterbases2(ip,j-2,j,i,ct,data)
-										*erg1(ip,j-2,ip+1,j-3,ct,data)*twoscaling*pfchecknp(lfce[j-1],lfce[i+1])/denominator;
-
-									if (!found&&cumulative>roll) {
-										stack.push(ip+1,j-3,1,0,0);
-										stack.push(i+2,ip-1,3,0,0);
-										regbp(ct,number,ip,j-2);
-										found=true;
-
-									}
-
-								}
 							}
+						}
 
 
-						
-						}			
-						#endif  //disable coax stacking
-						#endif  //SIMPLEMBLOOP
-						
-					}
-
 					
-					if (!found) {
-						cout << "Traceback error in v!\n";
-						tracebackerror=14;
-					}
-		
+					}			
+					#endif  //disable coax stacking
+					#endif  //SIMPLEMBLOOP
 					
+				}
 
-					break;
-
-				case 2: //switchcase = 2, dealing with a wcoax fragment
-					#ifndef SIMPLEMBLOOP
-					#ifndef disablecoax
+				
+				if (!found) {
+					cout << "Traceback error in v!\n";
+					tracebackerror=14;
+				}
+	
+				
 
-					for (ip=i+minloop+1;ip<j-minloop-1&&!found;ip++) {
-						
-						//first consider flush stacking
-						cumulative+=v->f(i,ip)*v->f(ip+1,j)*penalty(i,ip,ct,data)
-							*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)*data->eparam[10]*data->eparam[10]/wcoax->f(i,j);
+				break;
 
-						if (cumulative > roll) {
-							stack.push(i,ip,1,0,0);
-							stack.push(ip+1,j,1,0,0);
-							found=true;
-						}
+			case 2: //switchcase = 2, dealing with a wcoax fragment
+				#ifndef SIMPLEMBLOOP
+				#ifndef disablecoax
 
+				for (ip=i+minloop+1;ip<j-minloop-1&&!found;ip++) {
+					
+					//first consider flush stacking
+					cumulative+=v->f(i,ip)*v->f(ip+1,j)*penalty(i,ip,ct,data)
+						*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)*data->eparam[10]*data->eparam[10]/wcoax->f(i,j);
 
-						if ((mod[i]||mod[ip]||mod[ip+1]||mod[j])) {
+					if (cumulative > roll) {
+						stack.push(i,ip,1,0,0);
+						stack.push(ip+1,j,1,0,0);
+						found=true;
+					}
 
-							if ((mod[i]||mod[ip])&&(mod[ip+1]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
-								&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&notgu(i,ip,ct)&&notgu(ip+1,j,ct)
-								&&!(fce->f(ip+1,j)&SINGLE)&&!(fce->f(i,ip)&SINGLE)) {
 
-								cumulative+=v->f(i+1,ip-1)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
-									*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
-									*erg1(i,ip,i+1,ip-1,ct,data)*erg1(ip+1,j,ip+2,j-1,ct,data)*data->eparam[10]*data->eparam[10]/wcoax->f(i,j);
+					if ((mod[i]||mod[ip]||mod[ip+1]||mod[j])) {
 
-								if (!found&&cumulative>roll) {
-									stack.push(i+1,ip-1,1,0,0);
-									stack.push(ip+2,j-1,1,0,0);
-									found=true;
-									regbp(ct,number,i,ip);
-									regbp(ct,number,ip+1,j);
-								}
+						if ((mod[i]||mod[ip])&&(mod[ip+1]||mod[j])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
+							&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&notgu(i,ip,ct)&&notgu(ip+1,j,ct)
+							&&!(fce->f(ip+1,j)&SINGLE)&&!(fce->f(i,ip)&SINGLE)) {
 
+							cumulative+=v->f(i+1,ip-1)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
+								*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
+								*erg1(i,ip,i+1,ip-1,ct,data)*erg1(ip+1,j,ip+2,j-1,ct,data)*data->eparam[10]*data->eparam[10]/wcoax->f(i,j);
 
+							if (!found&&cumulative>roll) {
+								stack.push(i+1,ip-1,1,0,0);
+								stack.push(ip+2,j-1,1,0,0);
+								found=true;
+								regbp(basepr,i,ip);
+								regbp(basepr,ip+1,j);
 							}
 
-							if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&notgu(i,ip,ct)&&!(fce->f(i,ip)&SINGLE)) {
-							
-								cumulative+=v->f(i+1,ip-1)*v->f(ip+1,j)*penalty(i,ip,ct,data)
-									*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
-									*erg1(i,ip,i+1,ip-1,ct,data)*data->eparam[10]*data->eparam[10]/wcoax->f(i,j);
 
-								if (!found&&cumulative>roll) {
-									stack.push(i+1,ip-1,1,0,0);
-									stack.push(ip+1,j,1,0,0);
-									found=true;
-									regbp(ct,number,i,ip);
+						}
 
-								}
+						if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&notgu(i,ip,ct)&&!(fce->f(i,ip)&SINGLE)) {
+						
+							cumulative+=v->f(i+1,ip-1)*v->f(ip+1,j)*penalty(i,ip,ct,data)
+								*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
+								*erg1(i,ip,i+1,ip-1,ct,data)*data->eparam[10]*data->eparam[10]/wcoax->f(i,j);
 
+							if (!found&&cumulative>roll) {
+								stack.push(i+1,ip-1,1,0,0);
+								stack.push(ip+1,j,1,0,0);
+								found=true;
+								regbp(basepr,i,ip);
 
 							}
 
-							if ((mod[ip+1]||mod[j])&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&notgu(ip+1,j,ct)&&!(fce->f(ip+1,j)&SINGLE)) {
-
-
-								cumulative+=v->f(i,ip)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
-									*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
-									*erg1(ip+1,j,ip+2,j-1,ct,data)*data->eparam[10]*data->eparam[10]/wcoax->f(i,j);
 
-								if (!found&&cumulative>roll) {
-									stack.push(i,ip,1,0,0);
-									stack.push(ip+2,j-1,1,0,0);
-									found=true;
-									regbp(ct,number,ip+1,j);
-			
-								}
+						}
 
-							}
+						if ((mod[ip+1]||mod[j])&&inc[ct->numseq[ip+2]][ct->numseq[j-1]]&&notgu(ip+1,j,ct)&&!(fce->f(ip+1,j)&SINGLE)) {
 
 
-						}
-
-						if (!lfce[ip+1]&&!lfce[j]) {
-							//now consider an intervening mismatch
 							cumulative+=v->f(i,ip)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
-								*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
+								*penalty(ip+1,j,ct,data)*ergcoaxflushbases(i,ip,ip+1,j,ct,data)
+								*erg1(ip+1,j,ip+2,j-1,ct,data)*data->eparam[10]*data->eparam[10]/wcoax->f(i,j);
 
-							if (cumulative>roll&&!found) {
+							if (!found&&cumulative>roll) {
 								stack.push(i,ip,1,0,0);
 								stack.push(ip+2,j-1,1,0,0);
 								found=true;
-
+								regbp(basepr,ip+1,j);
+		
 							}
 
-							if (mod[i]||mod[ip]||mod[ip+2]||mod[j-1]) {
-								if ((mod[i]||mod[ip])&&(mod[ip+2]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
-									&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&notgu(i,ip,ct)&&notgu(ip+2,j-1,ct)
-										&&!(fce->f(i,ip)&SINGLE)&&!(fce->f(ip+2,j-1)&SINGLE)) {
+						}
 
-									 cumulative+=v->f(i+1,ip-1)*v->f(ip+3,j-2)*penalty(i,ip,ct,data)
-										*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
-										*erg1(i,ip,i+1,ip-1,ct,data)*erg1(ip+2,j-1,ip+3,j-2,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
 
-									 if (!found&&cumulative>roll) {
-										stack.push(i+1,ip-1,1,0,0);
-										stack.push(ip+3,j-2,1,0,0);
-										regbp(ct,number,i,ip);
-										regbp(ct,number,ip+2,j-1);
-										found=true;
+					}
 
-									 }
+					if (!lfce[ip+1]&&!lfce[j]) {
+						//now consider an intervening mismatch
+						cumulative+=v->f(i,ip)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
+							*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
 
+						if (cumulative>roll&&!found) {
+							stack.push(i,ip,1,0,0);
+							stack.push(ip+2,j-1,1,0,0);
+							found=true;
 
-								}
+						}
 
-								if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&notgu(i,ip,ct)&&!(fce->f(i,ip)&SINGLE)) {
-							
-									cumulative+=v->f(i+1,ip-1)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
-										*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
-										*erg1(i,ip,i+1,ip-1,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
+						if (mod[i]||mod[ip]||mod[ip+2]||mod[j-1]) {
+							if ((mod[i]||mod[ip])&&(mod[ip+2]||mod[j-1])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]
+								&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&notgu(i,ip,ct)&&notgu(ip+2,j-1,ct)
+									&&!(fce->f(i,ip)&SINGLE)&&!(fce->f(ip+2,j-1)&SINGLE)) {
 
-									if(!found&&cumulative>roll) {
-										stack.push(i+1,ip-1,1,0,0);
-										stack.push(ip+2,j-1,1,0,0);
-										regbp(ct,number,i,ip);
-										found=true;
+								 cumulative+=v->f(i+1,ip-1)*v->f(ip+3,j-2)*penalty(i,ip,ct,data)
+									*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
+									*erg1(i,ip,i+1,ip-1,ct,data)*erg1(ip+2,j-1,ip+3,j-2,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
 
-									}
+								 if (!found&&cumulative>roll) {
+									stack.push(i+1,ip-1,1,0,0);
+									stack.push(ip+3,j-2,1,0,0);
+									regbp(basepr,i,ip);
+									regbp(basepr,ip+2,j-1);
+									found=true;
+
+								 }
 
 
+							}
+
+							if ((mod[i]||mod[ip])&&inc[ct->numseq[i+1]][ct->numseq[ip-1]]&&notgu(i,ip,ct)&&!(fce->f(i,ip)&SINGLE)) {
+						
+								cumulative+=v->f(i+1,ip-1)*v->f(ip+2,j-1)*penalty(i,ip,ct,data)
+									*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
+									*erg1(i,ip,i+1,ip-1,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
+
+								if(!found&&cumulative>roll) {
+									stack.push(i+1,ip-1,1,0,0);
+									stack.push(ip+2,j-1,1,0,0);
+									regbp(basepr,i,ip);
+									found=true;
+
 								}
 
-								if ((mod[ip+2]||mod[j-1])&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&notgu(ip+2,j-1,ct)&&!(fce->f(ip+2,j-1)&SINGLE)) {
 
+							}
+
+							if ((mod[ip+2]||mod[j-1])&&inc[ct->numseq[ip+3]][ct->numseq[j-2]]&&notgu(ip+2,j-1,ct)&&!(fce->f(ip+2,j-1)&SINGLE)) {
 
-									cumulative+=v->f(i,ip)*v->f(ip+3,j-2)*penalty(i,ip,ct,data)
-										*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
-										*erg1(ip+2,j-1,ip+3,j-2,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
 
-									if (!found&&cumulative>roll) {
-										stack.push(i,ip,1,0,0);
-										stack.push(ip+3,j-2,1,0,0);
-										regbp(ct,number,ip+2,j-1);
-										found=true;
+								cumulative+=v->f(i,ip)*v->f(ip+3,j-2)*penalty(i,ip,ct,data)
+									*penalty(ip+2,j-1,ct,data)*ergcoaxinterbases2(i,ip,ip+2,j-1,ct,data)
+									*erg1(ip+2,j-1,ip+3,j-2,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
 
-									}
+								if (!found&&cumulative>roll) {
+									stack.push(i,ip,1,0,0);
+									stack.push(ip+3,j-2,1,0,0);
+									regbp(basepr,ip+2,j-1);
+									found=true;
 
 								}
+
 							}
 						}
+					}
 
-						if(!lfce[i]&&!lfce[ip+1]) {
-							cumulative+=v->f(i+1,ip)*v->f(ip+2,j)*penalty(i+1,ip,ct,data)
-								*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
-
+					if(!lfce[i]&&!lfce[ip+1]) {
+						cumulative+=v->f(i+1,ip)*v->f(ip+2,j)*penalty(i+1,ip,ct,data)
+							*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
 
-							if (!found&&cumulative>roll) {
-								stack.push(i+1,ip,1,0,0);
-								stack.push(ip+2,j,1,0,0);
-								
-								found=true;
 
-							}
+						if (!found&&cumulative>roll) {
+							stack.push(i+1,ip,1,0,0);
+							stack.push(ip+2,j,1,0,0);
+							
+							found=true;
 
-							if (mod[i+1]||mod[ip]||mod[ip+2]||mod[j]) {
-								if ((mod[i+1]||mod[ip])&&(mod[ip+2]||mod[j])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]
-									&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&notgu(i+1,ip,ct)&&notgu(ip+2,j,ct)
-									&&!(fce->f(i+1,ip)&SINGLE)&&!(fce->f(ip+2,j)&SINGLE)	) {
+						}
 
-									cumulative+=v->f(i+2,ip-1)*v->f(ip+3,j-1)*penalty(i+1,ip,ct,data)
-										*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
-										*erg1(i+1,ip,i+2,ip-1,ct,data)*erg1(ip+2,j,ip+3,j-1,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);	
+						if (mod[i+1]||mod[ip]||mod[ip+2]||mod[j]) {
+							if ((mod[i+1]||mod[ip])&&(mod[ip+2]||mod[j])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]
+								&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&notgu(i+1,ip,ct)&&notgu(ip+2,j,ct)
+								&&!(fce->f(i+1,ip)&SINGLE)&&!(fce->f(ip+2,j)&SINGLE)	) {
 
-									if (!found&&cumulative>roll) {
-										stack.push(i+2,ip-1,1,0,0);
-										stack.push(ip+3,j-1,1,0,0);
-										regbp(ct,number,i+1,ip);
-										regbp(ct,number,ip+2,j);
-										found=true;
+								cumulative+=v->f(i+2,ip-1)*v->f(ip+3,j-1)*penalty(i+1,ip,ct,data)
+									*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
+									*erg1(i+1,ip,i+2,ip-1,ct,data)*erg1(ip+2,j,ip+3,j-1,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);	
 
-									}
+								if (!found&&cumulative>roll) {
+									stack.push(i+2,ip-1,1,0,0);
+									stack.push(ip+3,j-1,1,0,0);
+									regbp(basepr,i+1,ip);
+									regbp(basepr,ip+2,j);
+									found=true;
 
-							
 								}
-								if ((mod[i+1]||mod[ip])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&notgu(i+1,ip,ct)&&!(fce->f(i+1,ip)&SINGLE)) {
-							
-									cumulative+=v->f(i+2,ip-1)*v->f(ip+2,j)*penalty(i+1,ip,ct,data)
-										*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
-										*erg1(i+1,ip,i+2,ip-1,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
-
-									if (!found&&cumulative>roll) {
-										stack.push(i+2,ip-1,1,0,0);
-										stack.push(ip+2,j,1,0,0);
-										regbp(ct,number,i+1,ip);
-										
-										found=true;
 
-									}
+						
+							}
+							if ((mod[i+1]||mod[ip])&&inc[ct->numseq[i+2]][ct->numseq[ip-1]]&&notgu(i+1,ip,ct)&&!(fce->f(i+1,ip)&SINGLE)) {
+						
+								cumulative+=v->f(i+2,ip-1)*v->f(ip+2,j)*penalty(i+1,ip,ct,data)
+									*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
+									*erg1(i+1,ip,i+2,ip-1,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
 
+								if (!found&&cumulative>roll) {
+									stack.push(i+2,ip-1,1,0,0);
+									stack.push(ip+2,j,1,0,0);
+									regbp(basepr,i+1,ip);
+									
+									found=true;
 
 								}
 
-								if ((mod[ip+2]||mod[j])&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&notgu(ip+2,j,ct)&&!(fce->f(ip+2,j)&SINGLE)) {
 
+							}
 
-									cumulative+=v->f(i+1,ip)*v->f(ip+3,j-1)*penalty(i+1,ip,ct,data)
-										*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
-										*erg1(ip+2,j,ip+3,j-1,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
+							if ((mod[ip+2]||mod[j])&&inc[ct->numseq[ip+3]][ct->numseq[j-1]]&&notgu(ip+2,j,ct)&&!(fce->f(ip+2,j)&SINGLE)) {
 
-									if (!found&&cumulative>roll) {
-										stack.push(i+1,ip,1,0,0);
-										stack.push(ip+3,j-1,1,0,0);
-										
-										regbp(ct,number,ip+2,j);
-										found=true;
 
-									}
+								cumulative+=v->f(i+1,ip)*v->f(ip+3,j-1)*penalty(i+1,ip,ct,data)
+									*penalty(ip+2,j,ct,data)*ergcoaxinterbases1(i+1,ip,ip+2,j,ct,data)
+									*erg1(ip+2,j,ip+3,j-1,ct,data)*data->eparam[10]*data->eparam[10]*data->eparam[6]*data->eparam[6]/wcoax->f(i,j);
+
+								if (!found&&cumulative>roll) {
+									stack.push(i+1,ip,1,0,0);
+									stack.push(ip+3,j-1,1,0,0);
+									
+									regbp(basepr,ip+2,j);
+									found=true;
 
 								}
-							}
-						
 
+							}
 						}
-					}
-
-					if (!found) {
-
-						cout << "Traceback error at wcoax/n";
-						tracebackerror=14;
+					
 
 					}
+				}
 
-					#endif
-					#endif //SIMPLEMBLOOP
-					break;
+				if (!found) {
 
-				case 3: //switchcase = 3, dealing with wmb fragment
+					cout << "Traceback error at wcoax/n";
+					tracebackerror=14;
 
-					cumulative = wmbl->f(i,j)/wmb->f(i,j);
+				}
 
-					if (cumulative>roll) {
-						found=true;
-						stack.push(i,j,5,0,0);
+				#endif
+				#endif //SIMPLEMBLOOP
+				break;
 
-					}
-			
-					if (!lfce[j]) {
-						
-						cumulative+=wmb->f(i,j-1)*data->eparam[6]*data->scaling/wmb->f(i,j);
+			case 3: //switchcase = 3, dealing with wmb fragment
 
-						if (!found&&cumulative>roll) {
-							found=true;
-							stack.push(i,j-1,3,0,0);
+				cumulative = wmbl->f(i,j)/wmb->f(i,j);
 
-						}
+				if (cumulative>roll) {
+					found=true;
+					stack.push(i,j,5,0,0);
+
+				}
+		
+				if (!lfce[j]) {
 					
+					cumulative+=wmb->f(i,j-1)*data->eparam[6]*data->scaling/wmb->f(i,j);
+
+					if (!found&&cumulative>roll) {
+						found=true;
+						stack.push(i,j-1,3,0,0);
 
 					}
+				
 
-					if (!found) {
-						cout << "Traceback error at wmb\n";
-						tracebackerror=14;
+				}
 
-					}
+				if (!found) {
+					cout << "Traceback error at wmb\n";
+					tracebackerror=14;
 
+				}
 
-					break;
 
-				case 4: //switchcase = 4, dealing with a w fragment
+				break;
 
-					cumulative = wl->f(i,j)/w->f(i,j);
-					if (cumulative>roll) {
-						stack.push(i,j,6,0,0);
-						found=true;
+			case 4: //switchcase = 4, dealing with a w fragment
 
-					}
+				cumulative = wl->f(i,j)/w->f(i,j);
+				if (cumulative>roll) {
+					stack.push(i,j,6,0,0);
+					found=true;
 
-					if (!lfce[j]) {
+				}
+
+				if (!lfce[j]) {
              	
                			cumulative+= w->f(i,j-1) * data->eparam[6]*data->scaling/w->f(i,j);
-						if (cumulative>roll&&!found) {
-							stack.push(i,j-1,4,0,0);
-							found=true;
+					if (cumulative>roll&&!found) {
+						stack.push(i,j-1,4,0,0);
+						found=true;
 
-						}
+					}
                
 
-					}
+				}
 
-					if (!found) {
-						cout << "Traceback error at w\n";
-						tracebackerror=14;
+				if (!found) {
+					cout << "Traceback error at w\n";
+					tracebackerror=14;
 
-					}
-	  
+				}
+  
 
-					break;
+				break;
 
-				case 5:  //switchcase = 5, wmbl fragment
-					
-					cumulative=wcoax->f(i,j)/wmbl->f(i,j);
-					if (cumulative>roll&&!found) {
-						stack.push(i,j,2,0,0);
-								
-						found=true;
+			case 5:  //switchcase = 5, wmbl fragment
+				
+				cumulative=wcoax->f(i,j)/wmbl->f(i,j);
+				if (cumulative>roll&&!found) {
+					stack.push(i,j,2,0,0);
+							
+					found=true;
 
-					}
+				}
 
 
 
-					for (k=i+1;k<j&&!found;k++) {
+				for (k=i+1;k<j&&!found;k++) {
+				
 					
-						
-						if (!lfce[i]) {
-							cumulative+=(wl->f(i,k)-wl->f(i+1,k)*data->eparam[6]*data->scaling)*(wl->f(k+1,j))/wmbl->f(i,j);
-							if (cumulative>roll&&!found) {
-								stack.push(i,k,7,0,0);
-								stack.push(k+1,j,6,0,0);
-								found=true;
-
-							}
+					if (!lfce[i]) {
+						cumulative+=(wl->f(i,k)-wl->f(i+1,k)*data->eparam[6]*data->scaling)*(wl->f(k+1,j))/wmbl->f(i,j);
+						if (cumulative>roll&&!found) {
+							stack.push(i,k,7,0,0);
+							stack.push(k+1,j,6,0,0);
+							found=true;
 
-							cumulative+=(wcoax->f(i,k))*(wl->f(k+1,j))/wmbl->f(i,j);
-							if (cumulative>roll&&!found) {
-								stack.push(i,k,2,0,0);
-								stack.push(k+1,j,6,0,0);
-								found=true;
+						}
 
-							}
+						cumulative+=(wcoax->f(i,k))*(wl->f(k+1,j))/wmbl->f(i,j);
+						if (cumulative>roll&&!found) {
+							stack.push(i,k,2,0,0);
+							stack.push(k+1,j,6,0,0);
+							found=true;
 
-							cumulative+=(wl->f(i,k)-wl->f(i+1,k)*data->eparam[6]*data->scaling)*(wmbl->f(k+1,j))/wmbl->f(i,j);
-							if (cumulative>roll&&!found) {
-								stack.push(i,k,7,0,0);
-								stack.push(k+1,j,5,0,0);
-								found=true;
+						}
 
-							}
+						cumulative+=(wl->f(i,k)-wl->f(i+1,k)*data->eparam[6]*data->scaling)*(wmbl->f(k+1,j))/wmbl->f(i,j);
+						if (cumulative>roll&&!found) {
+							stack.push(i,k,7,0,0);
+							stack.push(k+1,j,5,0,0);
+							found=true;
 
-							cumulative+=(wcoax->f(i,k))*(wmbl->f(k+1,j))/wmbl->f(i,j);
-							if (cumulative>roll&&!found) {
-								stack.push(i,k,2,0,0);
-								stack.push(k+1,j,5,0,0);
-								found=true;
+						}
 
-							}
+						cumulative+=(wcoax->f(i,k))*(wmbl->f(k+1,j))/wmbl->f(i,j);
+						if (cumulative>roll&&!found) {
+							stack.push(i,k,2,0,0);
+							stack.push(k+1,j,5,0,0);
+							found=true;
 
 						}
 
-						else {
-							
-							cumulative+=(wl->f(i,k))*(wl->f(k+1,j))/wmbl->f(i,j);
-							if (cumulative>roll&&!found) {
-								stack.push(i,k,6,0,0);
-								stack.push(k+1,j,6,0,0);
-								found=true;
-
-							}
+					}
 
-							cumulative+=(wcoax->f(i,k))*(wl->f(k+1,j))/wmbl->f(i,j);
-							if (cumulative>roll&&!found) {
-								stack.push(i,k,2,0,0);
-								stack.push(k+1,j,6,0,0);
-								found=true;
+					else {
+						
+						cumulative+=(wl->f(i,k))*(wl->f(k+1,j))/wmbl->f(i,j);
+						if (cumulative>roll&&!found) {
+							stack.push(i,k,6,0,0);
+							stack.push(k+1,j,6,0,0);
+							found=true;
 
-							}
+						}
 
-							cumulative+=(wl->f(i,k)*wmbl->f(k+1,j))/wmbl->f(i,j);
-							if (cumulative>roll&&!found) {
-								stack.push(i,k,6,0,0);
-								stack.push(k+1,j,5,0,0);
-								found=true;
+						cumulative+=(wcoax->f(i,k))*(wl->f(k+1,j))/wmbl->f(i,j);
+						if (cumulative>roll&&!found) {
+							stack.push(i,k,2,0,0);
+							stack.push(k+1,j,6,0,0);
+							found=true;
 
-							}
+						}
 
-							cumulative+=(wcoax->f(i,k))*(wmbl->f(k+1,j))/wmbl->f(i,j);
-							if (cumulative>roll&&!found) {
-								stack.push(i,k,2,0,0);
-								stack.push(k+1,j,5,0,0);
-								found=true;
+						cumulative+=(wl->f(i,k)*wmbl->f(k+1,j))/wmbl->f(i,j);
+						if (cumulative>roll&&!found) {
+							stack.push(i,k,6,0,0);
+							stack.push(k+1,j,5,0,0);
+							found=true;
 
-							}
+						}
 
+						cumulative+=(wcoax->f(i,k))*(wmbl->f(k+1,j))/wmbl->f(i,j);
+						if (cumulative>roll&&!found) {
+							stack.push(i,k,2,0,0);
+							stack.push(k+1,j,5,0,0);
+							found=true;
 
 						}
 
-						
-					}
 
+					}
 
 					
-					if (!lfce[i]) {
-						cumulative+=wmbl->f(i+1,j)*data->eparam[6]*data->scaling/wmbl->f(i,j);
-						if (cumulative>roll&&!found) {
-								
-								stack.push(i+1,j,5,0,0);
-								found=true;
+				}
 
-							}
 
-					}
+				
+				if (!lfce[i]) {
+					cumulative+=wmbl->f(i+1,j)*data->eparam[6]*data->scaling/wmbl->f(i,j);
+					if (cumulative>roll&&!found) {
+							
+							stack.push(i+1,j,5,0,0);
+							found=true;
 
-					if (!found) {
-						cout << "Traceback error at wmbl\n";
-						tracebackerror=14;
-			
-					}
+						}
 
-				break;
+				}
 
-				case 6: //switchcase 6, wl fragment
+				if (!found) {
+					cout << "Traceback error at wmbl\n";
+					tracebackerror=14;
+		
+				}
 
-					#ifdef SIMPLEMBLOOP
-					if (!lfce[i]) {
+			break;
+
+			case 6: //switchcase 6, wl fragment
+
+				#ifdef SIMPLEMBLOOP
+				if (!lfce[i]) {
          		
          				cumulative=  wl->f(i+1,j)*data->eparam[6]*data->scaling/wl->f(i,j);
 
-						if (cumulative>roll) {
-							stack.push(i+1,j,6,0,0);
-							found=true;
+					if (cumulative>roll) {
+						stack.push(i+1,j,6,0,0);
+						found=true;
 
-						}
-            	
 					}
-					cumulative+= v->f(i,j-1)* data->eparam[10] * data->eparam[6] *
+            	
+				}
+				cumulative+= v->f(i,j-1)* data->eparam[10] * data->eparam[6] *
          				erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)/wl->f(i,j);
 
-					if (cumulative>roll&&!found) {
-						stack.push(i,j-1,1,0,0);
-						found=true;
+				if (cumulative>roll&&!found) {
+					stack.push(i,j-1,1,0,0);
+					found=true;
 
-					}
+				}
 
-					if ((mod[i]||mod[j-1])) if(inc[ct->numseq[i+1]][ct->numseq[j-2]]&&notgu(i,j-1,ct)&&!(fce->f(i,j-1)&SINGLE)) {
+				if ((mod[i]||mod[j-1])) if(inc[ct->numseq[i+1]][ct->numseq[j-2]]&&notgu(i,j-1,ct)&&!(fce->f(i,j-1)&SINGLE)) {
 
-						cumulative+= v->f(i+1,j-2) * data->eparam[10] * data->eparam[6] *
+					cumulative+= v->f(i+1,j-2) * data->eparam[10] * data->eparam[6] *
          					erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)
-							*erg1(i,j-1,i+1,j-2,ct,data)/wl->f(i,j);
+						*erg1(i,j-1,i+1,j-2,ct,data)/wl->f(i,j);
 
-						if (cumulative>roll&&!found) {
-							stack.push(i+1,j-2,1,0,0);
-							regbp(ct,number,i,j-1);
-							found=true;
+					if (cumulative>roll&&!found) {
+						stack.push(i+1,j-2,1,0,0);
+						regbp(basepr,i,j-1);
+						found=true;
 
-						}
-				
+					}
+			
 
 
-					}
-					#else //!SIMPLEMBLOOP
+				}
+				#else //!SIMPLEMBLOOP
 
-					if (!lfce[i]) {
+				if (!lfce[i]) {
          		
          				cumulative=  wl->f(i+1,j)*data->eparam[6]*data->scaling/wl->f(i,j);
 
-						if (cumulative>roll) {
-							stack.push(i+1,j,6,0,0);
-							found=true;
-
-						}
-            	
-					}
-					cumulative+= data->eparam[10]*v->f(i,j)*penalty(j,i,ct,data)/wl->f(i,j);
-					if (cumulative>roll&&!found) {
+					if (cumulative>roll) {
+						stack.push(i+1,j,6,0,0);
 						found=true;
-						stack.push(i,j,1,0,0);
 
 					}
+            	
+				}
+				cumulative+= data->eparam[10]*v->f(i,j)*penalty(j,i,ct,data)/wl->f(i,j);
+				if (cumulative>roll&&!found) {
+					found=true;
+					stack.push(i,j,1,0,0);
 
-					if ((mod[i]||mod[j])) if (inc[ct->numseq[i+1]][ct->numseq[j-1]]&&notgu(i,j,ct)) {
+				}
 
-						cumulative+= data->eparam[10]*v->f(i+1,j-1)*penalty(j,i,ct,data)*erg1(i,j,i+1,j-1,ct,data)/wl->f(i,j);	
+				if ((mod[i]||mod[j])) if (inc[ct->numseq[i+1]][ct->numseq[j-1]]&&notgu(i,j,ct)) {
 
-						if (!found&&cumulative>roll) {
-							stack.push(i+1,j-1,1,0,0);
-							regbp(ct,number,i,j);
-							found = true;
+					cumulative+= data->eparam[10]*v->f(i+1,j-1)*penalty(j,i,ct,data)*erg1(i,j,i+1,j-1,ct,data)/wl->f(i,j);	
 
-						}
+					if (!found&&cumulative>roll) {
+						stack.push(i+1,j-1,1,0,0);
+						regbp(basepr,i,j);
+						found = true;
+
+					}
 
-					} 
+				} 
 
-					cumulative+= v->f(i+1,j)*data->eparam[10]*data->eparam[6]*
+				cumulative+= v->f(i+1,j)*data->eparam[10]*data->eparam[6]*
          				erg4(j,i+1,i,2,ct,data,lfce[i])*penalty(i+1,j,ct,data)/wl->f(i,j);
 
-					if (!found&&cumulative>roll) {
-						stack.push(i+1,j,1,0,0);
-						found=true;
+				if (!found&&cumulative>roll) {
+					stack.push(i+1,j,1,0,0);
+					found=true;
 
-					}
+				}
 
-					if ((mod[i+1]||mod[j])) if(inc[ct->numseq[i+2]][ct->numseq[j-1]]&&notgu(i+1,j,ct)&&!(fce->f(i+1,j)&SINGLE)) {
+				if ((mod[i+1]||mod[j])) if(inc[ct->numseq[i+2]][ct->numseq[j-1]]&&notgu(i+1,j,ct)&&!(fce->f(i+1,j)&SINGLE)) {
 
-						cumulative+= v->f(i+2,j-1) * data->eparam[10] *data->eparam[6] *
+					cumulative+= v->f(i+2,j-1) * data->eparam[10] *data->eparam[6] *
          					erg4(j,i+1,i,2,ct,data,lfce[i])*penalty(i+1,j,ct,data)
-							*erg1(i+1,j,i+2,j-1,ct,data)/wl->f(i,j);
+						*erg1(i+1,j,i+2,j-1,ct,data)/wl->f(i,j);
 
-						if (!found&&cumulative>roll) {
-							stack.push(i+2,j-1,1,0,0);
-							found=true;
-							regbp(ct,number,i+1,j);
+					if (!found&&cumulative>roll) {
+						stack.push(i+2,j-1,1,0,0);
+						found=true;
+						regbp(basepr,i+1,j);
 
-						}
+					}
 
 
-					}
+				}
 
-					cumulative+= v->f(i,j-1)* data->eparam[10] * data->eparam[6] *
+				cumulative+= v->f(i,j-1)* data->eparam[10] * data->eparam[6] *
          				erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)/wl->f(i,j);
 
-					if (cumulative>roll&&!found) {
-						stack.push(i,j-1,1,0,0);
-						found=true;
+				if (cumulative>roll&&!found) {
+					stack.push(i,j-1,1,0,0);
+					found=true;
 
-					}
+				}
 
-					if ((mod[i]||mod[j-1])) if(inc[ct->numseq[i+1]][ct->numseq[j-2]]&&notgu(i,j-1,ct)&&!(fce->f(i,j-1)&SINGLE)) {
+				if ((mod[i]||mod[j-1])) if(inc[ct->numseq[i+1]][ct->numseq[j-2]]&&notgu(i,j-1,ct)&&!(fce->f(i,j-1)&SINGLE)) {
 
-						cumulative+= v->f(i+1,j-2) * data->eparam[10] * data->eparam[6] *
+					cumulative+= v->f(i+1,j-2) * data->eparam[10] * data->eparam[6] *
          					erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)
-							*erg1(i,j-1,i+1,j-2,ct,data)/wl->f(i,j);
+						*erg1(i,j-1,i+1,j-2,ct,data)/wl->f(i,j);
 
-						if (cumulative>roll&&!found) {
-							stack.push(i+1,j-2,1,0,0);
-							regbp(ct,number,i,j-1);
-							found=true;
+					if (cumulative>roll&&!found) {
+						stack.push(i+1,j-2,1,0,0);
+						regbp(basepr,i,j-1);
+						found=true;
 
-						}
-				
+					}
+			
 
 
-					}
+				}
 
-					if (j!=1&&!lfce[i]&&!lfce[j]) {
+				if (j!=1&&!lfce[i]&&!lfce[j]) {
          				cumulative+= v->f(i+1,j-1) *data->eparam[10] * (data->eparam[6]*data->eparam[6]) *
          				data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
-						*penalty(j-1,i+1,ct,data)/wl->f(i,j);
+					*penalty(j-1,i+1,ct,data)/wl->f(i,j);
 
-						if (cumulative>roll&&!found) {
-							stack.push(i+1,j-1,1,0,0);
-							found=true;
+					if (cumulative>roll&&!found) {
+						stack.push(i+1,j-1,1,0,0);
+						found=true;
 
-						}
+					}
 
 
 
-						if ((mod[i+1]||mod[j-1])) if((j-2>0)&&!(fce->f(i+1,j-1)&SINGLE)) {
-							if(inc[ct->numseq[i+2]][ct->numseq[j-2]]&&notgu(i+1,j-1,ct)) {
+					if ((mod[i+1]||mod[j-1])) if((j-2>0)&&!(fce->f(i+1,j-1)&SINGLE)) {
+						if(inc[ct->numseq[i+2]][ct->numseq[j-2]]&&notgu(i+1,j-1,ct)) {
 
-								cumulative+= v->f(i+2,j-2) * data->eparam[10] * (data->eparam[6]*data->eparam[6]) *
+							cumulative+= v->f(i+2,j-2) * data->eparam[10] * (data->eparam[6]*data->eparam[6]) *
          							data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
-									*penalty(j-1,i+1,ct,data)*erg1(i+1,j-1,i+2,j-2,ct,data)/wl->f(i,j);
-
-								if (cumulative>roll&&!found) {
-									stack.push(i+2,j-2,1,0,0);
-									regbp(ct,number,i+1,j-1);
-									found=true;
+								*penalty(j-1,i+1,ct,data)*erg1(i+1,j-1,i+2,j-2,ct,data)/wl->f(i,j);
 
-								}
+							if (cumulative>roll&&!found) {
+								stack.push(i+2,j-2,1,0,0);
+								regbp(basepr,i+1,j-1);
+								found=true;
 
 							}
+
 						}
 					}
-					#endif  //SIMPLEMBLOOP
-					if (!found) {
-						cout << "Traceback errors at wl\n";
-						tracebackerror=14;
+				}
+				#endif  //SIMPLEMBLOOP
+				if (!found) {
+					cout << "Traceback errors at wl\n";
+					tracebackerror=14;
 
-					}
+				}
 
-				break;
+			break;
 
-				case 7: //switchcase 7, a wl seed (helix only)
-						
-					#ifdef SIMPLEMBLOOP
+			case 7: //switchcase 7, a wl seed (helix only)
+					
+				#ifdef SIMPLEMBLOOP
 
-					cumulative+= v->f(i,j-1)* data->eparam[10] * data->eparam[6] *
+				cumulative+= v->f(i,j-1)* data->eparam[10] * data->eparam[6] *
          				erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
 
+				if (cumulative>roll&&!found) {
+					stack.push(i,j-1,1,0,0);
+					found=true;
+
+				}
+
+				if ((mod[i]||mod[j-1])) if(inc[ct->numseq[i+1]][ct->numseq[j-2]]&&notgu(i,j-1,ct)&&!(fce->f(i,j-1)&SINGLE)) {
+
+					cumulative+= v->f(i+1,j-2) * data->eparam[10] * data->eparam[6] *
+         					erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)
+						*erg1(i,j-1,i+1,j-2,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
+
 					if (cumulative>roll&&!found) {
-						stack.push(i,j-1,1,0,0);
+						stack.push(i+1,j-2,1,0,0);
+						regbp(basepr,i,j-1);
 						found=true;
 
 					}
+			
 
-					if ((mod[i]||mod[j-1])) if(inc[ct->numseq[i+1]][ct->numseq[j-2]]&&notgu(i,j-1,ct)&&!(fce->f(i,j-1)&SINGLE)) {
 
-						cumulative+= v->f(i+1,j-2) * data->eparam[10] * data->eparam[6] *
-         					erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)
-							*erg1(i,j-1,i+1,j-2,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
+				}
+				#else   //!SIMPLEMBLOOP
 
-						if (cumulative>roll&&!found) {
-							stack.push(i+1,j-2,1,0,0);
-							regbp(ct,number,i,j-1);
-							found=true;
+				cumulative+= data->eparam[10]*v->f(i,j)*penalty(j,i,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
+				if (cumulative>roll&&!found) {
+					found=true;
+					stack.push(i,j,1,0,0);
 
-						}
-				
+				}
 
+				if ((mod[i]||mod[j])) if (inc[ct->numseq[i+1]][ct->numseq[j-1]]&&notgu(i,j,ct)) {
 
-					}
-					#else   //!SIMPLEMBLOOP
+					cumulative+= data->eparam[10]*v->f(i+1,j-1)*penalty(j,i,ct,data)*erg1(i,j,i+1,j-1,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);	
 
-					cumulative+= data->eparam[10]*v->f(i,j)*penalty(j,i,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
-					if (cumulative>roll&&!found) {
-						found=true;
-						stack.push(i,j,1,0,0);
+					if (!found&&cumulative>roll) {
+						stack.push(i+1,j-1,1,0,0);
+						regbp(basepr,i,j);
+						found = true;
 
 					}
 
-					if ((mod[i]||mod[j])) if (inc[ct->numseq[i+1]][ct->numseq[j-1]]&&notgu(i,j,ct)) {
+				} 
 
-						cumulative+= data->eparam[10]*v->f(i+1,j-1)*penalty(j,i,ct,data)*erg1(i,j,i+1,j-1,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);	
+				cumulative+= v->f(i+1,j)*data->eparam[10]*data->eparam[6]*
+         				erg4(j,i+1,i,2,ct,data,lfce[i])*penalty(i+1,j,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
 
-						if (!found&&cumulative>roll) {
-							stack.push(i+1,j-1,1,0,0);
-							regbp(ct,number,i,j);
-							found = true;
+				if (!found&&cumulative>roll) {
+					stack.push(i+1,j,1,0,0);
+					found=true;
 
-						}
+				}
 
-					} 
+				if ((mod[i+1]||mod[j])) if(inc[ct->numseq[i+2]][ct->numseq[j-1]]&&notgu(i+1,j,ct)&&!(fce->f(i+1,j)&SINGLE)) {
 
-					cumulative+= v->f(i+1,j)*data->eparam[10]*data->eparam[6]*
-         				erg4(j,i+1,i,2,ct,data,lfce[i])*penalty(i+1,j,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
+					cumulative+= v->f(i+2,j-1) * data->eparam[10] *data->eparam[6] *
+         					erg4(j,i+1,i,2,ct,data,lfce[i])*penalty(i+1,j,ct,data)
+						*erg1(i+1,j,i+2,j-1,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
 
 					if (!found&&cumulative>roll) {
-						stack.push(i+1,j,1,0,0);
+						stack.push(i+2,j-1,1,0,0);
 						found=true;
+						regbp(basepr,i+1,j);
 
 					}
 
-					if ((mod[i+1]||mod[j])) if(inc[ct->numseq[i+2]][ct->numseq[j-1]]&&notgu(i+1,j,ct)&&!(fce->f(i+1,j)&SINGLE)) {
 
-						cumulative+= v->f(i+2,j-1) * data->eparam[10] *data->eparam[6] *
-         					erg4(j,i+1,i,2,ct,data,lfce[i])*penalty(i+1,j,ct,data)
-							*erg1(i+1,j,i+2,j-1,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
+				}
 
-						if (!found&&cumulative>roll) {
-							stack.push(i+2,j-1,1,0,0);
-							found=true;
-							regbp(ct,number,i+1,j);
+				cumulative+= v->f(i,j-1)* data->eparam[10] * data->eparam[6] *
+         				erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
 
-						}
+				if (cumulative>roll&&!found) {
+					stack.push(i,j-1,1,0,0);
+					found=true;
 
+				}
+
+				if ((mod[i]||mod[j-1])) if(inc[ct->numseq[i+1]][ct->numseq[j-2]]&&notgu(i,j-1,ct)&&!(fce->f(i,j-1)&SINGLE)) {
+
+					cumulative+= v->f(i+1,j-2) * data->eparam[10] * data->eparam[6] *
+         					erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)
+						*erg1(i,j-1,i+1,j-2,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
+
+					if (cumulative>roll&&!found) {
+						stack.push(i+1,j-2,1,0,0);
+						regbp(basepr,i,j-1);
+						found=true;
 
 					}
+			
 
-					cumulative+= v->f(i,j-1)* data->eparam[10] * data->eparam[6] *
-         				erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
+
+				}
+
+				if (j!=1&&!lfce[i]&&!lfce[j]) {
+         				cumulative+= v->f(i+1,j-1) *data->eparam[10] * (data->eparam[6]*data->eparam[6]) *
+         				data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
+					*penalty(j-1,i+1,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
 
 					if (cumulative>roll&&!found) {
-						stack.push(i,j-1,1,0,0);
+						stack.push(i+1,j-1,1,0,0);
 						found=true;
 
 					}
 
-					if ((mod[i]||mod[j-1])) if(inc[ct->numseq[i+1]][ct->numseq[j-2]]&&notgu(i,j-1,ct)&&!(fce->f(i,j-1)&SINGLE)) {
 
-						cumulative+= v->f(i+1,j-2) * data->eparam[10] * data->eparam[6] *
-         					erg4(j-1,i,j,1,ct,data,lfce[j])*penalty(i,j-1,ct,data)
-							*erg1(i,j-1,i+1,j-2,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
 
-						if (cumulative>roll&&!found) {
-							stack.push(i+1,j-2,1,0,0);
-							regbp(ct,number,i,j-1);
-							found=true;
+					if ((mod[i+1]||mod[j-1])) if((j-2>0)&&!(fce->f(i+1,j-1)&SINGLE)) {
+						if(inc[ct->numseq[i+2]][ct->numseq[j-2]]&&notgu(i+1,j-1,ct)) {
 
-						}
-				
+							cumulative+= v->f(i+2,j-2) * data->eparam[10] * (data->eparam[6]*data->eparam[6]) *
+         							data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
+								*penalty(j-1,i+1,ct,data)*erg1(i+1,j-1,i+2,j-2,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
+
+							if (cumulative>roll&&!found) {
+								stack.push(i+2,j-2,1,0,0);
+								regbp(basepr,i+1,j-1);
+								found=true;
 
+							}
 
+						}
 					}
+				}
+				#endif //SIMPLEMBLOOP
+				if (!found) {
+					cout << "Traceback error at wl seed\n";
+					tracebackerror=14;
 
-					if (j!=1&&!lfce[i]&&!lfce[j]) {
-         				cumulative+= v->f(i+1,j-1) *data->eparam[10] * (data->eparam[6]*data->eparam[6]) *
-         				data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
-						*penalty(j-1,i+1,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
+				}
 
-						if (cumulative>roll&&!found) {
-							stack.push(i+1,j-1,1,0,0);
-							found=true;
 
-						}
+			break;
+		}
+		if (cumulative>(1.0+1e-5)) {
+			cout << "Over 1 probability error\n";
+			tracebackerror=21;
 
+		}
+		if (!found) {
+			cout << "Overall traceback error\n";
+			tracebackerror=14;
 
+		}
+	}
 
-						if ((mod[i+1]||mod[j-1])) if((j-2>0)&&!(fce->f(i+1,j-1)&SINGLE)) {
-							if(inc[ct->numseq[i+2]][ct->numseq[j-2]]&&notgu(i+1,j-1,ct)) {
+	return tracebackerror;
+}
 
-								cumulative+= v->f(i+2,j-2) * data->eparam[10] * (data->eparam[6]*data->eparam[6]) *
-         							data->tstkm[ct->numseq[j-1]][ct->numseq[i+1]][ct->numseq[j]][ct->numseq[i]]
-									*penalty(j-1,i+1,ct,data)*erg1(i+1,j-1,i+2,j-2,ct,data)/(wl->f(i,j)-wl->f(i+1,j)*data->eparam[6]*data->scaling);
 
-								if (cumulative>roll&&!found) {
-									stack.push(i+2,j-2,1,0,0);
-									regbp(ct,number,i+1,j-1);
-									found=true;
+int stochastictraceback(pfunctionclass *w,pfunctionclass *wmb,pfunctionclass *wmbl,pfunctionclass *wcoax,pfunctionclass *wl,pfunctionclass *v,pfunctionclass *v2,
+	forceclass *fce, PFPRECISION *w3,PFPRECISION *w5,PFPRECISION scaling, bool *lfce, bool *mod, pfdatatable *data, int numberofstructures, 
+	structure *ct, int randomseed, TProgressDialog *progress) {
+	
+	int number;
+	int tracebackerror=0;
 
-								}
+	//the structures are added before sampling, so that each thread only sets the pairs of its own structures
+	for (number = 1; number <= numberofstructures; number++) {
+		ct->AddStructure();
+		ct->SetCtLabel(ct->GetSequenceLabel(),number);
+	}
 
-							}
-						}
-					}
-					#endif //SIMPLEMBLOOP
-					if (!found) {
-						cout << "Traceback error at wl seed\n";
-						tracebackerror=14;
+	//Big loop:
+	#ifdef SMP
+	#pragma omp parallel for
+	#endif
+	for (number = 1; number <= numberofstructures; number++) {
+		vector<int> basepr(ct->GetSequenceLength()+1,0);
+		int i,error;
 
-					}
+		//the progress dialog is not thread safe, so only the first thread reports
+		bool reporter = true;
+		#ifdef SMP
+		reporter = omp_get_thread_num()==0;
+		#endif
+		if (progress!=NULL&&reporter) {
 
+			progress->update((int) (((float) 100*number)/((float) numberofstructures)));
 
-				break;
-			}
-			if (cumulative>(1.0+1e-5)) {
-				cout << "Over 1 probability error\n";
-				tracebackerror=21;
+		}
 
-			}
-			if (!found) {
-				cout << "Overall traceback error\n";
-				tracebackerror=14;
+		error = samplestructure(w,wmb,wmbl,wcoax,wl,v,v2,fce,w3,w5,scaling,lfce,mod,data,ct,randomseed+number,&basepr[0]);
+		if (error!=0) {
+			#ifdef SMP
+			#pragma omp critical (stochasticerror)
+			#endif
+			tracebackerror = error;
+		}
+
+		for (i=1;i<=ct->GetSequenceLength();i++) {
+			if (basepr[i]>i) ct->SetPair(i,basepr[i],number);
+		}
+	}
+
+	return tracebackerror;
+
+}
+
+
+static const char stochasticmagic[8] = {'R','N','A','p','r','o','b','S'};
+static const int stochasticversion = 1;
+
+stochasticstatistics::stochasticstatistics(int length) {
+	count = 0;
+	unpaired.assign(length+1,0);
+	paired.resize(length+1);
+}
+
+void stochasticstatistics::add(const int *basepr) {
+	int i,k;
+
+	count++;
+	for (i=1;i<(int) unpaired.size();i++) {
+		if (basepr[i]==0) unpaired[i]++;
+		else if (basepr[i]>i) {
+			vector< pair<int,int> > &list = paired[i];
+			for (k=0;k<(int) list.size()&&list[k].first!=basepr[i];k++);
+			if (k==(int) list.size()) list.push_back(make_pair(basepr[i],0));
+			list[k].second++;
+		}
+	}
+}
+
+void stochasticstatistics::merge(const stochasticstatistics &other) {
+	int i,k,m;
+
+	count += other.count;
+	for (i=1;i<(int) unpaired.size();i++) {
+		unpaired[i] += other.unpaired[i];
+		for (m=0;m<(int) other.paired[i].size();m++) {
+			vector< pair<int,int> > &list = paired[i];
+			for (k=0;k<(int) list.size()&&list[k].first!=other.paired[i][m].first;k++);
+			if (k==(int) list.size()) list.push_back(make_pair(other.paired[i][m].first,0));
+			list[k].second += other.paired[i][m].second;
+		}
+	}
+}
+
+int stochasticstatistics::samples() const {
+	return count;
+}
+
+int stochasticstatistics::length() const {
+	return (int) unpaired.size()-1;
+}
+
+double stochasticstatistics::pairfrequency(int i, int j) const {
+	int k;
+
+	if (count==0) return 0;
+	if (i>j) swap(i,j);
+	for (k=0;k<(int) paired[i].size();k++) {
+		if (paired[i][k].first==j) return ((double) paired[i][k].second)/count;
+	}
+	return 0;
+}
+
+double stochasticstatistics::unpairedfrequency(int i) const {
+	if (count==0) return 0;
+	return ((double) unpaired[i])/count;
+}
+
+const vector< pair<int,int> > &stochasticstatistics::partners(int i) const {
+	return paired[i];
+}
+
+//write the structure basepr to out in format
+static void writesample(ostream *out, int format, const int *basepr, int length) {
+	int i,pairs;
 
+	if (format==STOCHASTIC_DOTBRACKET) {
+		string line(length,'.');
+		for (i=1;i<=length;i++) {
+			if (basepr[i]>i) {
+				line[i-1] = '(';
+				line[basepr[i]-1] = ')';
+			}
+		}
+		*out << line << "\n";
+	}
+	else {
+		pairs = 0;
+		for (i=1;i<=length;i++) if (basepr[i]>i) pairs++;
+		out->write((const char *) &pairs,sizeof(pairs));
+		for (i=1;i<=length;i++) {
+			if (basepr[i]>i) {
+				out->write((const char *) &i,sizeof(i));
+				out->write((const char *) &basepr[i],sizeof(basepr[i]));
 			}
 		}
+	}
+}
+
+int stochasticstream(pfunctionclass *w,pfunctionclass *wmb,pfunctionclass *wmbl,pfunctionclass *wcoax,pfunctionclass *wl,pfunctionclass *v,pfunctionclass *v2,
+	forceclass *fce, PFPRECISION *w3,PFPRECISION *w5,PFPRECISION scaling, bool *lfce, bool *mod, pfdatatable *data, int numberofstructures,
+	structure *ct, ostream *out, int format, stochasticstatistics *statistics, int randomseed, TProgressDialog *progress) {
+
+	int number,threads,t;
+	int length = ct->GetSequenceLength();
+	int tracebackerror=0;
+
+	if (out!=NULL&&format==STOCHASTIC_PAIRS) {
+		stochasticheader header;
+		memcpy(header.magic,stochasticmagic,sizeof(header.magic));
+		header.version = stochasticversion;
+		header.length = length;
+		out->write((const char *) &header,sizeof(header));
+	}
+
+#ifdef SMP
+	threads = omp_get_max_threads();
+#else
+	threads = 1;
+#endif
+	//the counts of each thread
+	vector<stochasticstatistics> counts(statistics!=NULL?threads:0,stochasticstatistics(length));
+
+	//the structures are sampled in parallel, and written in order
+	#ifdef SMP
+	#pragma omp parallel for ordered schedule(dynamic)
+	#endif
+	for (number = 1; number <= numberofstructures; number++) {
+		vector<int> basepr(length+1,0);
+		int error;
+
+		//the progress dialog is not thread safe, so only the first thread reports
+		bool reporter = true;
+		#ifdef SMP
+		reporter = omp_get_thread_num()==0;
+		#endif
+		if (progress!=NULL&&reporter) {
+
+			progress->update((int) (((float) 100*number)/((float) numberofstructures)));
+
+		}
+
+		error = samplestructure(w,wmb,wmbl,wcoax,wl,v,v2,fce,w3,w5,scaling,lfce,mod,data,ct,randomseed+number,&basepr[0]);
+		if (error!=0) {
+			#ifdef SMP
+			#pragma omp critical (stochasticerror)
+			#endif
+			tracebackerror = error;
+		}
 
+		if (statistics!=NULL) {
+#ifdef SMP
+			counts[omp_get_thread_num()].add(&basepr[0]);
+#else
+			counts[0].add(&basepr[0]);
+#endif
+		}
+
+		#ifdef SMP
+		#pragma omp ordered
+		#endif
+		if (out!=NULL) writesample(out,format,&basepr[0],length);
 	}
 
+	for (t=0;t<(int) counts.size();t++) statistics->merge(counts[t]);
+
+	if (tracebackerror==0&&out!=NULL&&!out->good()) tracebackerror = 2;
 	return tracebackerror;
 
 }
@@ -1739,7 +1932,7 @@ void stochastic(structure *ct, char *savefilename, int numberofstructures, int r
 	
 	int vers;
 
-	pfunctionclass *w,*wmb,*wmbl,*wcoax,*wl,*v;
+	pfunctionclass *w,*wmb,*wmbl,*wcoax,*wl,*v,*v2;
 	forceclass *fce;
 	PFPRECISION *w3,*w5,scaling;
 	bool *lfce,*mod;
@@ -1762,13 +1955,14 @@ void stochastic(structure *ct, char *savefilename, int numberofstructures, int r
 	
 	ct->allocate(sequencelength);
 
-	w = new pfunctionclass(ct->GetSequenceLength());
-	v = new pfunctionclass(ct->GetSequenceLength());
-	wmb = new pfunctionclass(ct->GetSequenceLength());
-	fce = new forceclass(ct->GetSequenceLength());
-	wl = new pfunctionclass(ct->GetSequenceLength());
-	wcoax = new pfunctionclass(ct->GetSequenceLength());
-	wmbl = new pfunctionclass(ct->GetSequenceLength());
+	//the arrays are attached to the blocks of the save file by readpfsave
+	w = new pfunctionclass(ct->GetSequenceLength(),false);
+	v = new pfunctionclass(ct->GetSequenceLength(),false);
+	wmb = new pfunctionclass(ct->GetSequenceLength(),false);
+	fce = new forceclass(ct->GetSequenceLength(),0,false);
+	wl = new pfunctionclass(ct->GetSequenceLength(),false);
+	wcoax = new pfunctionclass(ct->GetSequenceLength(),false);
+	wmbl = new pfunctionclass(ct->GetSequenceLength(),false);
 
 	w5 = new PFPRECISION [ct->GetSequenceLength()+1];
 	w3 = new PFPRECISION [ct->GetSequenceLength()+2];
@@ -1779,21 +1973,23 @@ void stochastic(structure *ct, char *savefilename, int numberofstructures, int r
 	
 	
 
-	//load all the data from the pfsavefile:
-	readpfsave(savefilename, ct, w5, w3,v, w, wmb,wl, wmbl, wcoax, fce,&scaling,mod,lfce,data);
+	//load all the data from the pfsavefile; a truncated or corrupt file leaves no structures
+	if (readpfsave(savefilename, ct, w5, w3,v,&v2, w, wmb,wl, wmbl, wcoax, fce,&scaling,mod,lfce,data)==0) {
 
-	data->scaling = scaling;
+		data->scaling = scaling;
 	
-	//now that partition function data was read from disk, do the sampling:
-	stochastictraceback(w,wmb,wmbl,wcoax,wl,v,
-		fce, w3,w5,scaling, lfce, mod, data, numberofstructures, 
-		ct, randomseed, progress);
+		//now that partition function data was read from disk, do the sampling:
+		stochastictraceback(w,wmb,wmbl,wcoax,wl,v,v2,
+			fce, w3,w5,scaling, lfce, mod, data, numberofstructures, 
+			ct, randomseed, progress);
+	}
 
 
 	//delete everything
 	delete data;
 	delete w;
 	delete v;
+	delete v2;
 	delete wmb;
 	delete fce;
 	delete wl;
@@ -1,6 +1,9 @@
 #if !defined(STOCHASTIC_H)
 #define STOCHASTIC_H
 
+#include <ostream>
+#include <utility>
+#include <vector>
 #include "structure.h"
 #include "pfunction.h"
 
@@ -30,9 +33,62 @@ void stochastic(structure *ct, char *savefilename, int numberofstructures, int r
 	//return an int that is zero with no errors and non-zero when errors occur.  These error codes work with the RNA class.
 		//14 = traceback error.
 		//21 = probabilities sum to > 1.
-int stochastictraceback(pfunctionclass *w,pfunctionclass *wmb,pfunctionclass *wmbl,pfunctionclass *wcoax,pfunctionclass *wl,pfunctionclass *v,
+int stochastictraceback(pfunctionclass *w,pfunctionclass *wmb,pfunctionclass *wmbl,pfunctionclass *wcoax,pfunctionclass *wl,pfunctionclass *v,pfunctionclass *v2,
 	forceclass *fce, PFPRECISION *w3,PFPRECISION *w5,PFPRECISION scaling, bool *lfce, bool *mod, pfdatatable *data, int numberofstructures, 
 	structure *ct, int randomseed = 1000, TProgressDialog *progress=NULL );
 
+//The pair and unpaired counts of sampled structures.  The sampled partners of each nucleotide are
+//kept in a short list, so the memory grows with the sequence length and the pairs that were sampled,
+//and not with the number of samples.
+class stochasticstatistics {
+	public:
+		stochasticstatistics(int length = 0);
+
+		//count the structure basepr, which holds the pair of each nucleotide 1..length, or zero
+		void add(const int *basepr);
+
+		//add the counts of other, which has the same length
+		void merge(const stochasticstatistics &other);
+
+		int samples() const;
+		int length() const;
+
+		//the fraction of the samples with pair i-j, or with i unpaired
+		double pairfrequency(int i, int j) const;
+		double unpairedfrequency(int i) const;
+
+		//the partners j>i of i that were sampled, and the number of samples with each pair
+		const std::vector< std::pair<int,int> > &partners(int i) const;
+
+	private:
+		int count;
+		std::vector<int> unpaired;
+		std::vector< std::vector< std::pair<int,int> > > paired;
+};
+
+//the formats in which stochasticstream writes the samples
+enum {
+	STOCHASTIC_DOTBRACKET,//one line of dot-bracket notation per structure
+	STOCHASTIC_PAIRS//binary: a stochasticheader, then for each structure the number of pairs and each pair i<j, as ints
+};
+
+//The header of the binary format, which identifies the file and gives the sequence length.
+struct stochasticheader {
+	char magic[8];
+	int version;
+	int length;
+};
+
+//stochastic sampling of structures that are written to out, in format, as they are sampled, instead
+	//of being stored in ct.  The structures are the same as those of stochastictraceback and are written
+	//in the same order.  The pair and unpaired counts are added to statistics, if it is not NULL; each thread
+	//counts its own samples, and the counts are merged at the end, so only a few structures are held at once.
+	//out may be NULL to collect the statistics alone.
+	//return an int that is zero with no errors and non-zero when errors occur, as stochastictraceback, or:
+		//2 = out could not be written.
+int stochasticstream(pfunctionclass *w,pfunctionclass *wmb,pfunctionclass *wmbl,pfunctionclass *wcoax,pfunctionclass *wl,pfunctionclass *v,pfunctionclass *v2,
+	forceclass *fce, PFPRECISION *w3,PFPRECISION *w5,PFPRECISION scaling, bool *lfce, bool *mod, pfdatatable *data, int numberofstructures,
+	structure *ct, std::ostream *out, int format, stochasticstatistics *statistics, int randomseed = 1000, TProgressDialog *progress=NULL );
+
 
 #endif
@@ -6,7 +6,9 @@
 
 //#include <stdlib.h>
 #include "structure.h"
+#include "profile.h"
 #include <fstream>
+#include <sstream>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
@@ -88,8 +90,8 @@ structure::structure(int structures)
 	stacking = false;
 	limitdistance=false;//toogle to true to limit base pairing distance
 	maxdistance=600;//default maximum distance between paired nucs
+	filltile=0;//fill one diagonal at a time
 	shaped = false;//by default, a structure does not have SHAPE data associated with it
-	SHAPEss_region = NULL;//by default, the SHAPEss_region does not need to be allocated
 	ssoffset = false;//by default, a structure does not have a single stranded offset read from disk
 	experimentalPairBonusExists = false;//by default, no pairwise bonuses provided
 
@@ -105,6 +107,7 @@ structure::structure(int structures)
 	//ADD BY FD
 	trainingParam = new histSet();
 	trainingParamRead = false;
+	ownTrainingParam = true;
 	split_by_base = false;//if A and C are considered separately for DMS
 	twoStateVersion = false;//true for the two-category version, false for the three-category version
 	smoothVersion = false; // true is decoded with smoothed version
@@ -473,6 +476,10 @@ void structure::SetPairingDistance(int Maxdistance) {
 
 }
 
+void structure::SetFillTile(int tile) {
+	filltile = tile;
+}
+
 //=======
 
 //>>>>>>> 1.51
@@ -1168,6 +1175,25 @@ void structure::RemoveStructure(int structurenumber) {
 
 }
 
+//Remove the structures that are not kept.
+void structure::RemoveStructures(const vector<bool> &keep) {
+	int i,kept;
+
+	//move each kept structure down over the removed ones, swapping the vectors instead of copying them
+	kept = 0;
+	for (i=0;i<(int) arrayofstructures.size();++i) {
+		if (!keep[i]) continue;
+		if (kept!=i) {
+			arrayofstructures[kept].basepr.swap(arrayofstructures[i].basepr);
+			arrayofstructures[kept].ctlabel.swap(arrayofstructures[i].ctlabel);
+			arrayofstructures[kept].energy = arrayofstructures[i].energy;
+		}
+		++kept;
+	}
+	arrayofstructures.erase(arrayofstructures.begin()+kept,arrayofstructures.end());
+
+}
+
 
 //sort the structures from lowest to highest free energy
 void structure::sort() {
@@ -1249,15 +1275,15 @@ structure::~structure()
 		delete[] SHAPE;
 		//delete ss shape array
 		delete[] SHAPEss;
-		if (SHAPEss_region!=NULL) {
-			for (int i = 1; i <= numofbases; i++) {
-				delete[] SHAPEss_region[i];
-			}
-			delete[] SHAPEss_region;
-		}
+	}
+	if (SHAPEFileRead) {
+		delete[] SHAPEdiff;
+	}
+	if (ownTrainingParam) {
+		delete trainingParam;
 	}
 	if ( experimentalPairBonusExists ) {
-		delete[] EX;
+		delete EX;
 	}
 	if (constant!=NULL) {
 		//delete the equilibrium constants
@@ -1579,6 +1605,7 @@ double structure::CalculatePseudoEnergy_smooth(double data, int strucType)
 */
 void structure::ReadTrainingParam()
 {
+	profiletimer timer(profile.trainingparamtime);
 	string filedir;
 	char *dir=getenv("DATAPATH");
 	
@@ -1597,50 +1624,66 @@ void structure::ReadTrainingParam()
 	trainingParam->readHistFile(filedir.c_str());
 }
 
+/*
+	use the histograms of another structure, so that train_param.txt is read once when many
+	sequences are folded.  source must outlive this structure.
+*/
+void structure::ShareTrainingParam(structure *source)
+{
+	if (!source->trainingParamRead){
+		source->ReadTrainingParam();
+		source->trainingParamRead = true;
+	}
+	if (ownTrainingParam)
+		delete trainingParam;
+	trainingParam = source->trainingParam;
+	trainingParamRead = true;
+	ownTrainingParam = false;
+}
+
 /*
 	Add by FD
 	calculate pseudoenergy as -rt * log(P(reactivity|strucType))
 */
 double structure::CalculatePseudoEnergy(double data, std::string modifier, int position, int strucType)
 {
-	int dataSource = 0;
+	int dataSource = -1;
+	
+	if (modifier == "SHAPE") 
+		dataSource = DSOURCE_SHAPE;
+	else if (modifier == "DMS")
+		dataSource = DSOURCE_DMS;
+	
+	return CalculatePseudoEnergy(data, dataSource, position, strucType);
+}
+
+/*
+	calculate pseudoenergy with the data source already resolved, the -rt * log(P) values
+	are looked up in the tables precomputed by histSet::readHistFile
+*/
+double structure::CalculatePseudoEnergy(double data, int dataSource, int position, int strucType)
+{
 	int baseType = 0;
-	double probability = 0.0;
-	histData* ahist;
 	
 	if (data <= -500)
 		return 0;
 	else if (data < 0)
 		data = 0; // set negatives to 0
 	
-	if (modifier == "SHAPE") 
-		dataSource = DSOURCE_SHAPE;
-	else if (modifier == "DMS")
-		dataSource = DSOURCE_DMS;
-	else{
+	if (dataSource != DSOURCE_SHAPE && dataSource != DSOURCE_DMS){
 		cout<<"Unexpected data source!\n";
 		exit(0);
 	}
-		
 	
 	//check if empirical distribution are used by base type 
 	if (!split_by_base)
 		baseType = BASE_X;
 	else {
-		if (numseq[position] == 1)
-			baseType = BASE_A;
-		else if (numseq[position] == 2)
-			baseType = BASE_C;
-		else if (numseq[position] == 3)
-			baseType = BASE_G;
-		else if (numseq[position] == 4)
-			baseType = BASE_U;
-		else{
-			//cout<<"Unexpected data source!\n";
-			//exit(0);
+		//numseq is 1 to 4 for A, C, G and U
+		if (numseq[position] >= 1 && numseq[position] <= 4)
+			baseType = BASE_A + numseq[position] - 1;
+		else
 			return 0;
-		}
-			
 	}
 	
 	//Add code for other data sources, like CMCT
@@ -1650,13 +1693,7 @@ double structure::CalculatePseudoEnergy(double data, std::string modifier, int p
 		return CalculatePseudoEnergy_smooth(data, strucType);
 	}
 	else {
-		ahist = trainingParam->getHistData(dataSource, strucType, baseType);
-	
-		probability = ahist->getProbability(data);
-		if (probability <= 0)
-			return 0;
-		probability = -(double) rt * log (probability) * conversionfactor;
-		return probability;
+		return trainingParam->getPseudoEnergy(dataSource, strucType, baseType, data);
 	}
 }
 
@@ -1665,7 +1702,23 @@ double structure::CalculatePseudoEnergy(double data, std::string modifier, int p
 //calculate (default true) indicate whether these data are being read for folding.  (false means
 	//the raw values need to be stored.)
 void structure::ReadSHAPE(const char *filename, std::string modifier, bool calculate, bool nosum) {
-	ifstream in;
+	profiletimer timer(profile.SHAPEtime);
+	vector<int> positions;
+	vector<double> reactivities;
+
+	readreactivity(filename, positions, reactivities);
+
+	SetSHAPE(positions, reactivities, modifier, calculate);
+
+	//ADD BY FD
+	printSHAPE();
+}
+
+//This function takes SHAPE reactivities that are already in memory and saves the data for a linear penalty.
+//position[k] is the nucleotide index of reactivity[k], indices beyond the sequence are ignored and a position
+	//can be given more than once (its pseudoenergies are then averaged).
+//Like ReadSHAPE, the pseudoenergies are added to any that are already present.
+void structure::SetSHAPE(const vector<int> &positions, const vector<double> &reactivities, std::string modifier, bool calculate) {
 	int position;
 	double data;
 
@@ -1730,7 +1783,6 @@ void structure::ReadSHAPE(const char *filename, std::string modifier, bool calcu
 	int *num_data_points =  new int [ numofbases + 1];
 	for (position=0; position <= numofbases; position++) num_data_points[ position ] = 0;
 
-	in.open(filename);
 	shaped = true;
 
 	for (position=0; position <= 2*numofbases; position++) {
@@ -1744,12 +1796,16 @@ void structure::ReadSHAPE(const char *filename, std::string modifier, bool calcu
 		counts[position] = 0;
 	}
 
-	in >> position;
-	in >> data;
+	//resolve the data source once, rather than for every data point
+	int dataSource = -1;
+	if (modifier == "SHAPE")
+		dataSource = DSOURCE_SHAPE;
+	else if (modifier == "DMS")
+		dataSource = DSOURCE_DMS;
 
-	while (!in.eof()) {
-		//read and parse all data
-			//required format is rows with sequence position followed by reactivity
+	for (unsigned int k=0; k<positions.size(); k++) {
+		position = positions[k];
+		data = reactivities[k];
 		
 		if (position<=numofbases) {
 			
@@ -1758,14 +1814,14 @@ void structure::ReadSHAPE(const char *filename, std::string modifier, bool calcu
 				//SHAPEssnew[position] += CalculatePseudoEnergy(data, modifier, SHAPEslope_ss, SHAPEintercept_ss);
 				//FD
 				if (twoStateVersion)//set structure type to be paired when twoStateVersion = true
-					SHAPEnew[position] += CalculatePseudoEnergy(data, modifier, position, STYPE_PAIRED);
+					SHAPEnew[position] += CalculatePseudoEnergy(data, dataSource, position, STYPE_PAIRED);
 				else {//use helix-end pseudoenergy 
-					double helixE = CalculatePseudoEnergy(data, modifier, position, STYPE_HELIXEND);
-					double stackE = CalculatePseudoEnergy(data, modifier, position, STYPE_STACKED);
+					double helixE = CalculatePseudoEnergy(data, dataSource, position, STYPE_HELIXEND);
+					double stackE = CalculatePseudoEnergy(data, dataSource, position, STYPE_STACKED);
 					SHAPEnew[position] += helixE;
 					SHAPEdiffnew[position] += stackE - helixE;
 				}
-				SHAPEssnew[position] += CalculatePseudoEnergy(data, modifier, position, STYPE_UNPAIRED);
+				SHAPEssnew[position] += CalculatePseudoEnergy(data, dataSource, position, STYPE_UNPAIRED);
 				if(SHAPEnew[position] != 0)
 					counts[position] += 1;
 			}
@@ -1779,12 +1835,7 @@ void structure::ReadSHAPE(const char *filename, std::string modifier, bool calcu
 			}
 
 		}
-
-
-		in >> position;
-		in >> data;
 	}
-	in.close();
 	if (calculate) {
 		for (position=1;position<=numofbases;position++) {
 			if(counts[position] >= 1){
@@ -1814,21 +1865,8 @@ void structure::ReadSHAPE(const char *filename, std::string modifier, bool calcu
 		
 	}
 
-	//ADD BY FD
-	printSHAPE();
-	
-	
-	//initializing triangular 2-d array that stores ss SHAPE energies for loops. 1st index is ending location, 2nd index is starting location
-	SHAPEss_region = new int *[numofbases + 1];
-	for (int i = 1; i <= numofbases; i++) SHAPEss_region[i] = new int [i];
-
-	//fills 2-d array with pseudo energy terms for loops from i-j using ss SHAPE parameters
-	for (int j = 2; j <= numofbases; j++) {
-		SHAPEss_region[j][j - 1] = (int)(SHAPEss[j] + SHAPEss[j-1]); //sets energy for "zero sized loop".  Acts as starting value to add onto below
-		for (int i = j - 2; i >= 1; i--) {
-			SHAPEss_region[j][i] = SHAPEss_region[j][i + 1] + (int)(SHAPEss[i]); //adds energy for additional loop element
-		}
-	}
+	//sums of the ss SHAPE energies, for loops
+	SHAPEss_sums();
 
 	delete[] num_data_points;
 	delete[] SHAPEnew;
@@ -1839,6 +1877,59 @@ void structure::ReadSHAPE(const char *filename, std::string modifier, bool calcu
 
 }
 
+//Copy the pseudoenergies that source calculated from its reactivity data.
+//They do not depend on the folding temperature, so strands folded at several temperatures can take them from one strand
+	//instead of reading the data again.  source must have the same sequence.
+void structure::CopySHAPE(structure *source) {
+	int position;
+
+	if (!source->SHAPEFileRead) return;
+
+	if (!SHAPEFileRead) {
+		SHAPE = new double [2*numofbases+1];
+		SHAPEss = new double [2*numofbases+1];
+		SHAPEdiff = new double [2*numofbases+1];
+		SHAPEFileRead = true;
+	}
+	shaped = true;
+
+	SHAPEslope = source->SHAPEslope;
+	SHAPEintercept = source->SHAPEintercept;
+	SHAPEslope_ss = source->SHAPEslope_ss;
+	SHAPEintercept_ss = source->SHAPEintercept_ss;
+
+	for (position=0;position<=2*numofbases;position++) {
+		SHAPE[position] = source->SHAPE[position];
+		SHAPEss[position] = source->SHAPEss[position];
+		SHAPEdiff[position] = source->SHAPEdiff[position];
+	}
+
+	//sums of the ss SHAPE energies, for loops
+	SHAPEss_sums();
+}
+
+//Read a reactivity file into memory.
+//The required format is rows with sequence position followed by reactivity.
+void readreactivity(const char *filename, vector<int> &positions, vector<double> &reactivities) {
+	ifstream in;
+	int position;
+	double data;
+
+	in.open(filename);
+
+	in >> position;
+	in >> data;
+
+	while (!in.eof()) {
+		positions.push_back(position);
+		reactivities.push_back(data);
+
+		in >> position;
+		in >> data;
+	}
+	in.close();
+}
+
 //FD
 void structure::printSHAPE()
 {
@@ -1890,10 +1981,6 @@ void structure::ReadOffset(const char *SSOffset, const char *DSOffset) {
 
 		}
 
-		//also initialize the ssSHAPE lookup table for regions
-		SHAPEss_region = new int *[numofbases + 1];
-		for (int i = 1; i <= numofbases; i++) SHAPEss_region[i] = new int [i];
-
 		shaped = true;
 	}
 
@@ -1947,14 +2034,9 @@ void structure::ReadOffset(const char *SSOffset, const char *DSOffset) {
 		in2.close();
 	}
 
-	//fills 2-d array with pseudo energy terms for loops from i-j using ss SHAPE parameters or offsets
+	//sums of the ss SHAPE energies for loops, using ss SHAPE parameters or offsets
 	//If SHAPE was previously read, this is a redo of the action
-	for (int j = 2; j <= numofbases; j++) {
-		SHAPEss_region[j][j - 1] = (int)(SHAPEss[j] + SHAPEss[j-1]); //sets energy for "zero sized loop".  Acts as starting value to add onto below
-		for (int i = j - 2; i >= 1; i--) {
-			SHAPEss_region[j][i] = SHAPEss_region[j][i + 1] + (int)(SHAPEss[i]); //adds energy for additional loop element
-		}
-	}
+	SHAPEss_sums();
 
 
 
@@ -1980,10 +2062,18 @@ int structure::SHAPEdiff_give_value(int index)
 }
 
 
+//fills the running sums of the single stranded SHAPE pseudo energies over the doubled sequence,
+//SHAPEss_sum[k] = SHAPEss_give_value(1)+...+SHAPEss_give_value(k) for k up to 2*numofbases
+void structure::SHAPEss_sums() {
+	SHAPEss_sum.resize(2 * numofbases + 1);
+	SHAPEss_sum[0] = 0;
+	for (int k = 1; k <= 2 * numofbases; k++) SHAPEss_sum[k] = SHAPEss_sum[k-1] + (int)(SHAPEss[(k > numofbases) ? k - numofbases : k]);
+}
+
 //this is the function that will return a pseudo energy term for hairpin loops based off of SHAPE data
 int structure::SHAPEss_calc(int index_i, int index_j) {
 	if (shaped) {
-		//accounts for the SHAPEss_region array being only NxN, not 2Nx2N
+		//index the first copy of the sequence
 		if (index_i > numofbases) index_i -= numofbases;
 		if (index_j > numofbases) index_j -= numofbases;
 		if (index_i > index_j) {
@@ -1991,7 +2081,8 @@ int structure::SHAPEss_calc(int index_i, int index_j) {
 			index_i = index_j;
 			index_j = temp_index;
 		}
-		return SHAPEss_region[index_j][index_i];
+		//the last two nucleotides are summed before truncation, the rest one by one
+		return (int)(SHAPEss[index_j] + SHAPEss[index_j-1]) + SHAPEss_sum[index_j-2] - SHAPEss_sum[index_i-1];
 	} else return 0;  //if no shaped data is being used, return zero
 }
 
@@ -1999,6 +2090,7 @@ int structure::SHAPEss_calc(int index_i, int index_j) {
 //This function reads a SHAPE reactivity datafile and parse the data into single-stranded amd chemical modification constraints.
 //This function is largely depracated by the pseudo-free energy approach.  It is still available for experimentation.
 void structure::ReadSHAPE(const char *filename, float SingleStrandThreshold, float ModificationThreshold) {
+	profiletimer timer(profile.SHAPEtime);
 	ifstream in;
 	int position;
 	float data;
@@ -2032,45 +2124,60 @@ void structure::ReadSHAPE(const char *filename, float SingleStrandThreshold, flo
 // This function reads an experimental pair bonus file, similar to SHAPE, but just straightforward
 // application as kcal bonuses.  As with SHAPE, bonus is applied at 0x, 1x, and 2x for
 //  single stranded, edge base pairs, and internal base pairs.
-void structure::ReadExperimentalPairBonus(const char *filename, double const experimentalOffset, double const experimentalScaling ) {
-
-	//int position;
-	//float data;
+// The file is either a square matrix, where the value in row j and column i is the bonus for i-j,
+// or a list of "i j bonus" lines for just the pairs that have a bonus.  A file whose first line
+// has three values is read as a list, unless the sequence is three nucleotides long.
+// Only the pairs with a non-zero bonus are stored; the others take the offset.
+// Returns 0, 4 if a nucleotide in a list is out of range, or 28 if a matrix has fewer than numofbases*numofbases values.
+int structure::ReadExperimentalPairBonus(const char *filename, double const experimentalOffset, double const experimentalScaling ) {
+	string line;
+	int i( 1 ), j( 1 ), fields, count( 0 );
+	double val;
+	bool list;
 
-	//initializing 2-d array that stores bonuses for base pairs.
-	// actually this is already done in RNA.cpp. Thanks Pablo!
-	//delete[] EX;
+	if ( experimentalPairBonusExists ) {
+		delete EX;
+	}
+	EX = new pairbonus( numofbases, experimentalOffset * PFPRECISION( conversionfactor ) );
+	experimentalPairBonusExists = true;
 
-    	ifstream in(filename);
+	if ( strlen( filename ) == 0 ) {
+		EX->build();
+		return 0;
+	}
 
+	ifstream in(filename);
 
-	EX = new double *[ 2*numofbases+1 ];
-	for (int i = 0; i < 2*numofbases+1; i++) EX[i] = new double [ 2*numofbases+1 ];
-	for (int i = 0; i < 2*numofbases+1; i++)
-	  for (int j = 0; j < 2*numofbases+1; j++)
-	    EX[i][j] = 0.0;
+	//count the values on the first line to recognize a list
+	getline( in, line );
+	istringstream first( line );
+	for ( fields = 0; first >> val; fields++ );
+	list = fields == 3 && numofbases != 3;
+	in.clear();
+	in.seekg( 0 );
 
-	for (int i = 1; i <= 2*numofbases; i++)
-	  for (int j = 1; j <= 2*numofbases; j++)
-	    EX[i][j] = experimentalOffset * PFPRECISION( conversionfactor );
-	experimentalPairBonusExists = true;
+	if ( list ) {
 
-	int i( 1 ), j( 1 ), count( 0 );
-	double val;
+	  while ( getline( in, line ) ) {
+	    istringstream entry( line );
 
-	if ( filename != "" ) {
+	    //skip blank lines and comments
+	    if ( !( entry >> i >> j >> val ) ) continue;
 
+	    if ( i < 1 || i > numofbases || j < 1 || j > numofbases ) {
+	      in.close();
+	      return 4;
+	    }
+	    if ( val != 0.0 ) EX->add( i, j, val * PFPRECISION( conversionfactor ) * experimentalScaling );
+	  }
+	}
+	else {
 
-	  while (!in.eof() && j <= numofbases) {
+	  while ( j <= numofbases && in >> val ) {
 
 	    //read and parse all data
 	    //required format is bonuses in square matrix
-	    in >> val;
-
-	    EX[i           ][j           ] += val * PFPRECISION( conversionfactor ) * experimentalScaling;
-	    EX[i+numofbases][j           ] = EX[i][j];
-	    EX[i           ][j+numofbases] = EX[i][j];
-	    EX[i+numofbases][j+numofbases] = EX[i][j];
+	    if ( val != 0.0 ) EX->add( i, j, val * PFPRECISION( conversionfactor ) * experimentalScaling );
 	    count++;
 
 	    i++;
@@ -2080,14 +2187,12 @@ void structure::ReadExperimentalPairBonus(const char *filename, double const exp
 	    }
 
 	  }
-	  in.close();
-
-	  if ( count != numofbases * numofbases ){
-	    cerr << "Found too few values in experimental bonus file, found "<< count <<" but expected " << numofbases*numofbases << endl;
-	    exit(1);
-	  }
 	}
+	in.close();
 
+	EX->build();
+	if ( !list && count != numofbases * numofbases ) return 28;
+	return 0;
 }
 
 
@@ -11,6 +11,7 @@ using namespace std;
 
 #include "defines.h"
 #include "histSet.h"
+#include "pairbonus.h"
 
 #ifdef EXTENDED_DOUBLE
 	#include "extended_double.h" //inlcude code for extended double if needed
@@ -404,6 +405,15 @@ int SHAPEss_give_value(int index);  //Returns the single stranded SHAPE pseudo e
 
 		}
 
+		//!	Provide the tile size of the blocked fill.
+
+		//! \return An int that is the tile size, or 0 if the fill proceeds one diagonal at a time.
+		inline int GetFillTile() {
+
+			return filltile;
+
+		}
+
 		//! Get a nucleotide that must be single stranded.
 
 		//! \return An int that gives the nucleotide position, one indexed.
@@ -423,6 +433,13 @@ int SHAPEss_give_value(int index);  //Returns the single stranded SHAPE pseudo e
 		void SetPairingDistance(int maxdistance);
 
 
+		//! Fill the dynamic programming arrays in tiles of tile x tile fragments instead of one diagonal at a time.
+
+		//! The tiles are filled in dependency order, in parallel in the SMP build.  The structures are the same.
+		//! \param tile is an int that gives the tile size; 0 restores the diagonal fill.
+		void SetFillTile(int tile);
+
+
 		//*********************************
 		//Functions for disk I/O
 		//*********************************
@@ -482,6 +499,12 @@ int SHAPEss_give_value(int index);  //Returns the single stranded SHAPE pseudo e
 		//! \param structurenumber is an int that is the index to which structure should be removed.  This is one indexed.
 		void RemoveStructure(int structurenumber);
 
+		//! Remove each structure that is not marked to be kept, keeping the others in order.
+		
+		//! This is more efficient than removing the structures one at a time with RemoveStructure, which moves every later structure.
+		//! \param keep is a vector of bool that is true for each structure to be kept.  This is zero indexed, so keep[0] is structure 1.
+		void RemoveStructures(const vector<bool> &keep);
+
 		//********************************
 		//Additional functions
 		//********************************
@@ -503,8 +526,10 @@ int SHAPEss_give_value(int index);  //Returns the single stranded SHAPE pseudo e
 		void ReadSHAPE(const char *filename, float SingleStrandThreshold, float ModificationThreshold);//Read SHAPE reactivity data from a file
 		//void ReadSHAPE(const char *filename, bool calculate=true);//Read SHAPE reactivity data from a file
 		void ReadSHAPE(const char *filename, std::string modifier="SHAPE", bool calculate=true, bool nosum=false);//Read SHAPE reactivity data from a file
+		void SetSHAPE(const std::vector<int> &positions, const std::vector<double> &reactivities, std::string modifier="SHAPE", bool calculate=true);//Use SHAPE reactivity data that is already in memory
+		void CopySHAPE(structure *source);//use the SHAPE pseudoenergies of source, which must have the same sequence
 		void ReadOffset(const char *SSOffset, const char *DSOffset);//Read Free Energy Offset Files.
-		void ReadExperimentalPairBonus(const char *filename, double const experimentalOffset = 0.0, double const experimentalScaling = 1.0 );
+		int ReadExperimentalPairBonus(const char *filename, double const experimentalOffset = 0.0, double const experimentalScaling = 1.0 );//Read experimental pair bonuses, either a square matrix or "i j bonus" lines; returns 0, 4 if a nucleotide is out of range, or 28 if a matrix has too few values
 
 		
 
@@ -549,7 +574,7 @@ int SHAPEss_give_value(int index);  //Returns the single stranded SHAPE pseudo e
 		
 		
 		double *SHAPE;//double array to contain SHAPE data -- values less than -500 are ignored
-		double **EX;// double array that contains experimental bonuses/penalties
+		pairbonus *EX;// sparse array that contains experimental bonuses/penalties
 		bool shaped;//keeps track of whether SHAPE data was loaded
 		bool experimentalPairBonusExists;//keeps track of whether experimental bonus data was loaded
 		bool ssoffset;//keeps track of whether a single stranded offset was read from disk
@@ -557,7 +582,8 @@ int SHAPEss_give_value(int index);  //Returns the single stranded SHAPE pseudo e
 		//SINGLE STRANDED SHAPE ENERGY VARIABLES AND FUNCTIONS
 		double *SHAPEss; //int array that contains SHAPE data for single-stranded segments
 		double SHAPEslope_ss, SHAPEintercept_ss; //values of the slope and intercept for SHAPE data modifying single stranded loop stability
-		int **SHAPEss_region;  //2-d int array containing energy values for hairpin loop combinations
+		vector<int> SHAPEss_sum;  //running sums of (int)SHAPEss[1..k] over the doubled sequence, from which the energies of hairpin and internal loop segments are taken
+		void SHAPEss_sums();  //Fills SHAPEss_sum from SHAPEss; called whenever SHAPEss changes
 		int SHAPEss_calc(int index_i, int index_j);  //Returns pseudoenergy term for a hairpin loop using single stranded SHAPE data
 		int SHAPEss_give_value(int index);  //Returns the single stranded SHAPE pseudo energy for a given nucleotide
 		double CalculatePseudoEnergy(double data, std::string modifier, double, double);
@@ -573,10 +599,13 @@ int SHAPEss_give_value(int index);  //Returns the single stranded SHAPE pseudo e
 		//Add by FD
 		histSet* trainingParam;
 		bool trainingParamRead;
+		bool ownTrainingParam;//false if trainingParam belongs to another structure, see ShareTrainingParam
+		void ShareTrainingParam(structure *source);//use the reactivity histograms of source instead of reading them again
 		bool split_by_base;
 		bool twoStateVersion;
 		void ReadTrainingParam();
 		double CalculatePseudoEnergy(double data, std::string modifier, int position, int strucType);
+		double CalculatePseudoEnergy(double data, int dataSource, int position, int strucType);
 		double *SHAPEdiff;//record the difference between stacked and helix-end pseudo-energy
 		//double *SHAPEdiffnew;
 		int SHAPEdiff_give_value(int index);
@@ -594,6 +623,7 @@ int SHAPEss_give_value(int index);  //Returns the single stranded SHAPE pseudo e
 		int numofbases;//number of nucleotides in sequence
 		bool limitdistance;//toggle to indicate that there is a limit on the maximum distance between nucs in base pairs
 		int maxdistance;//maximum distance between nucs in base pairs
+		int filltile;//tile size of the blocked fill, 0 for the diagonal fill
 		
 		vector<singlestructure> arrayofstructures;//This holds an array of structures, i.e. base pairing information and comments
 			
@@ -613,6 +643,9 @@ int SHAPEss_give_value(int index);  //Returns the single stranded SHAPE pseudo e
 
 int tonumi(char *base); //converts base to a numeric
 
+//reads a reactivity file (rows of sequence position followed by reactivity) into positions and reactivities
+void readreactivity(const char *filename, vector<int> &positions, vector<double> &reactivities);
+
 
 char *tobase (int i);//convert a numeric value for a base to the familiar
 								//character
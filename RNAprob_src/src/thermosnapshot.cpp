@@ -0,0 +1,110 @@
+#include "thermosnapshot.h"
+
+#include <cstring>
+#include <sys/stat.h>
+
+using namespace std;
+
+static const char thermosnapshotmagic[8] = {'R','N','A','p','r','o','b','T'};
+
+//written as an int, so that a machine with the other byte order reads it differently
+static const int thermosnapshotbyteorder = 0x01020304;
+
+//a Fletcher sum of the 32 bit words of the tables
+static unsigned long long thermochecksum(const datatable *const *tables, int count) {
+	unsigned long long a = 1,b = 0;
+	int i;
+	size_t k;
+
+	for (i=0;i<count;i++) {
+		const unsigned int *words = (const unsigned int *) tables[i];
+		for (k=0;k<sizeof(datatable)/sizeof(unsigned int);k++) {
+			a += words[k];
+			b += a;
+		}
+	}
+	return (b<<32)^a;
+}
+
+const char *thermosnapshotname(bool isrna) {
+	return isrna ? "rna.snapshot" : "dna.snapshot";
+}
+
+bool writethermosnapshot(const char *filename, const datatable *freeenergy, const datatable *enthalpy) {
+	thermosnapshotheader header;
+	const datatable *tables[2] = {freeenergy,enthalpy};
+	int i;
+
+	memcpy(header.magic,thermosnapshotmagic,sizeof(header.magic));
+	header.version = thermosnapshotversion;
+	header.byteorder = thermosnapshotbyteorder;
+	header.tablesize = (int) sizeof(datatable);
+	header.tables = enthalpy!=NULL ? 2 : 1;
+	header.checksum = thermochecksum(tables,header.tables);
+
+	ofstream snapshot(filename,ios::binary);
+	if (!snapshot) return false;
+	snapshot.write((char *) &header,sizeof(header));
+
+	vector<saveblock> blocks(header.tables);
+	for (i=0;i<header.tables;i++) blocks[i].bytes = sizeof(datatable);
+	writesavedirectory(&snapshot,blocks);
+	for (i=0;i<header.tables;i++) writesaveblock(&snapshot,blocks[i],tables[i]);
+
+	snapshot.close();
+	if (snapshot.fail()) return false;
+
+	//read the snapshot back, to be sure that it is complete
+	savemapping *mapping = openthermosnapshot(filename,enthalpy!=NULL,true);
+	if (mapping==NULL) return false;
+	mapping->release();
+	return true;
+}
+
+savemapping *openthermosnapshot(const char *filename, bool enthalpy, bool verify) {
+	thermosnapshotheader header;
+	vector<saveblock> blocks;
+	const datatable *tables[2];
+	long long filesize;
+	int i;
+
+	ifstream snapshot(filename,ios::binary);
+	if (!snapshot) return NULL;
+	snapshot.read((char *) &header,sizeof(header));
+	if (!snapshot||memcmp(header.magic,thermosnapshotmagic,sizeof(header.magic))!=0) return NULL;
+	if (header.version!=thermosnapshotversion||header.byteorder!=thermosnapshotbyteorder||
+		header.tablesize!=(int) sizeof(datatable)||header.tables<1||header.tables>2) return NULL;
+	if (enthalpy&&header.tables<2) return NULL;
+
+	readsavedirectory(&snapshot,blocks);
+	if (!snapshot||(int) blocks.size()!=header.tables) return NULL;
+
+	//a mapping past the end of a truncated file would fault when it is read
+	snapshot.seekg(0,ios::end);
+	filesize = (long long) snapshot.tellg();
+	snapshot.close();
+	for (i=0;i<header.tables;i++) {
+		if (blocks[i].bytes!=(long long) sizeof(datatable)||blocks[i].offset+blocks[i].bytes>filesize) return NULL;
+	}
+
+	savemapping *mapping = savemapping::open(filename,blocks);
+	if (verify) {
+		for (i=0;i<header.tables;i++) tables[i] = (const datatable *) mapping->block(i);
+		if (thermochecksum(tables,header.tables)!=header.checksum) {
+			mapping->release();
+			return NULL;
+		}
+	}
+	return mapping;
+}
+
+bool thermosnapshotcurrent(const char *filename, char *const *sources, int count) {
+	struct stat snapshot,source;
+	int i;
+
+	if (stat(filename,&snapshot)!=0) return false;
+	for (i=0;i<count;i++) {
+		if (stat(sources[i],&source)==0&&source.st_mtime>snapshot.st_mtime) return false;
+	}
+	return true;
+}
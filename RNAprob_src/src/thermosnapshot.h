@@ -0,0 +1,45 @@
+#ifndef THERMOSNAPSHOT_H
+#define THERMOSNAPSHOT_H
+
+#include "rna_library.h"
+#include "savemapping.h"
+
+// A thermodynamic snapshot holds the parameter tables of a data_tables
+// directory, already parsed: the free energies at 37 degrees C and, when the
+// enthalpy files are present, the enthalpies, each as a datatable laid out as
+// in memory.  RNAprob-thermo writes the snapshot from the text files, and
+// Thermodynamics::ReadThermodynamic maps it instead of parsing them.
+
+// The header identifies the snapshot and the machine that wrote it; a
+// snapshot of another version, or from a machine with another byte order or
+// datatable layout, is not used.  The checksum of the tables is verified when
+// the snapshot is written; checking it at every startup would read all of
+// the tables, which takes longer than the rest of the mapping.
+struct thermosnapshotheader {
+	char magic[8];
+	int version;
+	int byteorder;
+	int tablesize;
+	int tables;//1, or 2 with the enthalpies
+	unsigned long long checksum;//of the tables
+};
+
+// the name of the snapshot in the data_tables directory
+const char *thermosnapshotname(bool isrna);
+
+// write a snapshot of freeenergy and, if it is not NULL, enthalpy; returns
+// false if the file cannot be written or does not match the checksum when it
+// is read back
+bool writethermosnapshot(const char *filename, const datatable *freeenergy, const datatable *enthalpy);
+
+// map the snapshot in filename, which the caller then holds; block 0 is the
+// free energy table and block 1 the enthalpy table.  Returns NULL if there is
+// no usable snapshot, if enthalpy is true and the snapshot has no enthalpies,
+// or if verify is true and the tables do not match the checksum.
+savemapping *openthermosnapshot(const char *filename, bool enthalpy, bool verify = false);
+
+// whether the snapshot in filename is at least as new as each of the count
+// parameter files in sources, which then cannot have changed since it was written
+bool thermosnapshotcurrent(const char *filename, char *const *sources, int count);
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * A program that compiles the thermodynamic parameter files of a data_tables directory into a binary snapshot.
+ * RNAprob and the other programs map the snapshot instead of parsing the files, which shortens their startup.
+ */
+
+#include "ThermoSnapshot.h"
+#include "../src/thermosnapshot.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor.
+///////////////////////////////////////////////////////////////////////////////
+ThermoSnapshot::ThermoSnapshot() {
+
+	// Initialize the calculation type description.
+	calcType = "Thermodynamic snapshot";
+
+	// Initialize the nucleic acid type (RNA).
+	isRNA = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Parse the command line arguments.
+///////////////////////////////////////////////////////////////////////////////
+bool ThermoSnapshot::parse( int argc, char** argv ) {
+
+	// Create the command line parser and build in its required parameters.
+	ParseCommandLine* parser = new ParseCommandLine( "RNAprob-thermo" );
+	parser->addParameterDescription( "data directory", "The name of the directory holding the thermodynamic parameter files, usually data_tables. The snapshot is written to rna.snapshot (dna.snapshot with -d) in this directory." );
+
+	// Add the DNA option.
+	vector<string> dnaOptions;
+	dnaOptions.push_back( "-d" );
+	dnaOptions.push_back( "-D" );
+	dnaOptions.push_back( "--DNA" );
+	parser->addOptionFlagsNoParameters( dnaOptions, "Specify that the DNA parameters are to be compiled. Default is to compile the RNA parameters." );
+
+	// Parse the command line into pieces.
+	parser->parseLine( argc, argv );
+
+	// Get required parameters from the parser.
+	if( !parser->isError() ) { dataDir = parser->getParameter( 1 ); }
+
+	// Get the DNA option.
+	if( !parser->isError() ) { isRNA = !parser->contains( dnaOptions ); }
+
+	// Delete the parser and return whether the parser encountered an error.
+	bool noError = ( parser->isError() == false );
+	delete parser;
+	return noError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Write the snapshot.
+///////////////////////////////////////////////////////////////////////////////
+bool ThermoSnapshot::run() {
+
+	// Parse the parameter files and write them.
+	RNA* strand = new RNA( isRNA );
+	ErrorChecker<RNA>* checker = new ErrorChecker<RNA>( strand );
+	cout << "Writing " << dataDir << "/" << thermosnapshotname( isRNA ) << "..." << flush;
+	int error = checker->isErrorStatus( strand->WriteThermodynamicSnapshot( dataDir.c_str() ) );
+	if( error == 0 ) { cout << "done." << endl; }
+
+	// Delete the error checker and strand.
+	delete checker;
+	delete strand;
+
+	// Print confirmation of run finishing.
+	if( error == 0 ) { cout << calcType << " complete." << endl; }
+	else { cerr << calcType << " complete with errors." << endl; }
+	return error == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main method to run the program.
+///////////////////////////////////////////////////////////////////////////////
+int main( int argc, char* argv[] ) {
+
+	ThermoSnapshot* runner = new ThermoSnapshot();
+	bool parseable = runner->parse( argc, argv );
+	bool written = false;
+	if( parseable == true ) { written = runner->run(); }
+	delete runner;
+	return written ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+/*
+ * A program that compiles the thermodynamic parameter files of a data_tables directory into a binary snapshot.
+ * RNAprob and the other programs map the snapshot instead of parsing the files, which shortens their startup.
+ */
+
+#ifndef THERMOSNAPSHOT_INTERFACE_H
+#define THERMOSNAPSHOT_INTERFACE_H
+
+#include "../RNA_class/RNA.h"
+#include "../src/ErrorChecker.h"
+#include "../src/ParseCommandLine.h"
+
+class ThermoSnapshot {
+ public:
+	// Public constructor and methods.
+
+	/*
+	 * Name:        Constructor.
+	 * Description: Initializes all private variables.
+	 */
+	ThermoSnapshot();
+
+	/*
+	 * Name:        parse
+	 * Description: Parses command line arguments to determine what options are required for a particular calculation.
+	 * Arguments:
+	 *     1.   The number of command line arguments.
+	 *     2.   The command line arguments themselves.
+	 * Returns:
+	 *     True if parsing completed without errors, false if not.
+	 */
+	bool parse( int argc, char** argv );
+
+	/*
+	 * Name:        run
+	 * Description: Write the snapshot.
+	 * Returns:
+	 *     True if the snapshot was written, false if not.
+	 */
+	bool run();
+
+ private:
+	// Private variables.
+
+	// Description of the calculation type.
+	string calcType;
+
+	// The data_tables directory, which holds the parameter files and receives the snapshot.
+	string dataDir;
+
+	// Whether the RNA (true) or DNA (false) parameters are compiled.
+	bool isRNA;
+};
+
+#endif /* THERMOSNAPSHOT_INTERFACE_H */